@@ -161,6 +161,25 @@ SOURCES += $$SRC_DIR/Vec4.cpp \
 		$$SRC_DIR/Vec2.cpp \
 		$$SRC_DIR/Text.cpp \
 		$$SRC_DIR/Mat3.cpp \
+		$$SRC_DIR/SIMD.cpp \
+		$$SRC_DIR/BatchTransform.cpp \
+		$$SRC_DIR/Vec3Array.cpp \
+		$$SRC_DIR/Vec4Array.cpp \
+		$$SRC_DIR/PrecisionConvert.cpp \
+		$$SRC_DIR/BatchQuaternion.cpp \
+		$$SRC_DIR/TransformHierarchy.cpp \
+		$$SRC_DIR/TransformPool.cpp \
+		$$SRC_DIR/Frustum.cpp \
+		$$SRC_DIR/OcclusionBuffer.cpp \
+		$$SRC_DIR/MeshBVH.cpp \
+		$$SRC_DIR/SceneBVH.cpp \
+		$$SRC_DIR/Bounds3.cpp \
+		$$SRC_DIR/BoundingSphere.cpp \
+		$$SRC_DIR/OBB.cpp \
+		$$SRC_DIR/MeshOptimizer.cpp \
+		$$SRC_DIR/VertexPacking.cpp \
+		$$SRC_DIR/MeshSimplify.cpp \
+		$$SRC_DIR/LODSelector.cpp \
 		$$SRC_DIR/AbstractSerializer.cpp \
 		$$SRC_DIR/XMLSerializer.cpp \
 		$$SRC_DIR/NGLStream.cpp \
@@ -222,6 +241,32 @@ HEADERS += $$INC_DIR/Vec4.h \
 		$$INC_DIR/Vec2.h \
 		$$INC_DIR/Text.h \
 		$$INC_DIR/Mat3.h \
+		$$INC_DIR/SIMD.h \
+		$$INC_DIR/BatchTransform.h \
+		$$SRC_DIR/ngl/ParallelFor.h \
+		$$INC_DIR/AlignedAllocator.h \
+		$$INC_DIR/Vec3Array.h \
+		$$INC_DIR/Vec4Array.h \
+		$$SRC_DIR/ngl/SoAKernels.h \
+		$$SRC_DIR/ngl/ExportInline.h \
+		$$INC_DIR/Vec3T.h \
+		$$INC_DIR/Mat4T.h \
+		$$INC_DIR/QuaternionT.h \
+		$$INC_DIR/PrecisionConvert.h \
+		$$INC_DIR/BatchQuaternion.h \
+		$$INC_DIR/TransformHierarchy.h \
+		$$INC_DIR/TransformPool.h \
+		$$INC_DIR/Frustum.h \
+		$$INC_DIR/OcclusionBuffer.h \
+		$$INC_DIR/MeshBVH.h \
+		$$INC_DIR/SceneBVH.h \
+		$$INC_DIR/Bounds3.h \
+		$$INC_DIR/BoundingSphere.h \
+		$$INC_DIR/OBB.h \
+		$$INC_DIR/MeshOptimizer.h \
+		$$INC_DIR/VertexPacking.h \
+		$$INC_DIR/MeshSimplify.h \
+		$$INC_DIR/LODSelector.h \
 		$$INC_DIR/Logger.h \
 		$$INC_DIR/Image.h \
     $$INC_DIR/VAOFactory.h \
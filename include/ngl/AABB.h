@@ -79,6 +79,11 @@ public :
 	// for use in frustum computations
 		Vec3 getVertexP(const Vec3 &_normal) const noexcept;
 		Vec3 getVertexN(const Vec3 &_normal) const noexcept;
+	//-------------------------------------------------------------------------------------------------------
+	/// @brief the minimum and maximum corners of the box
+	//-------------------------------------------------------------------------------------------------------
+	Vec3 getMin() const noexcept{return m_corner.toVec3();}
+	Vec3 getMax() const noexcept{return Vec3(m_corner.m_x+m_x,m_corner.m_y+m_y,m_corner.m_z+m_z);}
 private :
 	//----------------------------------------------------------------------------------------------------------------------
 	Vec4 m_corner;
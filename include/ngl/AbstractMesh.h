@@ -21,6 +21,11 @@
 // must include types.h first for Real and GLEW if required
 #include "Types.h"
 #include "BBox.h"
+#include "BoundingSphere.h"
+#include "OBB.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplify.h"
+#include "VertexPacking.h"
 #include "RibExport.h"
 #include "Texture.h"
 #include "NGLassert.h"
@@ -92,6 +97,10 @@ public :
   /// @param[in] _t the texture index
   //----------------------------------------------------------------------------------------------------------------------
   IndexRef(uint32_t _v, uint32_t _n, uint32_t _t ) noexcept :m_v(_v),m_n(_n),m_t(_t) {;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief true if all three indices match
+  //----------------------------------------------------------------------------------------------------------------------
+  bool operator==(const IndexRef &_r) const noexcept {return m_v==_r.m_v && m_n==_r.m_n && m_t==_r.m_t;}
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -128,6 +137,11 @@ public :
   /// @brief draw method to draw the obj as a VBO. The VBO first needs to be created using the CreateVBO method
   //----------------------------------------------------------------------------------------------------------------------
   void draw() const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief draw one level of detail, the full mesh is drawn if there are no LODs in the VAO
+  /// @param[in] _level the level, clamped to the last one
+  //----------------------------------------------------------------------------------------------------------------------
+  void drawLOD(size_t _level) const noexcept;
 
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief load int a texture and set it as the active texture of the Obj
@@ -142,14 +156,25 @@ public :
   //----------------------------------------------------------------------------------------------------------------------
   void scale( Real _sx, Real _sy, Real _sz ) noexcept;
   //----------------------------------------------------------------------------------------------------------------------
-  /// @brief a method to set the BBox and center
+  /// @brief a method to set the BBox and center, the extents are a simd min / max over the vertices split
+  /// over threads for large meshes
   //----------------------------------------------------------------------------------------------------------------------
   void calcDimensions() noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief a method to caluculate the bounding Sphere will set
-  /// m_sphereCenter and m_sphereRadius
+  /// m_sphereCenter and m_sphereRadius, the same as calcBoundingSphere(BoundingSphere::Fit::RITTER)
   //----------------------------------------------------------------------------------------------------------------------
   void calcBoundingSphere() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a method to caluculate the bounding Sphere will set
+  /// m_sphereCenter and m_sphereRadius (both 0 if there are no vertices)
+  /// @param[in] _fit how tight a sphere to fit, see BoundingSphere::Fit
+  //----------------------------------------------------------------------------------------------------------------------
+  void calcBoundingSphere(BoundingSphere::Fit _fit) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief fit an oriented box to the vertices along their principal axes, sets m_obb
+  //----------------------------------------------------------------------------------------------------------------------
+  void calcOBB() noexcept;
 
   //----------------------------------------------------------------------------------------------------------------------
   /// method to write out the obj mesh to a renderman sub div
@@ -158,17 +183,78 @@ public :
   void writeToRibSubdiv( RibExport& _ribFile) const noexcept;
 
   //----------------------------------------------------------------------------------------------------------------------
-  //// @brief create a VAO from the current mesh data
+  //// @brief create a VAO from the current mesh data, the same as createVAO(false)
   //----------------------------------------------------------------------------------------------------------------------
   virtual void createVAO() noexcept;
   //----------------------------------------------------------------------------------------------------------------------
+  //// @brief create a VAO from the current mesh data
+  /// @param[in] _indexed if false every face corner gets its own vertex and the VAO is drawn as a triangle
+  /// soup. If true corners with the same (vert, normal, tex) indices are welded into one vertex and drawn
+  /// through an index buffer, 16 bit if there are no more than 65536 vertices and 32 bit otherwise, which
+  /// on closed meshes has around a sixth of the vertices. Either way getIndices() gives the IndexRef of
+  /// each vertex in the VAO and, when indexed, m_outIndices holds the index buffer. An indexed VAO uses the
+  /// indices from weldVertices / optimizeIndices if they have been called, and is optimised first if
+  /// setOptimizeOnCreate is set.
+  //----------------------------------------------------------------------------------------------------------------------
+  void createVAO(bool _indexed) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief weld the face corners with the same (vert, normal, tex) indices into one vertex, fills
+  /// m_indices with the unique vertices and m_outIndices with the triangle list in face order
+  //----------------------------------------------------------------------------------------------------------------------
+  void weldVertices() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief reorder the welded triangles for the vertex cache then overdraw, and the vertices into the
+  /// order they are first used (see MeshOptimizer.h), welding first if needed. Call after loading and
+  /// before createVAO(true), use getCacheStats before and after to see the gain. Does nothing once buildLODs
+  /// has been called.
+  //----------------------------------------------------------------------------------------------------------------------
+  void optimizeIndices() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief have createVAO(true) call optimizeIndices if it has not been
+  //----------------------------------------------------------------------------------------------------------------------
+  void setOptimizeOnCreate(bool _optimize) noexcept {m_optimizeOnCreate=_optimize;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief simplify the welded mesh into a chain of LODs (see MeshSimplify.h) which createVAO(true) puts in
+  /// one index buffer after the full mesh, all the levels share the vertices. Each level is reordered for
+  /// the vertex cache. Call after loading (and optimizeIndices if wanted) and before createVAO(true),
+  /// welding again drops the LODs.
+  /// @param[in] _levels the most levels to build including the full mesh
+  /// @param[in] _ratio the fraction of triangles kept from one level to the next
+  /// @param[in] _options the simplification settings
+  //----------------------------------------------------------------------------------------------------------------------
+  void buildLODs(size_t _levels, Real _ratio=0.5f, const SimplifyOptions &_options=SimplifyOptions());
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the LOD levels from buildLODs, empty if it has not been called
+  //----------------------------------------------------------------------------------------------------------------------
+  const std::vector<MeshLOD> &getLODs() const noexcept {return m_lods;}
+  size_t getNumLODs() const noexcept {return m_lods.empty() ? 1 : m_lods.size();}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the vertex cache ACMR / ATVR of the current triangle order of the full mesh (LOD 0), every corner
+  /// misses if the mesh has not been welded
+  /// @param[in] _cacheSize the fifo cache size to simulate
+  //----------------------------------------------------------------------------------------------------------------------
+  VertexCacheStats getCacheStats(unsigned int _cacheSize=c_vertexCacheSize) const;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the vertex format used by the next createVAO, the default is all floats. Packed layouts
+  /// (for example VertexLayout::compact() at 16 bytes against 32) need shaders that take the attributes as
+  /// they are stored, see VertexPacking.h. Saving a bin mesh is only supported for the default layout and
+  /// NCCAPointBake needs float positions.
+  //----------------------------------------------------------------------------------------------------------------------
+  void setVertexLayout(const VertexLayout &_layout) noexcept {m_vertexLayout=_layout;}
+  const VertexLayout &getVertexLayout() const noexcept {return m_vertexLayout;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the matrix to apply to UNORM16 positions before the model matrix to get the mesh positions back,
+  /// identity for the other layouts. Only valid after createVAO.
+  //----------------------------------------------------------------------------------------------------------------------
+  Mat4 getPositionDequantize() const noexcept {return m_vertexLayout.dequantize(m_quantBounds);}
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief get the texture id
   /// @returns the texture id
   //----------------------------------------------------------------------------------------------------------------------
   unsigned int getTextureID() const  noexcept{ return m_textureID; }
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief map the VBO vertex data
-  /// @returns a pointer to the VBO vertex data
+  /// @returns a pointer to the VBO vertex data, interleaved as getVertexLayout() describes
   //----------------------------------------------------------------------------------------------------------------------
   Real *mapVAOVerts() noexcept;
   //----------------------------------------------------------------------------------------------------------------------
@@ -178,13 +264,14 @@ public :
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief get a pointer to the indices used to represent the VBO data, this is used in the clip
   /// class when re-ordering the clip data values
-  /// @returns the array of indices
+  /// @returns the array of indices, one per vertex in the VAO in the order of the buffer
   //----------------------------------------------------------------------------------------------------------------------
   const std::vector<IndexRef> & getIndices()  noexcept{ return m_indices; }
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief save the mesh as NCCA Binary VBO format
   /// basically this format is the processed binary vbo mesh data as
-  /// as packed by the CreateVBO() method is called.
+  /// as packed by the CreateVBO() method is called. Only the float vertex layout and an unindexed VAO can
+  /// be saved.
   //----------------------------------------------------------------------------------------------------------------------
   void saveNCCABinaryMesh( const std::string &_fname ) noexcept;
   //----------------------------------------------------------------------------------------------------------------------
@@ -194,6 +281,10 @@ public :
 
   BBox &getBBox() noexcept{ return *m_ext;  }
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the extents of the mesh as plain bounds, cheap to copy into culling or spatial structures
+  //----------------------------------------------------------------------------------------------------------------------
+  const Bounds3 &getBounds() const noexcept{ return m_bounds;  }
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief accessor for the vertex data
   /// @returns a std::vector containing the vert data
   //----------------------------------------------------------------------------------------------------------------------
@@ -249,6 +340,10 @@ public :
   //----------------------------------------------------------------------------------------------------------------------
   Real getSphereRadius() const  noexcept{return m_sphereRadius;}
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief accesor to get the oriented box, only valid after calcOBB
+  //----------------------------------------------------------------------------------------------------------------------
+  const OBB &getOBB() const  noexcept{return m_obb;}
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief accesor to get the center
   //----------------------------------------------------------------------------------------------------------------------
   Vec3 getCenter() const  noexcept{return m_center;}
@@ -261,6 +356,10 @@ public :
 protected :
   friend class NCCAPointBake;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the IndexRef of corner _j of a face, with the normal and tex indices 0 if the mesh has none
+  //----------------------------------------------------------------------------------------------------------------------
+  IndexRef faceCorner(const Face &_f, unsigned int _j) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief The number of vertices in the object
   unsigned int m_nVerts;
   //----------------------------------------------------------------------------------------------------------------------
@@ -300,10 +399,35 @@ protected :
   //----------------------------------------------------------------------------------------------------------------------
   std::vector<IndexRef> m_indices;
   //----------------------------------------------------------------------------------------------------------------------
-  /// @brief a vectr of indices without duplicates which are actually passed to the VBO when creating
+  /// @brief a vectr of indices without duplicates which are actually passed to the VBO when creating, the
+  /// index of each triangle corner into m_indices for an indexed VAO (empty otherwise)
   //----------------------------------------------------------------------------------------------------------------------
   std::vector<GLuint> m_outIndices;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set by optimizeIndices and cleared when the vertices are welded again
+  //----------------------------------------------------------------------------------------------------------------------
+  bool m_indicesOptimized=false;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief if createVAO(true) should optimise the indices
+  //----------------------------------------------------------------------------------------------------------------------
+  bool m_optimizeOnCreate=false;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the range of m_outIndices for each level from buildLODs, level 0 is the full mesh
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<MeshLOD> m_lods;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief if the VAO was built with an index buffer, needed to draw the LOD ranges and refused when saving
+  //----------------------------------------------------------------------------------------------------------------------
+  bool m_vaoIndexed=false;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the vertex format createVAO builds
+  //----------------------------------------------------------------------------------------------------------------------
+  VertexLayout m_vertexLayout;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the box the VAO positions were quantised in
+  //----------------------------------------------------------------------------------------------------------------------
+  Bounds3 m_quantBounds;
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief the size of the index array
   //----------------------------------------------------------------------------------------------------------------------
   size_t m_indexSize;
@@ -365,6 +489,10 @@ protected :
   //----------------------------------------------------------------------------------------------------------------------
   std::unique_ptr <BBox> m_ext;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief  the same extents as m_ext without any drawing state
+  //----------------------------------------------------------------------------------------------------------------------
+  Bounds3 m_bounds;
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief  determines if the data is Packed as either TRI or QUAD
   //----------------------------------------------------------------------------------------------------------------------
   GLuint m_dataPackType;
@@ -390,6 +518,10 @@ protected :
   /// @brief  the radius of the bounding sphere
   //----------------------------------------------------------------------------------------------------------------------
   Real m_sphereRadius;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief  the oriented box set by calcOBB
+  //----------------------------------------------------------------------------------------------------------------------
+  OBB m_obb;
 
 };
 
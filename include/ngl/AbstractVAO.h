@@ -85,6 +85,12 @@ class NGL_DLLEXPORT AbstractVAO
     //----------------------------------------------------------------------------------------------------------------------
     void setVertexAttributePointer(GLuint _id, GLint _size, GLenum _type, GLsizei _stride, unsigned int _dataOffset, bool _normalise=false );
     //----------------------------------------------------------------------------------------------------------------------
+    /// @brief as above with the offset in bytes, for packed vertices where the attributes are not all floats
+    /// (for example GL_HALF_FLOAT, normalised GL_SHORT or GL_INT_2_10_10_10_REV)
+    /// @param _byteOffset the offset of the first component from the start of the buffer in bytes
+    //----------------------------------------------------------------------------------------------------------------------
+    void setVertexAttributePointerBytes(GLuint _id, GLint _size, GLenum _type, GLsizei _stride, size_t _byteOffset, bool _normalise=false );
+    //----------------------------------------------------------------------------------------------------------------------
     /// @brief the number of indices to draw in the array. It may be that the draw routine can overide this at another time.
     /// @param _s the number of indices to draw (from 0)
     //----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,96 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef ALIGNEDALLOCATOR_H_
+#define ALIGNEDALLOCATOR_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file AlignedAllocator.h
+/// @brief a minimal std allocator returning memory aligned for simd loads
+//----------------------------------------------------------------------------------------------------------------------
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#ifdef _MSC_VER
+  #include <malloc.h>
+#endif
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @class AlignedAllocator "include/AlignedAllocator.h"
+/// @brief allocator for use with std::vector etc so the data starts on an ALIGN byte boundary
+/// (32 by default which is enough for AVX registers)
+/// @version 1.0
+/// @date 16/10/16
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T, size_t ALIGN=32>
+class AlignedAllocator
+{
+public :
+  using value_type=T;
+  template <typename U> struct rebind { using other=AlignedAllocator<U,ALIGN>; };
+
+  AlignedAllocator() noexcept=default;
+  template <typename U> AlignedAllocator(const AlignedAllocator<U,ALIGN> &) noexcept {}
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief allocate space for _n objects
+  /// @param[in] _n the number of objects
+  /// @returns the aligned memory, throws std::bad_alloc on failure as std::allocator does
+  //----------------------------------------------------------------------------------------------------------------------
+  T *allocate(size_t _n)
+  {
+    if(_n==0)
+    {
+      return nullptr;
+    }
+    void *p=nullptr;
+#ifdef _MSC_VER
+    p=_aligned_malloc(_n*sizeof(T),ALIGN);
+#else
+    if(posix_memalign(&p,ALIGN,_n*sizeof(T)) !=0)
+    {
+      p=nullptr;
+    }
+#endif
+    if(p==nullptr)
+    {
+      throw std::bad_alloc();
+    }
+    return static_cast<T *>(p);
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief release memory from allocate
+  /// @param[in] _p the memory to free
+  //----------------------------------------------------------------------------------------------------------------------
+  void deallocate(T *_p, size_t) noexcept
+  {
+#ifdef _MSC_VER
+    _aligned_free(_p);
+#else
+    free(_p);
+#endif
+  }
+};
+
+template <typename T, typename U, size_t ALIGN>
+bool operator==(const AlignedAllocator<T,ALIGN> &, const AlignedAllocator<U,ALIGN> &) noexcept { return true; }
+template <typename T, typename U, size_t ALIGN>
+bool operator!=(const AlignedAllocator<T,ALIGN> &, const AlignedAllocator<U,ALIGN> &) noexcept { return false; }
+
+} // end namespace ngl
+
+#endif
@@ -22,6 +22,7 @@
 #include "Types.h"
 #include "Vec3.h"
 #include "Vec4.h"
+#include "Bounds3.h"
 #include "AbstractVAO.h"
 #include <memory>
 
@@ -61,6 +62,11 @@ public :
   //----------------------------------------------------------------------------------------------------------------------
   BBox(Real _minX,Real _maxX,Real _minY,Real _maxY,Real _minZ,Real _maxZ) noexcept;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor from plain bounds
+  /// @param[in] _b the extents of the box
+  //----------------------------------------------------------------------------------------------------------------------
+  explicit BBox(const Bounds3 &_b) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief Default constructor will create a BBox centered at point 0,0,0
   /// With Unit length width and height (== 1)
   //----------------------------------------------------------------------------------------------------------------------
@@ -72,9 +78,10 @@ public :
   BBox(const BBox &_b) noexcept;
   BBox& operator=(const BBox &_other);
   //----------------------------------------------------------------------------------------------------------------------
-  /// @brief Draw Method draws the BBox using OpenGL
+  /// @brief Draw Method draws the BBox using OpenGL, the VAO is only built (or rebuilt after a change) here so
+  /// a BBox that is never drawn has no GL state. Not noexcept as building the VAO allocates
   //----------------------------------------------------------------------------------------------------------------------
-  void draw() const noexcept;
+  void draw() const;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief reset the draw mode for the BBox
   /// @param[in] _mode the mode to draw
@@ -110,6 +117,10 @@ public :
    //----------------------------------------------------------------------------------------------------------------------
    Real maxZ()const noexcept{ return m_maxZ;}
    //----------------------------------------------------------------------------------------------------------------------
+   /// @brief the extents as plain bounds
+   //----------------------------------------------------------------------------------------------------------------------
+   Bounds3 getBounds() const noexcept;
+   //----------------------------------------------------------------------------------------------------------------------
    /// @brief This is the center of the BBox stored for caluculations in other classes s
    //----------------------------------------------------------------------------------------------------------------------
    Vec3 center()const noexcept{ return m_center; }
@@ -166,9 +177,13 @@ public :
 protected :
 
   //----------------------------------------------------------------------------------------------------------------------
-  /// @brief method used to set the vao
+  /// @brief flag the vao to be rebuilt from the vertices the next time the box is drawn
   //----------------------------------------------------------------------------------------------------------------------
-  void setVAO();
+  void setVAO() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief create the vao from the vertices, called by draw
+  //----------------------------------------------------------------------------------------------------------------------
+  void buildVAO() const;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief Contains the   8 vertices for the BBox aranged from v[0] = Left-top-Max Z
   ///and then rotating clock wise for the top of the BBox
@@ -223,7 +238,11 @@ protected :
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief a pointer to the VAO buffer used for drawing the bbox
   //----------------------------------------------------------------------------------------------------------------------
-  std::unique_ptr< AbstractVAO >m_vao;
+  mutable std::unique_ptr< AbstractVAO >m_vao;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set when the vertices or draw mode change so draw rebuilds the vao
+  //----------------------------------------------------------------------------------------------------------------------
+  mutable bool m_vaoDirty=true;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief sets the draw mode for the BBox Faces,  set to GL_LINE for
   ///  line faces and GL_FILL for filled
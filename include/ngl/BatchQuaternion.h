@@ -0,0 +1,77 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef BATCHQUATERNION_H_
+#define BATCHQUATERNION_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file BatchQuaternion.h
+/// @brief blend, multiply and convert whole arrays of quaternions in one call, for example all the joints
+/// of a skeleton or a crowd
+/// @note these give the same results as the Quaternion methods of the same name (to float rounding, slerp
+/// uses polynomial acos and sin in the simd path with an error below 1e-6). The input and output arrays may
+/// be the same but must not otherwise overlap. Large inputs are split across several threads.
+//----------------------------------------------------------------------------------------------------------------------
+#include "Types.h"
+#include <cstddef>
+
+namespace ngl
+{
+class Quaternion;
+class Mat3;
+class Mat4;
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief spherical linear interpolation of each pair _a[i] _b[i], as Quaternion::slerp this takes the
+/// shortest path and the result is not re-normalised
+/// @param[in] _a the array of start rotations
+/// @param[in] _b the array of end rotations
+/// @param[in] _count the number of elements in _a and _b
+/// @param[in] _t the blend value 0-1 used for every element, or an array of _count blend values
+/// @param[out] o_out the array to write the _count blended rotations to
+//----------------------------------------------------------------------------------------------------------------------
+extern NGL_DLLEXPORT void slerpQuaternions(const Quaternion *_a, const Quaternion *_b, size_t _count, Real _t, Quaternion *o_out) noexcept;
+extern NGL_DLLEXPORT void slerpQuaternions(const Quaternion *_a, const Quaternion *_b, size_t _count, const Real *_t, Quaternion *o_out) noexcept;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief normalised linear interpolation of each pair _a[i] _b[i] taking the shortest path, this is much cheaper
+/// than slerp and close enough for small angles such as blending animation frames
+/// @param[in] _a the array of start rotations
+/// @param[in] _b the array of end rotations
+/// @param[in] _count the number of elements in _a and _b
+/// @param[in] _t the blend value 0-1 used for every element, or an array of _count blend values
+/// @param[out] o_out the array to write the _count unit length blended rotations to
+//----------------------------------------------------------------------------------------------------------------------
+extern NGL_DLLEXPORT void nlerpQuaternions(const Quaternion *_a, const Quaternion *_b, size_t _count, Real _t, Quaternion *o_out) noexcept;
+extern NGL_DLLEXPORT void nlerpQuaternions(const Quaternion *_a, const Quaternion *_b, size_t _count, const Real *_t, Quaternion *o_out) noexcept;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the products _a[i]*_b[i]
+/// @param[in] _a the array of left hand rotations
+/// @param[in] _b the array of right hand rotations
+/// @param[in] _count the number of elements in _a and _b
+/// @param[out] o_out the array to write the _count products to
+//----------------------------------------------------------------------------------------------------------------------
+extern NGL_DLLEXPORT void multiplyQuaternions(const Quaternion *_a, const Quaternion *_b, size_t _count, Quaternion *o_out) noexcept;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief convert to rotation matrices, the same as Quaternion::toMat4 or the upper 3x3 of it for Mat3
+/// @param[in] _q the array of rotations, these should be unit length
+/// @param[in] _count the number of elements in _q
+/// @param[out] o_out the array to write the _count matrices to
+//----------------------------------------------------------------------------------------------------------------------
+extern NGL_DLLEXPORT void quaternionsToMat4(const Quaternion *_q, size_t _count, Mat4 *o_out) noexcept;
+extern NGL_DLLEXPORT void quaternionsToMat3(const Quaternion *_q, size_t _count, Mat3 *o_out) noexcept;
+
+} // end namespace ngl
+
+#endif
@@ -0,0 +1,83 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef BATCHTRANSFORM_H_
+#define BATCHTRANSFORM_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file BatchTransform.h
+/// @brief transform whole arrays of points / vectors / normals by a Mat4 in one call
+/// @note all of these use the same convention as Vec4 * Mat4 (and the matrices built by Transformation)
+/// so the translation is taken from m_30, m_31, m_32. The input and output arrays may be the same but
+/// must not otherwise overlap. Large inputs are split across several threads.
+//----------------------------------------------------------------------------------------------------------------------
+#include "Types.h"
+#include <cstddef>
+
+namespace ngl
+{
+class Mat4;
+class Vec3;
+class Vec4;
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief transform points (w=1) by the matrix, for Vec4 input the full homogeneous product is
+/// used with the input w value and no divide is done
+/// @param[in] _m the matrix to transform by
+/// @param[in] _in the array of points to transform
+/// @param[in] _count the number of points in _in
+/// @param[out] o_out the array to write the _count transformed points to
+//----------------------------------------------------------------------------------------------------------------------
+extern NGL_DLLEXPORT void transformPoints(const Mat4 &_m, const Vec3 *_in, size_t _count, Vec3 *o_out) noexcept;
+extern NGL_DLLEXPORT void transformPoints(const Mat4 &_m, const Vec4 *_in, size_t _count, Vec4 *o_out) noexcept;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief transform points writing the result as separate x,y,z (and w) arrays
+/// @param[in] _m the matrix to transform by
+/// @param[in] _in the array of points to transform
+/// @param[in] _count the number of points in _in
+/// @param[out] o_x array of _count values for the x components
+/// @param[out] o_y array of _count values for the y components
+/// @param[out] o_z array of _count values for the z components
+/// @param[out] o_w array of _count values for the w components
+//----------------------------------------------------------------------------------------------------------------------
+extern NGL_DLLEXPORT void transformPoints(const Mat4 &_m, const Vec3 *_in, size_t _count, Real *o_x, Real *o_y, Real *o_z) noexcept;
+extern NGL_DLLEXPORT void transformPoints(const Mat4 &_m, const Vec4 *_in, size_t _count, Real *o_x, Real *o_y, Real *o_z, Real *o_w) noexcept;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief transform directions (w=0) by the matrix so the translation is ignored, Vec4 output has w set to 0
+/// @param[in] _m the matrix to transform by
+/// @param[in] _in the array of vectors to transform
+/// @param[in] _count the number of vectors in _in
+/// @param[out] o_out the array to write the _count transformed vectors to
+//----------------------------------------------------------------------------------------------------------------------
+extern NGL_DLLEXPORT void transformVectors(const Mat4 &_m, const Vec3 *_in, size_t _count, Vec3 *o_out) noexcept;
+extern NGL_DLLEXPORT void transformVectors(const Mat4 &_m, const Vec4 *_in, size_t _count, Vec4 *o_out) noexcept;
+extern NGL_DLLEXPORT void transformVectors(const Mat4 &_m, const Vec3 *_in, size_t _count, Real *o_x, Real *o_y, Real *o_z) noexcept;
+extern NGL_DLLEXPORT void transformVectors(const Mat4 &_m, const Vec4 *_in, size_t _count, Real *o_x, Real *o_y, Real *o_z) noexcept;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief transform normals by the inverse transpose of the upper 3x3 of the matrix and re-normalize them,
+/// zero length normals are left as zero. Vec4 output has w set to 0
+/// @param[in] _m the matrix to transform by
+/// @param[in] _in the array of normals to transform
+/// @param[in] _count the number of normals in _in
+/// @param[out] o_out the array to write the _count transformed normals to
+//----------------------------------------------------------------------------------------------------------------------
+extern NGL_DLLEXPORT void transformNormals(const Mat4 &_m, const Vec3 *_in, size_t _count, Vec3 *o_out) noexcept;
+extern NGL_DLLEXPORT void transformNormals(const Mat4 &_m, const Vec4 *_in, size_t _count, Vec4 *o_out) noexcept;
+extern NGL_DLLEXPORT void transformNormals(const Mat4 &_m, const Vec3 *_in, size_t _count, Real *o_x, Real *o_y, Real *o_z) noexcept;
+extern NGL_DLLEXPORT void transformNormals(const Mat4 &_m, const Vec4 *_in, size_t _count, Real *o_x, Real *o_y, Real *o_z) noexcept;
+
+} // end namespace ngl
+
+#endif
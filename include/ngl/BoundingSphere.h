@@ -0,0 +1,142 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef BOUNDINGSPHERE_H_
+#define BOUNDINGSPHERE_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file BoundingSphere.h
+/// @brief a plain centre and radius sphere with no drawing state
+//----------------------------------------------------------------------------------------------------------------------
+#include "Types.h"
+#include "Vec3.h"
+#include "Mat4.h"
+#include "Bounds3.h"
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @class BoundingSphere "include/ngl/BoundingSphere.h"
+/// @brief a bounding sphere as a value type to go with Bounds3, the default sphere is empty (a negative radius)
+/// so extending or merging into it gives the other bounds.
+/// @version 1.0
+/// @date 16/10/16
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT BoundingSphere
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief how fromPoints fits the sphere
+  /// RITTER one pass of Ritter's method started from the most separated pair of axis extremes, quick but
+  /// usually 5-20% larger than needed
+  /// ITERATIVE_RITTER Ritter's method then a few passes that shrink the sphere and regrow it over the points in
+  /// a different order keeping the smallest (Ericson, Real-Time Collision Detection 4.3.4), close to minimal
+  /// WELZL the exact minimum sphere using Welzl's algorithm with move to front, expected linear time but
+  /// single threaded and needs a copy of the points
+  //----------------------------------------------------------------------------------------------------------------------
+  enum class Fit : char {RITTER, ITERATIVE_RITTER, WELZL};
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief default ctor an empty sphere
+  //----------------------------------------------------------------------------------------------------------------------
+  BoundingSphere() noexcept : m_center(0.0f,0.0f,0.0f), m_radius(-1.0f) {}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor from a centre and radius
+  //----------------------------------------------------------------------------------------------------------------------
+  BoundingSphere(const Vec3 &_center, Real _radius) noexcept : m_center(_center), m_radius(_radius) {}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the sphere through the corners of a box
+  //----------------------------------------------------------------------------------------------------------------------
+  static BoundingSphere fromBounds(const Bounds3 &_b) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a sphere around some points, empty if there are none. Whatever the fit the radius is finally set
+  /// to the distance of the furthest point from the centre (over threads for large arrays) so every point is
+  /// inside
+  /// @param[in] _points the points
+  /// @param[in] _count the number of points
+  /// @param[in] _fit the method used
+  //----------------------------------------------------------------------------------------------------------------------
+  static BoundingSphere fromPoints(const Vec3 *_points, size_t _count, Fit _fit=Fit::ITERATIVE_RITTER);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief true if the sphere has no points in it
+  //----------------------------------------------------------------------------------------------------------------------
+  bool isEmpty() const noexcept {return m_radius<0.0f;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the box around the sphere
+  //----------------------------------------------------------------------------------------------------------------------
+  Bounds3 bounds() const noexcept
+  {
+    Vec3 r(m_radius,m_radius,m_radius);
+    return Bounds3(m_center-r,m_center+r);
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief grow the sphere the least amount to hold a point or another sphere, the centre moves toward it
+  //----------------------------------------------------------------------------------------------------------------------
+  void extend(const Vec3 &_p) noexcept;
+  void merge(const BoundingSphere &_s) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief true if a point or sphere is inside this one
+  //----------------------------------------------------------------------------------------------------------------------
+  bool contains(const Vec3 &_p) const noexcept
+  {
+    return (_p-m_center).lengthSquared()<=m_radius*m_radius;
+  }
+  bool contains(const BoundingSphere &_s) const noexcept
+  {
+    Real r=m_radius-_s.m_radius;
+    return r>=0.0f && (_s.m_center-m_center).lengthSquared()<=r*r;
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief true if this sphere overlaps another sphere or a box
+  //----------------------------------------------------------------------------------------------------------------------
+  bool intersects(const BoundingSphere &_s) const noexcept
+  {
+    Real r=m_radius+_s.m_radius;
+    return (_s.m_center-m_center).lengthSquared()<=r*r;
+  }
+  bool intersects(const Bounds3 &_b) const noexcept {return _b.distanceSquared(m_center)<=m_radius*m_radius;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief intersect a ray with the sphere
+  /// @param[in] _origin the start of the ray
+  /// @param[in] _dir the direction of the ray, need not be unit length
+  /// @param[in] _tMax the end of the ray in multiples of the direction
+  /// @param[out] o_t where the ray enters the sphere, 0 if it starts inside
+  /// @returns true if the ray hits the sphere between 0 and _tMax
+  //----------------------------------------------------------------------------------------------------------------------
+  bool intersectRay(const Vec3 &_origin, const Vec3 &_dir, Real _tMax, Real &o_t) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the sphere around this one after a transform, the radius is scaled by the largest axis scale so
+  /// it still holds everything under a non uniform scale
+  /// @param[in] _m the matrix, points are transformed as p * _m
+  //----------------------------------------------------------------------------------------------------------------------
+  BoundingSphere transformed(const Mat4 &_m) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief transform an array of spheres by the same matrix
+  /// @param[out] o_out the transformed spheres, may be the same array as _in
+  //----------------------------------------------------------------------------------------------------------------------
+  static void transform(const BoundingSphere *_in, size_t _count, const Mat4 &_m, BoundingSphere *o_out) noexcept;
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the centre
+  //----------------------------------------------------------------------------------------------------------------------
+  Vec3 m_center;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the radius, negative for an empty sphere
+  //----------------------------------------------------------------------------------------------------------------------
+  Real m_radius;
+};
+
+} // end namespace ngl
+
+#endif
@@ -0,0 +1,199 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef BOUNDS3_H_
+#define BOUNDS3_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file Bounds3.h
+/// @brief a plain min / max box with no drawing state
+//----------------------------------------------------------------------------------------------------------------------
+#include "Types.h"
+#include "Vec3.h"
+#include "Mat4.h"
+#include <algorithm>
+#include <limits>
+
+namespace ngl
+{
+class BoundingSphere;
+//----------------------------------------------------------------------------------------------------------------------
+/// @class Bounds3 "include/ngl/Bounds3.h"
+/// @brief an axis aligned box held as just its min and max corners, unlike BBox it has no VAO or vertex arrays
+/// so it can be copied around freely, kept in arrays and processed in bulk. The default box is empty (min
+/// greater than max) so extending or merging into it gives the other bounds.
+/// Transforming by a matrix uses Arvo's method ("Transforming Axis-Aligned Bounding Boxes", Graphics Gems
+/// 1990) which gives the box of the transformed box without transforming its 8 corners.
+/// @version 1.0
+/// @date 16/10/16
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT Bounds3
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief default ctor an empty box
+  //----------------------------------------------------------------------------------------------------------------------
+  Bounds3() noexcept :
+    m_min(std::numeric_limits<Real>::max(),std::numeric_limits<Real>::max(),std::numeric_limits<Real>::max()),
+    m_max(-std::numeric_limits<Real>::max(),-std::numeric_limits<Real>::max(),-std::numeric_limits<Real>::max())
+  {}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor from the corners
+  /// @param[in] _min the minimum corner
+  /// @param[in] _max the maximum corner
+  //----------------------------------------------------------------------------------------------------------------------
+  Bounds3(const Vec3 &_min, const Vec3 &_max) noexcept : m_min(_min), m_max(_max) {}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the box around some points, empty if there are none. The points are read 4 at a time and large
+  /// arrays are split over threads
+  /// @param[in] _points the points
+  /// @param[in] _count the number of points
+  //----------------------------------------------------------------------------------------------------------------------
+  static Bounds3 fromPoints(const Vec3 *_points, size_t _count) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief true if the box has no points in it
+  //----------------------------------------------------------------------------------------------------------------------
+  bool isEmpty() const noexcept
+  {
+    return m_min.m_x>m_max.m_x || m_min.m_y>m_max.m_y || m_min.m_z>m_max.m_z;
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the centre, size and half size of the box
+  //----------------------------------------------------------------------------------------------------------------------
+  Vec3 center() const noexcept
+  {
+    return Vec3((m_min.m_x+m_max.m_x)*0.5f,(m_min.m_y+m_max.m_y)*0.5f,(m_min.m_z+m_max.m_z)*0.5f);
+  }
+  Vec3 size() const noexcept {return Vec3(m_max.m_x-m_min.m_x,m_max.m_y-m_min.m_y,m_max.m_z-m_min.m_z);}
+  Vec3 halfSize() const noexcept {return size()*0.5f;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the surface area of the box
+  //----------------------------------------------------------------------------------------------------------------------
+  Real surfaceArea() const noexcept
+  {
+    Vec3 s=size();
+    return 2.0f*(s.m_x*s.m_y + s.m_y*s.m_z + s.m_z*s.m_x);
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief grow the box to hold a point
+  /// @param[in] _p the point
+  //----------------------------------------------------------------------------------------------------------------------
+  void extend(const Vec3 &_p) noexcept
+  {
+    m_min.set(std::min(m_min.m_x,_p.m_x),std::min(m_min.m_y,_p.m_y),std::min(m_min.m_z,_p.m_z));
+    m_max.set(std::max(m_max.m_x,_p.m_x),std::max(m_max.m_y,_p.m_y),std::max(m_max.m_z,_p.m_z));
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief grow the box to hold another box
+  /// @param[in] _b the box
+  //----------------------------------------------------------------------------------------------------------------------
+  void merge(const Bounds3 &_b) noexcept
+  {
+    m_min.set(std::min(m_min.m_x,_b.m_min.m_x),std::min(m_min.m_y,_b.m_min.m_y),std::min(m_min.m_z,_b.m_min.m_z));
+    m_max.set(std::max(m_max.m_x,_b.m_max.m_x),std::max(m_max.m_y,_b.m_max.m_y),std::max(m_max.m_z,_b.m_max.m_z));
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the box around an array of boxes, empty if there are none
+  /// @param[in] _bounds the boxes
+  /// @param[in] _count the number of boxes
+  //----------------------------------------------------------------------------------------------------------------------
+  static Bounds3 merge(const Bounds3 *_bounds, size_t _count) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the box grown by _amount on every side
+  //----------------------------------------------------------------------------------------------------------------------
+  Bounds3 expanded(Real _amount) const noexcept
+  {
+    Vec3 a(_amount,_amount,_amount);
+    return Bounds3(m_min-a,m_max+a);
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief true if a point or box is inside this one, touching counts as inside
+  //----------------------------------------------------------------------------------------------------------------------
+  bool contains(const Vec3 &_p) const noexcept
+  {
+    return _p.m_x>=m_min.m_x && _p.m_x<=m_max.m_x &&
+           _p.m_y>=m_min.m_y && _p.m_y<=m_max.m_y &&
+           _p.m_z>=m_min.m_z && _p.m_z<=m_max.m_z;
+  }
+  bool contains(const Bounds3 &_b) const noexcept
+  {
+    return _b.m_min.m_x>=m_min.m_x && _b.m_max.m_x<=m_max.m_x &&
+           _b.m_min.m_y>=m_min.m_y && _b.m_max.m_y<=m_max.m_y &&
+           _b.m_min.m_z>=m_min.m_z && _b.m_max.m_z<=m_max.m_z;
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief true if this box overlaps another box or a sphere, touching counts as overlapping
+  //----------------------------------------------------------------------------------------------------------------------
+  bool intersects(const Bounds3 &_b) const noexcept
+  {
+    return m_min.m_x<=_b.m_max.m_x && m_max.m_x>=_b.m_min.m_x &&
+           m_min.m_y<=_b.m_max.m_y && m_max.m_y>=_b.m_min.m_y &&
+           m_min.m_z<=_b.m_max.m_z && m_max.m_z>=_b.m_min.m_z;
+  }
+  bool intersects(const BoundingSphere &_s) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the squared distance from a point to the nearest point of the box, 0 inside
+  //----------------------------------------------------------------------------------------------------------------------
+  Real distanceSquared(const Vec3 &_p) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief intersect a ray with the box (the slab test)
+  /// @param[in] _origin the start of the ray
+  /// @param[in] _invDir 1 / each component of the ray direction
+  /// @param[in] _tMax the end of the ray in multiples of the direction
+  /// @param[out] o_t where the ray enters the box, 0 if it starts inside
+  /// @returns true if the ray hits the box between 0 and _tMax
+  //----------------------------------------------------------------------------------------------------------------------
+  bool intersectRay(const Vec3 &_origin, const Vec3 &_invDir, Real _tMax, Real &o_t) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the box around this box after a transform
+  /// @param[in] _m the matrix, points are transformed as p * _m
+  //----------------------------------------------------------------------------------------------------------------------
+  Bounds3 transformed(const Mat4 &_m) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief transform an array of boxes by the same matrix
+  /// @param[in] _in the boxes
+  /// @param[in] _count the number of boxes
+  /// @param[in] _m the matrix
+  /// @param[out] o_out the transformed boxes, may be the same array as _in
+  //----------------------------------------------------------------------------------------------------------------------
+  static void transform(const Bounds3 *_in, size_t _count, const Mat4 &_m, Bounds3 *o_out) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief transform an array of boxes each by its own matrix, for example local mesh bounds by instance
+  /// matrices
+  /// @param[in] _in the boxes
+  /// @param[in] _matrices one matrix per box
+  /// @param[in] _count the number of boxes
+  /// @param[out] o_out the transformed boxes, may be the same array as _in
+  //----------------------------------------------------------------------------------------------------------------------
+  static void transform(const Bounds3 *_in, const Mat4 *_matrices, size_t _count, Bounds3 *o_out) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief equality using the same tolerance as Vec3
+  //----------------------------------------------------------------------------------------------------------------------
+  bool operator==(const Bounds3 &_b) const noexcept {return m_min==_b.m_min && m_max==_b.m_max;}
+  bool operator!=(const Bounds3 &_b) const noexcept {return !(*this==_b);}
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the minimum corner
+  //----------------------------------------------------------------------------------------------------------------------
+  Vec3 m_min;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the maximum corner
+  //----------------------------------------------------------------------------------------------------------------------
+  Vec3 m_max;
+};
+
+} // end namespace ngl
+
+#endif
@@ -27,13 +27,11 @@
 #include "RibExport.h"
 #include "Plane.h"
 #include "AABB.h"
+#include "Frustum.h"
 
 
 namespace ngl
 {
-//----------------------------------------------------------------------------------------------------------------------
-/// @enum used to describe intercects with fustrum
-enum  class CameraIntercept : char {OUTSIDE, INTERSECT, INSIDE};
 
 //----------------------------------------------------------------------------------------------------------------------
 /// @class Camera
@@ -258,10 +256,15 @@ public :
   //----------------------------------------------------------------------------------------------------------------------
   Real getFar() const  noexcept{return m_zFar;}
   //----------------------------------------------------------------------------------------------------------------------
-  /// @brief calculate the frustum for clipping etc
+  /// @brief calculate the frustum planes for clipping etc from the view and projection matrices
   //----------------------------------------------------------------------------------------------------------------------
   void calculateFrustum() noexcept;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief get the frustum planes set by calculateFrustum
+  /// @returns the current frustum
+  //----------------------------------------------------------------------------------------------------------------------
+  const Frustum & getFrustum() const noexcept{return m_frustum;}
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief draw the frustum for clipping etc
   //----------------------------------------------------------------------------------------------------------------------
   void drawFrustum() noexcept;
@@ -284,6 +287,23 @@ public :
   /// @returns the result of the test (inside outside intercept)
   //----------------------------------------------------------------------------------------------------------------------
   CameraIntercept boxInFrustum(const AABB &b) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief cull whole arrays of bounds against the frustum, bit i%32 of o_visible[i/32] is set if object i is
+  /// visible (not OUTSIDE), see Frustum::cullBoxes and Frustum::cullSpheres. LODSelector culls spheres and picks
+  /// a level of detail for each in the same pass.
+  /// @param[in] _min the minimum corners of the boxes
+  /// @param[in] _max the maximum corners of the boxes
+  /// @param[out] o_visible the mask, must have space for Frustum::maskWords(count) words
+  //----------------------------------------------------------------------------------------------------------------------
+  void cullBoxes(const Vec3Array &_min, const Vec3Array &_max, uint32_t *o_visible) const noexcept;
+  void cullBoxes(const AABB *_boxes, size_t _count, uint32_t *o_visible) const noexcept;
+  void cullSpheres(const Vec3Array &_centre, const Real *_radius, uint32_t *o_visible) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief as above but give the indices of the visible objects
+  /// @param[out] o_visible replaced with the visible indices
+  //----------------------------------------------------------------------------------------------------------------------
+  void cullBoxes(const Vec3Array &_min, const Vec3Array &_max, std::vector<size_t> &o_visible) const;
+  void cullSpheres(const Vec3Array &_centre, const Real *_radius, std::vector<size_t> &o_visible) const;
 
 protected :
 
@@ -354,15 +374,11 @@ protected :
   //----------------------------------------------------------------------------------------------------------------------
   Mat4 m_viewMatrix;
   //----------------------------------------------------------------------------------------------------------------------
-  ///  @brief array of planes for fustrum
-  //----------------------------------------------------------------------------------------------------------------------
-  Plane m_planes[6];
-  //----------------------------------------------------------------------------------------------------------------------
-  ///  @brief index values for the planes array
+  ///  @brief the planes of the fustrum
   //----------------------------------------------------------------------------------------------------------------------
-  enum class ProjPlane : char { TOP = 0,BOTTOM,LEFT,RIGHT,NEARP,FARP};
+  Frustum m_frustum;
   //----------------------------------------------------------------------------------------------------------------------
-  ///  @brief points for the fustrum drawing
+  ///  @brief points for the fustrum drawing, only set by drawFrustum
   //----------------------------------------------------------------------------------------------------------------------
   Vec3 m_ntl,m_ntr,m_nbl,m_nbr,m_ftl,m_ftr,m_fbl,m_fbr;
   //----------------------------------------------------------------------------------------------------------------------
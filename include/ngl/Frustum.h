@@ -0,0 +1,199 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef FRUSTUM_H_
+#define FRUSTUM_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file Frustum.h
+/// @brief the six clip planes of a view volume extracted from a view projection matrix
+//----------------------------------------------------------------------------------------------------------------------
+#include "Types.h"
+#include "Vec3.h"
+#include "Mat4.h"
+#include "Plane.h"
+#include "AABB.h"
+#include "Bounds3.h"
+#include "BoundingSphere.h"
+#include "Vec3Array.h"
+#include <cstdint>
+#include <vector>
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @enum used to describe intercects with fustrum
+//----------------------------------------------------------------------------------------------------------------------
+enum  class CameraIntercept : char {OUTSIDE, INTERSECT, INSIDE};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class Frustum "include/ngl/Frustum.h"
+/// @brief the planes of the volume clipped by a view * projection matrix, found from the rows / columns of the
+/// matrix (Gribb and Hartmann "Fast Extraction of Viewing Frustum Planes from the World-View-Projection Matrix")
+/// so perspective, ortho, shadow or any custom projection can be used. Each plane is normalised with the
+/// normal pointing into the volume and the planes are stored as separate nx, ny, nz and d arrays so they can
+/// be loaded straight into simd registers by the batch culling.
+/// The cull functions test whole arrays of bounds held as separate x, y and z arrays, 4 (SSE) or 8 (AVX) at a
+/// time and split over threads for large arrays. Each gives exactly the same answer as the single object
+/// test, an object is visible unless the single test returns OUTSIDE.
+/// @version 1.0
+/// @date 16/10/16
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT Frustum
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief index values for the planes
+  //----------------------------------------------------------------------------------------------------------------------
+  enum class ProjPlane : char { TOP = 0,BOTTOM,LEFT,RIGHT,NEARP,FARP};
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of planes
+  //----------------------------------------------------------------------------------------------------------------------
+  static constexpr size_t c_numPlanes=6;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief default ctor the planes of the clip space cube (an identity matrix)
+  //----------------------------------------------------------------------------------------------------------------------
+  Frustum() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor from a matrix
+  /// @param[in] _viewProject the view * projection matrix (in the ngl order used for Vec4 * Mat4)
+  //----------------------------------------------------------------------------------------------------------------------
+  explicit Frustum(const Mat4 &_viewProject) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief extract the planes from a matrix, clip space is the OpenGL -w to w in x, y and z
+  /// @param[in] _viewProject the view * projection matrix, use model * view * projection to get planes in
+  /// model space
+  //----------------------------------------------------------------------------------------------------------------------
+  void set(const Mat4 &_viewProject) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief get a plane as a Plane object
+  /// @param[in] _p which plane
+  //----------------------------------------------------------------------------------------------------------------------
+  Plane getPlane(ProjPlane _p) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the plane normal components and distances, each an array of c_numPlanes values in ProjPlane order
+  //----------------------------------------------------------------------------------------------------------------------
+  const Real *getNormalX() const noexcept {return m_nx;}
+  const Real *getNormalY() const noexcept {return m_ny;}
+  const Real *getNormalZ() const noexcept {return m_nz;}
+  const Real *getD() const noexcept {return m_d;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the signed distance from a plane to a point, positive inside
+  /// @param[in] _i the plane index
+  /// @param[in] _p the point
+  //----------------------------------------------------------------------------------------------------------------------
+  Real distance(size_t _i, const Vec3 &_p) const noexcept
+  {
+    return m_d[_i] + (m_nx[_i]*_p.m_x + m_ny[_i]*_p.m_y + m_nz[_i]*_p.m_z);
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief check to see if the point passed in is within the frustum
+  /// @param _p the point to check
+  /// @returns INSIDE or OUTSIDE
+  //----------------------------------------------------------------------------------------------------------------------
+  CameraIntercept isPointInFrustum(const Vec3 &_p) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief check to see if the sphere passed in is within the frustum
+  /// @param[in] _p the center of the sphere
+  /// @param[in] _radius the radius of the sphere
+  /// @returns the result of the test (inside outside intercept)
+  //----------------------------------------------------------------------------------------------------------------------
+  CameraIntercept isSphereInFrustum(const Vec3 &_p, Real _radius) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief check to see if the box passed in is within the frustum, the corner furthest along each plane
+  /// normal decides if it is outside and the nearest one if it intersects
+  /// @param[in] _min the minimum corner of the box
+  /// @param[in] _max the maximum corner of the box
+  /// @returns the result of the test (inside outside intercept)
+  //----------------------------------------------------------------------------------------------------------------------
+  CameraIntercept boxInFrustum(const Vec3 &_min, const Vec3 &_max) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief check to see if the AABB passed in is within the frustum
+  /// @param[in] _b AABB to test
+  /// @returns the result of the test (inside outside intercept)
+  //----------------------------------------------------------------------------------------------------------------------
+  CameraIntercept boxInFrustum(const AABB &_b) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief as above for plain bounds
+  //----------------------------------------------------------------------------------------------------------------------
+  CameraIntercept boxInFrustum(const Bounds3 &_b) const noexcept {return boxInFrustum(_b.m_min,_b.m_max);}
+  CameraIntercept isSphereInFrustum(const BoundingSphere &_s) const noexcept {return isSphereInFrustum(_s.m_center,_s.m_radius);}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of 32 bit words in the visibility mask for _count objects
+  //----------------------------------------------------------------------------------------------------------------------
+  static size_t maskWords(size_t _count) noexcept {return (_count+31)/32;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief cull an array of boxes, bit i%32 of o_visible[i/32] is set if box i is visible, unused bits in the
+  /// last word are cleared
+  /// @param[in] _min the minimum corners of the boxes
+  /// @param[in] _max the maximum corners of the boxes, must be the same size as _min
+  /// @param[out] o_visible the mask, must have space for maskWords(_min.size()) words
+  //----------------------------------------------------------------------------------------------------------------------
+  void cullBoxes(const Vec3Array &_min, const Vec3Array &_max, uint32_t *o_visible) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief cull an array of AABB, each block of 32 is copied into separate arrays before testing
+  /// @param[in] _boxes the boxes
+  /// @param[in] _count the number of boxes
+  /// @param[out] o_visible the mask, must have space for maskWords(_count) words
+  //----------------------------------------------------------------------------------------------------------------------
+  void cullBoxes(const AABB *_boxes, size_t _count, uint32_t *o_visible) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief cull an array of spheres, bit i%32 of o_visible[i/32] is set if sphere i is visible
+  /// @param[in] _centre the centres of the spheres
+  /// @param[in] _radius the radius of each sphere, _centre.size() values
+  /// @param[out] o_visible the mask, must have space for maskWords(_centre.size()) words
+  //----------------------------------------------------------------------------------------------------------------------
+  void cullSpheres(const Vec3Array &_centre, const Real *_radius, uint32_t *o_visible) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief as the mask versions but give the indices of the visible objects in order
+  /// @param[out] o_visible replaced with the visible indices
+  //----------------------------------------------------------------------------------------------------------------------
+  void cullBoxes(const Vec3Array &_min, const Vec3Array &_max, std::vector<size_t> &o_visible) const;
+  void cullSpheres(const Vec3Array &_centre, const Real *_radius, std::vector<size_t> &o_visible) const;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief cull one array of boxes against several views at once (for example the main camera and each shadow
+  /// cascade), every block of bounds is loaded once and tested against all the views before moving on so the
+  /// bounds are only read from memory once however many views there are. The masks match calling the single
+  /// view version for each view.
+  /// @param[in] _views the frusta, for example {camera.getFrustum(),Frustum(lightVP)}
+  /// @param[in] _numViews the number of views
+  /// @param[in] _min the minimum corners of the boxes
+  /// @param[in] _max the maximum corners of the boxes, must be the same size as _min
+  /// @param[out] o_visible one mask per view, each with space for maskWords(_min.size()) words
+  //----------------------------------------------------------------------------------------------------------------------
+  static void cullBoxes(const Frustum *_views, size_t _numViews, const Vec3Array &_min, const Vec3Array &_max, uint32_t *const *o_visible) noexcept;
+  static void cullBoxes(const Frustum *_views, size_t _numViews, const AABB *_boxes, size_t _count, uint32_t *const *o_visible) noexcept;
+  static void cullSpheres(const Frustum *_views, size_t _numViews, const Vec3Array &_centre, const Real *_radius, uint32_t *const *o_visible) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief turn a visibility mask into the list of set indices
+  /// @param[in] _mask the mask from one of the cull functions
+  /// @param[in] _count the number of objects the mask is for
+  /// @param[out] o_indices replaced with the set indices
+  //----------------------------------------------------------------------------------------------------------------------
+  static void maskToIndices(const uint32_t *_mask, size_t _count, std::vector<size_t> &o_indices);
+
+private :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the planes as nx*x + ny*y + nz*z + d >= 0 inside
+  //----------------------------------------------------------------------------------------------------------------------
+  Real m_nx[c_numPlanes];
+  Real m_ny[c_numPlanes];
+  Real m_nz[c_numPlanes];
+  Real m_d[c_numPlanes];
+};
+
+} // end namespace ngl
+
+#endif
@@ -0,0 +1,155 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LODSELECTOR_H_
+#define LODSELECTOR_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file LODSelector.h
+/// @brief picks the level of detail of each object from the size of its geometric error on screen, done in
+/// the same pass over the bounds as the frustum culling
+//----------------------------------------------------------------------------------------------------------------------
+#include "Types.h"
+#include "Vec3.h"
+#include "Frustum.h"
+#include "Vec3Array.h"
+#include <cstdint>
+
+namespace ngl
+{
+class Camera;
+//----------------------------------------------------------------------------------------------------------------------
+/// @class LODSelector "include/ngl/LODSelector.h"
+/// @brief holds what is needed from a perspective Camera (frustum, eye, near plane and field of view) and
+/// the viewport height to turn a world space error at a distance into pixels. The error of a level is drawn
+/// at  error * viewportHeight / (2 * distance * tan(fov / 2))  pixels, where the distance is from the eye to
+/// the nearest point of the bounding sphere (but not less than the near plane). The coarsest level that is
+/// no more than the pixel error is chosen.
+/// To stop objects switching back and forth when they sit near the distance where two levels swap, an object
+/// only moves to a coarser level once its error is (1 + hysteresis) times under the limit, and only moves back
+/// to a finer one once it is (1 + hysteresis) times over it.
+/// cullSpheres tests the spheres 4 (SSE) or 8 (AVX) at a time for visibility and level together so each
+/// object is loaded once, and splits large arrays over threads. The mask matches Frustum::cullSpheres and the
+/// levels match selectLOD.
+/// @version 1.0
+/// @date 16/10/16
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT LODSelector
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the most levels an object can have so a level fits in a byte
+  //----------------------------------------------------------------------------------------------------------------------
+  static constexpr size_t c_maxLevels=256;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief default ctor, the default Frustum seen from the origin with a 90 degree field of view, a near
+  /// plane of 0.1 and a 720 pixel high viewport
+  //----------------------------------------------------------------------------------------------------------------------
+  LODSelector() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor from a camera
+  /// @param[in] _camera the camera, its frustum must be up to date (see Camera::calculateFrustum)
+  /// @param[in] _viewportHeight the height of the viewport in pixels
+  /// @param[in] _pixelError the most pixels the error of the chosen level can cover
+  /// @param[in] _hysteresis the fraction the error has to pass the limit by before the level changes, 0 for none
+  //----------------------------------------------------------------------------------------------------------------------
+  LODSelector(const Camera &_camera, Real _viewportHeight, Real _pixelError=1.0f, Real _hysteresis=0.2f) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief update from the camera, call each frame after the camera moves
+  /// @param[in] _camera the camera, its frustum must be up to date
+  /// @param[in] _viewportHeight the height of the viewport in pixels
+  //----------------------------------------------------------------------------------------------------------------------
+  void setCamera(const Camera &_camera, Real _viewportHeight) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the view from its parts, for cameras not held in a Camera
+  /// @param[in] _frustum the view frustum
+  /// @param[in] _eye the eye position
+  /// @param[in] _fov the vertical field of view in degrees
+  /// @param[in] _near the near plane distance
+  /// @param[in] _viewportHeight the height of the viewport in pixels
+  //----------------------------------------------------------------------------------------------------------------------
+  void setView(const Frustum &_frustum, const Vec3 &_eye, Real _fov, Real _near, Real _viewportHeight) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the most pixels the error of the chosen level can cover
+  //----------------------------------------------------------------------------------------------------------------------
+  void setPixelError(Real _pixels) noexcept;
+  Real getPixelError() const noexcept {return m_pixelError;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the fraction the error has to pass the limit by before the level changes
+  //----------------------------------------------------------------------------------------------------------------------
+  void setHysteresis(Real _hysteresis) noexcept;
+  Real getHysteresis() const noexcept {return m_hysteresis;}
+  const Frustum &getFrustum() const noexcept {return m_frustum;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of pixels a world space error covers for an object
+  /// @param[in] _centre the centre of the bounding sphere
+  /// @param[in] _radius the radius of the bounding sphere
+  /// @param[in] _error the error in world units
+  //----------------------------------------------------------------------------------------------------------------------
+  Real projectedError(const Vec3 &_centre, Real _radius, Real _error) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the level to draw a single object at
+  /// @param[in] _centre the centre of the bounding sphere
+  /// @param[in] _radius the radius of the bounding sphere
+  /// @param[in] _errors the world space error of each level, never decreasing (for example MeshLOD::m_error
+  /// times the scale of the instance), the first is not read as level 0 can always be used
+  /// @param[in] _levels the number of levels, at most c_maxLevels
+  /// @param[in] _previous the level chosen last frame
+  /// @returns the level
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t selectLOD(const Vec3 &_centre, Real _radius, const Real *_errors, size_t _levels, size_t _previous=0) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief cull an array of spheres and choose the level of each in one pass
+  /// @param[in] _centre the centres of the spheres
+  /// @param[in] _radius the radius of each sphere, _centre.size() values
+  /// @param[in] _levelError _levels arrays each of _centre.size() values, _levelError[l][i] is the world space
+  /// error of level l of object i. Objects with fewer levels should use a very large error (for example
+  /// std::numeric_limits<Real>::max()) for the ones they don't have. _levelError[0] is not read.
+  /// @param[in] _levels the number of levels, at most c_maxLevels
+  /// @param[out] o_visible bit i%32 of o_visible[i/32] is set if sphere i is visible, must have space for
+  /// Frustum::maskWords(_centre.size()) words
+  /// @param[in,out] io_level the level of each object from last frame (0 the first time), replaced with the
+  /// level for this frame. Every object gets a level, not just the visible ones.
+  //----------------------------------------------------------------------------------------------------------------------
+  void cullSpheres(const Vec3Array &_centre, const Real *_radius, const Real *const *_levelError, size_t _levels,
+                   uint32_t *o_visible, uint8_t *io_level) const noexcept;
+
+private :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set m_errorScale from the view values
+  //----------------------------------------------------------------------------------------------------------------------
+  void updateScale() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the view
+  //----------------------------------------------------------------------------------------------------------------------
+  Frustum m_frustum;
+  Vec3 m_eye;
+  Real m_near;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the world space size of a pixel at a distance of 1, 2 * tan(fov / 2) / viewportHeight
+  //----------------------------------------------------------------------------------------------------------------------
+  Real m_pixelSize;
+  Real m_pixelError=1.0f;
+  Real m_hysteresis=0.2f;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the largest error allowed at a distance of 1 to move to a coarser level and to stay at one
+  //----------------------------------------------------------------------------------------------------------------------
+  Real m_coarserScale;
+  Real m_stayScale;
+};
+
+} // end namespace ngl
+
+#endif
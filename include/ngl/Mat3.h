@@ -22,7 +22,9 @@
 //----------------------------------------------------------------------------------------------------------------------
 // must include types.h first for Real and GLEW if required
 #include "Types.h"
+#include "Vec3.h"
 #include <array>
+#include <cstring>
 #include <ostream>
 
 namespace ngl
@@ -48,11 +50,11 @@ public:
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief ctor will always create an identity matrix
   //----------------------------------------------------------------------------------------------------------------------
-  Mat3() noexcept;
+  constexpr Mat3() noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief ctor passing in value
   //----------------------------------------------------------------------------------------------------------------------
-  Mat3(Real _00,Real _01,Real _02,Real _10,Real _11,Real _12,Real _20,Real _21,Real _22) noexcept;
+  constexpr Mat3(Real _00,Real _01,Real _02,Real _10,Real _11,Real _12,Real _20,Real _21,Real _22) noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief copy ctor from mat4 will copy left up and fwd vectors
   //----------------------------------------------------------------------------------------------------------------------
@@ -61,11 +63,15 @@ public:
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief copy ctor with reference object
   //----------------------------------------------------------------------------------------------------------------------
-  Mat3( const Mat3& _m ) noexcept;
+  constexpr Mat3( const Mat3& _m ) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief assignment operator
+  //----------------------------------------------------------------------------------------------------------------------
+  Mat3 &operator=(const Mat3 &_m) noexcept=default;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief copy ctor with Real useful for Matrix m=1; for identity or Matrix m=3.5 for uniform scale
   //----------------------------------------------------------------------------------------------------------------------
-  Mat3( const Real _m ) noexcept;
+  constexpr Mat3( const Real _m ) noexcept;
 
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief set the value at m_m[_x][_y] to _equals
@@ -93,7 +99,7 @@ public:
   /// @param[in] _m the matrix to multiply the current one by
   /// @returns this*_m
   //----------------------------------------------------------------------------------------------------------------------
-  Mat3 operator*( const Mat3 &_m  ) const noexcept;
+  constexpr Mat3 operator*( const Mat3 &_m  ) const noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief operator to mult this matrix by value _m
   /// @param[in] _m the matrix to multiplt
@@ -105,7 +111,7 @@ public:
   /// @param[in] _m the matrix to add
   /// @returns this+_m
   //----------------------------------------------------------------------------------------------------------------------
-  Mat3 operator+( const Mat3 &_m ) const noexcept;
+  constexpr Mat3 operator+( const Mat3 &_m ) const noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief += operator
   /// @param[in] _m the matrix to add
@@ -117,7 +123,7 @@ public:
   /// @param[in] _i the scalar to multiply by
   /// @returns this*_i
   //----------------------------------------------------------------------------------------------------------------------
-  Mat3 operator*(  Real _i ) const noexcept;
+  constexpr Mat3 operator*(  Real _i ) const noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief *= operator with a scalar value
   /// @param[in] _i the scalar to multiply by
@@ -129,7 +135,7 @@ public:
   /// @param[in] _v the vector to multiply
   /// @returns Vector M*V
   //----------------------------------------------------------------------------------------------------------------------
-  Vec3 operator * ( const Vec3 &_v ) const noexcept;
+  constexpr Vec3 operator * ( const Vec3 &_v ) const noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   ///  @brief method to transpose the matrix
   //----------------------------------------------------------------------------------------------------------------------
@@ -166,7 +172,7 @@ public:
   /// @brief get the determinant of the matrix
   /// @returns the determinat
   //----------------------------------------------------------------------------------------------------------------------
-  Real determinant() const noexcept;
+  constexpr Real determinant() const noexcept;
 
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief set the matrix to be the inverse
@@ -293,6 +299,227 @@ public :
    };
 #endif
   }; // end of class
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief multiply whole arrays of matrices, o_out[i]=_a[i]*_b[i]. These process 4 matrices at a time with
+/// simd, the output may be one of the inputs but must not otherwise overlap
+/// @param[in] _a the array of left hand matrices
+/// @param[in] _b the array of right hand matrices
+/// @param[in] _count the number of elements in _a and _b
+/// @param[out] o_out the array to write the _count products to
+//----------------------------------------------------------------------------------------------------------------------
+extern NGL_DLLEXPORT void multiplyMatrices(const Mat3 *_a, const Mat3 *_b, size_t _count, Mat3 *o_out) noexcept;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the same as Mat3::inverse for each matrix, singular matrices give the identity
+/// @param[in] _m the array of matrices
+/// @param[in] _count the number of elements in _m
+/// @param[out] o_out the array to write the _count results to
+//----------------------------------------------------------------------------------------------------------------------
+extern NGL_DLLEXPORT void inverseMatrices(const Mat3 *_m, size_t _count, Mat3 *o_out) noexcept;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the determinant of each matrix
+/// @param[in] _m the array of matrices
+/// @param[in] _count the number of elements in _m
+/// @param[out] o_out the array to write the _count determinants to
+//----------------------------------------------------------------------------------------------------------------------
+extern NGL_DLLEXPORT void determinants(const Mat3 *_m, size_t _count, Real *o_out) noexcept;
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief construction and arithmetic are inline so they can be inlined into client code,
+/// the library still exports out of line copies see Mat3.cpp.
+/// The ctors and the non modifying operators are constexpr so constant matrices can be built at compile time,
+/// these only use m_m as that is the union member the ctors initialise.
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Mat3::Mat3() noexcept :
+  m_m{{1.0f,0.0f,0.0f},{0.0f,1.0f,0.0f},{0.0f,0.0f,1.0f}}
+{}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Mat3::Mat3(Real _00, Real _01, Real _02, Real _10,  Real _11, Real _12,Real _20, Real _21, Real _22) noexcept :
+  m_m{{_00,_01,_02},{_10,_11,_12},{_20,_21,_22}}
+{}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Mat3::Mat3(const Mat3& _m) noexcept :
+  m_m{{_m.m_m[0][0],_m.m_m[0][1],_m.m_m[0][2]},
+      {_m.m_m[1][0],_m.m_m[1][1],_m.m_m[1][2]},
+      {_m.m_m[2][0],_m.m_m[2][1],_m.m_m[2][2]}}
+{}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Mat3::Mat3(const Real _m  ) noexcept :
+  m_m{{_m,0.0f,0.0f},{0.0f,_m,0.0f},{0.0f,0.0f,_m}}
+{}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Mat3::setAtXY( GLint _x,GLint _y, Real _equals ) noexcept
+{
+  m_m[_x][_y]=_equals;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline const Mat3& Mat3::null() noexcept
+{
+  memset(&m_m,0,sizeof(m_m));
+  return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline const Mat3&  Mat3::identity() noexcept
+{
+  memset(m_m,0,sizeof(m_m));
+  m_00=1.0f;
+  m_11=1.0f;
+  m_22=1.0f;
+  return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Mat3 Mat3::operator*(const Mat3& _m   )const noexcept
+{
+  return Mat3(m_m[0][0] * _m.m_m[0][0] + m_m[0][1] * _m.m_m[1][0] + m_m[0][2] * _m.m_m[2][0],
+              m_m[0][0] * _m.m_m[0][1] + m_m[0][1] * _m.m_m[1][1] + m_m[0][2] * _m.m_m[2][1],
+              m_m[0][0] * _m.m_m[0][2] + m_m[0][1] * _m.m_m[1][2] + m_m[0][2] * _m.m_m[2][2],
+              m_m[1][0] * _m.m_m[0][0] + m_m[1][1] * _m.m_m[1][0] + m_m[1][2] * _m.m_m[2][0],
+              m_m[1][0] * _m.m_m[0][1] + m_m[1][1] * _m.m_m[1][1] + m_m[1][2] * _m.m_m[2][1],
+              m_m[1][0] * _m.m_m[0][2] + m_m[1][1] * _m.m_m[1][2] + m_m[1][2] * _m.m_m[2][2],
+              m_m[2][0] * _m.m_m[0][0] + m_m[2][1] * _m.m_m[1][0] + m_m[2][2] * _m.m_m[2][0],
+              m_m[2][0] * _m.m_m[0][1] + m_m[2][1] * _m.m_m[1][1] + m_m[2][2] * _m.m_m[2][1],
+              m_m[2][0] * _m.m_m[0][2] + m_m[2][1] * _m.m_m[1][2] + m_m[2][2] * _m.m_m[2][2]);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline const Mat3& Mat3::operator*= ( const Mat3 &_m ) noexcept
+{
+  Mat3 temp(*this);
+
+  //  row 0
+  m_00  =  temp.m_00 * _m.m_00;
+  m_01  =  temp.m_01 * _m.m_00;
+  m_02  =  temp.m_02 * _m.m_00;
+
+  m_00 +=  temp.m_10 * _m.m_01;
+  m_01 +=  temp.m_11 * _m.m_01;
+  m_02 +=  temp.m_12 * _m.m_01;
+
+  m_00 +=  temp.m_20 * _m.m_02;
+  m_01 +=  temp.m_21 * _m.m_02;
+  m_02 +=  temp.m_22 * _m.m_02;
+
+
+  //  row 1
+  m_10  =  temp.m_00 * _m.m_10;
+  m_11  =  temp.m_01 * _m.m_10;
+  m_12  =  temp.m_02 * _m.m_10;
+
+  m_10 +=  temp.m_10 * _m.m_11;
+  m_11 +=  temp.m_11 * _m.m_11;
+  m_12 +=  temp.m_12 * _m.m_11;
+
+  m_10 +=  temp.m_20 * _m.m_12;
+  m_11 +=  temp.m_21 * _m.m_12;
+  m_12 +=  temp.m_22 * _m.m_12;
+
+
+
+  //  row 2
+  m_20  =  temp.m_00 * _m.m_20;
+  m_21  =  temp.m_01 * _m.m_20;
+  m_22  =  temp.m_02 * _m.m_20;
+
+  m_20 +=  temp.m_10 * _m.m_21;
+  m_21 +=  temp.m_11 * _m.m_21;
+  m_22 +=  temp.m_12 * _m.m_21;
+
+  m_20 +=  temp.m_20 * _m.m_22;
+  m_21 +=  temp.m_21 * _m.m_22;
+  m_22 +=  temp.m_22 * _m.m_22;
+
+  return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Mat3 Mat3::operator+(const Mat3 &_m ) const noexcept
+{
+  return Mat3(m_m[0][0]+_m.m_m[0][0], m_m[0][1]+_m.m_m[0][1], m_m[0][2]+_m.m_m[0][2],
+              m_m[1][0]+_m.m_m[1][0], m_m[1][1]+_m.m_m[1][1], m_m[1][2]+_m.m_m[1][2],
+              m_m[2][0]+_m.m_m[2][0], m_m[2][1]+_m.m_m[2][1], m_m[2][2]+_m.m_m[2][2]);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline const Mat3& Mat3::operator+=( const Mat3 &_m  ) noexcept
+{
+  Real* iterA =&m_openGL[0];
+  const Real* iterB = &_m.m_openGL[0];
+  const Real* end   = &m_openGL[9];
+
+  for( ; iterA != end; ++iterA, ++iterB)
+  {
+    *iterA += *iterB;
+  }
+  return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Mat3 Mat3::operator*( Real _i  ) const noexcept
+{
+  return Mat3(m_m[0][0]*_i, m_m[0][1]*_i, m_m[0][2]*_i,
+              m_m[1][0]*_i, m_m[1][1]*_i, m_m[1][2]*_i,
+              m_m[2][0]*_i, m_m[2][1]*_i, m_m[2][2]*_i);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline const Mat3& Mat3::operator*=(Real _i) noexcept
+{
+  for(int y=0; y<3; ++y)
+  {
+    for(int x=0; x<3; ++x)
+    {
+      m_m[y][x]*=_i;
+    }
+  }
+  return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline const Mat3& Mat3::transpose() noexcept
+{
+  Mat3 tmp(*this);
+
+  for(int row=0; row<3; ++row)
+  {
+    for(int col=0; col<3; ++col)
+    {
+      m_m[row][col]=tmp.m_m[col][row];
+    }
+  }
+  return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Mat3::scale(Real _x,  Real _y,  Real _z) noexcept
+{
+  m_00 = _x;
+  m_11 = _y;
+  m_22 = _z;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Vec3 Mat3::operator * (const Vec3 &_v) const noexcept
+{
+  return Vec3(_v.m_x * m_m[0][0] + _v.m_y* m_m[0][1] + _v.m_z * m_m[0][2],
+              _v.m_x * m_m[1][0] + _v.m_y* m_m[1][1] + _v.m_z * m_m[1][2],
+              _v.m_x * m_m[2][0] + _v.m_y* m_m[2][1] + _v.m_z * m_m[2][2]);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Real Mat3::determinant() const noexcept
+{
+    return +m_m[0][0]*(m_m[1][1]*m_m[2][2]-m_m[2][1]*m_m[1][2])
+            -m_m[0][1]*(m_m[1][0]*m_m[2][2]-m_m[1][2]*m_m[2][0])
+            +m_m[0][2]*(m_m[1][0]*m_m[2][1]-m_m[1][1]*m_m[2][0]);
+}
+
 // free function for matrix comparison use in unit tests etc
 inline bool operator==(const ngl::Mat3 &_m1 , const ngl::Mat3 &_m2)
 {
@@ -24,11 +24,13 @@
 #include "Types.h"
 #include <ostream>
 #include <array>
+#include <cstring>
 
 namespace ngl
 {
 class Vec4;
 class Vec3;
+class Mat3;
 class Quaternion;
 
 
@@ -64,30 +66,30 @@ public:
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief ctor will always create an identity matrix
   //----------------------------------------------------------------------------------------------------------------------
-  Mat4() noexcept;
+  constexpr Mat4() noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief ctor using 4x4 array, really useful when mixing with Imath as we can do
   /// Imath::Matrix44 <float> iMatrix;
   /// Mat4 nMatrix(iMatrix.x)
   /// @param[in] _m[4][4] the input array for the matrix
   //----------------------------------------------------------------------------------------------------------------------
-  Mat4(Real _m[4][4]) noexcept;
+  constexpr Mat4(Real _m[4][4]) noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief ctor using individual elements
   /// @param [in] _00 0th element (etc you get the deal)
   //----------------------------------------------------------------------------------------------------------------------
-  Mat4(Real _00,Real _01,Real _02,Real _03,
+  constexpr Mat4(Real _00,Real _01,Real _02,Real _03,
        Real _10,Real _11,Real _12,Real _13,
        Real _20,Real _21,Real _22,Real _23,
        Real _30,Real _31,Real _32,Real _33) noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief copy ctor with reference object
   //----------------------------------------------------------------------------------------------------------------------
-  Mat4(const Mat4& _m) noexcept;
+  constexpr Mat4(const Mat4& _m) noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief copy ctor with Real useful for Mat4 m=1; for identity or Matrix m=3.5 for uniform scale
   //----------------------------------------------------------------------------------------------------------------------
-  Mat4(Real _m) noexcept;
+  constexpr Mat4(Real _m) noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief assignment operator
   //----------------------------------------------------------------------------------------------------------------------
@@ -130,7 +132,7 @@ public:
   /// @param[in] _m the matrix to add
   /// @returns this+_m
   //----------------------------------------------------------------------------------------------------------------------
-  Mat4 operator+(const Mat4 &_m) const noexcept;
+  constexpr Mat4 operator+(const Mat4 &_m) const noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief += operator
   /// @param[in] _m the matrix to add
@@ -142,7 +144,7 @@ public:
   /// @param[in] _i the scalar to multiply by
   /// @returns this*_i
   //----------------------------------------------------------------------------------------------------------------------
-  Mat4 operator*(const Real _i) const noexcept;
+  constexpr Mat4 operator*(const Real _i) const noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief *= operator with a scalar value
   /// @param[in] _i the scalar to multiply by
@@ -213,6 +215,44 @@ public:
   //----------------------------------------------------------------------------------------------------------------------
   Mat4 inverse() noexcept;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief get the inverse of an affine matrix (last column 0,0,0,1) using the 3x3 inverse of the
+  /// rotation / scale part and the translation in m_30, m_31, m_32. Much cheaper than inverse()
+  /// @returns a new matrix the inverse of the current matrix (warning no error checking )
+  //----------------------------------------------------------------------------------------------------------------------
+  Mat4 inverseAffine() const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief get the inverse of a rigid body matrix (rotation and translation only) where the 3x3
+  /// part is orthonormal so its inverse is just the transpose
+  /// @returns a new matrix the inverse of the current matrix (no check the matrix is rigid)
+  //----------------------------------------------------------------------------------------------------------------------
+  Mat4 inverseRigid() const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief get the matrix to transform normals by, this is the inverse transpose of the upper 3x3
+  /// calculated directly from its cofactors so is the same as Mat3(inverse().transpose()) for an affine matrix
+  /// @param[in] _uniformScale set if the upper 3x3 is only rotation and uniform scale, the result is then
+  /// just the 3x3 over the scale squared
+  /// @returns the normal matrix
+  //----------------------------------------------------------------------------------------------------------------------
+  Mat3 normalMatrix(bool _uniformScale=false) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief build the matrix scale * rotateX * rotateY * rotateZ with the translation in the last row,
+  /// this is the same matrix Transformation uses but built directly without any matrix multiplies
+  /// @param[in] _translate the translation
+  /// @param[in] _rotate the x,y,z rotations in degrees
+  /// @param[in] _scale the scale, each value must be non zero for the inverse
+  /// @param[out] o_matrix the composed matrix
+  /// @param[out] o_inverse the inverse of the composed matrix
+  //----------------------------------------------------------------------------------------------------------------------
+  static void fromTRS(const Vec3 &_translate, const Vec3 &_rotate, const Vec3 &_scale, Mat4 &o_matrix, Mat4 &o_inverse) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief build the matrix scale * rotateX * rotateY * rotateZ with the translation in the last row
+  /// @param[in] _translate the translation
+  /// @param[in] _rotate the x,y,z rotations in degrees
+  /// @param[in] _scale the scale
+  /// @returns the composed matrix
+  //----------------------------------------------------------------------------------------------------------------------
+  static Mat4 fromTRS(const Vec3 &_translate, const Vec3 &_rotate, const Vec3 &_scale) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief convert this matrix to a Quaternion
   /// @returns the matrix as a Quaternion
   //----------------------------------------------------------------------------------------------------------------------
@@ -330,6 +370,138 @@ public :
 #pragma pack(pop)
   }; // end of class
 
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief construction and the element wise arithmetic are inline, the products, transpose and inverse
+/// use the simd dispatch in Mat4.cpp so stay out of line. The ctors, + and * by a scalar are constexpr
+/// and only use m_m as that is the union member the ctors initialise.
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Mat4::Mat4() noexcept :
+  m_m{{1.0f,0.0f,0.0f,0.0f},{0.0f,1.0f,0.0f,0.0f},{0.0f,0.0f,1.0f,0.0f},{0.0f,0.0f,0.0f,1.0f}}
+{}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Mat4::Mat4(Real _m[4][4]) noexcept :
+  m_m{{_m[0][0],_m[0][1],_m[0][2],_m[0][3]},
+      {_m[1][0],_m[1][1],_m[1][2],_m[1][3]},
+      {_m[2][0],_m[2][1],_m[2][2],_m[2][3]},
+      {_m[3][0],_m[3][1],_m[3][2],_m[3][3]}}
+{}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Mat4::Mat4(
+            Real _00,Real _01,Real _02,Real _03,
+            Real _10,Real _11,Real _12,Real _13,
+            Real _20,Real _21,Real _22,Real _23,
+            Real _30, Real _31, Real _32, Real _33 ) noexcept :
+  m_m{{_00,_01,_02,_03},{_10,_11,_12,_13},{_20,_21,_22,_23},{_30,_31,_32,_33}}
+{}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Mat4::Mat4(const Mat4& _m ) noexcept :
+  m_m{{_m.m_m[0][0],_m.m_m[0][1],_m.m_m[0][2],_m.m_m[0][3]},
+      {_m.m_m[1][0],_m.m_m[1][1],_m.m_m[1][2],_m.m_m[1][3]},
+      {_m.m_m[2][0],_m.m_m[2][1],_m.m_m[2][2],_m.m_m[2][3]},
+      {_m.m_m[3][0],_m.m_m[3][1],_m.m_m[3][2],_m.m_m[3][3]}}
+{}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline Mat4& Mat4::operator=(const Mat4& _m ) noexcept
+{
+  memcpy(m_m,&_m.m_m,sizeof(m_m));
+  return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Mat4::Mat4(Real _m) noexcept :
+  m_m{{_m,0.0f,0.0f,0.0f},{0.0f,_m,0.0f,0.0f},{0.0f,0.0f,_m,0.0f},{0.0f,0.0f,0.0f,1.0f}}
+{}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Mat4::setAtXY(GLint _x,GLint _y, Real _equals  ) noexcept
+{
+  m_m[_x][_y]=_equals;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline const Mat4& Mat4::null() noexcept
+{
+  memset(&m_m,0,sizeof(m_m));
+  return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline const Mat4&  Mat4::identity() noexcept
+{
+  memset(m_m,0,sizeof(m_m));
+  m_00=1.0f;
+  m_11=1.0f;
+  m_22=1.0f;
+  m_33=1.0f;
+  return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Mat4 Mat4::operator+(const Mat4 &_m ) const noexcept
+{
+  return Mat4(m_m[0][0]+_m.m_m[0][0], m_m[0][1]+_m.m_m[0][1], m_m[0][2]+_m.m_m[0][2], m_m[0][3]+_m.m_m[0][3],
+              m_m[1][0]+_m.m_m[1][0], m_m[1][1]+_m.m_m[1][1], m_m[1][2]+_m.m_m[1][2], m_m[1][3]+_m.m_m[1][3],
+              m_m[2][0]+_m.m_m[2][0], m_m[2][1]+_m.m_m[2][1], m_m[2][2]+_m.m_m[2][2], m_m[2][3]+_m.m_m[2][3],
+              m_m[3][0]+_m.m_m[3][0], m_m[3][1]+_m.m_m[3][1], m_m[3][2]+_m.m_m[3][2], m_m[3][3]+_m.m_m[3][3]);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline const Mat4& Mat4::operator+=(const Mat4 &_m) noexcept
+{
+  Real* iterA =&m_openGL[0];
+  const Real* iterB = &_m.m_openGL[0];
+  const Real* end   = &m_openGL[16];
+
+  for( ; iterA != end; ++iterA, ++iterB)
+  {
+    *iterA += *iterB;
+  }
+  return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Mat4 Mat4::operator*( const Real _i) const noexcept
+{
+  return Mat4(m_m[0][0]*_i, m_m[0][1]*_i, m_m[0][2]*_i, m_m[0][3]*_i,
+              m_m[1][0]*_i, m_m[1][1]*_i, m_m[1][2]*_i, m_m[1][3]*_i,
+              m_m[2][0]*_i, m_m[2][1]*_i, m_m[2][2]*_i, m_m[2][3]*_i,
+              m_m[3][0]*_i, m_m[3][1]*_i, m_m[3][2]*_i, m_m[3][3]*_i);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline const Mat4& Mat4::operator*=(const Real _i) noexcept
+{
+  for(int y=0; y<4; y++)
+  {
+    for(int x=0; x<4; x++)
+    {
+      m_m[y][x]*=_i;
+    }
+  }
+  return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Mat4::translate( const Real _x,const Real _y,  const Real _z ) noexcept
+{
+  m_30 = _x;
+  m_31 = _y;
+  m_32 = _z;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Mat4::scale(const Real _x, const Real _y,  const Real _z ) noexcept
+{
+  m_00 = _x;
+  m_11 = _y;
+  m_22 = _z;
+}
+
+
 
 // free function for matrix comparison use in unit tests etc
 inline bool operator==(const ngl::Mat4 &_m1 , const ngl::Mat4 &_m2)
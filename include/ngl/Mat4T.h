@@ -0,0 +1,508 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MAT4T_H_
+#define MAT4T_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file Mat4T.h
+/// @brief a 4x4 matrix of any floating point precision, used with Mat4d for large world transforms
+//----------------------------------------------------------------------------------------------------------------------
+#include "Types.h"
+#include "Mat4.h"
+#include "Vec3T.h"
+#include <cmath>
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @class Mat4T "include/Mat4T.h"
+/// @brief Mat4 with the element type as a template parameter, using the same row vector convention as Mat4
+/// (the translation is in m_m[3][0..2]) so Mat4T<double>(m).toMat4() gives back the same transform.
+/// Mat4 stays the float type used by the rest of the library and the simd kernels. The usual use is to
+/// build the model and view matrices in double and use toMat4RelativeTo to move them to the camera
+/// position before going to float, that way the large translation cancels out in double precision.
+/// @version 1.0
+/// @date 16/10/16
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+class Mat4T
+{
+public:
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the element type
+  //----------------------------------------------------------------------------------------------------------------------
+  using value_type=T;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor will always create an identity matrix
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr Mat4T() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor using individual elements
+  /// @param [in] _00 0th element (etc you get the deal)
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr Mat4T(T _00,T _01,T _02,T _03,
+                  T _10,T _11,T _12,T _13,
+                  T _20,T _21,T _22,T _23,
+                  T _30,T _31,T _32,T _33) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief uniform scale matrix, as Mat4(Real) m_33 is left as 1
+  /// @param[in] _s the value for the upper 3x3 diagonal
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr explicit Mat4T(T _s) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief convert from another precision, narrowing to float should use toMat4 or convertToFloat
+  /// @param[in] _m the matrix to convert
+  //----------------------------------------------------------------------------------------------------------------------
+  template <typename U>
+  explicit Mat4T(const Mat4T<U> &_m) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief convert from the float Mat4
+  /// @param[in] _m the matrix to convert
+  //----------------------------------------------------------------------------------------------------------------------
+  explicit Mat4T(const Mat4 &_m) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief convert to the float Mat4 used by the rest of the library
+  /// @returns the matrix rounded to float
+  //----------------------------------------------------------------------------------------------------------------------
+  Mat4 toMat4() const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief move the matrix so _origin becomes the origin
+  /// @param[in] _origin the new origin, usually the camera position
+  /// @returns the matrix followed by a translation of -_origin
+  //----------------------------------------------------------------------------------------------------------------------
+  Mat4T relativeTo(const Vec3T<T> &_origin) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief convert to a float Mat4 with the translation made relative to _origin, the subtraction is done
+  /// at this precision before rounding so objects near _origin keep their full float precision however
+  /// far _origin is from the world origin
+  /// @param[in] _origin the new origin, usually the camera position
+  /// @returns relativeTo(_origin) rounded to float
+  //----------------------------------------------------------------------------------------------------------------------
+  Mat4 toMat4RelativeTo(const Vec3T<T> &_origin) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief clear the matrix to all 0
+  //----------------------------------------------------------------------------------------------------------------------
+  const Mat4T& null() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief make the matrix the identity matrix
+  //----------------------------------------------------------------------------------------------------------------------
+  const Mat4T& identity() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the translation (m_m[3][0..2]) leaving the rest of the matrix alone, as Mat4::translate
+  /// @param[in] _x the x translation
+  /// @param[in] _y the y translation
+  /// @param[in] _z the z translation
+  //----------------------------------------------------------------------------------------------------------------------
+  void translate(T _x, T _y, T _z) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the diagonal scale values leaving the rest of the matrix alone, as Mat4::scale
+  /// @param[in] _x the x scale
+  /// @param[in] _y the y scale
+  /// @param[in] _z the z scale
+  //----------------------------------------------------------------------------------------------------------------------
+  void scale(T _x, T _y, T _z) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the rotation elements for an axis, as the Mat4 versions these only write the elements
+  /// used by the rotation so should be called on an identity matrix
+  /// @param[in] _deg the angle in degrees
+  //----------------------------------------------------------------------------------------------------------------------
+  void rotateX(T _deg) noexcept;
+  void rotateY(T _deg) noexcept;
+  void rotateZ(T _deg) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the translation part of the matrix
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr Vec3T<T> getTranslation() const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief matrix multiplication
+  /// @param[in] _m the matrix to multiply the current one by
+  /// @returns this*_m
+  //----------------------------------------------------------------------------------------------------------------------
+  Mat4T operator*(const Mat4T &_m) const noexcept;
+  const Mat4T& operator*=(const Mat4T &_m) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief transform a point (w=1) with the same convention as Vec4 * Mat4, no divide by w is done
+  /// @param[in] _p the point to transform
+  //----------------------------------------------------------------------------------------------------------------------
+  Vec3T<T> transformPoint(const Vec3T<T> &_p) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief transform a direction (w=0) so the translation is ignored
+  /// @param[in] _v the vector to transform
+  //----------------------------------------------------------------------------------------------------------------------
+  Vec3T<T> transformVector(const Vec3T<T> &_v) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief transpose the matrix in place
+  //----------------------------------------------------------------------------------------------------------------------
+  const Mat4T& transpose() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the determinant of the matrix
+  //----------------------------------------------------------------------------------------------------------------------
+  T determinant() const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the general inverse, as Mat4::inverse a singular matrix gives non finite values
+  /// @returns the inverse of the matrix
+  //----------------------------------------------------------------------------------------------------------------------
+  Mat4T inverse() const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief check for equality uses FCompare as Mat4 does
+  /// @param[in] _m the matrix to check against
+  //----------------------------------------------------------------------------------------------------------------------
+  bool operator==(const Mat4T &_m) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief access to the matrix data
+  /// @returns a pointer to m_m[0][0]
+  //----------------------------------------------------------------------------------------------------------------------
+  T* data() noexcept {return &m_m[0][0];}
+  const T* data() const noexcept {return &m_m[0][0];}
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the matrix elements laid out as Mat4::m_m
+  //----------------------------------------------------------------------------------------------------------------------
+  T m_m[4][4];
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the precisions in use, Mat4 itself is the float version
+//----------------------------------------------------------------------------------------------------------------------
+using Mat4f=Mat4T<float>;
+using Mat4d=Mat4T<double>;
+
+namespace detail
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief degrees to radians without going through the float ngl::radians
+  //----------------------------------------------------------------------------------------------------------------------
+  template <typename T>
+  constexpr T radiansT(T _deg) noexcept
+  {
+    return _deg*(T(3.14159265358979323846)/T(180));
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+constexpr Mat4T<T>::Mat4T() noexcept :
+  m_m{{T(1),T(0),T(0),T(0)},{T(0),T(1),T(0),T(0)},{T(0),T(0),T(1),T(0)},{T(0),T(0),T(0),T(1)}}
+{}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+constexpr Mat4T<T>::Mat4T(T _00,T _01,T _02,T _03,
+                          T _10,T _11,T _12,T _13,
+                          T _20,T _21,T _22,T _23,
+                          T _30,T _31,T _32,T _33) noexcept :
+  m_m{{_00,_01,_02,_03},{_10,_11,_12,_13},{_20,_21,_22,_23},{_30,_31,_32,_33}}
+{}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+constexpr Mat4T<T>::Mat4T(T _s) noexcept :
+  m_m{{_s,T(0),T(0),T(0)},{T(0),_s,T(0),T(0)},{T(0),T(0),_s,T(0)},{T(0),T(0),T(0),T(1)}}
+{}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+template <typename U>
+inline Mat4T<T>::Mat4T(const Mat4T<U> &_m) noexcept
+{
+  for(int y=0; y<4; ++y)
+  {
+    for(int x=0; x<4; ++x)
+    {
+      m_m[y][x]=static_cast<T>(_m.m_m[y][x]);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline Mat4T<T>::Mat4T(const Mat4 &_m) noexcept
+{
+  for(int y=0; y<4; ++y)
+  {
+    for(int x=0; x<4; ++x)
+    {
+      m_m[y][x]=static_cast<T>(_m.m_m[y][x]);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline Mat4 Mat4T<T>::toMat4() const noexcept
+{
+  Mat4 r;
+  for(int y=0; y<4; ++y)
+  {
+    for(int x=0; x<4; ++x)
+    {
+      r.m_m[y][x]=static_cast<Real>(m_m[y][x]);
+    }
+  }
+  return r;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline Mat4T<T> Mat4T<T>::relativeTo(const Vec3T<T> &_origin) const noexcept
+{
+  // M * translate(-o) subtracts m_y3 * o from the first three elements of each row y, for the usual
+  // affine matrix (m_03=m_13=m_23=0, m_33=1) this is just the translation minus _origin
+  Mat4T r(*this);
+  for(int y=0; y<4; ++y)
+  {
+    for(int x=0; x<3; ++x)
+    {
+      r.m_m[y][x]-=m_m[y][3]*_origin[x];
+    }
+  }
+  return r;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline Mat4 Mat4T<T>::toMat4RelativeTo(const Vec3T<T> &_origin) const noexcept
+{
+  return relativeTo(_origin).toMat4();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline const Mat4T<T>& Mat4T<T>::null() noexcept
+{
+  for(int y=0; y<4; ++y)
+  {
+    for(int x=0; x<4; ++x)
+    {
+      m_m[y][x]=T(0);
+    }
+  }
+  return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline const Mat4T<T>& Mat4T<T>::identity() noexcept
+{
+  null();
+  m_m[0][0]=m_m[1][1]=m_m[2][2]=m_m[3][3]=T(1);
+  return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline void Mat4T<T>::translate(T _x, T _y, T _z) noexcept
+{
+  m_m[3][0]=_x;
+  m_m[3][1]=_y;
+  m_m[3][2]=_z;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline void Mat4T<T>::scale(T _x, T _y, T _z) noexcept
+{
+  m_m[0][0]=_x;
+  m_m[1][1]=_y;
+  m_m[2][2]=_z;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline void Mat4T<T>::rotateX(T _deg) noexcept
+{
+  T beta=detail::radiansT(_deg);
+  T sr=std::sin(beta);
+  T cr=std::cos(beta);
+  m_m[1][1]= cr;
+  m_m[2][1]=-sr;
+  m_m[1][2]= sr;
+  m_m[2][2]= cr;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline void Mat4T<T>::rotateY(T _deg) noexcept
+{
+  T beta=detail::radiansT(_deg);
+  T sr=std::sin(beta);
+  T cr=std::cos(beta);
+  m_m[0][0]= cr;
+  m_m[2][0]= sr;
+  m_m[0][2]=-sr;
+  m_m[2][2]= cr;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline void Mat4T<T>::rotateZ(T _deg) noexcept
+{
+  T beta=detail::radiansT(_deg);
+  T sr=std::sin(beta);
+  T cr=std::cos(beta);
+  m_m[0][0]= cr;
+  m_m[1][0]=-sr;
+  m_m[0][1]= sr;
+  m_m[1][1]= cr;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+constexpr Vec3T<T> Mat4T<T>::getTranslation() const noexcept
+{
+  return Vec3T<T>(m_m[3][0],m_m[3][1],m_m[3][2]);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline Mat4T<T> Mat4T<T>::operator*(const Mat4T &_m) const noexcept
+{
+  Mat4T r;
+  for(int y=0; y<4; ++y)
+  {
+    for(int x=0; x<4; ++x)
+    {
+      r.m_m[y][x]=m_m[y][0]*_m.m_m[0][x] + m_m[y][1]*_m.m_m[1][x] + m_m[y][2]*_m.m_m[2][x] + m_m[y][3]*_m.m_m[3][x];
+    }
+  }
+  return r;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline const Mat4T<T>& Mat4T<T>::operator*=(const Mat4T &_m) noexcept
+{
+  *this=*this*_m;
+  return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline Vec3T<T> Mat4T<T>::transformPoint(const Vec3T<T> &_p) const noexcept
+{
+  return Vec3T<T>(_p.m_x*m_m[0][0] + _p.m_y*m_m[1][0] + _p.m_z*m_m[2][0] + m_m[3][0],
+                  _p.m_x*m_m[0][1] + _p.m_y*m_m[1][1] + _p.m_z*m_m[2][1] + m_m[3][1],
+                  _p.m_x*m_m[0][2] + _p.m_y*m_m[1][2] + _p.m_z*m_m[2][2] + m_m[3][2]);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline Vec3T<T> Mat4T<T>::transformVector(const Vec3T<T> &_v) const noexcept
+{
+  return Vec3T<T>(_v.m_x*m_m[0][0] + _v.m_y*m_m[1][0] + _v.m_z*m_m[2][0],
+                  _v.m_x*m_m[0][1] + _v.m_y*m_m[1][1] + _v.m_z*m_m[2][1],
+                  _v.m_x*m_m[0][2] + _v.m_y*m_m[1][2] + _v.m_z*m_m[2][2]);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline const Mat4T<T>& Mat4T<T>::transpose() noexcept
+{
+  for(int y=0; y<4; ++y)
+  {
+    for(int x=y+1; x<4; ++x)
+    {
+      T t=m_m[y][x];
+      m_m[y][x]=m_m[x][y];
+      m_m[x][y]=t;
+    }
+  }
+  return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline T Mat4T<T>::determinant() const noexcept
+{
+  // expand using the 2x2 determinants of the top and bottom pairs of rows
+  const T (*a)[4]=m_m;
+  T s0=a[0][0]*a[1][1]-a[1][0]*a[0][1];
+  T s1=a[0][0]*a[1][2]-a[1][0]*a[0][2];
+  T s2=a[0][0]*a[1][3]-a[1][0]*a[0][3];
+  T s3=a[0][1]*a[1][2]-a[1][1]*a[0][2];
+  T s4=a[0][1]*a[1][3]-a[1][1]*a[0][3];
+  T s5=a[0][2]*a[1][3]-a[1][2]*a[0][3];
+  T c5=a[2][2]*a[3][3]-a[3][2]*a[2][3];
+  T c4=a[2][1]*a[3][3]-a[3][1]*a[2][3];
+  T c3=a[2][1]*a[3][2]-a[3][1]*a[2][2];
+  T c2=a[2][0]*a[3][3]-a[3][0]*a[2][3];
+  T c1=a[2][0]*a[3][2]-a[3][0]*a[2][2];
+  T c0=a[2][0]*a[3][1]-a[3][0]*a[2][1];
+  return s0*c5-s1*c4+s2*c3+s3*c2-s4*c1+s5*c0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline Mat4T<T> Mat4T<T>::inverse() const noexcept
+{
+  const T (*a)[4]=m_m;
+  T s0=a[0][0]*a[1][1]-a[1][0]*a[0][1];
+  T s1=a[0][0]*a[1][2]-a[1][0]*a[0][2];
+  T s2=a[0][0]*a[1][3]-a[1][0]*a[0][3];
+  T s3=a[0][1]*a[1][2]-a[1][1]*a[0][2];
+  T s4=a[0][1]*a[1][3]-a[1][1]*a[0][3];
+  T s5=a[0][2]*a[1][3]-a[1][2]*a[0][3];
+  T c5=a[2][2]*a[3][3]-a[3][2]*a[2][3];
+  T c4=a[2][1]*a[3][3]-a[3][1]*a[2][3];
+  T c3=a[2][1]*a[3][2]-a[3][1]*a[2][2];
+  T c2=a[2][0]*a[3][3]-a[3][0]*a[2][3];
+  T c1=a[2][0]*a[3][2]-a[3][0]*a[2][2];
+  T c0=a[2][0]*a[3][1]-a[3][0]*a[2][1];
+  T invDet=T(1)/(s0*c5-s1*c4+s2*c3+s3*c2-s4*c1+s5*c0);
+
+  Mat4T r;
+  r.m_m[0][0]=( a[1][1]*c5-a[1][2]*c4+a[1][3]*c3)*invDet;
+  r.m_m[0][1]=(-a[0][1]*c5+a[0][2]*c4-a[0][3]*c3)*invDet;
+  r.m_m[0][2]=( a[3][1]*s5-a[3][2]*s4+a[3][3]*s3)*invDet;
+  r.m_m[0][3]=(-a[2][1]*s5+a[2][2]*s4-a[2][3]*s3)*invDet;
+
+  r.m_m[1][0]=(-a[1][0]*c5+a[1][2]*c2-a[1][3]*c1)*invDet;
+  r.m_m[1][1]=( a[0][0]*c5-a[0][2]*c2+a[0][3]*c1)*invDet;
+  r.m_m[1][2]=(-a[3][0]*s5+a[3][2]*s2-a[3][3]*s1)*invDet;
+  r.m_m[1][3]=( a[2][0]*s5-a[2][2]*s2+a[2][3]*s1)*invDet;
+
+  r.m_m[2][0]=( a[1][0]*c4-a[1][1]*c2+a[1][3]*c0)*invDet;
+  r.m_m[2][1]=(-a[0][0]*c4+a[0][1]*c2-a[0][3]*c0)*invDet;
+  r.m_m[2][2]=( a[3][0]*s4-a[3][1]*s2+a[3][3]*s0)*invDet;
+  r.m_m[2][3]=(-a[2][0]*s4+a[2][1]*s2-a[2][3]*s0)*invDet;
+
+  r.m_m[3][0]=(-a[1][0]*c3+a[1][1]*c1-a[1][2]*c0)*invDet;
+  r.m_m[3][1]=( a[0][0]*c3-a[0][1]*c1+a[0][2]*c0)*invDet;
+  r.m_m[3][2]=(-a[3][0]*s3+a[3][1]*s1-a[3][2]*s0)*invDet;
+  r.m_m[3][3]=( a[2][0]*s3-a[2][1]*s1+a[2][2]*s0)*invDet;
+  return r;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline bool Mat4T<T>::operator==(const Mat4T &_m) const noexcept
+{
+  for(int y=0; y<4; ++y)
+  {
+    for(int x=0; x<4; ++x)
+    {
+      if(!FCompare(m_m[y][x],_m.m_m[y][x]))
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+} // end namespace ngl
+
+#endif
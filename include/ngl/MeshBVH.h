@@ -0,0 +1,201 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MESHBVH_H_
+#define MESHBVH_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file MeshBVH.h
+/// @brief a bounding volume hierarchy over the triangles of a mesh for ray queries such as picking
+//----------------------------------------------------------------------------------------------------------------------
+#include "Types.h"
+#include "Vec3.h"
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace ngl
+{
+class AbstractMesh;
+class NCCAPointBake;
+//----------------------------------------------------------------------------------------------------------------------
+/// @class MeshBVH "include/ngl/MeshBVH.h"
+/// @brief a binary tree of boxes over a triangle mesh built with the binned surface area heuristic, the top
+/// of the tree is split first and the subtrees under it are then built on separate threads.
+/// The nodes are flattened depth first into one array so the left child of a node always follows it, and the
+/// triangles are copied into leaf order as separate vertex / edge arrays so a leaf is tested 4 triangles at a
+/// time with SSE. Boxes are tested with SSE slabs and closestHits traces packets of 4 rays together.
+/// When the vertices move but the triangles stay the same (for example a mesh driven by NCCAPointBake) refit
+/// recomputes the boxes without rebuilding the tree.
+/// For picking the ray can come from ngl::unProject of the mouse position at depths 0 and 1.
+/// @version 1.0
+/// @date 16/10/16
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT MeshBVH
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the triangle index of a miss
+  //----------------------------------------------------------------------------------------------------------------------
+  static constexpr uint32_t c_noHit=~uint32_t(0);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the most triangles put in a leaf
+  //----------------------------------------------------------------------------------------------------------------------
+  static constexpr size_t c_maxLeafSize=8;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the result of a ray query, the hit point is origin + m_t * dir or the barycentric
+  /// (1-u-v)*a + u*b + v*c of the triangle vertices
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Hit
+  {
+    Real m_t=std::numeric_limits<Real>::max();
+    Real m_u=0.0f;
+    Real m_v=0.0f;
+    uint32_t m_triangle=c_noHit;
+  };
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a flattened node, 32 bytes. An inner node (m_count 0) has its left child next in the array and
+  /// its right child at m_index, a leaf has m_count triangles from m_index in leaf order
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Node
+  {
+    Real m_min[3];
+    uint32_t m_index;
+    Real m_max[3];
+    uint32_t m_count;
+  };
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief an empty tree, every ray misses
+  //----------------------------------------------------------------------------------------------------------------------
+  MeshBVH()=default;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief build over the faces of a mesh
+  //----------------------------------------------------------------------------------------------------------------------
+  explicit MeshBVH(AbstractMesh &_mesh);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief build over the faces of a mesh, polygons are split into triangle fans
+  /// @param[in] _mesh the mesh, its faces and vertices are copied once
+  //----------------------------------------------------------------------------------------------------------------------
+  void build(AbstractMesh &_mesh);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief build over an indexed triangle list
+  /// @param[in] _verts the vertices
+  /// @param[in] _numVerts the number of vertices
+  /// @param[in] _indices three vertex indices per triangle
+  /// @param[in] _numIndices the number of indices
+  //----------------------------------------------------------------------------------------------------------------------
+  void build(const Vec3 *_verts, size_t _numVerts, const uint32_t *_indices, size_t _numIndices);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief move the vertices and recompute the boxes keeping the tree, this is much quicker than a build but
+  /// the tree gets slower to search the further the vertices move from where it was built
+  /// @param[in] _verts the new positions, the same number and order as the vertices built with
+  /// @param[in] _numVerts the number of vertices
+  //----------------------------------------------------------------------------------------------------------------------
+  void refit(const Vec3 *_verts, size_t _numVerts) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief refit to a frame of a point bake attached to the mesh the tree was built from
+  /// @param[in] _bake the point bake
+  /// @param[in] _frame the frame
+  //----------------------------------------------------------------------------------------------------------------------
+  void refit(NCCAPointBake &_bake, unsigned int _frame) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief find the nearest triangle hit by a ray
+  /// @param[in] _origin the start of the ray
+  /// @param[in] _dir the direction, this need not be normalised and m_t is in multiples of it
+  /// @param[out] o_hit the nearest hit, unchanged on a miss
+  /// @param[in] _tMax only hits nearer than this are found
+  /// @returns true if anything was hit
+  //----------------------------------------------------------------------------------------------------------------------
+  bool closestHit(const Vec3 &_origin, const Vec3 &_dir, Hit &o_hit, Real _tMax=std::numeric_limits<Real>::max()) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief true if the ray hits any triangle nearer than _tMax, this stops at the first hit found so is the
+  /// quickest way to test for a shadow or line of sight
+  //----------------------------------------------------------------------------------------------------------------------
+  bool anyHit(const Vec3 &_origin, const Vec3 &_dir, Real _tMax=std::numeric_limits<Real>::max()) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the closest hit of many rays, traced as packets of 4 over several threads
+  /// @param[in] _origins the ray origins
+  /// @param[in] _dirs the ray directions
+  /// @param[in] _count the number of rays
+  /// @param[out] o_hits the hit of each ray, a miss has m_triangle c_noHit
+  /// @param[in] _tMax only hits nearer than this are found
+  //----------------------------------------------------------------------------------------------------------------------
+  void closestHits(const Vec3 *_origins, const Vec3 *_dirs, size_t _count, Hit *o_hits,
+                   Real _tMax=std::numeric_limits<Real>::max()) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the sizes of the tree
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t numTriangles() const noexcept {return m_triangle.size();}
+  size_t numNodes() const noexcept {return m_nodes.size();}
+  bool empty() const noexcept {return m_nodes.empty();}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the nodes, for example to draw the boxes
+  //----------------------------------------------------------------------------------------------------------------------
+  const Node *nodes() const noexcept {return m_nodes.data();}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the face a hit triangle came from, for a mesh with polygons several triangles share a face, for
+  /// an indexed build this is the triangle
+  //----------------------------------------------------------------------------------------------------------------------
+  uint32_t getFace(uint32_t _triangle) const noexcept {return m_face[_triangle];}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the three vertex indices of a triangle
+  //----------------------------------------------------------------------------------------------------------------------
+  const uint32_t *getTriangle(uint32_t _triangle) const noexcept {return &m_indices[_triangle*3];}
+
+private :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief build from m_verts and m_indices
+  //----------------------------------------------------------------------------------------------------------------------
+  void buildTree();
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief recompute the leaf order triangle arrays from m_verts
+  //----------------------------------------------------------------------------------------------------------------------
+  void updateTriangles() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief test a ray against the triangles [_first,_first+_count) in leaf order
+  /// @param[in] _any return at the first hit rather than the nearest
+  /// @returns true if io_hit was changed
+  //----------------------------------------------------------------------------------------------------------------------
+  bool intersectLeaf(const Real *_origin, const Real *_dir, size_t _first, size_t _count, Real _tMin, bool _any,
+                     Hit &io_hit) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief trace one ray, the closest hit or any hit
+  //----------------------------------------------------------------------------------------------------------------------
+  bool trace(const Vec3 &_origin, const Vec3 &_dir, bool _any, Hit &io_hit) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief trace 4 rays together
+  //----------------------------------------------------------------------------------------------------------------------
+  void tracePacket(const Vec3 *_origins, const Vec3 *_dirs, Hit *io_hits) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the mesh, m_face holds the face of each triangle
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<Vec3> m_verts;
+  std::vector<uint32_t> m_indices;
+  std::vector<uint32_t> m_face;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the tree
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<Node> m_nodes;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief per triangle in leaf order the original triangle index and the first vertex and two edges as
+  /// x,y,z arrays (v0x,v0y,v0z,e1x..e2z) each padded by 3 so a leaf can always be loaded 4 at a time
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<uint32_t> m_triangle;
+  std::vector<Real> m_tri[9];
+};
+
+} // end namespace ngl
+
+#endif
@@ -0,0 +1,116 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MESHOPTIMIZER_H_
+#define MESHOPTIMIZER_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file MeshOptimizer.h
+/// @brief reorder indexed triangle lists for the post transform vertex cache, overdraw and vertex fetch
+//----------------------------------------------------------------------------------------------------------------------
+#include "Types.h"
+#include "Vec3.h"
+#include <cstdint>
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the results of simulating a post transform vertex cache over an index list
+//----------------------------------------------------------------------------------------------------------------------
+struct VertexCacheStats
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of vertices transformed, each cache miss
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t m_misses=0;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief average cache miss ratio, misses per triangle from 3 (no reuse) down to about 0.5 for a regular grid
+  //----------------------------------------------------------------------------------------------------------------------
+  Real m_acmr=0.0f;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief average transform to vertex ratio, misses per vertex used, 1 is ideal
+  //----------------------------------------------------------------------------------------------------------------------
+  Real m_atvr=0.0f;
+};
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the cache size used for the statistics and the overdraw clusters, a typical fifo post transform cache
+//----------------------------------------------------------------------------------------------------------------------
+constexpr unsigned int c_vertexCacheSize=16;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief simulate a fifo vertex cache over an index list
+/// @param[in] _indices the triangle list indices
+/// @param[in] _indexCount the number of indices, a multiple of 3
+/// @param[in] _vertexCount one more than the largest index
+/// @param[in] _cacheSize the number of entries in the cache
+/// @returns the misses, ACMR and ATVR
+//----------------------------------------------------------------------------------------------------------------------
+extern NGL_DLLEXPORT VertexCacheStats analyzeVertexCache(const uint32_t *_indices, size_t _indexCount, size_t _vertexCount, unsigned int _cacheSize=c_vertexCacheSize);
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief reorder the triangles so vertices are reused while still in the cache, using Forsyth's
+/// "Linear-Speed Vertex Cache Optimisation" which scores each vertex by its place in a simulated lru cache
+/// and how few triangles it has left, then repeatedly emits the best scoring triangle using the cached
+/// vertices. The result does not depend on the exact cache size of the gpu. The winding of each triangle is
+/// kept.
+/// @param[in,out] io_indices the triangle list indices, reordered in place
+/// @param[in] _indexCount the number of indices, a multiple of 3
+/// @param[in] _vertexCount one more than the largest index
+//----------------------------------------------------------------------------------------------------------------------
+extern NGL_DLLEXPORT void optimizeVertexCache(uint32_t *io_indices, size_t _indexCount, size_t _vertexCount);
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief reorder clusters of a cache optimised list so triangles facing outward from the middle of the mesh
+/// are drawn first and hide those behind them (Sander, Nehab and Barczak "Fast Triangle Reordering for
+/// Vertex Locality and Reduced Overdraw" 2007). The list is split where the cache is flushed and further
+/// where the miss ratio so far is within _threshold of the whole cluster, so the ACMR grows by at most
+/// about _threshold. Call after optimizeVertexCache.
+/// @param[in,out] io_indices the triangle list indices, reordered in place
+/// @param[in] _indexCount the number of indices, a multiple of 3
+/// @param[in] _positions the position of each vertex
+/// @param[in] _vertexCount the number of positions, one more than the largest index
+/// @param[in] _threshold how much worse than the cache optimised order the ACMR may get, 1 keeps it
+//----------------------------------------------------------------------------------------------------------------------
+extern NGL_DLLEXPORT void optimizeOverdraw(uint32_t *io_indices, size_t _indexCount, const Vec3 *_positions, size_t _vertexCount, Real _threshold=1.05f);
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief renumber the vertices in the order the triangles first use them so the vertex buffer is read
+/// from front to back, call last after the triangle reorders. Apply the remap to the vertex data with
+/// remapVertices.
+/// @param[in,out] io_indices the triangle list indices, rewritten to use the new numbering
+/// @param[in] _indexCount the number of indices
+/// @param[in] _vertexCount one more than the largest index
+/// @param[out] o_remap space for _vertexCount values, the new index of each old vertex or ~0u if unused
+/// @returns the number of vertices used, the size of the new vertex buffer
+//----------------------------------------------------------------------------------------------------------------------
+extern NGL_DLLEXPORT size_t optimizeVertexFetch(uint32_t *io_indices, size_t _indexCount, size_t _vertexCount, uint32_t *o_remap);
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief move vertex data into the order given by optimizeVertexFetch, unused vertices are dropped
+/// @param[in] _in the old vertices
+/// @param[in] _vertexCount the number of old vertices
+/// @param[in] _remap the remap from optimizeVertexFetch
+/// @param[out] o_out space for the number of used vertices, must not be _in
+//----------------------------------------------------------------------------------------------------------------------
+template<typename T>
+void remapVertices(const T *_in, size_t _vertexCount, const uint32_t *_remap, T *o_out)
+{
+  for(size_t i=0; i<_vertexCount; ++i)
+  {
+    if(_remap[i]!=~0u)
+    {
+      o_out[_remap[i]]=_in[i];
+    }
+  }
+}
+
+} // end namespace ngl
+
+#endif
@@ -0,0 +1,112 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MESHSIMPLIFY_H_
+#define MESHSIMPLIFY_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file MeshSimplify.h
+/// @brief quadric error edge collapse simplification of indexed triangle meshes and the building of LOD
+/// chains that share one vertex buffer
+//----------------------------------------------------------------------------------------------------------------------
+#include "Types.h"
+#include "Vec3.h"
+#include <cstdint>
+#include <vector>
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the settings for simplifyMesh and buildLODChain
+//----------------------------------------------------------------------------------------------------------------------
+struct NGL_DLLEXPORT SimplifyOptions
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief how much a change of normal / uv counts against a change of position, positions are measured
+  /// relative to the size of the mesh so 1 makes a unit normal change cost the same as moving by the whole
+  /// mesh size, 0 ignores the attribute
+  //----------------------------------------------------------------------------------------------------------------------
+  Real m_normalWeight=0.25f;
+  Real m_uvWeight=0.5f;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief keep the vertices on open edges where they are so the outline (and any cracks against
+  /// neighbouring meshes) doesn't change, otherwise they can only slide along the border
+  //----------------------------------------------------------------------------------------------------------------------
+  bool m_lockBorder=true;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief stop before a collapse with a larger geometric error than this, relative to the mesh size. The
+  /// error of a vertex is the root mean square distance (weighted by area) from it to the planes of the
+  /// original triangles that have been merged into it.
+  //----------------------------------------------------------------------------------------------------------------------
+  Real m_maxError=1.0f;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief one level of a LOD chain, a range of the shared index buffer
+//----------------------------------------------------------------------------------------------------------------------
+struct NGL_DLLEXPORT MeshLOD
+{
+  size_t m_indexOffset=0;
+  size_t m_indexCount=0;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the geometric error of the level in the units of the mesh positions, 0 for the full mesh and
+  /// never less than the level before
+  //----------------------------------------------------------------------------------------------------------------------
+  Real m_error=0.0f;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief simplify a triangle list by collapsing edges (Garland and Heckbert "Surface Simplification Using
+/// Quadric Error Metrics" 1997) in order of the error of the generalised quadric over the position, normal and
+/// uv (Garland and Heckbert 1998). Each collapse moves one vertex onto a neighbour so no new vertices are made
+/// and the result indexes the same vertex buffer. Vertices at the same position (seams where the normal or
+/// uv is split) are collapsed together and only along the seam, collapses that would fold a triangle over or
+/// make the mesh non manifold are skipped. The cheapest independent collapses are done in passes so large
+/// meshes are quick and the cost of each pass is split over threads.
+/// @param[in] _indices the triangle list
+/// @param[in] _indexCount the number of indices, a multiple of 3
+/// @param[in] _positions the vertex positions
+/// @param[in] _normals the vertex normals or nullptr
+/// @param[in] _uvs the vertex texture co-ordinates (x and y) or nullptr
+/// @param[in] _vertexCount the number of vertices
+/// @param[in] _targetIndexCount stop when there are this many indices or fewer
+/// @param[in] _options the weights, border handling and error limit
+/// @param[out] o_indices space for _indexCount indices, can be the same as _indices
+/// @param[out] o_error if not null the largest error (as SimplifyOptions::m_maxError) of the vertices left,
+/// relative to the mesh size
+/// @returns the number of indices written
+//----------------------------------------------------------------------------------------------------------------------
+extern NGL_DLLEXPORT size_t simplifyMesh(const uint32_t *_indices, size_t _indexCount, const Vec3 *_positions,
+                                         const Vec3 *_normals, const Vec3 *_uvs, size_t _vertexCount,
+                                         size_t _targetIndexCount, const SimplifyOptions &_options,
+                                         uint32_t *o_indices, Real *o_error=nullptr);
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief build a chain of LODs each with _ratio of the triangles of the one before, level 0 is the mesh
+/// as given. Every level is simplified from the full mesh so the levels are shared out over threads. The
+/// chain stops early once the error limit means a level can't get any smaller.
+/// @param[in] _levels the most levels to build including the full mesh
+/// @param[in] _ratio the fraction of triangles kept from one level to the next
+/// @param[out] o_indices replaced with the indices of all the levels one after the other
+/// @param[out] o_lods replaced with the range and error of each level
+/// the rest are as simplifyMesh
+//----------------------------------------------------------------------------------------------------------------------
+extern NGL_DLLEXPORT void buildLODChain(const uint32_t *_indices, size_t _indexCount, const Vec3 *_positions,
+                                        const Vec3 *_normals, const Vec3 *_uvs, size_t _vertexCount,
+                                        size_t _levels, Real _ratio, const SimplifyOptions &_options,
+                                        std::vector<uint32_t> &o_indices, std::vector<MeshLOD> &o_lods);
+
+} // end namespace ngl
+
+#endif
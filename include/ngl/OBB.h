@@ -0,0 +1,107 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef OBB_H_
+#define OBB_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file OBB.h
+/// @brief an oriented bounding box fitted to points
+//----------------------------------------------------------------------------------------------------------------------
+#include "Types.h"
+#include "Vec3.h"
+#include "Mat4.h"
+#include "Bounds3.h"
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @class OBB "include/ngl/OBB.h"
+/// @brief a box with its own orthonormal axes held as a centre, the three axes and the half size along each.
+/// fromPoints fits the axes with principal component analysis, the eigenvectors of the covariance of the
+/// points, which follows the main directions of long or flat meshes much more closely than an axis aligned
+/// box. The default box is empty (a negative half size).
+/// @version 1.0
+/// @date 16/10/16
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT OBB
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief default ctor an empty box on the world axes
+  //----------------------------------------------------------------------------------------------------------------------
+  OBB() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor from an axis aligned box
+  //----------------------------------------------------------------------------------------------------------------------
+  explicit OBB(const Bounds3 &_b) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief fit a box to some points, empty if there are none. The mean, covariance and the extents along
+  /// the axes are each a single pass over the points split over threads for large arrays. If the axis aligned
+  /// box is smaller (for example for points already lined up with the world axes) that is used instead.
+  /// @param[in] _points the points
+  /// @param[in] _count the number of points
+  //----------------------------------------------------------------------------------------------------------------------
+  static OBB fromPoints(const Vec3 *_points, size_t _count) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief true if the box has no points in it
+  //----------------------------------------------------------------------------------------------------------------------
+  bool isEmpty() const noexcept
+  {
+    return m_halfSize.m_x<0.0f || m_halfSize.m_y<0.0f || m_halfSize.m_z<0.0f;
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the volume of the box
+  //----------------------------------------------------------------------------------------------------------------------
+  Real volume() const noexcept {return isEmpty() ? 0.0f : 8.0f*m_halfSize.m_x*m_halfSize.m_y*m_halfSize.m_z;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief true if a point is inside the box
+  /// @param[in] _p the point
+  /// @param[in] _epsilon how far outside the faces still counts as inside
+  //----------------------------------------------------------------------------------------------------------------------
+  bool contains(const Vec3 &_p, Real _epsilon=0.0f) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the 8 corners of the box
+  /// @param[out] o_corners space for the 8 corners
+  //----------------------------------------------------------------------------------------------------------------------
+  void getCorners(Vec3 *o_corners) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the axis aligned box around this one
+  //----------------------------------------------------------------------------------------------------------------------
+  Bounds3 bounds() const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the box after a transform, the axes are transformed and renormalised with their lengths going
+  /// into the half size, so a shear gives a box that is no longer tight
+  /// @param[in] _m the matrix, points are transformed as p * _m
+  //----------------------------------------------------------------------------------------------------------------------
+  OBB transformed(const Mat4 &_m) const noexcept;
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the centre
+  //----------------------------------------------------------------------------------------------------------------------
+  Vec3 m_center;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the unit length, orthogonal axes of the box
+  //----------------------------------------------------------------------------------------------------------------------
+  Vec3 m_axis[3];
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief half the size of the box along each axis, negative for an empty box
+  //----------------------------------------------------------------------------------------------------------------------
+  Vec3 m_halfSize;
+};
+
+} // end namespace ngl
+
+#endif
@@ -0,0 +1,214 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef OCCLUSIONBUFFER_H_
+#define OCCLUSIONBUFFER_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file OcclusionBuffer.h
+/// @brief a software depth buffer for occlusion culling on the cpu
+//----------------------------------------------------------------------------------------------------------------------
+#include "Types.h"
+#include "Vec3.h"
+#include "Vec4.h"
+#include "Mat4.h"
+#include "Vec3Array.h"
+#include "AlignedAllocator.h"
+#include <cstdint>
+#include <vector>
+
+namespace ngl
+{
+class AABB;
+class BBox;
+class AbstractMesh;
+//----------------------------------------------------------------------------------------------------------------------
+/// @class OcclusionBuffer "include/ngl/OcclusionBuffer.h"
+/// @brief rasterises a few large occluder meshes into a small depth buffer (256x128 is usually plenty) and then
+/// tests the bounding boxes of other objects against it so the hidden ones need not be drawn. It needs no GL
+/// context so can be used headless (or on another thread while the gpu draws the last frame).
+/// The buffer is split into 64x32 pixel tiles which are rasterised on separate threads, each pixel row is
+/// filled 4 (SSE) or 8 (AVX) pixels at a time. The depth is z/w mapped to [0,1] with 0 at the near plane and
+/// the rows start at the bottom of the screen as in GL. A second coarse level holds the farthest depth of
+/// each 8x8 block of pixels so most of a box test only reads that level.
+/// A typical frame is
+/// @code
+/// occlusion.begin(camera.getVPMatrix());
+/// occlusion.drawOccluder(wall,wallTransform.getMatrix());
+/// occlusion.rasterise();
+/// occlusion.testBoxes(boundsMin,boundsMax,mask);
+/// @endcode
+/// Occluders are sampled at pixel centres so an occludee seen through a gap thinner than a pixel may be culled,
+/// the occluders should be kept inside the meshes they stand in for.
+/// @version 1.0
+/// @date 16/10/16
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT OcclusionBuffer
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the size of the tiles each thread rasterises and of the coarse depth blocks
+  //----------------------------------------------------------------------------------------------------------------------
+  static constexpr size_t c_tileWidth=64;
+  static constexpr size_t c_tileHeight=32;
+  static constexpr size_t c_blockSize=8;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor
+  /// @param[in] _width the width of the buffer in pixels
+  /// @param[in] _height the height of the buffer in pixels
+  //----------------------------------------------------------------------------------------------------------------------
+  OcclusionBuffer(size_t _width=256, size_t _height=128);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief change the size of the buffer, the depth is cleared
+  //----------------------------------------------------------------------------------------------------------------------
+  void resize(size_t _width, size_t _height);
+  size_t width() const noexcept {return m_width;}
+  size_t height() const noexcept {return m_height;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add an occluder mesh, this is done once and the mesh is then drawn each frame with drawOccluder
+  /// @param[in] _verts the vertices
+  /// @param[in] _numVerts the number of vertices
+  /// @param[in] _indices three vertex indices per triangle
+  /// @param[in] _numIndices the number of indices
+  /// @returns the id used to draw the occluder
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t addOccluder(const Vec3 *_verts, size_t _numVerts, const uint32_t *_indices, size_t _numIndices);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add the faces of a loaded mesh as an occluder, polygons are split into triangle fans
+  /// @param[in] _mesh the mesh
+  /// @returns the id used to draw the occluder
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t addOccluder(AbstractMesh &_mesh);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add an occluder from triangle data in the TNV format used by VAOPrimitives::createVAOFromHeader
+  /// (u,v,nx,ny,nz,x,y,z per vertex, three vertices per triangle)
+  /// @param[in] _data the interleaved data
+  /// @param[in] _size the number of Reals in _data
+  /// @returns the id used to draw the occluder
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t addOccluder(const Real *_data, size_t _size);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief remove all the occluder meshes
+  //----------------------------------------------------------------------------------------------------------------------
+  void clearOccluders() noexcept;
+  size_t numOccluders() const noexcept {return m_occluders.size();}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief start a frame, the list of occluders to draw is emptied
+  /// @param[in] _viewProject the view * projection matrix, for example Camera::getVPMatrix()
+  //----------------------------------------------------------------------------------------------------------------------
+  void begin(const Mat4 &_viewProject) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add an occluder to this frame
+  /// @param[in] _occluder the id from addOccluder
+  /// @param[in] _model the model matrix to draw it with
+  //----------------------------------------------------------------------------------------------------------------------
+  void drawOccluder(size_t _occluder, const Mat4 &_model=Mat4());
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief clear the depth and rasterise the occluders drawn since begin, this must be called before testing
+  //----------------------------------------------------------------------------------------------------------------------
+  void rasterise();
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief test a world space box against the buffer
+  /// @param[in] _min the minimum corner
+  /// @param[in] _max the maximum corner
+  /// @returns false if the box is behind the occluders or entirely off screen, a box crossing the near plane is
+  /// always visible
+  //----------------------------------------------------------------------------------------------------------------------
+  bool isVisible(const Vec3 &_min, const Vec3 &_max) const noexcept;
+  bool isVisible(const AABB &_box) const noexcept;
+  bool isVisible(const BBox &_box) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief test an array of boxes on several threads, bit i%32 of o_visible[i/32] is set if box i is visible,
+  /// the same layout as Frustum::cullBoxes so the two masks can be and'ed
+  /// @param[in] _min the minimum corners
+  /// @param[in] _max the maximum corners, must be the same size as _min
+  /// @param[out] o_visible the mask, must have space for (_min.size()+31)/32 words
+  //----------------------------------------------------------------------------------------------------------------------
+  void testBoxes(const Vec3Array &_min, const Vec3Array &_max, uint32_t *o_visible) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the depth of a pixel, 1 where nothing was drawn
+  //----------------------------------------------------------------------------------------------------------------------
+  Real getDepth(size_t _x, size_t _y) const noexcept {return m_depth[_y*m_stride+_x];}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the farthest depth in the 8x8 block holding a pixel
+  //----------------------------------------------------------------------------------------------------------------------
+  Real getBlockDepth(size_t _x, size_t _y) const noexcept
+  {
+    return m_blockDepth[(_y/c_blockSize)*(m_stride/c_blockSize)+_x/c_blockSize];
+  }
+
+private :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a triangle set up for rasterising, the edge functions are a*x+b*y+c with x,y in pixels and >= 0
+  /// inside, the depth is the plane m_depth[0]*x+m_depth[1]*y+m_depth[2]
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Triangle
+  {
+    Real m_edge[3][3];
+    Real m_depth[3];
+    int m_bounds[4];
+  };
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief an occluder mesh and one drawn this frame
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Occluder
+  {
+    std::vector<Vec3> m_verts;
+    std::vector<uint32_t> m_indices;
+  };
+  struct Draw
+  {
+    size_t m_occluder;
+    Mat4 m_model;
+  };
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief clip a clip space triangle to the near plane and set up what is left with addTriangle
+  //----------------------------------------------------------------------------------------------------------------------
+  void clipTriangle(const Vec4 &_a, const Vec4 &_b, const Vec4 &_c);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add a triangle in front of the near plane to m_triangles if it covers any pixels
+  //----------------------------------------------------------------------------------------------------------------------
+  void addTriangle(const Vec4 &_a, const Vec4 &_b, const Vec4 &_c);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief clear a tile, draw the triangles binned to it and build its coarse blocks
+  //----------------------------------------------------------------------------------------------------------------------
+  void rasteriseTile(size_t _tile) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the size, the rows are padded to whole tiles
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t m_width=0;
+  size_t m_height=0;
+  size_t m_stride=0;
+  size_t m_tilesX=0;
+  size_t m_tilesY=0;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the pixel depths and the farthest depth of each block
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<Real,AlignedAllocator<Real>> m_depth;
+  std::vector<Real> m_blockDepth;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the frame being drawn, the triangles and the indices of those touching each tile
+  //----------------------------------------------------------------------------------------------------------------------
+  Mat4 m_viewProject;
+  std::vector<Occluder> m_occluders;
+  std::vector<Draw> m_draws;
+  std::vector<Vec4> m_clipVerts;
+  std::vector<Triangle> m_triangles;
+  std::vector<std::vector<uint32_t>> m_bins;
+};
+
+} // end namespace ngl
+
+#endif
@@ -0,0 +1,67 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef PRECISIONCONVERT_H_
+#define PRECISIONCONVERT_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file PrecisionConvert.h
+/// @brief convert whole arrays of double precision data to the float types for upload to the gpu
+/// @note the RelativeTo versions subtract the origin (usually the camera position) in double precision
+/// before rounding, this keeps full float precision for anything near the origin however far it is from
+/// the world origin. The input and output arrays must not overlap. Large inputs are split across several threads.
+//----------------------------------------------------------------------------------------------------------------------
+#include "Types.h"
+#include "Vec3T.h"
+#include "Mat4T.h"
+#include <cstddef>
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief round an array of doubles to float
+/// @param[in] _in the values to convert
+/// @param[in] _count the number of values in _in
+/// @param[out] o_out the array to write the _count converted values to
+//----------------------------------------------------------------------------------------------------------------------
+extern NGL_DLLEXPORT void convertToFloat(const double *_in, size_t _count, Real *o_out) noexcept;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief round an array of Vec3d / Mat4d to the float Vec3 / Mat4
+/// @param[in] _in the values to convert
+/// @param[in] _count the number of elements in _in
+/// @param[out] o_out the array to write the _count converted elements to
+//----------------------------------------------------------------------------------------------------------------------
+extern NGL_DLLEXPORT void convertToFloat(const Vec3d *_in, size_t _count, Vec3 *o_out) noexcept;
+extern NGL_DLLEXPORT void convertToFloat(const Mat4d *_in, size_t _count, Mat4 *o_out) noexcept;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief convert points to float relative to _origin, this is (_in[i]-_origin) done in double
+/// @param[in] _in the points to convert
+/// @param[in] _count the number of points in _in
+/// @param[in] _origin the new origin
+/// @param[out] o_out the array to write the _count converted points to
+//----------------------------------------------------------------------------------------------------------------------
+extern NGL_DLLEXPORT void convertToFloatRelativeTo(const Vec3d *_in, size_t _count, const Vec3d &_origin, Vec3 *o_out) noexcept;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief convert matrices to float relative to _origin, each is the same as _in[i].toMat4RelativeTo(_origin)
+/// @param[in] _in the matrices to convert
+/// @param[in] _count the number of matrices in _in
+/// @param[in] _origin the new origin
+/// @param[out] o_out the array to write the _count converted matrices to
+//----------------------------------------------------------------------------------------------------------------------
+extern NGL_DLLEXPORT void convertToFloatRelativeTo(const Mat4d *_in, size_t _count, const Vec3d &_origin, Mat4 *o_out) noexcept;
+
+} // end namespace ngl
+
+#endif
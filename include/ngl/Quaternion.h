@@ -48,7 +48,7 @@ class NGL_DLLEXPORT Quaternion
   /// @param [in]  _y  -  the y component of the quaternion
   /// @param [in]  _z  -  the z component of the quaternion
   //----------------------------------------------------------------------------------------------------------------------
-  Quaternion(const Real _s=0.0f,const Real _x=0.0f,const Real _y=0.0f,const Real _z=0.0f) noexcept:
+  constexpr Quaternion(const Real _s=0.0f,const Real _x=0.0f,const Real _y=0.0f,const Real _z=0.0f) noexcept:
           m_s(_s),
           m_x(_x),
           m_y(_y),
@@ -72,12 +72,17 @@ class NGL_DLLEXPORT Quaternion
   /// @brief copy constructor
   /// @param [in]  _q  -  the quaternion to copy
   //----------------------------------------------------------------------------------------------------------------------
-  Quaternion(const Quaternion& _q ) noexcept:
+  constexpr Quaternion(const Quaternion& _q ) noexcept:
           m_s(_q.m_s),
           m_x(_q.m_x),
           m_y(_q.m_y),
           m_z(_q.m_z) {;}
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief assignment operator
+  /// @param [in]  _q  -  the quaternion to copy
+  //----------------------------------------------------------------------------------------------------------------------
+  Quaternion &operator=(const Quaternion &_q) noexcept=default;
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief method to set the quaternion values
   /// @param[in] _x the x value
   /// @param[in] _y the y value
@@ -95,22 +100,22 @@ class NGL_DLLEXPORT Quaternion
   /// @brief accesor for the scalar part
   /// @returns m_s the scalar part of the quaternion
   //----------------------------------------------------------------------------------------------------------------------
-  Real getS() const  noexcept{return m_s;}
+  constexpr Real getS() const  noexcept{return m_s;}
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief accesor for the x vector components
   /// @returns m_x the scalar part of the quaternion
   //----------------------------------------------------------------------------------------------------------------------
-  Real getX() const  noexcept{return m_x;}
+  constexpr Real getX() const  noexcept{return m_x;}
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief accesor for the y vector components
   /// @returns m_y the scalar part of the quaternion
   //----------------------------------------------------------------------------------------------------------------------
-  Real getY() const  noexcept{return m_y;}
+  constexpr Real getY() const  noexcept{return m_y;}
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief accesor for the z vector components
   /// @returns m_z the scalar part of the quaternion
   //----------------------------------------------------------------------------------------------------------------------
-  Real getZ() const  noexcept{return m_z;}
+  constexpr Real getZ() const  noexcept{return m_z;}
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief accesor for the  vector components as an Vec4
   /// @returns a vector
@@ -151,7 +156,7 @@ class NGL_DLLEXPORT Quaternion
   /// @param[in] _q the rhs quaternion argument
   /// @return  the result of the mutliplication (product)
   //----------------------------------------------------------------------------------------------------------------------
-  Quaternion operator *(const Quaternion& _q) const noexcept;
+  constexpr Quaternion operator *(const Quaternion& _q) const noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief  Perform a multiplication this and another quaternions
   /// sets the current quat q1 = q1*q2
@@ -163,7 +168,7 @@ class NGL_DLLEXPORT Quaternion
   /// @param[in] _s the rhs scalar argument
   /// @return  the result of the mutliplication q*s
   //----------------------------------------------------------------------------------------------------------------------
-  Quaternion operator *(Real _s ) const noexcept;
+  constexpr Quaternion operator *(Real _s ) const noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief  Perform a multiplication this and  a real scalar
   /// sets the current quat to q=q*_s
@@ -175,13 +180,13 @@ class NGL_DLLEXPORT Quaternion
   /// @param[in] _q the rhs quaternion argument
   /// @return  the result of the addition
   //----------------------------------------------------------------------------------------------------------------------
-  Quaternion operator +(const Quaternion& _q ) const noexcept;
+  constexpr Quaternion operator +(const Quaternion& _q ) const noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief  subtract two quaternions
   /// @param[in] _q the rhs quaternion argument
   /// @return  the result of the subtraction
   //----------------------------------------------------------------------------------------------------------------------
-  Quaternion operator -( const Quaternion& _q) const noexcept;
+  constexpr Quaternion operator -( const Quaternion& _q) const noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief  add _q to the current quaternion
   /// @param[in] _q the rhs quaternion argument
@@ -207,12 +212,12 @@ class NGL_DLLEXPORT Quaternion
   /// @brief  conjugate negate the vector part can also be done by the -() operator
   /// @returns the conjugate of the current quaternion
   //----------------------------------------------------------------------------------------------------------------------
-  Quaternion  conjugate() const  noexcept{return Quaternion(m_s,-m_x,-m_y,-m_z);}
+  constexpr Quaternion  conjugate() const  noexcept{return Quaternion(m_s,-m_x,-m_y,-m_z);}
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief  conjugate negate the vector part can also be done by the -() operator
   /// @returns the conjugate of the current quaternion
   //----------------------------------------------------------------------------------------------------------------------
-  Quaternion inverse()const  noexcept{return Quaternion(m_s,-m_x,-m_y,-m_z);}
+  constexpr Quaternion inverse()const  noexcept{return Quaternion(m_s,-m_x,-m_y,-m_z);}
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief  conjugate negate the vector part but for the current vector -
   /// @returns the conjugate of the current quaternion
@@ -223,7 +228,7 @@ class NGL_DLLEXPORT Quaternion
   /// the scalar part remains the same and we reverse the vector part
   /// @return  the conjugate of the quaternion
   //----------------------------------------------------------------------------------------------------------------------
-  Quaternion operator-() const noexcept {return Quaternion(m_s,-m_x,-m_y,-m_z ); }
+  constexpr Quaternion operator-() const noexcept {return Quaternion(m_s,-m_x,-m_y,-m_z ); }
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief test for equality
   /// @param [in] _q the quaternion to test against
@@ -313,6 +318,109 @@ class NGL_DLLEXPORT Quaternion
 
 }; // end of class
 
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the quaternion arithmetic is defined inline so it can be inlined into client loops,
+/// the library still exports out of line copies see Quaternion.cpp. The ctors and the non modifying
+/// operators are constexpr so constant rotations can be built at compile time
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Quaternion Quaternion::operator *(const Quaternion& _q)const noexcept
+{
+  // if we have two Quaternions Qa Qb we get the following
+  // Qa*Qb
+  // first we do the scalar parts SaSb - A . B (where A and B are  the vector parts) . the dot product
+  // then the vector part is of the form saB + sbA + A x B (X is the cross product)
+  return Quaternion((m_s*_q.m_s)-(m_x*_q.m_x+m_y*_q.m_y+m_z*_q.m_z),
+                    m_s*_q.m_x + _q.m_s*m_x + (m_y*_q.m_z-m_z*_q.m_y),
+                    m_s*_q.m_y + _q.m_s*m_y + (m_z*_q.m_x-m_x*_q.m_z),
+                    m_s*_q.m_z + _q.m_s*m_z + (m_x*_q.m_y-m_y*_q.m_x));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Quaternion::operator *=(const Quaternion& _q) noexcept
+{
+    // as we have already written the code to do the mult above re-use
+    *this=*this*_q;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Quaternion Quaternion::operator +(const Quaternion& _q) const noexcept
+{
+  return Quaternion(m_s+_q.m_s,m_x+_q.m_x,m_y+_q.m_y,m_z+_q.m_z);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Quaternion Quaternion::operator -(const Quaternion& _q) const noexcept
+{
+  return Quaternion(m_s-_q.m_s,m_x-_q.m_x,m_y-_q.m_y,m_z-_q.m_z);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Quaternion::operator +=(const Quaternion& _q) noexcept
+{
+  // re-call the code from above
+  *this=*this+_q;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Quaternion::operator -=(const Quaternion& _q) noexcept
+{
+  // re-call the code from above
+  *this=*this-_q;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Quaternion Quaternion::operator *(Real _s) const noexcept
+{
+  return Quaternion(m_s*_s,m_x*_s,m_y*_s,m_z*_s);
+
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Quaternion::operator *=(Real _s) noexcept
+{
+  m_s*=_s;
+  m_x*=_s;
+  m_y*=_s;
+  m_z*=_s;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Quaternion::normalise() noexcept
+{
+  Real inverseOverOne = 1.0f/magnitude();
+  m_s*=inverseOverOne;
+  m_x*=inverseOverOne;
+  m_y*=inverseOverOne;
+  m_z*=inverseOverOne;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline Real Quaternion::magnitude()const noexcept
+{
+  return static_cast<Real>( sqrt(m_s*m_s + m_x*m_x + m_y*m_y + m_z*m_z) );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline bool Quaternion::operator == (const Quaternion& _q)const noexcept
+{
+  return (
+          FCompare(_q.m_s,m_s) &&
+          FCompare(_q.m_x,m_x) &&
+          FCompare(_q.m_y,m_y) &&
+          FCompare(_q.m_z,m_z)
+         );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline Vec4 Quaternion::operator* (const Vec4 &_vec) const noexcept
+{
+  Quaternion temp=-*this;
+  Quaternion point(0.0,_vec.m_x,_vec.m_y,_vec.m_z);
+  point = temp*point* *this;
+  return Vec4(point.m_x,point.m_y,point.m_z,1.0);
+}
+
+
 
 }
 
@@ -0,0 +1,281 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef QUATERNIONT_H_
+#define QUATERNIONT_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file QuaternionT.h
+/// @brief a quaternion of any floating point precision to go with Vec3T and Mat4T
+//----------------------------------------------------------------------------------------------------------------------
+#include "Types.h"
+#include "Quaternion.h"
+#include "Vec3T.h"
+#include "Mat4T.h"
+#include <cmath>
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @class QuaternionT "include/QuaternionT.h"
+/// @brief Quaternion with the component type as a template parameter, this uses the same scalar + vector
+/// layout and rotation conventions as Quaternion so the float and double versions give the same matrices.
+/// Quaternion stays the float type used by the rest of the library.
+/// @version 1.0
+/// @date 16/10/16
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+class QuaternionT
+{
+public:
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the component type
+  //----------------------------------------------------------------------------------------------------------------------
+  using value_type=T;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief constructor with the scalar then the vector part as Quaternion
+  /// @param [in]  _s  -  the s component of the quaternion
+  /// @param [in]  _x  -  the x component of the quaternion
+  /// @param [in]  _y  -  the y component of the quaternion
+  /// @param [in]  _z  -  the z component of the quaternion
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr QuaternionT(T _s=T(0), T _x=T(0), T _y=T(0), T _z=T(0)) noexcept : m_s(_s), m_x(_x), m_y(_y), m_z(_z){}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief convert from another precision
+  /// @param [in]  _q  -  the quaternion to convert
+  //----------------------------------------------------------------------------------------------------------------------
+  template <typename U>
+  constexpr explicit QuaternionT(const QuaternionT<U> &_q) noexcept :
+    m_s(static_cast<T>(_q.m_s)), m_x(static_cast<T>(_q.m_x)), m_y(static_cast<T>(_q.m_y)), m_z(static_cast<T>(_q.m_z)){}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief convert from the float Quaternion
+  /// @param [in]  _q  -  the quaternion to convert
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr explicit QuaternionT(const Quaternion &_q) noexcept :
+    m_s(static_cast<T>(_q.getS())), m_x(static_cast<T>(_q.getX())), m_y(static_cast<T>(_q.getY())), m_z(static_cast<T>(_q.getZ())){}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief convert to the float Quaternion used by the rest of the library
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr Quaternion toQuaternion() const noexcept
+  {
+    return Quaternion(static_cast<Real>(m_s),static_cast<Real>(m_x),static_cast<Real>(m_y),static_cast<Real>(m_z));
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief quaternion multiplication
+  /// @param [in]  _q  -  the quaternion to multiply by
+  /// @returns this*_q
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr QuaternionT operator*(const QuaternionT &_q) const noexcept;
+  QuaternionT& operator*=(const QuaternionT &_q) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the component wise operators
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr QuaternionT operator*(T _s) const noexcept;
+  constexpr QuaternionT operator+(const QuaternionT &_q) const noexcept;
+  constexpr QuaternionT operator-(const QuaternionT &_q) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the conjugate (negated vector part), as Quaternion this is also the unary - operator
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr QuaternionT conjugate() const noexcept {return QuaternionT(m_s,-m_x,-m_y,-m_z);}
+  constexpr QuaternionT operator-() const noexcept {return QuaternionT(m_s,-m_x,-m_y,-m_z);}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the magnitude of the quaternion
+  //----------------------------------------------------------------------------------------------------------------------
+  T magnitude() const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief normalise to unit length
+  //----------------------------------------------------------------------------------------------------------------------
+  void normalise() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set from an axis and angle
+  /// @param[in] _axis the axis to rotate about, this is normalised
+  /// @param[in] _angle the angle in degrees
+  //----------------------------------------------------------------------------------------------------------------------
+  void fromAxisAngle(const Vec3T<T> &_axis, T _angle) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief rotate a point by this quaternion, as Quaternion::rotatePoint
+  /// @param[in] _p the point to rotate
+  /// @returns the rotated point
+  //----------------------------------------------------------------------------------------------------------------------
+  Vec3T<T> rotatePoint(const Vec3T<T> &_p) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the rotation matrix, the same layout as Quaternion::toMat4
+  //----------------------------------------------------------------------------------------------------------------------
+  Mat4T<T> toMat4T() const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief spherical linear interpolation, the same method as Quaternion::slerp
+  /// @param [in] _q1 the start
+  /// @param [in] _q2 the end
+  /// @param [in] _t the blend value 0-1
+  //----------------------------------------------------------------------------------------------------------------------
+  static QuaternionT slerp(const QuaternionT &_q1, const QuaternionT &_q2, T _t) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief check for equality uses FCompare as Quaternion does
+  /// @param [in] _q the quaternion to test against
+  //----------------------------------------------------------------------------------------------------------------------
+  bool operator==(const QuaternionT &_q) const noexcept;
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the scalar and vector parts
+  //----------------------------------------------------------------------------------------------------------------------
+  T m_s;
+  T m_x;
+  T m_y;
+  T m_z;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the precisions in use, Quaternion itself is the float version
+//----------------------------------------------------------------------------------------------------------------------
+using Quaternionf=QuaternionT<float>;
+using Quaterniond=QuaternionT<double>;
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+constexpr QuaternionT<T> QuaternionT<T>::operator*(const QuaternionT &_q) const noexcept
+{
+  // scalar part SaSb - A . B and vector part saB + sbA + A x B as Quaternion
+  return QuaternionT((m_s*_q.m_s)-(m_x*_q.m_x+m_y*_q.m_y+m_z*_q.m_z),
+                     m_s*_q.m_x + _q.m_s*m_x + (m_y*_q.m_z-m_z*_q.m_y),
+                     m_s*_q.m_y + _q.m_s*m_y + (m_z*_q.m_x-m_x*_q.m_z),
+                     m_s*_q.m_z + _q.m_s*m_z + (m_x*_q.m_y-m_y*_q.m_x));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline QuaternionT<T>& QuaternionT<T>::operator*=(const QuaternionT &_q) noexcept
+{
+  *this=*this*_q;
+  return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+constexpr QuaternionT<T> QuaternionT<T>::operator*(T _s) const noexcept
+{
+  return QuaternionT(m_s*_s,m_x*_s,m_y*_s,m_z*_s);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+constexpr QuaternionT<T> QuaternionT<T>::operator+(const QuaternionT &_q) const noexcept
+{
+  return QuaternionT(m_s+_q.m_s,m_x+_q.m_x,m_y+_q.m_y,m_z+_q.m_z);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+constexpr QuaternionT<T> QuaternionT<T>::operator-(const QuaternionT &_q) const noexcept
+{
+  return QuaternionT(m_s-_q.m_s,m_x-_q.m_x,m_y-_q.m_y,m_z-_q.m_z);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline T QuaternionT<T>::magnitude() const noexcept
+{
+  return std::sqrt(m_s*m_s + m_x*m_x + m_y*m_y + m_z*m_z);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline void QuaternionT<T>::normalise() noexcept
+{
+  T inverseOverOne=T(1)/magnitude();
+  m_s*=inverseOverOne;
+  m_x*=inverseOverOne;
+  m_y*=inverseOverOne;
+  m_z*=inverseOverOne;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline void QuaternionT<T>::fromAxisAngle(const Vec3T<T> &_axis, T _angle) noexcept
+{
+  Vec3T<T> axis=_axis;
+  axis.normalize();
+  T half=detail::radiansT(_angle)/T(2);
+  T sinAngle=std::sin(half);
+  m_s=std::cos(half);
+  m_x=axis.m_x*sinAngle;
+  m_y=axis.m_y*sinAngle;
+  m_z=axis.m_z*sinAngle;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline Vec3T<T> QuaternionT<T>::rotatePoint(const Vec3T<T> &_p) const noexcept
+{
+  QuaternionT point=conjugate()*QuaternionT(T(0),_p.m_x,_p.m_y,_p.m_z)* *this;
+  return Vec3T<T>(point.m_x,point.m_y,point.m_z);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline Mat4T<T> QuaternionT<T>::toMat4T() const noexcept
+{
+  T xx=m_x*m_x;
+  T xy=m_x*m_y;
+  T xz=m_x*m_z;
+  T xs=m_x*m_s;
+  T yy=m_y*m_y;
+  T yz=m_y*m_z;
+  T ys=m_y*m_s;
+  T zz=m_z*m_z;
+  T zs=m_z*m_s;
+  return Mat4T<T>(T(1)-T(2)*(yy+zz), T(2)*(xy+zs),       T(2)*(xz-ys),       T(0),
+                  T(2)*(xy-zs),       T(1)-T(2)*(xx+zz), T(2)*(yz+xs),       T(0),
+                  T(2)*(xz+ys),       T(2)*(yz-xs),       T(1)-T(2)*(xx+yy), T(0),
+                  T(0),               T(0),               T(0),               T(1));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline QuaternionT<T> QuaternionT<T>::slerp(const QuaternionT &_q1, const QuaternionT &_q2, T _t) noexcept
+{
+  T cosom=_q1.m_x*_q2.m_x + _q1.m_y*_q2.m_y + _q1.m_z*_q2.m_z + _q1.m_s*_q2.m_s;
+  QuaternionT end=_q2;
+  if(cosom < T(0))
+  {
+    cosom=-cosom;
+    end=end*T(-1);
+  }
+  T sclp, sclq;
+  if((T(1)-cosom) > T(0.0001))
+  {
+    T omega=std::acos(cosom);
+    T sinom=std::sin(omega);
+    sclp=std::sin((T(1)-_t)*omega)/sinom;
+    sclq=std::sin(_t*omega)/sinom;
+  }
+  else
+  {
+    // very close so do linear interp
+    sclp=T(1)-_t;
+    sclq=_t;
+  }
+  return _q1*sclp+end*sclq;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline bool QuaternionT<T>::operator==(const QuaternionT &_q) const noexcept
+{
+  return FCompare(_q.m_s,m_s) && FCompare(_q.m_x,m_x) && FCompare(_q.m_y,m_y) && FCompare(_q.m_z,m_z);
+}
+
+} // end namespace ngl
+
+#endif
@@ -0,0 +1,74 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SIMD_H_
+#define SIMD_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file SIMD.h
+/// @brief runtime CPU feature detection used to select the vectorised maths kernels
+//----------------------------------------------------------------------------------------------------------------------
+#include "Types.h"
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief NGL_SIMD_X86 is defined when the compiler can emit SSE2 intrinsics for the target, the SSE2 kernels
+/// are always built in this case, the AVX (and F16C half float) ones are compiled with a per function target
+/// attribute so the library itself does not need to be built with -mavx
+//----------------------------------------------------------------------------------------------------------------------
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define NGL_SIMD_X86
+  #if defined(__GNUC__) || defined(__clang__)
+    #define NGL_TARGET_AVX __attribute__((target("avx")))
+    #define NGL_TARGET_F16C __attribute__((target("avx,f16c")))
+  #else
+    #define NGL_TARGET_AVX
+    #define NGL_TARGET_F16C
+  #endif
+#endif
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the instruction set levels the maths kernels are written for, ordered so that a higher
+/// level implies all the lower ones are also available
+//----------------------------------------------------------------------------------------------------------------------
+enum class SIMDLevel : int {SCALAR=0,SSE2=1,AVX=2};
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief query the cpu (and os support for the wider registers) for the best level we can use
+/// @returns the highest SIMDLevel supported by this machine
+//----------------------------------------------------------------------------------------------------------------------
+extern NGL_DLLEXPORT SIMDLevel cpuSIMDLevel() noexcept;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the level currently used by the maths classes to choose a kernel, this defaults to
+/// cpuSIMDLevel() the first time it is called
+/// @returns the active SIMDLevel
+//----------------------------------------------------------------------------------------------------------------------
+extern NGL_DLLEXPORT SIMDLevel activeSIMDLevel() noexcept;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief override the active level, mainly for testing and benchmarking the scalar fallback. The value
+/// is clamped to what the cpu supports. The level is atomic so it is safe to call while other threads use
+/// the maths classes, but a batch already running may use either level.
+/// @param[in] _level the level to use
+//----------------------------------------------------------------------------------------------------------------------
+extern NGL_DLLEXPORT void setSIMDLevel(SIMDLevel _level) noexcept;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief true if the half float conversion instructions can be used, they need the cpu F16C bit and the
+/// AVX level to be active (so setting a lower level also tests the fallback)
+//----------------------------------------------------------------------------------------------------------------------
+extern NGL_DLLEXPORT bool useF16C() noexcept;
+
+} // end namespace ngl
+
+#endif
@@ -0,0 +1,209 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SCENEBVH_H_
+#define SCENEBVH_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file SceneBVH.h
+/// @brief a dynamic bounding volume hierarchy over the objects placed in a scene for culling and spatial queries
+//----------------------------------------------------------------------------------------------------------------------
+#include "Types.h"
+#include "Vec3.h"
+#include "Mat4.h"
+#include "Bounds3.h"
+#include <cstdint>
+#include <vector>
+
+namespace ngl
+{
+class BBox;
+class Camera;
+class Frustum;
+class Transformation;
+//----------------------------------------------------------------------------------------------------------------------
+/// @class SceneBVH "include/ngl/SceneBVH.h"
+/// @brief a tree of world space boxes over many objects, each object usually being a mesh BBox placed by a
+/// Transformation. Objects can be inserted, removed and moved one at a time: an object is inserted next to the
+/// sibling that grows the total box area least and the tree is kept balanced with rotations on the way back up.
+/// Each leaf keeps a box grown by a margin so an object that only moves a little stays where it is and move()
+/// costs nothing, only when it leaves that box is it taken out and put back in. After loading many objects at
+/// once or a lot of movement the tree can be rebuilt from scratch with rebuild(), the ids stay the same.
+/// The queries give the user data of every object whose box touches the frustum, sphere, box or ray. The
+/// frustum query drops whole subtrees outside the frustum and takes whole subtrees inside it without testing
+/// the objects in them.
+/// @version 1.0
+/// @date 16/10/16
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT SceneBVH
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the id of no object
+  //----------------------------------------------------------------------------------------------------------------------
+  static constexpr uint32_t c_null=~uint32_t(0);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor
+  /// @param[in] _margin how far the leaf boxes are grown each way so small moves need no update
+  //----------------------------------------------------------------------------------------------------------------------
+  explicit SceneBVH(Real _margin=0.1f) noexcept : m_margin(_margin) {}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add an object
+  /// @param[in] _min the minimum corner of its world box
+  /// @param[in] _max the maximum corner of its world box
+  /// @param[in] _userData returned by the queries, for example the index of the object in the scene
+  /// @returns the id of the object, this never changes until it is removed
+  //----------------------------------------------------------------------------------------------------------------------
+  uint32_t insert(const Vec3 &_min, const Vec3 &_max, size_t _userData);
+  uint32_t insert(const Bounds3 &_b, size_t _userData) {return insert(_b.m_min,_b.m_max,_userData);}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add an object from its local box, for example AbstractMesh::getBBox(), and its transform
+  /// @param[in] _box the local box
+  /// @param[in] _transform the model matrix, for example Transformation::getMatrix()
+  /// @param[in] _userData returned by the queries
+  //----------------------------------------------------------------------------------------------------------------------
+  uint32_t insert(const BBox &_box, const Mat4 &_transform, size_t _userData);
+  uint32_t insert(const BBox &_box, Transformation &_transform, size_t _userData);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief remove an object, its id may be reused
+  //----------------------------------------------------------------------------------------------------------------------
+  void remove(uint32_t _id) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the box of an object after it moves
+  /// @param[in] _id the object
+  /// @param[in] _min the minimum corner of its new world box
+  /// @param[in] _max the maximum corner of its new world box
+  /// @returns true if the tree changed, false if the box stayed inside the grown leaf box
+  //----------------------------------------------------------------------------------------------------------------------
+  bool move(uint32_t _id, const Vec3 &_min, const Vec3 &_max) noexcept;
+  bool move(uint32_t _id, const Bounds3 &_b) noexcept {return move(_id,_b.m_min,_b.m_max);}
+  bool move(uint32_t _id, const BBox &_box, const Mat4 &_transform) noexcept;
+  bool move(uint32_t _id, const BBox &_box, Transformation &_transform) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief rebuild the whole tree top down with the surface area heuristic, worth doing when getCost() has
+  /// grown a lot since the last build
+  //----------------------------------------------------------------------------------------------------------------------
+  void rebuild();
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief remove all the objects
+  //----------------------------------------------------------------------------------------------------------------------
+  void clear() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of objects
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t size() const noexcept {return m_size;}
+  bool empty() const noexcept {return m_size==0;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the data and the world box of an object
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t getUserData(uint32_t _id) const noexcept {return m_nodes[_id].m_userData;}
+  const Vec3 &getMin(uint32_t _id) const noexcept {return m_nodes[_id].m_tightMin;}
+  const Vec3 &getMax(uint32_t _id) const noexcept {return m_nodes[_id].m_tightMax;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the height of the tree, a leaf is 0
+  //----------------------------------------------------------------------------------------------------------------------
+  int getHeight() const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the total area of the inner boxes over the area of the root box, the lower the quicker the queries
+  //----------------------------------------------------------------------------------------------------------------------
+  Real getCost() const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the objects whose box is not outside a frustum
+  /// @param[in] _frustum the frustum, for example Camera::getFrustum()
+  /// @param[out] o_userData the user data of each object found is appended
+  //----------------------------------------------------------------------------------------------------------------------
+  void queryFrustum(const Frustum &_frustum, std::vector<size_t> &o_userData) const;
+  void queryFrustum(const Camera &_camera, std::vector<size_t> &o_userData) const;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the objects whose box touches a sphere
+  //----------------------------------------------------------------------------------------------------------------------
+  void querySphere(const Vec3 &_centre, Real _radius, std::vector<size_t> &o_userData) const;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the objects whose box overlaps a box
+  //----------------------------------------------------------------------------------------------------------------------
+  void queryBox(const Vec3 &_min, const Vec3 &_max, std::vector<size_t> &o_userData) const;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the objects whose box is hit by a ray, for example to find the meshes to test for picking
+  /// @param[in] _origin the start of the ray
+  /// @param[in] _dir the direction of the ray
+  /// @param[in] _tMax the length of the ray in multiples of _dir
+  //----------------------------------------------------------------------------------------------------------------------
+  void queryRay(const Vec3 &_origin, const Vec3 &_dir, Real _tMax, std::vector<size_t> &o_userData) const;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the world box of a local box under a transform
+  /// @param[in] _box the local box
+  /// @param[in] _transform the model matrix
+  /// @param[out] o_min the minimum corner
+  /// @param[out] o_max the maximum corner
+  //----------------------------------------------------------------------------------------------------------------------
+  static void transformBox(const BBox &_box, const Mat4 &_transform, Vec3 &o_min, Vec3 &o_max) noexcept;
+
+private :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a node, a leaf has no children and also keeps the exact box of its object. Free nodes are chained
+  /// through m_parent
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Node
+  {
+    Vec3 m_min;
+    Vec3 m_max;
+    Vec3 m_tightMin;
+    Vec3 m_tightMax;
+    uint32_t m_parent=c_null;
+    uint32_t m_child[2]={c_null,c_null};
+    int m_height=0;
+    size_t m_userData=0;
+    bool isLeaf() const noexcept {return m_child[0]==c_null;}
+  };
+  uint32_t allocateNode();
+  void freeNode(uint32_t _node) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief link a leaf into the tree next to the best sibling or take it out
+  //----------------------------------------------------------------------------------------------------------------------
+  void insertLeaf(uint32_t _leaf) noexcept;
+  void removeLeaf(uint32_t _leaf) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief refit the boxes and heights from _node to the root rotating unbalanced nodes on the way
+  //----------------------------------------------------------------------------------------------------------------------
+  void fixUpwards(uint32_t _node) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief rotate the taller grandchild of _node up if its children differ in height by more than one
+  /// @returns the node now in the place of _node
+  //----------------------------------------------------------------------------------------------------------------------
+  uint32_t balance(uint32_t _node) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the box and height of an inner node from its children
+  //----------------------------------------------------------------------------------------------------------------------
+  void refitNode(uint32_t _node) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief build a subtree over the leaves [_begin,_end) for rebuild
+  //----------------------------------------------------------------------------------------------------------------------
+  uint32_t buildRange(std::vector<uint32_t> &io_leaves, size_t _begin, size_t _end);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief walk the tree visiting the nodes _test passes, the leaves that pass are added
+  //----------------------------------------------------------------------------------------------------------------------
+  template<typename Test>
+  void query(Test _test, std::vector<size_t> &o_userData) const;
+
+  std::vector<Node> m_nodes;
+  uint32_t m_root=c_null;
+  uint32_t m_free=c_null;
+  size_t m_size=0;
+  Real m_margin;
+};
+
+} // end namespace ngl
+
+#endif
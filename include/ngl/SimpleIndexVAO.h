@@ -58,6 +58,12 @@ class NGL_DLLEXPORT SimpleIndexVAO : public AbstractVAO
     //----------------------------------------------------------------------------------------------------------------------
     virtual void draw() const;
     //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draw part of the index buffer using glDrawElements, for example one level of a LOD chain
+    /// @param[in] _first the first index to draw
+    /// @param[in] _count the number of indices to draw
+    //----------------------------------------------------------------------------------------------------------------------
+    void drawRange(size_t _first, size_t _count) const;
+    //----------------------------------------------------------------------------------------------------------------------
     /// @brief dtor don't do anything as the remove clears things
     //----------------------------------------------------------------------------------------------------------------------
     virtual ~SimpleIndexVAO();
@@ -101,6 +107,10 @@ class NGL_DLLEXPORT SimpleIndexVAO : public AbstractVAO
     //----------------------------------------------------------------------------------------------------------------------
     GLuint m_buffer=0;
     //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the id of the index buffer for the VAO
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint m_indexBuffer=0;
+    //----------------------------------------------------------------------------------------------------------------------
     /// @brief data type of the index data (e.g. GL_UNSIGNED_INT)
     //----------------------------------------------------------------------------------------------------------------------
     GLenum m_indexType;
@@ -0,0 +1,168 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef TRANSFORMHIERARCHY_H_
+#define TRANSFORMHIERARCHY_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file TransformHierarchy.h
+/// @brief a pool of parented transforms (for example the joints of a rig or a scene graph) with
+/// incremental world matrix updates
+//----------------------------------------------------------------------------------------------------------------------
+#include "Types.h"
+#include "Vec3.h"
+#include "Mat4.h"
+#include <vector>
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @class TransformHierarchy "include/ngl/TransformHierarchy.h"
+/// @brief holds nodes each with a local translate / rotate / scale and the index of its parent. A node can
+/// only be parented to one added before it so the nodes are always in topological order and the world matrices
+/// can be updated in one pass from first to last.
+/// Setting a local transform only flags that node, update() then recomputes the world matrix (and inverse)
+/// of the flagged nodes and their descendants, everything else is left as it is.
+/// The local matrix is built as Transformation does (scale * rotateX * rotateY * rotateZ then translate) and
+/// the world matrix is local * parent world, the same order as Vec4 * Mat4 so points go through the local
+/// transform first.
+/// @version 1.0
+/// @date 16/10/16
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT TransformHierarchy
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the parent index of a root node
+  //----------------------------------------------------------------------------------------------------------------------
+  static constexpr size_t c_noParent=~size_t(0);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add a node with an identity local transform
+  /// @param[in] _parent the index of the parent node, this must already exist, or c_noParent for a root
+  /// @returns the index of the new node
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t addNode(size_t _parent=c_noParent);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief remove all nodes
+  //----------------------------------------------------------------------------------------------------------------------
+  void clear() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief reserve space for _count nodes
+  //----------------------------------------------------------------------------------------------------------------------
+  void reserve(size_t _count);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of nodes
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t size() const noexcept {return m_parent.size();}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the parent of _node or c_noParent for a root
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t getParent(size_t _node) const noexcept {return m_parent[_node];}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the local translate / rotate (degrees in x,y,z) / scale of a node and flag it for update
+  /// @param[in] _node the node to set
+  /// @param[in] _v the new value
+  //----------------------------------------------------------------------------------------------------------------------
+  void setPosition(size_t _node, const Vec3 &_v) noexcept;
+  void setRotation(size_t _node, const Vec3 &_v) noexcept;
+  void setScale(size_t _node, const Vec3 &_v) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set all of the local transform of a node and flag it for update
+  /// @param[in] _node the node to set
+  /// @param[in] _position the translation
+  /// @param[in] _rotation the x,y,z rotations in degrees
+  /// @param[in] _scale the scale, each value must be non zero for the inverse
+  //----------------------------------------------------------------------------------------------------------------------
+  void setTransform(size_t _node, const Vec3 &_position, const Vec3 &_rotation, const Vec3 &_scale) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief accessors for the local transform values
+  //----------------------------------------------------------------------------------------------------------------------
+  const Vec3 &getPosition(size_t _node) const noexcept {return m_position[_node];}
+  const Vec3 &getRotation(size_t _node) const noexcept {return m_rotation[_node];}
+  const Vec3 &getScale(size_t _node) const noexcept {return m_scale[_node];}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief true if the node or one of its ancestors has changed since the last update
+  //----------------------------------------------------------------------------------------------------------------------
+  bool isDirty(size_t _node) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief recompute the world matrices of every changed node and its descendants in one pass
+  //----------------------------------------------------------------------------------------------------------------------
+  void update() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief as update but split over threads. When there are plenty of roots (a crowd of rigs) each tree is
+  /// given whole to a thread, otherwise (one big rig) the nodes at each depth are split over threads one depth
+  /// after another. Small hierarchies are just done with update(). The first call after nodes are added
+  /// allocates the update orders.
+  //----------------------------------------------------------------------------------------------------------------------
+  void updateParallel();
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the matrices of a node, the world versions are only valid after an update
+  //----------------------------------------------------------------------------------------------------------------------
+  const Mat4 &getLocalMatrix(size_t _node) const noexcept {return m_local[_node];}
+  const Mat4 &getWorldMatrix(size_t _node) const noexcept {return m_world[_node];}
+  const Mat4 &getInverseWorldMatrix(size_t _node) const noexcept {return m_worldInverse[_node];}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief all the world matrices in node order, for example to upload as a palette of joint matrices
+  //----------------------------------------------------------------------------------------------------------------------
+  const Mat4 *worldMatrices() const noexcept {return m_world.data();}
+
+private :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief update the nodes _order[_begin,_end) in that order
+  //----------------------------------------------------------------------------------------------------------------------
+  template<typename Index>
+  void updateNodes(Index _index, size_t _begin, size_t _end) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief rebuild the root and depth orders after nodes are added
+  //----------------------------------------------------------------------------------------------------------------------
+  void buildOrders();
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief per node data all indexed by node
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<size_t> m_parent;
+  std::vector<size_t> m_root;
+  std::vector<Vec3> m_position;
+  std::vector<Vec3> m_rotation;
+  std::vector<Vec3> m_scale;
+  std::vector<Mat4> m_local;
+  std::vector<Mat4> m_localInverse;
+  std::vector<Mat4> m_world;
+  std::vector<Mat4> m_worldInverse;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set when the local transform changes, cleared when the local matrix is rebuilt
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<unsigned char> m_localDirty;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set during an update for the nodes whose world matrix was recomputed, so children know to follow
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<unsigned char> m_worldChanged;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the nodes grouped by root (still in topological order in each group) for the parallel update,
+  /// group r is m_order[m_rootStart[r],m_rootStart[r+1])
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<size_t> m_order;
+  std::vector<size_t> m_rootStart;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the nodes grouped by depth (still in topological order in each group), depth d is
+  /// m_depthOrder[m_depthStart[d],m_depthStart[d+1])
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<size_t> m_depthOrder;
+  std::vector<size_t> m_depthStart;
+  bool m_orderValid=false;
+};
+
+} // end namespace ngl
+
+#endif
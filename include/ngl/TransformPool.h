@@ -0,0 +1,171 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef TRANSFORMPOOL_H_
+#define TRANSFORMPOOL_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file TransformPool.h
+/// @brief structure of arrays storage for large numbers of translate / rotate / scale transforms with the
+/// matrices rebuilt in one batch
+//----------------------------------------------------------------------------------------------------------------------
+#include "Types.h"
+#include "Vec3.h"
+#include "Vec3Array.h"
+#include "Mat4.h"
+#include <vector>
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @class TransformPool "include/ngl/TransformPool.h"
+/// @brief keeps the position, rotation and scale of every transform in separate Vec3Arrays and the
+/// matrices in one contiguous array. Setting a value only flags the slot, update() then rebuilds every
+/// flagged matrix (and inverse) in a single simd pass split over threads, so the result can be uploaded
+/// straight from matrices(). The matrices are built as Transformation does (scale * rotateX * rotateY *
+/// rotateZ then translate).
+/// A Transformation constructed with a pool uses a slot in it, so existing code can keep using
+/// Transformation while the pool does the work. Slots are never moved, a released slot is reset to the
+/// identity and reused by the next add.
+/// @version 1.0
+/// @date 16/10/16
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT TransformPool
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add a transform, a released slot is reused if there is one
+  /// @param[in] _position the translation
+  /// @param[in] _rotation the x,y,z rotations in degrees
+  /// @param[in] _scale the scale, each value must be non zero for the inverse
+  /// @returns the index of the slot
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t add(const Vec3 &_position=Vec3(0.0f,0.0f,0.0f), const Vec3 &_rotation=Vec3(0.0f,0.0f,0.0f),
+             const Vec3 &_scale=Vec3(1.0f,1.0f,1.0f));
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief give a slot back to the pool, it is set to the identity until it is reused
+  /// @param[in] _index the slot to release
+  //----------------------------------------------------------------------------------------------------------------------
+  void release(size_t _index);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief remove all slots
+  //----------------------------------------------------------------------------------------------------------------------
+  void clear() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief reserve space for _count slots
+  //----------------------------------------------------------------------------------------------------------------------
+  void reserve(size_t _count);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of slots including released ones, this is the length of matrices()
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t size() const noexcept {return m_dirty.size();}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the translate / rotate (degrees in x,y,z) / scale of a slot and flag it for update
+  /// @param[in] _index the slot to set
+  /// @param[in] _v the new value
+  //----------------------------------------------------------------------------------------------------------------------
+  void setPosition(size_t _index, const Vec3 &_v) noexcept;
+  void setRotation(size_t _index, const Vec3 &_v) noexcept;
+  void setScale(size_t _index, const Vec3 &_v) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set all of the transform of a slot and flag it for update
+  /// @param[in] _index the slot to set
+  /// @param[in] _position the translation
+  /// @param[in] _rotation the x,y,z rotations in degrees
+  /// @param[in] _scale the scale, each value must be non zero for the inverse
+  //----------------------------------------------------------------------------------------------------------------------
+  void setTransform(size_t _index, const Vec3 &_position, const Vec3 &_rotation, const Vec3 &_scale) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the matrices of a slot directly, they are kept until the transform values are next set
+  /// @param[in] _index the slot to set
+  /// @param[in] _m the matrix
+  /// @param[in] _inverse the inverse of _m
+  //----------------------------------------------------------------------------------------------------------------------
+  void setMatrix(size_t _index, const Mat4 &_m, const Mat4 &_inverse) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief accessors for the transform values
+  //----------------------------------------------------------------------------------------------------------------------
+  Vec3 getPosition(size_t _index) const noexcept {return m_position.get(_index);}
+  Vec3 getRotation(size_t _index) const noexcept {return m_rotation.get(_index);}
+  Vec3 getScale(size_t _index) const noexcept {return m_scale.get(_index);}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the component arrays, for example to animate every position with the Vec3Array operations,
+  /// call setAllDirty() after writing to them
+  //----------------------------------------------------------------------------------------------------------------------
+  Vec3Array &positions() noexcept {return m_position;}
+  Vec3Array &rotations() noexcept {return m_rotation;}
+  Vec3Array &scales() noexcept {return m_scale;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief true if the slot has changed since the last update
+  //----------------------------------------------------------------------------------------------------------------------
+  bool isDirty(size_t _index) const noexcept {return m_dirty[_index]!=0;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief flag every slot in use for update
+  //----------------------------------------------------------------------------------------------------------------------
+  void setAllDirty() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief rebuild the matrices of every flagged slot, large pools are split over several threads
+  //----------------------------------------------------------------------------------------------------------------------
+  void update() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief rebuild the matrices of one slot if it is flagged, used by Transformation so reading a single
+  /// matrix doesn't need a full update
+  /// @param[in] _index the slot to update
+  //----------------------------------------------------------------------------------------------------------------------
+  void update(size_t _index) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the matrices of a slot, only valid after an update
+  //----------------------------------------------------------------------------------------------------------------------
+  const Mat4 &getMatrix(size_t _index) const noexcept {return m_matrix[_index];}
+  const Mat4 &getInverseMatrix(size_t _index) const noexcept {return m_inverse[_index];}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief all the matrices in slot order, for example to upload as per instance data
+  //----------------------------------------------------------------------------------------------------------------------
+  const Mat4 *matrices() const noexcept {return m_matrix.data();}
+  const Mat4 *inverseMatrices() const noexcept {return m_inverse.data();}
+
+private :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief rebuild the flagged slots in [_begin,_end), _begin must be a multiple of 4
+  //----------------------------------------------------------------------------------------------------------------------
+  void updateRange(size_t _begin, size_t _end) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the transform values
+  //----------------------------------------------------------------------------------------------------------------------
+  Vec3Array m_position;
+  Vec3Array m_rotation;
+  Vec3Array m_scale;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set when the values of a slot change, cleared when its matrices are rebuilt
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<unsigned char> m_dirty;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief true if any slot may be flagged so an update with nothing to do returns straight away
+  //----------------------------------------------------------------------------------------------------------------------
+  bool m_anyDirty=false;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the matrices and inverses indexed by slot
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<Mat4> m_matrix;
+  std::vector<Mat4> m_inverse;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief released slots waiting to be reused
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<size_t> m_free;
+};
+
+} // end namespace ngl
+
+#endif
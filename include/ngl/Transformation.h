@@ -28,6 +28,7 @@
 
 namespace ngl
 {
+class TransformPool;
 //----------------------------------------------------------------------------------------------------------------------
 /// @enum decide which matrix is the current active matrix
 //----------------------------------------------------------------------------------------------------------------------
@@ -50,9 +51,20 @@ public:
   //----------------------------------------------------------------------------------------------------------------------
   Transformation() noexcept;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief Constructor using a slot in a TransformPool, the setters write through to the pool so its
+  /// batch update builds the matrix and the slot is released when this is destroyed
+  /// @param[in] _pool the pool to use, it must outlive this. Adding the slot can grow the pool so this
+  /// and copying a pooled transform can throw std::bad_alloc
+  //----------------------------------------------------------------------------------------------------------------------
+  explicit Transformation(TransformPool &_pool);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief dtor gives back the pool slot if there is one
+  //----------------------------------------------------------------------------------------------------------------------
+  ~Transformation() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief Copy Constructor
   //----------------------------------------------------------------------------------------------------------------------
-  Transformation(const Transformation &_t) noexcept;
+  Transformation(const Transformation &_t);
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief assignment operator
   //----------------------------------------------------------------------------------------------------------------------
@@ -191,6 +203,14 @@ public:
   //----------------------------------------------------------------------------------------------------------------------
   Mat4 getInverseMatrix() noexcept {  computeMatrices(); return m_inverseMatrix; }
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the pool this transform uses or nullptr if it is standalone
+  //----------------------------------------------------------------------------------------------------------------------
+  TransformPool *getPool() const noexcept { return m_pool; }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the slot used in the pool, only valid if getPool() isn't nullptr
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t getPoolIndex() const noexcept { return m_poolIndex; }
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief *= operator
   /// @param _m the transformation to combine
   //----------------------------------------------------------------------------------------------------------------------
@@ -248,9 +268,18 @@ protected :
   //----------------------------------------------------------------------------------------------------------------------
   Mat4 m_inverseMatrix;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief  the pool and slot when this is used as a handle
+  //----------------------------------------------------------------------------------------------------------------------
+  TransformPool *m_pool=nullptr;
+  size_t m_poolIndex=0;
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief method to compute the matrix, transpose and inverse matrix. set the m_bIsMatrixComputed variable to true.
   //----------------------------------------------------------------------------------------------------------------------
   void computeMatrices() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief flag the matrices for recompute and pass the new values to the pool if there is one
+  //----------------------------------------------------------------------------------------------------------------------
+  void valuesChanged() noexcept;
 
 };
 
@@ -23,7 +23,9 @@
 
 // must include types.h first for Real and GLEW if required
 #include "Types.h"
+#include "NGLassert.h"
 #include <array>
+#include <cmath>
 //----------------------------------------------------------------------------------------------------------------------
 /// @file Vec2.h
 /// @brief encapsulates a 2 float object like glsl Vec2 but not maths
@@ -78,7 +80,7 @@ public:
   /// @brief copy ctor
   /// @param[in] _v the value to set
   //----------------------------------------------------------------------------------------------------------------------
-  Vec2( const Vec2& _v)  noexcept :
+  constexpr Vec2( const Vec2& _v)  noexcept :
         m_x(_v.m_x),
         m_y(_v.m_y){;}
 
@@ -88,14 +90,14 @@ public:
   /// @param[in]  _y y value
   /// @param[in]  _w 1.0f default so acts as a points
   //----------------------------------------------------------------------------------------------------------------------
-   Vec2(Real _x=0.0, Real _y=0.0 )  noexcept:
+   constexpr Vec2(Real _x=0.0, Real _y=0.0 )  noexcept:
    m_x(_x),
    m_y(_y){;}
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief ctor using a single float all components are set to the value _x
   /// @param[in] _x the value to set all components
   //----------------------------------------------------------------------------------------------------------------------
-  Vec2( Real _x  )  noexcept:
+  constexpr Vec2( Real _x  )  noexcept:
   m_x(_x),
   m_y(_x){;}
 
@@ -143,7 +145,7 @@ public:
   /// @brief returns the length squared of the vector (no sqrt so quicker)
   /// @returns  \f$x^2+y^2\f$
   //----------------------------------------------------------------------------------------------------------------------
-  Real lengthSquared() const noexcept;
+  constexpr Real lengthSquared() const noexcept;
 
 
   //----------------------------------------------------------------------------------------------------------------------
@@ -151,14 +153,14 @@ public:
   /// @param[in]  &_v the value to add
   /// @returns the Vec2 + v
   //----------------------------------------------------------------------------------------------------------------------
-  Vec2 operator +( const Vec2 &_v  )const noexcept;
+  constexpr Vec2 operator +( const Vec2 &_v  )const noexcept;
 
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief divide Vec2 components by a scalar
   /// @param[in] _v the scalar to divide by
   /// @returns a Vec2 V(x/v,y/v,z/v,w)
   //----------------------------------------------------------------------------------------------------------------------
-  Vec2 operator/( Real _v )const noexcept;
+  constexpr Vec2 operator/( Real _v )const noexcept;
 
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief divide this Vec2 components by a scalar
@@ -177,14 +179,14 @@ public:
   /// @param[in]  &_v the value to sub
   /// @returns this - v
   //----------------------------------------------------------------------------------------------------------------------
-  Vec2 operator-( const Vec2& _v  )const noexcept;
+  constexpr Vec2 operator-( const Vec2& _v  )const noexcept;
 
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief * operator mult vevtor*Vec2
   /// @param[in]  _v the value to mult
   /// @returns new Vec2 this*v
   //----------------------------------------------------------------------------------------------------------------------
-  Vec2 operator*( const Vec2 &_v )const noexcept;
+  constexpr Vec2 operator*( const Vec2 &_v )const noexcept;
 
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief assignment operator set the current Vec2 to rhs
@@ -196,7 +198,7 @@ public:
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief negate the Vec2 components
   //----------------------------------------------------------------------------------------------------------------------
-  Vec2 operator-() const noexcept;
+  constexpr Vec2 operator-() const noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief check for equality uses FCompare (from Util.h) as float values
   /// @param[in] _v the Vec2 to check against
@@ -214,13 +216,13 @@ public:
   /// @param[in]  _v the value to div by
   /// @returns Vec2 / Vec2
   //----------------------------------------------------------------------------------------------------------------------
-  Vec2 operator/( const Vec2& _v )const noexcept;
+  constexpr Vec2 operator/( const Vec2& _v )const noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief this * i for each element
   /// @param[in]  _i the scalar to mult by
   /// @returns Vec2
   //----------------------------------------------------------------------------------------------------------------------
-  Vec2 operator *(  Real _i )const noexcept;
+  constexpr Vec2 operator *(  Real _i )const noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief Normalize the vector using
   /// \n \f$x=x/\sqrt{x^2+y^2} \f$
@@ -232,7 +234,7 @@ public:
   /// @param[in]  _b vector to dot current vector with
   /// @returns  the dot product
   //----------------------------------------------------------------------------------------------------------------------
-  Real dot( const Vec2 &_b  )const noexcept;
+  constexpr Real dot( const Vec2 &_b  )const noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief accesor to the m_openGL matrix returns the address of the 0th element
   //----------------------------------------------------------------------------------------------------------------------
@@ -277,13 +279,179 @@ public :
 
 };
 
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the Vec2 arithmetic is defined inline so it can be inlined into client loops,
+/// the library still exports out of line copies see Vec2.cpp
+//----------------------------------------------------------------------------------------------------------------------
+inline void Vec2::set(Real _x, Real _y) noexcept
+{
+  m_x=_x;
+  m_y=_y;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Vec2::set(const Vec2& _v  ) noexcept
+{
+   m_x=_v.m_x;
+   m_y=_v.m_y;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Vec2::set(const Vec2* _v ) noexcept
+{
+  m_x=_v->m_x;
+  m_y=_v->m_y;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Vec2::null() noexcept
+{
+  m_x=0.0f;
+  m_y=0.0f;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline Real& Vec2::operator[]( int _i) noexcept
+{
+  NGL_ASSERT(_i >=0 || _i<=2);
+  return (&m_x)[_i];
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Vec2 Vec2::operator-() const noexcept
+{
+  return Vec2(-m_x,-m_y);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Vec2::operator+=(const Vec2& _v  ) noexcept
+{
+  m_x+=_v.m_x;
+  m_y+=_v.m_y;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Vec2::operator/=(Real _v  ) noexcept
+{
+  NGL_ASSERT(_v !=0.0);
+  m_x/=_v;
+  m_y/=_v;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Vec2::operator*=(Real _v) noexcept
+{
+  m_x*=_v;
+  m_y*=_v;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Vec2::operator-=(const Vec2& _v ) noexcept
+{
+  m_x-=_v.m_x;
+  m_y-=_v.m_y;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Vec2 Vec2::operator/( Real _v )const noexcept
+{
+  return Vec2(m_x/_v,m_y/_v);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Vec2 Vec2::operator+(const Vec2& _v )const noexcept
+{
+  return Vec2(m_x+_v.m_x,m_y+_v.m_y);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Vec2 Vec2::operator-( const Vec2& _v  )const noexcept
+{
+  return Vec2(m_x-_v.m_x, m_y-_v.m_y );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline bool Vec2::operator==(const Vec2& _v )const noexcept
+{
+  return (
+          FCompare(_v.m_x,m_x)  &&
+          FCompare(_v.m_y,m_y)
+         );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline bool Vec2::operator!=(const Vec2& _v  )const noexcept
+{
+  return (
+          !FCompare(_v.m_x,m_x) ||
+          !FCompare(_v.m_y,m_y)
+         );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Vec2 Vec2::operator*(const Vec2& _v  )const noexcept
+{
+  return Vec2(
+                m_x*_v.m_x,
+                m_y*_v.m_y
+              );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Vec2 Vec2::operator/( const Vec2& _v )const noexcept
+{
+  return Vec2(m_x/_v.m_x, m_y/_v.m_y );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Vec2 Vec2::operator *(Real _i )const noexcept
+{
+  return Vec2(m_x*_i,m_y*_i );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline Vec2 & Vec2::operator=(const Vec2& _v) noexcept
+{
+  m_x = _v.m_x;
+  m_y = _v.m_y;
+  return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Vec2::normalize() noexcept
+{
+  Real len=sqrtf(m_x*m_x+m_y*m_y);
+  NGL_ASSERT(len!=0.0);
+  m_x/=len;
+  m_y/=len;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Real Vec2::dot(const Vec2& _v )const noexcept
+{
+  return m_x * _v.m_x + m_y * _v.m_y;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Real Vec2::lengthSquared() const noexcept
+{
+  return (m_x*m_x)+(m_y*m_y);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline Real Vec2::length() const noexcept
+{
+  return sqrtf((m_x*m_x)+(m_y*m_y));
+}
+
+
 //----------------------------------------------------------------------------------------------------------------------
 /// @brief scalar * vector operator
 /// @param _k the float value
 /// @param _v the vector value
 /// @returns a vector _k*v
 //----------------------------------------------------------------------------------------------------------------------
-inline Vec2 operator *(Real _k, const Vec2 &_v) noexcept
+constexpr Vec2 operator *(Real _k, const Vec2 &_v) noexcept
 {
   return Vec2(_k*_v.m_x, _k*_v.m_y);
 }
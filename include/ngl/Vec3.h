@@ -22,7 +22,9 @@
 //----------------------------------------------------------------------------------------------------------------------
 // must include types.h first for Real and GLEW if required
 #include "Types.h"
+#include "NGLassert.h"
 #include <array>
+#include <cmath>
 //----------------------------------------------------------------------------------------------------------------------
 /// @file Vec3.h
 /// @brief encapsulates a 3 float object like glsl vec3 but not maths
@@ -56,7 +58,7 @@ public:
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief default ctor use default and set to (0.0f,0.0f,0.0f) as attributes are initialised
   //----------------------------------------------------------------------------------------------------------------------
-  Vec3() : m_x(0.0f),m_y(0.0f),m_z(0.0f) {}
+  constexpr Vec3() : m_x(0.0f),m_y(0.0f),m_z(0.0f) {}
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief copy ctor we have POD data so let the compiler do the work!
   //----------------------------------------------------------------------------------------------------------------------
@@ -67,7 +69,7 @@ public:
   /// @param[in]  _y y value
   /// @param[in]  _z z value
   //----------------------------------------------------------------------------------------------------------------------
-  Vec3(Real _x,  Real _y, Real _z) noexcept:
+  constexpr Vec3(Real _x,  Real _y, Real _z) noexcept:
         m_x(_x),m_y(_y),m_z(_z){}
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief sets the Vec3 component from 3 values
@@ -91,7 +93,7 @@ public:
   /// @param[in]  _b vector to dot current vector with
   /// @returns  the dot product
   //----------------------------------------------------------------------------------------------------------------------
-  Real dot(const Vec3 &_b  )const noexcept;
+  constexpr Real dot(const Vec3 &_b  )const noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief clears the Vec3 to 0,0,0
   //----------------------------------------------------------------------------------------------------------------------
@@ -119,7 +121,7 @@ public:
   /// @param[in] _v the vector to calculate inner product with
   /// @returns the inner product
   //----------------------------------------------------------------------------------------------------------------------
-  Real inner(const Vec3& _v)const noexcept;
+  constexpr Real inner(const Vec3& _v)const noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief compute the outer product of this vector and vector (requested by PJ)
   /// @param[in] _v the vector to calc against
@@ -136,7 +138,7 @@ public:
   /// @brief returns the length squared of the vector (no sqrt so quicker)
   /// @returns  \f$x^2+y^2+z^2 \f$
   //----------------------------------------------------------------------------------------------------------------------
-  Real lengthSquared() const noexcept;
+  constexpr Real lengthSquared() const noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief += operator add Vec3 v to current Vec3
   /// @param[in]  &_v Vec3 to add
@@ -152,19 +154,19 @@ public:
   /// @param[in]  _i the scalar to mult by
   /// @returns Vec3
   //----------------------------------------------------------------------------------------------------------------------
-  Vec3 operator *( Real _i )const noexcept;
+  constexpr Vec3 operator *( Real _i )const noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief + operator add Vec3+Vec3
   /// @param[in]  &_v the value to add
   /// @returns the Vec3 + v
   //----------------------------------------------------------------------------------------------------------------------
-  Vec3 operator +(const Vec3 &_v )const noexcept;
+  constexpr Vec3 operator +(const Vec3 &_v )const noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief divide Vec3 components by a scalar
   /// @param[in] _v the scalar to divide by
   /// @returns a Vec3 V(x/v,y/v,z/v,w)
   //----------------------------------------------------------------------------------------------------------------------
-  Vec3 operator/(Real _v  )const noexcept;
+  constexpr Vec3 operator/(Real _v  )const noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief divide this Vec3 components by a scalar
   /// @param[in] _v the scalar to divide by
@@ -182,13 +184,13 @@ public:
   /// @param[in]  &_v the value to sub
   /// @returns this - v
   //----------------------------------------------------------------------------------------------------------------------
-  Vec3 operator-(const Vec3  &_v   )const noexcept;
+  constexpr Vec3 operator-(const Vec3  &_v   )const noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief * operator mult vevtor*Vec3
   /// @param[in]  _v the value to mult
   /// @returns new Vec3 this*v
   //----------------------------------------------------------------------------------------------------------------------
-  Vec3 operator*( const Vec3 &_v  )const noexcept;
+  constexpr Vec3 operator*( const Vec3 &_v  )const noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief assignment operator set the current Vec3 to rhs
   /// @param[in] _v the Vec3 to set
@@ -216,7 +218,7 @@ public:
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief negate the Vec3 components
   //----------------------------------------------------------------------------------------------------------------------
-  Vec3 operator-() const noexcept;
+  constexpr Vec3 operator-() const noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief check for equality uses FCompare (from Util.h) as float values
   /// @param[in] _v the Vec3 to check against
@@ -234,7 +236,7 @@ public:
   /// @param[in]  _v the value to div by
   /// @returns Vec3 / Vec3
   //----------------------------------------------------------------------------------------------------------------------
-  Vec3 operator/( const Vec3& _v )const noexcept;
+  constexpr Vec3 operator/( const Vec3& _v )const noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief set the Vec3 as the cross product from 2 other Vec3
   /// @param[in]  _v1 the first vector
@@ -246,7 +248,7 @@ public:
   /// @param[in]  _b the vector cross this with
   /// @returns  the result of this cross b
   //----------------------------------------------------------------------------------------------------------------------
-  Vec3 cross(const Vec3& _b )const noexcept;
+  constexpr Vec3 cross(const Vec3& _b )const noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief clamp the vector values between _min and _max
   /// @param[in]  _min value
@@ -271,31 +273,31 @@ public:
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief simple static method to return Y up vector
   //----------------------------------------------------------------------------------------------------------------------
-  static Vec3 up()  {return Vec3(0.0f,1.0f,0.0f); }
+  static constexpr Vec3 up()  {return Vec3(0.0f,1.0f,0.0f); }
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief simple static method to return Y down vector
   //----------------------------------------------------------------------------------------------------------------------
-  static Vec3 down()  {return Vec3(0.0f,-1.0f,0.0f); }
+  static constexpr Vec3 down()  {return Vec3(0.0f,-1.0f,0.0f); }
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief simple static method to return X left vector
   //----------------------------------------------------------------------------------------------------------------------
-  static Vec3 left()  {return Vec3(-1.0f,0.0f,0.0f); }
+  static constexpr Vec3 left()  {return Vec3(-1.0f,0.0f,0.0f); }
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief simple static method to return X right vector
   //----------------------------------------------------------------------------------------------------------------------
-  static Vec3 right()  {return Vec3(1.0f,0.0f,0.0f); }
+  static constexpr Vec3 right()  {return Vec3(1.0f,0.0f,0.0f); }
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief simple static method to return Z out vector
   //----------------------------------------------------------------------------------------------------------------------
-  static Vec3 in()  {return Vec3(0.0f,0.0f,1.0f); }
+  static constexpr Vec3 in()  {return Vec3(0.0f,0.0f,1.0f); }
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief simple static method to return Z in vector
   //----------------------------------------------------------------------------------------------------------------------
-  static Vec3 out()  {return Vec3(0.0f,0.0f,-1.0f); }
+  static constexpr Vec3 out()  {return Vec3(0.0f,0.0f,-1.0f); }
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief simple static method to return zero vector
   //----------------------------------------------------------------------------------------------------------------------
-  static Vec3 zero()  {return Vec3(0.0f,0.0f,0.0f); }
+  static constexpr Vec3 zero()  {return Vec3(0.0f,0.0f,0.0f); }
 
 /// @note I've made this public as some compilers automatically make the
 /// anonymous unions public whereas clang++ complains see this post
@@ -332,13 +334,242 @@ public :
   std::array<Real,3> m_openGL;
   };
 };
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the Vec3 arithmetic is defined inline so it can be inlined into client loops,
+/// the library still exports out of line copies see Vec3.cpp
+//----------------------------------------------------------------------------------------------------------------------
+inline void Vec3::set(Real _x,   Real _y,  Real _z ) noexcept
+{
+  m_x=_x;
+  m_y=_y;
+  m_z=_z;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Vec3::set( const Vec3& _v ) noexcept
+{
+   m_x=_v.m_x;
+   m_y=_v.m_y;
+   m_z=_v.m_z;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Real Vec3::dot( const Vec3& _v  )const noexcept
+{
+  return m_x * _v.m_x + m_y * _v.m_y + m_z * _v.m_z;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Vec3::null() noexcept
+{
+  m_x=0.0f;
+  m_y=0.0f;
+  m_z=0.0f;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline Real& Vec3::operator[](size_t & _i ) noexcept
+{
+  NGL_ASSERT(_i >=0 || _i<=3);
+  return (&m_x)[_i];
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Vec3 Vec3::operator-() const noexcept
+{
+  return Vec3(-m_x,-m_y,-m_z);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Vec3::operator+=(const Vec3& _v) noexcept
+{
+  m_x+=_v.m_x;
+  m_y+=_v.m_y;
+  m_z+=_v.m_z;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Vec3::operator/=(Real _v) noexcept
+{
+  NGL_ASSERT(_v !=0.0f);
+  m_x/=_v;
+  m_y/=_v;
+  m_z/=_v;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Vec3::operator*=(Real _v) noexcept
+{
+  m_x*=_v;
+  m_y*=_v;
+  m_z*=_v;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Vec3::operator-=(const Vec3& _v) noexcept
+{
+  m_x-=_v.m_x;
+  m_y-=_v.m_y;
+  m_z-=_v.m_z;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Vec3 Vec3::operator/(Real _v)const noexcept
+{
+  return Vec3(m_x/_v,m_y/_v,m_z/_v);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Vec3 Vec3::operator+( const Vec3& _v)const noexcept
+{
+  return Vec3(m_x+_v.m_x,m_y+_v.m_y,m_z+_v.m_z);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Vec3 Vec3::operator-(const Vec3& _v)const noexcept
+{
+  return Vec3(m_x-_v.m_x,m_y-_v.m_y,m_z-_v.m_z);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline bool Vec3::operator==(const Vec3& _v)const noexcept
+{
+  return (
+          FCompare(_v.m_x,m_x)  &&
+          FCompare(_v.m_y,m_y)  &&
+          FCompare(_v.m_z,m_z)
+         );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline bool Vec3::operator!=(const Vec3& _v  )const noexcept
+{
+  return (
+          !FCompare(_v.m_x,m_x) ||
+          !FCompare(_v.m_y,m_y) ||
+          !FCompare(_v.m_z,m_z)
+         );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Vec3 Vec3::operator*( const Vec3& _v  )const noexcept
+{
+  return Vec3(m_x*_v.m_x,m_y*_v.m_y,m_z*_v.m_z );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Vec3 Vec3::operator/( const Vec3& _v )const noexcept
+{
+  return Vec3(m_x/_v.m_x,m_y/_v.m_y,m_z/_v.m_z);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Vec3 Vec3::operator *(Real _i)const noexcept
+{
+  return Vec3(m_x*_i,m_y*_i,m_z*_i);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline Vec3 & Vec3::operator=(Real _v) noexcept
+{
+  m_x = _v;
+  m_y = _v;
+  m_z = _v;
+  return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Vec3::cross(const Vec3& _v1, const Vec3& _v2) noexcept
+{
+  m_x=_v1.m_y*_v2.m_z-_v1.m_z*_v2.m_y;
+  m_y=_v1.m_z*_v2.m_x-_v1.m_x*_v2.m_z;
+  m_z=_v1.m_x*_v2.m_y-_v1.m_y*_v2.m_x;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Vec3 Vec3::cross( const Vec3& _v )const noexcept
+{
+  return Vec3(m_y*_v.m_z - m_z*_v.m_y,
+              m_z*_v.m_x - m_x*_v.m_z,
+              m_x*_v.m_y - m_y*_v.m_x
+             );
+
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Vec3::normalize() noexcept
+{
+  Real len=sqrtf(m_x*m_x+m_y*m_y+m_z*m_z);
+  NGL_ASSERT(len!=0.0f);
+  m_x/=len;
+  m_y/=len;
+  m_z/=len;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Real Vec3::inner( const Vec3& _v  )const noexcept
+{
+  return ((m_x * _v.m_x) +(m_y * _v.m_y) + (m_z * _v.m_z));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline Real Vec3::length() const noexcept
+{
+  return sqrtf((m_x*m_x)+(m_y*m_y)+(m_z*m_z));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Real Vec3::lengthSquared() const noexcept
+{
+  return m_x * m_x+m_y * m_y+ m_z*m_z;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline Vec3 Vec3::reflect(const Vec3 & _n) const noexcept
+{
+ float d=this->dot(_n);
+ //  I - 2.0 * dot(N, I) * N
+ return Vec3( m_x-2.0f*d*_n.m_x, m_y-2.0f*d*_n.m_y, m_z-2.0f*d*_n.m_z);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Vec3::clamp(float _min, float _max ) noexcept
+{
+  m_x<_min ? m_x = _min : m_x;
+  m_x>_max ? m_x = _max : m_x;
+
+  m_y<_min ? m_y = _min : m_y;
+  m_y>_max ? m_y = _max : m_y;
+
+  m_z<_min ? m_z = _min : m_z;
+  m_z>_max ? m_z = _max : m_z;
+
+
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Vec3::clamp(float _max ) noexcept
+{
+  m_x<-_max ? m_x = -_max : m_x;
+  m_x>_max ? m_x = _max : m_x;
+
+  m_y<-_max ? m_y = -_max : m_y;
+  m_y>_max ? m_y = _max : m_y;
+
+  m_z<-_max ? m_z = -_max : m_z;
+  m_z>_max ? m_z = _max : m_z;
+
+
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 /// @brief scalar * vector operator
 /// @param _k the float value
 /// @param _v the vector value
 /// @returns a vector _k*v
 //----------------------------------------------------------------------------------------------------------------------
-inline Vec3 operator *(Real _k, const Vec3 &_v) noexcept
+constexpr Vec3 operator *(Real _k, const Vec3 &_v) noexcept
 {
   return Vec3(_k*_v.m_x, _k*_v.m_y, _k*_v.m_z);
 }
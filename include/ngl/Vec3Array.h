@@ -0,0 +1,174 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef VEC3ARRAY_H_
+#define VEC3ARRAY_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file Vec3Array.h
+/// @brief structure of arrays container for large numbers of Vec3 with simd bulk operations
+//----------------------------------------------------------------------------------------------------------------------
+#include "Types.h"
+#include "AlignedAllocator.h"
+#include "Vec3.h"
+#include <vector>
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @class Vec3Array "include/Vec3Array.h"
+/// @brief stores n Vec3 as three aligned x, y and z arrays so the bulk operations can use aligned simd
+/// loads on whole registers, use this instead of std::vector<Vec3> for particles / deformers etc.
+/// The bulk operations split very large arrays over several threads. Where two arrays are used
+/// the operation is done over the smaller of the two sizes.
+/// @version 1.0
+/// @date 16/10/16
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT Vec3Array
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the component storage type, the arrays are padded to a multiple of 8 elements
+  //----------------------------------------------------------------------------------------------------------------------
+  using Storage=std::vector<Real,AlignedAllocator<Real>>;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief default ctor empty array
+  //----------------------------------------------------------------------------------------------------------------------
+  Vec3Array()=default;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief create an array of _size zero vectors
+  /// @param[in] _size the number of elements
+  //----------------------------------------------------------------------------------------------------------------------
+  explicit Vec3Array(size_t _size);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief create from packed Vec3 data
+  /// @param[in] _v the array of Vec3 to copy
+  /// @param[in] _count the number of elements in _v
+  //----------------------------------------------------------------------------------------------------------------------
+  Vec3Array(const Vec3 *_v, size_t _count);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief create from a std::vector of Vec3
+  /// @param[in] _v the vector to copy
+  //----------------------------------------------------------------------------------------------------------------------
+  explicit Vec3Array(const std::vector<Vec3> &_v);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of elements
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t size() const noexcept {return m_size;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief true if there are no elements
+  //----------------------------------------------------------------------------------------------------------------------
+  bool empty() const noexcept {return m_size==0;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief resize the array, new elements are zero
+  /// @param[in] _size the new number of elements
+  //----------------------------------------------------------------------------------------------------------------------
+  void resize(size_t _size);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief remove all elements
+  //----------------------------------------------------------------------------------------------------------------------
+  void clear() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add an element to the end of the array
+  /// @param[in] _v the value to add
+  //----------------------------------------------------------------------------------------------------------------------
+  void push_back(const Vec3 &_v);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief get the element at _i as a Vec3
+  /// @param[in] _i the index
+  //----------------------------------------------------------------------------------------------------------------------
+  Vec3 get(size_t _i) const noexcept {return Vec3(m_x[_i],m_y[_i],m_z[_i]);}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the element at _i
+  /// @param[in] _i the index
+  /// @param[in] _v the value to set
+  //----------------------------------------------------------------------------------------------------------------------
+  void set(size_t _i, const Vec3 &_v) noexcept {m_x[_i]=_v.m_x; m_y[_i]=_v.m_y; m_z[_i]=_v.m_z;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief direct access to the aligned component arrays
+  //----------------------------------------------------------------------------------------------------------------------
+  Real *x() noexcept {return m_x.data();}
+  Real *y() noexcept {return m_y.data();}
+  Real *z() noexcept {return m_z.data();}
+  const Real *x() const noexcept {return m_x.data();}
+  const Real *y() const noexcept {return m_y.data();}
+  const Real *z() const noexcept {return m_z.data();}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief replace the contents with packed Vec3 data
+  /// @param[in] _v the array of Vec3 to copy
+  /// @param[in] _count the number of elements in _v
+  //----------------------------------------------------------------------------------------------------------------------
+  void fromAoS(const Vec3 *_v, size_t _count);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief copy the contents to packed Vec3 data
+  /// @param[out] o_v the array to write, must have space for size() elements
+  //----------------------------------------------------------------------------------------------------------------------
+  void toAoS(Vec3 *o_v) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief copy the contents to a std::vector of Vec3
+  /// @returns the packed data
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<Vec3> toAoS() const;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief element wise dot product with _b
+  /// @param[in] _b the other array
+  /// @param[out] o_out array of results, must have space for the smaller of the two sizes
+  //----------------------------------------------------------------------------------------------------------------------
+  void dot(const Vec3Array &_b, Real *o_out) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief element wise length
+  /// @param[out] o_out array of results, must have space for size() elements
+  //----------------------------------------------------------------------------------------------------------------------
+  void length(Real *o_out) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief normalize every element in place, unlike Vec3::normalize zero length vectors are left as zero
+  //----------------------------------------------------------------------------------------------------------------------
+  void normalize() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief element wise cross product this x _b
+  /// @param[in] _b the other array
+  /// @param[out] o_out the result, resized to fit, may be this or _b
+  //----------------------------------------------------------------------------------------------------------------------
+  void cross(const Vec3Array &_b, Vec3Array &o_out) const;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief element wise linear interpolation this+(_b-this)*_t
+  /// @param[in] _b the other array
+  /// @param[in] _t the blend value
+  /// @param[out] o_out the result, resized to fit, may be this or _b
+  //----------------------------------------------------------------------------------------------------------------------
+  void lerp(const Vec3Array &_b, Real _t, Vec3Array &o_out) const;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the per component minimum and maximum of all the elements, both are set to zero for an empty array
+  /// @param[out] o_min the minimum values
+  /// @param[out] o_max the maximum values
+  //----------------------------------------------------------------------------------------------------------------------
+  void minMax(Vec3 &o_min, Vec3 &o_max) const noexcept;
+
+private :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of elements in use
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t m_size=0;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the component arrays
+  //----------------------------------------------------------------------------------------------------------------------
+  Storage m_x;
+  Storage m_y;
+  Storage m_z;
+};
+
+} // end namespace ngl
+
+#endif
@@ -0,0 +1,328 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef VEC3T_H_
+#define VEC3T_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file Vec3T.h
+/// @brief a 3 tuple of any floating point precision, used with Vec3d for large world positions
+//----------------------------------------------------------------------------------------------------------------------
+#include "Types.h"
+#include "Vec3.h"
+#include "NGLassert.h"
+#include <cmath>
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @class Vec3T "include/Vec3T.h"
+/// @brief Vec3 with the component type as a template parameter. Vec3 stays the float type used by the rest
+/// of the library (and the one with the simd paths), Vec3T<double> is for positions that lose precision as
+/// floats such as large world coordinates. Converting between precisions is always explicit, to go to the
+/// gpu use toVec3 or convertToFloat (see PrecisionConvert.h) for whole arrays.
+/// @version 1.0
+/// @date 16/10/16
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+class Vec3T
+{
+public:
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the component type
+  //----------------------------------------------------------------------------------------------------------------------
+  using value_type=T;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor defaults to (0,0,0)
+  /// @param[in]  _x the x value
+  /// @param[in]  _y the y value
+  /// @param[in]  _z the z value
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr Vec3T(T _x=T(0), T _y=T(0), T _z=T(0)) noexcept : m_x(_x), m_y(_y), m_z(_z){}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief convert from another precision, narrowing to float should use toVec3 or convertToFloat
+  /// @param[in]  _v the vector to convert
+  //----------------------------------------------------------------------------------------------------------------------
+  template <typename U>
+  constexpr explicit Vec3T(const Vec3T<U> &_v) noexcept :
+    m_x(static_cast<T>(_v.m_x)), m_y(static_cast<T>(_v.m_y)), m_z(static_cast<T>(_v.m_z)){}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief convert from the float Vec3
+  /// @param[in]  _v the vector to convert
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr explicit Vec3T(const Vec3 &_v) noexcept :
+    m_x(static_cast<T>(_v.m_x)), m_y(static_cast<T>(_v.m_y)), m_z(static_cast<T>(_v.m_z)){}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief convert to the float Vec3 used by the rest of the library
+  /// @returns the vector rounded to float
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr Vec3 toVec3() const noexcept
+  {
+    return Vec3(static_cast<Real>(m_x),static_cast<Real>(m_y),static_cast<Real>(m_z));
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the components
+  /// @param[in]  _x the x value
+  /// @param[in]  _y the y value
+  /// @param[in]  _z the z value
+  //----------------------------------------------------------------------------------------------------------------------
+  void set(T _x, T _y, T _z) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief clear the vector to (0,0,0)
+  //----------------------------------------------------------------------------------------------------------------------
+  void null() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief component access by index 0=x 1=y 2=z
+  /// @param[in]  _i the index
+  //----------------------------------------------------------------------------------------------------------------------
+  T& operator[](size_t _i) noexcept;
+  const T& operator[](size_t _i) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the dot product of this and _v
+  /// @param[in]  _v the other vector
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr T dot(const Vec3T &_v) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the cross product this x _v
+  /// @param[in]  _v the other vector
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr Vec3T cross(const Vec3T &_v) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the length of the vector
+  //----------------------------------------------------------------------------------------------------------------------
+  T length() const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the squared length of the vector
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr T lengthSquared() const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief normalize the vector, asserts if the vector is zero length
+  //----------------------------------------------------------------------------------------------------------------------
+  void normalize() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the component wise arithmetic operators
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr Vec3T operator+(const Vec3T &_v) const noexcept;
+  constexpr Vec3T operator-(const Vec3T &_v) const noexcept;
+  constexpr Vec3T operator*(const Vec3T &_v) const noexcept;
+  constexpr Vec3T operator*(T _s) const noexcept;
+  constexpr Vec3T operator/(T _s) const noexcept;
+  constexpr Vec3T operator-() const noexcept;
+  Vec3T& operator+=(const Vec3T &_v) noexcept;
+  Vec3T& operator-=(const Vec3T &_v) noexcept;
+  Vec3T& operator*=(T _s) noexcept;
+  Vec3T& operator/=(T _s) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief check for equality uses FCompare as Vec3 does
+  /// @param[in]  _v the vector to check against
+  //----------------------------------------------------------------------------------------------------------------------
+  bool operator==(const Vec3T &_v) const noexcept;
+  bool operator!=(const Vec3T &_v) const noexcept;
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the components, public as with Vec3
+  //----------------------------------------------------------------------------------------------------------------------
+  T m_x;
+  T m_y;
+  T m_z;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the precisions in use, Vec3 itself is the float version
+//----------------------------------------------------------------------------------------------------------------------
+using Vec3f=Vec3T<float>;
+using Vec3d=Vec3T<double>;
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline void Vec3T<T>::set(T _x, T _y, T _z) noexcept
+{
+  m_x=_x;
+  m_y=_y;
+  m_z=_z;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline void Vec3T<T>::null() noexcept
+{
+  m_x=m_y=m_z=T(0);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline T& Vec3T<T>::operator[](size_t _i) noexcept
+{
+  NGL_ASSERT(_i<3);
+  return (&m_x)[_i];
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline const T& Vec3T<T>::operator[](size_t _i) const noexcept
+{
+  NGL_ASSERT(_i<3);
+  return (&m_x)[_i];
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+constexpr T Vec3T<T>::dot(const Vec3T &_v) const noexcept
+{
+  return m_x*_v.m_x + m_y*_v.m_y + m_z*_v.m_z;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+constexpr Vec3T<T> Vec3T<T>::cross(const Vec3T &_v) const noexcept
+{
+  return Vec3T(m_y*_v.m_z - m_z*_v.m_y,
+               m_z*_v.m_x - m_x*_v.m_z,
+               m_x*_v.m_y - m_y*_v.m_x);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline T Vec3T<T>::length() const noexcept
+{
+  return std::sqrt(m_x*m_x + m_y*m_y + m_z*m_z);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+constexpr T Vec3T<T>::lengthSquared() const noexcept
+{
+  return m_x*m_x + m_y*m_y + m_z*m_z;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline void Vec3T<T>::normalize() noexcept
+{
+  T len=length();
+  NGL_ASSERT(len!=T(0));
+  m_x/=len;
+  m_y/=len;
+  m_z/=len;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+constexpr Vec3T<T> Vec3T<T>::operator+(const Vec3T &_v) const noexcept
+{
+  return Vec3T(m_x+_v.m_x,m_y+_v.m_y,m_z+_v.m_z);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+constexpr Vec3T<T> Vec3T<T>::operator-(const Vec3T &_v) const noexcept
+{
+  return Vec3T(m_x-_v.m_x,m_y-_v.m_y,m_z-_v.m_z);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+constexpr Vec3T<T> Vec3T<T>::operator*(const Vec3T &_v) const noexcept
+{
+  return Vec3T(m_x*_v.m_x,m_y*_v.m_y,m_z*_v.m_z);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+constexpr Vec3T<T> Vec3T<T>::operator*(T _s) const noexcept
+{
+  return Vec3T(m_x*_s,m_y*_s,m_z*_s);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+constexpr Vec3T<T> Vec3T<T>::operator/(T _s) const noexcept
+{
+  return Vec3T(m_x/_s,m_y/_s,m_z/_s);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+constexpr Vec3T<T> Vec3T<T>::operator-() const noexcept
+{
+  return Vec3T(-m_x,-m_y,-m_z);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline Vec3T<T>& Vec3T<T>::operator+=(const Vec3T &_v) noexcept
+{
+  m_x+=_v.m_x;
+  m_y+=_v.m_y;
+  m_z+=_v.m_z;
+  return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline Vec3T<T>& Vec3T<T>::operator-=(const Vec3T &_v) noexcept
+{
+  m_x-=_v.m_x;
+  m_y-=_v.m_y;
+  m_z-=_v.m_z;
+  return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline Vec3T<T>& Vec3T<T>::operator*=(T _s) noexcept
+{
+  m_x*=_s;
+  m_y*=_s;
+  m_z*=_s;
+  return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline Vec3T<T>& Vec3T<T>::operator/=(T _s) noexcept
+{
+  m_x/=_s;
+  m_y/=_s;
+  m_z/=_s;
+  return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline bool Vec3T<T>::operator==(const Vec3T &_v) const noexcept
+{
+  return FCompare(_v.m_x,m_x) && FCompare(_v.m_y,m_y) && FCompare(_v.m_z,m_z);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+inline bool Vec3T<T>::operator!=(const Vec3T &_v) const noexcept
+{
+  return !(*this==_v);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief scalar * vector
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T>
+constexpr Vec3T<T> operator*(T _s, const Vec3T<T> &_v) noexcept
+{
+  return _v*_s;
+}
+
+} // end namespace ngl
+
+#endif
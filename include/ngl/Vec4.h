@@ -25,7 +25,9 @@
 #include "Types.h"
 #include "Vec2.h"
 #include "Vec3.h"
+#include "NGLassert.h"
 #include <array>
+#include <cmath>
 //----------------------------------------------------------------------------------------------------------------------
 /// @file Vec4.h
 /// @brief encapsulates a 4d Homogenous Point / Vector object
@@ -64,7 +66,7 @@ friend class Quaternion;
 friend class Obj;
 
 public:
-  Vec4() : m_x(0.0f),m_y(0.0f),m_z(0.0f),m_w(1.0f){}
+  constexpr Vec4() : m_x(0.0f),m_y(0.0f),m_z(0.0f),m_w(1.0f){}
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief copy ctor
   /// @param[in] _v the value to set
@@ -74,7 +76,7 @@ public:
   /// @brief copy ctor
   /// @param[in] _v the value to set
   //----------------------------------------------------------------------------------------------------------------------
-  Vec4(const Vec3& _v, float _w=1.0f)  noexcept:
+  constexpr Vec4(const Vec3& _v, float _w=1.0f)  noexcept:
   m_x(_v.m_x),
   m_y(_v.m_y),
   m_z(_v.m_z),
@@ -87,7 +89,7 @@ public:
   /// @param[in]  _z z value
   /// @param[in]  _w 1.0f default so acts as a points
   //----------------------------------------------------------------------------------------------------------------------
-   Vec4( Real _x, Real _y, Real _z,  Real _w=1.0f ) noexcept:
+   constexpr Vec4( Real _x, Real _y, Real _z,  Real _w=1.0f ) noexcept:
    m_x(_x),
    m_y(_y),
    m_z(_z),
@@ -98,7 +100,7 @@ public:
   /// @param[in]  _b vector to dot current vector with
   /// @returns  the dot product
   //----------------------------------------------------------------------------------------------------------------------
-  Real dot( const Vec4 &_b )const noexcept;
+  constexpr Real dot( const Vec4 &_b )const noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief sets the vector component from 3 values
   /// @param[in]  _x the x component
@@ -125,12 +127,12 @@ public:
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief get as a Vec3 for glsl etc
   //----------------------------------------------------------------------------------------------------------------------
-  Vec3 toVec3() const  noexcept{ return Vec3(m_x,m_y,m_z);}
+  constexpr Vec3 toVec3() const  noexcept{ return Vec3(m_x,m_y,m_z);}
 
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief get as a Vec2 for glsl etc
   //----------------------------------------------------------------------------------------------------------------------
-  Vec2 toVec2() const  noexcept{ return Vec2(m_x,m_y);}
+  constexpr Vec2 toVec2() const  noexcept{ return Vec2(m_x,m_y);}
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief [] index operator to access the index component of the vector
   /// @returns  this[x] as a Real
@@ -161,7 +163,7 @@ public:
   /// @param[in]  _b the vector cross this with
   /// @returns  the result of this cross b
   //----------------------------------------------------------------------------------------------------------------------
-  Vec4 cross(const Vec4& _b)const noexcept;
+  constexpr Vec4 cross(const Vec4& _b)const noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief += operator add vector v to current vector
   /// @param[in]  &_v vector to add
@@ -179,21 +181,21 @@ public:
   /// @param[in]  _i the scalar to mult by
   /// @returns Vector
   //----------------------------------------------------------------------------------------------------------------------
-  Vec4 operator *(Real _i)const noexcept;
+  constexpr Vec4 operator *(Real _i)const noexcept;
 
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief + operator add vector+vector
   /// @param[in]  &_v the value to add
   /// @returns the vector + v
   //----------------------------------------------------------------------------------------------------------------------
-  Vec4 operator +(const Vec4 &_v)const noexcept;
+  constexpr Vec4 operator +(const Vec4 &_v)const noexcept;
 
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief divide vector components by a scalar
   /// @param[in] _v the scalar to divide by
   /// @returns a vector V(x/v,y/v,z/v,w)
   //----------------------------------------------------------------------------------------------------------------------
-  Vec4 operator/(Real _v)const noexcept;
+  constexpr Vec4 operator/(Real _v)const noexcept;
 
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief divide this vector components by a scalar
@@ -212,14 +214,14 @@ public:
   /// @param[in]  &_v the value to sub
   /// @returns this - v
   //----------------------------------------------------------------------------------------------------------------------
-  Vec4 operator-(const Vec4& _v)const noexcept;
+  constexpr Vec4 operator-(const Vec4& _v)const noexcept;
 
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief * operator mult vevtor*vector
   /// @param[in]  _v the value to mult
   /// @returns new vector this*v
   //----------------------------------------------------------------------------------------------------------------------
-  Vec4 operator*( const Vec4 &_v)const noexcept;
+  constexpr Vec4 operator*( const Vec4 &_v)const noexcept;
 
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief assignment operator set the current vector to rhs
@@ -262,7 +264,7 @@ public:
   /// @param[in]  _v the value to div by
   /// @returns Vector / Vector
   //----------------------------------------------------------------------------------------------------------------------
-  Vec4 operator/( const Vec4& _v)const noexcept;
+  constexpr Vec4 operator/( const Vec4& _v)const noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief calculate the angle between current vector and _v
   /// @param[in] _v the vector to check
@@ -274,7 +276,7 @@ public:
   /// @param[in] _v the vector to calculate inner product with
   /// @returns the inner product
   //----------------------------------------------------------------------------------------------------------------------
-  Real inner( const Vec4& _v)const noexcept;
+  constexpr Real inner( const Vec4& _v)const noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief compute the outer product of this vector and vector
   /// @param[in] _v the vector to calc against
@@ -285,7 +287,7 @@ public:
   /// @brief calculate the length squared of the vector
   /// @returns length squared
   //----------------------------------------------------------------------------------------------------------------------
-  Real lengthSquared() const noexcept;
+  constexpr Real lengthSquared() const noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief operator to multiply a vector by a matrix
   /// @param[in] _m the matrix to multiply
@@ -296,16 +298,16 @@ public:
   //----------------------------------------------------------------------------------------------------------------------
   Real* openGL() noexcept{return &m_openGL[0];}
 
-  static Vec4 up()  {return Vec4(0.0f,1.0f,0.0f,0.0f); }
-  static Vec4 down()  {return Vec4(0.0f,-1.0f,0.0f,0.0f); }
+  static constexpr Vec4 up()  {return Vec4(0.0f,1.0f,0.0f,0.0f); }
+  static constexpr Vec4 down()  {return Vec4(0.0f,-1.0f,0.0f,0.0f); }
 
-  static Vec4 left()  {return Vec4(-1.0f,0.0f,0.0f,0.0f); }
-  static Vec4 right()  {return Vec4(1.0f,0.0f,0.0f,0.0f); }
+  static constexpr Vec4 left()  {return Vec4(-1.0f,0.0f,0.0f,0.0f); }
+  static constexpr Vec4 right()  {return Vec4(1.0f,0.0f,0.0f,0.0f); }
 
-  static Vec4 in()  {return Vec4(0.0f,0.0f,1.0f,0.0f); }
-  static Vec4 out()  {return Vec4(0.0f,0.0f,-1.0f,0.0f); }
+  static constexpr Vec4 in()  {return Vec4(0.0f,0.0f,1.0f,0.0f); }
+  static constexpr Vec4 out()  {return Vec4(0.0f,0.0f,-1.0f,0.0f); }
 
-  static Vec4 zero()  {return Vec4(0.0f,0.0f,0.0f,0.0f); }
+  static constexpr Vec4 zero()  {return Vec4(0.0f,0.0f,0.0f,0.0f); }
 
 
 /// @note I've made this public as some compilers automatically make the
@@ -344,6 +346,275 @@ public :
 
 };
 
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the Vec4 arithmetic is defined inline so it can be inlined into client loops,
+/// the library still exports out of line copies see Vec4.cpp
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Real Vec4::dot(const Vec4& _v )const noexcept
+{
+  return m_x * _v.m_x + m_y * _v.m_y + m_z * _v.m_z;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Vec4::set( Real _x, Real _y, Real _z, Real _w) noexcept
+{
+  m_x=_x;
+  m_y=_y;
+  m_z=_z;
+  m_w=_w;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Vec4::set( const Vec4& _v) noexcept
+{
+   m_x=_v.m_x;
+   m_y=_v.m_y;
+   m_z=_v.m_z;
+   m_w=_v.m_w;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Vec4::set( const Vec3 &_v ) noexcept
+{
+  m_x=_v.m_x;
+  m_y=_v.m_y;
+  m_z=_v.m_z;
+  m_w=1.0f;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Vec4::null() noexcept
+{
+  m_x=0.0f;
+  m_y=0.0f;
+  m_z=0.0f;
+  m_w=1.0f;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline Real& Vec4::operator[]( int _i ) noexcept
+{
+  NGL_ASSERT(_i >=0 && _i<=3);
+  return (&m_x)[_i];
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline Real Vec4::length() const noexcept
+{
+  return sqrtf((m_x*m_x)+(m_y*m_y)+(m_z*m_z));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline Vec4 &Vec4::operator-() noexcept
+{
+  m_x=-m_x;
+  m_y=-m_y;
+  m_z=-m_z;
+  return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline Vec4 &Vec4::normalize() noexcept
+{
+  Real len=sqrtf(m_x*m_x+m_y*m_y+m_z*m_z);
+  NGL_ASSERT(len!=0.0f);
+  m_x/=len;
+  m_y/=len;
+  m_z/=len;
+  return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Vec4::cross( const Vec4& _v1, const Vec4& _v2) noexcept
+{
+  m_x=_v1.m_y*_v2.m_z-_v1.m_z*_v2.m_y;
+  m_y=_v1.m_z*_v2.m_x-_v1.m_x*_v2.m_z;
+  m_z=_v1.m_x*_v2.m_y-_v1.m_y*_v2.m_x;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Vec4 Vec4::cross(const Vec4& _v )const noexcept
+{
+  return Vec4(
+                m_y*_v.m_z - m_z*_v.m_y,
+                m_z*_v.m_x - m_x*_v.m_z,
+                m_x*_v.m_y - m_y*_v.m_x,
+                0.0f
+               );
+
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Vec4::operator+=( const Vec4& _v) noexcept
+{
+  m_x+=_v.m_x;
+  m_y+=_v.m_y;
+  m_z+=_v.m_z;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Vec4::operator/=(Real _v) noexcept
+{
+  NGL_ASSERT(_v !=0.0f);
+  m_x/=_v;
+  m_y/=_v;
+  m_z/=_v;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Vec4::operator*=(Real _v) noexcept
+{
+  m_x*=_v;
+  m_y*=_v;
+  m_z*=_v;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline void Vec4::operator-=( const Vec4& _v) noexcept
+{
+  m_x-=_v.m_x;
+  m_y-=_v.m_y;
+  m_z-=_v.m_z;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Vec4 Vec4::operator/(Real _v )const noexcept
+{
+  return Vec4(m_x/_v,m_y/_v,m_z/_v,m_w);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Vec4 Vec4::operator+(const Vec4& _v )const noexcept
+{
+  return Vec4(
+                m_x+_v.m_x,
+                m_y+_v.m_y,
+                m_z+_v.m_z,
+                m_w
+                );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Vec4 Vec4::operator-(const Vec4& _v )const noexcept
+{
+  return Vec4(
+                m_x-_v.m_x,
+                m_y-_v.m_y,
+                m_z-_v.m_z,
+                m_w
+               );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline bool Vec4::operator==(const Vec4& _v   )const noexcept
+{
+  return (
+          FCompare(_v.m_x,m_x)  &&
+          FCompare(_v.m_y,m_y)  &&
+          FCompare(_v.m_z,m_z)
+         );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline bool Vec4::operator!=( const Vec4& _v  )const noexcept
+{
+  return (
+          !FCompare(_v.m_x,m_x) ||
+          !FCompare(_v.m_y,m_y) ||
+          !FCompare(_v.m_z,m_z)
+         );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Vec4 Vec4::operator*( const Vec4& _v )const noexcept
+{
+  return Vec4(
+                m_x*_v.m_x,
+                m_y*_v.m_y,
+                m_z*_v.m_z,
+                m_w
+               );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Vec4 Vec4::operator/(const Vec4& _v )const noexcept
+{
+  return Vec4(
+                m_x/_v.m_x,
+                m_y/_v.m_y,
+                m_z/_v.m_z,
+                m_w
+                );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Vec4 Vec4::operator *( Real _i )const noexcept
+{
+  return Vec4(
+                m_x*_i,
+                m_y*_i,
+                m_z*_i,
+                m_w
+               );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Real Vec4::inner(const Vec4& _v  )const noexcept
+{
+  return (
+          (m_x * _v.m_x) +
+          (m_y * _v.m_y) +
+          (m_z * _v.m_z)
+         );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline Vec4 Vec4::outer(const Vec4& _v  )  const noexcept
+{
+  Real x = (m_y * _v.m_z) - (m_z * _v.m_y);
+  Real y = (m_z * _v.m_x) - (m_x * _v.m_z);
+  Real z = (m_x * _v.m_y) - (m_y * _v.m_x);
+
+  return Vec4(x,y,z,m_w);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline Vec4 & Vec4::operator=( const Vec4& _v) noexcept
+{
+  m_x = _v.m_x;
+  m_y = _v.m_y;
+  m_z = _v.m_z;
+  m_w = _v.m_w;
+  return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline Vec4 & Vec4::operator=( const Vec3& _v) noexcept
+{
+  m_x = _v.m_x;
+  m_y = _v.m_y;
+  m_z = _v.m_z;
+  m_w = 0.0f;
+  return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+inline Vec4 & Vec4::operator=( Real _v) noexcept
+{
+  m_x = _v;
+  m_y = _v;
+  m_z = _v;
+  m_w = 0.0f;
+  return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+constexpr Real Vec4::lengthSquared() const noexcept
+{
+  return m_x * m_x+m_y * m_y+ m_z*m_z;
+}
+
+
 
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -352,7 +623,7 @@ public :
 /// @param _v the vector value
 /// @returns a vector _k*v
 //----------------------------------------------------------------------------------------------------------------------
-inline Vec4 operator *(Real _k, const Vec4 &_v) noexcept
+constexpr Vec4 operator *(Real _k, const Vec4 &_v) noexcept
 {
   return Vec4(_k*_v.m_x, _k*_v.m_y, _k*_v.m_z,_v.m_w);
 }
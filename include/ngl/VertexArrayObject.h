@@ -149,6 +149,11 @@ public:
 	//----------------------------------------------------------------------------------------------------------------------
 	void setVertexAttributePointer(GLuint _id,GLint _size,GLenum _type,GLsizei _stride,unsigned int _dataOffset,bool _normalise=GL_FALSE);
 	//----------------------------------------------------------------------------------------------------------------------
+	/// @brief as above with the offset in bytes, for packed vertices where the attributes are not all floats
+	/// @param _byteOffset the offset of the first component from the start of the buffer in bytes
+	//----------------------------------------------------------------------------------------------------------------------
+	void setVertexAttributePointerBytes(GLuint _id,GLint _size,GLenum _type,GLsizei _stride,size_t _byteOffset,bool _normalise=GL_FALSE);
+	//----------------------------------------------------------------------------------------------------------------------
 	/// @brief set the vertex attribute pointer as an Integer this will not be normalised etc
 	/// @param _size the size of the raw data passed (not counting sizeof(GL_FLOAT))
 	/// @param _type the data type of the Pointer (eg GL_FLOAT)
@@ -0,0 +1,137 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef VERTEXPACKING_H_
+#define VERTEXPACKING_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file VertexPacking.h
+/// @brief compact vertex formats, half floats, octahedral and 10:10:10:2 normals and positions quantised
+/// in a box, with the interleaved layouts built from them for the mesh VAOs
+//----------------------------------------------------------------------------------------------------------------------
+#include "Types.h"
+#include "Vec3.h"
+#include "Mat4.h"
+#include "Bounds3.h"
+#include <cstdint>
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief convert a float to the nearest half float (ties to even), too large values give infinity
+//----------------------------------------------------------------------------------------------------------------------
+extern NGL_DLLEXPORT uint16_t floatToHalf(float _f) noexcept;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief convert a half float back to a float, this is exact
+//----------------------------------------------------------------------------------------------------------------------
+extern NGL_DLLEXPORT float halfToFloat(uint16_t _h) noexcept;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief convert arrays, 8 at a time with the F16C instructions when useF16C() is true, the results are the
+/// same as the single value versions
+/// @param[in] _in the values to convert
+/// @param[in] _count the number of values
+/// @param[out] o_out space for _count values
+//----------------------------------------------------------------------------------------------------------------------
+extern NGL_DLLEXPORT void floatToHalf(const float *_in, size_t _count, uint16_t *o_out) noexcept;
+extern NGL_DLLEXPORT void halfToFloat(const uint16_t *_in, size_t _count, float *o_out) noexcept;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief a unit vector mapped onto an octahedron and unfolded into a square (Meyer et al. "On Floating-Point
+/// Normal Vectors" 2010) stored as two 16 bit snorm values, x in the low half, read in a shader as 2
+/// normalised GL_SHORT and decoded with c_octahedralDecodeGLSL. The error is under 0.01 degrees.
+//----------------------------------------------------------------------------------------------------------------------
+extern NGL_DLLEXPORT uint32_t packOctahedral(const Vec3 &_n) noexcept;
+extern NGL_DLLEXPORT Vec3 unpackOctahedral(uint32_t _p) noexcept;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief a vector in [-1,1] as 10 bit snorm x, y and z (w is 0) in the GL_INT_2_10_10_10_REV layout, read
+/// directly as a normalised vec4 attribute
+//----------------------------------------------------------------------------------------------------------------------
+extern NGL_DLLEXPORT uint32_t packSnorm1010102(const Vec3 &_n) noexcept;
+extern NGL_DLLEXPORT Vec3 unpackSnorm1010102(uint32_t _p) noexcept;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief glsl to decode an octahedral normal, include it in a vertex shader and call
+/// octahedralDecode(inNormal) where inNormal is a vec2 attribute
+//----------------------------------------------------------------------------------------------------------------------
+constexpr const char *c_octahedralDecodeGLSL=
+  "vec3 octahedralDecode(vec2 _e)\n"
+  "{\n"
+  "  vec3 n=vec3(_e.xy,1.0-abs(_e.x)-abs(_e.y));\n"
+  "  float t=max(-n.z,0.0);\n"
+  "  n.xy+=mix(vec2(t),vec2(-t),greaterThanEqual(n.xy,vec2(0.0)));\n"
+  "  return normalize(n);\n"
+  "}\n";
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class VertexLayout "include/ngl/VertexPacking.h"
+/// @brief the formats of the position, normal and uv in an interleaved mesh vertex. The attributes are
+/// stored uv, normal then position each starting on a 4 byte boundary, so the all float layout is the 32
+/// byte u,v,nx,ny,nz,x,y,z vertex the meshes have always used and compact() is 16 bytes.
+/// UNORM16 positions are read in the shader as 0 to 1 across the box given to packVertices, multiply them by
+/// dequantize() (before the model matrix) to get the original positions back.
+/// @version 1.0
+/// @date 16/10/16
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT VertexLayout
+{
+public :
+  enum class Position : char {FLOAT, HALF, UNORM16};
+  enum class Normal : char {FLOAT, OCTAHEDRAL16, SNORM_10_10_10_2};
+  enum class UV : char {FLOAT, HALF};
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief default ctor all floats
+  //----------------------------------------------------------------------------------------------------------------------
+  VertexLayout() noexcept=default;
+  VertexLayout(Position _p, Normal _n, UV _uv) noexcept : m_position(_p), m_normal(_n), m_uv(_uv) {}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the smallest layout, UNORM16 positions, octahedral normals and half uvs
+  //----------------------------------------------------------------------------------------------------------------------
+  static VertexLayout compact() noexcept {return VertexLayout(Position::UNORM16,Normal::OCTAHEDRAL16,UV::HALF);}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief true if everything is float
+  //----------------------------------------------------------------------------------------------------------------------
+  bool isFloat() const noexcept {return m_position==Position::FLOAT && m_normal==Normal::FLOAT && m_uv==UV::FLOAT;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the byte offset of each attribute and the size of a vertex
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t uvOffset() const noexcept {return 0;}
+  size_t normalOffset() const noexcept {return m_uv==UV::FLOAT ? 8 : 4;}
+  size_t positionOffset() const noexcept {return normalOffset()+(m_normal==Normal::FLOAT ? 12 : 4);}
+  size_t stride() const noexcept {return positionOffset()+(m_position==Position::FLOAT ? 12 : 8);}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the matrix taking UNORM16 positions back to the box they were quantised in (identity otherwise)
+  /// @param[in] _box the box given to packVertices
+  //----------------------------------------------------------------------------------------------------------------------
+  Mat4 dequantize(const Bounds3 &_box) const noexcept;
+
+  Position m_position=Position::FLOAT;
+  Normal m_normal=Normal::FLOAT;
+  UV m_uv=UV::FLOAT;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief interleave vertices into a layout
+/// @param[in] _layout the layout to write
+/// @param[in] _count the number of vertices
+/// @param[in] _positions the positions
+/// @param[in] _normals the normals, unit length for the packed formats
+/// @param[in] _uvs the texture co-ordinates (only x and y are used as the meshes store them)
+/// @param[in] _box the box UNORM16 positions are quantised in, usually the bounds of the positions
+/// @param[out] o_data space for _count * _layout.stride() bytes
+//----------------------------------------------------------------------------------------------------------------------
+extern NGL_DLLEXPORT void packVertices(const VertexLayout &_layout, size_t _count, const Vec3 *_positions, const Vec3 *_normals,
+                                       const Vec3 *_uvs, const Bounds3 &_box, unsigned char *o_data) noexcept;
+
+} // end namespace ngl
+
+#endif
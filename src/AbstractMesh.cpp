@@ -21,6 +21,11 @@
 #include "NGLStream.h"
 #include "VAOFactory.h"
 #include "SimpleVAO.h"
+#include "SimpleIndexVAO.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplify.h"
+#include <limits>
+#include <unordered_map>
 //----------------------------------------------------------------------------------------------------------------------
 /// @file AbstractMesh.cpp
 /// @brief a series of classes used to define an abstract 3D mesh of Faces, Vertex Normals and TexCords
@@ -195,23 +200,162 @@ bool AbstractMesh::isTriangular() noexcept
 	return true;
 }
 
-// a simple structure to hold our vertex data
-// had to move this outside the method as g++ complains about it
-// clang doesn't have a problem tho
-struct VertData
+namespace
 {
-  GLfloat u; // tex cords
-  GLfloat v; // tex cords
-  GLfloat nx; // normal from obj mesh
-  GLfloat ny;
-  GLfloat nz;
-  GLfloat x; // position from obj
-  GLfloat y;
-  GLfloat z;
-};
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief hash for the (vert, normal, tex) triples when welding, the three lists usually share the same index
+  /// so each is mixed in with a different multiplier rather than a plain xor
+  //----------------------------------------------------------------------------------------------------------------------
+  struct IndexRefHash
+  {
+    size_t operator()(const IndexRef &_i) const noexcept
+    {
+      uint64_t h=uint64_t(_i.m_v)*0x9E3779B97F4A7C15ull;
+      h=(h^(h>>29))+uint64_t(_i.m_n)*0xC2B2AE3D27D4EB4Full;
+      h=(h^(h>>32))+uint64_t(_i.m_t)*0x165667B19E3779F9ull;
+      return static_cast<size_t>(h^(h>>29));
+    }
+  };
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+IndexRef AbstractMesh::faceCorner(const Face &_f, unsigned int _j) const noexcept
+{
+  // the normal and tex indices are only used if the mesh has them, so vertices only differing in
+  // unused indices are welded together
+  return IndexRef(_f.m_vert[_j], m_nNorm>0 ? _f.m_norm[_j] : 0, m_nTex>0 ? _f.m_tex[_j] : 0);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void AbstractMesh::weldVertices() noexcept
+{
+  NGL_ASSERT(isTriangular());
+  m_indices.clear();
+  m_outIndices.clear();
+  m_lods.clear();
+  m_indicesOptimized=false;
+  std::unordered_map<IndexRef,GLuint,IndexRefHash> unique;
+  unique.reserve(m_nFaces*3);
+  m_outIndices.reserve(m_nFaces*3);
+  for(unsigned int i=0;i<m_nFaces;++i)
+  {
+    for(unsigned int j=0;j<3;++j)
+    {
+      IndexRef ref=faceCorner(m_face[i],j);
+      auto found=unique.emplace(ref,static_cast<GLuint>(m_indices.size()));
+      if(found.second)
+      {
+        m_indices.push_back(ref);
+      }
+      m_outIndices.push_back(found.first->second);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void AbstractMesh::optimizeIndices() noexcept
+{
+  // the LOD ranges index the current vertex order so welding or reordering again would lose them
+  if(!m_lods.empty())
+  {
+    std::cerr<<"optimizeIndices must be called before buildLODs, the indices are left as they are\n";
+    return;
+  }
+  if(m_outIndices.size()!=size_t(m_nFaces)*3)
+  {
+    weldVertices();
+  }
+  size_t vertexCount=m_indices.size();
+  optimizeVertexCache(m_outIndices.data(),m_outIndices.size(),vertexCount);
+  std::vector<Vec3> positions;
+  positions.reserve(vertexCount);
+  for(const auto &ref : m_indices)
+  {
+    positions.push_back(m_verts[ref.m_v]);
+  }
+  optimizeOverdraw(m_outIndices.data(),m_outIndices.size(),positions.data(),vertexCount);
+  // finally put the vertices in the order they are first used
+  std::vector<uint32_t> remap(vertexCount);
+  size_t used=optimizeVertexFetch(m_outIndices.data(),m_outIndices.size(),vertexCount,remap.data());
+  std::vector<IndexRef> ordered(used,IndexRef(0,0,0));
+  remapVertices(m_indices.data(),vertexCount,remap.data(),ordered.data());
+  m_indices.swap(ordered);
+  m_indicesOptimized=true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void AbstractMesh::buildLODs(size_t _levels, Real _ratio, const SimplifyOptions &_options)
+{
+  if(m_outIndices.size()!=size_t(m_nFaces)*3)
+  {
+    weldVertices();
+  }
+  if(m_optimizeOnCreate && !m_indicesOptimized)
+  {
+    optimizeIndices();
+  }
+  size_t vertexCount=m_indices.size();
+  std::vector<Vec3> positions(vertexCount);
+  std::vector<Vec3> normals;
+  std::vector<Vec3> uvs;
+  for(size_t i=0; i<vertexCount; ++i)
+  {
+    positions[i]=m_verts[m_indices[i].m_v];
+  }
+  if(m_nNorm>0)
+  {
+    normals.resize(vertexCount);
+    for(size_t i=0; i<vertexCount; ++i)
+    {
+      normals[i]=m_norm[m_indices[i].m_n];
+    }
+  }
+  if(m_nTex>0)
+  {
+    uvs.resize(vertexCount);
+    for(size_t i=0; i<vertexCount; ++i)
+    {
+      uvs[i]=m_tex[m_indices[i].m_t];
+    }
+  }
+  std::vector<uint32_t> chain;
+  buildLODChain(m_outIndices.data(),m_outIndices.size(),positions.data(),
+                normals.empty() ? nullptr : normals.data(),uvs.empty() ? nullptr : uvs.data(),vertexCount,
+                _levels,_ratio,_options,chain,m_lods);
+  // level 0 keeps the order it had, the simplified ones are reordered for the cache
+  for(size_t l=1; l<m_lods.size(); ++l)
+  {
+    optimizeVertexCache(chain.data()+m_lods[l].m_indexOffset,m_lods[l].m_indexCount,vertexCount);
+  }
+  m_outIndices.assign(chain.begin(),chain.end());
+}
 
+//----------------------------------------------------------------------------------------------------------------------
+VertexCacheStats AbstractMesh::getCacheStats(unsigned int _cacheSize) const
+{
+  if(!m_outIndices.empty())
+  {
+    // only the full mesh, not the LOD levels after it
+    size_t count=m_lods.empty() ? m_outIndices.size() : m_lods[0].m_indexCount;
+    return analyzeVertexCache(m_outIndices.data(),count,m_indices.size(),_cacheSize);
+  }
+  // a triangle soup transforms every corner
+  std::vector<uint32_t> soup(size_t(m_nFaces)*3);
+  for(size_t i=0; i<soup.size(); ++i)
+  {
+    soup[i]=static_cast<uint32_t>(i);
+  }
+  return analyzeVertexCache(soup.data(),soup.size(),soup.size(),_cacheSize);
+}
 
+//----------------------------------------------------------------------------------------------------------------------
 void AbstractMesh::createVAO() noexcept
+{
+  createVAO(false);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void AbstractMesh::createVAO(bool _indexed) noexcept
 {
 	// if we have already created a VBO just return.
 	if(m_vao == true)
@@ -233,100 +377,140 @@ void AbstractMesh::createVAO() noexcept
 		exit(EXIT_FAILURE);
 	}
 
-  // now we are going to process and pack the mesh into an ngl::VertexArrayObject
-  std::vector <VertData> vboMesh;
-  VertData d;
-
-
-	// loop for each of the faces
-	for(unsigned int i=0;i<m_nFaces;++i)
-	{
-		// now for each triangle in the face (remember we ensured tri above)
-    for(unsigned int j=0;j<3;++j)
-		{
-
-			// pack in the vertex data first
-			d.x=m_verts[m_face[i].m_vert[j]].m_x;
-			d.y=m_verts[m_face[i].m_vert[j]].m_y;
-			d.z=m_verts[m_face[i].m_vert[j]].m_z;
-			// now if we have norms of tex (possibly could not) pack them as well
-			if(m_nNorm >0 && m_nTex > 0)
-			{
-        d.nx=m_norm[m_face[i].m_norm[j]].m_x;
-        d.ny=m_norm[m_face[i].m_norm[j]].m_y;
-        d.nz=m_norm[m_face[i].m_norm[j]].m_z;
-
-				d.u=m_tex[m_face[i].m_tex[j]].m_x;
-				d.v=m_tex[m_face[i].m_tex[j]].m_y;
-      }
-      // now if neither are present (only verts like Zbrush models)
-      else if(m_nNorm ==0 && m_nTex==0)
-      {
-        d.nx=0;
-        d.ny=0;
-        d.nz=0;
-        d.u=0;
-        d.v=0;
-      }
-      // here we've got norms but not tex
-      else if(m_nNorm >0 && m_nTex==0)
-      {
-        d.nx=m_norm[m_face[i].m_norm[j]].m_x;
-        d.ny=m_norm[m_face[i].m_norm[j]].m_y;
-        d.nz=m_norm[m_face[i].m_norm[j]].m_z;
-        d.u=0;
-        d.v=0;
-      }
-      // here we've got tex but not norm least common
-      else if(m_nNorm ==0 && m_nTex>0)
+  // m_indices gets the IndexRef of each vertex in the VAO, and m_outIndices the index of each
+  // triangle corner into them when indexed
+  if(_indexed)
+  {
+    // the LOD chain has the full mesh first and the simplified levels after it
+    if(m_lods.empty() && m_outIndices.size()!=size_t(m_nFaces)*3)
+    {
+      weldVertices();
+    }
+    if(m_lods.empty() && m_optimizeOnCreate && !m_indicesOptimized)
+    {
+      optimizeIndices();
+    }
+  }
+  else
+  {
+    m_indices.clear();
+    m_outIndices.clear();
+    m_lods.clear();
+    m_indices.reserve(m_nFaces*3);
+    for(unsigned int i=0;i<m_nFaces;++i)
+    {
+      for(unsigned int j=0;j<3;++j)
       {
-        d.nx=0;
-        d.ny=0;
-        d.nz=0;
-        d.u=m_tex[m_face[i].m_tex[j]].m_x;
-        d.v=m_tex[m_face[i].m_tex[j]].m_y;
+        m_indices.push_back(faceCorner(m_face[i],j));
       }
-    vboMesh.push_back(d);
     }
   }
+  bool hasNorm=m_nNorm>0;
+  bool hasTex=m_nTex>0;
 
-  // first we grab an instance of our VOA
-  m_vaoMesh.reset( ngl::VAOFactory::createVAO("simpleVAO",m_dataPackType));
-  // next we bind it so it's active for setting data
-  m_vaoMesh->bind();
-  m_meshSize=vboMesh.size();
-
-	// now we have our data add it to the VAO, we need to tell the VAO the following
-	// how much (in bytes) data we are copying
-	// a pointer to the first element of data (in this case the address of the first element of the
-	// std::vector
-  //m_vaoMesh->setData(m_meshSize*sizeof(VertData),vboMesh[0].u);
-  m_vaoMesh->setData(SimpleVAO::VertexData(m_meshSize*sizeof(VertData),vboMesh[0].u));
+  // gather the attributes of each vertex then pack them into the interleaved layout
+  size_t numVerts=m_indices.size();
+  if(numVerts==0)
+  {
+    std::cerr<<"no vertices to create a VAO from\n";
+    return;
+  }
+  std::vector<Vec3> positions(numVerts);
+  std::vector<Vec3> normals(numVerts,Vec3(0.0f,0.0f,0.0f));
+  std::vector<Vec3> uvs(numVerts,Vec3(0.0f,0.0f,0.0f));
+  for(size_t i=0; i<numVerts; ++i)
+  {
+    const IndexRef &ref=m_indices[i];
+    positions[i]=m_verts[ref.m_v];
+    // now if we have norms or tex (possibly could not) pack them as well, zbrush models only have verts
+    if(hasNorm)
+    {
+      normals[i]=m_norm[ref.m_n];
+    }
+    if(hasTex)
+    {
+      uvs[i]=m_tex[ref.m_t];
+    }
+  }
+  const VertexLayout &layout=m_vertexLayout;
+  size_t stride=layout.stride();
+  m_quantBounds=Bounds3::fromPoints(positions.data(),numVerts);
+  std::vector<unsigned char> vboMesh(numVerts*stride);
+  packVertices(layout,numVerts,positions.data(),normals.data(),uvs.data(),m_quantBounds,vboMesh.data());
+  const GLfloat &vboData=*reinterpret_cast<const GLfloat *>(vboMesh.data());
+  // the number of vertices in the buffer and the 4 byte words in each, used when saving
+  m_indexSize=numVerts;
+  m_bufferPackSize=stride/sizeof(GLfloat);
+
+  if(_indexed)
+  {
+    m_vaoMesh.reset( ngl::VAOFactory::createVAO("simpleIndexVAO",m_dataPackType));
+    m_vaoMesh->bind();
+    m_meshSize=m_lods.empty() ? m_outIndices.size() : m_lods[0].m_indexCount;
+    // 16 bit indices halve the index buffer when there are few enough vertices
+    if(numVerts<=size_t(std::numeric_limits<GLushort>::max())+1)
+    {
+      std::vector<GLushort> shortIndices(m_outIndices.begin(),m_outIndices.end());
+      m_vaoMesh->setData(SimpleIndexVAO::VertexData(vboMesh.size(),vboData,
+                                                    static_cast<unsigned int>(shortIndices.size()),shortIndices.data(),GL_UNSIGNED_SHORT));
+    }
+    else
+    {
+      m_vaoMesh->setData(SimpleIndexVAO::VertexData(vboMesh.size(),vboData,
+                                                    static_cast<unsigned int>(m_outIndices.size()),m_outIndices.data(),GL_UNSIGNED_INT));
+    }
+  }
+  else
+  {
+    // first we grab an instance of our VOA
+    m_vaoMesh.reset( ngl::VAOFactory::createVAO("simpleVAO",m_dataPackType));
+    // next we bind it so it's active for setting data
+    m_vaoMesh->bind();
+    m_meshSize=numVerts;
+
+    // now we have our data add it to the VAO, we need to tell the VAO the following
+    // how much (in bytes) data we are copying
+    // a pointer to the first element of data (in this case the address of the first element of the
+    // std::vector
+    m_vaoMesh->setData(SimpleVAO::VertexData(vboMesh.size(),vboData));
+  }
   // in this case we have packed our data in interleaved format as follows
-	// u,v,nx,ny,nz,x,y,z
+	// u,v,nx,ny,nz,x,y,z (each in the format given by the layout)
 	// If you look at the shader we have the following attributes being used
 	// attribute vec3 inVert; attribute 0
 	// attribute vec2 inUV; attribute 1
-	// attribute vec3 inNormal; attribure 2
+	// attribute vec3 inNormal; attribure 2 (vec2 for octahedral normals, vec4 for 10:10:10:2)
 	// so we need to set the vertexAttributePointer so the correct size and type as follows
-	// vertex is attribute 0 with x,y,z(3) parts of type GL_FLOAT, our complete packed data is
-	// sizeof(vertData) and the offset into the data structure for the first x component is 5 (u,v,nx,ny,nz)..x
-	m_vaoMesh->setVertexAttributePointer(0,3,GL_FLOAT,sizeof(VertData),5);
+	// vertex is attribute 0 with x,y,z(3) parts, the unorm positions are normalised to 0-1 in the box
+  GLsizei glStride=static_cast<GLsizei>(stride);
+  switch(layout.m_position)
+  {
+    case VertexLayout::Position::FLOAT : m_vaoMesh->setVertexAttributePointerBytes(0,3,GL_FLOAT,glStride,layout.positionOffset()); break;
+    case VertexLayout::Position::HALF : m_vaoMesh->setVertexAttributePointerBytes(0,3,GL_HALF_FLOAT,glStride,layout.positionOffset()); break;
+    case VertexLayout::Position::UNORM16 : m_vaoMesh->setVertexAttributePointerBytes(0,3,GL_UNSIGNED_SHORT,glStride,layout.positionOffset(),true); break;
+  }
 	// uv same as above but starts at 0 and is attrib 1 and only u,v so 2
-	m_vaoMesh->setVertexAttributePointer(1,2,GL_FLOAT,sizeof(VertData),0);
-	// normal same as vertex only starts at position 2 (u,v)-> nx
-	m_vaoMesh->setVertexAttributePointer(2,3,GL_FLOAT,sizeof(VertData),2);
+  GLenum uvType= layout.m_uv==VertexLayout::UV::FLOAT ? GL_FLOAT : GL_HALF_FLOAT;
+  m_vaoMesh->setVertexAttributePointerBytes(1,2,uvType,glStride,layout.uvOffset());
+	// normal follows the uv
+  switch(layout.m_normal)
+  {
+    case VertexLayout::Normal::FLOAT : m_vaoMesh->setVertexAttributePointerBytes(2,3,GL_FLOAT,glStride,layout.normalOffset()); break;
+    case VertexLayout::Normal::OCTAHEDRAL16 : m_vaoMesh->setVertexAttributePointerBytes(2,2,GL_SHORT,glStride,layout.normalOffset(),true); break;
+    case VertexLayout::Normal::SNORM_10_10_10_2 : m_vaoMesh->setVertexAttributePointerBytes(2,4,GL_INT_2_10_10_10_REV,glStride,layout.normalOffset(),true); break;
+  }
 
 
 	// now we have set the vertex attributes we tell the VAO class how many indices to draw when
-	// glDrawArrays is called, in this case we use buffSize (but if we wished less of the sphere to be drawn we could
-	// specify less (in steps of 3))
+	// glDrawArrays / glDrawElements is called, in this case we use m_meshSize (but if we wished less of
+	// the mesh to be drawn we could specify less (in steps of 3))
 	m_vaoMesh->setNumIndices(m_meshSize);
 	// finally we have finished for now so time to unbind the VAO
 	m_vaoMesh->unbind();
 
 	// indicate we have a vao now
 	m_vao=true;
+  m_vaoIndexed=_indexed;
 
 }
 
@@ -349,6 +533,27 @@ void AbstractMesh::draw() const noexcept
 }
 
 
+//----------------------------------------------------------------------------------------------------------------------
+void AbstractMesh::drawLOD(size_t _level) const noexcept
+{
+  if(!m_vaoIndexed || m_lods.empty())
+  {
+    draw();
+    return;
+  }
+  if(m_vao == true)
+  {
+    if(m_texture == true)
+    {
+      glBindTexture(GL_TEXTURE_2D,m_textureID);
+    }
+    const MeshLOD &lod=m_lods[std::min(_level,m_lods.size()-1)];
+    m_vaoMesh->bind();
+    static_cast<SimpleIndexVAO *>(m_vaoMesh.get())->drawRange(lod.m_indexOffset,lod.m_indexCount);
+    m_vaoMesh->unbind();
+  }
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 Real * AbstractMesh::mapVAOVerts() noexcept
 {
@@ -386,46 +591,29 @@ void AbstractMesh::unMapVAO() noexcept
 //----------------------------------------------------------------------------------------------------------------------
 void AbstractMesh::calcDimensions() noexcept
 {
-  // Calculate the center of the object.
   m_center=0.0;
-  for(auto v : m_verts)
+  m_bounds=Bounds3::fromPoints(m_verts.data(),m_verts.size());
+  if(m_verts.empty())
   {
-    m_center+=v;
+    m_bounds=Bounds3(m_center,m_center);
   }
-  m_center/=m_nVerts;
-  // calculate the extents
-  m_maxX=m_minX=m_center.m_x;
-  m_maxY=m_minY=m_center.m_y;
-  m_maxZ=m_minZ=m_center.m_z;
-
-
-  // Calculate the center of the object.
-  m_center=0.0;
-  for( auto  v :m_verts)
+  else
   {
-    m_center+=v;
-  }
-  m_center/=m_nVerts;
-  // calculate the extents
-  m_maxX=m_minX=m_center.m_x;
-  m_maxY=m_minY=m_center.m_y;
-  m_maxZ=m_minZ=m_center.m_z;
-
-  for(auto v : m_verts)
-  {
-    if     (v.m_x >m_maxX) { m_maxX=v.m_x; }
-    else if(v.m_x <m_minX) { m_minX=v.m_x; }
-    if     (v.m_y >m_maxY) { m_maxY=v.m_y; }
-    else if(v.m_y <m_minY) { m_minY=v.m_y; }
-    if     (v.m_z >m_maxZ) { m_maxZ=v.m_z; }
-    else if(v.m_z <m_minZ) { m_minZ=v.m_z; }
+    // the center of the object is the average of the vertices
+    for(const auto &v : m_verts)
+    {
+      m_center+=v;
+    }
+    m_center/=static_cast<Real>(m_verts.size());
   }
-
-
-
+  m_minX=m_bounds.m_min.m_x;
+  m_minY=m_bounds.m_min.m_y;
+  m_minZ=m_bounds.m_min.m_z;
+  m_maxX=m_bounds.m_max.m_x;
+  m_maxY=m_bounds.m_max.m_y;
+  m_maxZ=m_bounds.m_max.m_z;
   // create a new bbox based on the new object size
-  m_ext.reset(new BBox(m_minX,m_maxX,m_minY,m_maxY,m_minZ,m_maxZ));
-
+  m_ext.reset(new BBox(m_bounds));
 }
 
 void AbstractMesh::saveNCCABinaryMesh( const std::string &_fname  ) noexcept
@@ -433,6 +621,17 @@ void AbstractMesh::saveNCCABinaryMesh( const std::string &_fname  ) noexcept
 // so basically we need to save all the state data from the abstract mesh
 // then map the vbo on the gpu and dump that in one go, this means we have to
 // call CreateVBO first the Save
+  if(!m_vertexLayout.isFloat())
+  {
+    std::cerr<<"bin meshes can only be saved from the float vertex layout\n";
+    return;
+  }
+  // the loader draws the buffer as a triangle soup so it can't use welded vertices and an index buffer
+  if(m_vaoIndexed)
+  {
+    std::cerr<<"bin meshes can only be saved from an unindexed VAO, use createVAO(false)\n";
+    return;
+  }
   std::fstream file;
   file.open(_fname.c_str(),std::ios::out | std::ios::binary);
   if (!file.is_open())
@@ -487,7 +686,7 @@ void AbstractMesh::saveNCCABinaryMesh( const std::string &_fname  ) noexcept
 
   for (auto d : m_outIndices)
   {
-    file.write(reinterpret_cast <char *>(d),sizeof(unsigned int));
+    file.write(reinterpret_cast <char *>(&d),sizeof(unsigned int));
   }
 
   file.close();
@@ -495,114 +694,25 @@ void AbstractMesh::saveNCCABinaryMesh( const std::string &_fname  ) noexcept
 
 }
 
-/// modified from example in Rick Parent book
-/// Computer Animation Algorithms and Techniques
-/// Morgan Korfman Appendix B
+//----------------------------------------------------------------------------------------------------------------------
 void AbstractMesh::calcBoundingSphere() noexcept
 {
-auto size=m_verts.size();
-if( size <=0 )
-{
-	std::cerr<<"now vertices loaded \n";
-	m_sphereCenter=0;
-	m_sphereRadius=0;
-	return;
-
+  calcBoundingSphere(BoundingSphere::Fit::RITTER);
 }
-// find minimal and maximal extents and indexs into
-// into vert array
-int minXI=0; int minYI=0; int minZI=0;
-int maxXI=0; int maxYI=0; int maxZI=0;
-Real minX=m_verts[0].m_x; Real maxX=m_verts[0].m_x;
-Real minY=m_verts[0].m_y; Real maxY=m_verts[0].m_y;
-Real minZ=m_verts[0].m_z; Real maxZ=m_verts[0].m_z;
-
-for(unsigned int i=0; i<size; ++i)
-{
-  if(m_verts[i].m_x < minX) { minXI=i; minX=m_verts[i].m_x; }
-  if(m_verts[i].m_x > maxX) { maxXI=i; maxX=m_verts[i].m_x; }
-  if(m_verts[i].m_y < minY) { minYI=i; minY=m_verts[i].m_y; }
-  if(m_verts[i].m_y > maxY) { maxYI=i; maxY=m_verts[i].m_y; }
-  if(m_verts[i].m_z < minZ) { minZI=i; minZ=m_verts[i].m_z; }
-  if(m_verts[i].m_z > maxZ) { maxZI=i; maxZ=m_verts[i].m_z; }
-}
-// now we find maximally seperated points from the 3 pairs
-// we will use this to initialise the spheres
-Real dx=m_verts[minXI].m_x-m_verts[maxXI].m_x;
-Real dy=m_verts[minXI].m_y-m_verts[maxXI].m_y;
-Real dz=m_verts[minXI].m_z-m_verts[maxXI].m_z;
-Real diam2x=dx*dx+dy*dy+dz*dz;
-
-dx=m_verts[minYI].m_x-m_verts[maxYI].m_x;
-dy=m_verts[minYI].m_y-m_verts[maxYI].m_y;
-dz=m_verts[minYI].m_z-m_verts[maxYI].m_z;
-Real diam2y=dx*dx+dy*dy+dz*dz;
-
-dx=m_verts[minZI].m_x-m_verts[maxZI].m_x;
-dy=m_verts[minZI].m_y-m_verts[maxZI].m_y;
-dz=m_verts[minZI].m_z-m_verts[maxZI].m_z;
-Real diam2z=dx*dx+dy*dy+dz*dz;
-
-Real diamTwo=diam2x;
-int p1i=minXI;
-int p2i=maxXI;
-if(diam2y>diamTwo){ diamTwo=diam2y; p1i=minYI; p2i=maxYI;}
-if(diam2z>diamTwo){ diamTwo=diam2z; p1i=minZI; p2i=maxZI;}
-// now we can get the center of the sphere as the average
-// of the two points
-m_sphereCenter=(m_verts[p1i]+m_verts[p2i])/2.0;
-// now calculate radius and radius^2 of the initial sphere
-Real radTwo=diamTwo/4.0;
-Real rad=sqrt(radTwo);
-// now check and adjust for outlying points
-Vec3 newCenter;
-Real newRad2;
-Real newRad;
-Real dist2;
-Real dist;
-Real delta;
-
-for (auto v : m_verts)
-{
-  dx=v.m_x-m_sphereCenter.m_x;
-  dy=v.m_y-m_sphereCenter.m_y;
-  dz=v.m_z-m_sphereCenter.m_z;
-  // distance squared of old center to current point
-  dist2=dx*dx+dy*dy+dz*dz;
-  // need to update the sphere if this point is outside the radius
-  if(dist2 > radTwo)
-  {
-    dist=sqrt(dist2);
-    newRad=(rad+dist)/2.0;
-    newRad2=newRad*newRad;
-    delta=dist-newRad;
-    // now compute new center using the weights above
-    newCenter.m_x=(newRad*m_sphereCenter.m_x+delta*v.m_x)/dist;
-    newCenter.m_y=(newRad*m_sphereCenter.m_y+delta*v.m_y)/dist;
-    newCenter.m_z=(newRad*m_sphereCenter.m_z+delta*v.m_z)/dist;
-    // now test to see if we have a fit
-    dx=v.m_x-newCenter.m_x;
-    dy=v.m_y-newCenter.m_y;
-    dz=v.m_z-newCenter.m_z;
-    dist2=dx*dx+dy*dy+dz*dz;
-    if(dist2 > newRad2)
-    {
-      std::cerr<<"something wrong here\n";
-      std::cerr<<"error margin "<<dist2-newRad2<<"\n";
-    }
-    m_sphereCenter=newCenter;
-    rad=newRad;
-    radTwo=rad*rad;
-  } // end if dist2>rad2
-  m_sphereRadius=rad;
 
+//----------------------------------------------------------------------------------------------------------------------
+void AbstractMesh::calcBoundingSphere(BoundingSphere::Fit _fit) noexcept
+{
+  BoundingSphere s=BoundingSphere::fromPoints(m_verts.data(),m_verts.size(),_fit);
+  m_sphereCenter=s.m_center;
+  m_sphereRadius=s.isEmpty() ? 0.0f : s.m_radius;
 }
 
-m_sphereRadius=rad;
-std::cout<<m_sphereCenter<<"  rad "<<m_sphereRadius<<"\n";
-
+//----------------------------------------------------------------------------------------------------------------------
+void AbstractMesh::calcOBB() noexcept
+{
+  m_obb=OBB::fromPoints(m_verts.data(),m_verts.size());
 }
-/// end of citation
 
 
 } //end ngl namespace
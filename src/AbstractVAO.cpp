@@ -34,13 +34,18 @@ namespace ngl
 
 
   void AbstractVAO::setVertexAttributePointer(GLuint _id, GLint _size, GLenum _type, GLsizei _stride, unsigned int _dataOffset, bool _normalise )
+  {
+    setVertexAttributePointerBytes(_id,_size,_type,_stride,_dataOffset*sizeof(Real),_normalise);
+  }
+
+  void AbstractVAO::setVertexAttributePointerBytes(GLuint _id, GLint _size, GLenum _type, GLsizei _stride, size_t _byteOffset, bool _normalise )
   {
     if(m_bound !=true)
     {
       std::cerr<<"Warning trying to set attribute on Unbound VOA\n";
     }
     // set and enable the generic vertex attribute
-    glVertexAttribPointer(_id,_size,_type,_normalise,_stride,static_cast<Real *>(NULL)  + _dataOffset);//   ((Real *)NULL + (_dataOffset)));
+    glVertexAttribPointer(_id,_size,_type,_normalise,_stride,static_cast<char *>(NULL) + _byteOffset);
     glEnableVertexAttribArray(_id);
   }
 
@@ -77,8 +77,7 @@ BBox::BBox( const Vec3& _center,  Real _width, Real _height, Real _depth  ) noex
 	#else
 		m_drawMode=GL_LINE;
 	#endif
-	m_vao=0;
-	setVAO();
+	recalculate();
 }
 
 
@@ -97,8 +96,7 @@ BBox::BBox() noexcept
   m_width=2.0;
   m_height=2.0;
   m_depth=2.0;
-  m_vao=nullptr;
-  setVAO();
+  recalculate();
 }
 
 BBox::BBox(const BBox &_b) noexcept
@@ -114,7 +112,6 @@ BBox::BBox(const BBox &_b) noexcept
   m_maxY=_b.m_maxY;
   m_minZ=_b.m_minZ;
   m_maxZ=_b.m_maxZ;
-  m_vao=0;
   recalculate();
 }
 
@@ -132,7 +129,8 @@ BBox& BBox::operator=(const BBox &_b)
   m_maxY=_b.m_maxY;
   m_minZ=_b.m_minZ;
   m_maxZ=_b.m_maxZ;
-  m_vao.reset(_b.m_vao.get());
+  // the VAO is not shared, ours is rebuilt from the new vertices when next drawn
+  recalculate();
   return *this;
 }
 
@@ -149,7 +147,7 @@ BBox::BBox( Real _minX, Real _maxX,  Real _minY, Real _maxY, Real _minZ, Real _m
 	m_maxZ=_maxZ;
 
 
-	m_center.set(0,0,0);
+	m_center.set((_minX+_maxX)*0.5f,(_minY+_maxY)*0.5f,(_minZ+_maxZ)*0.5f);
 
 	m_vert[0].m_x=_minX; m_vert[0].m_y=_maxY; m_vert[0].m_z=_minZ;
 	m_vert[1].m_x=_maxX; m_vert[1].m_y=_maxY; m_vert[1].m_z=_minZ;
@@ -168,7 +166,6 @@ BBox::BBox( Real _minX, Real _maxX,  Real _minY, Real _maxY, Real _minZ, Real _m
 	m_width=m_maxX-m_minX;
 	m_height=m_maxY-m_minY;
 	m_depth=m_maxZ-m_minZ;
-	m_vao=0;
 	setVAO();
 
 }
@@ -180,8 +177,18 @@ void BBox::setDrawMode( GLenum _mode) noexcept
   setVAO();
 }
 
-void BBox::setVAO()
+void BBox::setVAO() noexcept
+{
+  m_vaoDirty=true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void BBox::buildVAO() const
 {
+  if(m_vao)
+  {
+    m_vao->removeVAO();
+  }
 	// if were not doing line drawing then use tris
 	#ifdef USINGIOS_
 		if(m_drawMode !=GL_LINE_LOOP)
@@ -220,14 +227,17 @@ void BBox::setVAO()
     // finally we have finished for now so time to unbind the VAO
     m_vao->unbind();
   }
-
-
+  m_vaoDirty=false;
 }
 
 
 //----------------------------------------------------------------------------------------------------------------------
-void BBox::draw() const noexcept
+void BBox::draw() const
 {
+  if(m_vaoDirty)
+  {
+    buildVAO();
+  }
 #ifndef USINGIOS_
   glPolygonMode(GL_FRONT_AND_BACK,m_drawMode);
   m_vao->bind();
@@ -304,14 +314,33 @@ void BBox::recalculate() noexcept
   m_vert[5].m_x=m_center.m_x+(m_width/2.0f); m_vert[5].m_y=m_center.m_y-(m_height/2.0f); m_vert[5].m_z=m_center.m_z-(m_depth/2.0f);
   m_vert[6].m_x=m_center.m_x+(m_width/2.0f); m_vert[6].m_y=m_center.m_y-(m_height/2.0f); m_vert[6].m_z=m_center.m_z+(m_depth/2.0f);
   m_vert[7].m_x=m_center.m_x-(m_width/2.0f); m_vert[7].m_y=m_center.m_y-(m_height/2.0f); m_vert[7].m_z=m_center.m_z+(m_depth/2.0f);
+  m_minX=m_vert[0].m_x; m_maxX=m_vert[1].m_x;
+  m_minY=m_vert[4].m_y; m_maxY=m_vert[0].m_y;
+  m_minZ=m_vert[0].m_z; m_maxZ=m_vert[2].m_z;
   setVAO();
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+BBox::BBox(const Bounds3 &_b) noexcept :
+  BBox(_b.m_min.m_x,_b.m_max.m_x,_b.m_min.m_y,_b.m_max.m_y,_b.m_min.m_z,_b.m_max.m_z)
+{
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+Bounds3 BBox::getBounds() const noexcept
+{
+  Vec3 half(m_width*0.5f,m_height*0.5f,m_depth*0.5f);
+  return Bounds3(m_center-half,m_center+half);
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 BBox::~BBox() noexcept
 {
-  m_vao->removeVAO();
+  if(m_vao)
+  {
+    m_vao->removeVAO();
+  }
 }
 //----------------------------------------------------------------------------------------------------------------------
 
@@ -0,0 +1,421 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "BatchQuaternion.h"
+#include "Quaternion.h"
+#include "Mat3.h"
+#include "Mat4.h"
+#include "SIMD.h"
+#include "ParallelFor.h"
+#include <cmath>
+#include <type_traits>
+#ifdef NGL_SIMD_X86
+  #include <immintrin.h>
+#endif
+//----------------------------------------------------------------------------------------------------------------------
+/// @file BatchQuaternion.cpp
+/// @brief implementation of the quaternion array functions
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace ngl
+{
+// the simd loads treat each Quaternion as the 4 floats s,x,y,z
+static_assert(sizeof(Quaternion)==4*sizeof(Real) && std::is_standard_layout<Quaternion>::value,"Quaternion must be 4 packed Reals");
+
+namespace
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief below this many elements per thread it is not worth starting another one
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr size_t c_grainSize=8192;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief below this 1-cos(angle) slerp falls back to a linear blend, the same value as Quaternion::slerp
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr Real c_slerpEpsilon=0.0001f;
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the blend values, either one for all elements or an array
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Blend
+  {
+    Real m_t;
+    const Real *m_array;
+    Real get(size_t _i) const noexcept { return m_array ? m_array[_i] : m_t; }
+  };
+
+  //----------------------------------------------------------------------------------------------------------------------
+  inline const Real *data(const Quaternion *_q) noexcept { return reinterpret_cast<const Real *>(_q); }
+  inline Real *data(Quaternion *_q) noexcept { return reinterpret_cast<Real *>(_q); }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief scalar nlerp, the simd version evaluates the same expression
+  //----------------------------------------------------------------------------------------------------------------------
+  Quaternion nlerp(const Quaternion &_a, const Quaternion &_b, Real _t) noexcept
+  {
+    Real cosom=_a.getS()*_b.getS()+_a.getX()*_b.getX()+_a.getY()*_b.getY()+_a.getZ()*_b.getZ();
+    Real tb= cosom < 0.0f ? -_t : _t;
+    Quaternion r=_a*(1.0f-_t)+_b*tb;
+    r.normalise();
+    return r;
+  }
+
+#ifdef NGL_SIMD_X86
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief 4 quaternions to one register per component
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void load4(const Real *_p, __m128 &o_s, __m128 &o_x, __m128 &o_y, __m128 &o_z) noexcept
+  {
+    o_s=_mm_loadu_ps(_p);
+    o_x=_mm_loadu_ps(_p+4);
+    o_y=_mm_loadu_ps(_p+8);
+    o_z=_mm_loadu_ps(_p+12);
+    _MM_TRANSPOSE4_PS(o_s,o_x,o_y,o_z);
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void store4(Real *o_p, __m128 _s, __m128 _x, __m128 _y, __m128 _z) noexcept
+  {
+    _MM_TRANSPOSE4_PS(_s,_x,_y,_z);
+    _mm_storeu_ps(o_p,_s);
+    _mm_storeu_ps(o_p+4,_x);
+    _mm_storeu_ps(o_p+8,_y);
+    _mm_storeu_ps(o_p+12,_z);
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  inline __m128 loadBlend(const Blend &_t, size_t _i) noexcept
+  {
+    return _t.m_array ? _mm_loadu_ps(_t.m_array+_i) : _mm_set1_ps(_t.m_t);
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  inline __m128 dot4(__m128 _as, __m128 _ax, __m128 _ay, __m128 _az, __m128 _bs, __m128 _bx, __m128 _by, __m128 _bz) noexcept
+  {
+    __m128 r=_mm_mul_ps(_as,_bs);
+    r=_mm_add_ps(r,_mm_mul_ps(_ax,_bx));
+    r=_mm_add_ps(r,_mm_mul_ps(_ay,_by));
+    return _mm_add_ps(r,_mm_mul_ps(_az,_bz));
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief acos for _x in [0,1] using the Abramowitz and Stegun 4.4.46 polynomial, error below 2e-8
+  //----------------------------------------------------------------------------------------------------------------------
+  inline __m128 acos01(__m128 _x) noexcept
+  {
+    __m128 p=_mm_set1_ps(-0.0012624911f);
+    p=_mm_add_ps(_mm_mul_ps(p,_x),_mm_set1_ps( 0.0066700901f));
+    p=_mm_add_ps(_mm_mul_ps(p,_x),_mm_set1_ps(-0.0170881256f));
+    p=_mm_add_ps(_mm_mul_ps(p,_x),_mm_set1_ps( 0.0308918810f));
+    p=_mm_add_ps(_mm_mul_ps(p,_x),_mm_set1_ps(-0.0501743046f));
+    p=_mm_add_ps(_mm_mul_ps(p,_x),_mm_set1_ps( 0.0889789874f));
+    p=_mm_add_ps(_mm_mul_ps(p,_x),_mm_set1_ps(-0.2145988016f));
+    p=_mm_add_ps(_mm_mul_ps(p,_x),_mm_set1_ps( 1.5707963050f));
+    return _mm_mul_ps(p,_mm_sqrt_ps(_mm_sub_ps(_mm_set1_ps(1.0f),_x)));
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief sin for _x in [0,pi/2] (all slerp needs) using the series to x^11, error below 1e-7
+  //----------------------------------------------------------------------------------------------------------------------
+  inline __m128 sinHalfPi(__m128 _x) noexcept
+  {
+    __m128 x2=_mm_mul_ps(_x,_x);
+    __m128 p=_mm_set1_ps(-1.0f/39916800.0f);
+    p=_mm_add_ps(_mm_mul_ps(p,x2),_mm_set1_ps( 1.0f/362880.0f));
+    p=_mm_add_ps(_mm_mul_ps(p,x2),_mm_set1_ps(-1.0f/5040.0f));
+    p=_mm_add_ps(_mm_mul_ps(p,x2),_mm_set1_ps( 1.0f/120.0f));
+    p=_mm_add_ps(_mm_mul_ps(p,x2),_mm_set1_ps(-1.0f/6.0f));
+    p=_mm_add_ps(_mm_mul_ps(p,x2),_mm_set1_ps( 1.0f));
+    return _mm_mul_ps(p,_x);
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  inline __m128 select(__m128 _mask, __m128 _a, __m128 _b) noexcept
+  {
+    return _mm_or_ps(_mm_and_ps(_mask,_a),_mm_andnot_ps(_mask,_b));
+  }
+#endif
+
+  //----------------------------------------------------------------------------------------------------------------------
+  void slerpRange(const Quaternion *_a, const Quaternion *_b, const Blend &_t, Quaternion *o_out, size_t _begin, size_t _end) noexcept
+  {
+    size_t i=_begin;
+#ifdef NGL_SIMD_X86
+    if(activeSIMDLevel()!=SIMDLevel::SCALAR)
+    {
+      const __m128 one=_mm_set1_ps(1.0f);
+      const __m128 signBit=_mm_set1_ps(-0.0f);
+      for( ; i+4<=_end; i+=4)
+      {
+        __m128 as,ax,ay,az,bs,bx,by,bz;
+        load4(data(_a+i),as,ax,ay,az);
+        load4(data(_b+i),bs,bx,by,bz);
+        __m128 t=loadBlend(_t,i);
+        __m128 cosom=dot4(as,ax,ay,az,bs,bx,by,bz);
+        // take the short way round by flipping b where the dot product is negative
+        __m128 flip=_mm_and_ps(cosom,signBit);
+        cosom=_mm_xor_ps(cosom,flip);
+        bs=_mm_xor_ps(bs,flip);
+        bx=_mm_xor_ps(bx,flip);
+        by=_mm_xor_ps(by,flip);
+        bz=_mm_xor_ps(bz,flip);
+
+        __m128 omega=acos01(_mm_min_ps(cosom,one));
+        __m128 invSin=_mm_div_ps(one,sinHalfPi(omega));
+        __m128 oneMinusT=_mm_sub_ps(one,t);
+        __m128 sclp=_mm_mul_ps(sinHalfPi(_mm_mul_ps(oneMinusT,omega)),invSin);
+        __m128 sclq=_mm_mul_ps(sinHalfPi(_mm_mul_ps(t,omega)),invSin);
+        // very close so linear blend, this also drops the divide by zero
+        __m128 linear=_mm_cmple_ps(_mm_sub_ps(one,cosom),_mm_set1_ps(c_slerpEpsilon));
+        sclp=select(linear,oneMinusT,sclp);
+        sclq=select(linear,t,sclq);
+
+        store4(data(o_out+i),
+               _mm_add_ps(_mm_mul_ps(as,sclp),_mm_mul_ps(bs,sclq)),
+               _mm_add_ps(_mm_mul_ps(ax,sclp),_mm_mul_ps(bx,sclq)),
+               _mm_add_ps(_mm_mul_ps(ay,sclp),_mm_mul_ps(by,sclq)),
+               _mm_add_ps(_mm_mul_ps(az,sclp),_mm_mul_ps(bz,sclq)));
+      }
+    }
+#endif
+    for( ; i<_end; ++i)
+    {
+      o_out[i]=Quaternion::slerp(_a[i],_b[i],_t.get(i));
+    }
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  void nlerpRange(const Quaternion *_a, const Quaternion *_b, const Blend &_t, Quaternion *o_out, size_t _begin, size_t _end) noexcept
+  {
+    size_t i=_begin;
+#ifdef NGL_SIMD_X86
+    if(activeSIMDLevel()!=SIMDLevel::SCALAR)
+    {
+      const __m128 one=_mm_set1_ps(1.0f);
+      const __m128 signBit=_mm_set1_ps(-0.0f);
+      for( ; i+4<=_end; i+=4)
+      {
+        __m128 as,ax,ay,az,bs,bx,by,bz;
+        load4(data(_a+i),as,ax,ay,az);
+        load4(data(_b+i),bs,bx,by,bz);
+        __m128 t=loadBlend(_t,i);
+        __m128 flip=_mm_and_ps(dot4(as,ax,ay,az,bs,bx,by,bz),signBit);
+        __m128 ta=_mm_sub_ps(one,t);
+        __m128 tb=_mm_xor_ps(t,flip);
+        __m128 s=_mm_add_ps(_mm_mul_ps(as,ta),_mm_mul_ps(bs,tb));
+        __m128 x=_mm_add_ps(_mm_mul_ps(ax,ta),_mm_mul_ps(bx,tb));
+        __m128 y=_mm_add_ps(_mm_mul_ps(ay,ta),_mm_mul_ps(by,tb));
+        __m128 z=_mm_add_ps(_mm_mul_ps(az,ta),_mm_mul_ps(bz,tb));
+        __m128 inv=_mm_div_ps(one,_mm_sqrt_ps(dot4(s,x,y,z,s,x,y,z)));
+        store4(data(o_out+i),_mm_mul_ps(s,inv),_mm_mul_ps(x,inv),_mm_mul_ps(y,inv),_mm_mul_ps(z,inv));
+      }
+    }
+#endif
+    for( ; i<_end; ++i)
+    {
+      o_out[i]=nlerp(_a[i],_b[i],_t.get(i));
+    }
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  void multiplyRange(const Quaternion *_a, const Quaternion *_b, Quaternion *o_out, size_t _begin, size_t _end) noexcept
+  {
+    size_t i=_begin;
+#ifdef NGL_SIMD_X86
+    if(activeSIMDLevel()!=SIMDLevel::SCALAR)
+    {
+      for( ; i+4<=_end; i+=4)
+      {
+        __m128 as,ax,ay,az,bs,bx,by,bz;
+        load4(data(_a+i),as,ax,ay,az);
+        load4(data(_b+i),bs,bx,by,bz);
+        // SaSb - A.B and saB + sbA + A x B in the same order as Quaternion::operator*
+        __m128 s=_mm_sub_ps(_mm_mul_ps(as,bs),
+                            _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax,bx),_mm_mul_ps(ay,by)),_mm_mul_ps(az,bz)));
+        __m128 x=_mm_add_ps(_mm_add_ps(_mm_mul_ps(as,bx),_mm_mul_ps(bs,ax)),_mm_sub_ps(_mm_mul_ps(ay,bz),_mm_mul_ps(az,by)));
+        __m128 y=_mm_add_ps(_mm_add_ps(_mm_mul_ps(as,by),_mm_mul_ps(bs,ay)),_mm_sub_ps(_mm_mul_ps(az,bx),_mm_mul_ps(ax,bz)));
+        __m128 z=_mm_add_ps(_mm_add_ps(_mm_mul_ps(as,bz),_mm_mul_ps(bs,az)),_mm_sub_ps(_mm_mul_ps(ax,by),_mm_mul_ps(ay,bx)));
+        store4(data(o_out+i),s,x,y,z);
+      }
+    }
+#endif
+    for( ; i<_end; ++i)
+    {
+      o_out[i]=_a[i]*_b[i];
+    }
+  }
+
+#ifdef NGL_SIMD_X86
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the 9 rotation terms of 4 quaternions laid out as Quaternion::toMat4, o_r[row][col]
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void rotation4(const Real *_q, __m128 o_r[3][3]) noexcept
+  {
+    __m128 s,x,y,z;
+    load4(_q,s,x,y,z);
+    const __m128 one=_mm_set1_ps(1.0f);
+    const __m128 two=_mm_set1_ps(2.0f);
+    __m128 xx=_mm_mul_ps(x,x);
+    __m128 xy=_mm_mul_ps(x,y);
+    __m128 xz=_mm_mul_ps(x,z);
+    __m128 xs=_mm_mul_ps(x,s);
+    __m128 yy=_mm_mul_ps(y,y);
+    __m128 yz=_mm_mul_ps(y,z);
+    __m128 ys=_mm_mul_ps(y,s);
+    __m128 zz=_mm_mul_ps(z,z);
+    __m128 zs=_mm_mul_ps(z,s);
+    o_r[0][0]=_mm_sub_ps(one,_mm_mul_ps(two,_mm_add_ps(yy,zz)));
+    o_r[0][1]=_mm_mul_ps(two,_mm_add_ps(xy,zs));
+    o_r[0][2]=_mm_mul_ps(two,_mm_sub_ps(xz,ys));
+    o_r[1][0]=_mm_mul_ps(two,_mm_sub_ps(xy,zs));
+    o_r[1][1]=_mm_sub_ps(one,_mm_mul_ps(two,_mm_add_ps(xx,zz)));
+    o_r[1][2]=_mm_mul_ps(two,_mm_add_ps(yz,xs));
+    o_r[2][0]=_mm_mul_ps(two,_mm_add_ps(xz,ys));
+    o_r[2][1]=_mm_mul_ps(two,_mm_sub_ps(yz,xs));
+    o_r[2][2]=_mm_sub_ps(one,_mm_mul_ps(two,_mm_add_ps(xx,yy)));
+  }
+#endif
+
+  //----------------------------------------------------------------------------------------------------------------------
+  void toMat4Range(const Quaternion *_q, Mat4 *o_out, size_t _begin, size_t _end) noexcept
+  {
+    size_t i=_begin;
+#ifdef NGL_SIMD_X86
+    if(activeSIMDLevel()!=SIMDLevel::SCALAR)
+    {
+      const __m128 lastRow=_mm_setr_ps(0.0f,0.0f,0.0f,1.0f);
+      for( ; i+4<=_end; i+=4)
+      {
+        __m128 r[3][3];
+        rotation4(data(_q+i),r);
+        for(int row=0; row<3; ++row)
+        {
+          // transposing gives this row of each of the 4 matrices
+          __m128 m0=r[row][0];
+          __m128 m1=r[row][1];
+          __m128 m2=r[row][2];
+          __m128 m3=_mm_setzero_ps();
+          _MM_TRANSPOSE4_PS(m0,m1,m2,m3);
+          _mm_storeu_ps(&o_out[i].m_openGL[row*4],m0);
+          _mm_storeu_ps(&o_out[i+1].m_openGL[row*4],m1);
+          _mm_storeu_ps(&o_out[i+2].m_openGL[row*4],m2);
+          _mm_storeu_ps(&o_out[i+3].m_openGL[row*4],m3);
+        }
+        for(size_t j=0; j<4; ++j)
+        {
+          _mm_storeu_ps(&o_out[i+j].m_openGL[12],lastRow);
+        }
+      }
+    }
+#endif
+    for( ; i<_end; ++i)
+    {
+      o_out[i]=_q[i].toMat4();
+    }
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  void toMat3Range(const Quaternion *_q, Mat3 *o_out, size_t _begin, size_t _end) noexcept
+  {
+    size_t i=_begin;
+#ifdef NGL_SIMD_X86
+    if(activeSIMDLevel()!=SIMDLevel::SCALAR)
+    {
+      for( ; i+4<=_end; i+=4)
+      {
+        __m128 r[3][3];
+        rotation4(data(_q+i),r);
+        // Mat3 is 9 packed floats, elements 0-3 and 4-7 of each are a transpose of 4 registers
+        __m128 a0=r[0][0], a1=r[0][1], a2=r[0][2], a3=r[1][0];
+        __m128 b0=r[1][1], b1=r[1][2], b2=r[2][0], b3=r[2][1];
+        _MM_TRANSPOSE4_PS(a0,a1,a2,a3);
+        _MM_TRANSPOSE4_PS(b0,b1,b2,b3);
+        alignas(16) Real last[4];
+        _mm_store_ps(last,r[2][2]);
+        __m128 a[4]={a0,a1,a2,a3};
+        __m128 b[4]={b0,b1,b2,b3};
+        for(size_t j=0; j<4; ++j)
+        {
+          Real *m=&o_out[i+j].m_openGL[0];
+          _mm_storeu_ps(m,a[j]);
+          _mm_storeu_ps(m+4,b[j]);
+          m[8]=last[j];
+        }
+      }
+    }
+#endif
+    for( ; i<_end; ++i)
+    {
+      o_out[i]=Mat3(_q[i].toMat4());
+    }
+  }
+} // end anon namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+void slerpQuaternions(const Quaternion *_a, const Quaternion *_b, size_t _count, Real _t, Quaternion *o_out) noexcept
+{
+  Blend t={_t,nullptr};
+  parallelFor(_count,c_grainSize,[_a,_b,&t,o_out](size_t _begin, size_t _end)
+  {
+    slerpRange(_a,_b,t,o_out,_begin,_end);
+  });
+}
+//----------------------------------------------------------------------------------------------------------------------
+void slerpQuaternions(const Quaternion *_a, const Quaternion *_b, size_t _count, const Real *_t, Quaternion *o_out) noexcept
+{
+  Blend t={0.0f,_t};
+  parallelFor(_count,c_grainSize,[_a,_b,&t,o_out](size_t _begin, size_t _end)
+  {
+    slerpRange(_a,_b,t,o_out,_begin,_end);
+  });
+}
+//----------------------------------------------------------------------------------------------------------------------
+void nlerpQuaternions(const Quaternion *_a, const Quaternion *_b, size_t _count, Real _t, Quaternion *o_out) noexcept
+{
+  Blend t={_t,nullptr};
+  parallelFor(_count,c_grainSize,[_a,_b,&t,o_out](size_t _begin, size_t _end)
+  {
+    nlerpRange(_a,_b,t,o_out,_begin,_end);
+  });
+}
+//----------------------------------------------------------------------------------------------------------------------
+void nlerpQuaternions(const Quaternion *_a, const Quaternion *_b, size_t _count, const Real *_t, Quaternion *o_out) noexcept
+{
+  Blend t={0.0f,_t};
+  parallelFor(_count,c_grainSize,[_a,_b,&t,o_out](size_t _begin, size_t _end)
+  {
+    nlerpRange(_a,_b,t,o_out,_begin,_end);
+  });
+}
+//----------------------------------------------------------------------------------------------------------------------
+void multiplyQuaternions(const Quaternion *_a, const Quaternion *_b, size_t _count, Quaternion *o_out) noexcept
+{
+  parallelFor(_count,c_grainSize,[_a,_b,o_out](size_t _begin, size_t _end)
+  {
+    multiplyRange(_a,_b,o_out,_begin,_end);
+  });
+}
+//----------------------------------------------------------------------------------------------------------------------
+void quaternionsToMat4(const Quaternion *_q, size_t _count, Mat4 *o_out) noexcept
+{
+  parallelFor(_count,c_grainSize,[_q,o_out](size_t _begin, size_t _end)
+  {
+    toMat4Range(_q,o_out,_begin,_end);
+  });
+}
+//----------------------------------------------------------------------------------------------------------------------
+void quaternionsToMat3(const Quaternion *_q, size_t _count, Mat3 *o_out) noexcept
+{
+  parallelFor(_count,c_grainSize,[_q,o_out](size_t _begin, size_t _end)
+  {
+    toMat3Range(_q,o_out,_begin,_end);
+  });
+}
+
+} // end namespace ngl
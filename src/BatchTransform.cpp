@@ -0,0 +1,350 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "BatchTransform.h"
+#include "Mat4.h"
+#include "Vec3.h"
+#include "Vec4.h"
+#include "SIMD.h"
+#include "ParallelFor.h"
+#include "SoAKernels.h"
+#include <cmath>
+#ifdef NGL_SIMD_X86
+  #include <immintrin.h>
+#endif
+//----------------------------------------------------------------------------------------------------------------------
+/// @file BatchTransform.cpp
+/// @brief implementation of the array transform functions
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace ngl
+{
+
+namespace
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief below this many elements per thread it is not worth starting another one
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr size_t c_grainSize=16384;
+
+  enum class Mode : char {POINT,VECTOR,NORMAL};
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the matrix actually applied (the normal matrix for normals) and how to treat w
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Kernel
+  {
+    Real m[4][4];
+    Mode mode;
+  };
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the destination, either an array of Vec3 / Vec4 or separate component arrays
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Output
+  {
+    Vec3 *v3=nullptr;
+    Vec4 *v4=nullptr;
+    Real *x=nullptr;
+    Real *y=nullptr;
+    Real *z=nullptr;
+    Real *w=nullptr;
+  };
+
+  //----------------------------------------------------------------------------------------------------------------------
+  Kernel makeKernel(const Mat4 &_m, Mode _mode) noexcept
+  {
+    Kernel k;
+    k.mode=_mode;
+    for(int i=0; i<4; ++i)
+    {
+      for(int j=0; j<4; ++j)
+      {
+        k.m[i][j]=_m.m_m[i][j];
+      }
+    }
+    if(_mode==Mode::NORMAL)
+    {
+      // the cofactor matrix of the upper 3x3 is det * inverse transpose, the rows are the cross
+      // products of the other two rows, as we normalize afterwards we only need the sign of det
+      const Real (*a)[4]=_m.m_m;
+      Real c[3][3]={
+                     { a[1][1]*a[2][2]-a[1][2]*a[2][1], a[1][2]*a[2][0]-a[1][0]*a[2][2], a[1][0]*a[2][1]-a[1][1]*a[2][0] },
+                     { a[2][1]*a[0][2]-a[2][2]*a[0][1], a[2][2]*a[0][0]-a[2][0]*a[0][2], a[2][0]*a[0][1]-a[2][1]*a[0][0] },
+                     { a[0][1]*a[1][2]-a[0][2]*a[1][1], a[0][2]*a[1][0]-a[0][0]*a[1][2], a[0][0]*a[1][1]-a[0][1]*a[1][0] }
+                   };
+      Real det=a[0][0]*c[0][0]+a[0][1]*c[0][1]+a[0][2]*c[0][2];
+      Real sign= det < 0.0f ? -1.0f : 1.0f;
+      for(int i=0; i<3; ++i)
+      {
+        for(int j=0; j<3; ++j)
+        {
+          k.m[i][j]=c[i][j]*sign;
+        }
+      }
+    }
+    return k;
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void read(const Vec3 &_v, Real o_v[4]) noexcept
+  {
+    o_v[0]=_v.m_x; o_v[1]=_v.m_y; o_v[2]=_v.m_z; o_v[3]=1.0f;
+  }
+  inline void read(const Vec4 &_v, Real o_v[4]) noexcept
+  {
+    o_v[0]=_v.m_x; o_v[1]=_v.m_y; o_v[2]=_v.m_z; o_v[3]=_v.m_w;
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void write(const Output &_out, size_t _i, const Real _v[4]) noexcept
+  {
+    if(_out.v3)
+    {
+      _out.v3[_i].set(_v[0],_v[1],_v[2]);
+    }
+    else if(_out.v4)
+    {
+      _out.v4[_i].set(_v[0],_v[1],_v[2],_v[3]);
+    }
+    else
+    {
+      _out.x[_i]=_v[0];
+      _out.y[_i]=_v[1];
+      _out.z[_i]=_v[2];
+      if(_out.w)
+      {
+        _out.w[_i]=_v[3];
+      }
+    }
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief scalar transform of a single element, this evaluates the sums in the same order as Vec4 * Mat4
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void transformOne(const Kernel &_k, const Real _v[4], Real o_v[4]) noexcept
+  {
+    Real x=_v[0]*_k.m[0][0] + _v[1]*_k.m[1][0] + _v[2]*_k.m[2][0];
+    Real y=_v[0]*_k.m[0][1] + _v[1]*_k.m[1][1] + _v[2]*_k.m[2][1];
+    Real z=_v[0]*_k.m[0][2] + _v[1]*_k.m[1][2] + _v[2]*_k.m[2][2];
+    Real w=0.0f;
+    if(_k.mode==Mode::POINT)
+    {
+      x+=_v[3]*_k.m[3][0];
+      y+=_v[3]*_k.m[3][1];
+      z+=_v[3]*_k.m[3][2];
+      w=_v[0]*_k.m[0][3] + _v[1]*_k.m[1][3] + _v[2]*_k.m[2][3] + _v[3]*_k.m[3][3];
+    }
+    else if(_k.mode==Mode::NORMAL)
+    {
+      Real len=sqrtf(x*x+y*y+z*z);
+      if(len > 0.0f)
+      {
+        x/=len;
+        y/=len;
+        z/=len;
+      }
+    }
+    o_v[0]=x; o_v[1]=y; o_v[2]=z; o_v[3]=w;
+  }
+
+#ifdef NGL_SIMD_X86
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief load 4 elements and transpose them so each register holds one component of all 4
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void load4(const Vec3 *_v, __m128 &o_x, __m128 &o_y, __m128 &o_z, __m128 &o_w) noexcept
+  {
+    soa::load3x4(&_v->m_x,o_x,o_y,o_z);
+    o_w=_mm_set1_ps(1.0f);
+  }
+  inline void load4(const Vec4 *_v, __m128 &o_x, __m128 &o_y, __m128 &o_z, __m128 &o_w) noexcept
+  {
+    const Real *p=&_v->m_x;
+    o_x=_mm_loadu_ps(p);
+    o_y=_mm_loadu_ps(p+4);
+    o_z=_mm_loadu_ps(p+8);
+    o_w=_mm_loadu_ps(p+12);
+    _MM_TRANSPOSE4_PS(o_x,o_y,o_z,o_w);
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void store4(const Output &_out, size_t _i, __m128 _x, __m128 _y, __m128 _z, __m128 _w) noexcept
+  {
+    if(_out.v3)
+    {
+      soa::store3x4(&_out.v3[_i].m_x,_x,_y,_z);
+    }
+    else if(_out.v4)
+    {
+      _MM_TRANSPOSE4_PS(_x,_y,_z,_w);
+      Real *p=&_out.v4[_i].m_x;
+      _mm_storeu_ps(p,_x);
+      _mm_storeu_ps(p+4,_y);
+      _mm_storeu_ps(p+8,_z);
+      _mm_storeu_ps(p+12,_w);
+    }
+    else
+    {
+      _mm_storeu_ps(_out.x+_i,_x);
+      _mm_storeu_ps(_out.y+_i,_y);
+      _mm_storeu_ps(_out.z+_i,_z);
+      if(_out.w)
+      {
+        _mm_storeu_ps(_out.w+_i,_w);
+      }
+    }
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief column j of the kernel matrix dotted with 3 components, same summation order as transformOne
+  //----------------------------------------------------------------------------------------------------------------------
+  inline __m128 column(const Kernel &_k, int _j, __m128 _x, __m128 _y, __m128 _z) noexcept
+  {
+    __m128 r=_mm_mul_ps(_x,_mm_set1_ps(_k.m[0][_j]));
+    r=_mm_add_ps(r,_mm_mul_ps(_y,_mm_set1_ps(_k.m[1][_j])));
+    return _mm_add_ps(r,_mm_mul_ps(_z,_mm_set1_ps(_k.m[2][_j])));
+  }
+#endif
+
+  //----------------------------------------------------------------------------------------------------------------------
+  template <typename In>
+  void transformRange(const Kernel &_k, const In *_in, const Output &_out, size_t _begin, size_t _end) noexcept
+  {
+    size_t i=_begin;
+#ifdef NGL_SIMD_X86
+    if(activeSIMDLevel()!=SIMDLevel::SCALAR)
+    {
+      for( ; i+4<=_end; i+=4)
+      {
+        __m128 x,y,z,w;
+        load4(_in+i,x,y,z,w);
+        __m128 ox=column(_k,0,x,y,z);
+        __m128 oy=column(_k,1,x,y,z);
+        __m128 oz=column(_k,2,x,y,z);
+        __m128 ow=_mm_setzero_ps();
+        if(_k.mode==Mode::POINT)
+        {
+          ox=_mm_add_ps(ox,_mm_mul_ps(w,_mm_set1_ps(_k.m[3][0])));
+          oy=_mm_add_ps(oy,_mm_mul_ps(w,_mm_set1_ps(_k.m[3][1])));
+          oz=_mm_add_ps(oz,_mm_mul_ps(w,_mm_set1_ps(_k.m[3][2])));
+          ow=_mm_add_ps(column(_k,3,x,y,z),_mm_mul_ps(w,_mm_set1_ps(_k.m[3][3])));
+        }
+        else if(_k.mode==Mode::NORMAL)
+        {
+          __m128 len=_mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(ox,ox),_mm_mul_ps(oy,oy)),_mm_mul_ps(oz,oz)));
+          // zero length normals divide by 1 so stay zero
+          __m128 zero=_mm_cmpeq_ps(len,_mm_setzero_ps());
+          len=_mm_or_ps(_mm_andnot_ps(zero,len),_mm_and_ps(zero,_mm_set1_ps(1.0f)));
+          ox=_mm_div_ps(ox,len);
+          oy=_mm_div_ps(oy,len);
+          oz=_mm_div_ps(oz,len);
+        }
+        store4(_out,i,ox,oy,oz,ow);
+      }
+    }
+#endif
+    for( ; i<_end; ++i)
+    {
+      Real v[4];
+      Real r[4];
+      read(_in[i],v);
+      transformOne(_k,v,r);
+      write(_out,i,r);
+    }
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  template <typename In>
+  void transformArray(const Mat4 &_m, Mode _mode, const In *_in, size_t _count, const Output &_out) noexcept
+  {
+    Kernel k=makeKernel(_m,_mode);
+    parallelFor(_count,c_grainSize,[&k,_in,&_out](size_t _begin, size_t _end)
+    {
+      transformRange(k,_in,_out,_begin,_end);
+    });
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  Output aos(Vec3 *_v) noexcept { Output o; o.v3=_v; return o; }
+  Output aos(Vec4 *_v) noexcept { Output o; o.v4=_v; return o; }
+  Output components(Real *_x, Real *_y, Real *_z, Real *_w=nullptr) noexcept
+  {
+    Output o;
+    o.x=_x; o.y=_y; o.z=_z; o.w=_w;
+    return o;
+  }
+} // end anon namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+void transformPoints(const Mat4 &_m, const Vec3 *_in, size_t _count, Vec3 *o_out) noexcept
+{
+  transformArray(_m,Mode::POINT,_in,_count,aos(o_out));
+}
+//----------------------------------------------------------------------------------------------------------------------
+void transformPoints(const Mat4 &_m, const Vec4 *_in, size_t _count, Vec4 *o_out) noexcept
+{
+  transformArray(_m,Mode::POINT,_in,_count,aos(o_out));
+}
+//----------------------------------------------------------------------------------------------------------------------
+void transformPoints(const Mat4 &_m, const Vec3 *_in, size_t _count, Real *o_x, Real *o_y, Real *o_z) noexcept
+{
+  transformArray(_m,Mode::POINT,_in,_count,components(o_x,o_y,o_z));
+}
+//----------------------------------------------------------------------------------------------------------------------
+void transformPoints(const Mat4 &_m, const Vec4 *_in, size_t _count, Real *o_x, Real *o_y, Real *o_z, Real *o_w) noexcept
+{
+  transformArray(_m,Mode::POINT,_in,_count,components(o_x,o_y,o_z,o_w));
+}
+//----------------------------------------------------------------------------------------------------------------------
+void transformVectors(const Mat4 &_m, const Vec3 *_in, size_t _count, Vec3 *o_out) noexcept
+{
+  transformArray(_m,Mode::VECTOR,_in,_count,aos(o_out));
+}
+//----------------------------------------------------------------------------------------------------------------------
+void transformVectors(const Mat4 &_m, const Vec4 *_in, size_t _count, Vec4 *o_out) noexcept
+{
+  transformArray(_m,Mode::VECTOR,_in,_count,aos(o_out));
+}
+//----------------------------------------------------------------------------------------------------------------------
+void transformVectors(const Mat4 &_m, const Vec3 *_in, size_t _count, Real *o_x, Real *o_y, Real *o_z) noexcept
+{
+  transformArray(_m,Mode::VECTOR,_in,_count,components(o_x,o_y,o_z));
+}
+//----------------------------------------------------------------------------------------------------------------------
+void transformVectors(const Mat4 &_m, const Vec4 *_in, size_t _count, Real *o_x, Real *o_y, Real *o_z) noexcept
+{
+  transformArray(_m,Mode::VECTOR,_in,_count,components(o_x,o_y,o_z));
+}
+//----------------------------------------------------------------------------------------------------------------------
+void transformNormals(const Mat4 &_m, const Vec3 *_in, size_t _count, Vec3 *o_out) noexcept
+{
+  transformArray(_m,Mode::NORMAL,_in,_count,aos(o_out));
+}
+//----------------------------------------------------------------------------------------------------------------------
+void transformNormals(const Mat4 &_m, const Vec4 *_in, size_t _count, Vec4 *o_out) noexcept
+{
+  transformArray(_m,Mode::NORMAL,_in,_count,aos(o_out));
+}
+//----------------------------------------------------------------------------------------------------------------------
+void transformNormals(const Mat4 &_m, const Vec3 *_in, size_t _count, Real *o_x, Real *o_y, Real *o_z) noexcept
+{
+  transformArray(_m,Mode::NORMAL,_in,_count,components(o_x,o_y,o_z));
+}
+//----------------------------------------------------------------------------------------------------------------------
+void transformNormals(const Mat4 &_m, const Vec4 *_in, size_t _count, Real *o_x, Real *o_y, Real *o_z) noexcept
+{
+  transformArray(_m,Mode::NORMAL,_in,_count,components(o_x,o_y,o_z));
+}
+
+} // end namespace ngl
@@ -0,0 +1,495 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "BoundingSphere.h"
+#include "SoAKernels.h"
+#include "ParallelFor.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file BoundingSphere.cpp
+/// @brief implementation files for BoundingSphere class
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace ngl
+{
+
+namespace
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief p * _m including the translation
+  //----------------------------------------------------------------------------------------------------------------------
+  inline Vec3 transformPoint(const Vec3 &_p, const Mat4 &_m) noexcept
+  {
+    return Vec3(_p.m_x*_m.m_m[0][0] + _p.m_y*_m.m_m[1][0] + _p.m_z*_m.m_m[2][0] + _m.m_m[3][0],
+                _p.m_x*_m.m_m[0][1] + _p.m_y*_m.m_m[1][1] + _p.m_z*_m.m_m[2][1] + _m.m_m[3][1],
+                _p.m_x*_m.m_m[0][2] + _p.m_y*_m.m_m[1][2] + _p.m_z*_m.m_m[2][2] + _m.m_m[3][2]);
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the largest length of the three axis rows, how much the matrix can stretch a radius
+  //----------------------------------------------------------------------------------------------------------------------
+  inline Real maxScale(const Mat4 &_m) noexcept
+  {
+    Real s=0.0f;
+    for(int i=0; i<3; ++i)
+    {
+      s=std::max(s,_m.m_m[i][0]*_m.m_m[i][0] + _m.m_m[i][1]*_m.m_m[i][1] + _m.m_m[i][2]*_m.m_m[i][2]);
+    }
+    return std::sqrt(s);
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of points each thread is given when fitting large arrays
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr size_t c_pointGrain=1<<16;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the indices of the points with the smallest and largest x, y and z
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Extremes
+  {
+    size_t m_min[3]={0,0,0};
+    size_t m_max[3]={0,0,0};
+  };
+
+  Extremes findExtremes(const Vec3 *_points, size_t _count)
+  {
+    auto better=[_points](Extremes _a, const Extremes &_b)
+    {
+      for(size_t i=0; i<3; ++i)
+      {
+        if(_points[_b.m_min[i]].m_openGL[i]<_points[_a.m_min[i]].m_openGL[i])
+        {
+          _a.m_min[i]=_b.m_min[i];
+        }
+        if(_points[_b.m_max[i]].m_openGL[i]>_points[_a.m_max[i]].m_openGL[i])
+        {
+          _a.m_max[i]=_b.m_max[i];
+        }
+      }
+      return _a;
+    };
+    return parallelReduce(_count,c_pointGrain,Extremes(),[_points](size_t _begin, size_t _end)
+    {
+      Extremes e;
+      for(size_t i=0; i<3; ++i)
+      {
+        e.m_min[i]=e.m_max[i]=_begin;
+      }
+      for(size_t p=_begin+1; p<_end; ++p)
+      {
+        for(size_t i=0; i<3; ++i)
+        {
+          Real v=_points[p].m_openGL[i];
+          if(v<_points[e.m_min[i]].m_openGL[i]) { e.m_min[i]=p; }
+          if(v>_points[e.m_max[i]].m_openGL[i]) { e.m_max[i]=p; }
+        }
+      }
+      return e;
+    },better);
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief grow a sphere over the points visiting them as _start, _start+_stride, ... mod _count, with a
+  /// stride coprime to _count every point is visited once
+  //----------------------------------------------------------------------------------------------------------------------
+  void growOver(const Vec3 *_points, size_t _count, size_t _start, size_t _stride, BoundingSphere &io_s) noexcept
+  {
+    size_t p=_start;
+    for(size_t i=0; i<_count; ++i)
+    {
+      io_s.extend(_points[p]);
+      p+=_stride;
+      if(p>=_count)
+      {
+        p-=_count;
+      }
+    }
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief greatest common divisor for picking the strides
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t gcd(size_t _a, size_t _b) noexcept
+  {
+    while(_b!=0)
+    {
+      size_t t=_a%_b;
+      _a=_b;
+      _b=t;
+    }
+    return _a;
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief Ritter's method (following Parent, Computer Animation Algorithms and Techniques, appendix B),
+  /// the sphere through the most separated pair of axis extremes grown to hold each point
+  //----------------------------------------------------------------------------------------------------------------------
+  BoundingSphere ritter(const Vec3 *_points, size_t _count)
+  {
+    Extremes e=findExtremes(_points,_count);
+    size_t a=e.m_min[0];
+    size_t b=e.m_max[0];
+    for(size_t i=1; i<3; ++i)
+    {
+      if((_points[e.m_max[i]]-_points[e.m_min[i]]).lengthSquared() > (_points[b]-_points[a]).lengthSquared())
+      {
+        a=e.m_min[i];
+        b=e.m_max[i];
+      }
+    }
+    BoundingSphere s((_points[a]+_points[b])*0.5f,(_points[b]-_points[a]).length()*0.5f);
+    growOver(_points,_count,0,1,s);
+    return s;
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief shrink and regrow the Ritter sphere over the points in a different order a few times keeping the
+  /// smallest (Ericson, Real-Time Collision Detection 4.3.4), the orders are strides through the array so
+  /// the points do not need to be copied and shuffled
+  //----------------------------------------------------------------------------------------------------------------------
+  BoundingSphere iterativeRitter(const Vec3 *_points, size_t _count)
+  {
+    constexpr int c_iterations=8;
+    constexpr size_t c_strides[c_iterations]={7919,104729,15485863,2,32452843,3,86028121,5};
+    BoundingSphere best=ritter(_points,_count);
+    BoundingSphere s=best;
+    for(int k=0; k<c_iterations; ++k)
+    {
+      size_t stride=c_strides[k]%_count;
+      while(stride==0 || gcd(stride,_count)!=1)
+      {
+        stride=(stride+1)%_count;
+      }
+      s.m_radius*=0.95f;
+      growOver(_points,_count,(static_cast<size_t>(k)*_count)/c_iterations,stride,s);
+      if(s.m_radius<best.m_radius)
+      {
+        best=s;
+      }
+    }
+    return best;
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a sphere in double precision for Welzl's algorithm, a negative radius is empty
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Ball
+  {
+    double m_c[3]={0.0,0.0,0.0};
+    double m_r2=-1.0;
+
+    bool outside(const Vec3 &_p) const noexcept
+    {
+      double dx=_p.m_x-m_c[0];
+      double dy=_p.m_y-m_c[1];
+      double dz=_p.m_z-m_c[2];
+      return dx*dx+dy*dy+dz*dz > m_r2*(1.0+1e-9)+1e-12;
+    }
+  };
+
+  inline void sub(const Vec3 &_a, const Vec3 &_b, double o_r[3]) noexcept
+  {
+    o_r[0]=double(_a.m_x)-_b.m_x;
+    o_r[1]=double(_a.m_y)-_b.m_y;
+    o_r[2]=double(_a.m_z)-_b.m_z;
+  }
+
+  inline double dot(const double _a[3], const double _b[3]) noexcept
+  {
+    return _a[0]*_b[0]+_a[1]*_b[1]+_a[2]*_b[2];
+  }
+
+  inline void cross(const double _a[3], const double _b[3], double o_r[3]) noexcept
+  {
+    o_r[0]=_a[1]*_b[2]-_a[2]*_b[1];
+    o_r[1]=_a[2]*_b[0]-_a[0]*_b[2];
+    o_r[2]=_a[0]*_b[1]-_a[1]*_b[0];
+  }
+
+  Ball ballFromOffset(const Vec3 &_origin, const double _offset[3]) noexcept
+  {
+    Ball b;
+    for(int i=0; i<3; ++i)
+    {
+      b.m_c[i]=_origin.m_openGL[i]+_offset[i];
+    }
+    b.m_r2=dot(_offset,_offset);
+    return b;
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the smallest sphere with all of _support on its surface, degenerate sets fall back to the
+  /// smallest sphere of a subset that holds them all
+  //----------------------------------------------------------------------------------------------------------------------
+  Ball supportBall(const Vec3 *_support, int _n) noexcept
+  {
+    Ball b;
+    if(_n==0)
+    {
+      return b;
+    }
+    const Vec3 &p0=_support[0];
+    double a[3],c[3],d[3],axb[3],t[3],offset[3];
+    switch(_n)
+    {
+      case 1 :
+        offset[0]=offset[1]=offset[2]=0.0;
+        return ballFromOffset(p0,offset);
+      case 2 :
+        sub(_support[1],p0,a);
+        for(int i=0; i<3; ++i) { offset[i]=a[i]*0.5; }
+        return ballFromOffset(p0,offset);
+      case 3 :
+      {
+        sub(_support[1],p0,a);
+        sub(_support[2],p0,c);
+        cross(a,c,axb);
+        double denom=2.0*dot(axb,axb);
+        if(denom<=1e-18*dot(a,a)*dot(c,c))
+        {
+          // collinear, the sphere on the two furthest apart
+          Ball best;
+          const int pairs[3][2]={{0,1},{0,2},{1,2}};
+          for(const auto &pr : pairs)
+          {
+            Vec3 two[2]={_support[pr[0]],_support[pr[1]]};
+            Ball s=supportBall(two,2);
+            if(s.m_r2>best.m_r2) { best=s; }
+          }
+          return best;
+        }
+        double aa=dot(a,a);
+        double cc=dot(c,c);
+        for(int i=0; i<3; ++i) { t[i]=aa*c[i]-cc*a[i]; }
+        cross(t,axb,offset);
+        for(int i=0; i<3; ++i) { offset[i]/=denom; }
+        return ballFromOffset(p0,offset);
+      }
+      default :
+      {
+        sub(_support[1],p0,a);
+        sub(_support[2],p0,c);
+        sub(_support[3],p0,d);
+        double cxd[3],dxa[3];
+        cross(c,d,cxd);
+        cross(d,a,dxa);
+        cross(a,c,axb);
+        double det=2.0*dot(a,cxd);
+        double scale=std::sqrt(dot(a,a)*dot(c,c)*dot(d,d));
+        if(std::abs(det)<=1e-12*scale)
+        {
+          // coplanar, the smallest sphere on three of them that holds the fourth
+          Ball best;
+          best.m_r2=std::numeric_limits<double>::max();
+          for(int skip=0; skip<4; ++skip)
+          {
+            Vec3 three[3];
+            int k=0;
+            for(int i=0; i<4; ++i)
+            {
+              if(i!=skip) { three[k++]=_support[i]; }
+            }
+            Ball s=supportBall(three,3);
+            if(!s.outside(_support[skip]) && s.m_r2<best.m_r2) { best=s; }
+          }
+          return best;
+        }
+        double aa=dot(a,a);
+        double cc=dot(c,c);
+        double dd=dot(d,d);
+        for(int i=0; i<3; ++i) { offset[i]=(aa*cxd[i]+cc*dxa[i]+dd*axb[i])/det; }
+        return ballFromOffset(p0,offset);
+      }
+    }
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the smallest sphere holding io_points[0,_end) with _support on its surface, points found outside
+  /// are moved to the front so later passes meet them early. The recursion is at most 4 deep.
+  //----------------------------------------------------------------------------------------------------------------------
+  Ball welzl(std::vector<Vec3> &io_points, size_t _end, Vec3 *_support, int _numSupport)
+  {
+    Ball b=supportBall(_support,_numSupport);
+    if(_numSupport==4)
+    {
+      return b;
+    }
+    for(size_t i=0; i<_end; ++i)
+    {
+      if(b.outside(io_points[i]))
+      {
+        _support[_numSupport]=io_points[i];
+        b=welzl(io_points,i,_support,_numSupport+1);
+        std::rotate(io_points.begin(),io_points.begin()+static_cast<ptrdiff_t>(i),io_points.begin()+static_cast<ptrdiff_t>(i+1));
+      }
+    }
+    return b;
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the largest squared distance from _center to any of the points
+  //----------------------------------------------------------------------------------------------------------------------
+  Real maxDistanceSquared(const Vec3 *_points, size_t _count, const Vec3 &_center)
+  {
+    return parallelReduce(_count,c_pointGrain,Real(0.0f),[&](size_t _begin, size_t _end)
+    {
+      Real r=0.0f;
+      size_t i=_begin;
+#ifdef NGL_SIMD_X86
+      if(soa::useSIMD())
+      {
+        __m128 cx=_mm_set1_ps(_center.m_x);
+        __m128 cy=_mm_set1_ps(_center.m_y);
+        __m128 cz=_mm_set1_ps(_center.m_z);
+        __m128 mx=_mm_setzero_ps();
+        for( ; i+4<=_end; i+=4)
+        {
+          __m128 x,y,z;
+          soa::load3x4(&_points[i].m_x,x,y,z);
+          x=_mm_sub_ps(x,cx);
+          y=_mm_sub_ps(y,cy);
+          z=_mm_sub_ps(z,cz);
+          mx=_mm_max_ps(mx,_mm_add_ps(_mm_add_ps(_mm_mul_ps(x,x),_mm_mul_ps(y,y)),_mm_mul_ps(z,z)));
+        }
+        mx=_mm_max_ps(mx,_mm_shuffle_ps(mx,mx,_MM_SHUFFLE(1,0,3,2)));
+        mx=_mm_max_ps(mx,_mm_shuffle_ps(mx,mx,_MM_SHUFFLE(2,3,0,1)));
+        r=_mm_cvtss_f32(mx);
+      }
+#endif
+      for( ; i<_end; ++i)
+      {
+        r=std::max(r,(_points[i]-_center).lengthSquared());
+      }
+      return r;
+    },[](Real _a, Real _b){ return std::max(_a,_b); });
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+BoundingSphere BoundingSphere::fromBounds(const Bounds3 &_b) noexcept
+{
+  if(_b.isEmpty())
+  {
+    return BoundingSphere();
+  }
+  return BoundingSphere(_b.center(),_b.halfSize().length());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+BoundingSphere BoundingSphere::fromPoints(const Vec3 *_points, size_t _count, Fit _fit)
+{
+  if(_count==0)
+  {
+    return BoundingSphere();
+  }
+  BoundingSphere s;
+  switch(_fit)
+  {
+    case Fit::RITTER : s=ritter(_points,_count); break;
+    case Fit::ITERATIVE_RITTER : s=iterativeRitter(_points,_count); break;
+    case Fit::WELZL :
+    {
+      // a fixed shuffle so the expected linear time holds for sorted input and the result is repeatable
+      std::vector<Vec3> points(_points,_points+_count);
+      std::shuffle(points.begin(),points.end(),std::minstd_rand(5489u));
+      Vec3 support[4];
+      Ball b=welzl(points,points.size(),support,0);
+      s.m_center.set(static_cast<Real>(b.m_c[0]),static_cast<Real>(b.m_c[1]),static_cast<Real>(b.m_c[2]));
+    }
+    break;
+  }
+  // the float centre moved by rounding (or the fit grew in steps) so measure the radius directly
+  s.m_radius=std::sqrt(maxDistanceSquared(_points,_count,s.m_center));
+  return s;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void BoundingSphere::extend(const Vec3 &_p) noexcept
+{
+  if(isEmpty())
+  {
+    m_center=_p;
+    m_radius=0.0f;
+    return;
+  }
+  Vec3 d=_p-m_center;
+  Real dist2=d.lengthSquared();
+  if(dist2<=m_radius*m_radius)
+  {
+    return;
+  }
+  // the new sphere just touches the far side of the old one and the point
+  Real dist=std::sqrt(dist2);
+  Real radius=(m_radius+dist)*0.5f;
+  m_center+=d*((radius-m_radius)/dist);
+  m_radius=radius;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void BoundingSphere::merge(const BoundingSphere &_s) noexcept
+{
+  if(_s.isEmpty())
+  {
+    return;
+  }
+  if(isEmpty() || _s.contains(*this))
+  {
+    *this=_s;
+    return;
+  }
+  if(contains(_s))
+  {
+    return;
+  }
+  Vec3 d=_s.m_center-m_center;
+  Real dist=d.length();
+  Real radius=(dist+m_radius+_s.m_radius)*0.5f;
+  m_center+=d*((radius-m_radius)/dist);
+  m_radius=radius;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool BoundingSphere::intersectRay(const Vec3 &_origin, const Vec3 &_dir, Real _tMax, Real &o_t) const noexcept
+{
+  Vec3 m=_origin-m_center;
+  Real a=_dir.lengthSquared();
+  Real b=m.dot(_dir);
+  Real c=m.lengthSquared()-m_radius*m_radius;
+  // outside and pointing away
+  if(c>0.0f && b>0.0f)
+  {
+    return false;
+  }
+  Real disc=b*b-a*c;
+  if(disc<0.0f)
+  {
+    return false;
+  }
+  o_t=std::max((-b-std::sqrt(disc))/a,0.0f);
+  return o_t<=_tMax;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+BoundingSphere BoundingSphere::transformed(const Mat4 &_m) const noexcept
+{
+  return BoundingSphere(transformPoint(m_center,_m),m_radius*maxScale(_m));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void BoundingSphere::transform(const BoundingSphere *_in, size_t _count, const Mat4 &_m, BoundingSphere *o_out) noexcept
+{
+  Real scale=maxScale(_m);
+  for(size_t i=0; i<_count; ++i)
+  {
+    o_out[i]=BoundingSphere(transformPoint(_in[i].m_center,_m),_in[i].m_radius*scale);
+  }
+}
+
+} // end namespace ngl
@@ -0,0 +1,286 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Bounds3.h"
+#include "BoundingSphere.h"
+#include "SoAKernels.h"
+#include "ParallelFor.h"
+//----------------------------------------------------------------------------------------------------------------------
+/// @file Bounds3.cpp
+/// @brief implementation files for Bounds3 class
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace ngl
+{
+
+namespace
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of points each thread is given when fitting large arrays
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr size_t c_pointGrain=1<<16;
+#ifdef NGL_SIMD_X86
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a box as two registers, the 6 floats are read as [0,4) and [2,6) so nothing past the box is read
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void loadBounds(const Bounds3 &_b, __m128 &o_min, __m128 &o_max) noexcept
+  {
+    const Real *p=&_b.m_min.m_x;
+    o_min=_mm_loadu_ps(p);
+    __m128 hi=_mm_loadu_ps(p+2);
+    o_max=_mm_shuffle_ps(hi,hi,_MM_SHUFFLE(3,3,2,1));
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the reverse of loadBounds, the second store overwrites the spare lane of the first
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void storeBounds(Bounds3 &o_b, __m128 _min, __m128 _max) noexcept
+  {
+    Real *p=&o_b.m_min.m_x;
+    __m128 t=_mm_shuffle_ps(_min,_max,_MM_SHUFFLE(0,0,2,2));
+    _mm_storeu_ps(p,_min);
+    _mm_storeu_ps(p+2,_mm_shuffle_ps(t,_max,_MM_SHUFFLE(2,1,2,0)));
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the rows of a matrix, row 3 is the translation
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Rows
+  {
+    explicit Rows(const Mat4 &_m) noexcept
+    {
+      for(int i=0; i<4; ++i)
+      {
+        m_r[i]=_mm_loadu_ps(&_m.m_m[i][0]);
+      }
+    }
+    __m128 m_r[4];
+  };
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief Arvo's method, each output axis is the translation plus the smaller / larger of each matrix term
+  /// times the min and max extent, done for all three axes at once
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void transformSSE(const Rows &_rows, const Bounds3 &_in, Bounds3 &o_out) noexcept
+  {
+    __m128 lo,hi;
+    loadBounds(_in,lo,hi);
+    __m128 mn=_rows.m_r[3];
+    __m128 mx=_rows.m_r[3];
+    __m128 a=_mm_mul_ps(_rows.m_r[0],_mm_shuffle_ps(lo,lo,_MM_SHUFFLE(0,0,0,0)));
+    __m128 b=_mm_mul_ps(_rows.m_r[0],_mm_shuffle_ps(hi,hi,_MM_SHUFFLE(0,0,0,0)));
+    mn=_mm_add_ps(mn,_mm_min_ps(a,b));
+    mx=_mm_add_ps(mx,_mm_max_ps(a,b));
+    a=_mm_mul_ps(_rows.m_r[1],_mm_shuffle_ps(lo,lo,_MM_SHUFFLE(1,1,1,1)));
+    b=_mm_mul_ps(_rows.m_r[1],_mm_shuffle_ps(hi,hi,_MM_SHUFFLE(1,1,1,1)));
+    mn=_mm_add_ps(mn,_mm_min_ps(a,b));
+    mx=_mm_add_ps(mx,_mm_max_ps(a,b));
+    a=_mm_mul_ps(_rows.m_r[2],_mm_shuffle_ps(lo,lo,_MM_SHUFFLE(2,2,2,2)));
+    b=_mm_mul_ps(_rows.m_r[2],_mm_shuffle_ps(hi,hi,_MM_SHUFFLE(2,2,2,2)));
+    mn=_mm_add_ps(mn,_mm_min_ps(a,b));
+    mx=_mm_add_ps(mx,_mm_max_ps(a,b));
+    storeBounds(o_out,mn,mx);
+  }
+#endif
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void transformScalar(const Mat4 &_m, const Bounds3 &_in, Bounds3 &o_out) noexcept
+  {
+    const Real lo[3]={_in.m_min.m_x,_in.m_min.m_y,_in.m_min.m_z};
+    const Real hi[3]={_in.m_max.m_x,_in.m_max.m_y,_in.m_max.m_z};
+    Real mn[3];
+    Real mx[3];
+    for(int j=0; j<3; ++j)
+    {
+      mn[j]=mx[j]=_m.m_m[3][j];
+      for(int i=0; i<3; ++i)
+      {
+        Real a=_m.m_m[i][j]*lo[i];
+        Real b=_m.m_m[i][j]*hi[i];
+        mn[j]+=std::min(a,b);
+        mx[j]+=std::max(a,b);
+      }
+    }
+    o_out.m_min.set(mn[0],mn[1],mn[2]);
+    o_out.m_max.set(mx[0],mx[1],mx[2]);
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the box around the points [_begin,_end), 4 at a time as separate x, y and z registers
+  //----------------------------------------------------------------------------------------------------------------------
+  inline Bounds3 boundsOfRange(const Vec3 *_points, size_t _begin, size_t _end) noexcept
+  {
+    Bounds3 b;
+    size_t i=_begin;
+#ifdef NGL_SIMD_X86
+    if(soa::useSIMD() && _end-_begin>=4)
+    {
+      __m128 x,y,z;
+      soa::load3x4(&_points[i].m_x,x,y,z);
+      __m128 minX=x, maxX=x, minY=y, maxY=y, minZ=z, maxZ=z;
+      for(i+=4; i+4<=_end; i+=4)
+      {
+        soa::load3x4(&_points[i].m_x,x,y,z);
+        minX=_mm_min_ps(minX,x);
+        maxX=_mm_max_ps(maxX,x);
+        minY=_mm_min_ps(minY,y);
+        maxY=_mm_max_ps(maxY,y);
+        minZ=_mm_min_ps(minZ,z);
+        maxZ=_mm_max_ps(maxZ,z);
+      }
+      alignas(16) Real lanes[6][4];
+      _mm_store_ps(lanes[0],minX);
+      _mm_store_ps(lanes[1],minY);
+      _mm_store_ps(lanes[2],minZ);
+      _mm_store_ps(lanes[3],maxX);
+      _mm_store_ps(lanes[4],maxY);
+      _mm_store_ps(lanes[5],maxZ);
+      for(int l=0; l<4; ++l)
+      {
+        b.extend(Vec3(lanes[0][l],lanes[1][l],lanes[2][l]));
+        b.extend(Vec3(lanes[3][l],lanes[4][l],lanes[5][l]));
+      }
+    }
+#endif
+    for( ; i<_end; ++i)
+    {
+      b.extend(_points[i]);
+    }
+    return b;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+Bounds3 Bounds3::fromPoints(const Vec3 *_points, size_t _count) noexcept
+{
+  return parallelReduce(_count,c_pointGrain,Bounds3(),
+                        [_points](size_t _begin, size_t _end){ return boundsOfRange(_points,_begin,_end); },
+                        [](Bounds3 _a, const Bounds3 &_b){ _a.merge(_b); return _a; });
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+Bounds3 Bounds3::merge(const Bounds3 *_bounds, size_t _count) noexcept
+{
+  Bounds3 b;
+  size_t i=0;
+#ifdef NGL_SIMD_X86
+  if(soa::useSIMD() && _count>0)
+  {
+    __m128 mn,mx;
+    loadBounds(_bounds[0],mn,mx);
+    for(i=1; i<_count; ++i)
+    {
+      __m128 lo,hi;
+      loadBounds(_bounds[i],lo,hi);
+      mn=_mm_min_ps(mn,lo);
+      mx=_mm_max_ps(mx,hi);
+    }
+    storeBounds(b,mn,mx);
+  }
+#endif
+  for( ; i<_count; ++i)
+  {
+    b.merge(_bounds[i]);
+  }
+  return b;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool Bounds3::intersects(const BoundingSphere &_s) const noexcept
+{
+  return distanceSquared(_s.m_center)<=_s.m_radius*_s.m_radius;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+Real Bounds3::distanceSquared(const Vec3 &_p) const noexcept
+{
+  Real d2=0.0f;
+  for(size_t i=0; i<3; ++i)
+  {
+    Real c=_p.m_openGL[i];
+    Real d=c<m_min.m_openGL[i] ? m_min.m_openGL[i]-c : (c>m_max.m_openGL[i] ? c-m_max.m_openGL[i] : 0.0f);
+    d2+=d*d;
+  }
+  return d2;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool Bounds3::intersectRay(const Vec3 &_origin, const Vec3 &_invDir, Real _tMax, Real &o_t) const noexcept
+{
+  // a zero direction gives +-inf which the min / max order handles
+  Real tNear=0.0f;
+  Real tFar=_tMax;
+  for(size_t i=0; i<3; ++i)
+  {
+    Real t0=(m_min.m_openGL[i]-_origin.m_openGL[i])*_invDir.m_openGL[i];
+    Real t1=(m_max.m_openGL[i]-_origin.m_openGL[i])*_invDir.m_openGL[i];
+    tNear=std::max(tNear,std::min(t0,t1));
+    tFar=std::min(tFar,std::max(t0,t1));
+  }
+  o_t=tNear;
+  return tNear<=tFar;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+Bounds3 Bounds3::transformed(const Mat4 &_m) const noexcept
+{
+  Bounds3 b;
+#ifdef NGL_SIMD_X86
+  if(soa::useSIMD())
+  {
+    transformSSE(Rows(_m),*this,b);
+    return b;
+  }
+#endif
+  transformScalar(_m,*this,b);
+  return b;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Bounds3::transform(const Bounds3 *_in, size_t _count, const Mat4 &_m, Bounds3 *o_out) noexcept
+{
+#ifdef NGL_SIMD_X86
+  if(soa::useSIMD())
+  {
+    Rows rows(_m);
+    for(size_t i=0; i<_count; ++i)
+    {
+      transformSSE(rows,_in[i],o_out[i]);
+    }
+    return;
+  }
+#endif
+  for(size_t i=0; i<_count; ++i)
+  {
+    transformScalar(_m,_in[i],o_out[i]);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Bounds3::transform(const Bounds3 *_in, const Mat4 *_matrices, size_t _count, Bounds3 *o_out) noexcept
+{
+#ifdef NGL_SIMD_X86
+  if(soa::useSIMD())
+  {
+    for(size_t i=0; i<_count; ++i)
+    {
+      transformSSE(Rows(_matrices[i]),_in[i],o_out[i]);
+    }
+    return;
+  }
+#endif
+  for(size_t i=0; i<_count; ++i)
+  {
+    transformScalar(_matrices[i],_in[i],o_out[i]);
+  }
+}
+
+} // end namespace ngl
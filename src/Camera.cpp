@@ -118,7 +118,8 @@ void Camera::setPerspProjection() noexcept
   m_projectionMatrix.m_m[3][2]=(2*m_zFar*m_zNear)/(m_zNear-m_zFar);
 
   m_projectionMatrix.m_m[2][3]=-1.0f;
-  m_projectionMatrix.m_m[3][3]=1.0f;
+  // w is -z so there is no constant term, as ngl::perspective
+  m_projectionMatrix.m_m[3][3]=0.0f;
 
 }
 
@@ -149,7 +150,7 @@ void Camera::setShape(Real _viewAngle, Real _aspect, Real _near, Real _far  ) no
 	m_zNear = _near;
 	m_zFar = _far;
 	setProjectionMatrix();
-	//calculateFrustum();
+	calculateFrustum();
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -353,11 +354,15 @@ void Camera::writeRib( RibExport &_rib ) const noexcept
 	}
 }
 //----------------------------------------------------------------------------------------------------------------------
-/// Code modified from http://www.lighthouse3d.com/opengl/viewfrustum/index.php?intro
-///
 void Camera::calculateFrustum() noexcept
 {
+  m_frustum.set(getVPMatrix());
+}
 
+/// Code modified from http://www.lighthouse3d.com/opengl/viewfrustum/index.php?intro
+///
+void Camera::drawFrustum() noexcept
+{
     Real tang = tanf(radians(m_fov) * 0.5f) ;
     Real nh = m_zNear * tang;
     Real nw = nh * m_aspect;
@@ -376,16 +381,7 @@ void Camera::calculateFrustum() noexcept
     m_ftr = fc + m_v.toVec3() * fh + m_u.toVec3() * fw;
     m_fbl = fc - m_v.toVec3() * fh - m_u.toVec3() * fw;
     m_fbr = fc - m_v.toVec3() * fh + m_u.toVec3() * fw;
-    m_planes[static_cast<int>(ProjPlane::TOP)].setPoints(m_ntr,m_ntl,m_ftl);
-    m_planes[static_cast<int>(ProjPlane::BOTTOM)].setPoints(m_nbl,m_nbr,m_fbr);
-    m_planes[static_cast<int>(ProjPlane::LEFT)].setPoints(m_ntl,m_nbl,m_fbl);
-    m_planes[static_cast<int>(ProjPlane::RIGHT)].setPoints(m_nbr,m_ntr,m_fbr);
-    m_planes[static_cast<int>(ProjPlane::NEARP)].setPoints(m_ntl,m_ntr,m_nbr);
-    m_planes[static_cast<int>(ProjPlane::FARP)].setPoints(m_ftr,m_ftl,m_fbl);
-}
 
-void Camera::drawFrustum() noexcept
-{
   std::vector<Vec3>points;
 
   // draw the sides as lines
@@ -440,57 +436,45 @@ void Camera::drawFrustum() noexcept
 
 CameraIntercept Camera::isPointInFrustum( const Vec3 &_p ) const noexcept
 {
-	CameraIntercept result = CameraIntercept::INSIDE;
-	for(int i=0; i < 6; ++i)
-	{
-
-		if (m_planes[i].distance(_p) < 0)
-		{
-			return CameraIntercept::OUTSIDE;
-		}
-	}
-
-	return result;
+  return m_frustum.isPointInFrustum(_p);
 }
 
 
 CameraIntercept Camera::isSphereInFrustum(const Vec3 &_p,  Real _radius ) const noexcept
 {
+  return m_frustum.isSphereInFrustum(_p,_radius);
+}
 
-	CameraIntercept result = CameraIntercept::INSIDE;
-	Real distance;
 
-	for(int i=0; i< 6; ++i)
-	{
-		distance = m_planes[i].distance(_p);
-		if (distance < -_radius)
-		{
-			return CameraIntercept::OUTSIDE;
-		}
-		else if (distance < _radius)
-		{
-			result =  CameraIntercept::INTERSECT;
-		}
-	}
-	return result;
+CameraIntercept Camera::boxInFrustum(const AABB &b) const noexcept
+{
+  return m_frustum.boxInFrustum(b);
 }
 
+void Camera::cullBoxes(const Vec3Array &_min, const Vec3Array &_max, uint32_t *o_visible) const noexcept
+{
+  m_frustum.cullBoxes(_min,_max,o_visible);
+}
 
-CameraIntercept Camera::boxInFrustum(const AABB &b) const noexcept
+void Camera::cullBoxes(const AABB *_boxes, size_t _count, uint32_t *o_visible) const noexcept
 {
+  m_frustum.cullBoxes(_boxes,_count,o_visible);
+}
 
-	CameraIntercept result = CameraIntercept::INSIDE;
-	for(int i=0; i < 6; i++)
-	{
+void Camera::cullSpheres(const Vec3Array &_centre, const Real *_radius, uint32_t *o_visible) const noexcept
+{
+  m_frustum.cullSpheres(_centre,_radius,o_visible);
+}
 
-		if (m_planes[i].distance(b.getVertexP(m_planes[i].getNormal())) < 0)
-			return CameraIntercept::OUTSIDE;
-		else if (m_planes[i].distance(b.getVertexN(m_planes[i].getNormal())) < 0)
-			result =  CameraIntercept::INTERSECT;
-	}
-	return(result);
+void Camera::cullBoxes(const Vec3Array &_min, const Vec3Array &_max, std::vector<size_t> &o_visible) const
+{
+  m_frustum.cullBoxes(_min,_max,o_visible);
+}
 
- }
+void Camera::cullSpheres(const Vec3Array &_centre, const Real *_radius, std::vector<size_t> &o_visible) const
+{
+  m_frustum.cullSpheres(_centre,_radius,o_visible);
+}
 
 
 
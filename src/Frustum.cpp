@@ -0,0 +1,474 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Frustum.h"
+#include "NGLassert.h"
+#include "ParallelFor.h"
+#include "SIMD.h"
+#include <algorithm>
+#include <cmath>
+#ifdef NGL_SIMD_X86
+  #include <immintrin.h>
+#endif
+//----------------------------------------------------------------------------------------------------------------------
+/// @file Frustum.cpp
+/// @brief implementation files for Frustum class
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace ngl
+{
+constexpr size_t Frustum::c_numPlanes;
+
+namespace
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the minimum number of mask words (32 objects each) given to each thread
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr size_t c_grainWords=256;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the most views tested per pass over a block of bounds so their masks fit on the stack, more views
+  /// just take another pass over the same (cached) block
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr size_t c_viewsPerPass=8;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief pointers to separate component arrays of boxes and spheres
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Boxes
+  {
+    const Real *m_min[3];
+    const Real *m_max[3];
+  };
+  struct Spheres
+  {
+    const Real *m_centre[3];
+    const Real *m_radius;
+  };
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the single object tests
+  //----------------------------------------------------------------------------------------------------------------------
+  bool visible(const Frustum &_f, const Boxes &_b, size_t _i) noexcept
+  {
+    Vec3 mn(_b.m_min[0][_i],_b.m_min[1][_i],_b.m_min[2][_i]);
+    Vec3 mx(_b.m_max[0][_i],_b.m_max[1][_i],_b.m_max[2][_i]);
+    return _f.boxInFrustum(mn,mx)!=CameraIntercept::OUTSIDE;
+  }
+  bool visible(const Frustum &_f, const Spheres &_s, size_t _i) noexcept
+  {
+    Vec3 c(_s.m_centre[0][_i],_s.m_centre[1][_i],_s.m_centre[2][_i]);
+    return _f.isSphereInFrustum(c,_s.m_radius[_i])!=CameraIntercept::OUTSIDE;
+  }
+
+#ifdef NGL_SIMD_X86
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the visibility of 4 loaded boxes as the low 4 bits, the distances are summed in the same order as
+  /// Frustum::distance so the results match boxInFrustum exactly
+  //----------------------------------------------------------------------------------------------------------------------
+  inline uint32_t boxes4(const Frustum &_f, const __m128 *_mn, const __m128 *_mx) noexcept
+  {
+    const __m128 zero=_mm_setzero_ps();
+    __m128 outside=zero;
+    for(size_t p=0; p<Frustum::c_numPlanes; ++p)
+    {
+      Real n[3]={_f.getNormalX()[p],_f.getNormalY()[p],_f.getNormalZ()[p]};
+      // the corner furthest along the normal
+      __m128 d=_mm_mul_ps(_mm_set1_ps(n[0]),n[0] > 0.0f ? _mx[0] : _mn[0]);
+      d=_mm_add_ps(d,_mm_mul_ps(_mm_set1_ps(n[1]),n[1] > 0.0f ? _mx[1] : _mn[1]));
+      d=_mm_add_ps(d,_mm_mul_ps(_mm_set1_ps(n[2]),n[2] > 0.0f ? _mx[2] : _mn[2]));
+      d=_mm_add_ps(_mm_set1_ps(_f.getD()[p]),d);
+      outside=_mm_or_ps(outside,_mm_cmplt_ps(d,zero));
+    }
+    return ~static_cast<uint32_t>(_mm_movemask_ps(outside)) & 0xf;
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the visibility of 4 loaded spheres as the low 4 bits
+  //----------------------------------------------------------------------------------------------------------------------
+  inline uint32_t spheres4(const Frustum &_f, const __m128 *_c, __m128 _negRadius) noexcept
+  {
+    __m128 outside=_mm_setzero_ps();
+    for(size_t p=0; p<Frustum::c_numPlanes; ++p)
+    {
+      __m128 d=_mm_mul_ps(_mm_set1_ps(_f.getNormalX()[p]),_c[0]);
+      d=_mm_add_ps(d,_mm_mul_ps(_mm_set1_ps(_f.getNormalY()[p]),_c[1]));
+      d=_mm_add_ps(d,_mm_mul_ps(_mm_set1_ps(_f.getNormalZ()[p]),_c[2]));
+      d=_mm_add_ps(_mm_set1_ps(_f.getD()[p]),d);
+      outside=_mm_or_ps(outside,_mm_cmplt_ps(d,_negRadius));
+    }
+    return ~static_cast<uint32_t>(_mm_movemask_ps(outside)) & 0xf;
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief AVX versions testing 8 at a time
+  //----------------------------------------------------------------------------------------------------------------------
+  NGL_TARGET_AVX inline uint32_t boxes8(const Frustum &_f, const __m256 *_mn, const __m256 *_mx) noexcept
+  {
+    const __m256 zero=_mm256_setzero_ps();
+    __m256 outside=zero;
+    for(size_t p=0; p<Frustum::c_numPlanes; ++p)
+    {
+      Real n[3]={_f.getNormalX()[p],_f.getNormalY()[p],_f.getNormalZ()[p]};
+      __m256 d=_mm256_mul_ps(_mm256_set1_ps(n[0]),n[0] > 0.0f ? _mx[0] : _mn[0]);
+      d=_mm256_add_ps(d,_mm256_mul_ps(_mm256_set1_ps(n[1]),n[1] > 0.0f ? _mx[1] : _mn[1]));
+      d=_mm256_add_ps(d,_mm256_mul_ps(_mm256_set1_ps(n[2]),n[2] > 0.0f ? _mx[2] : _mn[2]));
+      d=_mm256_add_ps(_mm256_set1_ps(_f.getD()[p]),d);
+      outside=_mm256_or_ps(outside,_mm256_cmp_ps(d,zero,_CMP_LT_OQ));
+    }
+    return ~static_cast<uint32_t>(_mm256_movemask_ps(outside)) & 0xff;
+  }
+  NGL_TARGET_AVX inline uint32_t spheres8(const Frustum &_f, const __m256 *_c, __m256 _negRadius) noexcept
+  {
+    __m256 outside=_mm256_setzero_ps();
+    for(size_t p=0; p<Frustum::c_numPlanes; ++p)
+    {
+      __m256 d=_mm256_mul_ps(_mm256_set1_ps(_f.getNormalX()[p]),_c[0]);
+      d=_mm256_add_ps(d,_mm256_mul_ps(_mm256_set1_ps(_f.getNormalY()[p]),_c[1]));
+      d=_mm256_add_ps(d,_mm256_mul_ps(_mm256_set1_ps(_f.getNormalZ()[p]),_c[2]));
+      d=_mm256_add_ps(_mm256_set1_ps(_f.getD()[p]),d);
+      outside=_mm256_or_ps(outside,_mm256_cmp_ps(d,_negRadius,_CMP_LT_OQ));
+    }
+    return ~static_cast<uint32_t>(_mm256_movemask_ps(outside)) & 0xff;
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief load the objects at _i once then test them against every view, the bits for view v are or'd into
+  /// io_words[v] shifted by _shift
+  //----------------------------------------------------------------------------------------------------------------------
+  void testSSE(const Frustum *_f, size_t _views, const Boxes &_b, size_t _i, size_t _shift, uint32_t *io_words) noexcept
+  {
+    __m128 mn[3];
+    __m128 mx[3];
+    for(int c=0; c<3; ++c)
+    {
+      mn[c]=_mm_load_ps(_b.m_min[c]+_i);
+      mx[c]=_mm_load_ps(_b.m_max[c]+_i);
+    }
+    for(size_t v=0; v<_views; ++v)
+    {
+      io_words[v]|=boxes4(_f[v],mn,mx) << _shift;
+    }
+  }
+  void testSSE(const Frustum *_f, size_t _views, const Spheres &_s, size_t _i, size_t _shift, uint32_t *io_words) noexcept
+  {
+    __m128 c[3]={_mm_load_ps(_s.m_centre[0]+_i),_mm_load_ps(_s.m_centre[1]+_i),_mm_load_ps(_s.m_centre[2]+_i)};
+    __m128 negRadius=_mm_xor_ps(_mm_loadu_ps(_s.m_radius+_i),_mm_set1_ps(-0.0f));
+    for(size_t v=0; v<_views; ++v)
+    {
+      io_words[v]|=spheres4(_f[v],c,negRadius) << _shift;
+    }
+  }
+  NGL_TARGET_AVX void testAVX(const Frustum *_f, size_t _views, const Boxes &_b, size_t _i, size_t _shift, uint32_t *io_words) noexcept
+  {
+    __m256 mn[3];
+    __m256 mx[3];
+    for(int c=0; c<3; ++c)
+    {
+      mn[c]=_mm256_loadu_ps(_b.m_min[c]+_i);
+      mx[c]=_mm256_loadu_ps(_b.m_max[c]+_i);
+    }
+    for(size_t v=0; v<_views; ++v)
+    {
+      io_words[v]|=boxes8(_f[v],mn,mx) << _shift;
+    }
+  }
+  NGL_TARGET_AVX void testAVX(const Frustum *_f, size_t _views, const Spheres &_s, size_t _i, size_t _shift, uint32_t *io_words) noexcept
+  {
+    __m256 c[3]={_mm256_loadu_ps(_s.m_centre[0]+_i),_mm256_loadu_ps(_s.m_centre[1]+_i),_mm256_loadu_ps(_s.m_centre[2]+_i)};
+    __m256 negRadius=_mm256_xor_ps(_mm256_loadu_ps(_s.m_radius+_i),_mm256_set1_ps(-0.0f));
+    for(size_t v=0; v<_views; ++v)
+    {
+      io_words[v]|=spheres8(_f[v],c,negRadius) << _shift;
+    }
+  }
+#endif
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the mask words of objects [_begin,_end) (at most 32) for each view, _begin must be a multiple of 8
+  /// @param[out] o_words one word per view
+  //----------------------------------------------------------------------------------------------------------------------
+  template<typename Objects>
+  void cullWords(const Frustum *_f, size_t _views, const Objects &_o, size_t _begin, size_t _end, uint32_t *o_words) noexcept
+  {
+    std::fill(o_words,o_words+_views,0u);
+    size_t i=_begin;
+#ifdef NGL_SIMD_X86
+    if(activeSIMDLevel()==SIMDLevel::AVX)
+    {
+      for( ; i+8<=_end; i+=8)
+      {
+        testAVX(_f,_views,_o,i,i-_begin,o_words);
+      }
+    }
+    if(activeSIMDLevel()!=SIMDLevel::SCALAR)
+    {
+      for( ; i+4<=_end; i+=4)
+      {
+        testSSE(_f,_views,_o,i,i-_begin,o_words);
+      }
+    }
+#endif
+    for( ; i<_end; ++i)
+    {
+      for(size_t v=0; v<_views; ++v)
+      {
+        o_words[v]|=static_cast<uint32_t>(visible(_f[v],_o,i)) << (i-_begin);
+      }
+    }
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief fill the masks of _count objects for every view in one pass over the bounds, split over threads
+  /// by mask word so no two threads write the same word
+  //----------------------------------------------------------------------------------------------------------------------
+  template<typename Objects>
+  void cullViews(const Frustum *_f, size_t _views, const Objects &_o, size_t _count, uint32_t *const *o_visible) noexcept
+  {
+    parallelFor(Frustum::maskWords(_count),c_grainWords,[_f,_views,&_o,_count,o_visible](size_t _begin, size_t _end)
+    {
+      uint32_t words[c_viewsPerPass];
+      for(size_t w=_begin; w<_end; ++w)
+      {
+        for(size_t v=0; v<_views; v+=c_viewsPerPass)
+        {
+          size_t n=std::min(c_viewsPerPass,_views-v);
+          cullWords(_f+v,n,_o,w*32,std::min(_count,w*32+32),words);
+          for(size_t k=0; k<n; ++k)
+          {
+            o_visible[v+k][w]=words[k];
+          }
+        }
+      }
+    });
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+Frustum::Frustum() noexcept
+{
+  set(Mat4());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+Frustum::Frustum(const Mat4 &_viewProject) noexcept
+{
+  set(_viewProject);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Frustum::set(const Mat4 &_viewProject) noexcept
+{
+  // with v * M clip component j is v . column j of M so the planes are w +/- x,y,z
+  // which is column 3 +/- columns 0,1,2
+  const Real (&m)[4][4]=_viewProject.m_m;
+  static constexpr struct { ProjPlane plane; int column; Real sign; } c_planes[c_numPlanes]=
+  {
+    { ProjPlane::TOP,    1, -1.0f },
+    { ProjPlane::BOTTOM, 1,  1.0f },
+    { ProjPlane::LEFT,   0,  1.0f },
+    { ProjPlane::RIGHT,  0, -1.0f },
+    { ProjPlane::NEARP,  2,  1.0f },
+    { ProjPlane::FARP,   2, -1.0f }
+  };
+  for(const auto &p : c_planes)
+  {
+    size_t i=static_cast<size_t>(p.plane);
+    Real a=m[0][3]+p.sign*m[0][p.column];
+    Real b=m[1][3]+p.sign*m[1][p.column];
+    Real c=m[2][3]+p.sign*m[2][p.column];
+    Real d=m[3][3]+p.sign*m[3][p.column];
+    Real length=sqrtf(a*a+b*b+c*c);
+    // an infinite far plane has no normal, leave it as zero so everything is inside it
+    Real scale=length > 0.0f ? 1.0f/length : 0.0f;
+    m_nx[i]=a*scale;
+    m_ny[i]=b*scale;
+    m_nz[i]=c*scale;
+    m_d[i]=length > 0.0f ? d*scale : 0.0f;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+Plane Frustum::getPlane(ProjPlane _p) const noexcept
+{
+  size_t i=static_cast<size_t>(_p);
+  Vec3 normal(m_nx[i],m_ny[i],m_nz[i]);
+  Plane p;
+  p.setNormalPoint(normal,normal*-m_d[i]);
+  return p;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CameraIntercept Frustum::isPointInFrustum(const Vec3 &_p) const noexcept
+{
+  for(size_t i=0; i<c_numPlanes; ++i)
+  {
+    if(distance(i,_p) < 0.0f)
+    {
+      return CameraIntercept::OUTSIDE;
+    }
+  }
+  return CameraIntercept::INSIDE;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CameraIntercept Frustum::isSphereInFrustum(const Vec3 &_p, Real _radius) const noexcept
+{
+  CameraIntercept result=CameraIntercept::INSIDE;
+  for(size_t i=0; i<c_numPlanes; ++i)
+  {
+    Real d=distance(i,_p);
+    if(d < -_radius)
+    {
+      return CameraIntercept::OUTSIDE;
+    }
+    else if(d < _radius)
+    {
+      result=CameraIntercept::INTERSECT;
+    }
+  }
+  return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CameraIntercept Frustum::boxInFrustum(const Vec3 &_min, const Vec3 &_max) const noexcept
+{
+  CameraIntercept result=CameraIntercept::INSIDE;
+  for(size_t i=0; i<c_numPlanes; ++i)
+  {
+    // the corner furthest along the normal (p) and the one furthest against it (n) as AABB::getVertexP/N
+    Vec3 p(m_nx[i] > 0.0f ? _max.m_x : _min.m_x, m_ny[i] > 0.0f ? _max.m_y : _min.m_y, m_nz[i] > 0.0f ? _max.m_z : _min.m_z);
+    Vec3 n(m_nx[i] < 0.0f ? _max.m_x : _min.m_x, m_ny[i] < 0.0f ? _max.m_y : _min.m_y, m_nz[i] < 0.0f ? _max.m_z : _min.m_z);
+    if(distance(i,p) < 0.0f)
+    {
+      return CameraIntercept::OUTSIDE;
+    }
+    else if(distance(i,n) < 0.0f)
+    {
+      result=CameraIntercept::INTERSECT;
+    }
+  }
+  return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CameraIntercept Frustum::boxInFrustum(const AABB &_b) const noexcept
+{
+  return boxInFrustum(_b.getMin(),_b.getMax());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Frustum::cullBoxes(const Vec3Array &_min, const Vec3Array &_max, uint32_t *o_visible) const noexcept
+{
+  cullBoxes(this,1,_min,_max,&o_visible);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Frustum::cullBoxes(const AABB *_boxes, size_t _count, uint32_t *o_visible) const noexcept
+{
+  cullBoxes(this,1,_boxes,_count,&o_visible);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Frustum::cullSpheres(const Vec3Array &_centre, const Real *_radius, uint32_t *o_visible) const noexcept
+{
+  cullSpheres(this,1,_centre,_radius,&o_visible);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Frustum::cullBoxes(const Frustum *_views, size_t _numViews, const Vec3Array &_min, const Vec3Array &_max, uint32_t *const *o_visible) noexcept
+{
+  NGL_ASSERT(_min.size()==_max.size());
+  Boxes b={{_min.x(),_min.y(),_min.z()},{_max.x(),_max.y(),_max.z()}};
+  cullViews(_views,_numViews,b,_min.size(),o_visible);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Frustum::cullBoxes(const Frustum *_views, size_t _numViews, const AABB *_boxes, size_t _count, uint32_t *const *o_visible) noexcept
+{
+  parallelFor(maskWords(_count),c_grainWords,[_views,_numViews,_boxes,_count,o_visible](size_t _begin, size_t _end)
+  {
+    alignas(32) Real mn[3][32];
+    alignas(32) Real mx[3][32];
+    uint32_t words[c_viewsPerPass];
+    for(size_t w=_begin; w<_end; ++w)
+    {
+      // gather the block once for all the views
+      size_t n=std::min(_count-w*32,size_t(32));
+      for(size_t i=0; i<n; ++i)
+      {
+        Vec3 boxMin=_boxes[w*32+i].getMin();
+        Vec3 boxMax=_boxes[w*32+i].getMax();
+        for(int c=0; c<3; ++c)
+        {
+          mn[c][i]=boxMin.m_openGL[c];
+          mx[c][i]=boxMax.m_openGL[c];
+        }
+      }
+      Boxes b={{mn[0],mn[1],mn[2]},{mx[0],mx[1],mx[2]}};
+      for(size_t v=0; v<_numViews; v+=c_viewsPerPass)
+      {
+        size_t views=std::min(c_viewsPerPass,_numViews-v);
+        cullWords(_views+v,views,b,0,n,words);
+        for(size_t k=0; k<views; ++k)
+        {
+          o_visible[v+k][w]=words[k];
+        }
+      }
+    }
+  });
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Frustum::cullSpheres(const Frustum *_views, size_t _numViews, const Vec3Array &_centre, const Real *_radius, uint32_t *const *o_visible) noexcept
+{
+  Spheres s={{_centre.x(),_centre.y(),_centre.z()},_radius};
+  cullViews(_views,_numViews,s,_centre.size(),o_visible);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Frustum::cullBoxes(const Vec3Array &_min, const Vec3Array &_max, std::vector<size_t> &o_visible) const
+{
+  std::vector<uint32_t> mask(maskWords(_min.size()));
+  cullBoxes(_min,_max,mask.data());
+  maskToIndices(mask.data(),_min.size(),o_visible);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Frustum::cullSpheres(const Vec3Array &_centre, const Real *_radius, std::vector<size_t> &o_visible) const
+{
+  std::vector<uint32_t> mask(maskWords(_centre.size()));
+  cullSpheres(_centre,_radius,mask.data());
+  maskToIndices(mask.data(),_centre.size(),o_visible);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Frustum::maskToIndices(const uint32_t *_mask, size_t _count, std::vector<size_t> &o_indices)
+{
+  o_indices.clear();
+  for(size_t w=0; w<maskWords(_count); ++w)
+  {
+    for(uint32_t bits=_mask[w]; bits!=0; bits&=bits-1)
+    {
+      // the lowest set bit
+      uint32_t low=bits & (~bits+1);
+      size_t bit=0;
+      while((low >> bit)!=1)
+      {
+        ++bit;
+      }
+      o_indices.push_back(w*32+bit);
+    }
+  }
+}
+
+} // end namespace ngl
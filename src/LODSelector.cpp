@@ -0,0 +1,323 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "LODSelector.h"
+#include "Camera.h"
+#include "NGLassert.h"
+#include "ParallelFor.h"
+#include "SIMD.h"
+#include "Util.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#ifdef NGL_SIMD_X86
+  #include <immintrin.h>
+#endif
+//----------------------------------------------------------------------------------------------------------------------
+/// @file LODSelector.cpp
+/// @brief implementation files for LODSelector class
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace ngl
+{
+constexpr size_t LODSelector::c_maxLevels;
+
+namespace
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the minimum number of mask words (32 objects each) given to each thread
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr size_t c_grainWords=256;
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the distance from the eye to the nearest point of a sphere, kept in front of the near plane
+  //----------------------------------------------------------------------------------------------------------------------
+  inline Real viewDistance(const Vec3 &_eye, Real _near, Real _x, Real _y, Real _z, Real _radius) noexcept
+  {
+    Real dx=_x-_eye.m_x;
+    Real dy=_y-_eye.m_y;
+    Real dz=_z-_eye.m_z;
+    return std::max(std::sqrt(dx*dx+dy*dy+dz*dz)-_radius,_near);
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the coarsest level under each limit with the previous level clamped between them
+  /// @param[in] _error the error of level l of this object
+  //----------------------------------------------------------------------------------------------------------------------
+  template<typename Error>
+  inline size_t chooseLevel(Error _error, size_t _levels, Real _coarser, Real _stay, size_t _previous) noexcept
+  {
+    size_t coarsest=0;
+    size_t furthest=0;
+    for(size_t l=1; l<_levels; ++l)
+    {
+      Real e=_error(l);
+      coarsest+= e<=_coarser;
+      furthest+= e<=_stay;
+    }
+    return std::min(std::max(_previous,coarsest),furthest);
+  }
+
+#ifdef NGL_SIMD_X86
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the visibility of 4 loaded spheres as the low 4 bits, summed as Frustum::distance so the results
+  /// match isSphereInFrustum exactly
+  //----------------------------------------------------------------------------------------------------------------------
+  inline uint32_t spheres4(const Frustum &_f, const __m128 *_c, __m128 _negRadius) noexcept
+  {
+    __m128 outside=_mm_setzero_ps();
+    for(size_t p=0; p<Frustum::c_numPlanes; ++p)
+    {
+      __m128 d=_mm_mul_ps(_mm_set1_ps(_f.getNormalX()[p]),_c[0]);
+      d=_mm_add_ps(d,_mm_mul_ps(_mm_set1_ps(_f.getNormalY()[p]),_c[1]));
+      d=_mm_add_ps(d,_mm_mul_ps(_mm_set1_ps(_f.getNormalZ()[p]),_c[2]));
+      d=_mm_add_ps(_mm_set1_ps(_f.getD()[p]),d);
+      outside=_mm_or_ps(outside,_mm_cmplt_ps(d,_negRadius));
+    }
+    return ~static_cast<uint32_t>(_mm_movemask_ps(outside)) & 0xf;
+  }
+  NGL_TARGET_AVX inline uint32_t spheres8(const Frustum &_f, const __m256 *_c, __m256 _negRadius) noexcept
+  {
+    __m256 outside=_mm256_setzero_ps();
+    for(size_t p=0; p<Frustum::c_numPlanes; ++p)
+    {
+      __m256 d=_mm256_mul_ps(_mm256_set1_ps(_f.getNormalX()[p]),_c[0]);
+      d=_mm256_add_ps(d,_mm256_mul_ps(_mm256_set1_ps(_f.getNormalY()[p]),_c[1]));
+      d=_mm256_add_ps(d,_mm256_mul_ps(_mm256_set1_ps(_f.getNormalZ()[p]),_c[2]));
+      d=_mm256_add_ps(_mm256_set1_ps(_f.getD()[p]),d);
+      outside=_mm256_or_ps(outside,_mm256_cmp_ps(d,_negRadius,_CMP_LT_OQ));
+    }
+    return ~static_cast<uint32_t>(_mm256_movemask_ps(outside)) & 0xff;
+  }
+#endif
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief everything the batch needs, set up once per call
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Batch
+  {
+    const Frustum *m_frustum;
+    Vec3 m_eye;
+    Real m_near;
+    Real m_coarserScale;
+    Real m_stayScale;
+    const Real *m_centre[3];
+    const Real *m_radius;
+    const Real *const *m_levelError;
+    size_t m_levels;
+    uint8_t *m_level;
+  };
+
+#ifdef NGL_SIMD_X86
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the visibility bits and new levels of the 4 objects at _i
+  //----------------------------------------------------------------------------------------------------------------------
+  uint32_t testSSE(const Batch &_b, size_t _i) noexcept
+  {
+    __m128 c[3]={_mm_loadu_ps(_b.m_centre[0]+_i),_mm_loadu_ps(_b.m_centre[1]+_i),_mm_loadu_ps(_b.m_centre[2]+_i)};
+    __m128 radius=_mm_loadu_ps(_b.m_radius+_i);
+    uint32_t bits=spheres4(*_b.m_frustum,c,_mm_xor_ps(radius,_mm_set1_ps(-0.0f)));
+    // the same sums as viewDistance
+    __m128 dx=_mm_sub_ps(c[0],_mm_set1_ps(_b.m_eye.m_x));
+    __m128 dy=_mm_sub_ps(c[1],_mm_set1_ps(_b.m_eye.m_y));
+    __m128 dz=_mm_sub_ps(c[2],_mm_set1_ps(_b.m_eye.m_z));
+    __m128 lengthSq=_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx,dx),_mm_mul_ps(dy,dy)),_mm_mul_ps(dz,dz));
+    __m128 d=_mm_max_ps(_mm_sub_ps(_mm_sqrt_ps(lengthSq),radius),_mm_set1_ps(_b.m_near));
+    __m128 coarser=_mm_mul_ps(d,_mm_set1_ps(_b.m_coarserScale));
+    __m128 stay=_mm_mul_ps(d,_mm_set1_ps(_b.m_stayScale));
+    // the level counts are kept as floats, they are small whole numbers so exact
+    const __m128 one=_mm_set1_ps(1.0f);
+    __m128 coarsest=_mm_setzero_ps();
+    __m128 furthest=_mm_setzero_ps();
+    for(size_t l=1; l<_b.m_levels; ++l)
+    {
+      __m128 e=_mm_loadu_ps(_b.m_levelError[l]+_i);
+      coarsest=_mm_add_ps(coarsest,_mm_and_ps(_mm_cmple_ps(e,coarser),one));
+      furthest=_mm_add_ps(furthest,_mm_and_ps(_mm_cmple_ps(e,stay),one));
+    }
+    const __m128i zero=_mm_setzero_si128();
+    int32_t packed;
+    std::memcpy(&packed,_b.m_level+_i,sizeof(packed));
+    __m128i previous=_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed),zero),zero);
+    __m128 level=_mm_min_ps(_mm_max_ps(_mm_cvtepi32_ps(previous),coarsest),furthest);
+    __m128i out=_mm_cvttps_epi32(level);
+    out=_mm_packs_epi32(out,out);
+    packed=_mm_cvtsi128_si32(_mm_packus_epi16(out,out));
+    std::memcpy(_b.m_level+_i,&packed,sizeof(packed));
+    return bits;
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the AVX version for the 8 objects at _i
+  //----------------------------------------------------------------------------------------------------------------------
+  NGL_TARGET_AVX uint32_t testAVX(const Batch &_b, size_t _i) noexcept
+  {
+    __m256 c[3]={_mm256_loadu_ps(_b.m_centre[0]+_i),_mm256_loadu_ps(_b.m_centre[1]+_i),_mm256_loadu_ps(_b.m_centre[2]+_i)};
+    __m256 radius=_mm256_loadu_ps(_b.m_radius+_i);
+    uint32_t bits=spheres8(*_b.m_frustum,c,_mm256_xor_ps(radius,_mm256_set1_ps(-0.0f)));
+    __m256 dx=_mm256_sub_ps(c[0],_mm256_set1_ps(_b.m_eye.m_x));
+    __m256 dy=_mm256_sub_ps(c[1],_mm256_set1_ps(_b.m_eye.m_y));
+    __m256 dz=_mm256_sub_ps(c[2],_mm256_set1_ps(_b.m_eye.m_z));
+    __m256 lengthSq=_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx,dx),_mm256_mul_ps(dy,dy)),_mm256_mul_ps(dz,dz));
+    __m256 d=_mm256_max_ps(_mm256_sub_ps(_mm256_sqrt_ps(lengthSq),radius),_mm256_set1_ps(_b.m_near));
+    __m256 coarser=_mm256_mul_ps(d,_mm256_set1_ps(_b.m_coarserScale));
+    __m256 stay=_mm256_mul_ps(d,_mm256_set1_ps(_b.m_stayScale));
+    const __m256 one=_mm256_set1_ps(1.0f);
+    __m256 coarsest=_mm256_setzero_ps();
+    __m256 furthest=_mm256_setzero_ps();
+    for(size_t l=1; l<_b.m_levels; ++l)
+    {
+      __m256 e=_mm256_loadu_ps(_b.m_levelError[l]+_i);
+      coarsest=_mm256_add_ps(coarsest,_mm256_and_ps(_mm256_cmp_ps(e,coarser,_CMP_LE_OQ),one));
+      furthest=_mm256_add_ps(furthest,_mm256_and_ps(_mm256_cmp_ps(e,stay,_CMP_LE_OQ),one));
+    }
+    // AVX has no 256 bit integer unpacks so the bytes are widened in two halves
+    const __m128i zero=_mm_setzero_si128();
+    __m128i bytes=_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(_b.m_level+_i)),zero);
+    __m256 previous=_mm256_insertf128_ps(_mm256_castps128_ps256(_mm_cvtepi32_ps(_mm_unpacklo_epi16(bytes,zero))),
+                                         _mm_cvtepi32_ps(_mm_unpackhi_epi16(bytes,zero)),1);
+    __m256i level=_mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(previous,coarsest),furthest));
+    __m128i out=_mm_packs_epi32(_mm256_castsi256_si128(level),_mm256_extractf128_si256(level,1));
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(_b.m_level+_i),_mm_packus_epi16(out,out));
+    return bits;
+  }
+#endif
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the single object version
+  //----------------------------------------------------------------------------------------------------------------------
+  uint32_t testScalar(const Batch &_b, size_t _i) noexcept
+  {
+    Vec3 c(_b.m_centre[0][_i],_b.m_centre[1][_i],_b.m_centre[2][_i]);
+    Real radius=_b.m_radius[_i];
+    bool visible=_b.m_frustum->isSphereInFrustum(c,radius)!=CameraIntercept::OUTSIDE;
+    Real d=viewDistance(_b.m_eye,_b.m_near,c.m_x,c.m_y,c.m_z,radius);
+    size_t level=chooseLevel([&_b,_i](size_t _l){ return _b.m_levelError[_l][_i]; },_b.m_levels,
+                             d*_b.m_coarserScale,d*_b.m_stayScale,_b.m_level[_i]);
+    _b.m_level[_i]=static_cast<uint8_t>(level);
+    return static_cast<uint32_t>(visible);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+LODSelector::LODSelector() noexcept
+{
+  setView(Frustum(),Vec3(0.0f,0.0f,0.0f),90.0f,0.1f,720.0f);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+LODSelector::LODSelector(const Camera &_camera, Real _viewportHeight, Real _pixelError, Real _hysteresis) noexcept :
+  m_pixelError(_pixelError),
+  m_hysteresis(_hysteresis)
+{
+  setCamera(_camera,_viewportHeight);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void LODSelector::setCamera(const Camera &_camera, Real _viewportHeight) noexcept
+{
+  setView(_camera.getFrustum(),_camera.getEye().toVec3(),_camera.getFOV(),_camera.getNear(),_viewportHeight);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void LODSelector::setView(const Frustum &_frustum, const Vec3 &_eye, Real _fov, Real _near, Real _viewportHeight) noexcept
+{
+  NGL_ASSERT(_viewportHeight>0.0f && _near>0.0f);
+  m_frustum=_frustum;
+  m_eye=_eye;
+  m_near=_near;
+  m_pixelSize=2.0f*std::tan(radians(_fov)*0.5f)/_viewportHeight;
+  updateScale();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void LODSelector::setPixelError(Real _pixels) noexcept
+{
+  m_pixelError=_pixels;
+  updateScale();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void LODSelector::setHysteresis(Real _hysteresis) noexcept
+{
+  NGL_ASSERT(_hysteresis>=0.0f);
+  m_hysteresis=_hysteresis;
+  updateScale();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void LODSelector::updateScale() noexcept
+{
+  Real limit=m_pixelError*m_pixelSize;
+  m_coarserScale=limit/(1.0f+m_hysteresis);
+  m_stayScale=limit*(1.0f+m_hysteresis);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+Real LODSelector::projectedError(const Vec3 &_centre, Real _radius, Real _error) const noexcept
+{
+  return _error/(viewDistance(m_eye,m_near,_centre.m_x,_centre.m_y,_centre.m_z,_radius)*m_pixelSize);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+size_t LODSelector::selectLOD(const Vec3 &_centre, Real _radius, const Real *_errors, size_t _levels, size_t _previous) const noexcept
+{
+  NGL_ASSERT(_levels>0 && _levels<=c_maxLevels);
+  Real d=viewDistance(m_eye,m_near,_centre.m_x,_centre.m_y,_centre.m_z,_radius);
+  return chooseLevel([_errors](size_t _l){ return _errors[_l]; },_levels,d*m_coarserScale,d*m_stayScale,_previous);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void LODSelector::cullSpheres(const Vec3Array &_centre, const Real *_radius, const Real *const *_levelError, size_t _levels,
+                              uint32_t *o_visible, uint8_t *io_level) const noexcept
+{
+  NGL_ASSERT(_levels>0 && _levels<=c_maxLevels);
+  size_t count=_centre.size();
+  Batch b={&m_frustum,m_eye,m_near,m_coarserScale,m_stayScale,{_centre.x(),_centre.y(),_centre.z()},_radius,
+           _levelError,_levels,io_level};
+  parallelFor(Frustum::maskWords(count),c_grainWords,[&b,count,o_visible](size_t _begin, size_t _end)
+  {
+    for(size_t w=_begin; w<_end; ++w)
+    {
+      size_t first=w*32;
+      size_t last=std::min(count,first+32);
+      uint32_t word=0;
+      size_t i=first;
+#ifdef NGL_SIMD_X86
+      if(activeSIMDLevel()==SIMDLevel::AVX)
+      {
+        for( ; i+8<=last; i+=8)
+        {
+          word|=testAVX(b,i) << (i-first);
+        }
+      }
+      if(activeSIMDLevel()!=SIMDLevel::SCALAR)
+      {
+        for( ; i+4<=last; i+=4)
+        {
+          word|=testSSE(b,i) << (i-first);
+        }
+      }
+#endif
+      for( ; i<last; ++i)
+      {
+        word|=testScalar(b,i) << (i-first);
+      }
+      o_visible[w]=word;
+    }
+  });
+}
+
+} // end namespace ngl
@@ -21,8 +21,15 @@
 #include "Quaternion.h"
 #include "Util.h"
 #include "Vec2.h"
+#include "ExportInline.h"
+#include "SIMD.h"
+#include "ParallelFor.h"
 #include <iostream>
 #include <cstring> // for memset
+#include <new>
+#ifdef NGL_SIMD_X86
+  #include <immintrin.h>
+#endif
 //----------------------------------------------------------------------------------------------------------------------
 /// @file Mat3x3.cpp
 /// @brief implementation files for Mat3x3 class
@@ -32,14 +39,6 @@
 namespace ngl
 {
 
-//----------------------------------------------------------------------------------------------------------------------
-Mat3::Mat3() noexcept
-{
-	memset(&m_m,0,sizeof(m_m));
-	m_00=1.0f;
-	m_11=1.0f;
-	m_22=1.0f;
-}
 
 Mat3::Mat3( const Mat4 &_m ) noexcept
 {
@@ -54,205 +53,6 @@ Mat3::Mat3( const Mat4 &_m ) noexcept
   m_22=_m.m_22;
 }
 
-Mat3::Mat3(Real _00, Real _01, Real _02, Real _10,  Real _11, Real _12,Real _20, Real _21, Real _22) noexcept
-{
-	m_00=_00;
-	m_01=_01;
-	m_02=_02;
-
-	m_10=_10;
-	m_11=_11;
-	m_12=_12;
-	m_20=_20;
-	m_21=_21;
-	m_22=_22;
-
-}
-//----------------------------------------------------------------------------------------------------------------------
-Mat3::Mat3(const Mat3& _m) noexcept
-{
-	memcpy(m_m,&_m.m_m,sizeof(m_m));
-}
-
-
-
-//----------------------------------------------------------------------------------------------------------------------
-Mat3::Mat3(const Real _m  ) noexcept
-{
-  memset(m_m,0,sizeof(m_m));
-  m_00=_m;
-  m_11=_m;
-  m_22=_m;
-}
-
-
-
-
-
-//----------------------------------------------------------------------------------------------------------------------
-/// @todo replace this with function operator overload ()
-void Mat3::setAtXY( GLint _x,GLint _y, Real _equals ) noexcept
-{
-	m_m[_x][_y]=_equals;
-}
-//----------------------------------------------------------------------------------------------------------------------
-const Mat3& Mat3::null() noexcept
-{
-	memset(&m_m,0,sizeof(m_m));
-	return *this;
-}
-//----------------------------------------------------------------------------------------------------------------------
-const Mat3&  Mat3::identity() noexcept
-{
-	memset(m_m,0,sizeof(m_m));
-	m_00=1.0f;
-	m_11=1.0f;
-	m_22=1.0f;
-	return *this;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-Mat3 Mat3::operator*(const Mat3& _m   )const noexcept
-{
-  Mat3 temp;
-
-  temp.m_m[0][0] = m_m[0][0] * _m.m_m[0][0] + m_m[0][1] * _m.m_m[1][0] + m_m[0][2] * _m.m_m[2][0] ;
-  temp.m_m[0][1] = m_m[0][0] * _m.m_m[0][1] + m_m[0][1] * _m.m_m[1][1] + m_m[0][2] * _m.m_m[2][1] ;
-  temp.m_m[0][2] = m_m[0][0] * _m.m_m[0][2] + m_m[0][1] * _m.m_m[1][2] + m_m[0][2] * _m.m_m[2][2] ;
-  temp.m_m[1][0] = m_m[1][0] * _m.m_m[0][0] + m_m[1][1] * _m.m_m[1][0] + m_m[1][2] * _m.m_m[2][0] ;
-  temp.m_m[1][1] = m_m[1][0] * _m.m_m[0][1] + m_m[1][1] * _m.m_m[1][1] + m_m[1][2] * _m.m_m[2][1] ;
-  temp.m_m[1][2] = m_m[1][0] * _m.m_m[0][2] + m_m[1][1] * _m.m_m[1][2] + m_m[1][2] * _m.m_m[2][2] ;
-  temp.m_m[2][0] = m_m[2][0] * _m.m_m[0][0] + m_m[2][1] * _m.m_m[1][0] + m_m[2][2] * _m.m_m[2][0] ;
-  temp.m_m[2][1] = m_m[2][0] * _m.m_m[0][1] + m_m[2][1] * _m.m_m[1][1] + m_m[2][2] * _m.m_m[2][1] ;
-  temp.m_m[2][2] = m_m[2][0] * _m.m_m[0][2] + m_m[2][1] * _m.m_m[1][2] + m_m[2][2] * _m.m_m[2][2] ;
-  return temp;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-const Mat3& Mat3::operator*= ( const Mat3 &_m ) noexcept
-{
-	Mat3 temp(*this);
-
-	//  row 0
-	m_00  =  temp.m_00 * _m.m_00;
-	m_01  =  temp.m_01 * _m.m_00;
-	m_02  =  temp.m_02 * _m.m_00;
-
-	m_00 +=  temp.m_10 * _m.m_01;
-	m_01 +=  temp.m_11 * _m.m_01;
-	m_02 +=  temp.m_12 * _m.m_01;
-
-	m_00 +=  temp.m_20 * _m.m_02;
-	m_01 +=  temp.m_21 * _m.m_02;
-	m_02 +=  temp.m_22 * _m.m_02;
-
-
-	//  row 1
-	m_10  =  temp.m_00 * _m.m_10;
-	m_11  =  temp.m_01 * _m.m_10;
-	m_12  =  temp.m_02 * _m.m_10;
-
-	m_10 +=  temp.m_10 * _m.m_11;
-	m_11 +=  temp.m_11 * _m.m_11;
-	m_12 +=  temp.m_12 * _m.m_11;
-
-	m_10 +=  temp.m_20 * _m.m_12;
-	m_11 +=  temp.m_21 * _m.m_12;
-	m_12 +=  temp.m_22 * _m.m_12;
-
-
-
-	//  row 2
-	m_20  =  temp.m_00 * _m.m_20;
-	m_21  =  temp.m_01 * _m.m_20;
-	m_22  =  temp.m_02 * _m.m_20;
-
-	m_20 +=  temp.m_10 * _m.m_21;
-	m_21 +=  temp.m_11 * _m.m_21;
-	m_22 +=  temp.m_12 * _m.m_21;
-
-	m_20 +=  temp.m_20 * _m.m_22;
-	m_21 +=  temp.m_21 * _m.m_22;
-	m_22 +=  temp.m_22 * _m.m_22;
-
-	return *this;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-Mat3 Mat3::operator+(const Mat3 &_m ) const noexcept
-{
-  Mat3 ret;
-  const Real* iterA = &m_openGL[0];
-  const Real* iterB = &_m.m_openGL[0];
-  Real* iterR = &ret.m_openGL[0];
-  const Real* end   = &m_openGL[9];
-
-	for( ; iterA != end; ++iterA, ++iterB, ++iterR)
-	{
-		*iterR = *iterA + *iterB;
-	}
-  return ret;
-}
-//----------------------------------------------------------------------------------------------------------------------
-const Mat3& Mat3::operator+=( const Mat3 &_m  ) noexcept
-{
-  Real* iterA =&m_openGL[0];
-  const Real* iterB = &_m.m_openGL[0];
-  const Real* end   = &m_openGL[9];
-
-	for( ; iterA != end; ++iterA, ++iterB)
-	{
-		*iterA += *iterB;
-	}
-	return *this;
-}
-//----------------------------------------------------------------------------------------------------------------------
-Mat3 Mat3::operator*( Real _i  ) const noexcept
-{
-  Mat3 ret;
-  const Real* iterA = &m_openGL[0];
-  Real* iterB = &ret.m_openGL[0];
-  const Real* end   = &m_openGL[9];
-
-	for( ; iterA != end; ++iterA, ++iterB)
-	{
-		*iterB = (*iterA) * _i;
-	}
-	return ret;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-const Mat3& Mat3::operator*=(Real _i) noexcept
-{
-  for(int y=0; y<3; ++y)
-	{
-    for(int x=0; x<3; ++x)
-		{
-			m_m[y][x]*=_i;
-		}
-	}
-	return *this;
-}
-
-
-
-
-//----------------------------------------------------------------------------------------------------------------------
-const Mat3& Mat3::transpose() noexcept
-{
-	Mat3 tmp(*this);
-
-  for(int row=0; row<3; ++row)
-	{
-    for(int col=0; col<3; ++col)
-		{
-			m_m[row][col]=tmp.m_m[col][row];
-		}
-	}
-	return *this;
-}
-
-
 
 //----------------------------------------------------------------------------------------------------------------------
 void Mat3::rotateX( Real _deg) noexcept
@@ -291,31 +91,6 @@ void Mat3::rotateZ( Real _deg) noexcept
 }
 
 
-
-//----------------------------------------------------------------------------------------------------------------------
-void Mat3::scale(Real _x,  Real _y,  Real _z) noexcept
-{
-	m_00 = _x;
-	m_11 = _y;
-	m_22 = _z;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-Vec3 Mat3::operator * (const Vec3 &_v) const noexcept
-{
-  Vec3 temp;
-
-  temp.m_x=_v.m_x * m_00 + _v.m_y* m_01 + _v.m_z * m_02;
-  temp.m_y=_v.m_x * m_10 + _v.m_y* m_11 + _v.m_z * m_12;
-  temp.m_z=_v.m_x * m_20 + _v.m_y* m_21 + _v.m_z * m_22;
-
-  return temp;
-}
-
-
-
-
-
 //----------------------------------------------------------------------------------------------------------------------
 void Mat3::euler( Real _angle,Real _x,  Real _y, Real _z) noexcept
 {
@@ -335,14 +110,6 @@ void Mat3::euler( Real _angle,Real _x,  Real _y, Real _z) noexcept
 }
 
 
-Real Mat3::determinant() const noexcept
-{
-    return +m_00*(m_11*m_22-m_21*m_12)
-            -m_01*(m_10*m_22-m_12*m_20)
-            +m_02*(m_10*m_21-m_11*m_20);
-}
-
-
 Mat3 Mat3::inverse() noexcept
 {
   Real det = determinant();
@@ -409,8 +176,240 @@ Vec3 Mat3::getBackVector() const noexcept
 //----------------------------------------------------------------------------------------------------------------------
 
 
+//----------------------------------------------------------------------------------------------------------------------
+// array versions of multiply, inverse and determinant. The simd path transposes 4 matrices so each register
+// holds one element of all 4, the sums are then written exactly as the scalar methods so the results match.
+//----------------------------------------------------------------------------------------------------------------------
+namespace
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief below this many matrices per thread it is not worth starting another one
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr size_t c_grainSize=16384;
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the cofactor inverse used by Mat3::inverse without the error message
+  //----------------------------------------------------------------------------------------------------------------------
+  Mat3 inverseNoCheck(const Mat3 &_m) noexcept
+  {
+    Real det=_m.determinant();
+    if(det==0.0f)
+    {
+      return Mat3();
+    }
+    Mat3 tmp(_m);
+    return tmp.inverse();
+  }
 
-} // end namespace ngl
+#ifdef NGL_SIMD_X86
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief load 4 matrices so o_e[i] holds element i of each
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void load4(const Mat3 *_m, __m128 o_e[9]) noexcept
+  {
+    const Real *m0=&_m[0].m_openGL[0];
+    const Real *m1=&_m[1].m_openGL[0];
+    const Real *m2=&_m[2].m_openGL[0];
+    const Real *m3=&_m[3].m_openGL[0];
+    o_e[0]=_mm_loadu_ps(m0);
+    o_e[1]=_mm_loadu_ps(m1);
+    o_e[2]=_mm_loadu_ps(m2);
+    o_e[3]=_mm_loadu_ps(m3);
+    _MM_TRANSPOSE4_PS(o_e[0],o_e[1],o_e[2],o_e[3]);
+    o_e[4]=_mm_loadu_ps(m0+4);
+    o_e[5]=_mm_loadu_ps(m1+4);
+    o_e[6]=_mm_loadu_ps(m2+4);
+    o_e[7]=_mm_loadu_ps(m3+4);
+    _MM_TRANSPOSE4_PS(o_e[4],o_e[5],o_e[6],o_e[7]);
+    o_e[8]=_mm_setr_ps(m0[8],m1[8],m2[8],m3[8]);
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the reverse of load4
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void store4(const __m128 _e[9], Mat3 *o_m) noexcept
+  {
+    __m128 a0=_e[0], a1=_e[1], a2=_e[2], a3=_e[3];
+    __m128 b0=_e[4], b1=_e[5], b2=_e[6], b3=_e[7];
+    _MM_TRANSPOSE4_PS(a0,a1,a2,a3);
+    _MM_TRANSPOSE4_PS(b0,b1,b2,b3);
+    alignas(16) Real last[4];
+    _mm_store_ps(last,_e[8]);
+    __m128 a[4]={a0,a1,a2,a3};
+    __m128 b[4]={b0,b1,b2,b3};
+    for(size_t j=0; j<4; ++j)
+    {
+      Real *m=&o_m[j].m_openGL[0];
+      _mm_storeu_ps(m,a[j]);
+      _mm_storeu_ps(m+4,b[j]);
+      m[8]=last[j];
+    }
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief element [_y][_x] of the transposed registers
+  //----------------------------------------------------------------------------------------------------------------------
+  inline __m128 at(const __m128 _e[9], int _y, int _x) noexcept { return _e[_y*3+_x]; }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief _a*_b-_c*_d the 2x2 determinant used by the cofactors
+  //----------------------------------------------------------------------------------------------------------------------
+  inline __m128 det2(__m128 _a, __m128 _b, __m128 _c, __m128 _d) noexcept
+  {
+    return _mm_sub_ps(_mm_mul_ps(_a,_b),_mm_mul_ps(_c,_d));
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief Mat3::determinant for 4 matrices
+  //----------------------------------------------------------------------------------------------------------------------
+  inline __m128 determinant4(const __m128 _e[9]) noexcept
+  {
+    __m128 d=_mm_mul_ps(at(_e,0,0),det2(at(_e,1,1),at(_e,2,2),at(_e,2,1),at(_e,1,2)));
+    d=_mm_sub_ps(d,_mm_mul_ps(at(_e,0,1),det2(at(_e,1,0),at(_e,2,2),at(_e,1,2),at(_e,2,0))));
+    return _mm_add_ps(d,_mm_mul_ps(at(_e,0,2),det2(at(_e,1,0),at(_e,2,1),at(_e,1,1),at(_e,2,0))));
+  }
+#endif
+
+  //----------------------------------------------------------------------------------------------------------------------
+  void multiplyRange(const Mat3 *_a, const Mat3 *_b, Mat3 *o_out, size_t _begin, size_t _end) noexcept
+  {
+    size_t i=_begin;
+#ifdef NGL_SIMD_X86
+    if(activeSIMDLevel()!=SIMDLevel::SCALAR)
+    {
+      for( ; i+4<=_end; i+=4)
+      {
+        __m128 a[9],b[9],r[9];
+        load4(_a+i,a);
+        load4(_b+i,b);
+        for(int y=0; y<3; ++y)
+        {
+          for(int x=0; x<3; ++x)
+          {
+            __m128 v=_mm_mul_ps(at(a,y,0),at(b,0,x));
+            v=_mm_add_ps(v,_mm_mul_ps(at(a,y,1),at(b,1,x)));
+            r[y*3+x]=_mm_add_ps(v,_mm_mul_ps(at(a,y,2),at(b,2,x)));
+          }
+        }
+        store4(r,o_out+i);
+      }
+    }
+#endif
+    for( ; i<_end; ++i)
+    {
+      o_out[i]=_a[i]*_b[i];
+    }
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  void inverseRange(const Mat3 *_m, Mat3 *o_out, size_t _begin, size_t _end) noexcept
+  {
+    size_t i=_begin;
+#ifdef NGL_SIMD_X86
+    if(activeSIMDLevel()!=SIMDLevel::SCALAR)
+    {
+      const __m128 zero=_mm_setzero_ps();
+      const __m128 one=_mm_set1_ps(1.0f);
+      for( ; i+4<=_end; i+=4)
+      {
+        __m128 m[9],r[9];
+        load4(_m+i,m);
+        __m128 det=determinant4(m);
+        __m128 singular=_mm_cmpeq_ps(det,zero);
+        __m128 invDet=_mm_div_ps(one,det);
+        __m128 neg=_mm_sub_ps(zero,invDet);
+        // the same cofactors as Mat3::inverse
+        r[0]=_mm_mul_ps(det2(at(m,1,1),at(m,2,2),at(m,2,1),at(m,1,2)),invDet);
+        r[1]=_mm_mul_ps(det2(at(m,1,0),at(m,2,2),at(m,1,2),at(m,2,0)),neg);
+        r[2]=_mm_mul_ps(det2(at(m,1,0),at(m,2,1),at(m,2,0),at(m,1,1)),invDet);
+        r[3]=_mm_mul_ps(det2(at(m,0,1),at(m,2,2),at(m,0,2),at(m,2,1)),neg);
+        r[4]=_mm_mul_ps(det2(at(m,0,0),at(m,2,2),at(m,0,2),at(m,2,0)),invDet);
+        r[5]=_mm_mul_ps(det2(at(m,0,0),at(m,2,1),at(m,2,0),at(m,0,1)),neg);
+        r[6]=_mm_mul_ps(det2(at(m,0,1),at(m,1,2),at(m,0,2),at(m,1,1)),invDet);
+        r[7]=_mm_mul_ps(det2(at(m,0,0),at(m,1,2),at(m,1,0),at(m,0,2)),neg);
+        r[8]=_mm_mul_ps(det2(at(m,0,0),at(m,1,1),at(m,1,0),at(m,0,1)),invDet);
+        for(int e=0; e<9; ++e)
+        {
+          __m128 identity= (e%4==0) ? one : zero;
+          r[e]=_mm_or_ps(_mm_and_ps(singular,identity),_mm_andnot_ps(singular,r[e]));
+        }
+        store4(r,o_out+i);
+      }
+    }
+#endif
+    for( ; i<_end; ++i)
+    {
+      o_out[i]=inverseNoCheck(_m[i]);
+    }
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  void determinantRange(const Mat3 *_m, Real *o_out, size_t _begin, size_t _end) noexcept
+  {
+    size_t i=_begin;
+#ifdef NGL_SIMD_X86
+    if(activeSIMDLevel()!=SIMDLevel::SCALAR)
+    {
+      for( ; i+4<=_end; i+=4)
+      {
+        __m128 m[9];
+        load4(_m+i,m);
+        _mm_storeu_ps(o_out+i,determinant4(m));
+      }
+    }
+#endif
+    for( ; i<_end; ++i)
+    {
+      o_out[i]=_m[i].determinant();
+    }
+  }
+} // end anon namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+void multiplyMatrices(const Mat3 *_a, const Mat3 *_b, size_t _count, Mat3 *o_out) noexcept
+{
+  parallelFor(_count,c_grainSize,[_a,_b,o_out](size_t _begin, size_t _end)
+  {
+    multiplyRange(_a,_b,o_out,_begin,_end);
+  });
+}
 
+//----------------------------------------------------------------------------------------------------------------------
+void inverseMatrices(const Mat3 *_m, size_t _count, Mat3 *o_out) noexcept
+{
+  parallelFor(_count,c_grainSize,[_m,o_out](size_t _begin, size_t _end)
+  {
+    inverseRange(_m,o_out,_begin,_end);
+  });
+}
 
+//----------------------------------------------------------------------------------------------------------------------
+void determinants(const Mat3 *_m, size_t _count, Real *o_out) noexcept
+{
+  parallelFor(_count,c_grainSize,[_m,o_out](size_t _begin, size_t _end)
+  {
+    determinantRange(_m,o_out,_begin,_end);
+  });
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief keeps an exported copy of the methods that are inline in Mat3.h, see ExportInline.h
+//----------------------------------------------------------------------------------------------------------------------
+namespace detail
+{
+NGL_EXPORT_INLINE void exportMat3Inline(Mat3 *o_m, Real _v) noexcept
+{
+  new (o_m) Mat3;
+  new (o_m) Mat3(_v);
+  new (o_m) Mat3(*o_m);
+  new (o_m) Mat3(_v,_v,_v,_v,_v,_v,_v,_v,_v);
+  exportInline(
+    static_cast<Mat3 (Mat3::*)(const Mat3 &) const>(&Mat3::operator*),
+    static_cast<Mat3 (Mat3::*)(Real) const>(&Mat3::operator*),
+    static_cast<Vec3 (Mat3::*)(const Vec3 &) const>(&Mat3::operator*),
+    static_cast<const Mat3 &(Mat3::*)(const Mat3 &)>(&Mat3::operator*=),
+    static_cast<const Mat3 &(Mat3::*)(Real)>(&Mat3::operator*=),
+    &Mat3::setAtXY, &Mat3::null, &Mat3::identity, &Mat3::operator+, &Mat3::operator+=,
+    &Mat3::transpose, &Mat3::scale, &Mat3::determinant
+  );
+}
+} // end namespace detail
+
+} // end namespace ngl
 
@@ -16,12 +16,19 @@
  */
 #include "NGLassert.h"
 #include "Mat4.h"
+#include "Mat3.h"
 #include "Quaternion.h"
 #include "Util.h"
 #include "Vec3.h"
+#include "SIMD.h"
+#include "ExportInline.h"
 #include <iostream>
 #include <cstring> // for memset
 #include <algorithm>
+#include <new>
+#ifdef NGL_SIMD_X86
+  #include <immintrin.h>
+#endif
 
 //----------------------------------------------------------------------------------------------------------------------
 /// @file Mat4.cpp
@@ -32,99 +39,184 @@
 namespace ngl
 {
 
+#ifdef NGL_SIMD_X86
 //----------------------------------------------------------------------------------------------------------------------
-Mat4::Mat4() noexcept
-{
-  memset(&m_m,0,sizeof(m_m));
-  m_00=1.0f;
-  m_11=1.0f;
-  m_22=1.0f;
-  m_33=1.0f;
-}
-
-Mat4::Mat4(Real _m[4][4]) noexcept
+// SSE / AVX kernels, selected at runtime in the Mat4 methods below via activeSIMDLevel().
+// The sums are evaluated in the same order as the scalar code (and no fma is used) so the
+// multiply and vector transforms give identical results to the scalar fallback.
+//----------------------------------------------------------------------------------------------------------------------
+namespace
 {
-  for(int y=0; y<4; ++y)
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief o = a*b where each row of o is the linear combination of the rows of b weighted by the row of a
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void multiplySSE(const Real *_a, const Real *_b, Real *o_m) noexcept
+  {
+    __m128 b0=_mm_loadu_ps(_b);
+    __m128 b1=_mm_loadu_ps(_b+4);
+    __m128 b2=_mm_loadu_ps(_b+8);
+    __m128 b3=_mm_loadu_ps(_b+12);
+    for(int row=0; row<4; ++row)
+    {
+      const Real *a=_a+row*4;
+      __m128 r=_mm_mul_ps(_mm_set1_ps(a[0]),b0);
+      r=_mm_add_ps(r,_mm_mul_ps(_mm_set1_ps(a[1]),b1));
+      r=_mm_add_ps(r,_mm_mul_ps(_mm_set1_ps(a[2]),b2));
+      r=_mm_add_ps(r,_mm_mul_ps(_mm_set1_ps(a[3]),b3));
+      _mm_storeu_ps(o_m+row*4,r);
+    }
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief AVX version of the above doing two rows of the result per pass
+  //----------------------------------------------------------------------------------------------------------------------
+  NGL_TARGET_AVX void multiplyAVX(const Real *_a, const Real *_b, Real *o_m) noexcept
   {
-    for(int x=0; x<4; ++x)
+    // each b row duplicated into both 128 bit lanes
+    __m256 b0=_mm256_broadcast_ps(reinterpret_cast<const __m128 *>(_b));
+    __m256 b1=_mm256_broadcast_ps(reinterpret_cast<const __m128 *>(_b+4));
+    __m256 b2=_mm256_broadcast_ps(reinterpret_cast<const __m128 *>(_b+8));
+    __m256 b3=_mm256_broadcast_ps(reinterpret_cast<const __m128 *>(_b+12));
+    for(int row=0; row<4; row+=2)
     {
-      m_m[y][x]=_m[y][x];
+      const Real *a=_a+row*4;
+      __m256 r=_mm256_mul_ps(_mm256_setr_ps(a[0],a[0],a[0],a[0],a[4],a[4],a[4],a[4]),b0);
+      r=_mm256_add_ps(r,_mm256_mul_ps(_mm256_setr_ps(a[1],a[1],a[1],a[1],a[5],a[5],a[5],a[5]),b1));
+      r=_mm256_add_ps(r,_mm256_mul_ps(_mm256_setr_ps(a[2],a[2],a[2],a[2],a[6],a[6],a[6],a[6]),b2));
+      r=_mm256_add_ps(r,_mm256_mul_ps(_mm256_setr_ps(a[3],a[3],a[3],a[3],a[7],a[7],a[7],a[7]),b3));
+      _mm256_storeu_ps(o_m+row*4,r);
     }
   }
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void multiply(const Real *_a, const Real *_b, Real *o_m) noexcept
+  {
+    if(activeSIMDLevel()==SIMDLevel::AVX)
+    {
+      multiplyAVX(_a,_b,o_m);
+    }
+    else
+    {
+      multiplySSE(_a,_b,o_m);
+    }
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void transposeSSE(Real *io_m) noexcept
+  {
+    __m128 r0=_mm_loadu_ps(io_m);
+    __m128 r1=_mm_loadu_ps(io_m+4);
+    __m128 r2=_mm_loadu_ps(io_m+8);
+    __m128 r3=_mm_loadu_ps(io_m+12);
+    _MM_TRANSPOSE4_PS(r0,r1,r2,r3);
+    _mm_storeu_ps(io_m,r0);
+    _mm_storeu_ps(io_m+4,r1);
+    _mm_storeu_ps(io_m+8,r2);
+    _mm_storeu_ps(io_m+12,r3);
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief o = m*v, each element is the dot of a matrix row with v which we get as the sum of the
+  /// transposed columns scaled by the vector components
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void transformSSE(const Real *_m, const Real *_v, Real *o_v) noexcept
+  {
+    __m128 c0=_mm_loadu_ps(_m);
+    __m128 c1=_mm_loadu_ps(_m+4);
+    __m128 c2=_mm_loadu_ps(_m+8);
+    __m128 c3=_mm_loadu_ps(_m+12);
+    _MM_TRANSPOSE4_PS(c0,c1,c2,c3);
+    __m128 r=_mm_mul_ps(_mm_set1_ps(_v[0]),c0);
+    r=_mm_add_ps(r,_mm_mul_ps(_mm_set1_ps(_v[1]),c1));
+    r=_mm_add_ps(r,_mm_mul_ps(_mm_set1_ps(_v[2]),c2));
+    r=_mm_add_ps(r,_mm_mul_ps(_mm_set1_ps(_v[3]),c3));
+    _mm_storeu_ps(o_v,r);
+  }
 
-}
+  #define NGL_SHUFFLE(a,b,x,y,z,w) _mm_shuffle_ps(a,b,_MM_SHUFFLE(w,z,y,x))
+  #define NGL_SWIZZLE(a,x,y,z,w) _mm_shuffle_ps(a,a,_MM_SHUFFLE(w,z,y,x))
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief 2x2 helpers for the block inverse, a 2x2 matrix is packed as (m00,m01,m10,m11)
+  //----------------------------------------------------------------------------------------------------------------------
+  inline __m128 mat2Mul(__m128 _a, __m128 _b) noexcept
+  {
+    return _mm_add_ps(_mm_mul_ps(_a,NGL_SWIZZLE(_b,0,3,0,3)),
+                      _mm_mul_ps(NGL_SWIZZLE(_a,1,0,3,2),NGL_SWIZZLE(_b,2,1,2,1)));
+  }
+  /// @brief adjugate(a)*b
+  inline __m128 mat2AdjMul(__m128 _a, __m128 _b) noexcept
+  {
+    return _mm_sub_ps(_mm_mul_ps(NGL_SWIZZLE(_a,3,3,0,0),_b),
+                      _mm_mul_ps(NGL_SWIZZLE(_a,1,1,2,2),NGL_SWIZZLE(_b,2,3,0,1)));
+  }
+  /// @brief a*adjugate(b)
+  inline __m128 mat2MulAdj(__m128 _a, __m128 _b) noexcept
+  {
+    return _mm_sub_ps(_mm_mul_ps(_a,NGL_SWIZZLE(_b,3,0,3,0)),
+                      _mm_mul_ps(NGL_SWIZZLE(_a,1,0,3,2),NGL_SWIZZLE(_b,2,1,2,1)));
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief general inverse using the 2x2 block decomposition of the matrix, as with the scalar version there is
+  /// no check for a singular matrix
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void inverseSSE(const Real *_m, Real *o_m) noexcept
+  {
+    __m128 r0=_mm_loadu_ps(_m);
+    __m128 r1=_mm_loadu_ps(_m+4);
+    __m128 r2=_mm_loadu_ps(_m+8);
+    __m128 r3=_mm_loadu_ps(_m+12);
+    // the four 2x2 sub matrices | A B |
+    //                           | C D |
+    __m128 A=_mm_movelh_ps(r0,r1);
+    __m128 B=_mm_movehl_ps(r1,r0);
+    __m128 C=_mm_movelh_ps(r2,r3);
+    __m128 D=_mm_movehl_ps(r3,r2);
+    // determinants of the sub matrices as (|A| |B| |C| |D|)
+    __m128 detSub=_mm_sub_ps(_mm_mul_ps(NGL_SHUFFLE(r0,r2,0,2,0,2),NGL_SHUFFLE(r1,r3,1,3,1,3)),
+                             _mm_mul_ps(NGL_SHUFFLE(r0,r2,1,3,1,3),NGL_SHUFFLE(r1,r3,0,2,0,2)));
+    __m128 detA=NGL_SWIZZLE(detSub,0,0,0,0);
+    __m128 detB=NGL_SWIZZLE(detSub,1,1,1,1);
+    __m128 detC=NGL_SWIZZLE(detSub,2,2,2,2);
+    __m128 detD=NGL_SWIZZLE(detSub,3,3,3,3);
+
+    __m128 DC=mat2AdjMul(D,C);
+    __m128 AB=mat2AdjMul(A,B);
+    // adjugates of the blocks of the inverse
+    __m128 X=_mm_sub_ps(_mm_mul_ps(detD,A),mat2Mul(B,DC));
+    __m128 W=_mm_sub_ps(_mm_mul_ps(detA,D),mat2Mul(C,AB));
+    __m128 Y=_mm_sub_ps(_mm_mul_ps(detB,C),mat2MulAdj(D,AB));
+    __m128 Z=_mm_sub_ps(_mm_mul_ps(detC,B),mat2MulAdj(A,DC));
+    // |M| = |A||D| + |B||C| - tr((A#B)(D#C))
+    __m128 det=_mm_add_ps(_mm_mul_ps(detA,detD),_mm_mul_ps(detB,detC));
+    __m128 tr=_mm_mul_ps(AB,NGL_SWIZZLE(DC,0,2,1,3));
+    tr=_mm_add_ps(tr,NGL_SWIZZLE(tr,2,3,0,1));
+    tr=_mm_add_ps(tr,NGL_SWIZZLE(tr,1,0,3,2));
+    det=_mm_sub_ps(det,tr);
+
+    __m128 rcpDet=_mm_div_ps(_mm_setr_ps(1.0f,-1.0f,-1.0f,1.0f),det);
+    X=_mm_mul_ps(X,rcpDet);
+    Y=_mm_mul_ps(Y,rcpDet);
+    Z=_mm_mul_ps(Z,rcpDet);
+    W=_mm_mul_ps(W,rcpDet);
+    // undo the adjugate and re-interleave the blocks into rows
+    _mm_storeu_ps(o_m,   NGL_SHUFFLE(X,Y,3,1,3,1));
+    _mm_storeu_ps(o_m+4, NGL_SHUFFLE(X,Y,2,0,2,0));
+    _mm_storeu_ps(o_m+8, NGL_SHUFFLE(Z,W,3,1,3,1));
+    _mm_storeu_ps(o_m+12,NGL_SHUFFLE(Z,W,2,0,2,0));
+  }
+  #undef NGL_SHUFFLE
+  #undef NGL_SWIZZLE
+} // end anon namespace
+#endif
 
-Mat4::Mat4(
-            Real _00,Real _01,Real _02,Real _03,
-            Real _10,Real _11,Real _12,Real _13,
-            Real _20,Real _21,Real _22,Real _23,
-            Real _30, Real _31, Real _32, Real _33 ) noexcept
-{
-  m_00=_00;
-  m_01=_01;
-  m_02=_02;
-  m_03=_03;
-
-  m_10=_10;
-  m_11=_11;
-  m_12=_12;
-  m_13=_13;
-  m_20=_20;
-  m_21=_21;
-  m_22=_22;
-  m_23=_23;
-  m_30=_30;
-  m_31=_31;
-  m_32=_32;
-  m_33=_33;
-}
-//----------------------------------------------------------------------------------------------------------------------
-Mat4::Mat4(const Mat4& _m ) noexcept
-{
-  memcpy(m_m,&_m.m_m,sizeof(m_m));
-}
-//----------------------------------------------------------------------------------------------------------------------
-Mat4& Mat4::operator=(const Mat4& _m ) noexcept
-{
-  memcpy(m_m,&_m.m_m,sizeof(m_m));
-  return *this;
-}
-//----------------------------------------------------------------------------------------------------------------------
-Mat4::Mat4(Real _m) noexcept
-{
-  memset(m_m,0,sizeof(m_m));
-  m_00=_m;
-  m_11=_m;
-  m_22=_m;
-  m_33=1.0f;
-}
-//----------------------------------------------------------------------------------------------------------------------
-/// @todo replace this with function operator overload ()
-void Mat4::setAtXY(GLint _x,GLint _y, Real _equals  ) noexcept
-{
-  m_m[_x][_y]=_equals;
-}
-//----------------------------------------------------------------------------------------------------------------------
-const Mat4& Mat4::null() noexcept
-{
-  memset(&m_m,0,sizeof(m_m));
-  return *this;
-}
-//----------------------------------------------------------------------------------------------------------------------
-const Mat4&  Mat4::identity() noexcept
-{
-  memset(m_m,0,sizeof(m_m));
-  m_00=1.0f;
-  m_11=1.0f;
-  m_22=1.0f;
-  m_33=1.0f;
-  return *this;
-}
 
 //----------------------------------------------------------------------------------------------------------------------
 Mat4 Mat4::operator*(const Mat4& _m ) const noexcept
 {
   Mat4 temp;
+#ifdef NGL_SIMD_X86
+  if(activeSIMDLevel()!=SIMDLevel::SCALAR)
+  {
+    multiply(&m_openGL[0],&_m.m_openGL[0],&temp.m_openGL[0]);
+    return temp;
+  }
+#endif
   // according to this http://www.research.scea.com/research/pdfs/GDC2003_Memory_Optimization_18Mar03.pdf
   // we get better cache performance and less in the way of
   // cache misses by prefectching the data using the consume / process pardigm
@@ -213,6 +305,14 @@ Mat4 Mat4::operator*(const Mat4& _m ) const noexcept
 const Mat4& Mat4::operator*= ( const Mat4 &_m ) noexcept
 {
   Mat4 temp(*this);
+#ifdef NGL_SIMD_X86
+  // note this is _m * this not this * _m
+  if(activeSIMDLevel()!=SIMDLevel::SCALAR)
+  {
+    multiply(&_m.m_openGL[0],&temp.m_openGL[0],&m_openGL[0]);
+    return *this;
+  }
+#endif
   //  row 0
   m_00  =  temp.m_00 * _m.m_00;
   m_01  =  temp.m_01 * _m.m_00;
@@ -304,77 +404,17 @@ const Mat4& Mat4::operator*= ( const Mat4 &_m ) noexcept
 }
 
 
-//----------------------------------------------------------------------------------------------------------------------
-Mat4 Mat4::operator+(const Mat4 &_m ) const noexcept
-{
-  Mat4 ret;
-  const Real* iterA = &m_openGL[0];
-  const Real* iterB = &_m.m_openGL[0];
-  Real* iterR = &ret.m_openGL[0];
-  const Real* end   = &m_openGL[16];
-
-
-  for( ; iterA != end; ++iterA, ++iterB, ++iterR)
-  {
-    *iterR = *iterA + *iterB;
-  }
-  return ret;
-
-/* this is one way of doing things with STL however speed is Average time: 15.457 us as
- apposed to Average time: 6.847 us using the above version
-Mat4 ret;
-std::transform(std::begin(m_openGL), std::end(m_openGL),
-               std::begin(_m.m_openGL), std::begin(ret.m_openGL),
-               std::plus<Real>());
-
-return ret;
-*/
-}
-//----------------------------------------------------------------------------------------------------------------------
-const Mat4& Mat4::operator+=(const Mat4 &_m) noexcept
-{
-  Real* iterA =&m_openGL[0];
-  const Real* iterB = &_m.m_openGL[0];
-  const Real* end   = &m_openGL[16];
-
-  for( ; iterA != end; ++iterA, ++iterB)
-  {
-    *iterA += *iterB;
-  }
-  return *this;
-}
-//----------------------------------------------------------------------------------------------------------------------
-Mat4 Mat4::operator*( const Real _i) const noexcept
-{
-  Mat4 ret;
-  const Real* iterA = &m_openGL[0];
-  Real* iterB = &ret.m_openGL[0];
-  const Real* end   = &m_openGL[16];
-
-  for( ; iterA != end; ++iterA, ++iterB)
-  {
-    *iterB = (*iterA) * _i;
-  }
-  return ret;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-const Mat4& Mat4::operator*=(const Real _i) noexcept
-{
-  for(int y=0; y<4; y++)
-  {
-    for(int x=0; x<4; x++)
-    {
-      m_m[y][x]*=_i;
-    }
-  }
-  return *this;
-}
-
 //----------------------------------------------------------------------------------------------------------------------
 Vec4 Mat4::operator * (const Vec4 &_v ) const noexcept
 {
   Vec4 temp;
+#ifdef NGL_SIMD_X86
+  if(activeSIMDLevel()!=SIMDLevel::SCALAR)
+  {
+    transformSSE(&m_openGL[0],&_v.m_openGL[0],&temp.m_openGL[0]);
+    return temp;
+  }
+#endif
 
   temp.m_x=_v.m_x * m_00 + _v.m_y	* m_01 + _v.m_z * m_02 + _v.m_w * m_03;
   temp.m_y=_v.m_x * m_10 + _v.m_y	* m_11 + _v.m_z * m_12 + _v.m_w * m_13;
@@ -388,6 +428,13 @@ return temp;
 //----------------------------------------------------------------------------------------------------------------------
 const Mat4& Mat4::transpose() noexcept
 {
+#ifdef NGL_SIMD_X86
+  if(activeSIMDLevel()!=SIMDLevel::SCALAR)
+  {
+    transposeSSE(&m_openGL[0]);
+    return *this;
+  }
+#endif
   Mat4 tmp(*this);
 
   for(int row=0; row<4; row++)
@@ -401,7 +448,6 @@ const Mat4& Mat4::transpose() noexcept
 }
 
 
-
 //----------------------------------------------------------------------------------------------------------------------
 void Mat4::rotateX( const Real _deg) noexcept
 {
@@ -438,21 +484,6 @@ void Mat4::rotateZ(const Real _deg ) noexcept
   m_11 =  cr;
 }
 
-//----------------------------------------------------------------------------------------------------------------------
-void Mat4::translate( const Real _x,const Real _y,  const Real _z ) noexcept
-{
-  m_30 = _x;
-  m_31 = _y;
-  m_32 = _z;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-void Mat4::scale(const Real _x, const Real _y,  const Real _z ) noexcept
-{
-  m_00 = _x;
-  m_11 = _y;
-  m_22 = _z;
-}
 
 //----------------------------------------------------------------------------------------------------------------------
 void Mat4::subMatrix3x3(const int _i, const int _j, Real o_mat[]  ) const noexcept
@@ -503,11 +534,6 @@ Real Mat4::determinant() const noexcept
 }
 
 
-
-
-
-
-
 //----------------------------------------------------------------------------------------------------------------------
 void Mat4::euler(const Real _angle, const Real _x, const Real _y, const Real _z) noexcept
 {
@@ -683,7 +709,14 @@ Mat4  Mat4::Adjacent() noexcept
 
 Mat4 Mat4::inverse() noexcept
 {
-
+#ifdef NGL_SIMD_X86
+  if(activeSIMDLevel()!=SIMDLevel::SCALAR)
+  {
+    Mat4 r;
+    inverseSSE(&m_openGL[0],&r.m_openGL[0]);
+    return r;
+  }
+#endif
 
   Mat4 t;
   t.m_00 = m_11*m_22*m_33 + m_12*m_23*m_31 + m_13*m_21*m_32 - m_11*m_32*m_23 - m_12*m_21*m_33 - m_13*m_22*m_31;
@@ -711,6 +744,117 @@ Mat4 Mat4::inverse() noexcept
 
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+Mat4 Mat4::inverseAffine() const noexcept
+{
+  // M = | A 0 |  so   M^-1 = | A^-1     0 |
+  //     | t 1 |              | -t*A^-1  1 |
+  // where A^-1 is the transposed cofactors of the upper 3x3 over its determinant
+  Mat4 r;
+  r.m_00 = m_11*m_22 - m_12*m_21;
+  r.m_01 = m_02*m_21 - m_01*m_22;
+  r.m_02 = m_01*m_12 - m_02*m_11;
+  r.m_10 = m_12*m_20 - m_10*m_22;
+  r.m_11 = m_00*m_22 - m_02*m_20;
+  r.m_12 = m_02*m_10 - m_00*m_12;
+  r.m_20 = m_10*m_21 - m_11*m_20;
+  r.m_21 = m_01*m_20 - m_00*m_21;
+  r.m_22 = m_00*m_11 - m_01*m_10;
+
+  Real invDet = 1.0f/(m_00*r.m_00 + m_01*r.m_10 + m_02*r.m_20);
+  for(int y=0; y<3; ++y)
+  {
+    for(int x=0; x<3; ++x)
+    {
+      r.m_m[y][x]*=invDet;
+    }
+  }
+  r.m_30 = -(m_30*r.m_00 + m_31*r.m_10 + m_32*r.m_20);
+  r.m_31 = -(m_30*r.m_01 + m_31*r.m_11 + m_32*r.m_21);
+  r.m_32 = -(m_30*r.m_02 + m_31*r.m_12 + m_32*r.m_22);
+  return r;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+Mat4 Mat4::inverseRigid() const noexcept
+{
+  // the inverse of an orthonormal 3x3 is its transpose
+  Mat4 r;
+  for(int y=0; y<3; ++y)
+  {
+    for(int x=0; x<3; ++x)
+    {
+      r.m_m[y][x]=m_m[x][y];
+    }
+  }
+  r.m_30 = -(m_30*m_00 + m_31*m_01 + m_32*m_02);
+  r.m_31 = -(m_30*m_10 + m_31*m_11 + m_32*m_12);
+  r.m_32 = -(m_30*m_20 + m_31*m_21 + m_32*m_22);
+  return r;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+Mat3 Mat4::normalMatrix(bool _uniformScale) const noexcept
+{
+  if(_uniformScale)
+  {
+    // for M = sR the inverse transpose is R/s which is M/s^2
+    Mat3 n(*this);
+    n*=1.0f/(m_00*m_00 + m_01*m_01 + m_02*m_02);
+    return n;
+  }
+  // (A^-1)^T is the cofactors of the upper 3x3 over its determinant
+  Mat3 n(m_11*m_22 - m_12*m_21, m_12*m_20 - m_10*m_22, m_10*m_21 - m_11*m_20,
+         m_02*m_21 - m_01*m_22, m_00*m_22 - m_02*m_20, m_01*m_20 - m_00*m_21,
+         m_01*m_12 - m_02*m_11, m_02*m_10 - m_00*m_12, m_00*m_11 - m_01*m_10);
+  n*=1.0f/(m_00*n.m_00 + m_01*n.m_01 + m_02*n.m_02);
+  return n;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Mat4::fromTRS(const Vec3 &_translate, const Vec3 &_rotate, const Vec3 &_scale, Mat4 &o_matrix, Mat4 &o_inverse) noexcept
+{
+  Real sx=sinf(radians(_rotate.m_x));
+  Real cx=cosf(radians(_rotate.m_x));
+  Real sy=sinf(radians(_rotate.m_y));
+  Real cy=cosf(radians(_rotate.m_y));
+  Real sz=sinf(radians(_rotate.m_z));
+  Real cz=cosf(radians(_rotate.m_z));
+  // rotateX * rotateY * rotateZ expanded
+  Real rot[3][3]={
+                   { cy*cz,             cy*sz,            -sy    },
+                   { sx*sy*cz - cx*sz,  sx*sy*sz + cx*cz, sx*cy  },
+                   { cx*sy*cz + sx*sz,  cx*sy*sz - sx*cz, cx*cy  }
+                 };
+  Real scale[3]={_scale.m_x,_scale.m_y,_scale.m_z};
+  Real translate[3]={_translate.m_x,_translate.m_y,_translate.m_z};
+  // M = S*R with the translation row, M^-1 = T^-1 * R^T * S^-1
+  for(int y=0; y<3; ++y)
+  {
+    Real invScale=1.0f/scale[y];
+    for(int x=0; x<3; ++x)
+    {
+      o_matrix.m_m[y][x]=scale[y]*rot[y][x];
+      o_inverse.m_m[x][y]=rot[y][x]*invScale;
+    }
+    o_matrix.m_m[y][3]=0.0f;
+    o_matrix.m_m[3][y]=translate[y];
+    o_inverse.m_m[y][3]=0.0f;
+    o_inverse.m_m[3][y]=-(translate[0]*rot[y][0] + translate[1]*rot[y][1] + translate[2]*rot[y][2])*invScale;
+  }
+  o_matrix.m_33=1.0f;
+  o_inverse.m_33=1.0f;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+Mat4 Mat4::fromTRS(const Vec3 &_translate, const Vec3 &_rotate, const Vec3 &_scale) noexcept
+{
+  Mat4 m;
+  Mat4 inv;
+  fromTRS(_translate,_rotate,_scale,m,inv);
+  return m;
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 Vec3 Mat4::getLeftVector() const noexcept
 {
@@ -749,8 +893,26 @@ Vec3 Mat4::getBackVector() const noexcept
 }
 
 
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief keeps an exported copy of the methods that are inline in Mat4.h, see ExportInline.h
+//----------------------------------------------------------------------------------------------------------------------
+namespace detail
+{
+NGL_EXPORT_INLINE void exportMat4Inline(Mat4 *o_m, Real _v) noexcept
+{
+  new (o_m) Mat4;
+  new (o_m) Mat4(o_m->m_m);
+  new (o_m) Mat4(_v,_v,_v,_v,_v,_v,_v,_v,_v,_v,_v,_v,_v,_v,_v,_v);
+  new (o_m) Mat4(*o_m);
+  new (o_m) Mat4(_v);
+  exportInline(
+    static_cast<Mat4 (Mat4::*)(Real) const>(&Mat4::operator*),
+    static_cast<const Mat4 &(Mat4::*)(Real)>(&Mat4::operator*=),
+    &Mat4::operator=, &Mat4::setAtXY, &Mat4::null, &Mat4::identity, &Mat4::operator+, &Mat4::operator+=,
+    &Mat4::translate, &Mat4::scale
+  );
+}
+} // end namespace detail
 
 } // end namespace ngl
 
-
-
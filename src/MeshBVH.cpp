@@ -0,0 +1,912 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "MeshBVH.h"
+#include "AbstractMesh.h"
+#include "NCCAPointBake.h"
+#include "NGLassert.h"
+#include "ParallelFor.h"
+#include "SIMD.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#ifdef NGL_SIMD_X86
+  #include <immintrin.h>
+#endif
+//----------------------------------------------------------------------------------------------------------------------
+/// @file MeshBVH.cpp
+/// @brief implementation files for MeshBVH class
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace ngl
+{
+constexpr uint32_t MeshBVH::c_noHit;
+constexpr size_t MeshBVH::c_maxLeafSize;
+
+namespace
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of bins the centroids are sorted into to find the best split
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr size_t c_numBins=16;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the cost of visiting a node relative to testing a triangle
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr Real c_traversalCost=1.0f;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the traversal stack size, below c_sahDepth the splits are forced to halve the triangles so the
+  /// depth can never reach it
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr size_t c_stackSize=64;
+  constexpr size_t c_sahDepth=c_stackSize-33;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ranges smaller than this are not worth handing to another thread when building
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr size_t c_parallelThreshold=4096;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the minimum number of rays given to each thread by closestHits
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr size_t c_grainRays=256;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the offsets of the arrays in m_tri
+  //----------------------------------------------------------------------------------------------------------------------
+  enum TriArray {V0X=0,V0Y,V0Z,E1X,E1Y,E1Z,E2X,E2Y,E2Z};
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a box grown to hold points
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Bounds
+  {
+    Real m_min[3]={std::numeric_limits<Real>::max(),std::numeric_limits<Real>::max(),std::numeric_limits<Real>::max()};
+    Real m_max[3]={-std::numeric_limits<Real>::max(),-std::numeric_limits<Real>::max(),-std::numeric_limits<Real>::max()};
+
+    void grow(const Real *_min, const Real *_max) noexcept
+    {
+      for(int i=0; i<3; ++i)
+      {
+        m_min[i]=std::min(m_min[i],_min[i]);
+        m_max[i]=std::max(m_max[i],_max[i]);
+      }
+    }
+    void grow(const Vec3 &_p) noexcept { grow(_p.m_openGL.data(),_p.m_openGL.data()); }
+    void grow(const Bounds &_b) noexcept { grow(_b.m_min,_b.m_max); }
+    Real area() const noexcept
+    {
+      if(m_min[0] > m_max[0])
+      {
+        return 0.0f;
+      }
+      Real x=m_max[0]-m_min[0];
+      Real y=m_max[1]-m_min[1];
+      Real z=m_max[2]-m_min[2];
+      return 2.0f*(x*y+y*z+z*x);
+    }
+    void store(MeshBVH::Node &o_node) const noexcept
+    {
+      std::copy(m_min,m_min+3,o_node.m_min);
+      std::copy(m_max,m_max+3,o_node.m_max);
+    }
+  };
+
+  Bounds nodeBounds(const MeshBVH::Node &_n) noexcept
+  {
+    Bounds b;
+    b.grow(_n.m_min,_n.m_max);
+    return b;
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief builds the tree over a permutation of the triangles, each range of m_order is only touched by the
+  /// thread building it
+  //----------------------------------------------------------------------------------------------------------------------
+  class Builder
+  {
+  public :
+    Builder(const std::vector<Bounds> &_bounds, const std::vector<Vec3> &_centroids, std::vector<uint32_t> &io_order) :
+      m_bounds(_bounds), m_centroids(_centroids), m_order(io_order) {}
+
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief partition [_begin,_end) with the binned SAH
+    /// @returns the start of the right half or _end if the range should be a leaf
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t split(size_t _begin, size_t _end, size_t _depth) const
+    {
+      size_t count=_end-_begin;
+      if(count<=1)
+      {
+        return _end;
+      }
+      Bounds all;
+      Bounds centres;
+      for(size_t i=_begin; i<_end; ++i)
+      {
+        all.grow(m_bounds[m_order[i]]);
+        centres.grow(m_centroids[m_order[i]]);
+      }
+      int axis=0;
+      for(int i=1; i<3; ++i)
+      {
+        if(centres.m_max[i]-centres.m_min[i] > centres.m_max[axis]-centres.m_min[axis])
+        {
+          axis=i;
+        }
+      }
+      Real lo=centres.m_min[axis];
+      Real extent=centres.m_max[axis]-lo;
+      if(!(extent > 0.0f))
+      {
+        // every centre is the same so there is nothing to sort on
+        return count>MeshBVH::c_maxLeafSize ? _begin+count/2 : _end;
+      }
+      if(_depth>=c_sahDepth)
+      {
+        // deep in a badly balanced tree so just halve it
+        size_t mid=_begin+count/2;
+        std::nth_element(m_order.begin()+_begin,m_order.begin()+mid,m_order.begin()+_end,[this,axis](uint32_t _a, uint32_t _b)
+        {
+          return m_centroids[_a].m_openGL[axis] < m_centroids[_b].m_openGL[axis];
+        });
+        return mid;
+      }
+      Real scale=static_cast<Real>(c_numBins)/extent;
+      auto bin=[this,axis,lo,scale](uint32_t _t)
+      {
+        return std::min(c_numBins-1,static_cast<size_t>((m_centroids[_t].m_openGL[axis]-lo)*scale));
+      };
+      size_t binCount[c_numBins]={0};
+      Bounds binBounds[c_numBins];
+      for(size_t i=_begin; i<_end; ++i)
+      {
+        size_t b=bin(m_order[i]);
+        ++binCount[b];
+        binBounds[b].grow(m_bounds[m_order[i]]);
+      }
+      // the area and count to the right of each split
+      Real rightCost[c_numBins];
+      Bounds right;
+      size_t rightCount=0;
+      for(size_t b=c_numBins-1; b>0; --b)
+      {
+        right.grow(binBounds[b]);
+        rightCount+=binCount[b];
+        rightCost[b]=right.area()*static_cast<Real>(rightCount);
+      }
+      Bounds left;
+      size_t leftCount=0;
+      size_t best=0;
+      Real bestCost=std::numeric_limits<Real>::max();
+      for(size_t b=1; b<c_numBins; ++b)
+      {
+        left.grow(binBounds[b-1]);
+        leftCount+=binCount[b-1];
+        Real cost=left.area()*static_cast<Real>(leftCount)+rightCost[b];
+        if(leftCount!=0 && leftCount!=count && cost<bestCost)
+        {
+          best=b;
+          bestCost=cost;
+        }
+      }
+      Real area=all.area();
+      if(count<=MeshBVH::c_maxLeafSize && (best==0 || c_traversalCost*area+bestCost >= area*static_cast<Real>(count)))
+      {
+        return _end;
+      }
+      if(best==0)
+      {
+        return _begin+count/2;
+      }
+      auto mid=std::partition(m_order.begin()+_begin,m_order.begin()+_end,[&bin,best](uint32_t _t){ return bin(_t)<best; });
+      return static_cast<size_t>(mid-m_order.begin());
+    }
+
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief build the subtree of [_begin,_end) depth first onto the end of io_nodes
+    //----------------------------------------------------------------------------------------------------------------------
+    void build(size_t _begin, size_t _end, size_t _depth, std::vector<MeshBVH::Node> &io_nodes) const
+    {
+      size_t index=io_nodes.size();
+      io_nodes.push_back(MeshBVH::Node());
+      size_t mid=split(_begin,_end,_depth);
+      Bounds b;
+      if(mid==_end)
+      {
+        for(size_t i=_begin; i<_end; ++i)
+        {
+          b.grow(m_bounds[m_order[i]]);
+        }
+        io_nodes[index].m_index=static_cast<uint32_t>(_begin);
+        io_nodes[index].m_count=static_cast<uint32_t>(_end-_begin);
+      }
+      else
+      {
+        build(_begin,mid,_depth+1,io_nodes);
+        io_nodes[index].m_index=static_cast<uint32_t>(io_nodes.size());
+        build(mid,_end,_depth+1,io_nodes);
+        b=nodeBounds(io_nodes[index+1]);
+        b.grow(nodeBounds(io_nodes[io_nodes[index].m_index]));
+        io_nodes[index].m_count=0;
+      }
+      b.store(io_nodes[index]);
+    }
+
+  private :
+    const std::vector<Bounds> &m_bounds;
+    const std::vector<Vec3> &m_centroids;
+    std::vector<uint32_t> &m_order;
+  };
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the top of the tree is split on one thread into tasks which are then built in parallel, a top node
+  /// either has two top children or is one task
+  //----------------------------------------------------------------------------------------------------------------------
+  struct TopNode
+  {
+    size_t m_left;
+    size_t m_right;
+    size_t m_task;
+  };
+  struct Task
+  {
+    size_t m_begin;
+    size_t m_end;
+    size_t m_depth;
+  };
+  constexpr size_t c_notTask=~size_t(0);
+
+  size_t splitTop(const Builder &_builder, size_t _begin, size_t _end, size_t _depth, size_t _maxDepth,
+                  std::vector<TopNode> &io_top, std::vector<Task> &io_tasks)
+  {
+    size_t index=io_top.size();
+    io_top.push_back({0,0,c_notTask});
+    size_t mid=_end;
+    if(_end-_begin>c_parallelThreshold && _depth<_maxDepth)
+    {
+      mid=_builder.split(_begin,_end,_depth);
+    }
+    if(mid==_end)
+    {
+      io_top[index].m_task=io_tasks.size();
+      io_tasks.push_back({_begin,_end,_depth});
+    }
+    else
+    {
+      size_t left=splitTop(_builder,_begin,mid,_depth+1,_maxDepth,io_top,io_tasks);
+      size_t right=splitTop(_builder,mid,_end,_depth+1,_maxDepth,io_top,io_tasks);
+      io_top[index].m_left=left;
+      io_top[index].m_right=right;
+    }
+    return index;
+  }
+
+  void flattenTop(const std::vector<TopNode> &_top, size_t _node, const std::vector<std::vector<MeshBVH::Node>> &_tasks,
+                  std::vector<MeshBVH::Node> &io_nodes)
+  {
+    const TopNode &t=_top[_node];
+    if(t.m_task!=c_notTask)
+    {
+      uint32_t offset=static_cast<uint32_t>(io_nodes.size());
+      for(auto n : _tasks[t.m_task])
+      {
+        if(n.m_count==0)
+        {
+          n.m_index+=offset;
+        }
+        io_nodes.push_back(n);
+      }
+      return;
+    }
+    size_t index=io_nodes.size();
+    io_nodes.push_back(MeshBVH::Node());
+    flattenTop(_top,t.m_left,_tasks,io_nodes);
+    io_nodes[index].m_index=static_cast<uint32_t>(io_nodes.size());
+    flattenTop(_top,t.m_right,_tasks,io_nodes);
+    Bounds b=nodeBounds(io_nodes[index+1]);
+    b.grow(nodeBounds(io_nodes[io_nodes[index].m_index]));
+    b.store(io_nodes[index]);
+    io_nodes[index].m_count=0;
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief slab test of one ray against a box
+  /// @param[out] o_near the distance the ray enters the box
+  //----------------------------------------------------------------------------------------------------------------------
+  inline bool boxScalar(const MeshBVH::Node &_n, const Real *_origin, const Real *_invDir, Real _tMin, Real _tMax,
+                        Real &o_near) noexcept
+  {
+    Real tNear=_tMin;
+    Real tFar=_tMax;
+    for(int i=0; i<3; ++i)
+    {
+      Real t1=(_n.m_min[i]-_origin[i])*_invDir[i];
+      Real t2=(_n.m_max[i]-_origin[i])*_invDir[i];
+      tNear=std::max(tNear,std::min(t1,t2));
+      tFar=std::min(tFar,std::max(t1,t2));
+    }
+    o_near=tNear;
+    return tNear<=tFar;
+  }
+
+#ifdef NGL_SIMD_X86
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the slab test with x,y,z in one register, _origin and _invDir hold x,y,z,x
+  //----------------------------------------------------------------------------------------------------------------------
+  inline bool boxSSE(const MeshBVH::Node &_n, __m128 _origin, __m128 _invDir, Real _tMin, Real _tMax, Real &o_near) noexcept
+  {
+    // the fourth lane of each load is the index or count so x is copied over it
+    __m128 lo=_mm_loadu_ps(_n.m_min);
+    __m128 hi=_mm_loadu_ps(_n.m_max);
+    lo=_mm_shuffle_ps(lo,lo,_MM_SHUFFLE(0,2,1,0));
+    hi=_mm_shuffle_ps(hi,hi,_MM_SHUFFLE(0,2,1,0));
+    __m128 t1=_mm_mul_ps(_mm_sub_ps(lo,_origin),_invDir);
+    __m128 t2=_mm_mul_ps(_mm_sub_ps(hi,_origin),_invDir);
+    __m128 tNear=_mm_min_ps(t1,t2);
+    __m128 tFar=_mm_max_ps(t1,t2);
+    tNear=_mm_max_ps(tNear,_mm_shuffle_ps(tNear,tNear,_MM_SHUFFLE(2,1,0,3)));
+    tNear=_mm_max_ps(tNear,_mm_shuffle_ps(tNear,tNear,_MM_SHUFFLE(1,0,3,2)));
+    tFar=_mm_min_ps(tFar,_mm_shuffle_ps(tFar,tFar,_MM_SHUFFLE(2,1,0,3)));
+    tFar=_mm_min_ps(tFar,_mm_shuffle_ps(tFar,tFar,_MM_SHUFFLE(1,0,3,2)));
+    Real n=std::max(_tMin,_mm_cvtss_f32(tNear));
+    Real f=std::min(_tMax,_mm_cvtss_f32(tFar));
+    o_near=n;
+    return n<=f;
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the ray / triangle test of 4 triangles from _tri+_i as in the scalar version
+  /// @returns the lane mask of the hits and their t, u and v
+  //----------------------------------------------------------------------------------------------------------------------
+  inline int trianglesSSE(const std::vector<Real> *_tri, size_t _i, const Real *_origin, const Real *_dir,
+                          Real _tMin, Real _tMax, __m128 &o_t, __m128 &o_u, __m128 &o_v) noexcept
+  {
+    __m128 dx=_mm_set1_ps(_dir[0]);
+    __m128 dy=_mm_set1_ps(_dir[1]);
+    __m128 dz=_mm_set1_ps(_dir[2]);
+    __m128 e1x=_mm_loadu_ps(&_tri[E1X][_i]);
+    __m128 e1y=_mm_loadu_ps(&_tri[E1Y][_i]);
+    __m128 e1z=_mm_loadu_ps(&_tri[E1Z][_i]);
+    __m128 e2x=_mm_loadu_ps(&_tri[E2X][_i]);
+    __m128 e2y=_mm_loadu_ps(&_tri[E2Y][_i]);
+    __m128 e2z=_mm_loadu_ps(&_tri[E2Z][_i]);
+    __m128 px=_mm_sub_ps(_mm_mul_ps(dy,e2z),_mm_mul_ps(dz,e2y));
+    __m128 py=_mm_sub_ps(_mm_mul_ps(dz,e2x),_mm_mul_ps(dx,e2z));
+    __m128 pz=_mm_sub_ps(_mm_mul_ps(dx,e2y),_mm_mul_ps(dy,e2x));
+    __m128 det=_mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x,px),_mm_mul_ps(e1y,py)),_mm_mul_ps(e1z,pz));
+    __m128 inv=_mm_div_ps(_mm_set1_ps(1.0f),det);
+    __m128 tx=_mm_sub_ps(_mm_set1_ps(_origin[0]),_mm_loadu_ps(&_tri[V0X][_i]));
+    __m128 ty=_mm_sub_ps(_mm_set1_ps(_origin[1]),_mm_loadu_ps(&_tri[V0Y][_i]));
+    __m128 tz=_mm_sub_ps(_mm_set1_ps(_origin[2]),_mm_loadu_ps(&_tri[V0Z][_i]));
+    __m128 u=_mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(tx,px),_mm_mul_ps(ty,py)),_mm_mul_ps(tz,pz)),inv);
+    __m128 qx=_mm_sub_ps(_mm_mul_ps(ty,e1z),_mm_mul_ps(tz,e1y));
+    __m128 qy=_mm_sub_ps(_mm_mul_ps(tz,e1x),_mm_mul_ps(tx,e1z));
+    __m128 qz=_mm_sub_ps(_mm_mul_ps(tx,e1y),_mm_mul_ps(ty,e1x));
+    __m128 v=_mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx,qx),_mm_mul_ps(dy,qy)),_mm_mul_ps(dz,qz)),inv);
+    __m128 t=_mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x,qx),_mm_mul_ps(e2y,qy)),_mm_mul_ps(e2z,qz)),inv);
+    const __m128 zero=_mm_setzero_ps();
+    __m128 hit=_mm_cmpneq_ps(det,zero);
+    hit=_mm_and_ps(hit,_mm_cmpge_ps(u,zero));
+    hit=_mm_and_ps(hit,_mm_cmpge_ps(v,zero));
+    hit=_mm_and_ps(hit,_mm_cmple_ps(_mm_add_ps(u,v),_mm_set1_ps(1.0f)));
+    hit=_mm_and_ps(hit,_mm_cmpgt_ps(t,_mm_set1_ps(_tMin)));
+    hit=_mm_and_ps(hit,_mm_cmplt_ps(t,_mm_set1_ps(_tMax)));
+    o_t=t;
+    o_u=u;
+    o_v=v;
+    return _mm_movemask_ps(hit);
+  }
+#endif
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief Moller Trumbore ray / triangle test of the triangle at _i
+  //----------------------------------------------------------------------------------------------------------------------
+  inline bool triangleScalar(const std::vector<Real> *_tri, size_t _i, const Real *_origin, const Real *_dir,
+                             Real _tMin, Real _tMax, Real &o_t, Real &o_u, Real &o_v) noexcept
+  {
+    Real e1[3]={_tri[E1X][_i],_tri[E1Y][_i],_tri[E1Z][_i]};
+    Real e2[3]={_tri[E2X][_i],_tri[E2Y][_i],_tri[E2Z][_i]};
+    Real p[3]={_dir[1]*e2[2]-_dir[2]*e2[1],_dir[2]*e2[0]-_dir[0]*e2[2],_dir[0]*e2[1]-_dir[1]*e2[0]};
+    Real det=e1[0]*p[0]+e1[1]*p[1]+e1[2]*p[2];
+    if(det==0.0f)
+    {
+      return false;
+    }
+    Real inv=1.0f/det;
+    Real t[3]={_origin[0]-_tri[V0X][_i],_origin[1]-_tri[V0Y][_i],_origin[2]-_tri[V0Z][_i]};
+    Real u=(t[0]*p[0]+t[1]*p[1]+t[2]*p[2])*inv;
+    Real q[3]={t[1]*e1[2]-t[2]*e1[1],t[2]*e1[0]-t[0]*e1[2],t[0]*e1[1]-t[1]*e1[0]};
+    Real v=(_dir[0]*q[0]+_dir[1]*q[1]+_dir[2]*q[2])*inv;
+    Real d=(e2[0]*q[0]+e2[1]*q[1]+e2[2]*q[2])*inv;
+    if(u>=0.0f && v>=0.0f && u+v<=1.0f && d>_tMin && d<_tMax)
+    {
+      o_t=d;
+      o_u=u;
+      o_v=v;
+      return true;
+    }
+    return false;
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief 1/_d per axis
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void inverse(const Real *_d, Real *o_inv) noexcept
+  {
+    for(int i=0; i<3; ++i)
+    {
+      o_inv[i]=1.0f/_d[i];
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+MeshBVH::MeshBVH(AbstractMesh &_mesh)
+{
+  build(_mesh);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void MeshBVH::build(AbstractMesh &_mesh)
+{
+  m_verts=_mesh.getVertexList();
+  m_indices.clear();
+  m_face.clear();
+  std::vector<Face> faces=_mesh.getFaceList();
+  for(size_t f=0; f<faces.size(); ++f)
+  {
+    const auto &v=faces[f].m_vert;
+    for(size_t i=2; i<v.size(); ++i)
+    {
+      m_indices.push_back(v[0]);
+      m_indices.push_back(v[i-1]);
+      m_indices.push_back(v[i]);
+      m_face.push_back(static_cast<uint32_t>(f));
+    }
+  }
+  buildTree();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void MeshBVH::build(const Vec3 *_verts, size_t _numVerts, const uint32_t *_indices, size_t _numIndices)
+{
+  NGL_ASSERT(_numIndices%3==0);
+  m_verts.assign(_verts,_verts+_numVerts);
+  m_indices.assign(_indices,_indices+_numIndices/3*3);
+  m_face.resize(m_indices.size()/3);
+  for(size_t i=0; i<m_face.size(); ++i)
+  {
+    m_face[i]=static_cast<uint32_t>(i);
+  }
+  buildTree();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void MeshBVH::buildTree()
+{
+  m_nodes.clear();
+  size_t numTris=m_indices.size()/3;
+  m_triangle.resize(numTris);
+  if(numTris==0)
+  {
+    updateTriangles();
+    return;
+  }
+  std::vector<Bounds> bounds(numTris);
+  std::vector<Vec3> centroids(numTris);
+  parallelFor(numTris,c_parallelThreshold,[this,&bounds,&centroids](size_t _begin, size_t _end)
+  {
+    for(size_t t=_begin; t<_end; ++t)
+    {
+      Bounds b;
+      for(int i=0; i<3; ++i)
+      {
+        b.grow(m_verts[m_indices[t*3+i]]);
+      }
+      bounds[t]=b;
+      centroids[t].set((b.m_min[0]+b.m_max[0])*0.5f,(b.m_min[1]+b.m_max[1])*0.5f,(b.m_min[2]+b.m_max[2])*0.5f);
+    }
+  });
+  for(size_t t=0; t<numTris; ++t)
+  {
+    m_triangle[t]=static_cast<uint32_t>(t);
+  }
+  Builder builder(bounds,centroids,m_triangle);
+  // split the top into a few tasks per thread then build the subtrees in parallel
+  size_t maxDepth=0;
+  for(size_t tasks=1; tasks<4*std::max(1u,std::thread::hardware_concurrency()); tasks*=2)
+  {
+    ++maxDepth;
+  }
+  std::vector<TopNode> top;
+  std::vector<Task> tasks;
+  splitTop(builder,0,numTris,0,maxDepth,top,tasks);
+  std::vector<std::vector<Node>> taskNodes(tasks.size());
+  parallelFor(tasks.size(),1,[&builder,&tasks,&taskNodes](size_t _begin, size_t _end)
+  {
+    for(size_t t=_begin; t<_end; ++t)
+    {
+      builder.build(tasks[t].m_begin,tasks[t].m_end,tasks[t].m_depth,taskNodes[t]);
+    }
+  });
+  flattenTop(top,0,taskNodes,m_nodes);
+  updateTriangles();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void MeshBVH::updateTriangles() noexcept
+{
+  size_t numTris=m_triangle.size();
+  for(auto &a : m_tri)
+  {
+    a.resize(numTris+3,0.0f);
+  }
+  parallelFor(numTris,c_parallelThreshold,[this](size_t _begin, size_t _end)
+  {
+    for(size_t i=_begin; i<_end; ++i)
+    {
+      const uint32_t *index=&m_indices[m_triangle[i]*3];
+      const Vec3 &a=m_verts[index[0]];
+      const Vec3 &b=m_verts[index[1]];
+      const Vec3 &c=m_verts[index[2]];
+      for(int k=0; k<3; ++k)
+      {
+        m_tri[V0X+k][i]=a.m_openGL[k];
+        m_tri[E1X+k][i]=b.m_openGL[k]-a.m_openGL[k];
+        m_tri[E2X+k][i]=c.m_openGL[k]-a.m_openGL[k];
+      }
+    }
+  });
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void MeshBVH::refit(const Vec3 *_verts, size_t _numVerts) noexcept
+{
+  NGL_ASSERT(_numVerts==m_verts.size());
+  std::copy(_verts,_verts+std::min(_numVerts,m_verts.size()),m_verts.begin());
+  updateTriangles();
+  // the children always follow their parent so going backwards visits them first
+  for(size_t n=m_nodes.size(); n-->0; )
+  {
+    Node &node=m_nodes[n];
+    Bounds b;
+    if(node.m_count!=0)
+    {
+      for(size_t i=node.m_index; i<node.m_index+node.m_count; ++i)
+      {
+        const uint32_t *index=&m_indices[m_triangle[i]*3];
+        for(int k=0; k<3; ++k)
+        {
+          b.grow(m_verts[index[k]]);
+        }
+      }
+    }
+    else
+    {
+      b=nodeBounds(m_nodes[n+1]);
+      b.grow(nodeBounds(m_nodes[node.m_index]));
+    }
+    b.store(node);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void MeshBVH::refit(NCCAPointBake &_bake, unsigned int _frame) noexcept
+{
+  const std::vector<Vec3> &frame=_bake.getRawDataPointer()[_frame];
+  refit(frame.data(),frame.size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool MeshBVH::intersectLeaf(const Real *_origin, const Real *_dir, size_t _first, size_t _count, Real _tMin, bool _any,
+                            Hit &io_hit) const noexcept
+{
+  bool found=false;
+  size_t i=_first;
+  size_t end=_first+_count;
+#ifdef NGL_SIMD_X86
+  if(activeSIMDLevel()!=SIMDLevel::SCALAR)
+  {
+    for( ; i<end; i+=4)
+    {
+      __m128 t;
+      __m128 u;
+      __m128 v;
+      int mask=trianglesSSE(m_tri,i,_origin,_dir,_tMin,io_hit.m_t,t,u,v);
+      // drop the lanes past the end of the leaf
+      mask&=(1<<std::min<size_t>(4,end-i))-1;
+      if(mask==0)
+      {
+        continue;
+      }
+      alignas(16) Real ts[4];
+      alignas(16) Real us[4];
+      alignas(16) Real vs[4];
+      _mm_store_ps(ts,t);
+      _mm_store_ps(us,u);
+      _mm_store_ps(vs,v);
+      for(int l=0; l<4; ++l)
+      {
+        if((mask>>l & 1) && ts[l]<io_hit.m_t)
+        {
+          io_hit.m_t=ts[l];
+          io_hit.m_u=us[l];
+          io_hit.m_v=vs[l];
+          io_hit.m_triangle=m_triangle[i+l];
+          found=true;
+        }
+      }
+      if(_any)
+      {
+        return true;
+      }
+    }
+    return found;
+  }
+#endif
+  for( ; i<end; ++i)
+  {
+    Real t;
+    Real u;
+    Real v;
+    if(triangleScalar(m_tri,i,_origin,_dir,_tMin,io_hit.m_t,t,u,v))
+    {
+      io_hit.m_t=t;
+      io_hit.m_u=u;
+      io_hit.m_v=v;
+      io_hit.m_triangle=m_triangle[i];
+      found=true;
+      if(_any)
+      {
+        return true;
+      }
+    }
+  }
+  return found;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool MeshBVH::trace(const Vec3 &_origin, const Vec3 &_dir, bool _any, Hit &io_hit) const noexcept
+{
+  if(m_nodes.empty())
+  {
+    return false;
+  }
+  const Real *o=_origin.m_openGL.data();
+  const Real *d=_dir.m_openGL.data();
+  Real inv[3];
+  inverse(d,inv);
+  const Real tMin=0.0f;
+  bool simd=activeSIMDLevel()!=SIMDLevel::SCALAR;
+#ifdef NGL_SIMD_X86
+  __m128 o4=_mm_set_ps(o[0],o[2],o[1],o[0]);
+  __m128 inv4=_mm_set_ps(inv[0],inv[2],inv[1],inv[0]);
+#endif
+  auto box=[&](uint32_t _node, Real &o_near)
+  {
+#ifdef NGL_SIMD_X86
+    if(simd)
+    {
+      return boxSSE(m_nodes[_node],o4,inv4,tMin,io_hit.m_t,o_near);
+    }
+#endif
+    return boxScalar(m_nodes[_node],o,inv,tMin,io_hit.m_t,o_near);
+  };
+  Real tNear;
+  if(!box(0,tNear))
+  {
+    return false;
+  }
+  uint32_t stack[c_stackSize];
+  size_t size=0;
+  uint32_t node=0;
+  bool found=false;
+  for(;;)
+  {
+    const Node &n=m_nodes[node];
+    if(n.m_count!=0)
+    {
+      if(intersectLeaf(o,d,n.m_index,n.m_count,tMin,_any,io_hit))
+      {
+        found=true;
+        if(_any)
+        {
+          return true;
+        }
+      }
+    }
+    else
+    {
+      uint32_t left=node+1;
+      uint32_t right=n.m_index;
+      Real tLeft;
+      Real tRight;
+      bool hitLeft=box(left,tLeft);
+      bool hitRight=box(right,tRight);
+      if(hitLeft && hitRight)
+      {
+        // the nearer child first so the farther is more likely to be skipped
+        if(tRight<tLeft)
+        {
+          std::swap(left,right);
+        }
+        stack[size++]=right;
+        node=left;
+        continue;
+      }
+      if(hitLeft || hitRight)
+      {
+        node=hitLeft ? left : right;
+        continue;
+      }
+    }
+    if(size==0)
+    {
+      break;
+    }
+    node=stack[--size];
+  }
+  return found;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool MeshBVH::closestHit(const Vec3 &_origin, const Vec3 &_dir, Hit &o_hit, Real _tMax) const noexcept
+{
+  Hit hit;
+  hit.m_t=_tMax;
+  if(trace(_origin,_dir,false,hit))
+  {
+    o_hit=hit;
+    return true;
+  }
+  return false;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool MeshBVH::anyHit(const Vec3 &_origin, const Vec3 &_dir, Real _tMax) const noexcept
+{
+  Hit hit;
+  hit.m_t=_tMax;
+  return trace(_origin,_dir,true,hit);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void MeshBVH::tracePacket(const Vec3 *_origins, const Vec3 *_dirs, Hit *io_hits) const noexcept
+{
+#ifdef NGL_SIMD_X86
+  // the 4 rays as x,y,z registers with one ray per lane
+  alignas(16) Real inv[3][4];
+  for(int r=0; r<4; ++r)
+  {
+    for(int k=0; k<3; ++k)
+    {
+      inv[k][r]=1.0f/_dirs[r].m_openGL[k];
+    }
+  }
+  __m128 o[3];
+  __m128 invDir[3];
+  for(int k=0; k<3; ++k)
+  {
+    o[k]=_mm_set_ps(_origins[3].m_openGL[k],_origins[2].m_openGL[k],_origins[1].m_openGL[k],_origins[0].m_openGL[k]);
+    invDir[k]=_mm_load_ps(inv[k]);
+  }
+  __m128 tMax=_mm_set_ps(io_hits[3].m_t,io_hits[2].m_t,io_hits[1].m_t,io_hits[0].m_t);
+  const __m128 tMin=_mm_setzero_ps();
+  // the mask of rays that hit a box
+  auto box=[&](uint32_t _node)
+  {
+    const Node &n=m_nodes[_node];
+    __m128 tNear=tMin;
+    __m128 tFar=tMax;
+    for(int k=0; k<3; ++k)
+    {
+      __m128 t1=_mm_mul_ps(_mm_sub_ps(_mm_set1_ps(n.m_min[k]),o[k]),invDir[k]);
+      __m128 t2=_mm_mul_ps(_mm_sub_ps(_mm_set1_ps(n.m_max[k]),o[k]),invDir[k]);
+      tNear=_mm_max_ps(tNear,_mm_min_ps(t1,t2));
+      tFar=_mm_min_ps(tFar,_mm_max_ps(t1,t2));
+    }
+    return _mm_movemask_ps(_mm_cmple_ps(tNear,tFar));
+  };
+  if(box(0)==0)
+  {
+    return;
+  }
+  uint32_t stack[c_stackSize];
+  size_t size=0;
+  uint32_t node=0;
+  int active=0xf;
+  for(;;)
+  {
+    const Node &n=m_nodes[node];
+    if(n.m_count!=0)
+    {
+      bool changed=false;
+      for(int r=0; r<4; ++r)
+      {
+        if(active>>r & 1)
+        {
+          changed|=intersectLeaf(_origins[r].m_openGL.data(),_dirs[r].m_openGL.data(),n.m_index,n.m_count,0.0f,false,io_hits[r]);
+        }
+      }
+      if(changed)
+      {
+        tMax=_mm_set_ps(io_hits[3].m_t,io_hits[2].m_t,io_hits[1].m_t,io_hits[0].m_t);
+      }
+    }
+    else
+    {
+      int left=box(node+1);
+      int right=box(n.m_index);
+      if(left!=0 && right!=0)
+      {
+        stack[size++]=n.m_index;
+        node=node+1;
+        active=left;
+        continue;
+      }
+      if(left!=0 || right!=0)
+      {
+        node=left!=0 ? node+1 : n.m_index;
+        active=left!=0 ? left : right;
+        continue;
+      }
+    }
+    if(size==0)
+    {
+      break;
+    }
+    // the rays that still reach the popped node now some may have closer hits
+    node=stack[--size];
+    active=box(node);
+  }
+#else
+  for(int r=0; r<4; ++r)
+  {
+    trace(_origins[r],_dirs[r],false,io_hits[r]);
+  }
+#endif
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void MeshBVH::closestHits(const Vec3 *_origins, const Vec3 *_dirs, size_t _count, Hit *o_hits, Real _tMax) const noexcept
+{
+  parallelFor(_count,c_grainRays,[this,_origins,_dirs,o_hits,_tMax](size_t _begin, size_t _end)
+  {
+    for(size_t i=_begin; i<_end; ++i)
+    {
+      o_hits[i]=Hit();
+      o_hits[i].m_t=_tMax;
+    }
+    size_t i=_begin;
+    if(activeSIMDLevel()!=SIMDLevel::SCALAR && !m_nodes.empty())
+    {
+      for( ; i+4<=_end; i+=4)
+      {
+        tracePacket(_origins+i,_dirs+i,o_hits+i);
+      }
+    }
+    for( ; i<_end; ++i)
+    {
+      trace(_origins[i],_dirs[i],false,o_hits[i]);
+    }
+    for(size_t r=_begin; r<_end; ++r)
+    {
+      if(o_hits[r].m_triangle==c_noHit)
+      {
+        o_hits[r].m_t=_tMax;
+      }
+    }
+  });
+}
+
+} // end namespace ngl
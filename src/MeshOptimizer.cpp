@@ -0,0 +1,407 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "MeshOptimizer.h"
+#include "NGLassert.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file MeshOptimizer.cpp
+/// @brief implementation files for the mesh index optimisations
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace ngl
+{
+
+namespace
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the lru cache simulated by the Forsyth scoring and its tuning values from the paper
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr int c_forsythCacheSize=32;
+  constexpr float c_cacheDecayPower=1.5f;
+  constexpr float c_lastTriScore=0.75f;
+  constexpr float c_valenceBoostScale=2.0f;
+  constexpr float c_valenceBoostPower=0.5f;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the valence part of the score is looked up for up to this many remaining triangles
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr uint32_t c_maxValence=64;
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the score tables, so the inner loop has no pow calls
+  //----------------------------------------------------------------------------------------------------------------------
+  struct ScoreTables
+  {
+    float m_cache[c_forsythCacheSize];
+    float m_valence[c_maxValence+1];
+
+    ScoreTables() noexcept
+    {
+      for(int i=0; i<c_forsythCacheSize; ++i)
+      {
+        // the last triangle's vertices get a fixed score so it is not simply repeated
+        m_cache[i]= i<3 ? c_lastTriScore :
+                          std::pow(1.0f-static_cast<float>(i-3)/static_cast<float>(c_forsythCacheSize-3),c_cacheDecayPower);
+      }
+      m_valence[0]=0.0f;
+      for(uint32_t i=1; i<=c_maxValence; ++i)
+      {
+        m_valence[i]=c_valenceBoostScale*std::pow(static_cast<float>(i),-c_valenceBoostPower);
+      }
+    }
+
+    float score(int _cachePos, uint32_t _remaining) const noexcept
+    {
+      if(_remaining==0)
+      {
+        return -1.0f;
+      }
+      float s= _cachePos>=0 ? m_cache[_cachePos] : 0.0f;
+      return s+m_valence[std::min(_remaining,c_maxValence)];
+    }
+  };
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a fifo cache simulated with a time stamp per vertex, a vertex is in the cache if fewer than the
+  /// cache size misses have happened since it was loaded
+  //----------------------------------------------------------------------------------------------------------------------
+  class FifoCache
+  {
+  public :
+    FifoCache(size_t _vertexCount, unsigned int _cacheSize) :
+      m_stamp(_vertexCount,0), m_time(_cacheSize+1), m_size(_cacheSize) {}
+
+    // true if _v was not in the cache, it then is
+    bool miss(uint32_t _v) noexcept
+    {
+      if(m_time-m_stamp[_v]>m_size)
+      {
+        m_stamp[_v]=m_time++;
+        return true;
+      }
+      return false;
+    }
+
+    unsigned int missTriangle(const uint32_t *_tri) noexcept
+    {
+      return unsigned(miss(_tri[0]))+unsigned(miss(_tri[1]))+unsigned(miss(_tri[2]));
+    }
+
+    // empty the cache
+    void flush() noexcept {m_time+=m_size+1;}
+
+  private :
+    std::vector<uint32_t> m_stamp;
+    uint32_t m_time;
+    uint32_t m_size;
+  };
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+VertexCacheStats analyzeVertexCache(const uint32_t *_indices, size_t _indexCount, size_t _vertexCount, unsigned int _cacheSize)
+{
+  NGL_ASSERT(_indexCount%3==0);
+  VertexCacheStats stats;
+  FifoCache cache(_vertexCount,_cacheSize);
+  std::vector<unsigned char> used(_vertexCount,0);
+  size_t usedCount=0;
+  for(size_t i=0; i<_indexCount; ++i)
+  {
+    uint32_t v=_indices[i];
+    NGL_ASSERT(v<_vertexCount);
+    stats.m_misses+=cache.miss(v);
+    if(!used[v])
+    {
+      used[v]=1;
+      ++usedCount;
+    }
+  }
+  if(_indexCount>0)
+  {
+    stats.m_acmr=static_cast<Real>(stats.m_misses)/static_cast<Real>(_indexCount/3);
+    stats.m_atvr=static_cast<Real>(stats.m_misses)/static_cast<Real>(usedCount);
+  }
+  return stats;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void optimizeVertexCache(uint32_t *io_indices, size_t _indexCount, size_t _vertexCount)
+{
+  NGL_ASSERT(_indexCount%3==0);
+  size_t triCount=_indexCount/3;
+  if(triCount==0)
+  {
+    return;
+  }
+  static const ScoreTables tables;
+
+  // the triangles using each vertex, vertex v has m_remaining[v] live entries from m_adjacency[m_offset[v]]
+  std::vector<uint32_t> remaining(_vertexCount,0);
+  for(size_t i=0; i<_indexCount; ++i)
+  {
+    NGL_ASSERT(io_indices[i]<_vertexCount);
+    ++remaining[io_indices[i]];
+  }
+  std::vector<uint32_t> offset(_vertexCount+1,0);
+  for(size_t v=0; v<_vertexCount; ++v)
+  {
+    offset[v+1]=offset[v]+remaining[v];
+  }
+  std::vector<uint32_t> adjacency(_indexCount);
+  {
+    std::vector<uint32_t> fill(offset.begin(),offset.end()-1);
+    for(size_t i=0; i<_indexCount; ++i)
+    {
+      adjacency[fill[io_indices[i]]++]=static_cast<uint32_t>(i/3);
+    }
+  }
+
+  std::vector<int> cachePos(_vertexCount,-1);
+  std::vector<float> vertexScore(_vertexCount);
+  for(size_t v=0; v<_vertexCount; ++v)
+  {
+    vertexScore[v]=tables.score(-1,remaining[v]);
+  }
+  std::vector<float> triScore(triCount);
+  for(size_t t=0; t<triCount; ++t)
+  {
+    const uint32_t *tri=&io_indices[t*3];
+    triScore[t]=vertexScore[tri[0]]+vertexScore[tri[1]]+vertexScore[tri[2]];
+  }
+  std::vector<unsigned char> emitted(triCount,0);
+  std::vector<uint32_t> output;
+  output.reserve(_indexCount);
+
+  uint32_t cache[c_forsythCacheSize+3];
+  uint32_t newCache[c_forsythCacheSize+3];
+  int cacheCount=0;
+  size_t cursor=0;
+  long best=-1;
+  for(size_t emittedCount=0; emittedCount<triCount; ++emittedCount)
+  {
+    if(best<0)
+    {
+      // nothing in the cache has triangles left so carry on from the next unused triangle in the input
+      while(emitted[cursor])
+      {
+        ++cursor;
+      }
+      best=static_cast<long>(cursor);
+    }
+    const uint32_t *tri=&io_indices[static_cast<size_t>(best)*3];
+    output.insert(output.end(),tri,tri+3);
+    emitted[static_cast<size_t>(best)]=1;
+
+    // take the triangle out of its vertices' lists
+    for(int k=0; k<3; ++k)
+    {
+      uint32_t v=tri[k];
+      uint32_t *list=&adjacency[offset[v]];
+      uint32_t count=remaining[v];
+      for(uint32_t j=0; j<count; ++j)
+      {
+        if(list[j]==static_cast<uint32_t>(best))
+        {
+          list[j]=list[count-1];
+          --remaining[v];
+          break;
+        }
+      }
+    }
+
+    // the triangle's vertices go to the front of the lru cache, the rest move back
+    int newCount=0;
+    for(int k=0; k<3; ++k)
+    {
+      if(std::find(newCache,newCache+newCount,tri[k])==newCache+newCount)
+      {
+        newCache[newCount++]=tri[k];
+      }
+    }
+    for(int i=0; i<cacheCount; ++i)
+    {
+      uint32_t v=cache[i];
+      if(v!=tri[0] && v!=tri[1] && v!=tri[2])
+      {
+        newCache[newCount++]=v;
+      }
+    }
+    for(int i=0; i<newCount; ++i)
+    {
+      uint32_t v=newCache[i];
+      cachePos[v]= i<c_forsythCacheSize ? i : -1;
+      vertexScore[v]=tables.score(cachePos[v],remaining[v]);
+    }
+
+    // rescore the triangles touching the changed vertices, the next one is the best using a cached vertex
+    best=-1;
+    float bestScore=-1.0f;
+    for(int i=0; i<newCount; ++i)
+    {
+      uint32_t v=newCache[i];
+      const uint32_t *list=&adjacency[offset[v]];
+      for(uint32_t j=0; j<remaining[v]; ++j)
+      {
+        uint32_t t=list[j];
+        const uint32_t *other=&io_indices[t*3];
+        float s=vertexScore[other[0]]+vertexScore[other[1]]+vertexScore[other[2]];
+        triScore[t]=s;
+        if(i<c_forsythCacheSize && s>bestScore)
+        {
+          bestScore=s;
+          best=static_cast<long>(t);
+        }
+      }
+    }
+    cacheCount=std::min(newCount,c_forsythCacheSize);
+    std::copy(newCache,newCache+cacheCount,cache);
+  }
+  std::copy(output.begin(),output.end(),io_indices);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void optimizeOverdraw(uint32_t *io_indices, size_t _indexCount, const Vec3 *_positions, size_t _vertexCount, Real _threshold)
+{
+  NGL_ASSERT(_indexCount%3==0);
+  size_t triCount=_indexCount/3;
+  if(triCount==0)
+  {
+    return;
+  }
+  // hard boundaries where the cache order restarts, every vertex of the triangle misses
+  std::vector<size_t> hard;
+  {
+    FifoCache cache(_vertexCount,c_vertexCacheSize);
+    for(size_t t=0; t<triCount; ++t)
+    {
+      if(cache.missTriangle(&io_indices[t*3])==3 || t==0)
+      {
+        hard.push_back(t);
+      }
+    }
+    hard.push_back(triCount);
+  }
+
+  // split each of those where the miss ratio since the last split is within the threshold of the whole
+  // cluster's, starting each split with an empty cache so the clusters can go in any order
+  std::vector<size_t> clusters;
+  {
+    FifoCache cache(_vertexCount,c_vertexCacheSize);
+    for(size_t h=0; h+1<hard.size(); ++h)
+    {
+      size_t begin=hard[h];
+      size_t end=hard[h+1];
+      cache.flush();
+      size_t misses=0;
+      for(size_t t=begin; t<end; ++t)
+      {
+        misses+=cache.missTriangle(&io_indices[t*3]);
+      }
+      Real target=static_cast<Real>(misses)/static_cast<Real>(end-begin)*_threshold;
+      cache.flush();
+      clusters.push_back(begin);
+      size_t start=begin;
+      misses=0;
+      for(size_t t=begin; t<end; ++t)
+      {
+        misses+=cache.missTriangle(&io_indices[t*3]);
+        if(t+1<end && static_cast<Real>(misses)/static_cast<Real>(t+1-start)<=target)
+        {
+          cache.flush();
+          clusters.push_back(t+1);
+          start=t+1;
+          misses=0;
+        }
+      }
+    }
+    clusters.push_back(triCount);
+  }
+
+  // the area weighted centre of the mesh and of each cluster with the cluster's average normal
+  size_t clusterCount=clusters.size()-1;
+  std::vector<Vec3> centroid(clusterCount,Vec3(0.0f,0.0f,0.0f));
+  std::vector<Vec3> normal(clusterCount,Vec3(0.0f,0.0f,0.0f));
+  std::vector<Real> area(clusterCount,0.0f);
+  Vec3 meshCentroid(0.0f,0.0f,0.0f);
+  Real meshArea=0.0f;
+  for(size_t c=0; c<clusterCount; ++c)
+  {
+    for(size_t t=clusters[c]; t<clusters[c+1]; ++t)
+    {
+      const uint32_t *tri=&io_indices[t*3];
+      const Vec3 &a=_positions[tri[0]];
+      const Vec3 &b=_positions[tri[1]];
+      const Vec3 &p=_positions[tri[2]];
+      Vec3 n=(b-a).cross(p-a);
+      Real triArea=n.length();
+      normal[c]+=n;
+      centroid[c]+=(a+b+p)*(triArea/3.0f);
+      area[c]+=triArea;
+    }
+    meshCentroid+=centroid[c];
+    meshArea+=area[c];
+  }
+  if(meshArea>0.0f)
+  {
+    meshCentroid/=meshArea;
+  }
+  // clusters facing away from the centre are on the outside so go first
+  std::vector<Real> key(clusterCount,0.0f);
+  for(size_t c=0; c<clusterCount; ++c)
+  {
+    Real len=normal[c].length();
+    if(area[c]>0.0f && len>0.0f)
+    {
+      key[c]=(centroid[c]/area[c]-meshCentroid).dot(normal[c])/len;
+    }
+  }
+  std::vector<size_t> order(clusterCount);
+  for(size_t c=0; c<clusterCount; ++c)
+  {
+    order[c]=c;
+  }
+  std::stable_sort(order.begin(),order.end(),[&key](size_t _a, size_t _b){ return key[_a]>key[_b]; });
+
+  std::vector<uint32_t> output;
+  output.reserve(_indexCount);
+  for(size_t c : order)
+  {
+    output.insert(output.end(),io_indices+clusters[c]*3,io_indices+clusters[c+1]*3);
+  }
+  std::copy(output.begin(),output.end(),io_indices);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+size_t optimizeVertexFetch(uint32_t *io_indices, size_t _indexCount, size_t _vertexCount, uint32_t *o_remap)
+{
+  std::fill(o_remap,o_remap+_vertexCount,~0u);
+  uint32_t next=0;
+  for(size_t i=0; i<_indexCount; ++i)
+  {
+    uint32_t &index=io_indices[i];
+    NGL_ASSERT(index<_vertexCount);
+    if(o_remap[index]==~0u)
+    {
+      o_remap[index]=next++;
+    }
+    index=o_remap[index];
+  }
+  return next;
+}
+
+} // end namespace ngl
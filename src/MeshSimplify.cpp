@@ -0,0 +1,898 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "MeshSimplify.h"
+#include "Bounds3.h"
+#include "NGLassert.h"
+#include "ParallelFor.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file MeshSimplify.cpp
+/// @brief implementation files for the mesh simplification
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace ngl
+{
+
+namespace
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the largest quadric is over position, normal and uv
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr size_t c_maxDim=8;
+  constexpr size_t c_packedSize=c_maxDim*(c_maxDim+1)/2;
+  constexpr uint32_t c_none=~uint32_t(0);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the most vertices sharing a position that are collapsed together
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr size_t c_maxWedges=16;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the weight of the planes keeping an open border in place against the triangle planes
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr double c_borderWeight=10.0;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a collapse is skipped if it turns a triangle normal by more than 60 degrees, which also stops
+  /// slivers standing up off the surface
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr Real c_flipLimit=0.5f;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief each pass tries the cheapest 1 / c_passFraction of the possible collapses
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr size_t c_passFraction=4;
+  constexpr size_t c_grainSize=4096;
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the index of A(i,j) with i <= j in the packed upper triangle
+  //----------------------------------------------------------------------------------------------------------------------
+  inline size_t packed(size_t _i, size_t _j) noexcept
+  {
+    return _i*c_maxDim-(_i*(_i-1))/2+(_j-_i);
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the error x^T A x + 2 b.x + c of a point x, A symmetric
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Quadric
+  {
+    float m_a[c_packedSize];
+    float m_b[c_maxDim];
+    float m_c;
+
+    Quadric &operator+=(const Quadric &_q) noexcept
+    {
+      for(size_t i=0; i<c_packedSize; ++i)
+      {
+        m_a[i]+=_q.m_a[i];
+      }
+      for(size_t i=0; i<c_maxDim; ++i)
+      {
+        m_b[i]+=_q.m_b[i];
+      }
+      m_c+=_q.m_c;
+      return *this;
+    }
+
+    double eval(const float *_x, size_t _dim) const noexcept
+    {
+      double r=m_c;
+      for(size_t i=0; i<_dim; ++i)
+      {
+        double xi=_x[i];
+        double row=m_a[packed(i,i)]*xi;
+        for(size_t j=i+1; j<_dim; ++j)
+        {
+          row+=2.0*m_a[packed(i,j)]*_x[j];
+        }
+        r+=xi*(row+2.0*m_b[i]);
+      }
+      // rounding in the float sums can take a perfect fit just below 0
+      return std::max(r,0.0);
+    }
+  };
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the same over just the position in double, the geometric error is the square root so the
+  /// rounding of a float quadric would stop flat areas ever reaching 0
+  //----------------------------------------------------------------------------------------------------------------------
+  struct PositionQuadric
+  {
+    double m_a[6]={0.0,0.0,0.0,0.0,0.0,0.0};
+    double m_b[3]={0.0,0.0,0.0};
+    double m_c=0.0;
+    double m_weight=0.0;
+
+    PositionQuadric &operator+=(const PositionQuadric &_q) noexcept
+    {
+      for(size_t i=0; i<6; ++i)
+      {
+        m_a[i]+=_q.m_a[i];
+      }
+      for(size_t i=0; i<3; ++i)
+      {
+        m_b[i]+=_q.m_b[i];
+      }
+      m_c+=_q.m_c;
+      m_weight+=_q.m_weight;
+      return *this;
+    }
+
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief add the squared distance to the plane n.p + d = 0 (n unit length)
+    //----------------------------------------------------------------------------------------------------------------------
+    void addPlane(const double *_n, double _d, double _weight) noexcept
+    {
+      m_a[0]+=_weight*_n[0]*_n[0];
+      m_a[1]+=_weight*_n[0]*_n[1];
+      m_a[2]+=_weight*_n[0]*_n[2];
+      m_a[3]+=_weight*_n[1]*_n[1];
+      m_a[4]+=_weight*_n[1]*_n[2];
+      m_a[5]+=_weight*_n[2]*_n[2];
+      for(size_t i=0; i<3; ++i)
+      {
+        m_b[i]+=_weight*_d*_n[i];
+      }
+      m_c+=_weight*_d*_d;
+      m_weight+=_weight;
+    }
+
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the weighted mean squared distance to the planes
+    //----------------------------------------------------------------------------------------------------------------------
+    double eval(const float *_x) const noexcept
+    {
+      double x=_x[0];
+      double y=_x[1];
+      double z=_x[2];
+      double r=m_a[0]*x*x+m_a[3]*y*y+m_a[5]*z*z+2.0*(m_a[1]*x*y+m_a[2]*x*z+m_a[4]*y*z)
+              +2.0*(m_b[0]*x+m_b[1]*y+m_b[2]*z)+m_c;
+      return m_weight>0.0 ? std::max(r,0.0)/m_weight : 0.0;
+    }
+  };
+
+  Quadric zeroQuadric() noexcept
+  {
+    Quadric q;
+    std::memset(&q,0,sizeof(q));
+    return q;
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the quadric of the distance to the plane through 3 points in _dim dimensions (Garland and
+  /// Heckbert 1998), A = I - e1 e1^T - e2 e2^T for orthonormal e1, e2 in the plane
+  //----------------------------------------------------------------------------------------------------------------------
+  bool triangleQuadric(const float *_p0, const float *_p1, const float *_p2, size_t _dim, double _weight, Quadric &o_q) noexcept
+  {
+    double e1[c_maxDim];
+    double e2[c_maxDim];
+    double l1=0.0;
+    for(size_t i=0; i<_dim; ++i)
+    {
+      e1[i]=double(_p1[i])-_p0[i];
+      l1+=e1[i]*e1[i];
+    }
+    if(l1<=0.0)
+    {
+      return false;
+    }
+    l1=1.0/std::sqrt(l1);
+    double d=0.0;
+    for(size_t i=0; i<_dim; ++i)
+    {
+      e1[i]*=l1;
+      e2[i]=double(_p2[i])-_p0[i];
+      d+=e1[i]*e2[i];
+    }
+    double l2=0.0;
+    for(size_t i=0; i<_dim; ++i)
+    {
+      e2[i]-=d*e1[i];
+      l2+=e2[i]*e2[i];
+    }
+    if(l2<=1.0e-20)
+    {
+      return false;
+    }
+    l2=1.0/std::sqrt(l2);
+    double pe1=0.0;
+    double pe2=0.0;
+    double pp=0.0;
+    for(size_t i=0; i<_dim; ++i)
+    {
+      e2[i]*=l2;
+      pe1+=_p0[i]*e1[i];
+      pe2+=_p0[i]*e2[i];
+      pp+=double(_p0[i])*_p0[i];
+    }
+    o_q=zeroQuadric();
+    for(size_t i=0; i<_dim; ++i)
+    {
+      for(size_t j=i; j<_dim; ++j)
+      {
+        o_q.m_a[packed(i,j)]=static_cast<float>(_weight*((i==j ? 1.0 : 0.0)-e1[i]*e1[j]-e2[i]*e2[j]));
+      }
+      o_q.m_b[i]=static_cast<float>(_weight*(pe1*e1[i]+pe2*e2[i]-_p0[i]));
+    }
+    o_q.m_c=static_cast<float>(_weight*(pp-pe1*pe1-pe2*pe2));
+    return true;
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add the squared distance to the plane n.p + d = 0 (n unit length) over the position part
+  //----------------------------------------------------------------------------------------------------------------------
+  void addPlane(Quadric &io_q, const double *_n, double _d, double _weight) noexcept
+  {
+    for(size_t i=0; i<3; ++i)
+    {
+      for(size_t j=i; j<3; ++j)
+      {
+        io_q.m_a[packed(i,j)]+=static_cast<float>(_weight*_n[i]*_n[j]);
+      }
+      io_q.m_b[i]+=static_cast<float>(_weight*_d*_n[i]);
+    }
+    io_q.m_c+=static_cast<float>(_weight*_d*_d);
+  }
+
+  inline uint64_t edgeKey(uint32_t _a, uint32_t _b) noexcept
+  {
+    return _a<_b ? (uint64_t(_a)<<32) | _b : (uint64_t(_b)<<32) | _a;
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the shared setup (welded positions, scaled attributes and starting quadrics) that each
+  /// simplification of the mesh runs from, run is const so several targets can be built at once
+  //----------------------------------------------------------------------------------------------------------------------
+  class Simplifier
+  {
+  public :
+    Simplifier(const uint32_t *_indices, size_t _indexCount, const Vec3 *_positions, const Vec3 *_normals,
+               const Vec3 *_uvs, size_t _vertexCount, const SimplifyOptions &_options);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief simplify to _targetIndexCount indices, o_error is the largest relative geometric error
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t run(size_t _targetIndexCount, bool _parallel, uint32_t *o_indices, Real &o_error) const;
+    Real scale() const noexcept {return m_scale;}
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief moving every vertex at position m_from onto the neighbouring position m_to
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Collapse
+    {
+      uint32_t m_from;
+      uint32_t m_to;
+      float m_cost;
+      float m_error;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the state of one run
+    //----------------------------------------------------------------------------------------------------------------------
+    struct State
+    {
+      std::vector<uint32_t> m_indices;
+      std::vector<Quadric> m_vertexQuadric;
+      std::vector<PositionQuadric> m_positionQuadric;
+      // the triangles around each position, triangles of position p are m_tris[m_triStart[p],m_triStart[p+1])
+      std::vector<uint32_t> m_triStart;
+      std::vector<uint32_t> m_tris;
+      // the undirected position edges of every triangle, sorted so the triangles on an edge can be counted
+      std::vector<uint64_t> m_edges;
+    };
+    const float *attr(uint32_t _v) const noexcept {return &m_attr[size_t(_v)*m_dim];}
+    void buildAdjacency(State &io_state) const;
+    size_t edgeCount(const State &_state, uint32_t _a, uint32_t _b) const noexcept;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief pair each vertex at _from with the vertex at _to it shares a triangle with, false if one has
+    /// none or two different ones (so the collapse would cross a seam)
+    //----------------------------------------------------------------------------------------------------------------------
+    bool wedgeMap(const State &_state, uint32_t _from, uint32_t _to, uint32_t *o_from, uint32_t *o_to, size_t &o_count) const noexcept;
+    void evaluate(const State &_state, Collapse &io_c) const noexcept;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief false if the collapse changes the topology (the positions next to both ends must be the
+    /// corners opposite the edge) or flips a triangle, o_neighbours gets the positions around _c.m_from
+    //----------------------------------------------------------------------------------------------------------------------
+    bool isValid(const State &_state, const Collapse &_c, std::vector<uint32_t> &o_neighbours, std::vector<uint32_t> &io_scratch) const;
+
+    size_t m_dim;
+    Real m_scale;
+    bool m_lockBorder;
+    Real m_maxError;
+    std::vector<uint32_t> m_indices;
+    // the first vertex with the same position as each vertex, used as the position id
+    std::vector<uint32_t> m_position;
+    // the normalised position followed by the weighted normal and uv of each vertex
+    std::vector<float> m_attr;
+    std::vector<Quadric> m_vertexQuadric;
+    std::vector<PositionQuadric> m_positionQuadric;
+  };
+
+  //----------------------------------------------------------------------------------------------------------------------
+  Simplifier::Simplifier(const uint32_t *_indices, size_t _indexCount, const Vec3 *_positions, const Vec3 *_normals,
+                         const Vec3 *_uvs, size_t _vertexCount, const SimplifyOptions &_options) :
+    m_lockBorder(_options.m_lockBorder),
+    m_maxError(_options.m_maxError),
+    m_indices(_indices,_indices+_indexCount)
+  {
+    NGL_ASSERT(_indexCount%3==0);
+    bool useNormals=_normals!=nullptr && _options.m_normalWeight>0.0f;
+    bool useUVs=_uvs!=nullptr && _options.m_uvWeight>0.0f;
+    m_dim=3+(useNormals ? 3 : 0)+(useUVs ? 2 : 0);
+    Bounds3 box=Bounds3::fromPoints(_positions,_vertexCount);
+    m_scale=1.0f;
+    if(!box.isEmpty())
+    {
+      Vec3 size=box.size();
+      m_scale=std::max(size.m_x,std::max(size.m_y,size.m_z));
+      if(m_scale<=0.0f)
+      {
+        m_scale=1.0f;
+      }
+    }
+    Real invScale=1.0f/m_scale;
+    m_attr.resize(_vertexCount*m_dim);
+    m_position.resize(_vertexCount);
+    std::unordered_map<uint64_t,std::vector<uint32_t>> welded;
+    welded.reserve(_vertexCount);
+    for(size_t v=0; v<_vertexCount; ++v)
+    {
+      float *a=&m_attr[v*m_dim];
+      Vec3 p=(_positions[v]-box.m_min)*invScale;
+      a[0]=p.m_x;
+      a[1]=p.m_y;
+      a[2]=p.m_z;
+      size_t d=3;
+      if(useNormals)
+      {
+        a[d++]=_normals[v].m_x*_options.m_normalWeight;
+        a[d++]=_normals[v].m_y*_options.m_normalWeight;
+        a[d++]=_normals[v].m_z*_options.m_normalWeight;
+      }
+      if(useUVs)
+      {
+        a[d++]=_uvs[v].m_x*_options.m_uvWeight;
+        a[d++]=_uvs[v].m_y*_options.m_uvWeight;
+      }
+      // vertices with exactly the same position are one position, hashed on the bits
+      uint32_t bits[3];
+      std::memcpy(bits,&_positions[v].m_x,sizeof(bits));
+      uint64_t h=(uint64_t(bits[0])*0x9E3779B97F4A7C15ull)^(uint64_t(bits[1])*0xC2B2AE3D27D4EB4Full)^(uint64_t(bits[2])*0x165667B19E3779F9ull);
+      auto &bucket=welded[h];
+      m_position[v]=static_cast<uint32_t>(v);
+      for(auto w : bucket)
+      {
+        if(std::memcmp(&_positions[w].m_x,&_positions[v].m_x,sizeof(bits))==0)
+        {
+          m_position[v]=w;
+          break;
+        }
+      }
+      if(m_position[v]==v)
+      {
+        bucket.push_back(static_cast<uint32_t>(v));
+      }
+    }
+    // triangles with two corners at one position are already invisible and would confuse the collapses
+    size_t out=0;
+    for(size_t t=0; t<_indexCount; t+=3)
+    {
+      uint32_t a=m_position[m_indices[t]];
+      uint32_t b=m_position[m_indices[t+1]];
+      uint32_t c=m_position[m_indices[t+2]];
+      if(a!=b && b!=c && a!=c)
+      {
+        std::copy(&m_indices[t],&m_indices[t]+3,&m_indices[out]);
+        out+=3;
+      }
+    }
+    m_indices.resize(out);
+    _indexCount=out;
+    // each triangle adds its quadric to its corners, weighted by area
+    m_vertexQuadric.assign(_vertexCount,zeroQuadric());
+    m_positionQuadric.assign(_vertexCount,PositionQuadric());
+    Quadric q;
+    for(size_t t=0; t<_indexCount; t+=3)
+    {
+      const float *a=attr(m_indices[t]);
+      const float *b=attr(m_indices[t+1]);
+      const float *c=attr(m_indices[t+2]);
+      Vec3 n=(Vec3(b[0],b[1],b[2])-Vec3(a[0],a[1],a[2])).cross(Vec3(c[0],c[1],c[2])-Vec3(a[0],a[1],a[2]));
+      double area=0.5*n.length();
+      if(triangleQuadric(a,b,c,m_dim,area,q))
+      {
+        for(size_t k=0; k<3; ++k)
+        {
+          m_vertexQuadric[m_indices[t+k]]+=q;
+        }
+      }
+      if(area>0.0)
+      {
+        double plane[3]={n.m_x/(2.0*area),n.m_y/(2.0*area),n.m_z/(2.0*area)};
+        double d=-(plane[0]*a[0]+plane[1]*a[1]+plane[2]*a[2]);
+        for(size_t k=0; k<3; ++k)
+        {
+          m_positionQuadric[m_position[m_indices[t+k]]].addPlane(plane,d,area);
+        }
+      }
+    }
+    if(m_lockBorder)
+    {
+      return;
+    }
+    // a border that can move is held to the planes through each open edge at right angles to its triangle
+    std::vector<uint64_t> edges;
+    edges.reserve(_indexCount);
+    for(size_t i=0; i<_indexCount; ++i)
+    {
+      edges.push_back(edgeKey(m_position[m_indices[i]],m_position[m_indices[i-i%3+(i+1)%3]]));
+    }
+    std::sort(edges.begin(),edges.end());
+    for(size_t t=0; t<_indexCount; t+=3)
+    {
+      for(size_t k=0; k<3; ++k)
+      {
+        uint32_t va=m_indices[t+k];
+        uint32_t vb=m_indices[t+(k+1)%3];
+        uint64_t key=edgeKey(m_position[va],m_position[vb]);
+        auto range=std::equal_range(edges.begin(),edges.end(),key);
+        if(range.second-range.first!=1)
+        {
+          continue;
+        }
+        const float *a=attr(va);
+        const float *b=attr(vb);
+        const float *c=attr(m_indices[t+(k+2)%3]);
+        Vec3 edge(b[0]-a[0],b[1]-a[1],b[2]-a[2]);
+        Vec3 normal=edge.cross(Vec3(c[0]-a[0],c[1]-a[1],c[2]-a[2]));
+        Vec3 m=edge.cross(normal);
+        if(m.lengthSquared()<=0.0f)
+        {
+          continue;
+        }
+        m.normalize();
+        double n[3]={m.m_x,m.m_y,m.m_z};
+        double d=-(n[0]*a[0]+n[1]*a[1]+n[2]*a[2]);
+        double weight=c_borderWeight*edge.lengthSquared();
+        addPlane(m_vertexQuadric[va],n,d,weight);
+        addPlane(m_vertexQuadric[vb],n,d,weight);
+        m_positionQuadric[m_position[va]].addPlane(n,d,weight);
+        m_positionQuadric[m_position[vb]].addPlane(n,d,weight);
+      }
+    }
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  void Simplifier::buildAdjacency(State &io_state) const
+  {
+    const auto &indices=io_state.m_indices;
+    size_t count=m_position.size();
+    io_state.m_triStart.assign(count+1,0);
+    for(auto i : indices)
+    {
+      ++io_state.m_triStart[m_position[i]+1];
+    }
+    for(size_t p=0; p<count; ++p)
+    {
+      io_state.m_triStart[p+1]+=io_state.m_triStart[p];
+    }
+    io_state.m_tris.resize(indices.size());
+    std::vector<uint32_t> fill(io_state.m_triStart.begin(),io_state.m_triStart.end()-1);
+    io_state.m_edges.clear();
+    for(size_t i=0; i<indices.size(); ++i)
+    {
+      io_state.m_tris[fill[m_position[indices[i]]]++]=static_cast<uint32_t>(i/3);
+      io_state.m_edges.push_back(edgeKey(m_position[indices[i]],m_position[indices[i-i%3+(i+1)%3]]));
+    }
+    std::sort(io_state.m_edges.begin(),io_state.m_edges.end());
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t Simplifier::edgeCount(const State &_state, uint32_t _a, uint32_t _b) const noexcept
+  {
+    auto range=std::equal_range(_state.m_edges.begin(),_state.m_edges.end(),edgeKey(_a,_b));
+    return static_cast<size_t>(range.second-range.first);
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  bool Simplifier::wedgeMap(const State &_state, uint32_t _from, uint32_t _to, uint32_t *o_from, uint32_t *o_to, size_t &o_count) const noexcept
+  {
+    o_count=0;
+    for(uint32_t i=_state.m_triStart[_from]; i<_state.m_triStart[_from+1]; ++i)
+    {
+      const uint32_t *tri=&_state.m_indices[size_t(_state.m_tris[i])*3];
+      uint32_t v=c_none;
+      uint32_t u=c_none;
+      for(size_t k=0; k<3; ++k)
+      {
+        uint32_t p=m_position[tri[k]];
+        if(p==_from)
+        {
+          v=tri[k];
+        }
+        else if(p==_to)
+        {
+          u=tri[k];
+        }
+      }
+      size_t w=0;
+      while(w<o_count && o_from[w]!=v)
+      {
+        ++w;
+      }
+      if(w==o_count)
+      {
+        if(o_count==c_maxWedges)
+        {
+          return false;
+        }
+        o_from[o_count]=v;
+        o_to[o_count++]=u;
+      }
+      else if(u!=c_none)
+      {
+        if(o_to[w]==c_none)
+        {
+          o_to[w]=u;
+        }
+        else if(o_to[w]!=u)
+        {
+          return false;
+        }
+      }
+    }
+    for(size_t w=0; w<o_count; ++w)
+    {
+      if(o_to[w]==c_none)
+      {
+        return false;
+      }
+    }
+    return o_count>0;
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  void Simplifier::evaluate(const State &_state, Collapse &io_c) const noexcept
+  {
+    io_c.m_cost=std::numeric_limits<float>::infinity();
+    uint32_t from[c_maxWedges];
+    uint32_t to[c_maxWedges];
+    size_t count;
+    if(!wedgeMap(_state,io_c.m_from,io_c.m_to,from,to,count))
+    {
+      return;
+    }
+    // the merged quadric of every vertex moving onto each target at that target
+    double cost=0.0;
+    for(size_t w=0; w<count; ++w)
+    {
+      bool first=true;
+      for(size_t k=0; k<w; ++k)
+      {
+        first&= to[k]!=to[w];
+      }
+      if(!first)
+      {
+        continue;
+      }
+      Quadric q=_state.m_vertexQuadric[to[w]];
+      for(size_t k=w; k<count; ++k)
+      {
+        if(to[k]==to[w])
+        {
+          q+=_state.m_vertexQuadric[from[k]];
+        }
+      }
+      cost+=q.eval(attr(to[w]),m_dim);
+    }
+    PositionQuadric p=_state.m_positionQuadric[io_c.m_from];
+    p+=_state.m_positionQuadric[io_c.m_to];
+    io_c.m_cost=static_cast<float>(cost);
+    io_c.m_error=static_cast<float>(std::sqrt(p.eval(attr(io_c.m_to))));
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  bool Simplifier::isValid(const State &_state, const Collapse &_c, std::vector<uint32_t> &o_neighbours, std::vector<uint32_t> &io_scratch) const
+  {
+    const float *target=attr(_c.m_to);
+    Vec3 q(target[0],target[1],target[2]);
+    o_neighbours.clear();
+    io_scratch.clear();
+    size_t shared=0;
+    for(uint32_t i=_state.m_triStart[_c.m_from]; i<_state.m_triStart[_c.m_from+1]; ++i)
+    {
+      const uint32_t *tri=&_state.m_indices[size_t(_state.m_tris[i])*3];
+      uint32_t p[3]={m_position[tri[0]],m_position[tri[1]],m_position[tri[2]]};
+      bool hasTo=p[0]==_c.m_to || p[1]==_c.m_to || p[2]==_c.m_to;
+      for(size_t k=0; k<3; ++k)
+      {
+        if(p[k]!=_c.m_from)
+        {
+          o_neighbours.push_back(p[k]);
+        }
+      }
+      if(hasTo)
+      {
+        ++shared;
+        continue;
+      }
+      // the triangles that stay must not flip
+      Vec3 v[3];
+      Vec3 moved[3];
+      for(size_t k=0; k<3; ++k)
+      {
+        const float *a=attr(p[k]);
+        v[k].set(a[0],a[1],a[2]);
+        moved[k]= p[k]==_c.m_from ? q : v[k];
+      }
+      Vec3 n0=(v[1]-v[0]).cross(v[2]-v[0]);
+      Vec3 n1=(moved[1]-moved[0]).cross(moved[2]-moved[0]);
+      Real l0=n0.length();
+      if(l0>0.0f && n0.dot(n1)<=c_flipLimit*l0*n1.length())
+      {
+        return false;
+      }
+    }
+    // the link condition, the only positions next to both ends are those opposite the collapsed edge
+    std::sort(o_neighbours.begin(),o_neighbours.end());
+    o_neighbours.erase(std::unique(o_neighbours.begin(),o_neighbours.end()),o_neighbours.end());
+    for(uint32_t i=_state.m_triStart[_c.m_to]; i<_state.m_triStart[_c.m_to+1]; ++i)
+    {
+      const uint32_t *tri=&_state.m_indices[size_t(_state.m_tris[i])*3];
+      for(size_t k=0; k<3; ++k)
+      {
+        uint32_t p=m_position[tri[k]];
+        if(p!=_c.m_to && p!=_c.m_from && std::binary_search(o_neighbours.begin(),o_neighbours.end(),p))
+        {
+          io_scratch.push_back(p);
+        }
+      }
+    }
+    std::sort(io_scratch.begin(),io_scratch.end());
+    size_t common=static_cast<size_t>(std::unique(io_scratch.begin(),io_scratch.end())-io_scratch.begin());
+    return shared>0 && common==shared;
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t Simplifier::run(size_t _targetIndexCount, bool _parallel, uint32_t *o_indices, Real &o_error) const
+  {
+    State state;
+    state.m_indices=m_indices;
+    state.m_vertexQuadric=m_vertexQuadric;
+    state.m_positionQuadric=m_positionQuadric;
+    size_t vertexCount=m_position.size();
+    std::vector<uint32_t> remap(vertexCount);
+    for(size_t v=0; v<vertexCount; ++v)
+    {
+      remap[v]=static_cast<uint32_t>(v);
+    }
+    std::vector<unsigned char> flags(vertexCount);
+    std::vector<unsigned char> touched(vertexCount);
+    std::vector<Collapse> collapses;
+    std::vector<uint32_t> order;
+    std::vector<uint32_t> neighbours;
+    std::vector<uint32_t> scratch;
+    enum : unsigned char {BORDER=1, LOCKED=2};
+    double maxError=0.0;
+    size_t triangles=state.m_indices.size()/3;
+    size_t target=_targetIndexCount/3;
+    while(triangles>target)
+    {
+      buildAdjacency(state);
+      // positions on an open edge are border, on an edge with more than two triangles locked
+      std::fill(flags.begin(),flags.end(),0);
+      for(size_t i=0; i<state.m_edges.size(); )
+      {
+        size_t j=i+1;
+        while(j<state.m_edges.size() && state.m_edges[j]==state.m_edges[i])
+        {
+          ++j;
+        }
+        unsigned char flag= j-i==1 ? BORDER : j-i>2 ? LOCKED : 0;
+        flags[state.m_edges[i]>>32]|=flag;
+        flags[state.m_edges[i]&0xffffffffu]|=flag;
+        i=j;
+      }
+      // each edge is taken from the triangle where it runs from the lower position, an interior edge is
+      // there once each way round so this finds it once, an open edge is only in the one triangle
+      collapses.clear();
+      for(size_t i=0; i<state.m_indices.size(); ++i)
+      {
+        uint32_t a=m_position[state.m_indices[i]];
+        uint32_t b=m_position[state.m_indices[i-i%3+(i+1)%3]];
+        bool open=(flags[a]&BORDER) && (flags[b]&BORDER) && edgeCount(state,a,b)==1;
+        if(a>b && !open)
+        {
+          continue;
+        }
+        for(size_t k=0; k<2; ++k)
+        {
+          std::swap(a,b);
+          if(flags[a]&LOCKED)
+          {
+            continue;
+          }
+          // a border position can only slide along an open edge
+          if((flags[a]&BORDER) && (m_lockBorder || !open))
+          {
+            continue;
+          }
+          collapses.push_back({a,b,0.0f,0.0f});
+        }
+      }
+      auto evaluateRange=[this,&state,&collapses](size_t _begin, size_t _end)
+      {
+        for(size_t i=_begin; i<_end; ++i)
+        {
+          evaluate(state,collapses[i]);
+        }
+      };
+      if(_parallel)
+      {
+        parallelFor(collapses.size(),c_grainSize,evaluateRange);
+      }
+      else
+      {
+        evaluateRange(0,collapses.size());
+      }
+      order.clear();
+      for(size_t i=0; i<collapses.size(); ++i)
+      {
+        if(std::isfinite(collapses[i].m_cost) && collapses[i].m_error<=m_maxError)
+        {
+          order.push_back(static_cast<uint32_t>(i));
+        }
+      }
+      if(order.empty())
+      {
+        break;
+      }
+      // only the cheapest part are tried each pass so the greedy order is mostly kept, that part is sorted
+      // first and the rest only if none of it can be collapsed, the index breaks ties so the result doesn't
+      // depend on the sort
+      auto cheaper=[&collapses](uint32_t _x, uint32_t _y)
+      {
+        return collapses[_x].m_cost<collapses[_y].m_cost || (collapses[_x].m_cost==collapses[_y].m_cost && _x<_y);
+      };
+      auto passEnd=order.begin()+static_cast<ptrdiff_t>(order.size()/c_passFraction)+1;
+      std::nth_element(order.begin(),passEnd-1,order.end(),cheaper);
+      std::sort(order.begin(),passEnd,cheaper);
+      std::fill(touched.begin(),touched.end(),0);
+      std::vector<uint32_t> changed;
+      for(auto it=order.begin(); it!=order.end(); ++it)
+      {
+        if(it==passEnd)
+        {
+          if(!changed.empty())
+          {
+            break;
+          }
+          std::sort(passEnd,order.end(),cheaper);
+        }
+        const Collapse &c=collapses[*it];
+        if(touched[c.m_from] || touched[c.m_to] || !isValid(state,c,neighbours,scratch))
+        {
+          continue;
+        }
+        uint32_t from[c_maxWedges];
+        uint32_t to[c_maxWedges];
+        size_t count;
+        wedgeMap(state,c.m_from,c.m_to,from,to,count);
+        for(size_t w=0; w<count; ++w)
+        {
+          remap[from[w]]=to[w];
+          state.m_vertexQuadric[to[w]]+=state.m_vertexQuadric[from[w]];
+          changed.push_back(from[w]);
+        }
+        state.m_positionQuadric[c.m_to]+=state.m_positionQuadric[c.m_from];
+        touched[c.m_from]=1;
+        for(auto n : neighbours)
+        {
+          touched[n]=1;
+        }
+        triangles-=edgeCount(state,c.m_from,c.m_to);
+        maxError=std::max(maxError,double(c.m_error));
+        if(triangles<=target)
+        {
+          break;
+        }
+      }
+      if(changed.empty())
+      {
+        break;
+      }
+      // move the collapsed vertices and drop the triangles that are now lines
+      size_t out=0;
+      for(size_t t=0; t<state.m_indices.size(); t+=3)
+      {
+        uint32_t a=remap[state.m_indices[t]];
+        uint32_t b=remap[state.m_indices[t+1]];
+        uint32_t c=remap[state.m_indices[t+2]];
+        if(m_position[a]!=m_position[b] && m_position[b]!=m_position[c] && m_position[a]!=m_position[c])
+        {
+          state.m_indices[out++]=a;
+          state.m_indices[out++]=b;
+          state.m_indices[out++]=c;
+        }
+      }
+      state.m_indices.resize(out);
+      triangles=out/3;
+      for(auto v : changed)
+      {
+        remap[v]=v;
+      }
+    }
+    std::copy(state.m_indices.begin(),state.m_indices.end(),o_indices);
+    o_error=static_cast<Real>(maxError);
+    return state.m_indices.size();
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+size_t simplifyMesh(const uint32_t *_indices, size_t _indexCount, const Vec3 *_positions, const Vec3 *_normals,
+                    const Vec3 *_uvs, size_t _vertexCount, size_t _targetIndexCount, const SimplifyOptions &_options,
+                    uint32_t *o_indices, Real *o_error)
+{
+  Simplifier simplifier(_indices,_indexCount,_positions,_normals,_uvs,_vertexCount,_options);
+  Real error;
+  size_t count=simplifier.run(_targetIndexCount,true,o_indices,error);
+  if(o_error!=nullptr)
+  {
+    *o_error=error;
+  }
+  return count;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void buildLODChain(const uint32_t *_indices, size_t _indexCount, const Vec3 *_positions, const Vec3 *_normals,
+                   const Vec3 *_uvs, size_t _vertexCount, size_t _levels, Real _ratio, const SimplifyOptions &_options,
+                   std::vector<uint32_t> &o_indices, std::vector<MeshLOD> &o_lods)
+{
+  o_indices.assign(_indices,_indices+_indexCount);
+  o_lods.assign(1,MeshLOD());
+  o_lods[0].m_indexCount=_indexCount;
+  if(_levels<2 || _indexCount==0)
+  {
+    return;
+  }
+  Simplifier simplifier(_indices,_indexCount,_positions,_normals,_uvs,_vertexCount,_options);
+  std::vector<std::vector<uint32_t>> levels(_levels-1);
+  std::vector<Real> errors(_levels-1,0.0f);
+  // every level starts from the full mesh so they are independent and shared out over threads
+  parallelTasks(_levels-1,[&](size_t _l)
+  {
+    size_t target=static_cast<size_t>(double(_indexCount/3)*std::pow(double(_ratio),double(_l+1)))*3;
+    levels[_l].resize(_indexCount);
+    levels[_l].resize(simplifier.run(std::max<size_t>(target,3),false,levels[_l].data(),errors[_l]));
+  });
+  for(size_t l=0; l<levels.size(); ++l)
+  {
+    const MeshLOD &previous=o_lods.back();
+    if(levels[l].empty() || levels[l].size()>=previous.m_indexCount)
+    {
+      break;
+    }
+    MeshLOD lod;
+    lod.m_indexOffset=o_indices.size();
+    lod.m_indexCount=levels[l].size();
+    lod.m_error=std::max(errors[l]*simplifier.scale(),previous.m_error);
+    o_indices.insert(o_indices.end(),levels[l].begin(),levels[l].end());
+    o_lods.push_back(lod);
+  }
+}
+
+} // end namespace ngl
@@ -107,7 +107,8 @@ bool NCCABinMesh::load(const std::string &_fname,bool _calcBB) noexcept
   // create the BBox for the obj
   if(_calcBB)
   {
-    m_ext.reset(new BBox(m_minX,m_maxX,m_minY,m_maxY,m_minZ,m_maxZ) );
+    m_bounds=Bounds3(Vec3(m_minX,m_minY,m_minZ),Vec3(m_maxX,m_maxY,m_maxZ));
+    m_ext.reset(new BBox(m_bounds) );
   }
   m_vbo=true;
   return true;
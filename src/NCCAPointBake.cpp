@@ -245,28 +245,30 @@ bool NCCAPointBake::saveBinaryPointBake( const std::string &_fileName) noexcept
 
 void NCCAPointBake::setMeshToFrame(  const unsigned int _frame) noexcept
 {
+    // the positions are overwritten in place so must be stored as floats
+    const VertexLayout &layout=m_mesh->getVertexLayout();
+    if(layout.m_position!=VertexLayout::Position::FLOAT)
+    {
+      std::cerr<<"point bake needs a mesh with float positions\n";
+      return;
+    }
     // map the m_obj's vbo dat
     Real *ptr=m_mesh->mapVAOVerts();
-    std::vector <Face> faces=m_mesh->getFaceList();
-    //unsigned int nFaces=faces.size();
-    // loop for each of the faces
-    unsigned int step=0;
-    for(auto face : faces)
+    // the mesh gives the vertex index of each vertex in the vao, this is a vertex per face corner
+    // unless the vao was created indexed
+    // the data is packed uv, normal then x,y,z (u,v,nx,ny,nz,x,y,z for the float layout)
+    // as we only want to change x,y,z, we need to skip over
+    // stuff
+    const std::vector<IndexRef> &indices=m_mesh->getIndices();
+    size_t offset=layout.positionOffset()/sizeof(Real);
+    size_t stride=layout.stride()/sizeof(Real);
+    size_t step=0;
+    for(const auto &index : indices)
     {
-      // now for each triangle in the face (remember we ensured tri when loading)
-      // loop for all the verts and set the new vert value
-      // the data is packed uv, nx,ny,nz then x,y,z
-      // as we only want to change x,y,z, we need to skip over
-      // stuff
-
-      for(unsigned int j=0;j<3;++j)
-      {
-        ptr[step+5]=m_data[_frame][face.m_vert[j]].m_x;
-        ptr[step+6]=m_data[_frame][face.m_vert[j]].m_y;
-        ptr[step+7]=m_data[_frame][face.m_vert[j]].m_z;
-        step+=8;
-      }
-
+      ptr[step+offset]=m_data[_frame][index.m_v].m_x;
+      ptr[step+offset+1]=m_data[_frame][index.m_v].m_y;
+      ptr[step+offset+2]=m_data[_frame][index.m_v].m_z;
+      step+=stride;
     }
 
     // unmap the vbo as we have finished updating
@@ -0,0 +1,365 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "OBB.h"
+#include "SoAKernels.h"
+#include "ParallelFor.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file OBB.cpp
+/// @brief implementation files for OBB class
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace ngl
+{
+
+namespace
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of points each thread is given when fitting large arrays
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr size_t c_pointGrain=1<<16;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief sums kept in double so millions of points do not lose the small terms
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Sums
+  {
+    double m_v[6]={0.0,0.0,0.0,0.0,0.0,0.0};
+  };
+
+  inline Sums addSums(Sums _a, const Sums &_b) noexcept
+  {
+    for(int i=0; i<6; ++i)
+    {
+      _a.m_v[i]+=_b.m_v[i];
+    }
+    return _a;
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the smallest and largest projection of the points onto each axis
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Extents
+  {
+    Real m_min[3]={std::numeric_limits<Real>::max(),std::numeric_limits<Real>::max(),std::numeric_limits<Real>::max()};
+    Real m_max[3]={-std::numeric_limits<Real>::max(),-std::numeric_limits<Real>::max(),-std::numeric_limits<Real>::max()};
+  };
+
+  Extents extentsOfRange(const Vec3 *_points, size_t _begin, size_t _end, const Vec3 *_axis, const Vec3 &_origin) noexcept
+  {
+    Extents e;
+    size_t i=_begin;
+#ifdef NGL_SIMD_X86
+    if(soa::useSIMD())
+    {
+      __m128 ox=_mm_set1_ps(_origin.m_x);
+      __m128 oy=_mm_set1_ps(_origin.m_y);
+      __m128 oz=_mm_set1_ps(_origin.m_z);
+      __m128 mn[3],mx[3];
+      for(int a=0; a<3; ++a)
+      {
+        mn[a]=_mm_set1_ps(e.m_min[a]);
+        mx[a]=_mm_set1_ps(e.m_max[a]);
+      }
+      for( ; i+4<=_end; i+=4)
+      {
+        __m128 x,y,z;
+        soa::load3x4(&_points[i].m_x,x,y,z);
+        x=_mm_sub_ps(x,ox);
+        y=_mm_sub_ps(y,oy);
+        z=_mm_sub_ps(z,oz);
+        for(int a=0; a<3; ++a)
+        {
+          __m128 d=_mm_add_ps(_mm_add_ps(_mm_mul_ps(x,_mm_set1_ps(_axis[a].m_x)),
+                                         _mm_mul_ps(y,_mm_set1_ps(_axis[a].m_y))),
+                              _mm_mul_ps(z,_mm_set1_ps(_axis[a].m_z)));
+          mn[a]=_mm_min_ps(mn[a],d);
+          mx[a]=_mm_max_ps(mx[a],d);
+        }
+      }
+      for(int a=0; a<3; ++a)
+      {
+        alignas(16) float lo[4],hi[4];
+        _mm_store_ps(lo,mn[a]);
+        _mm_store_ps(hi,mx[a]);
+        e.m_min[a]=std::min(std::min(lo[0],lo[1]),std::min(lo[2],lo[3]));
+        e.m_max[a]=std::max(std::max(hi[0],hi[1]),std::max(hi[2],hi[3]));
+      }
+    }
+#endif
+    for( ; i<_end; ++i)
+    {
+      Vec3 p=_points[i]-_origin;
+      for(int a=0; a<3; ++a)
+      {
+        Real d=p.dot(_axis[a]);
+        e.m_min[a]=std::min(e.m_min[a],d);
+        e.m_max[a]=std::max(e.m_max[a],d);
+      }
+    }
+    return e;
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the eigenvectors of a symmetric 3x3 matrix by cyclic Jacobi rotations, the columns of o_v
+  /// @param[in,out] io_a the matrix, left (close to) diagonal
+  /// @param[out] o_v the eigenvectors as columns
+  //----------------------------------------------------------------------------------------------------------------------
+  void jacobiEigenvectors(double io_a[3][3], double o_v[3][3]) noexcept
+  {
+    for(int i=0; i<3; ++i)
+    {
+      for(int j=0; j<3; ++j)
+      {
+        o_v[i][j]= i==j ? 1.0 : 0.0;
+      }
+    }
+    constexpr int c_maxSweeps=32;
+    for(int sweep=0; sweep<c_maxSweeps; ++sweep)
+    {
+      double off=io_a[0][1]*io_a[0][1]+io_a[0][2]*io_a[0][2]+io_a[1][2]*io_a[1][2];
+      double diag=io_a[0][0]*io_a[0][0]+io_a[1][1]*io_a[1][1]+io_a[2][2]*io_a[2][2];
+      if(off<=1e-24*diag)
+      {
+        return;
+      }
+      for(int p=0; p<2; ++p)
+      {
+        for(int q=p+1; q<3; ++q)
+        {
+          if(io_a[p][q]==0.0)
+          {
+            continue;
+          }
+          // the rotation that zeroes a[p][q] (Golub and Van Loan 8.4)
+          double theta=(io_a[q][q]-io_a[p][p])/(2.0*io_a[p][q]);
+          double t=(theta>=0.0 ? 1.0 : -1.0)/(std::abs(theta)+std::sqrt(theta*theta+1.0));
+          double c=1.0/std::sqrt(t*t+1.0);
+          double s=t*c;
+          for(int k=0; k<3; ++k)
+          {
+            double akp=io_a[k][p];
+            double akq=io_a[k][q];
+            io_a[k][p]=c*akp-s*akq;
+            io_a[k][q]=s*akp+c*akq;
+          }
+          for(int k=0; k<3; ++k)
+          {
+            double apk=io_a[p][k];
+            double aqk=io_a[q][k];
+            io_a[p][k]=c*apk-s*aqk;
+            io_a[q][k]=s*apk+c*aqk;
+          }
+          for(int k=0; k<3; ++k)
+          {
+            double vkp=o_v[k][p];
+            double vkq=o_v[k][q];
+            o_v[k][p]=c*vkp-s*vkq;
+            o_v[k][q]=s*vkp+c*vkq;
+          }
+        }
+      }
+    }
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the centre and half size of a box from the extents measured along its axes from _origin
+  //----------------------------------------------------------------------------------------------------------------------
+  void fitToExtents(const Extents &_e, const Vec3 &_origin, OBB &io_box) noexcept
+  {
+    io_box.m_center=_origin;
+    for(int a=0; a<3; ++a)
+    {
+      io_box.m_center+=io_box.m_axis[a]*((_e.m_min[a]+_e.m_max[a])*0.5f);
+      io_box.m_halfSize.m_openGL[static_cast<size_t>(a)]=(_e.m_max[a]-_e.m_min[a])*0.5f;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+OBB::OBB() noexcept : m_center(0.0f,0.0f,0.0f), m_halfSize(-1.0f,-1.0f,-1.0f)
+{
+  m_axis[0].set(1.0f,0.0f,0.0f);
+  m_axis[1].set(0.0f,1.0f,0.0f);
+  m_axis[2].set(0.0f,0.0f,1.0f);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+OBB::OBB(const Bounds3 &_b) noexcept : OBB()
+{
+  if(!_b.isEmpty())
+  {
+    m_center=_b.center();
+    m_halfSize=_b.halfSize();
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+OBB OBB::fromPoints(const Vec3 *_points, size_t _count) noexcept
+{
+  if(_count==0)
+  {
+    return OBB();
+  }
+  Sums sum=parallelReduce(_count,c_pointGrain,Sums(),[_points](size_t _begin, size_t _end)
+  {
+    Sums s;
+    for(size_t i=_begin; i<_end; ++i)
+    {
+      s.m_v[0]+=_points[i].m_x;
+      s.m_v[1]+=_points[i].m_y;
+      s.m_v[2]+=_points[i].m_z;
+    }
+    return s;
+  },addSums);
+  double mean[3]={sum.m_v[0]/_count,sum.m_v[1]/_count,sum.m_v[2]/_count};
+  // the covariance xx, xy, xz, yy, yz, zz about the mean
+  Sums cov=parallelReduce(_count,c_pointGrain,Sums(),[_points,&mean](size_t _begin, size_t _end)
+  {
+    Sums s;
+    for(size_t i=_begin; i<_end; ++i)
+    {
+      double x=_points[i].m_x-mean[0];
+      double y=_points[i].m_y-mean[1];
+      double z=_points[i].m_z-mean[2];
+      s.m_v[0]+=x*x;
+      s.m_v[1]+=x*y;
+      s.m_v[2]+=x*z;
+      s.m_v[3]+=y*y;
+      s.m_v[4]+=y*z;
+      s.m_v[5]+=z*z;
+    }
+    return s;
+  },addSums);
+  double a[3][3]={{cov.m_v[0],cov.m_v[1],cov.m_v[2]},
+                  {cov.m_v[1],cov.m_v[3],cov.m_v[4]},
+                  {cov.m_v[2],cov.m_v[4],cov.m_v[5]}};
+  double v[3][3];
+  jacobiEigenvectors(a,v);
+
+  // the rotations keep v orthonormal but rebuild it in float so the axes are exactly a right handed basis
+  OBB box;
+  Vec3 origin(static_cast<Real>(mean[0]),static_cast<Real>(mean[1]),static_cast<Real>(mean[2]));
+  Vec3 e0(static_cast<Real>(v[0][0]),static_cast<Real>(v[1][0]),static_cast<Real>(v[2][0]));
+  Vec3 e1(static_cast<Real>(v[0][1]),static_cast<Real>(v[1][1]),static_cast<Real>(v[2][1]));
+  e0.normalize();
+  e1-=e0*e0.dot(e1);
+  e1.normalize();
+  box.m_axis[0]=e0;
+  box.m_axis[1]=e1;
+  box.m_axis[2]=e0.cross(e1);
+  Extents e=parallelReduce(_count,c_pointGrain,Extents(),[_points,&box,&origin](size_t _begin, size_t _end)
+  {
+    return extentsOfRange(_points,_begin,_end,box.m_axis,origin);
+  },[](Extents _a, const Extents &_b)
+  {
+    for(int i=0; i<3; ++i)
+    {
+      _a.m_min[i]=std::min(_a.m_min[i],_b.m_min[i]);
+      _a.m_max[i]=std::max(_a.m_max[i],_b.m_max[i]);
+    }
+    return _a;
+  });
+  fitToExtents(e,origin,box);
+
+  OBB aligned(Bounds3::fromPoints(_points,_count));
+  return aligned.volume()<=box.volume() ? aligned : box;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool OBB::contains(const Vec3 &_p, Real _epsilon) const noexcept
+{
+  Vec3 d=_p-m_center;
+  for(size_t a=0; a<3; ++a)
+  {
+    if(std::abs(d.dot(m_axis[a]))>m_halfSize.m_openGL[a]+_epsilon)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void OBB::getCorners(Vec3 *o_corners) const noexcept
+{
+  Vec3 x=m_axis[0]*m_halfSize.m_x;
+  Vec3 y=m_axis[1]*m_halfSize.m_y;
+  Vec3 z=m_axis[2]*m_halfSize.m_z;
+  for(int i=0; i<8; ++i)
+  {
+    o_corners[i]=m_center+((i&1) ? x : -x)+((i&2) ? y : -y)+((i&4) ? z : -z);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+Bounds3 OBB::bounds() const noexcept
+{
+  if(isEmpty())
+  {
+    return Bounds3();
+  }
+  // the half size of the box along each world axis is the sum of the projected half axes
+  Vec3 h;
+  for(size_t i=0; i<3; ++i)
+  {
+    h.m_openGL[i]=std::abs(m_axis[0].m_openGL[i])*m_halfSize.m_x+
+                  std::abs(m_axis[1].m_openGL[i])*m_halfSize.m_y+
+                  std::abs(m_axis[2].m_openGL[i])*m_halfSize.m_z;
+  }
+  return Bounds3(m_center-h,m_center+h);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+OBB OBB::transformed(const Mat4 &_m) const noexcept
+{
+  if(isEmpty())
+  {
+    return *this;
+  }
+  OBB b;
+  b.m_center.set(m_center.m_x*_m.m_m[0][0] + m_center.m_y*_m.m_m[1][0] + m_center.m_z*_m.m_m[2][0] + _m.m_m[3][0],
+                 m_center.m_x*_m.m_m[0][1] + m_center.m_y*_m.m_m[1][1] + m_center.m_z*_m.m_m[2][1] + _m.m_m[3][1],
+                 m_center.m_x*_m.m_m[0][2] + m_center.m_y*_m.m_m[1][2] + m_center.m_z*_m.m_m[2][2] + _m.m_m[3][2]);
+  Vec3 axis[3];
+  for(size_t a=0; a<3; ++a)
+  {
+    const Vec3 &v=m_axis[a];
+    axis[a].set(v.m_x*_m.m_m[0][0] + v.m_y*_m.m_m[1][0] + v.m_z*_m.m_m[2][0],
+                v.m_x*_m.m_m[0][1] + v.m_y*_m.m_m[1][1] + v.m_z*_m.m_m[2][1],
+                v.m_x*_m.m_m[0][2] + v.m_y*_m.m_m[1][2] + v.m_z*_m.m_m[2][2]);
+  }
+  // keep the first axis, make the others orthogonal to it and grow each half size so the sheared box is held
+  Vec3 e0=axis[0];
+  e0.normalize();
+  Vec3 e1=axis[1]-e0*e0.dot(axis[1]);
+  e1.normalize();
+  Vec3 e2=e0.cross(e1);
+  b.m_axis[0]=e0;
+  b.m_axis[1]=e1;
+  b.m_axis[2]=e2;
+  for(size_t i=0; i<3; ++i)
+  {
+    Real h=0.0f;
+    for(size_t a=0; a<3; ++a)
+    {
+      h+=std::abs(axis[a].dot(b.m_axis[i]))*m_halfSize.m_openGL[a];
+    }
+    b.m_halfSize.m_openGL[i]=h;
+  }
+  return b;
+}
+
+} // end namespace ngl
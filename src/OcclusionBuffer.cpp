@@ -0,0 +1,533 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "OcclusionBuffer.h"
+#include "AABB.h"
+#include "AbstractMesh.h"
+#include "BBox.h"
+#include "NGLassert.h"
+#include "ParallelFor.h"
+#include "SIMD.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#ifdef NGL_SIMD_X86
+  #include <immintrin.h>
+#endif
+//----------------------------------------------------------------------------------------------------------------------
+/// @file OcclusionBuffer.cpp
+/// @brief implementation files for OcclusionBuffer class
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace ngl
+{
+constexpr size_t OcclusionBuffer::c_tileWidth;
+constexpr size_t OcclusionBuffer::c_tileHeight;
+constexpr size_t OcclusionBuffer::c_blockSize;
+
+namespace
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the minimum number of mask words (32 boxes each) given to each thread by testBoxes
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr size_t c_grainWords=16;
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the values of a triangle for one pixel row, the edges and depth are a*x + row[i]
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Span
+  {
+    Real m_a[4];
+    Real m_row[4];
+  };
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief fill the pixels [_x,_end] of a row, done in the same order as the simd versions so every level gives
+  /// the same depths
+  //----------------------------------------------------------------------------------------------------------------------
+  void rowScalar(const Span &_s, size_t _x, size_t _end, Real *io_row) noexcept
+  {
+    for( ; _x<=_end; ++_x)
+    {
+      Real px=static_cast<Real>(_x)+0.5f;
+      if(_s.m_a[0]*px+_s.m_row[0] >= 0.0f && _s.m_a[1]*px+_s.m_row[1] >= 0.0f && _s.m_a[2]*px+_s.m_row[2] >= 0.0f)
+      {
+        io_row[_x]=std::min(io_row[_x],_s.m_a[3]*px+_s.m_row[3]);
+      }
+    }
+  }
+
+#ifdef NGL_SIMD_X86
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief as rowScalar 4 pixels at a time from _x rounded down to a multiple of 4, the span values are
+  /// copied to registers first as the row could alias them
+  //----------------------------------------------------------------------------------------------------------------------
+  void rowSSE(const Span &_s, size_t _x, size_t _end, Real *io_row) noexcept
+  {
+    const __m128 zero=_mm_setzero_ps();
+    const __m128 offset=_mm_set_ps(3.5f,2.5f,1.5f,0.5f);
+    __m128 a[4];
+    __m128 row[4];
+    for(int i=0; i<4; ++i)
+    {
+      a[i]=_mm_set1_ps(_s.m_a[i]);
+      row[i]=_mm_set1_ps(_s.m_row[i]);
+    }
+    for(_x&=~size_t(3); _x<=_end; _x+=4)
+    {
+      __m128 px=_mm_add_ps(_mm_set1_ps(static_cast<Real>(_x)),offset);
+      __m128 inside=_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a[0],px),row[0]),zero);
+      inside=_mm_and_ps(inside,_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a[1],px),row[1]),zero));
+      inside=_mm_and_ps(inside,_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a[2],px),row[2]),zero));
+      __m128 depth=_mm_add_ps(_mm_mul_ps(a[3],px),row[3]);
+      __m128 current=_mm_load_ps(io_row+_x);
+      __m128 write=_mm_and_ps(inside,_mm_cmplt_ps(depth,current));
+      _mm_store_ps(io_row+_x,_mm_or_ps(_mm_and_ps(write,depth),_mm_andnot_ps(write,current)));
+    }
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief as rowScalar 8 pixels at a time from _x rounded down to a multiple of 8
+  //----------------------------------------------------------------------------------------------------------------------
+  NGL_TARGET_AVX void rowAVX(const Span &_s, size_t _x, size_t _end, Real *io_row) noexcept
+  {
+    const __m256 zero=_mm256_setzero_ps();
+    const __m256 offset=_mm256_set_ps(7.5f,6.5f,5.5f,4.5f,3.5f,2.5f,1.5f,0.5f);
+    __m256 a[4];
+    __m256 row[4];
+    for(int i=0; i<4; ++i)
+    {
+      a[i]=_mm256_set1_ps(_s.m_a[i]);
+      row[i]=_mm256_set1_ps(_s.m_row[i]);
+    }
+    for(_x&=~size_t(7); _x<=_end; _x+=8)
+    {
+      __m256 px=_mm256_add_ps(_mm256_set1_ps(static_cast<Real>(_x)),offset);
+      __m256 inside=_mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(a[0],px),row[0]),zero,_CMP_GE_OQ);
+      inside=_mm256_and_ps(inside,_mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(a[1],px),row[1]),zero,_CMP_GE_OQ));
+      inside=_mm256_and_ps(inside,_mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(a[2],px),row[2]),zero,_CMP_GE_OQ));
+      __m256 depth=_mm256_add_ps(_mm256_mul_ps(a[3],px),row[3]);
+      __m256 current=_mm256_load_ps(io_row+_x);
+      __m256 write=_mm256_and_ps(inside,_mm256_cmp_ps(depth,current,_CMP_LT_OQ));
+      _mm256_store_ps(io_row+_x,_mm256_blendv_ps(current,depth,write));
+    }
+  }
+#endif
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+OcclusionBuffer::OcclusionBuffer(size_t _width, size_t _height)
+{
+  resize(_width,_height);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void OcclusionBuffer::resize(size_t _width, size_t _height)
+{
+  NGL_ASSERT(_width>0 && _height>0);
+  m_width=_width;
+  m_height=_height;
+  m_tilesX=(_width+c_tileWidth-1)/c_tileWidth;
+  m_tilesY=(_height+c_tileHeight-1)/c_tileHeight;
+  m_stride=m_tilesX*c_tileWidth;
+  m_depth.assign(m_stride*m_tilesY*c_tileHeight,1.0f);
+  m_blockDepth.assign((m_stride/c_blockSize)*(m_tilesY*c_tileHeight/c_blockSize),1.0f);
+  m_bins.resize(m_tilesX*m_tilesY);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+size_t OcclusionBuffer::addOccluder(const Vec3 *_verts, size_t _numVerts, const uint32_t *_indices, size_t _numIndices)
+{
+  NGL_ASSERT(_numIndices%3==0);
+  Occluder o;
+  o.m_verts.assign(_verts,_verts+_numVerts);
+  o.m_indices.assign(_indices,_indices+_numIndices);
+  m_occluders.push_back(std::move(o));
+  return m_occluders.size()-1;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+size_t OcclusionBuffer::addOccluder(AbstractMesh &_mesh)
+{
+  Occluder o;
+  o.m_verts=_mesh.getVertexList();
+  for(const auto &f : _mesh.getFaceList())
+  {
+    for(size_t i=2; i<f.m_vert.size(); ++i)
+    {
+      o.m_indices.push_back(f.m_vert[0]);
+      o.m_indices.push_back(f.m_vert[i-1]);
+      o.m_indices.push_back(f.m_vert[i]);
+    }
+  }
+  m_occluders.push_back(std::move(o));
+  return m_occluders.size()-1;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+size_t OcclusionBuffer::addOccluder(const Real *_data, size_t _size)
+{
+  // u,v,nx,ny,nz,x,y,z per vertex
+  size_t numVerts=(_size/8)/3*3;
+  Occluder o;
+  for(size_t i=0; i<numVerts; ++i)
+  {
+    o.m_verts.push_back(Vec3(_data[i*8+5],_data[i*8+6],_data[i*8+7]));
+    o.m_indices.push_back(static_cast<uint32_t>(i));
+  }
+  m_occluders.push_back(std::move(o));
+  return m_occluders.size()-1;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void OcclusionBuffer::clearOccluders() noexcept
+{
+  m_occluders.clear();
+  m_draws.clear();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void OcclusionBuffer::begin(const Mat4 &_viewProject) noexcept
+{
+  m_viewProject=_viewProject;
+  m_draws.clear();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void OcclusionBuffer::drawOccluder(size_t _occluder, const Mat4 &_model)
+{
+  NGL_ASSERT(_occluder<m_occluders.size());
+  m_draws.push_back({_occluder,_model});
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void OcclusionBuffer::addTriangle(const Vec4 &_a, const Vec4 &_b, const Vec4 &_c)
+{
+  // screen x,y in pixels and depth
+  Real v[3][3];
+  const Vec4 *p[3]={&_a,&_b,&_c};
+  for(int i=0; i<3; ++i)
+  {
+    Real iw=1.0f/p[i]->m_w;
+    v[i][0]=(p[i]->m_x*iw*0.5f+0.5f)*static_cast<Real>(m_width);
+    v[i][1]=(p[i]->m_y*iw*0.5f+0.5f)*static_cast<Real>(m_height);
+    v[i][2]=p[i]->m_z*iw*0.5f+0.5f;
+  }
+  Real area=(v[1][0]-v[0][0])*(v[2][1]-v[0][1])-(v[2][0]-v[0][0])*(v[1][1]-v[0][1]);
+  if(std::abs(area) < 1e-6f)
+  {
+    return;
+  }
+  Real minX=std::min({v[0][0],v[1][0],v[2][0]});
+  Real maxX=std::max({v[0][0],v[1][0],v[2][0]});
+  Real minY=std::min({v[0][1],v[1][1],v[2][1]});
+  Real maxY=std::max({v[0][1],v[1][1],v[2][1]});
+  if(maxX < 0.0f || maxY < 0.0f || minX >= static_cast<Real>(m_width) || minY >= static_cast<Real>(m_height) ||
+     std::min({v[0][2],v[1][2],v[2][2]}) > 1.0f)
+  {
+    return;
+  }
+  Triangle t;
+  t.m_bounds[0]=static_cast<int>(std::floor(std::max(minX,0.0f)));
+  t.m_bounds[1]=static_cast<int>(std::floor(std::max(minY,0.0f)));
+  t.m_bounds[2]=static_cast<int>(std::floor(std::min(maxX,static_cast<Real>(m_width-1))));
+  t.m_bounds[3]=static_cast<int>(std::floor(std::min(maxY,static_cast<Real>(m_height-1))));
+  // both windings are drawn so flip the edges of clockwise triangles to be positive inside
+  Real sign=area > 0.0f ? 1.0f : -1.0f;
+  for(int i=0; i<3; ++i)
+  {
+    const Real *s=v[i];
+    const Real *e=v[(i+1)%3];
+    t.m_edge[i][0]=sign*(s[1]-e[1]);
+    t.m_edge[i][1]=sign*(e[0]-s[0]);
+    t.m_edge[i][2]=sign*(s[0]*e[1]-s[1]*e[0]);
+  }
+  // z/w is linear in screen space so the depth is a plane through the three vertices
+  Real dx=((v[1][2]-v[0][2])*(v[2][1]-v[0][1])-(v[2][2]-v[0][2])*(v[1][1]-v[0][1]))/area;
+  Real dy=((v[2][2]-v[0][2])*(v[1][0]-v[0][0])-(v[1][2]-v[0][2])*(v[2][0]-v[0][0]))/area;
+  t.m_depth[0]=dx;
+  t.m_depth[1]=dy;
+  t.m_depth[2]=v[0][2]-dx*v[0][0]-dy*v[0][1];
+  m_triangles.push_back(t);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void OcclusionBuffer::clipTriangle(const Vec4 &_a, const Vec4 &_b, const Vec4 &_c)
+{
+  // in front of the near plane when z >= -w
+  const Vec4 *in[3]={&_a,&_b,&_c};
+  Real dist[3];
+  int numInside=0;
+  for(int i=0; i<3; ++i)
+  {
+    dist[i]=in[i]->m_z+in[i]->m_w;
+    numInside+= dist[i] >= 0.0f;
+  }
+  if(numInside==3)
+  {
+    addTriangle(_a,_b,_c);
+    return;
+  }
+  if(numInside==0)
+  {
+    return;
+  }
+  Vec4 out[4];
+  int numOut=0;
+  for(int i=0; i<3; ++i)
+  {
+    int j=(i+1)%3;
+    if(dist[i] >= 0.0f)
+    {
+      out[numOut++]=*in[i];
+    }
+    if((dist[i] >= 0.0f)!=(dist[j] >= 0.0f))
+    {
+      // the Vec4 operators leave w alone so lerp each part
+      Real t=dist[i]/(dist[i]-dist[j]);
+      const Vec4 &a=*in[i];
+      const Vec4 &b=*in[j];
+      out[numOut++]=Vec4(a.m_x+(b.m_x-a.m_x)*t,a.m_y+(b.m_y-a.m_y)*t,a.m_z+(b.m_z-a.m_z)*t,a.m_w+(b.m_w-a.m_w)*t);
+    }
+  }
+  for(int i=2; i<numOut; ++i)
+  {
+    addTriangle(out[0],out[i-1],out[i]);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void OcclusionBuffer::rasterise()
+{
+  m_triangles.clear();
+  for(const auto &d : m_draws)
+  {
+    const Occluder &o=m_occluders[d.m_occluder];
+    Mat4 mvp=d.m_model*m_viewProject;
+    m_clipVerts.resize(o.m_verts.size());
+    for(size_t i=0; i<o.m_verts.size(); ++i)
+    {
+      m_clipVerts[i]=Vec4(o.m_verts[i].m_x,o.m_verts[i].m_y,o.m_verts[i].m_z,1.0f)*mvp;
+    }
+    for(size_t i=0; i+2<o.m_indices.size(); i+=3)
+    {
+      clipTriangle(m_clipVerts[o.m_indices[i]],m_clipVerts[o.m_indices[i+1]],m_clipVerts[o.m_indices[i+2]]);
+    }
+  }
+  // bin the triangles by the tiles their bounds touch
+  for(auto &b : m_bins)
+  {
+    b.clear();
+  }
+  for(size_t i=0; i<m_triangles.size(); ++i)
+  {
+    const int *b=m_triangles[i].m_bounds;
+    for(size_t ty=b[1]/c_tileHeight; ty<=b[3]/c_tileHeight; ++ty)
+    {
+      for(size_t tx=b[0]/c_tileWidth; tx<=b[2]/c_tileWidth; ++tx)
+      {
+        m_bins[ty*m_tilesX+tx].push_back(static_cast<uint32_t>(i));
+      }
+    }
+  }
+  parallelFor(m_bins.size(),1,[this](size_t _begin, size_t _end)
+  {
+    for(size_t t=_begin; t<_end; ++t)
+    {
+      rasteriseTile(t);
+    }
+  });
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void OcclusionBuffer::rasteriseTile(size_t _tile) noexcept
+{
+  size_t x0=(_tile%m_tilesX)*c_tileWidth;
+  size_t y0=(_tile/m_tilesX)*c_tileHeight;
+  size_t x1=std::min(x0+c_tileWidth,m_width)-1;
+  size_t y1=std::min(y0+c_tileHeight,m_height)-1;
+  for(size_t y=y0; y<y0+c_tileHeight; ++y)
+  {
+    std::fill_n(&m_depth[y*m_stride+x0],c_tileWidth,1.0f);
+  }
+  for(auto i : m_bins[_tile])
+  {
+    const Triangle &t=m_triangles[i];
+    size_t bx0=std::max<size_t>(x0,t.m_bounds[0]);
+    size_t bx1=std::min<size_t>(x1,t.m_bounds[2]);
+    size_t by0=std::max<size_t>(y0,t.m_bounds[1]);
+    size_t by1=std::min<size_t>(y1,t.m_bounds[3]);
+    Span s;
+    for(int e=0; e<3; ++e)
+    {
+      s.m_a[e]=t.m_edge[e][0];
+    }
+    s.m_a[3]=t.m_depth[0];
+    for(size_t y=by0; y<=by1; ++y)
+    {
+      Real py=static_cast<Real>(y)+0.5f;
+      for(int e=0; e<3; ++e)
+      {
+        s.m_row[e]=t.m_edge[e][1]*py+t.m_edge[e][2];
+      }
+      s.m_row[3]=t.m_depth[1]*py+t.m_depth[2];
+      // narrow the row to where every edge can be inside, a pixel is left spare each end for rounding and the
+      // pixels are still tested exactly
+      Real lo=static_cast<Real>(bx0);
+      Real hi=static_cast<Real>(bx1);
+      for(int e=0; e<3; ++e)
+      {
+        Real a=s.m_a[e];
+        if(a > 0.0f)
+        {
+          lo=std::max(lo,-s.m_row[e]/a-1.0f);
+        }
+        else if(a < 0.0f)
+        {
+          hi=std::min(hi,-s.m_row[e]/a+1.0f);
+        }
+        else if(s.m_row[e] < 0.0f)
+        {
+          hi=-1.0f;
+        }
+      }
+      if(lo > hi)
+      {
+        continue;
+      }
+      size_t rx0=static_cast<size_t>(lo);
+      size_t rx1=static_cast<size_t>(hi);
+      Real *row=&m_depth[y*m_stride];
+      // the tiles are a whole number of simd widths so the rounded down start stays in this tile
+#ifdef NGL_SIMD_X86
+      if(activeSIMDLevel()==SIMDLevel::AVX)
+      {
+        rowAVX(s,rx0,rx1,row);
+        continue;
+      }
+      if(activeSIMDLevel()==SIMDLevel::SSE2)
+      {
+        rowSSE(s,rx0,rx1,row);
+        continue;
+      }
+#endif
+      rowScalar(s,rx0,rx1,row);
+    }
+  }
+  // the farthest depth of each block, ignoring the padding past the edge of the buffer
+  size_t blocksPerRow=m_stride/c_blockSize;
+  for(size_t by=y0; by<=y1; by+=c_blockSize)
+  {
+    for(size_t bx=x0; bx<=x1; bx+=c_blockSize)
+    {
+      Real farthest=0.0f;
+      for(size_t y=by; y<=std::min(by+c_blockSize-1,y1); ++y)
+      {
+        const Real *row=&m_depth[y*m_stride];
+        farthest=std::max(farthest,*std::max_element(row+bx,row+std::min(bx+c_blockSize-1,x1)+1));
+      }
+      m_blockDepth[(by/c_blockSize)*blocksPerRow+bx/c_blockSize]=farthest;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool OcclusionBuffer::isVisible(const Vec3 &_min, const Vec3 &_max) const noexcept
+{
+  Real minX=std::numeric_limits<Real>::max();
+  Real minY=minX;
+  Real nearest=minX;
+  Real maxX=-minX;
+  Real maxY=-minX;
+  for(int i=0; i<8; ++i)
+  {
+    Vec4 p=Vec4(i&1 ? _max.m_x : _min.m_x,i&2 ? _max.m_y : _min.m_y,i&4 ? _max.m_z : _min.m_z,1.0f)*m_viewProject;
+    if(p.m_z < -p.m_w || p.m_w <= 0.0f)
+    {
+      return true;
+    }
+    Real iw=1.0f/p.m_w;
+    Real x=(p.m_x*iw*0.5f+0.5f)*static_cast<Real>(m_width);
+    Real y=(p.m_y*iw*0.5f+0.5f)*static_cast<Real>(m_height);
+    minX=std::min(minX,x);
+    maxX=std::max(maxX,x);
+    minY=std::min(minY,y);
+    maxY=std::max(maxY,y);
+    nearest=std::min(nearest,p.m_z*iw*0.5f+0.5f);
+  }
+  if(maxX < 0.0f || maxY < 0.0f || minX >= static_cast<Real>(m_width) || minY >= static_cast<Real>(m_height))
+  {
+    return false;
+  }
+  size_t x0=static_cast<size_t>(std::floor(std::max(minX,0.0f)));
+  size_t y0=static_cast<size_t>(std::floor(std::max(minY,0.0f)));
+  size_t x1=static_cast<size_t>(std::floor(std::min(maxX,static_cast<Real>(m_width-1))));
+  size_t y1=static_cast<size_t>(std::floor(std::min(maxY,static_cast<Real>(m_height-1))));
+  for(size_t by=y0/c_blockSize; by<=y1/c_blockSize; ++by)
+  {
+    for(size_t bx=x0/c_blockSize; bx<=x1/c_blockSize; ++bx)
+    {
+      // the whole block is in front of the box
+      if(nearest > m_blockDepth[by*(m_stride/c_blockSize)+bx])
+      {
+        continue;
+      }
+      for(size_t y=std::max(y0,by*c_blockSize); y<=std::min(y1,by*c_blockSize+c_blockSize-1); ++y)
+      {
+        for(size_t x=std::max(x0,bx*c_blockSize); x<=std::min(x1,bx*c_blockSize+c_blockSize-1); ++x)
+        {
+          if(nearest <= m_depth[y*m_stride+x])
+          {
+            return true;
+          }
+        }
+      }
+    }
+  }
+  return false;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool OcclusionBuffer::isVisible(const AABB &_box) const noexcept
+{
+  return isVisible(_box.getMin(),_box.getMax());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool OcclusionBuffer::isVisible(const BBox &_box) const noexcept
+{
+  return isVisible(Vec3(_box.minX(),_box.minY(),_box.minZ()),Vec3(_box.maxX(),_box.maxY(),_box.maxZ()));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void OcclusionBuffer::testBoxes(const Vec3Array &_min, const Vec3Array &_max, uint32_t *o_visible) const noexcept
+{
+  NGL_ASSERT(_min.size()==_max.size());
+  size_t count=_min.size();
+  parallelFor((count+31)/32,c_grainWords,[this,&_min,&_max,count,o_visible](size_t _begin, size_t _end)
+  {
+    for(size_t w=_begin; w<_end; ++w)
+    {
+      uint32_t bits=0;
+      for(size_t i=w*32; i<std::min(count,w*32+32); ++i)
+      {
+        bits|=static_cast<uint32_t>(isVisible(_min.get(i),_max.get(i))) << (i-w*32);
+      }
+      o_visible[w]=bits;
+    }
+  });
+}
+
+} // end namespace ngl
@@ -0,0 +1,172 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "PrecisionConvert.h"
+#include "Mat4.h"
+#include "Vec3.h"
+#include "SIMD.h"
+#include "ParallelFor.h"
+#ifdef NGL_SIMD_X86
+  #include <immintrin.h>
+#endif
+//----------------------------------------------------------------------------------------------------------------------
+/// @file PrecisionConvert.cpp
+/// @brief implementation of the double to float array conversions
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace ngl
+{
+
+// the conversions treat the arrays as flat runs of components
+static_assert(sizeof(Vec3)==3*sizeof(Real) && sizeof(Vec3d)==3*sizeof(double),"Vec3 types must be packed");
+static_assert(sizeof(Mat4)==16*sizeof(Real) && sizeof(Mat4d)==16*sizeof(double),"Mat4 types must be packed");
+
+namespace
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the conversion is memory bound so needs a big range to be worth threading
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr size_t c_grainSize=65536;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the value subtracted from each component before rounding, component i uses m_v[i%12] so any
+  /// xyz pattern lines up with both the 2 and 4 wide registers
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Offset
+  {
+    double m_v[12]={0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0};
+  };
+
+  //----------------------------------------------------------------------------------------------------------------------
+  Offset xyzOffset(const Vec3d &_origin) noexcept
+  {
+    Offset o;
+    for(int i=0; i<12; ++i)
+    {
+      o.m_v[i]=_origin[i%3];
+    }
+    return o;
+  }
+
+#ifdef NGL_SIMD_X86
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief SSE2 version, each block of 4 is two 2 wide conversions joined into one store
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t convertSSE(const double *_in, const Offset &_off, Real *o_out, size_t _i, size_t _end) noexcept
+  {
+    for( ; _i+4<=_end; _i+=4)
+    {
+      const double *o=&_off.m_v[_i%12];
+      __m128 lo=_mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(_in+_i),_mm_loadu_pd(o)));
+      __m128 hi=_mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(_in+_i+2),_mm_loadu_pd(o+2)));
+      _mm_storeu_ps(o_out+_i,_mm_movelh_ps(lo,hi));
+    }
+    return _i;
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief AVX version converting 8 values per pass
+  //----------------------------------------------------------------------------------------------------------------------
+  NGL_TARGET_AVX size_t convertAVX(const double *_in, const Offset &_off, Real *o_out, size_t _i, size_t _end) noexcept
+  {
+    // the offsets repeat every 12 so 8 at a time steps through the pattern 0,8,4
+    for( ; _i+8<=_end; _i+=8)
+    {
+      size_t k=_i%12;
+      __m256d a=_mm256_sub_pd(_mm256_loadu_pd(_in+_i),_mm256_loadu_pd(&_off.m_v[k]));
+      __m256d b=_mm256_sub_pd(_mm256_loadu_pd(_in+_i+4),_mm256_loadu_pd(&_off.m_v[(k+4)%12]));
+      _mm256_storeu_ps(o_out+_i,_mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(a)),_mm256_cvtpd_ps(b),1));
+    }
+    return _i;
+  }
+#endif
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief convert components [_begin,_end) of _in to float subtracting the offset
+  //----------------------------------------------------------------------------------------------------------------------
+  void convertRange(const double *_in, const Offset &_off, Real *o_out, size_t _begin, size_t _end) noexcept
+  {
+    size_t i=_begin;
+    // the simd loops need the offset index on a multiple of 4
+    for( ; i<_end && (i&3)!=0; ++i)
+    {
+      o_out[i]=static_cast<Real>(_in[i]-_off.m_v[i%12]);
+    }
+#ifdef NGL_SIMD_X86
+    if(activeSIMDLevel()==SIMDLevel::AVX)
+    {
+      i=convertAVX(_in,_off,o_out,i,_end);
+    }
+    if(activeSIMDLevel()!=SIMDLevel::SCALAR)
+    {
+      i=convertSSE(_in,_off,o_out,i,_end);
+    }
+#endif
+    for( ; i<_end; ++i)
+    {
+      o_out[i]=static_cast<Real>(_in[i]-_off.m_v[i%12]);
+    }
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief convert _count elements of _components doubles each
+  //----------------------------------------------------------------------------------------------------------------------
+  void convertArray(const double *_in, size_t _count, size_t _components, const Offset &_off, Real *o_out) noexcept
+  {
+    parallelFor(_count,c_grainSize/_components,[_in,_components,&_off,o_out](size_t _begin, size_t _end)
+    {
+      convertRange(_in,_off,o_out,_begin*_components,_end*_components);
+    });
+  }
+} // end anon namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+void convertToFloat(const double *_in, size_t _count, Real *o_out) noexcept
+{
+  convertArray(_in,_count,1,Offset(),o_out);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void convertToFloat(const Vec3d *_in, size_t _count, Vec3 *o_out) noexcept
+{
+  convertArray(&_in->m_x,_count,3,Offset(),&o_out->m_x);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void convertToFloat(const Mat4d *_in, size_t _count, Mat4 *o_out) noexcept
+{
+  convertArray(_in->data(),_count,16,Offset(),&o_out->m_openGL[0]);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void convertToFloatRelativeTo(const Vec3d *_in, size_t _count, const Vec3d &_origin, Vec3 *o_out) noexcept
+{
+  convertArray(&_in->m_x,_count,3,xyzOffset(_origin),&o_out->m_x);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void convertToFloatRelativeTo(const Mat4d *_in, size_t _count, const Vec3d &_origin, Mat4 *o_out) noexcept
+{
+  parallelFor(_count,c_grainSize/16,[_in,&_origin,o_out](size_t _begin, size_t _end)
+  {
+    Offset none;
+    for(size_t i=_begin; i<_end; ++i)
+    {
+      Mat4d m=_in[i].relativeTo(_origin);
+      convertRange(m.data(),none,&o_out[i].m_openGL[0],0,16);
+    }
+  });
+}
+
+} // end namespace ngl
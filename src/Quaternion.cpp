@@ -22,6 +22,7 @@
 
 #include "Quaternion.h"
 #include "Util.h"
+#include "ExportInline.h"
 
 namespace ngl
 {
@@ -84,129 +85,6 @@ Quaternion::Quaternion(const Vec3 &_rot) noexcept
 
 }
 
-//----------------------------------------------------------------------------------------------------------------------
-Quaternion Quaternion::operator *(const Quaternion& _q)const noexcept
-{
-  Quaternion ret(0.0,0.0,0.0,0.0);
-  // if we have two Quaternions Qa Qb we get the following
-  // Qa*Qb
-  // first we do the scalar parts SaSb - A . B (where A and B are  the vector parts) . the dot product
-  ret.m_s=(m_s*_q.m_s)-(m_x*_q.m_x+m_y*_q.m_y+m_z*_q.m_z);
-  // now the x component of the vector part
-  // this is the form of saB + sbA + sbA + A x B (X is the cross product)
-
-  Vec4 v1( m_x, m_y, m_z );
-  Vec4 v2( _q.m_x, _q.m_y, _q.m_z );
-
-  Vec4 vectorPart = (m_s * v2) + (_q.m_s * v1) + (v1.cross(v2));
-
-  ret.m_x=vectorPart.m_x;
-  ret.m_y=vectorPart.m_y;
-  ret.m_z=vectorPart.m_z;
-  return ret;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-void Quaternion::operator *=(const Quaternion& _q) noexcept
-{
-		// as we have already written the code to do the mult above re-use
-		*this=*this*_q;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-Quaternion Quaternion::operator +(const Quaternion& _q) const noexcept
-{
-	Quaternion ret;
-	ret.m_s=m_s+_q.m_s;
-	ret.m_x=m_x+_q.m_x;
-	ret.m_y=m_y+_q.m_y;
-	ret.m_z=m_z+_q.m_z;
-	return ret;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-Quaternion Quaternion::operator -(const Quaternion& _q) const noexcept
-{
-	Quaternion ret;
-	ret.m_s=m_s-_q.m_s;
-	ret.m_x=m_x-_q.m_x;
-	ret.m_y=m_y-_q.m_y;
-	ret.m_z=m_z-_q.m_z;
-	return ret;
-}
-
-
-//----------------------------------------------------------------------------------------------------------------------
-void Quaternion::operator +=(const Quaternion& _q) noexcept
-{
-	// re-call the code from above
-	*this=*this+_q;
-}
-//----------------------------------------------------------------------------------------------------------------------
-void Quaternion::operator -=(const Quaternion& _q) noexcept
-{
-	// re-call the code from above
-	*this=*this-_q;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-Quaternion Quaternion::operator *(Real _s) const noexcept
-{
-	return Quaternion(m_s*_s,m_x*_s,m_y*_s,m_z*_s);
-
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-void Quaternion::operator *=(Real _s) noexcept
-{
-	m_s*=_s;
-	m_x*=_s;
-	m_y*=_s;
-	m_z*=_s;
-}
-
-
-
-//----------------------------------------------------------------------------------------------------------------------
-void Quaternion::normalise() noexcept
-{
-	Real inverseOverOne = 1.0f/magnitude();
-	m_s*=inverseOverOne;
-	m_x*=inverseOverOne;
-	m_y*=inverseOverOne;
-	m_z*=inverseOverOne;
-}
-
-
-//----------------------------------------------------------------------------------------------------------------------
-Real Quaternion::magnitude()const noexcept
-{
-	return static_cast<Real>( sqrt(m_s*m_s + m_x*m_x + m_y*m_y + m_z*m_z) );
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-bool Quaternion::operator == (const Quaternion& _q)const noexcept
-{
-	return (
-					FCompare(_q.m_s,m_s) &&
-					FCompare(_q.m_x,m_x) &&
-					FCompare(_q.m_y,m_y) &&
-					FCompare(_q.m_z,m_z)
-				 );
-}
-
-
-//----------------------------------------------------------------------------------------------------------------------
-Vec4 Quaternion::operator* (const Vec4 &_vec) const noexcept
-{
-	Quaternion temp=-*this;
-	Quaternion point(0.0,_vec.m_x,_vec.m_y,_vec.m_z);
-	point = temp*point* *this;
-	return Vec4(point.m_x,point.m_y,point.m_z,1.0);
-}
-
-
-
 
 void Quaternion::rotateX(Real _angle) noexcept
 {
@@ -336,7 +214,6 @@ Quaternion Quaternion::slerp(const Quaternion &_q1, const Quaternion &_q2, const
 }
 
 
-
 Mat4 Quaternion::toMat4() const noexcept
 {
   // written by Rob Bateman
@@ -416,10 +293,26 @@ Mat4 Quaternion::toMat4Transpose() const noexcept
 }
 
 
-
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief keeps an exported copy of the methods that are inline in Quaternion.h, see ExportInline.h
+//----------------------------------------------------------------------------------------------------------------------
+namespace detail
+{
+NGL_EXPORT_INLINE void exportQuaternionInline() noexcept
+{
+  exportInline(
+    static_cast<Quaternion (Quaternion::*)(const Quaternion &) const>(&Quaternion::operator*),
+    static_cast<Quaternion (Quaternion::*)(Real) const>(&Quaternion::operator*),
+    static_cast<Vec4 (Quaternion::*)(const Vec4 &) const>(&Quaternion::operator*),
+    static_cast<void (Quaternion::*)(const Quaternion &)>(&Quaternion::operator*=),
+    static_cast<void (Quaternion::*)(Real)>(&Quaternion::operator*=),
+    static_cast<Quaternion (Quaternion::*)(const Quaternion &) const>(&Quaternion::operator-),
+    &Quaternion::operator+, &Quaternion::operator+=, &Quaternion::operator-=,
+    &Quaternion::normalise, &Quaternion::magnitude, &Quaternion::operator==
+  );
+}
+} // end namespace detail
 
 } // end ngl namespace
 //----------------------------------------------------------------------------------------------------------------------
 
-
-
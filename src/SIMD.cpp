@@ -0,0 +1,103 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "SIMD.h"
+#include <atomic>
+#if defined(NGL_SIMD_X86) && defined(_MSC_VER)
+  #include <intrin.h>
+  #include <immintrin.h>
+#elif defined(NGL_SIMD_X86)
+  #include <cpuid.h>
+#endif
+//----------------------------------------------------------------------------------------------------------------------
+/// @file SIMD.cpp
+/// @brief implementation of the cpu feature detection
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace ngl
+{
+
+namespace
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  std::atomic<SIMDLevel> &currentLevel() noexcept
+  {
+    // function static so the maths classes can safely be used from other static initialisers, atomic as the
+    // batch kernels read it from the worker threads
+    static std::atomic<SIMDLevel> s_level(cpuSIMDLevel());
+    return s_level;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+SIMDLevel cpuSIMDLevel() noexcept
+{
+#if !defined(NGL_SIMD_X86)
+  return SIMDLevel::SCALAR;
+#elif defined(_MSC_VER)
+  int info[4];
+  __cpuid(info,1);
+  // AVX needs both the cpu bit (28) and the os saving the ymm registers (OSXSAVE bit 27 + XCR0)
+  bool avx = (info[2] & (1<<28)) && (info[2] & (1<<27)) && ((_xgetbv(0) & 0x6) == 0x6);
+  return avx ? SIMDLevel::AVX : SIMDLevel::SSE2;
+#else
+  // gcc / clang check the os support for the ymm state as part of the avx test
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx"))
+  {
+    return SIMDLevel::AVX;
+  }
+  return SIMDLevel::SSE2;
+#endif
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+SIMDLevel activeSIMDLevel() noexcept
+{
+  return currentLevel().load(std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void setSIMDLevel(SIMDLevel _level) noexcept
+{
+  SIMDLevel max=cpuSIMDLevel();
+  currentLevel().store(_level > max ? max : _level,std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool useF16C() noexcept
+{
+#if !defined(NGL_SIMD_X86)
+  return false;
+#else
+  static const bool s_f16c=[]()
+  {
+    // F16C is ecx bit 29 of leaf 1, it is vex encoded so also needs the os avx support checked by cpuSIMDLevel
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info,1);
+    bool bit=(info[2] & (1<<29))!=0;
+#else
+    unsigned int a,b,c,d;
+    bool bit=__get_cpuid(1,&a,&b,&c,&d) && (c & (1u<<29));
+#endif
+    return bit && cpuSIMDLevel()==SIMDLevel::AVX;
+  }();
+  return s_f16c && activeSIMDLevel()==SIMDLevel::AVX;
+#endif
+}
+
+} // end namespace ngl
@@ -0,0 +1,586 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "SceneBVH.h"
+#include "BBox.h"
+#include "Camera.h"
+#include "Frustum.h"
+#include "Transformation.h"
+#include "NGLassert.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file SceneBVH.cpp
+/// @brief implementation files for SceneBVH class
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace ngl
+{
+constexpr uint32_t SceneBVH::c_null;
+
+namespace
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief half the surface area of a box, the chance a random ray or small view hits it goes with this
+  //----------------------------------------------------------------------------------------------------------------------
+  inline Real area(const Vec3 &_min, const Vec3 &_max) noexcept
+  {
+    Real x=_max.m_x-_min.m_x;
+    Real y=_max.m_y-_min.m_y;
+    Real z=_max.m_z-_min.m_z;
+    return x*y + y*z + z*x;
+  }
+
+  inline Vec3 minOf(const Vec3 &_a, const Vec3 &_b) noexcept
+  {
+    return Vec3(std::min(_a.m_x,_b.m_x),std::min(_a.m_y,_b.m_y),std::min(_a.m_z,_b.m_z));
+  }
+
+  inline Vec3 maxOf(const Vec3 &_a, const Vec3 &_b) noexcept
+  {
+    return Vec3(std::max(_a.m_x,_b.m_x),std::max(_a.m_y,_b.m_y),std::max(_a.m_z,_b.m_z));
+  }
+
+  inline Real unionArea(const Vec3 &_minA, const Vec3 &_maxA, const Vec3 &_minB, const Vec3 &_maxB) noexcept
+  {
+    return area(minOf(_minA,_minB),maxOf(_maxA,_maxB));
+  }
+
+  inline bool contains(const Vec3 &_outerMin, const Vec3 &_outerMax, const Vec3 &_min, const Vec3 &_max) noexcept
+  {
+    return _outerMin.m_x<=_min.m_x && _outerMin.m_y<=_min.m_y && _outerMin.m_z<=_min.m_z &&
+           _max.m_x<=_outerMax.m_x && _max.m_y<=_outerMax.m_y && _max.m_z<=_outerMax.m_z;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void SceneBVH::transformBox(const BBox &_box, const Mat4 &_transform, Vec3 &o_min, Vec3 &o_max) noexcept
+{
+  Bounds3 b=_box.getBounds().transformed(_transform);
+  o_min=b.m_min;
+  o_max=b.m_max;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+uint32_t SceneBVH::allocateNode()
+{
+  uint32_t node;
+  if(m_free!=c_null)
+  {
+    node=m_free;
+    m_free=m_nodes[node].m_parent;
+    m_nodes[node]=Node();
+  }
+  else
+  {
+    // the frustum query uses the top bit of a node index
+    NGL_ASSERT(m_nodes.size()<(size_t(1)<<31));
+    node=static_cast<uint32_t>(m_nodes.size());
+    m_nodes.push_back(Node());
+  }
+  return node;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void SceneBVH::freeNode(uint32_t _node) noexcept
+{
+  m_nodes[_node].m_parent=m_free;
+  m_nodes[_node].m_height=-1;
+  m_free=_node;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+uint32_t SceneBVH::insert(const Vec3 &_min, const Vec3 &_max, size_t _userData)
+{
+  uint32_t leaf=allocateNode();
+  Node &n=m_nodes[leaf];
+  Vec3 margin(m_margin,m_margin,m_margin);
+  n.m_tightMin=_min;
+  n.m_tightMax=_max;
+  n.m_min=_min-margin;
+  n.m_max=_max+margin;
+  n.m_userData=_userData;
+  insertLeaf(leaf);
+  ++m_size;
+  return leaf;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+uint32_t SceneBVH::insert(const BBox &_box, const Mat4 &_transform, size_t _userData)
+{
+  Vec3 mn,mx;
+  transformBox(_box,_transform,mn,mx);
+  return insert(mn,mx,_userData);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+uint32_t SceneBVH::insert(const BBox &_box, Transformation &_transform, size_t _userData)
+{
+  return insert(_box,_transform.getMatrix(),_userData);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void SceneBVH::remove(uint32_t _id) noexcept
+{
+  NGL_ASSERT(_id<m_nodes.size() && m_nodes[_id].isLeaf() && m_nodes[_id].m_height==0);
+  removeLeaf(_id);
+  freeNode(_id);
+  --m_size;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool SceneBVH::move(uint32_t _id, const Vec3 &_min, const Vec3 &_max) noexcept
+{
+  NGL_ASSERT(_id<m_nodes.size() && m_nodes[_id].isLeaf() && m_nodes[_id].m_height==0);
+  Node &n=m_nodes[_id];
+  n.m_tightMin=_min;
+  n.m_tightMax=_max;
+  if(contains(n.m_min,n.m_max,_min,_max))
+  {
+    return false;
+  }
+  removeLeaf(_id);
+  Vec3 margin(m_margin,m_margin,m_margin);
+  n.m_min=_min-margin;
+  n.m_max=_max+margin;
+  // removing a leaf only frees its old parent so one node is always free for the reinsert
+  insertLeaf(_id);
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool SceneBVH::move(uint32_t _id, const BBox &_box, const Mat4 &_transform) noexcept
+{
+  Vec3 mn,mx;
+  transformBox(_box,_transform,mn,mx);
+  return move(_id,mn,mx);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool SceneBVH::move(uint32_t _id, const BBox &_box, Transformation &_transform) noexcept
+{
+  return move(_id,_box,_transform.getMatrix());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void SceneBVH::clear() noexcept
+{
+  m_nodes.clear();
+  m_root=c_null;
+  m_free=c_null;
+  m_size=0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void SceneBVH::insertLeaf(uint32_t _leaf) noexcept
+{
+  if(m_root==c_null)
+  {
+    m_root=_leaf;
+    m_nodes[_leaf].m_parent=c_null;
+    return;
+  }
+  // walk down to the sibling that adds the least area, at each node the cost of pairing here is the area of
+  // the new parent plus the growth of every ancestor, going down costs the growth of this node plus the
+  // growth of the child (or the new parent's area if the child is a leaf)
+  const Vec3 leafMin=m_nodes[_leaf].m_min;
+  const Vec3 leafMax=m_nodes[_leaf].m_max;
+  uint32_t index=m_root;
+  while(!m_nodes[index].isLeaf())
+  {
+    const Node &n=m_nodes[index];
+    Real nodeArea=area(n.m_min,n.m_max);
+    Real combined=unionArea(n.m_min,n.m_max,leafMin,leafMax);
+    Real cost=2.0f*combined;
+    Real inherited=2.0f*(combined-nodeArea);
+    Real childCost[2];
+    for(int c=0; c<2; ++c)
+    {
+      const Node &child=m_nodes[n.m_child[c]];
+      Real grown=unionArea(child.m_min,child.m_max,leafMin,leafMax);
+      childCost[c]=(child.isLeaf() ? grown : grown-area(child.m_min,child.m_max))+inherited;
+    }
+    if(cost<childCost[0] && cost<childCost[1])
+    {
+      break;
+    }
+    index=n.m_child[childCost[0]<=childCost[1] ? 0 : 1];
+  }
+
+  uint32_t sibling=index;
+  uint32_t parent=allocateNode();
+  uint32_t oldParent=m_nodes[sibling].m_parent;
+  Node &p=m_nodes[parent];
+  p.m_parent=oldParent;
+  p.m_child[0]=sibling;
+  p.m_child[1]=_leaf;
+  m_nodes[sibling].m_parent=parent;
+  m_nodes[_leaf].m_parent=parent;
+  if(oldParent==c_null)
+  {
+    m_root=parent;
+  }
+  else
+  {
+    Node &o=m_nodes[oldParent];
+    o.m_child[o.m_child[0]==sibling ? 0 : 1]=parent;
+  }
+  fixUpwards(parent);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void SceneBVH::removeLeaf(uint32_t _leaf) noexcept
+{
+  if(_leaf==m_root)
+  {
+    m_root=c_null;
+    return;
+  }
+  uint32_t parent=m_nodes[_leaf].m_parent;
+  uint32_t grandParent=m_nodes[parent].m_parent;
+  uint32_t sibling=m_nodes[parent].m_child[m_nodes[parent].m_child[0]==_leaf ? 1 : 0];
+  m_nodes[sibling].m_parent=grandParent;
+  freeNode(parent);
+  if(grandParent==c_null)
+  {
+    m_root=sibling;
+  }
+  else
+  {
+    Node &g=m_nodes[grandParent];
+    g.m_child[g.m_child[0]==parent ? 0 : 1]=sibling;
+    fixUpwards(grandParent);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void SceneBVH::refitNode(uint32_t _node) noexcept
+{
+  Node &n=m_nodes[_node];
+  const Node &a=m_nodes[n.m_child[0]];
+  const Node &b=m_nodes[n.m_child[1]];
+  n.m_min=minOf(a.m_min,b.m_min);
+  n.m_max=maxOf(a.m_max,b.m_max);
+  n.m_height=1+std::max(a.m_height,b.m_height);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void SceneBVH::fixUpwards(uint32_t _node) noexcept
+{
+  while(_node!=c_null)
+  {
+    _node=balance(_node);
+    refitNode(_node);
+    _node=m_nodes[_node].m_parent;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+uint32_t SceneBVH::balance(uint32_t _node) noexcept
+{
+  // the children's heights must be right, _node's own box and height are refit by the caller
+  Node &a=m_nodes[_node];
+  if(a.isLeaf() || a.m_height<2)
+  {
+    return _node;
+  }
+  int h0=m_nodes[a.m_child[0]].m_height;
+  int h1=m_nodes[a.m_child[1]].m_height;
+  int tall;
+  if(h1-h0>1)
+  {
+    tall=1;
+  }
+  else if(h0-h1>1)
+  {
+    tall=0;
+  }
+  else
+  {
+    return _node;
+  }
+  // the taller child c takes the place of a, a keeps the shorter of c's children and c keeps the other
+  uint32_t c=a.m_child[tall];
+  Node &cn=m_nodes[c];
+  uint32_t f=cn.m_child[0];
+  uint32_t g=cn.m_child[1];
+  cn.m_child[0]=_node;
+  cn.m_parent=a.m_parent;
+  a.m_parent=c;
+  if(cn.m_parent==c_null)
+  {
+    m_root=c;
+  }
+  else
+  {
+    Node &p=m_nodes[cn.m_parent];
+    p.m_child[p.m_child[0]==_node ? 0 : 1]=c;
+  }
+  if(m_nodes[f].m_height<m_nodes[g].m_height)
+  {
+    std::swap(f,g);
+  }
+  // f is the taller so stays with c, g moves down to a
+  cn.m_child[1]=f;
+  a.m_child[tall]=g;
+  m_nodes[g].m_parent=_node;
+  refitNode(_node);
+  return c;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void SceneBVH::rebuild()
+{
+  if(m_root==c_null)
+  {
+    return;
+  }
+  std::vector<uint32_t> leaves;
+  leaves.reserve(m_size);
+  std::vector<uint32_t> stack(1,m_root);
+  while(!stack.empty())
+  {
+    uint32_t node=stack.back();
+    stack.pop_back();
+    if(m_nodes[node].isLeaf())
+    {
+      leaves.push_back(node);
+    }
+    else
+    {
+      stack.push_back(m_nodes[node].m_child[0]);
+      stack.push_back(m_nodes[node].m_child[1]);
+      freeNode(node);
+    }
+  }
+  m_root=buildRange(leaves,0,leaves.size());
+  m_nodes[m_root].m_parent=c_null;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+uint32_t SceneBVH::buildRange(std::vector<uint32_t> &io_leaves, size_t _begin, size_t _end)
+{
+  size_t count=_end-_begin;
+  if(count==1)
+  {
+    return io_leaves[_begin];
+  }
+  // sort by the centre along each axis and sweep both ways to find the split with the least
+  // area(left)*n(left) + area(right)*n(right)
+  auto centre=[this](uint32_t _l, int _axis)
+  {
+    return m_nodes[_l].m_min.m_openGL[_axis]+m_nodes[_l].m_max.m_openGL[_axis];
+  };
+  std::vector<Real> rightArea(count);
+  Real bestCost=std::numeric_limits<Real>::max();
+  int bestAxis=0;
+  size_t bestSplit=count/2;
+  auto first=io_leaves.begin()+static_cast<ptrdiff_t>(_begin);
+  auto last=io_leaves.begin()+static_cast<ptrdiff_t>(_end);
+  for(int axis=0; axis<3; ++axis)
+  {
+    std::sort(first,last,[&](uint32_t _a, uint32_t _b){ return centre(_a,axis)<centre(_b,axis); });
+    Vec3 mn=m_nodes[io_leaves[_end-1]].m_min;
+    Vec3 mx=m_nodes[io_leaves[_end-1]].m_max;
+    for(size_t i=count-1; i>0; --i)
+    {
+      const Node &n=m_nodes[io_leaves[_begin+i]];
+      mn=minOf(mn,n.m_min);
+      mx=maxOf(mx,n.m_max);
+      rightArea[i]=area(mn,mx);
+    }
+    mn=m_nodes[io_leaves[_begin]].m_min;
+    mx=m_nodes[io_leaves[_begin]].m_max;
+    for(size_t i=1; i<count; ++i)
+    {
+      Real cost=area(mn,mx)*static_cast<Real>(i)+rightArea[i]*static_cast<Real>(count-i);
+      if(cost<bestCost)
+      {
+        bestCost=cost;
+        bestAxis=axis;
+        bestSplit=i;
+      }
+      const Node &n=m_nodes[io_leaves[_begin+i]];
+      mn=minOf(mn,n.m_min);
+      mx=maxOf(mx,n.m_max);
+    }
+  }
+  if(bestAxis!=2)
+  {
+    std::sort(first,last,[&](uint32_t _a, uint32_t _b){ return centre(_a,bestAxis)<centre(_b,bestAxis); });
+  }
+  uint32_t left=buildRange(io_leaves,_begin,_begin+bestSplit);
+  uint32_t right=buildRange(io_leaves,_begin+bestSplit,_end);
+  uint32_t node=allocateNode();
+  m_nodes[node].m_child[0]=left;
+  m_nodes[node].m_child[1]=right;
+  m_nodes[left].m_parent=node;
+  m_nodes[right].m_parent=node;
+  refitNode(node);
+  return node;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+int SceneBVH::getHeight() const noexcept
+{
+  return m_root==c_null ? 0 : m_nodes[m_root].m_height;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+Real SceneBVH::getCost() const noexcept
+{
+  if(m_root==c_null || m_nodes[m_root].isLeaf())
+  {
+    return 0.0f;
+  }
+  Real total=0.0f;
+  for(const auto &n : m_nodes)
+  {
+    if(n.m_height>0)
+    {
+      total+=area(n.m_min,n.m_max);
+    }
+  }
+  Real root=area(m_nodes[m_root].m_min,m_nodes[m_root].m_max);
+  return root>0.0f ? total/root : 0.0f;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template<typename Test>
+void SceneBVH::query(Test _test, std::vector<size_t> &o_userData) const
+{
+  if(m_root==c_null)
+  {
+    return;
+  }
+  std::vector<uint32_t> stack;
+  stack.reserve(64);
+  stack.push_back(m_root);
+  while(!stack.empty())
+  {
+    const Node &n=m_nodes[stack.back()];
+    stack.pop_back();
+    if(n.isLeaf())
+    {
+      if(_test(n.m_tightMin,n.m_tightMax))
+      {
+        o_userData.push_back(n.m_userData);
+      }
+    }
+    else if(_test(n.m_min,n.m_max))
+    {
+      stack.push_back(n.m_child[1]);
+      stack.push_back(n.m_child[0]);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void SceneBVH::queryFrustum(const Frustum &_frustum, std::vector<size_t> &o_userData) const
+{
+  if(m_root==c_null)
+  {
+    return;
+  }
+  // a subtree outside any plane is dropped and one inside all of them is taken whole, the leaves inside a
+  // node's box are inside it too so this gives the same answer as testing every leaf. The nodes of a whole
+  // subtree go on the stack with the top bit set so they are not tested again
+  constexpr uint32_t inside=1u<<31;
+  std::vector<uint32_t> stack;
+  stack.reserve(64);
+  stack.push_back(m_root);
+  while(!stack.empty())
+  {
+    uint32_t entry=stack.back();
+    stack.pop_back();
+    const Node &n=m_nodes[entry & ~inside];
+    CameraIntercept result=CameraIntercept::INSIDE;
+    if(!(entry & inside))
+    {
+      result=n.isLeaf() ? _frustum.boxInFrustum(n.m_tightMin,n.m_tightMax) : _frustum.boxInFrustum(n.m_min,n.m_max);
+    }
+    if(result==CameraIntercept::OUTSIDE)
+    {
+      continue;
+    }
+    if(n.isLeaf())
+    {
+      o_userData.push_back(n.m_userData);
+      continue;
+    }
+    uint32_t flag=result==CameraIntercept::INSIDE ? inside : 0u;
+    stack.push_back(n.m_child[1] | flag);
+    stack.push_back(n.m_child[0] | flag);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void SceneBVH::queryFrustum(const Camera &_camera, std::vector<size_t> &o_userData) const
+{
+  queryFrustum(_camera.getFrustum(),o_userData);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void SceneBVH::querySphere(const Vec3 &_centre, Real _radius, std::vector<size_t> &o_userData) const
+{
+  const Real r2=_radius*_radius;
+  query([&](const Vec3 &_min, const Vec3 &_max)
+  {
+    // the squared distance from the centre to the nearest point of the box
+    Real d2=0.0f;
+    for(int i=0; i<3; ++i)
+    {
+      Real c=_centre.m_openGL[i];
+      Real d=c<_min.m_openGL[i] ? _min.m_openGL[i]-c : (c>_max.m_openGL[i] ? c-_max.m_openGL[i] : 0.0f);
+      d2+=d*d;
+    }
+    return d2<=r2;
+  },o_userData);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void SceneBVH::queryBox(const Vec3 &_min, const Vec3 &_max, std::vector<size_t> &o_userData) const
+{
+  query([&](const Vec3 &_bMin, const Vec3 &_bMax)
+  {
+    return _bMin.m_x<=_max.m_x && _bMax.m_x>=_min.m_x &&
+           _bMin.m_y<=_max.m_y && _bMax.m_y>=_min.m_y &&
+           _bMin.m_z<=_max.m_z && _bMax.m_z>=_min.m_z;
+  },o_userData);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void SceneBVH::queryRay(const Vec3 &_origin, const Vec3 &_dir, Real _tMax, std::vector<size_t> &o_userData) const
+{
+  const Vec3 inv(1.0f/_dir.m_x,1.0f/_dir.m_y,1.0f/_dir.m_z);
+  query([&](const Vec3 &_min, const Vec3 &_max)
+  {
+    // slab test, a zero direction gives +-inf which the min / max order handles
+    Real tNear=0.0f;
+    Real tFar=_tMax;
+    for(int i=0; i<3; ++i)
+    {
+      Real t0=(_min.m_openGL[i]-_origin.m_openGL[i])*inv.m_openGL[i];
+      Real t1=(_max.m_openGL[i]-_origin.m_openGL[i])*inv.m_openGL[i];
+      tNear=std::max(tNear,std::min(t0,t1));
+      tFar=std::min(tFar,std::max(t0,t1));
+    }
+    return tNear<=tFar;
+  },o_userData);
+}
+
+} // end namespace ngl
@@ -20,6 +20,20 @@ namespace ngl
     glDrawElements(m_mode,static_cast<GLsizei>(m_indicesCount),m_indexType,static_cast<GLvoid *>(nullptr));
   }
 
+  void SimpleIndexVAO::drawRange(size_t _first, size_t _count) const
+  {
+    if(m_allocated == false)
+    {
+      std::cerr<<"Warning trying to draw an unallocated VOA\n";
+    }
+    if(m_bound == false)
+    {
+      std::cerr<<"Warning trying to draw an unbound VOA\n";
+    }
+    size_t indexBytes= m_indexType==GL_UNSIGNED_SHORT ? sizeof(GLushort) : m_indexType==GL_UNSIGNED_BYTE ? sizeof(GLubyte) : sizeof(GLuint);
+    glDrawElements(m_mode,static_cast<GLsizei>(_count),m_indexType,reinterpret_cast<GLvoid *>(_first*indexBytes));
+  }
+
   void SimpleIndexVAO::removeVAO()
   {
     if(m_bound == true)
@@ -29,6 +43,7 @@ namespace ngl
     if( m_allocated ==true)
     {
         glDeleteBuffers(1,&m_buffer);
+        glDeleteBuffers(1,&m_indexBuffer);
     }
     glDeleteVertexArrays(1,&m_id);
     m_allocated=false;
@@ -43,14 +58,17 @@ namespace ngl
     {
     std::cerr<<"trying to set VOA data when unbound\n";
     }
-    GLuint vboID;
-    glGenBuffers(1, &vboID);
-
-    GLuint iboID;
-    glGenBuffers(1, &iboID);
+    if( m_allocated ==true)
+    {
+        glDeleteBuffers(1,&m_buffer);
+        glDeleteBuffers(1,&m_indexBuffer);
+    }
+    // keep the ids so getBufferID can map the vertex data and removeVAO can free both
+    glGenBuffers(1, &m_buffer);
+    glGenBuffers(1, &m_indexBuffer);
 
     // now we will bind an array buffer to the first one and load the data for the verts
-    glBindBuffer(GL_ARRAY_BUFFER, vboID);
+    glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
     glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(data.m_size), &data.m_data, data.m_mode);
     // we need to determine the size of the data type before we set it
     // in default to a ushort
@@ -63,7 +81,7 @@ namespace ngl
       default : std::cerr<<"wrong data type send for index value\n"; break;
     }
     // now for the indices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, iboID);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.m_indexSize * static_cast<GLsizeiptr>(size), const_cast<GLvoid *>(data.m_indexData),data.m_mode);
 
     m_allocated=true;
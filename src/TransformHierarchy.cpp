@@ -0,0 +1,246 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "TransformHierarchy.h"
+#include "NGLassert.h"
+#include "ParallelFor.h"
+#include <algorithm>
+#include <thread>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file TransformHierarchy.cpp
+/// @brief implementation files for TransformHierarchy class
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace ngl
+{
+constexpr size_t TransformHierarchy::c_noParent;
+
+namespace
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief below this many nodes the parallel update is not worth starting threads for
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr size_t c_parallelThreshold=4096;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the minimum number of nodes of one depth given to each thread, narrower levels are done inline
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr size_t c_levelGrain=256;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+size_t TransformHierarchy::addNode(size_t _parent)
+{
+  size_t node=m_parent.size();
+  NGL_ASSERT(_parent==c_noParent || _parent<node);
+  m_parent.push_back(_parent);
+  m_root.push_back(_parent==c_noParent ? node : m_root[_parent]);
+  m_position.push_back(Vec3(0.0f,0.0f,0.0f));
+  m_rotation.push_back(Vec3(0.0f,0.0f,0.0f));
+  m_scale.push_back(Vec3(1.0f,1.0f,1.0f));
+  m_local.push_back(Mat4());
+  m_localInverse.push_back(Mat4());
+  m_world.push_back(Mat4());
+  m_worldInverse.push_back(Mat4());
+  // flagged so the first update gives it the parent's world matrix
+  m_localDirty.push_back(1);
+  m_worldChanged.push_back(0);
+  m_orderValid=false;
+  return node;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void TransformHierarchy::clear() noexcept
+{
+  m_parent.clear();
+  m_root.clear();
+  m_position.clear();
+  m_rotation.clear();
+  m_scale.clear();
+  m_local.clear();
+  m_localInverse.clear();
+  m_world.clear();
+  m_worldInverse.clear();
+  m_localDirty.clear();
+  m_worldChanged.clear();
+  m_orderValid=false;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void TransformHierarchy::reserve(size_t _count)
+{
+  m_parent.reserve(_count);
+  m_root.reserve(_count);
+  m_position.reserve(_count);
+  m_rotation.reserve(_count);
+  m_scale.reserve(_count);
+  m_local.reserve(_count);
+  m_localInverse.reserve(_count);
+  m_world.reserve(_count);
+  m_worldInverse.reserve(_count);
+  m_localDirty.reserve(_count);
+  m_worldChanged.reserve(_count);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void TransformHierarchy::setPosition(size_t _node, const Vec3 &_v) noexcept
+{
+  m_position[_node]=_v;
+  m_localDirty[_node]=1;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void TransformHierarchy::setRotation(size_t _node, const Vec3 &_v) noexcept
+{
+  m_rotation[_node]=_v;
+  m_localDirty[_node]=1;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void TransformHierarchy::setScale(size_t _node, const Vec3 &_v) noexcept
+{
+  m_scale[_node]=_v;
+  m_localDirty[_node]=1;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void TransformHierarchy::setTransform(size_t _node, const Vec3 &_position, const Vec3 &_rotation, const Vec3 &_scale) noexcept
+{
+  m_position[_node]=_position;
+  m_rotation[_node]=_rotation;
+  m_scale[_node]=_scale;
+  m_localDirty[_node]=1;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool TransformHierarchy::isDirty(size_t _node) const noexcept
+{
+  for(size_t n=_node; n!=c_noParent; n=m_parent[n])
+  {
+    if(m_localDirty[n])
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+template<typename Index>
+void TransformHierarchy::updateNodes(Index _index, size_t _begin, size_t _end) noexcept
+{
+  for(size_t i=_begin; i<_end; ++i)
+  {
+    size_t node=_index(i);
+    size_t parent=m_parent[node];
+    bool localChanged=m_localDirty[node]!=0;
+    bool changed=localChanged || (parent!=c_noParent && m_worldChanged[parent]);
+    m_worldChanged[node]=changed;
+    if(!changed)
+    {
+      continue;
+    }
+    if(localChanged)
+    {
+      Mat4::fromTRS(m_position[node],m_rotation[node],m_scale[node],m_local[node],m_localInverse[node]);
+      m_localDirty[node]=0;
+    }
+    if(parent==c_noParent)
+    {
+      m_world[node]=m_local[node];
+      m_worldInverse[node]=m_localInverse[node];
+    }
+    else
+    {
+      // world = local * parent so world^-1 = parent^-1 * local^-1
+      m_world[node]=m_local[node]*m_world[parent];
+      m_worldInverse[node]=m_worldInverse[parent]*m_localInverse[node];
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void TransformHierarchy::update() noexcept
+{
+  updateNodes([](size_t _i){ return _i; },0,size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void TransformHierarchy::buildOrders()
+{
+  // a stable sort by root (or depth) keeps each group in topological order
+  std::vector<size_t> depth(size());
+  for(size_t i=0; i<size(); ++i)
+  {
+    depth[i]= m_parent[i]==c_noParent ? 0 : depth[m_parent[i]]+1;
+  }
+  auto group=[this](std::vector<size_t> &o_order, std::vector<size_t> &o_start, const std::vector<size_t> &_key)
+  {
+    o_order.resize(size());
+    for(size_t i=0; i<o_order.size(); ++i)
+    {
+      o_order[i]=i;
+    }
+    std::stable_sort(o_order.begin(),o_order.end(),[&_key](size_t _a, size_t _b){ return _key[_a]<_key[_b]; });
+    o_start.clear();
+    for(size_t i=0; i<o_order.size(); ++i)
+    {
+      if(i==0 || _key[o_order[i]]!=_key[o_order[i-1]])
+      {
+        o_start.push_back(i);
+      }
+    }
+    o_start.push_back(o_order.size());
+  };
+  group(m_order,m_rootStart,m_root);
+  group(m_depthOrder,m_depthStart,depth);
+  m_orderValid=true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void TransformHierarchy::updateParallel()
+{
+  if(size()<c_parallelThreshold)
+  {
+    update();
+    return;
+  }
+  if(!m_orderValid)
+  {
+    buildOrders();
+  }
+  size_t numRoots=m_rootStart.size()-1;
+  size_t hw=std::max(1u,std::thread::hardware_concurrency());
+  if(numRoots>=2*hw)
+  {
+    // enough separate trees to keep every thread busy, each tree is done start to finish by one thread
+    parallelFor(numRoots,1,[this](size_t _begin, size_t _end)
+    {
+      updateNodes([this](size_t _i){ return m_order[_i]; },m_rootStart[_begin],m_rootStart[_end]);
+    });
+    return;
+  }
+  // a few large trees, the nodes of each depth only need the level above so each level is split over threads
+  for(size_t l=0; l+1<m_depthStart.size(); ++l)
+  {
+    size_t first=m_depthStart[l];
+    parallelFor(m_depthStart[l+1]-first,c_levelGrain,[this,first](size_t _begin, size_t _end)
+    {
+      updateNodes([this](size_t _i){ return m_depthOrder[_i]; },first+_begin,first+_end);
+    });
+  }
+}
+
+} // end namespace ngl
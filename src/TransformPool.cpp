@@ -0,0 +1,274 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "TransformPool.h"
+#include "NGLassert.h"
+#include "ParallelFor.h"
+#include "SoAKernels.h"
+#include "Util.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file TransformPool.cpp
+/// @brief implementation files for TransformPool class
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace ngl
+{
+namespace
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the minimum number of slots given to each thread by update
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr size_t c_grainSize=4096;
+
+#ifdef NGL_SIMD_X86
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief Mat4::fromTRS for the 4 slots starting at _i, o_m[lane][row] and o_inv[lane][row] are the rows
+  /// of each matrix
+  //----------------------------------------------------------------------------------------------------------------------
+  void fromTRS4(const Vec3Array &_t, const Vec3Array &_r, const Vec3Array &_s, size_t _i,
+                __m128 o_m[4][4], __m128 o_inv[4][4]) noexcept
+  {
+    const __m128 toRadians=_mm_set1_ps(PI/180.0f);
+    const __m128 zero=_mm_setzero_ps();
+    const __m128 one=_mm_set1_ps(1.0f);
+    __m128 sx,cx,sy,cy,sz,cz;
+    soa::sinCos(_mm_mul_ps(_mm_load_ps(_r.x()+_i),toRadians),sx,cx);
+    soa::sinCos(_mm_mul_ps(_mm_load_ps(_r.y()+_i),toRadians),sy,cy);
+    soa::sinCos(_mm_mul_ps(_mm_load_ps(_r.z()+_i),toRadians),sz,cz);
+    __m128 sxsy=_mm_mul_ps(sx,sy);
+    __m128 cxsy=_mm_mul_ps(cx,sy);
+    // rotateX * rotateY * rotateZ expanded as in Mat4::fromTRS
+    __m128 rot[3][3]={
+                       { _mm_mul_ps(cy,cz), _mm_mul_ps(cy,sz), _mm_sub_ps(zero,sy) },
+                       { _mm_sub_ps(_mm_mul_ps(sxsy,cz),_mm_mul_ps(cx,sz)), _mm_add_ps(_mm_mul_ps(sxsy,sz),_mm_mul_ps(cx,cz)), _mm_mul_ps(sx,cy) },
+                       { _mm_add_ps(_mm_mul_ps(cxsy,cz),_mm_mul_ps(sx,sz)), _mm_sub_ps(_mm_mul_ps(cxsy,sz),_mm_mul_ps(sx,cz)), _mm_mul_ps(cx,cy) }
+                     };
+    __m128 scale[3]={_mm_load_ps(_s.x()+_i),_mm_load_ps(_s.y()+_i),_mm_load_ps(_s.z()+_i)};
+    __m128 translate[3]={_mm_load_ps(_t.x()+_i),_mm_load_ps(_t.y()+_i),_mm_load_ps(_t.z()+_i)};
+    __m128 invScale[3];
+    for(int y=0; y<3; ++y)
+    {
+      invScale[y]=_mm_div_ps(one,scale[y]);
+    }
+    // each group of four registers holds one row for the 4 slots, transposed to give each slot's row
+    for(int y=0; y<3; ++y)
+    {
+      __m128 c0=_mm_mul_ps(scale[y],rot[y][0]);
+      __m128 c1=_mm_mul_ps(scale[y],rot[y][1]);
+      __m128 c2=_mm_mul_ps(scale[y],rot[y][2]);
+      __m128 c3=zero;
+      _MM_TRANSPOSE4_PS(c0,c1,c2,c3);
+      o_m[0][y]=c0; o_m[1][y]=c1; o_m[2][y]=c2; o_m[3][y]=c3;
+    }
+    __m128 t0=translate[0];
+    __m128 t1=translate[1];
+    __m128 t2=translate[2];
+    __m128 t3=one;
+    _MM_TRANSPOSE4_PS(t0,t1,t2,t3);
+    o_m[0][3]=t0; o_m[1][3]=t1; o_m[2][3]=t2; o_m[3][3]=t3;
+
+    for(int x=0; x<3; ++x)
+    {
+      __m128 c0=_mm_mul_ps(rot[0][x],invScale[0]);
+      __m128 c1=_mm_mul_ps(rot[1][x],invScale[1]);
+      __m128 c2=_mm_mul_ps(rot[2][x],invScale[2]);
+      __m128 c3=zero;
+      _MM_TRANSPOSE4_PS(c0,c1,c2,c3);
+      o_inv[0][x]=c0; o_inv[1][x]=c1; o_inv[2][x]=c2; o_inv[3][x]=c3;
+    }
+    __m128 it[4];
+    for(int y=0; y<3; ++y)
+    {
+      __m128 d=_mm_mul_ps(translate[0],rot[y][0]);
+      d=_mm_add_ps(d,_mm_mul_ps(translate[1],rot[y][1]));
+      d=_mm_add_ps(d,_mm_mul_ps(translate[2],rot[y][2]));
+      it[y]=_mm_mul_ps(_mm_sub_ps(zero,d),invScale[y]);
+    }
+    it[3]=one;
+    _MM_TRANSPOSE4_PS(it[0],it[1],it[2],it[3]);
+    o_inv[0][3]=it[0]; o_inv[1][3]=it[1]; o_inv[2][3]=it[2]; o_inv[3][3]=it[3];
+  }
+#endif
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+size_t TransformPool::add(const Vec3 &_position, const Vec3 &_rotation, const Vec3 &_scale)
+{
+  if(!m_free.empty())
+  {
+    size_t index=m_free.back();
+    m_free.pop_back();
+    setTransform(index,_position,_rotation,_scale);
+    return index;
+  }
+  size_t index=size();
+  m_position.push_back(_position);
+  m_rotation.push_back(_rotation);
+  m_scale.push_back(_scale);
+  m_matrix.push_back(Mat4());
+  m_inverse.push_back(Mat4());
+  m_dirty.push_back(1);
+  m_anyDirty=true;
+  return index;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void TransformPool::release(size_t _index)
+{
+  NGL_ASSERT(_index<size());
+  m_position.set(_index,Vec3(0.0f,0.0f,0.0f));
+  m_rotation.set(_index,Vec3(0.0f,0.0f,0.0f));
+  m_scale.set(_index,Vec3(1.0f,1.0f,1.0f));
+  m_matrix[_index]=Mat4();
+  m_inverse[_index]=Mat4();
+  m_dirty[_index]=0;
+  m_free.push_back(_index);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void TransformPool::clear() noexcept
+{
+  m_position.clear();
+  m_rotation.clear();
+  m_scale.clear();
+  m_dirty.clear();
+  m_matrix.clear();
+  m_inverse.clear();
+  m_free.clear();
+  m_anyDirty=false;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void TransformPool::reserve(size_t _count)
+{
+  m_dirty.reserve(_count);
+  m_matrix.reserve(_count);
+  m_inverse.reserve(_count);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void TransformPool::setPosition(size_t _index, const Vec3 &_v) noexcept
+{
+  m_position.set(_index,_v);
+  m_dirty[_index]=1;
+  m_anyDirty=true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void TransformPool::setRotation(size_t _index, const Vec3 &_v) noexcept
+{
+  m_rotation.set(_index,_v);
+  m_dirty[_index]=1;
+  m_anyDirty=true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void TransformPool::setScale(size_t _index, const Vec3 &_v) noexcept
+{
+  m_scale.set(_index,_v);
+  m_dirty[_index]=1;
+  m_anyDirty=true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void TransformPool::setTransform(size_t _index, const Vec3 &_position, const Vec3 &_rotation, const Vec3 &_scale) noexcept
+{
+  m_position.set(_index,_position);
+  m_rotation.set(_index,_rotation);
+  m_scale.set(_index,_scale);
+  m_dirty[_index]=1;
+  m_anyDirty=true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void TransformPool::setMatrix(size_t _index, const Mat4 &_m, const Mat4 &_inverse) noexcept
+{
+  m_matrix[_index]=_m;
+  m_inverse[_index]=_inverse;
+  m_dirty[_index]=0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void TransformPool::setAllDirty() noexcept
+{
+  std::fill(m_dirty.begin(),m_dirty.end(),1);
+  m_anyDirty=!m_dirty.empty();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void TransformPool::updateRange(size_t _begin, size_t _end) noexcept
+{
+  size_t i=_begin;
+#ifdef NGL_SIMD_X86
+  if(soa::useSIMD())
+  {
+    __m128 m[4][4];
+    __m128 inv[4][4];
+    for( ; i+4<=_end; i+=4)
+    {
+      uint32_t flags;
+      std::memcpy(&flags,&m_dirty[i],sizeof(flags));
+      if(flags==0)
+      {
+        continue;
+      }
+      fromTRS4(m_position,m_rotation,m_scale,i,m,inv);
+      for(size_t lane=0; lane<4; ++lane)
+      {
+        if(m_dirty[i+lane])
+        {
+          for(int row=0; row<4; ++row)
+          {
+            _mm_storeu_ps(&m_matrix[i+lane].m_m[row][0],m[lane][row]);
+            _mm_storeu_ps(&m_inverse[i+lane].m_m[row][0],inv[lane][row]);
+          }
+          m_dirty[i+lane]=0;
+        }
+      }
+    }
+  }
+#endif
+  for( ; i<_end; ++i)
+  {
+    update(i);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void TransformPool::update() noexcept
+{
+  if(!m_anyDirty)
+  {
+    return;
+  }
+  parallelFor(size(),c_grainSize,[this](size_t _begin, size_t _end){ updateRange(_begin,_end); });
+  m_anyDirty=false;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void TransformPool::update(size_t _index) noexcept
+{
+  if(m_dirty[_index])
+  {
+    Mat4::fromTRS(m_position.get(_index),m_rotation.get(_index),m_scale.get(_index),m_matrix[_index],m_inverse[_index]);
+    m_dirty[_index]=0;
+  }
+}
+
+} // end namespace ngl
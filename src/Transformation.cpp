@@ -16,6 +16,7 @@
 */
 #include "ShaderLib.h"
 #include "Transformation.h"
+#include "TransformPool.h"
 //----------------------------------------------------------------------------------------------------------------------
 /// @file Transformation.cpp
 /// @brief implementation files for Transformation class
@@ -37,7 +38,28 @@ Transformation::Transformation() noexcept
 
 }
 
-Transformation::Transformation(const Transformation &_t) noexcept
+Transformation::Transformation(TransformPool &_pool)
+{
+  m_position = Vec3(0.0f,0.0f,0.0f);
+  m_scale = Vec3(1.0f,1.0f,1.0f);
+  m_rotation = Vec3(0.0f,0.0f,0.0f);
+  m_isMatrixComputed = true;
+  m_matrix=1.0f;
+  m_transposeMatrix=1.0f;
+  m_inverseMatrix=1.0f;
+  m_pool=&_pool;
+  m_poolIndex=_pool.add(m_position,m_rotation,m_scale);
+}
+
+Transformation::~Transformation() noexcept
+{
+  if(m_pool !=nullptr)
+  {
+    m_pool->release(m_poolIndex);
+  }
+}
+
+Transformation::Transformation(const Transformation &_t)
 {
   //m_isMatrixComputed=false;
 
@@ -48,6 +70,13 @@ Transformation::Transformation(const Transformation &_t) noexcept
   this->m_matrix=_t.m_matrix;
   this->m_transposeMatrix=_t.m_transposeMatrix;
   this->m_inverseMatrix=_t.m_inverseMatrix;
+  // a copy of a pooled transform gets its own slot in the same pool
+  if(_t.m_pool !=nullptr)
+  {
+    m_pool=_t.m_pool;
+    m_poolIndex=m_pool->add(m_position,m_rotation,m_scale);
+    m_pool->setMatrix(m_poolIndex,m_matrix,m_inverseMatrix);
+  }
 }
 
 Transformation & Transformation::operator =(const Transformation &_t) noexcept
@@ -61,6 +90,12 @@ Transformation & Transformation::operator =(const Transformation &_t) noexcept
   this->m_matrix=_t.m_matrix;
   this->m_transposeMatrix=_t.m_transposeMatrix;
   this->m_inverseMatrix=_t.m_inverseMatrix;
+  // a pooled transform keeps its own slot and just takes the values
+  if(m_pool !=nullptr)
+  {
+    m_pool->setTransform(m_poolIndex,m_position,m_rotation,m_scale);
+    m_pool->setMatrix(m_poolIndex,m_matrix,m_inverseMatrix);
+  }
   return *this;
 }
 
@@ -72,33 +107,56 @@ void Transformation::setMatrix( const Mat4 &_m   ) noexcept
   m_matrix=_m;
   m_transposeMatrix=_m;
   m_transposeMatrix.transpose();
+  // only use the full inverse if we have been given a projective matrix
+  if(FCompare(_m.m_03,0.0f) && FCompare(_m.m_13,0.0f) && FCompare(_m.m_23,0.0f) && FCompare(_m.m_33,1.0f))
+  {
+    m_inverseMatrix=_m.inverseAffine();
+  }
+  else
+  {
+    Mat4 m(_m);
+    m_inverseMatrix=m.inverse();
+  }
   m_isMatrixComputed = true;
+  if(m_pool !=nullptr)
+  {
+    m_pool->setMatrix(m_poolIndex,m_matrix,m_inverseMatrix);
+  }
+}
+
+void Transformation::valuesChanged() noexcept
+{
+  m_isMatrixComputed = false;
+  if(m_pool !=nullptr)
+  {
+    m_pool->setTransform(m_poolIndex,m_position,m_rotation,m_scale);
+  }
 }
 
 // Set scale ---------------------------------------------------------------------------------------------------------------------
 void Transformation::setScale( const Vec3& _scale  ) noexcept
 {
   m_scale = _scale;
-  m_isMatrixComputed = false;
+  valuesChanged();
 }
 
 void Transformation::setScale( const Vec4& _scale  ) noexcept
 {
   m_scale = _scale;
-  m_isMatrixComputed = false;
+  valuesChanged();
 }
 
 void Transformation::setScale(Real _x, Real _y, Real _z  ) noexcept
 {
   m_scale.set(_x,_y,_z);
-  m_isMatrixComputed = false;
+  valuesChanged();
 }
 
 // add scale ---------------------------------------------------------------------------------------------------------------------
 void Transformation::addScale( const Vec3& _scale ) noexcept
 {
   m_scale += _scale;
-  m_isMatrixComputed = false;
+  valuesChanged();
 }
 
 
@@ -108,31 +166,31 @@ void Transformation::addScale(Real _x,  Real _y,  Real _z ) noexcept
   m_scale.m_y+=_y;
   m_scale.m_z+=_z;
 
-  m_isMatrixComputed = false;
+  valuesChanged();
 }
 
 // Set position --------------------------------------------------------------------------------------------------------------------
 void Transformation::setPosition(const Vec4 &_position ) noexcept
 {
   m_position = _position;
-  m_isMatrixComputed = false;
+  valuesChanged();
 }
 void Transformation::setPosition(const Vec3 &_position) noexcept
 {
   m_position = _position;
-  m_isMatrixComputed = false;
+  valuesChanged();
 }
 void Transformation::setPosition(Real _x, Real _y, Real _z  ) noexcept
 {
   m_position.set(_x,_y,_z);
-  m_isMatrixComputed = false;
+  valuesChanged();
 }
 
 // Set position --------------------------------------------------------------------------------------------------------------------
 void Transformation::addPosition( const Vec3& _position) noexcept
 {
   m_position+= _position;
-  m_isMatrixComputed = false;
+  valuesChanged();
 }
 void Transformation::addPosition( Real _x, Real _y, Real _z ) noexcept
 {
@@ -140,7 +198,7 @@ void Transformation::addPosition( Real _x, Real _y, Real _z ) noexcept
   m_position.m_y+=_y;
   m_position.m_z+=_z;
 
-  m_isMatrixComputed = false;
+  valuesChanged();
 }
 
 
@@ -148,12 +206,12 @@ void Transformation::addPosition( Real _x, Real _y, Real _z ) noexcept
 void Transformation::setRotation( const Vec3 &_rotation ) noexcept
 {
   m_rotation = _rotation;
-  m_isMatrixComputed = false;
+  valuesChanged();
 }
 void Transformation::setRotation( const Vec4 &_rotation ) noexcept
 {
   m_rotation = _rotation;
-  m_isMatrixComputed = false;
+  valuesChanged();
 }
 
 
@@ -161,7 +219,7 @@ void Transformation::setRotation(Real _x, Real _y,  Real _z ) noexcept
 {
   m_rotation.set(_x,_y,_z);
 
-  m_isMatrixComputed = false;
+  valuesChanged();
 }
 
 
@@ -169,14 +227,14 @@ void Transformation::setRotation(Real _x, Real _y,  Real _z ) noexcept
 void Transformation::addRotation(const Vec3 &_rotation  ) noexcept
 {
   m_rotation+= _rotation;
-  m_isMatrixComputed = false;
+  valuesChanged();
 }
 void Transformation::addRotation(Real _x, Real _y, Real _z) noexcept
 {
   m_rotation.m_x+=_x;
   m_rotation.m_y+=_y;
   m_rotation.m_z+=_z;
-  m_isMatrixComputed = false;
+  valuesChanged();
 }
 
 
@@ -186,54 +244,31 @@ void Transformation::reset() noexcept
   m_position = Vec3(0.0f,0.0f,0.0f);
   m_scale = Vec3(1.0f,1.0f,1.0f);
   m_rotation = Vec3(0.0f,0.0f,0.0f);
-  m_isMatrixComputed = false;
+  valuesChanged();
   computeMatrices();
 }
 
 // comptue matrix ---------------------------------------------------------------------------------------------------------------------
 void Transformation::computeMatrices() noexcept
 {
-  if (!m_isMatrixComputed)       // need to recalculate
+  if (!m_isMatrixComputed && m_pool !=nullptr)
   {
-    Mat4 scale;
-    Mat4 rX;
-    Mat4 rY;
-    Mat4 rZ;
-    Mat4 trans;
-
-    // rotation/scale matrix
-    Mat4 rotationScale;
-    scale.scale(m_scale.m_x, m_scale.m_y, m_scale.m_z);
-
-    rX.rotateX(m_rotation.m_x);
-    rY.rotateY(m_rotation.m_y);
-    rZ.rotateZ(m_rotation.m_z);
-    rotationScale = scale * rX * rY * rZ;
-
-    // transform matrix
-    m_matrix = rotationScale;
-    m_matrix.m_m[3][0] = m_position.m_x;
-    m_matrix.m_m[3][1] = m_position.m_y;
-    m_matrix.m_m[3][2] = m_position.m_z;
-    m_matrix.m_m[3][3] = 1;
-
-
+    // the pool may already have rebuilt the slot in a batch update, otherwise just this one is done
+    m_pool->update(m_poolIndex);
+    m_matrix=m_pool->getMatrix(m_poolIndex);
+    m_inverseMatrix=m_pool->getInverseMatrix(m_poolIndex);
+    m_transposeMatrix = m_matrix;
+    m_transposeMatrix.transpose();
+    m_isMatrixComputed = true;
+  }
+  else if (!m_isMatrixComputed)       // need to recalculate
+  {
+    // scale * rX * rY * rZ with the translation and its inverse built directly
+    Mat4::fromTRS(m_position,m_rotation,m_scale,m_matrix,m_inverseMatrix);
 
     // tranpose matrix
-    m_transposeMatrix = rotationScale;
+    m_transposeMatrix = m_matrix;
     m_transposeMatrix.transpose();
-    m_transposeMatrix.m_m[0][3] = m_position.m_x;
-    m_transposeMatrix.m_m[1][3] = m_position.m_y;
-    m_transposeMatrix.m_m[2][3] = m_position.m_z;
-    m_transposeMatrix.m_m[3][3] = 1;
-
-    // inverse matrix
-    trans.translate(-m_position.m_x, -m_position.m_y, -m_position.m_z);
-    scale.scale(1.0f / m_scale.m_x, 1.0f / m_scale.m_y, 1.0f / m_scale.m_z);
-    rX.rotateX(-m_rotation.m_x);
-    rY.rotateY(-m_rotation.m_y);
-    rZ.rotateZ(-m_rotation.m_z);
-    m_inverseMatrix = trans * rZ * rY * rX * scale  ;
 
     m_isMatrixComputed = true;
   }
@@ -241,7 +276,7 @@ void Transformation::computeMatrices() noexcept
 
 void Transformation::operator*= ( const Transformation &_m) noexcept
 {
-  m_isMatrixComputed=false;
+  valuesChanged();
 
   computeMatrices();
   m_matrix*=_m.m_matrix;
@@ -251,11 +286,16 @@ void Transformation::operator*= ( const Transformation &_m) noexcept
 
   /// inverse matrix transformation
   m_inverseMatrix*=_m.m_inverseMatrix;
+
+  if(m_pool !=nullptr)
+  {
+    m_pool->setMatrix(m_poolIndex,m_matrix,m_inverseMatrix);
+  }
 }
 
 Transformation Transformation::operator*(const Transformation &_m) noexcept
 {
-  m_isMatrixComputed=false;
+  valuesChanged();
   computeMatrices();
   Transformation t;
   t.m_matrix=m_matrix*_m.m_matrix;
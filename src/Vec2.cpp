@@ -15,9 +15,7 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include "Vec2.h"
-#include "Vec4.h"
-#include "NGLassert.h"
-#include <cmath>
+#include "ExportInline.h"
 //----------------------------------------------------------------------------------------------------------------------
 /// @file Vec2.cpp
 /// @brief implementation files for Vec2 class
@@ -25,181 +23,31 @@
 namespace ngl
 {
 
-//----------------------------------------------------------------------------------------------------------------------
-void Vec2::set(Real _x, Real _y) noexcept
-{
-	m_x=_x;
-	m_y=_y;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-void Vec2::set(const Vec2& _v  ) noexcept
-{
-   m_x=_v.m_x;
-   m_y=_v.m_y;
-}
-//----------------------------------------------------------------------------------------------------------------------
-void Vec2::set(const Vec2* _v	) noexcept
-{
-	m_x=_v->m_x;
-	m_y=_v->m_y;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-void Vec2::null() noexcept
-{
-	m_x=0.0f;
-	m_y=0.0f;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-Real& Vec2::operator[]( int _i) noexcept
-{
-	NGL_ASSERT(_i >=0 || _i<=2);
-	return (&m_x)[_i];
-}
-
-
-
-//----------------------------------------------------------------------------------------------------------------------
-Vec2 Vec2::operator-() const noexcept
-{
-	return Vec2(-m_x,-m_y);
-}
-
 
 //----------------------------------------------------------------------------------------------------------------------
-void Vec2::operator+=(const Vec2& _v  ) noexcept
-{
-	m_x+=_v.m_x;
-	m_y+=_v.m_y;
-}
-
+/// @brief keeps an exported copy of the methods that are inline in Vec2.h, see ExportInline.h
 //----------------------------------------------------------------------------------------------------------------------
-void Vec2::operator/=(Real _v  ) noexcept
+namespace detail
 {
-  NGL_ASSERT(_v !=0.0);
-	m_x/=_v;
-	m_y/=_v;
-}
-//----------------------------------------------------------------------------------------------------------------------
-void Vec2::operator*=(Real _v) noexcept
+NGL_EXPORT_INLINE void exportVec2Inline() noexcept
 {
-	m_x*=_v;
-	m_y*=_v;
-}
-//----------------------------------------------------------------------------------------------------------------------
-void Vec2::operator-=(const Vec2& _v ) noexcept
-{
-	m_x-=_v.m_x;
-	m_y-=_v.m_y;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-Vec2 Vec2::operator/( Real _v )const noexcept
-{
-	return Vec2(m_x/_v,m_y/_v);
+  exportInline(
+    static_cast<void (Vec2::*)(Real,Real)>(&Vec2::set),
+    static_cast<void (Vec2::*)(const Vec2 &)>(&Vec2::set),
+    static_cast<void (Vec2::*)(const Vec2 *)>(&Vec2::set),
+    static_cast<Real &(Vec2::*)(int)>(&Vec2::operator[]),
+    static_cast<Vec2 (Vec2::*)() const>(&Vec2::operator-),
+    static_cast<Vec2 (Vec2::*)(const Vec2 &) const>(&Vec2::operator-),
+    static_cast<Vec2 (Vec2::*)(Real) const>(&Vec2::operator/),
+    static_cast<Vec2 (Vec2::*)(const Vec2 &) const>(&Vec2::operator/),
+    static_cast<Vec2 (Vec2::*)(Real) const>(&Vec2::operator*),
+    static_cast<Vec2 (Vec2::*)(const Vec2 &) const>(&Vec2::operator*),
+    &Vec2::null, &Vec2::operator+=, &Vec2::operator-=, &Vec2::operator/=, &Vec2::operator*=,
+    &Vec2::operator+, &Vec2::operator==, &Vec2::operator!=, &Vec2::operator=,
+    &Vec2::normalize, &Vec2::dot, &Vec2::lengthSquared, &Vec2::length
+  );
 }
-
-//----------------------------------------------------------------------------------------------------------------------
-Vec2 Vec2::operator+(const Vec2& _v )const noexcept
-{
-	return Vec2(m_x+_v.m_x,m_y+_v.m_y);
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-Vec2 Vec2::operator-( const Vec2& _v  )const noexcept
-{
-	return Vec2(m_x-_v.m_x,	m_y-_v.m_y );
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-bool Vec2::operator==(const Vec2& _v )const noexcept
-{
-	return (
-					FCompare(_v.m_x,m_x)  &&
-					FCompare(_v.m_y,m_y)
-				 );
-}
-//----------------------------------------------------------------------------------------------------------------------
-bool Vec2::operator!=(const Vec2& _v  )const noexcept
-{
-	return (
-					!FCompare(_v.m_x,m_x) ||
-					!FCompare(_v.m_y,m_y)
-				 );
-}
-//----------------------------------------------------------------------------------------------------------------------
-Vec2 Vec2::operator*(const Vec2& _v  )const noexcept
-{
-	return Vec2(
-								m_x*_v.m_x,
-								m_y*_v.m_y
-							);
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-Vec2 Vec2::operator/( const Vec2& _v )const noexcept
-{
-	return Vec2(m_x/_v.m_x,	m_y/_v.m_y	);
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-Vec2 Vec2::operator *(Real _i )const noexcept
-{
-	return Vec2(m_x*_i,m_y*_i );
-}
-
-
-
-//----------------------------------------------------------------------------------------------------------------------
-Vec2 & Vec2::operator=(const Vec2& _v) noexcept
-{
-	m_x = _v.m_x;
-	m_y = _v.m_y;
-	return *this;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-void Vec2::normalize() noexcept
-{
-  Real len=sqrtf(m_x*m_x+m_y*m_y);
-  NGL_ASSERT(len!=0.0);
-  m_x/=len;
-  m_y/=len;
-}
-
-
-
-
-
-
-Real Vec2::dot(const Vec2& _v )const noexcept
-{
-  return m_x * _v.m_x + m_y * _v.m_y;
-}
-
-
-//----------------------------------------------------------------------------------------------------------------------
-Real Vec2::lengthSquared() const noexcept
-{
-  return (m_x*m_x)+(m_y*m_y);
-}
-
-
-
-
-
-
-//----------------------------------------------------------------------------------------------------------------------
-Real Vec2::length() const noexcept
-{
-  return sqrtf((m_x*m_x)+(m_y*m_y));
-}
-
-
+} // end namespace detail
 
 } // end namspace ngl
 
-
-
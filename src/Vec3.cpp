@@ -17,8 +17,7 @@
 #include "Vec3.h"
 #include "Vec4.h"
 #include "Mat3.h"
-#include "NGLassert.h"
-#include <cmath>
+#include "ExportInline.h"
 //----------------------------------------------------------------------------------------------------------------------
 /// @file Vec3.cpp
 /// @brief implementation files for Vec3 class
@@ -27,23 +26,6 @@ namespace ngl
 {
 
 
-
-
-//----------------------------------------------------------------------------------------------------------------------
-void Vec3::set(Real _x,   Real _y,  Real _z ) noexcept
-{
-	m_x=_x;
-	m_y=_y;
-	m_z=_z;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-void Vec3::set( const Vec3& _v ) noexcept
-{
-   m_x=_v.m_x;
-   m_y=_v.m_y;
-   m_z=_v.m_z;
-}
 void Vec3::set( const Vec4& _v ) noexcept
 {
    m_x=_v.m_x;
@@ -51,129 +33,6 @@ void Vec3::set( const Vec4& _v ) noexcept
    m_z=_v.m_z;
 }
 
-//----------------------------------------------------------------------------------------------------------------------
-Real Vec3::dot( const Vec3& _v  )const noexcept
-{
-	return m_x * _v.m_x + m_y * _v.m_y + m_z * _v.m_z;
-}
-//----------------------------------------------------------------------------------------------------------------------
-void Vec3::null() noexcept
-{
-	m_x=0.0f;
-	m_y=0.0f;
-	m_z=0.0f;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-Real& Vec3::operator[](size_t & _i ) noexcept
-{
-	NGL_ASSERT(_i >=0 || _i<=3);
-	return (&m_x)[_i];
-}
-
-
-
-//----------------------------------------------------------------------------------------------------------------------
-Vec3 Vec3::operator-() const noexcept
-{
-	return Vec3(-m_x,-m_y,-m_z);
-}
-
-
-//----------------------------------------------------------------------------------------------------------------------
-void Vec3::operator+=(const Vec3& _v) noexcept
-{
-	m_x+=_v.m_x;
-	m_y+=_v.m_y;
-	m_z+=_v.m_z;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-void Vec3::operator/=(Real _v) noexcept
-{
-  NGL_ASSERT(_v !=0.0f);
-	m_x/=_v;
-	m_y/=_v;
-	m_z/=_v;
-}
-//----------------------------------------------------------------------------------------------------------------------
-void Vec3::operator*=(Real _v) noexcept
-{
-	m_x*=_v;
-	m_y*=_v;
-	m_z*=_v;
-}
-//----------------------------------------------------------------------------------------------------------------------
-void Vec3::operator-=(const Vec3& _v) noexcept
-{
-	m_x-=_v.m_x;
-	m_y-=_v.m_y;
-	m_z-=_v.m_z;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-Vec3 Vec3::operator/(Real _v)const noexcept
-{
-	return Vec3(m_x/_v,m_y/_v,m_z/_v);
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-Vec3 Vec3::operator+( const Vec3& _v)const noexcept
-{
-	return Vec3(m_x+_v.m_x,m_y+_v.m_y,m_z+_v.m_z);
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-Vec3 Vec3::operator-(const Vec3& _v)const noexcept
-{
-	return Vec3(m_x-_v.m_x,m_y-_v.m_y,m_z-_v.m_z);
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-bool Vec3::operator==(const Vec3& _v)const noexcept
-{
-	return (
-					FCompare(_v.m_x,m_x)  &&
-					FCompare(_v.m_y,m_y)  &&
-					FCompare(_v.m_z,m_z)
-				 );
-}
-//----------------------------------------------------------------------------------------------------------------------
-bool Vec3::operator!=(const Vec3& _v  )const noexcept
-{
-	return (
-					!FCompare(_v.m_x,m_x) ||
-					!FCompare(_v.m_y,m_y) ||
-					!FCompare(_v.m_z,m_z)
-				 );
-}
-//----------------------------------------------------------------------------------------------------------------------
-Vec3 Vec3::operator*( const Vec3& _v  )const noexcept
-{
-	return Vec3(m_x*_v.m_x,m_y*_v.m_y,m_z*_v.m_z );
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-Vec3 Vec3::operator/( const Vec3& _v )const noexcept
-{
-	return Vec3(m_x/_v.m_x,m_y/_v.m_y,m_z/_v.m_z);
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-Vec3 Vec3::operator *(Real _i)const noexcept
-{
-	return Vec3(m_x*_i,m_y*_i,m_z*_i);
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-Vec3 & Vec3::operator=(Real _v) noexcept
-{
-  m_x = _v;
-  m_y = _v;
-  m_z = _v;
-  return *this;
-}
-
 
 //----------------------------------------------------------------------------------------------------------------------
 Vec3 & Vec3::operator=(const Vec4& _v) noexcept
@@ -183,41 +42,6 @@ Vec3 & Vec3::operator=(const Vec4& _v) noexcept
   m_z = _v.m_z;
   return *this;
 }
-//----------------------------------------------------------------------------------------------------------------------
-void Vec3::cross(const Vec3& _v1, const Vec3& _v2) noexcept
-{
-  m_x=_v1.m_y*_v2.m_z-_v1.m_z*_v2.m_y;
-  m_y=_v1.m_z*_v2.m_x-_v1.m_x*_v2.m_z;
-  m_z=_v1.m_x*_v2.m_y-_v1.m_y*_v2.m_x;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-Vec3 Vec3::cross( const Vec3& _v )const noexcept
-{
-  return Vec3(m_y*_v.m_z - m_z*_v.m_y,
-              m_z*_v.m_x - m_x*_v.m_z,
-              m_x*_v.m_y - m_y*_v.m_x
-             );
-
-}
-
-
-//----------------------------------------------------------------------------------------------------------------------
-void Vec3::normalize() noexcept
-{
-  Real len=sqrtf(m_x*m_x+m_y*m_y+m_z*m_z);
-  NGL_ASSERT(len!=0.0f);
-  m_x/=len;
-  m_y/=len;
-  m_z/=len;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-Real Vec3::inner( const Vec3& _v  )const noexcept
-{
-  return ((m_x * _v.m_x) +(m_y * _v.m_y) + (m_z * _v.m_z));
-}
-
 
 
 Mat3 Vec3::outer(const Vec3 &_v  )  const noexcept
@@ -229,18 +53,6 @@ Mat3 Vec3::outer(const Vec3 &_v  )  const noexcept
             );
 }
 
-//----------------------------------------------------------------------------------------------------------------------
-Real Vec3::length() const noexcept
-{
-  return sqrtf((m_x*m_x)+(m_y*m_y)+(m_z*m_z));
-}
-
-
-//----------------------------------------------------------------------------------------------------------------------
-Real Vec3::lengthSquared() const noexcept
-{
-  return m_x * m_x+m_y * m_y+ m_z*m_z;
-}
 
 //----------------------------------------------------------------------------------------------------------------------
 Vec3 Vec3::operator*(const Mat3 &_m) const noexcept
@@ -257,41 +69,35 @@ Vec3 Vec3::operator*(const Mat3 &_m) const noexcept
    return v;
  }
 
-Vec3 Vec3::reflect(const Vec3 & _n) const noexcept
-{
- float d=this->dot(_n);
- //  I - 2.0 * dot(N, I) * N
- return Vec3( m_x-2.0f*d*_n.m_x, m_y-2.0f*d*_n.m_y, m_z-2.0f*d*_n.m_z);
-}
 
-void Vec3::clamp(float _min, float _max ) noexcept
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief keeps an exported copy of the methods that are inline in Vec3.h, see ExportInline.h
+//----------------------------------------------------------------------------------------------------------------------
+namespace detail
 {
-  m_x<_min ? m_x = _min : m_x;
-  m_x>_max ? m_x = _max : m_x;
-
-  m_y<_min ? m_y = _min : m_y;
-  m_y>_max ? m_y = _max : m_y;
-
-  m_z<_min ? m_z = _min : m_z;
-  m_z>_max ? m_z = _max : m_z;
-
-
-}
-void Vec3::clamp(float _max ) noexcept
+NGL_EXPORT_INLINE void exportVec3Inline() noexcept
 {
-  m_x<-_max ? m_x = -_max : m_x;
-  m_x>_max ? m_x = _max : m_x;
-
-  m_y<-_max ? m_y = -_max : m_y;
-  m_y>_max ? m_y = _max : m_y;
-
-  m_z<-_max ? m_z = -_max : m_z;
-  m_z>_max ? m_z = _max : m_z;
-
-
+  exportInline(
+    static_cast<void (Vec3::*)(Real,Real,Real)>(&Vec3::set),
+    static_cast<void (Vec3::*)(const Vec3 &)>(&Vec3::set),
+    static_cast<Real &(Vec3::*)(size_t &)>(&Vec3::operator[]),
+    static_cast<Vec3 (Vec3::*)() const>(&Vec3::operator-),
+    static_cast<Vec3 (Vec3::*)(const Vec3 &) const>(&Vec3::operator-),
+    static_cast<Vec3 (Vec3::*)(Real) const>(&Vec3::operator/),
+    static_cast<Vec3 (Vec3::*)(const Vec3 &) const>(&Vec3::operator/),
+    static_cast<Vec3 (Vec3::*)(Real) const>(&Vec3::operator*),
+    static_cast<Vec3 (Vec3::*)(const Vec3 &) const>(&Vec3::operator*),
+    static_cast<Vec3 &(Vec3::*)(Real)>(&Vec3::operator=),
+    static_cast<void (Vec3::*)(const Vec3 &,const Vec3 &)>(&Vec3::cross),
+    static_cast<Vec3 (Vec3::*)(const Vec3 &) const>(&Vec3::cross),
+    static_cast<void (Vec3::*)(float,float)>(&Vec3::clamp),
+    static_cast<void (Vec3::*)(float)>(&Vec3::clamp),
+    &Vec3::dot, &Vec3::null, &Vec3::operator+=, &Vec3::operator/=, &Vec3::operator*=, &Vec3::operator-=,
+    &Vec3::operator+, &Vec3::operator==, &Vec3::operator!=, &Vec3::normalize, &Vec3::inner,
+    &Vec3::length, &Vec3::lengthSquared, &Vec3::reflect
+  );
 }
+} // end namespace detail
 
 } // end namspace ngl
 
-
-
@@ -18,8 +18,8 @@
 #include "Vec3.h"
 #include "Vec2.h"
 
-#include "NGLassert.h"
 #include "Mat4.h"
+#include "ExportInline.h"
 #include <cmath>
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -30,212 +30,6 @@ namespace ngl
 {
 
 
-
-//----------------------------------------------------------------------------------------------------------------------
-Real Vec4::dot(const Vec4& _v )const noexcept
-{
-	return m_x * _v.m_x + m_y * _v.m_y + m_z * _v.m_z;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-void Vec4::set( Real _x, Real _y, Real _z, Real _w) noexcept
-{
-	m_x=_x;
-	m_y=_y;
-	m_z=_z;
-	m_w=_w;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-void Vec4::set( const Vec4& _v) noexcept
-{
-   m_x=_v.m_x;
-   m_y=_v.m_y;
-   m_z=_v.m_z;
-   m_w=_v.m_w;
-}
-//----------------------------------------------------------------------------------------------------------------------
-void Vec4::set( const Vec3 &_v ) noexcept
-{
-  m_x=_v.m_x;
-  m_y=_v.m_y;
-  m_z=_v.m_z;
-  m_w=1.0f;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-void Vec4::null() noexcept
-{
-	m_x=0.0f;
-	m_y=0.0f;
-	m_z=0.0f;
-	m_w=1.0f;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-Real& Vec4::operator[]( int _i ) noexcept
-{
-	NGL_ASSERT(_i >=0 && _i<=3);
-	return (&m_x)[_i];
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-Real Vec4::length() const noexcept
-{
-  return sqrtf((m_x*m_x)+(m_y*m_y)+(m_z*m_z));
-}
-
-
-//----------------------------------------------------------------------------------------------------------------------
-Vec4 &Vec4::operator-() noexcept
-{
-  m_x=-m_x;
-  m_y=-m_y;
-  m_z=-m_z;
-  return *this;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-Vec4 &Vec4::normalize() noexcept
-{
-  Real len=sqrtf(m_x*m_x+m_y*m_y+m_z*m_z);
-	NGL_ASSERT(len!=0.0f);
-	m_x/=len;
-	m_y/=len;
-	m_z/=len;
-	return *this;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-void Vec4::cross( const Vec4& _v1, const Vec4& _v2) noexcept
-{
-	m_x=_v1.m_y*_v2.m_z-_v1.m_z*_v2.m_y;
-	m_y=_v1.m_z*_v2.m_x-_v1.m_x*_v2.m_z;
-	m_z=_v1.m_x*_v2.m_y-_v1.m_y*_v2.m_x;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-Vec4 Vec4::cross(const Vec4& _v )const noexcept
-{
-	return Vec4(
-								m_y*_v.m_z - m_z*_v.m_y,
-								m_z*_v.m_x - m_x*_v.m_z,
-								m_x*_v.m_y - m_y*_v.m_x,
-								0.0f
-							 );
-
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-void Vec4::operator+=( const Vec4& _v) noexcept
-{
-	m_x+=_v.m_x;
-	m_y+=_v.m_y;
-	m_z+=_v.m_z;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-void Vec4::operator/=(Real _v) noexcept
-{
-	NGL_ASSERT(_v !=0.0f);
-	m_x/=_v;
-	m_y/=_v;
-	m_z/=_v;
-}
-//----------------------------------------------------------------------------------------------------------------------
-void Vec4::operator*=(Real _v) noexcept
-{
-	m_x*=_v;
-	m_y*=_v;
-	m_z*=_v;
-}
-//----------------------------------------------------------------------------------------------------------------------
-void Vec4::operator-=( const Vec4& _v) noexcept
-{
-	m_x-=_v.m_x;
-	m_y-=_v.m_y;
-	m_z-=_v.m_z;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-Vec4 Vec4::operator/(Real _v )const noexcept
-{
-	return Vec4(m_x/_v,m_y/_v,m_z/_v,m_w);
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-Vec4 Vec4::operator+(const Vec4& _v )const noexcept
-{
-	return Vec4(
-								m_x+_v.m_x,
-								m_y+_v.m_y,
-								m_z+_v.m_z,
-								m_w
-								);
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-Vec4 Vec4::operator-(const Vec4& _v )const noexcept
-{
-	return Vec4(
-								m_x-_v.m_x,
-								m_y-_v.m_y,
-								m_z-_v.m_z,
-								m_w
-							 );
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-bool Vec4::operator==(const Vec4& _v   )const noexcept
-{
-	return (
-					FCompare(_v.m_x,m_x)  &&
-					FCompare(_v.m_y,m_y)  &&
-					FCompare(_v.m_z,m_z)
-				 );
-}
-//----------------------------------------------------------------------------------------------------------------------
-bool Vec4::operator!=( const Vec4& _v  )const noexcept
-{
-	return (
-					!FCompare(_v.m_x,m_x) ||
-					!FCompare(_v.m_y,m_y) ||
-					!FCompare(_v.m_z,m_z)
-				 );
-}
-//----------------------------------------------------------------------------------------------------------------------
-Vec4 Vec4::operator*( const Vec4& _v )const noexcept
-{
-	return Vec4(
-								m_x*_v.m_x,
-								m_y*_v.m_y,
-								m_z*_v.m_z,
-								m_w
-							 );
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-Vec4 Vec4::operator/(const Vec4& _v )const noexcept
-{
-	return Vec4(
-								m_x/_v.m_x,
-								m_y/_v.m_y,
-								m_z/_v.m_z,
-								m_w
-								);
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-Vec4 Vec4::operator *( Real _i )const noexcept
-{
-	return Vec4(
-								m_x*_i,
-								m_y*_i,
-								m_z*_i,
-								m_w
-							 );
-}
-
 //----------------------------------------------------------------------------------------------------------------------
 Real Vec4::angleBetween( const Vec4& _v  )const noexcept
 {
@@ -249,63 +43,6 @@ Real Vec4::angleBetween( const Vec4& _v  )const noexcept
   return acosf(v1.dot(v2));
 }
 
-//----------------------------------------------------------------------------------------------------------------------
-Real Vec4::inner(const Vec4& _v  )const noexcept
-{
-	return (
-					(m_x * _v.m_x) +
-					(m_y * _v.m_y) +
-					(m_z * _v.m_z)
-				 );
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-Vec4 Vec4::outer(const Vec4& _v  )  const noexcept
-{
-	Real x = (m_y * _v.m_z) - (m_z * _v.m_y);
-	Real y = (m_z * _v.m_x) - (m_x * _v.m_z);
-	Real z = (m_x * _v.m_y) - (m_y * _v.m_x);
-
-	return Vec4(x,y,z,m_w);
-}
-
-
-//----------------------------------------------------------------------------------------------------------------------
-Vec4 & Vec4::operator=( const Vec4& _v) noexcept
-{
-	m_x = _v.m_x;
-	m_y = _v.m_y;
-	m_z = _v.m_z;
-	m_w = _v.m_w;
-	return *this;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-Vec4 & Vec4::operator=( const Vec3& _v) noexcept
-{
-  m_x = _v.m_x;
-  m_y = _v.m_y;
-  m_z = _v.m_z;
-  m_w = 0.0f;
-  return *this;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-Vec4 & Vec4::operator=( Real _v) noexcept
-{
-  m_x = _v;
-  m_y = _v;
-  m_z = _v;
-  m_w = 0.0f;
-  return *this;
-}
-
-
-//----------------------------------------------------------------------------------------------------------------------
-Real Vec4::lengthSquared() const noexcept
-{
-  return m_x * m_x+m_y * m_y+ m_z*m_z;
-}
 
 //----------------------------------------------------------------------------------------------------------------------
 Vec4 Vec4::operator*(const Mat4 &_m ) const noexcept
@@ -322,7 +59,35 @@ Vec4 Vec4::operator*(const Mat4 &_m ) const noexcept
  }
 
 
-} // end namspace ngl
-
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief keeps an exported copy of the methods that are inline in Vec4.h, see ExportInline.h
+//----------------------------------------------------------------------------------------------------------------------
+namespace detail
+{
+NGL_EXPORT_INLINE void exportVec4Inline() noexcept
+{
+  exportInline(
+    static_cast<void (Vec4::*)(Real,Real,Real,Real)>(&Vec4::set),
+    static_cast<void (Vec4::*)(const Vec4 &)>(&Vec4::set),
+    static_cast<void (Vec4::*)(const Vec3 &)>(&Vec4::set),
+    static_cast<Real &(Vec4::*)(int)>(&Vec4::operator[]),
+    static_cast<Vec4 &(Vec4::*)()>(&Vec4::operator-),
+    static_cast<Vec4 (Vec4::*)(const Vec4 &) const>(&Vec4::operator-),
+    static_cast<void (Vec4::*)(const Vec4 &,const Vec4 &)>(&Vec4::cross),
+    static_cast<Vec4 (Vec4::*)(const Vec4 &) const>(&Vec4::cross),
+    static_cast<Vec4 (Vec4::*)(Real) const>(&Vec4::operator/),
+    static_cast<Vec4 (Vec4::*)(const Vec4 &) const>(&Vec4::operator/),
+    static_cast<Vec4 (Vec4::*)(Real) const>(&Vec4::operator*),
+    static_cast<Vec4 (Vec4::*)(const Vec4 &) const>(&Vec4::operator*),
+    static_cast<Vec4 &(Vec4::*)(const Vec4 &)>(&Vec4::operator=),
+    static_cast<Vec4 &(Vec4::*)(const Vec3 &)>(&Vec4::operator=),
+    static_cast<Vec4 &(Vec4::*)(Real)>(&Vec4::operator=),
+    &Vec4::dot, &Vec4::null, &Vec4::length, &Vec4::normalize,
+    &Vec4::operator+=, &Vec4::operator/=, &Vec4::operator*=, &Vec4::operator-=,
+    &Vec4::operator+, &Vec4::operator==, &Vec4::operator!=, &Vec4::inner, &Vec4::outer, &Vec4::lengthSquared
+  );
+}
+} // end namespace detail
 
+} // end namspace ngl
 
@@ -0,0 +1,202 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Vec4Array.h"
+#include "NGLassert.h"
+#include "ParallelFor.h"
+#include "SoAKernels.h"
+#include <algorithm>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file Vec4Array.cpp
+/// @brief implementation files for Vec4Array class
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+
+namespace
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the element wise operations are only memory bound so need a big range to be worth threading
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr size_t c_grainSize=65536;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief round up to a whole number of AVX registers
+  //----------------------------------------------------------------------------------------------------------------------
+  inline size_t padded(size_t _size) noexcept { return (_size+7) & ~size_t(7); }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+Vec4Array::Vec4Array(size_t _size)
+{
+  resize(_size);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+Vec4Array::Vec4Array(const Vec4 *_v, size_t _count)
+{
+  fromAoS(_v,_count);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+Vec4Array::Vec4Array(const std::vector<Vec4> &_v)
+{
+  fromAoS(_v.data(),_v.size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec4Array::resize(size_t _size)
+{
+  size_t p=padded(_size);
+  m_x.resize(p,0.0f);
+  m_y.resize(p,0.0f);
+  m_z.resize(p,0.0f);
+  m_w.resize(p,1.0f);
+  // elements left over from a previous shrink need clearing
+  if(_size>m_size)
+  {
+    std::fill(m_x.begin()+m_size,m_x.begin()+_size,0.0f);
+    std::fill(m_y.begin()+m_size,m_y.begin()+_size,0.0f);
+    std::fill(m_z.begin()+m_size,m_z.begin()+_size,0.0f);
+    std::fill(m_w.begin()+m_size,m_w.begin()+_size,1.0f);
+  }
+  m_size=_size;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec4Array::clear() noexcept
+{
+  m_size=0;
+  m_x.clear();
+  m_y.clear();
+  m_z.clear();
+  m_w.clear();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec4Array::push_back(const Vec4 &_v)
+{
+  resize(m_size+1);
+  set(m_size-1,_v);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec4Array::fromAoS(const Vec4 *_v, size_t _count)
+{
+  resize(_count);
+  Real *c[4]={m_x.data(),m_y.data(),m_z.data(),m_w.data()};
+  parallelFor(_count,c_grainSize,[&c,_v](size_t _begin, size_t _end)
+  {
+    soa::fromAoS(&_v->m_x,4,c,_begin,_end);
+  });
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec4Array::toAoS(Vec4 *o_v) const noexcept
+{
+  const Real *c[4]={m_x.data(),m_y.data(),m_z.data(),m_w.data()};
+  parallelFor(m_size,c_grainSize,[&c,o_v](size_t _begin, size_t _end)
+  {
+    soa::toAoS(c,4,&o_v->m_x,_begin,_end);
+  });
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+std::vector<Vec4> Vec4Array::toAoS() const
+{
+  std::vector<Vec4> v(m_size);
+  toAoS(v.data());
+  return v;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec4Array::dot(const Vec4Array &_b, Real *o_out) const noexcept
+{
+  NGL_ASSERT(m_size==_b.m_size);
+  const Real *a[3]={m_x.data(),m_y.data(),m_z.data()};
+  const Real *b[3]={_b.m_x.data(),_b.m_y.data(),_b.m_z.data()};
+  parallelFor(std::min(m_size,_b.m_size),c_grainSize,[&a,&b,o_out](size_t _begin, size_t _end)
+  {
+    soa::dot(a,b,o_out,_begin,_end);
+  });
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec4Array::length(Real *o_out) const noexcept
+{
+  const Real *a[3]={m_x.data(),m_y.data(),m_z.data()};
+  parallelFor(m_size,c_grainSize,[&a,o_out](size_t _begin, size_t _end)
+  {
+    soa::length(a,o_out,_begin,_end);
+  });
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec4Array::normalize() noexcept
+{
+  Real *a[3]={m_x.data(),m_y.data(),m_z.data()};
+  parallelFor(m_size,c_grainSize,[&a](size_t _begin, size_t _end)
+  {
+    soa::normalize(a,_begin,_end);
+  });
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec4Array::cross(const Vec4Array &_b, Vec4Array &o_out) const
+{
+  NGL_ASSERT(m_size==_b.m_size);
+  size_t size=std::min(m_size,_b.m_size);
+  o_out.resize(size);
+  const Real *a[3]={m_x.data(),m_y.data(),m_z.data()};
+  const Real *b[3]={_b.m_x.data(),_b.m_y.data(),_b.m_z.data()};
+  Real *o[3]={o_out.m_x.data(),o_out.m_y.data(),o_out.m_z.data()};
+  parallelFor(size,c_grainSize,[&a,&b,&o](size_t _begin, size_t _end)
+  {
+    soa::cross(a,b,o,_begin,_end);
+  });
+  std::fill(o_out.m_w.begin(),o_out.m_w.begin()+size,0.0f);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec4Array::lerp(const Vec4Array &_b, Real _t, Vec4Array &o_out) const
+{
+  NGL_ASSERT(m_size==_b.m_size);
+  size_t size=std::min(m_size,_b.m_size);
+  o_out.resize(size);
+  const Real *a[4]={m_x.data(),m_y.data(),m_z.data(),m_w.data()};
+  const Real *b[4]={_b.m_x.data(),_b.m_y.data(),_b.m_z.data(),_b.m_w.data()};
+  Real *o[4]={o_out.m_x.data(),o_out.m_y.data(),o_out.m_z.data(),o_out.m_w.data()};
+  parallelFor(size,c_grainSize,[&a,&b,&o,_t](size_t _begin, size_t _end)
+  {
+    soa::lerp(a,b,_t,4,o,_begin,_end);
+  });
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec4Array::minMax(Vec4 &o_min, Vec4 &o_max) const noexcept
+{
+  if(m_size==0)
+  {
+    o_min.set(0.0f,0.0f,0.0f,0.0f);
+    o_max.set(0.0f,0.0f,0.0f,0.0f);
+    return;
+  }
+  soa::minMax(m_x.data(),0,m_size,o_min.m_x,o_max.m_x);
+  soa::minMax(m_y.data(),0,m_size,o_min.m_y,o_max.m_y);
+  soa::minMax(m_z.data(),0,m_size,o_min.m_z,o_max.m_z);
+  soa::minMax(m_w.data(),0,m_size,o_min.m_w,o_max.m_w);
+}
+
+} // end namespace ngl
@@ -241,13 +241,18 @@ GLuint VertexArrayObject::getVBOid(unsigned int _index)
 
 //----------------------------------------------------------------------------------------------------------------------
 void VertexArrayObject::setVertexAttributePointer(GLuint _id, GLint _size, GLenum _type, GLsizei _stride, unsigned int _dataOffset, bool _normalise )
+{
+  setVertexAttributePointerBytes(_id,_size,_type,_stride,_dataOffset*sizeof(Real),_normalise);
+}
+
+void VertexArrayObject::setVertexAttributePointerBytes(GLuint _id, GLint _size, GLenum _type, GLsizei _stride, size_t _byteOffset, bool _normalise )
 {
   if(m_bound !=true)
   {
     std::cerr<<"Warning trying to set attribute on Unbound VOA\n";
   }
 
-  glVertexAttribPointer(_id,_size,_type,_normalise,_stride,static_cast<Real *>(NULL)  + _dataOffset);//   ((Real *)NULL + (_dataOffset)));
+  glVertexAttribPointer(_id,_size,_type,_normalise,_stride,static_cast<char *>(NULL) + _byteOffset);
   glEnableVertexAttribArray(_id);
 }
 
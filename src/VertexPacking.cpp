@@ -0,0 +1,352 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "VertexPacking.h"
+#include "SIMD.h"
+#include "ParallelFor.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#ifdef NGL_SIMD_X86
+  #include <immintrin.h>
+#endif
+//----------------------------------------------------------------------------------------------------------------------
+/// @file VertexPacking.cpp
+/// @brief implementation files for the compact vertex formats
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace ngl
+{
+
+namespace
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a value clamped to [-1,1] as a snorm with _max as 1
+  //----------------------------------------------------------------------------------------------------------------------
+  inline int32_t toSnorm(Real _v, Real _max) noexcept
+  {
+    // rounding half away from zero by hand, lrint is a library call that dominates the packing
+    Real v=std::min(std::max(_v,-1.0f),1.0f)*_max;
+    return static_cast<int32_t>(v>=0.0f ? v+0.5f : v-0.5f);
+  }
+
+  inline Real fromSnorm(int32_t _v, Real _max) noexcept
+  {
+    return std::max(static_cast<Real>(_v)/_max,-1.0f);
+  }
+
+#ifdef NGL_SIMD_X86
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief 8 at a time with F16C, returns how many were done
+  //----------------------------------------------------------------------------------------------------------------------
+  NGL_TARGET_F16C size_t toHalfF16C(const float *_in, size_t _count, uint16_t *o_out) noexcept
+  {
+    size_t i=0;
+    for( ; i+8<=_count; i+=8)
+    {
+      __m128i h=_mm256_cvtps_ph(_mm256_loadu_ps(_in+i),_MM_FROUND_TO_NEAREST_INT);
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(o_out+i),h);
+    }
+    return i;
+  }
+
+  NGL_TARGET_F16C size_t fromHalfF16C(const uint16_t *_in, size_t _count, float *o_out) noexcept
+  {
+    size_t i=0;
+    for( ; i+8<=_count; i+=8)
+    {
+      __m128i h=_mm_loadu_si128(reinterpret_cast<const __m128i *>(_in+i));
+      _mm256_storeu_ps(o_out+i,_mm256_cvtph_ps(h));
+    }
+    return i;
+  }
+#endif
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief how many vertices packVertices gathers for each batch of half conversions
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr size_t c_packBlock=256;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the fewest vertices given to a thread when packing
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr size_t c_grainSize=16384;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+uint16_t floatToHalf(float _f) noexcept
+{
+  uint32_t x;
+  std::memcpy(&x,&_f,sizeof(x));
+  uint16_t sign=static_cast<uint16_t>((x>>16)&0x8000u);
+  uint32_t absx=x&0x7fffffffu;
+  if(absx>=0x7f800000u)
+  {
+    // infinity or a quiet nan keeping the top of the payload
+    return static_cast<uint16_t>(sign | 0x7c00u | (absx>0x7f800000u ? 0x200u | ((absx>>13)&0x3ffu) : 0u));
+  }
+  if(absx>=0x477ff000u)
+  {
+    // 65520 and above round past the largest half (65504)
+    return static_cast<uint16_t>(sign | 0x7c00u);
+  }
+  if(absx<0x38800000u)
+  {
+    // below the smallest normal half the value is a multiple of 2^-24, scaling by 2^24 is exact
+    float f;
+    std::memcpy(&f,&absx,sizeof(f));
+    return static_cast<uint16_t>(sign | static_cast<uint16_t>(std::lrint(f*16777216.0f)));
+  }
+  // rebias the exponent from 127 to 15 and round the mantissa to nearest even
+  uint32_t h=absx-0x38000000u;
+  h=(h+0xfffu+((h>>13)&1u))>>13;
+  return static_cast<uint16_t>(sign | h);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+float halfToFloat(uint16_t _h) noexcept
+{
+  uint32_t sign=static_cast<uint32_t>(_h&0x8000u)<<16;
+  uint32_t exponent=(_h>>10)&0x1fu;
+  uint32_t mantissa=_h&0x3ffu;
+  uint32_t x;
+  if(exponent==0)
+  {
+    float f=static_cast<float>(mantissa)*(1.0f/16777216.0f);
+    std::memcpy(&x,&f,sizeof(x));
+    x|=sign;
+  }
+  else if(exponent==31)
+  {
+    x=sign | 0x7f800000u | (mantissa<<13);
+  }
+  else
+  {
+    x=sign | ((exponent+112u)<<23) | (mantissa<<13);
+  }
+  float f;
+  std::memcpy(&f,&x,sizeof(f));
+  return f;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void floatToHalf(const float *_in, size_t _count, uint16_t *o_out) noexcept
+{
+  size_t i=0;
+#ifdef NGL_SIMD_X86
+  if(useF16C())
+  {
+    i=toHalfF16C(_in,_count,o_out);
+  }
+#endif
+  for( ; i<_count; ++i)
+  {
+    o_out[i]=floatToHalf(_in[i]);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void halfToFloat(const uint16_t *_in, size_t _count, float *o_out) noexcept
+{
+  size_t i=0;
+#ifdef NGL_SIMD_X86
+  if(useF16C())
+  {
+    i=fromHalfF16C(_in,_count,o_out);
+  }
+#endif
+  for( ; i<_count; ++i)
+  {
+    o_out[i]=halfToFloat(_in[i]);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+uint32_t packOctahedral(const Vec3 &_n) noexcept
+{
+  Real l1=std::abs(_n.m_x)+std::abs(_n.m_y)+std::abs(_n.m_z);
+  if(l1<=0.0f)
+  {
+    return packOctahedral(Vec3(0.0f,0.0f,1.0f));
+  }
+  Real x=_n.m_x/l1;
+  Real y=_n.m_y/l1;
+  if(_n.m_z<0.0f)
+  {
+    // fold the lower half over the diagonals
+    Real fx=(1.0f-std::abs(y))*(x>=0.0f ? 1.0f : -1.0f);
+    Real fy=(1.0f-std::abs(x))*(y>=0.0f ? 1.0f : -1.0f);
+    x=fx;
+    y=fy;
+  }
+  uint32_t ix=static_cast<uint16_t>(static_cast<int16_t>(toSnorm(x,32767.0f)));
+  uint32_t iy=static_cast<uint16_t>(static_cast<int16_t>(toSnorm(y,32767.0f)));
+  return ix | (iy<<16);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+Vec3 unpackOctahedral(uint32_t _p) noexcept
+{
+  Real x=fromSnorm(static_cast<int16_t>(_p&0xffffu),32767.0f);
+  Real y=fromSnorm(static_cast<int16_t>(_p>>16),32767.0f);
+  Vec3 n(x,y,1.0f-std::abs(x)-std::abs(y));
+  Real t=std::max(-n.m_z,0.0f);
+  n.m_x+= n.m_x>=0.0f ? -t : t;
+  n.m_y+= n.m_y>=0.0f ? -t : t;
+  n.normalize();
+  return n;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+uint32_t packSnorm1010102(const Vec3 &_n) noexcept
+{
+  uint32_t x=static_cast<uint32_t>(toSnorm(_n.m_x,511.0f))&0x3ffu;
+  uint32_t y=static_cast<uint32_t>(toSnorm(_n.m_y,511.0f))&0x3ffu;
+  uint32_t z=static_cast<uint32_t>(toSnorm(_n.m_z,511.0f))&0x3ffu;
+  return x | (y<<10) | (z<<20);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+Vec3 unpackSnorm1010102(uint32_t _p) noexcept
+{
+  // sign extend each 10 bit field
+  auto field=[_p](int _shift)
+  {
+    int32_t v=static_cast<int32_t>((_p>>_shift)&0x3ffu);
+    return fromSnorm(v>=512 ? v-1024 : v,511.0f);
+  };
+  return Vec3(field(0),field(10),field(20));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+Mat4 VertexLayout::dequantize(const Bounds3 &_box) const noexcept
+{
+  Mat4 m;
+  if(m_position==Position::UNORM16 && !_box.isEmpty())
+  {
+    Vec3 size=_box.size();
+    m.m_m[0][0]=size.m_x;
+    m.m_m[1][1]=size.m_y;
+    m.m_m[2][2]=size.m_z;
+    m.m_m[3][0]=_box.m_min.m_x;
+    m.m_m[3][1]=_box.m_min.m_y;
+    m.m_m[3][2]=_box.m_min.m_z;
+  }
+  return m;
+}
+
+namespace
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief pack the vertices [_begin,_end), _scale is 1 / the box size (0 for a flat axis)
+  //----------------------------------------------------------------------------------------------------------------------
+  void packRange(const VertexLayout &_layout, size_t _begin, size_t _end, const Vec3 *_positions, const Vec3 *_normals,
+                 const Vec3 *_uvs, const Bounds3 &_box, const Vec3 &_scale, unsigned char *o_data) noexcept
+  {
+    size_t stride=_layout.stride();
+    size_t normalOffset=_layout.normalOffset();
+    size_t positionOffset=_layout.positionOffset();
+    // the half floats are gathered and converted a block at a time so the simd conversion can be used
+    float floats[c_packBlock*3];
+    uint16_t halfPositions[c_packBlock*3];
+    uint16_t halfUVs[c_packBlock*2];
+    for(size_t begin=_begin; begin<_end; begin+=c_packBlock)
+    {
+      size_t n=std::min(c_packBlock,_end-begin);
+      if(_layout.m_uv==VertexLayout::UV::HALF)
+      {
+        for(size_t i=0; i<n; ++i)
+        {
+          floats[i*2]=_uvs[begin+i].m_x;
+          floats[i*2+1]=_uvs[begin+i].m_y;
+        }
+        floatToHalf(floats,n*2,halfUVs);
+      }
+      if(_layout.m_position==VertexLayout::Position::HALF)
+      {
+        for(size_t i=0; i<n; ++i)
+        {
+          floats[i*3]=_positions[begin+i].m_x;
+          floats[i*3+1]=_positions[begin+i].m_y;
+          floats[i*3+2]=_positions[begin+i].m_z;
+        }
+        floatToHalf(floats,n*3,halfPositions);
+      }
+      for(size_t i=0; i<n; ++i)
+      {
+        unsigned char *v=o_data+(begin+i)*stride;
+        const Vec3 &uv=_uvs[begin+i];
+        const Vec3 &normal=_normals[begin+i];
+        const Vec3 &position=_positions[begin+i];
+        switch(_layout.m_uv)
+        {
+          case VertexLayout::UV::FLOAT : std::memcpy(v,&uv.m_x,2*sizeof(float)); break;
+          case VertexLayout::UV::HALF : std::memcpy(v,&halfUVs[i*2],2*sizeof(uint16_t)); break;
+        }
+        uint32_t packed=0;
+        switch(_layout.m_normal)
+        {
+          case VertexLayout::Normal::FLOAT : std::memcpy(v+normalOffset,&normal.m_x,3*sizeof(float)); break;
+          case VertexLayout::Normal::OCTAHEDRAL16 :
+            packed=packOctahedral(normal);
+            std::memcpy(v+normalOffset,&packed,sizeof(packed));
+          break;
+          case VertexLayout::Normal::SNORM_10_10_10_2 :
+            packed=packSnorm1010102(normal);
+            std::memcpy(v+normalOffset,&packed,sizeof(packed));
+          break;
+        }
+        uint16_t p[4]={0,0,0,0};
+        switch(_layout.m_position)
+        {
+          case VertexLayout::Position::FLOAT : std::memcpy(v+positionOffset,&position.m_x,3*sizeof(float)); break;
+          case VertexLayout::Position::HALF :
+            std::copy(&halfPositions[i*3],&halfPositions[i*3+3],p);
+            std::memcpy(v+positionOffset,p,sizeof(p));
+          break;
+          case VertexLayout::Position::UNORM16 :
+            for(size_t k=0; k<3; ++k)
+            {
+              Real t=(position.m_openGL[k]-_box.m_min.m_openGL[k])*_scale.m_openGL[k];
+              p[k]=static_cast<uint16_t>(std::min(std::max(t,0.0f),1.0f)*65535.0f+0.5f);
+            }
+            std::memcpy(v+positionOffset,p,sizeof(p));
+          break;
+        }
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void packVertices(const VertexLayout &_layout, size_t _count, const Vec3 *_positions, const Vec3 *_normals,
+                  const Vec3 *_uvs, const Bounds3 &_box, unsigned char *o_data) noexcept
+{
+  Vec3 scale(0.0f,0.0f,0.0f);
+  if(!_box.isEmpty())
+  {
+    Vec3 size=_box.size();
+    for(size_t i=0; i<3; ++i)
+    {
+      scale.m_openGL[i]= size.m_openGL[i]>0.0f ? 1.0f/size.m_openGL[i] : 0.0f;
+    }
+  }
+  parallelFor(_count,c_grainSize,[&](size_t _begin, size_t _end)
+  {
+    packRange(_layout,_begin,_end,_positions,_normals,_uvs,_box,scale,o_data);
+  });
+}
+
+} // end namespace ngl
@@ -0,0 +1,70 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef EXPORTINLINE_H_
+#define EXPORTINLINE_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file ExportInline.h
+/// @brief internal helper to keep exporting the maths methods that are now defined inline in the headers,
+/// this is not part of the public api
+//----------------------------------------------------------------------------------------------------------------------
+/// An inline method is only emitted where the compiler decides not to inline it, so once the maths classes
+/// moved their arithmetic into the headers the library stopped providing those symbols. Each class .cpp
+/// has an exported function that passes the address of every inline method to exportInline, a method
+/// whose address is taken always gets an out of line copy, so binaries built against the old headers
+/// still link. Constructors can't have their address taken so they are called from the same function,
+/// NGL_EXPORT_INLINE builds it without optimisation so those calls are not inlined away. The constexpr
+/// constructors are run with placement new on runtime arguments, with constant arguments the compiler
+/// would initialise the object at compile time and never call them.
+/// None of these functions are ever called. With MSVC the dllexport on the class already exports them.
+//----------------------------------------------------------------------------------------------------------------------
+#if defined(__clang__)
+  #define NGL_EXPORT_INLINE __attribute__((optnone,noinline,used))
+#elif defined(__GNUC__)
+  #define NGL_EXPORT_INLINE __attribute__((optimize("O0"),noinline,used))
+#else
+  #define NGL_EXPORT_INLINE
+#endif
+
+namespace ngl
+{
+namespace detail
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief store a method address where the optimiser can't remove it
+  /// @param[in] _f the address to store
+  //----------------------------------------------------------------------------------------------------------------------
+  template <typename Func>
+  void keepSymbol(Func _f) noexcept
+  {
+    static volatile Func s_func;
+    s_func=_f;
+    (void)s_func;
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief keep an out of line copy of each of the methods passed in
+  /// @param[in] _f the addresses of the methods, overloads need a static_cast to pick one
+  //----------------------------------------------------------------------------------------------------------------------
+  template <typename ...Func>
+  void exportInline(Func ..._f) noexcept
+  {
+    using expand=int[];
+    (void)expand{0,(keepSymbol(_f),0)...};
+  }
+} // end namespace detail
+} // end namespace ngl
+
+#endif
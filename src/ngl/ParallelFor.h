@@ -0,0 +1,176 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef PARALLELFOR_H_
+#define PARALLELFOR_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file ParallelFor.h
+/// @brief internal helper used by the batch maths routines to split a range over std::threads, this is not
+/// part of the public api
+//----------------------------------------------------------------------------------------------------------------------
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief call _func(begin,end) over [0,_count) using as many threads as are worthwhile, the calling
+/// thread does the last block. Small ranges are run directly with no threads created.
+/// @param[in] _count the size of the range
+/// @param[in] _grain the minimum number of items given to a thread, blocks are also kept a multiple of 4
+/// so the simd loops only see a tail in the final block
+/// @param[in] _func the function to call with each sub range
+//----------------------------------------------------------------------------------------------------------------------
+template <typename Func>
+void parallelFor(size_t _count, size_t _grain, Func _func)
+{
+  size_t hw=std::max(1u,std::thread::hardware_concurrency());
+  size_t numThreads=std::min(hw,_count/std::max<size_t>(_grain,1));
+  if(numThreads<2)
+  {
+    _func(size_t(0),_count);
+    return;
+  }
+  size_t block=((_count/numThreads)+3) & ~size_t(3);
+  std::vector<std::thread> threads;
+  threads.reserve(numThreads-1);
+  size_t begin=0;
+  for(size_t i=0; i<numThreads-1 && begin+block<_count; ++i)
+  {
+    // if we can't get a thread the rest of the range is done on this one
+    try
+    {
+      threads.emplace_back(_func,begin,begin+block);
+    }
+    catch(...)
+    {
+      break;
+    }
+    begin+=block;
+  }
+  _func(begin,_count);
+  for(auto &t : threads)
+  {
+    t.join();
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief reduce [0,_count) in fixed chunks of _grain items, each chunk is mapped to a partial result with
+/// _map(begin,end) (the chunks spread over threads with parallelFor) and the partials are combined in order
+/// on the calling thread, so the result does not depend on the number of threads
+/// @param[in] _count the size of the range
+/// @param[in] _grain the chunk size, keep it a multiple of 4 for the simd loops
+/// @param[in] _identity the result for an empty range
+/// @param[in] _map the function giving the partial result of a sub range
+/// @param[in] _combine the function combining two partial results
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T, typename Map, typename Combine>
+T parallelReduce(size_t _count, size_t _grain, T _identity, Map _map, Combine _combine)
+{
+  size_t grain=std::max<size_t>(_grain,1);
+  size_t numChunks=(_count+grain-1)/grain;
+  if(numChunks<2)
+  {
+    return _count==0 ? _identity : _combine(_identity,_map(size_t(0),_count));
+  }
+  std::vector<T> partial(numChunks,_identity);
+  parallelFor(numChunks,1,[&](size_t _begin, size_t _end)
+  {
+    for(size_t c=_begin; c<_end; ++c)
+    {
+      partial[c]=_map(c*grain,std::min(_count,(c+1)*grain));
+    }
+  });
+  T result=_identity;
+  for(const auto &p : partial)
+  {
+    result=_combine(result,p);
+  }
+  return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief call _func(i) for each i in [0,_count), for a few large independent tasks where the blocks of
+/// parallelFor would put them all on one thread. Up to hardware_concurrency threads (the calling one
+/// included) each take the next task until none are left. If a task throws no more are started and the
+/// first exception is rethrown on the calling thread once every thread has finished.
+/// @param[in] _count the number of tasks
+/// @param[in] _func the function to call with each task index
+//----------------------------------------------------------------------------------------------------------------------
+template <typename Func>
+void parallelTasks(size_t _count, Func _func)
+{
+  size_t hw=std::max(1u,std::thread::hardware_concurrency());
+  size_t numThreads=std::min(hw,_count);
+  std::atomic<size_t> next(0);
+  std::exception_ptr error;
+  std::mutex errorMutex;
+  auto worker=[&]()
+  {
+    try
+    {
+      for(size_t i=next++; i<_count; i=next++)
+      {
+        _func(i);
+      }
+    }
+    catch(...)
+    {
+      std::lock_guard<std::mutex> lock(errorMutex);
+      if(!error)
+      {
+        error=std::current_exception();
+      }
+      next=_count;
+    }
+  };
+  std::vector<std::thread> threads;
+  if(numThreads>1)
+  {
+    threads.reserve(numThreads-1);
+    for(size_t t=0; t<numThreads-1; ++t)
+    {
+      // if we can't get a thread the ones we have (and this one) share the tasks
+      try
+      {
+        threads.emplace_back(worker);
+      }
+      catch(...)
+      {
+        break;
+      }
+    }
+  }
+  worker();
+  for(auto &t : threads)
+  {
+    t.join();
+  }
+  if(error)
+  {
+    std::rethrow_exception(error);
+  }
+}
+
+} // end namespace ngl
+
+#endif
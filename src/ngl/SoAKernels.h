@@ -0,0 +1,359 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOAKERNELS_H_
+#define SOAKERNELS_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file SoAKernels.h
+/// @brief internal element wise kernels over separate component arrays shared by Vec3Array and Vec4Array,
+/// each works on the range [_begin,_end) so they can be used with parallelFor. The simd loops need
+/// _begin to be a multiple of 4 and leave any remainder to the scalar loop. Not part of the public api.
+//----------------------------------------------------------------------------------------------------------------------
+#include "Types.h"
+#include "SIMD.h"
+#include <cmath>
+#include <cstddef>
+#ifdef NGL_SIMD_X86
+  #include <immintrin.h>
+#endif
+
+namespace ngl
+{
+namespace soa
+{
+#ifdef NGL_SIMD_X86
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief 4 packed xyz triples (12 floats) to one register per component
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void load3x4(const Real *_p, __m128 &o_x, __m128 &o_y, __m128 &o_z) noexcept
+  {
+    // (x0 y0 z0 x1) (y1 z1 x2 y2) (z2 x3 y3 z3)
+    __m128 a0=_mm_loadu_ps(_p);
+    __m128 a1=_mm_loadu_ps(_p+4);
+    __m128 a2=_mm_loadu_ps(_p+8);
+    o_x=_mm_shuffle_ps(a0,_mm_shuffle_ps(a1,a2,_MM_SHUFFLE(1,1,2,2)),_MM_SHUFFLE(2,0,3,0));
+    o_y=_mm_shuffle_ps(_mm_shuffle_ps(a0,a1,_MM_SHUFFLE(0,0,1,1)),_mm_shuffle_ps(a1,a2,_MM_SHUFFLE(2,2,3,3)),_MM_SHUFFLE(2,0,2,0));
+    o_z=_mm_shuffle_ps(_mm_shuffle_ps(a0,a1,_MM_SHUFFLE(1,1,2,2)),a2,_MM_SHUFFLE(3,0,2,0));
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the reverse of load3x4
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void store3x4(Real *o_p, __m128 _x, __m128 _y, __m128 _z) noexcept
+  {
+    _mm_storeu_ps(o_p,  _mm_shuffle_ps(_mm_shuffle_ps(_x,_y,_MM_SHUFFLE(0,0,0,0)),_mm_shuffle_ps(_z,_x,_MM_SHUFFLE(1,1,0,0)),_MM_SHUFFLE(2,0,2,0)));
+    _mm_storeu_ps(o_p+4,_mm_shuffle_ps(_mm_shuffle_ps(_y,_z,_MM_SHUFFLE(1,1,1,1)),_mm_shuffle_ps(_x,_y,_MM_SHUFFLE(2,2,2,2)),_MM_SHUFFLE(2,0,2,0)));
+    _mm_storeu_ps(o_p+8,_mm_shuffle_ps(_mm_shuffle_ps(_z,_x,_MM_SHUFFLE(3,3,2,2)),_mm_shuffle_ps(_y,_z,_MM_SHUFFLE(3,3,3,3)),_MM_SHUFFLE(2,0,2,0)));
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  inline bool useSIMD() noexcept { return activeSIMDLevel()!=SIMDLevel::SCALAR; }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief sin and cos of 4 angles in radians, the angle is reduced to [-pi/4,pi/4] by the nearest multiple
+  /// of pi/2 (in three parts so large angles stay accurate) and the cephes polynomials used for each, the
+  /// quadrant then picks and signs the results. This is within a couple of ulp of sinf / cosf.
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void sinCos(__m128 _x, __m128 &o_sin, __m128 &o_cos) noexcept
+  {
+    __m128i quadrant=_mm_cvtps_epi32(_mm_mul_ps(_x,_mm_set1_ps(0.636619772367581f)));
+    __m128 q=_mm_cvtepi32_ps(quadrant);
+    __m128 y=_mm_sub_ps(_x,_mm_mul_ps(q,_mm_set1_ps(1.5703125f)));
+    y=_mm_sub_ps(y,_mm_mul_ps(q,_mm_set1_ps(4.837512969970703125e-4f)));
+    y=_mm_sub_ps(y,_mm_mul_ps(q,_mm_set1_ps(7.54978995489188216e-8f)));
+    __m128 z=_mm_mul_ps(y,y);
+
+    __m128 s=_mm_add_ps(_mm_mul_ps(z,_mm_set1_ps(-1.9515295891e-4f)),_mm_set1_ps(8.3321608736e-3f));
+    s=_mm_add_ps(_mm_mul_ps(s,z),_mm_set1_ps(-1.6666654611e-1f));
+    s=_mm_add_ps(_mm_mul_ps(_mm_mul_ps(s,z),y),y);
+
+    __m128 c=_mm_add_ps(_mm_mul_ps(z,_mm_set1_ps(2.443315711809948e-5f)),_mm_set1_ps(-1.388731625493765e-3f));
+    c=_mm_add_ps(_mm_mul_ps(c,z),_mm_set1_ps(4.166664568298827e-2f));
+    c=_mm_mul_ps(_mm_mul_ps(c,z),z);
+    c=_mm_add_ps(_mm_sub_ps(c,_mm_mul_ps(z,_mm_set1_ps(0.5f))),_mm_set1_ps(1.0f));
+
+    // odd quadrants swap sin and cos, bit 1 of the quadrant (of quadrant+1 for cos) gives the sign
+    const __m128i one=_mm_set1_epi32(1);
+    const __m128i two=_mm_set1_epi32(2);
+    __m128 swap=_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant,one),one));
+    __m128 sinSign=_mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant,two),30));
+    __m128 cosSign=_mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant,one),two),30));
+    o_sin=_mm_xor_ps(_mm_or_ps(_mm_and_ps(swap,c),_mm_andnot_ps(swap,s)),sinSign);
+    o_cos=_mm_xor_ps(_mm_or_ps(_mm_and_ps(swap,s),_mm_andnot_ps(swap,c)),cosSign);
+  }
+#endif
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief packed AoS data with _stride floats per element to separate component arrays
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void fromAoS(const Real *_aos, size_t _stride, Real *const *o_c, size_t _begin, size_t _end) noexcept
+  {
+    size_t i=_begin;
+#ifdef NGL_SIMD_X86
+    if(useSIMD())
+    {
+      for( ; i+4<=_end; i+=4)
+      {
+        const Real *p=_aos+i*_stride;
+        if(_stride==3)
+        {
+          __m128 x,y,z;
+          load3x4(p,x,y,z);
+          _mm_store_ps(o_c[0]+i,x);
+          _mm_store_ps(o_c[1]+i,y);
+          _mm_store_ps(o_c[2]+i,z);
+        }
+        else
+        {
+          __m128 x=_mm_loadu_ps(p);
+          __m128 y=_mm_loadu_ps(p+4);
+          __m128 z=_mm_loadu_ps(p+8);
+          __m128 w=_mm_loadu_ps(p+12);
+          _MM_TRANSPOSE4_PS(x,y,z,w);
+          _mm_store_ps(o_c[0]+i,x);
+          _mm_store_ps(o_c[1]+i,y);
+          _mm_store_ps(o_c[2]+i,z);
+          _mm_store_ps(o_c[3]+i,w);
+        }
+      }
+    }
+#endif
+    for( ; i<_end; ++i)
+    {
+      for(size_t c=0; c<_stride; ++c)
+      {
+        o_c[c][i]=_aos[i*_stride+c];
+      }
+    }
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief separate component arrays back to packed AoS data with _stride floats per element
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void toAoS(const Real *const *_c, size_t _stride, Real *o_aos, size_t _begin, size_t _end) noexcept
+  {
+    size_t i=_begin;
+#ifdef NGL_SIMD_X86
+    if(useSIMD())
+    {
+      for( ; i+4<=_end; i+=4)
+      {
+        Real *p=o_aos+i*_stride;
+        if(_stride==3)
+        {
+          store3x4(p,_mm_load_ps(_c[0]+i),_mm_load_ps(_c[1]+i),_mm_load_ps(_c[2]+i));
+        }
+        else
+        {
+          __m128 x=_mm_load_ps(_c[0]+i);
+          __m128 y=_mm_load_ps(_c[1]+i);
+          __m128 z=_mm_load_ps(_c[2]+i);
+          __m128 w=_mm_load_ps(_c[3]+i);
+          _MM_TRANSPOSE4_PS(x,y,z,w);
+          _mm_storeu_ps(p,x);
+          _mm_storeu_ps(p+4,y);
+          _mm_storeu_ps(p+8,z);
+          _mm_storeu_ps(p+12,w);
+        }
+      }
+    }
+#endif
+    for( ; i<_end; ++i)
+    {
+      for(size_t c=0; c<_stride; ++c)
+      {
+        o_aos[i*_stride+c]=_c[c][i];
+      }
+    }
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief o = a.b for the xyz components
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void dot(const Real *const *_a, const Real *const *_b, Real *o_out, size_t _begin, size_t _end) noexcept
+  {
+    size_t i=_begin;
+#ifdef NGL_SIMD_X86
+    if(useSIMD())
+    {
+      for( ; i+4<=_end; i+=4)
+      {
+        __m128 r=_mm_mul_ps(_mm_load_ps(_a[0]+i),_mm_load_ps(_b[0]+i));
+        r=_mm_add_ps(r,_mm_mul_ps(_mm_load_ps(_a[1]+i),_mm_load_ps(_b[1]+i)));
+        r=_mm_add_ps(r,_mm_mul_ps(_mm_load_ps(_a[2]+i),_mm_load_ps(_b[2]+i)));
+        _mm_storeu_ps(o_out+i,r);
+      }
+    }
+#endif
+    for( ; i<_end; ++i)
+    {
+      o_out[i]=_a[0][i]*_b[0][i] + _a[1][i]*_b[1][i] + _a[2][i]*_b[2][i];
+    }
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief o = |a| for the xyz components
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void length(const Real *const *_a, Real *o_out, size_t _begin, size_t _end) noexcept
+  {
+    size_t i=_begin;
+#ifdef NGL_SIMD_X86
+    if(useSIMD())
+    {
+      for( ; i+4<=_end; i+=4)
+      {
+        __m128 x=_mm_load_ps(_a[0]+i);
+        __m128 y=_mm_load_ps(_a[1]+i);
+        __m128 z=_mm_load_ps(_a[2]+i);
+        _mm_storeu_ps(o_out+i,_mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x,x),_mm_mul_ps(y,y)),_mm_mul_ps(z,z))));
+      }
+    }
+#endif
+    for( ; i<_end; ++i)
+    {
+      o_out[i]=sqrtf(_a[0][i]*_a[0][i] + _a[1][i]*_a[1][i] + _a[2][i]*_a[2][i]);
+    }
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief normalize the xyz components in place, zero length vectors are left as zero
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void normalize(Real *const *io_a, size_t _begin, size_t _end) noexcept
+  {
+    size_t i=_begin;
+#ifdef NGL_SIMD_X86
+    if(useSIMD())
+    {
+      const __m128 one=_mm_set1_ps(1.0f);
+      for( ; i+4<=_end; i+=4)
+      {
+        __m128 x=_mm_load_ps(io_a[0]+i);
+        __m128 y=_mm_load_ps(io_a[1]+i);
+        __m128 z=_mm_load_ps(io_a[2]+i);
+        __m128 len=_mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x,x),_mm_mul_ps(y,y)),_mm_mul_ps(z,z)));
+        __m128 zero=_mm_cmpeq_ps(len,_mm_setzero_ps());
+        len=_mm_or_ps(_mm_andnot_ps(zero,len),_mm_and_ps(zero,one));
+        _mm_store_ps(io_a[0]+i,_mm_div_ps(x,len));
+        _mm_store_ps(io_a[1]+i,_mm_div_ps(y,len));
+        _mm_store_ps(io_a[2]+i,_mm_div_ps(z,len));
+      }
+    }
+#endif
+    for( ; i<_end; ++i)
+    {
+      Real len=sqrtf(io_a[0][i]*io_a[0][i] + io_a[1][i]*io_a[1][i] + io_a[2][i]*io_a[2][i]);
+      if(len > 0.0f)
+      {
+        io_a[0][i]/=len;
+        io_a[1][i]/=len;
+        io_a[2][i]/=len;
+      }
+    }
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief o = a x b for the xyz components, o must not alias a or b
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void cross(const Real *const *_a, const Real *const *_b, Real *const *o_c, size_t _begin, size_t _end) noexcept
+  {
+    size_t i=_begin;
+#ifdef NGL_SIMD_X86
+    if(useSIMD())
+    {
+      for( ; i+4<=_end; i+=4)
+      {
+        __m128 ax=_mm_load_ps(_a[0]+i);
+        __m128 ay=_mm_load_ps(_a[1]+i);
+        __m128 az=_mm_load_ps(_a[2]+i);
+        __m128 bx=_mm_load_ps(_b[0]+i);
+        __m128 by=_mm_load_ps(_b[1]+i);
+        __m128 bz=_mm_load_ps(_b[2]+i);
+        _mm_store_ps(o_c[0]+i,_mm_sub_ps(_mm_mul_ps(ay,bz),_mm_mul_ps(az,by)));
+        _mm_store_ps(o_c[1]+i,_mm_sub_ps(_mm_mul_ps(az,bx),_mm_mul_ps(ax,bz)));
+        _mm_store_ps(o_c[2]+i,_mm_sub_ps(_mm_mul_ps(ax,by),_mm_mul_ps(ay,bx)));
+      }
+    }
+#endif
+    for( ; i<_end; ++i)
+    {
+      Real x=_a[1][i]*_b[2][i] - _a[2][i]*_b[1][i];
+      Real y=_a[2][i]*_b[0][i] - _a[0][i]*_b[2][i];
+      Real z=_a[0][i]*_b[1][i] - _a[1][i]*_b[0][i];
+      o_c[0][i]=x;
+      o_c[1][i]=y;
+      o_c[2][i]=z;
+    }
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief o = a+(b-a)*t for _dims components, this is the same expression as ngl::lerp
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void lerp(const Real *const *_a, const Real *const *_b, Real _t, size_t _dims, Real *const *o_c, size_t _begin, size_t _end) noexcept
+  {
+    for(size_t c=0; c<_dims; ++c)
+    {
+      const Real *a=_a[c];
+      const Real *b=_b[c];
+      Real *o=o_c[c];
+      size_t i=_begin;
+#ifdef NGL_SIMD_X86
+      if(useSIMD())
+      {
+        __m128 t=_mm_set1_ps(_t);
+        for( ; i+4<=_end; i+=4)
+        {
+          __m128 av=_mm_load_ps(a+i);
+          _mm_store_ps(o+i,_mm_add_ps(av,_mm_mul_ps(_mm_sub_ps(_mm_load_ps(b+i),av),t)));
+        }
+      }
+#endif
+      for( ; i<_end; ++i)
+      {
+        o[i]=a[i]+(b[i]-a[i])*_t;
+      }
+    }
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the min and max of a single component array, _end must be > _begin
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void minMax(const Real *_a, size_t _begin, size_t _end, Real &o_min, Real &o_max) noexcept
+  {
+    Real mn=_a[_begin];
+    Real mx=_a[_begin];
+    size_t i=_begin;
+#ifdef NGL_SIMD_X86
+    if(useSIMD() && _end-_begin >= 4)
+    {
+      __m128 vmin=_mm_load_ps(_a+i);
+      __m128 vmax=vmin;
+      for(i+=4; i+4<=_end; i+=4)
+      {
+        __m128 v=_mm_load_ps(_a+i);
+        vmin=_mm_min_ps(vmin,v);
+        vmax=_mm_max_ps(vmax,v);
+      }
+      vmin=_mm_min_ps(vmin,_mm_shuffle_ps(vmin,vmin,_MM_SHUFFLE(1,0,3,2)));
+      vmin=_mm_min_ps(vmin,_mm_shuffle_ps(vmin,vmin,_MM_SHUFFLE(2,3,0,1)));
+      vmax=_mm_max_ps(vmax,_mm_shuffle_ps(vmax,vmax,_MM_SHUFFLE(1,0,3,2)));
+      vmax=_mm_max_ps(vmax,_mm_shuffle_ps(vmax,vmax,_MM_SHUFFLE(2,3,0,1)));
+      mn=_mm_cvtss_f32(vmin);
+      mx=_mm_cvtss_f32(vmax);
+    }
+#endif
+    for( ; i<_end; ++i)
+    {
+      mn=_a[i] < mn ? _a[i] : mn;
+      mx=_a[i] > mx ? _a[i] : mx;
+    }
+    o_min=mn;
+    o_max=mx;
+  }
+
+} // end namespace soa
+} // end namespace ngl
+
+#endif
@@ -0,0 +1,263 @@
+#include "BenchHarness.h"
+#include <ngl/SIMD.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+namespace bench
+{
+std::vector<Benchmark> &registry()
+{
+  static std::vector<Benchmark> s_benchmarks;
+  return s_benchmarks;
+}
+} // end namespace bench
+
+namespace
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the result of one benchmark
+//----------------------------------------------------------------------------------------------------------------------
+struct Result
+{
+  std::string m_name;
+  double m_median;
+  double m_min;
+  size_t m_iterations;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+struct Options
+{
+  std::string m_filter;
+  std::string m_json;
+  std::string m_baseline;
+  double m_threshold=10.0;
+  int m_samples=7;
+  double m_sampleTime=0.01;
+};
+
+using Clock=std::chrono::steady_clock;
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief time _iterations calls of _func in seconds
+//----------------------------------------------------------------------------------------------------------------------
+double timeBatch(const std::function<void()> &_func, size_t _iterations)
+{
+  auto start=Clock::now();
+  for(size_t i=0; i<_iterations; ++i)
+  {
+    _func();
+  }
+  return std::chrono::duration<double>(Clock::now()-start).count();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief grow the batch until it takes the sample time then take the median of several batches
+//----------------------------------------------------------------------------------------------------------------------
+Result run(const bench::Benchmark &_b, const Options &_opt)
+{
+  size_t iterations=1;
+  double t=timeBatch(_b.m_func,iterations);
+  while(t<_opt.m_sampleTime && iterations<(size_t(1)<<40))
+  {
+    iterations*=2;
+    t=timeBatch(_b.m_func,iterations);
+  }
+  std::vector<double> ns;
+  for(int s=0; s<_opt.m_samples; ++s)
+  {
+    ns.push_back(timeBatch(_b.m_func,iterations)*1e9/static_cast<double>(iterations));
+  }
+  std::sort(ns.begin(),ns.end());
+  return {_b.m_name,ns[ns.size()/2],ns.front(),iterations};
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+const char *simdName(ngl::SIMDLevel _level)
+{
+  switch(_level)
+  {
+    case ngl::SIMDLevel::SCALAR : return "scalar";
+    case ngl::SIMDLevel::SSE2 : return "sse2";
+    case ngl::SIMDLevel::AVX : return "avx";
+  }
+  return "unknown";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief write the results as json, the baseline reader below expects this layout
+//----------------------------------------------------------------------------------------------------------------------
+void writeJSON(std::ostream &_out, const std::vector<Result> &_results)
+{
+  _out<<"{\n  \"simd\": \""<<simdName(ngl::activeSIMDLevel())<<"\",\n  \"benchmarks\": [\n";
+  for(size_t i=0; i<_results.size(); ++i)
+  {
+    const Result &r=_results[i];
+    _out<<"    {\"name\": \""<<r.m_name<<"\", \"ns_per_op\": "<<r.m_median
+        <<", \"min_ns_per_op\": "<<r.m_min<<", \"iterations\": "<<r.m_iterations<<'}'
+        <<(i+1<_results.size() ? ",\n" : "\n");
+  }
+  _out<<"  ]\n}\n";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief read the name and ns_per_op pairs from a file written by writeJSON
+//----------------------------------------------------------------------------------------------------------------------
+bool readBaseline(const std::string &_fname, std::map<std::string,double> &o_times)
+{
+  std::ifstream in(_fname);
+  if(!in.is_open())
+  {
+    std::cerr<<"unable to open baseline "<<_fname<<'\n';
+    return false;
+  }
+  std::stringstream ss;
+  ss<<in.rdbuf();
+  std::string text=ss.str();
+  const std::string nameKey="\"name\": \"";
+  const std::string timeKey="\"ns_per_op\": ";
+  size_t pos=0;
+  while((pos=text.find(nameKey,pos))!=std::string::npos)
+  {
+    pos+=nameKey.size();
+    size_t end=text.find('"',pos);
+    size_t t=text.find(timeKey,end);
+    if(end==std::string::npos || t==std::string::npos)
+    {
+      break;
+    }
+    o_times[text.substr(pos,end-pos)]=std::strtod(text.c_str()+t+timeKey.size(),nullptr);
+    pos=t;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief print each result against the baseline
+/// @returns the number of regressions
+//----------------------------------------------------------------------------------------------------------------------
+int compare(const std::vector<Result> &_results, const std::map<std::string,double> &_baseline, double _threshold)
+{
+  int regressions=0;
+  std::cout<<"\ncomparison with baseline, threshold "<<_threshold<<"%\n";
+  for(const auto &r : _results)
+  {
+    auto b=_baseline.find(r.m_name);
+    std::cout<<std::left<<std::setw(44)<<r.m_name;
+    if(b==_baseline.end() || b->second<=0.0)
+    {
+      std::cout<<"new\n";
+      continue;
+    }
+    double change=(r.m_median-b->second)/b->second*100.0;
+    std::cout<<std::right<<std::setw(10)<<std::fixed<<std::setprecision(2)<<b->second<<" -> "
+             <<std::setw(10)<<r.m_median<<" ns "<<std::showpos<<std::setw(8)<<change<<'%'<<std::noshowpos;
+    if(change>_threshold)
+    {
+      std::cout<<"  REGRESSION";
+      ++regressions;
+    }
+    else if(change< -_threshold)
+    {
+      std::cout<<"  faster";
+    }
+    std::cout<<'\n';
+  }
+  std::cout<<regressions<<" regression(s)\n";
+  return regressions;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void usage()
+{
+  std::cout<<"ngl_bench [options]\n"
+             "  --filter <text>      only run benchmarks with text in the name\n"
+             "  --json <file>        write the results as json to file (- for stdout)\n"
+             "  --baseline <file>    compare with the json from an earlier run, exit code 1 on a regression\n"
+             "  --threshold <pct>    percentage slowdown counted as a regression (default 10)\n"
+             "  --samples <n>        number of timed batches per benchmark, the median is reported (default 7)\n"
+             "  --simd <level>       scalar, sse2 or avx (default the best the cpu supports)\n"
+             "  --list               list the benchmarks and exit\n";
+}
+} // end anon namespace
+
+int main(int argc, char **argv)
+{
+  Options opt;
+  bool list=false;
+  for(int i=1; i<argc; ++i)
+  {
+    std::string arg=argv[i];
+    bool hasValue=i+1<argc;
+    if(arg=="--filter" && hasValue)         { opt.m_filter=argv[++i]; }
+    else if(arg=="--json" && hasValue)      { opt.m_json=argv[++i]; }
+    else if(arg=="--baseline" && hasValue)  { opt.m_baseline=argv[++i]; }
+    else if(arg=="--threshold" && hasValue) { opt.m_threshold=std::atof(argv[++i]); }
+    else if(arg=="--samples" && hasValue)   { opt.m_samples=std::max(1,std::atoi(argv[++i])); }
+    else if(arg=="--simd" && hasValue)
+    {
+      std::string level=argv[++i];
+      if(level=="scalar")    { ngl::setSIMDLevel(ngl::SIMDLevel::SCALAR); }
+      else if(level=="sse2") { ngl::setSIMDLevel(ngl::SIMDLevel::SSE2); }
+      else if(level=="avx")  { ngl::setSIMDLevel(ngl::SIMDLevel::AVX); }
+      else { usage(); return 2; }
+    }
+    else if(arg=="--list") { list=true; }
+    else { usage(); return arg=="--help" ? 0 : 2; }
+  }
+
+  std::vector<Result> results;
+  for(const auto &b : bench::registry())
+  {
+    if(b.m_name.find(opt.m_filter)==std::string::npos)
+    {
+      continue;
+    }
+    if(list)
+    {
+      std::cout<<b.m_name<<'\n';
+      continue;
+    }
+    results.push_back(run(b,opt));
+    const Result &r=results.back();
+    std::cout<<std::left<<std::setw(44)<<r.m_name<<std::right<<std::fixed<<std::setprecision(2)
+             <<std::setw(12)<<r.m_median<<" ns/op  (min "<<r.m_min<<")\n";
+  }
+  if(list)
+  {
+    return 0;
+  }
+
+  if(opt.m_json=="-")
+  {
+    writeJSON(std::cout,results);
+  }
+  else if(!opt.m_json.empty())
+  {
+    std::ofstream out(opt.m_json);
+    if(!out.is_open())
+    {
+      std::cerr<<"unable to write "<<opt.m_json<<'\n';
+      return 2;
+    }
+    writeJSON(out,results);
+  }
+
+  if(!opt.m_baseline.empty())
+  {
+    std::map<std::string,double> baseline;
+    if(!readBaseline(opt.m_baseline,baseline))
+    {
+      return 2;
+    }
+    return compare(results,baseline,opt.m_threshold) ? 1 : 0;
+  }
+  return 0;
+}
@@ -0,0 +1,63 @@
+#ifndef BENCHHARNESS_H_
+#define BENCHHARNESS_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file BenchHarness.h
+/// @brief a very small benchmark runner for ngl_bench, each benchmark body does a single operation and the
+/// runner times it in batches so the results are in ns per operation. See tests/README.md for the options.
+//----------------------------------------------------------------------------------------------------------------------
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace bench
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief one registered benchmark, the name is group/name
+//----------------------------------------------------------------------------------------------------------------------
+struct Benchmark
+{
+  std::string m_name;
+  std::function<void()> m_func;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief all the benchmarks in registration order
+//----------------------------------------------------------------------------------------------------------------------
+std::vector<Benchmark> &registry();
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief adds a benchmark to the registry when constructed, used by NGL_BENCH
+//----------------------------------------------------------------------------------------------------------------------
+struct Register
+{
+  Register(const char *_group, const char *_name, void (*_func)())
+  {
+    registry().push_back({std::string(_group)+'/'+_name,_func});
+  }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief stop the compiler removing a result or treating a value as constant
+//----------------------------------------------------------------------------------------------------------------------
+template<typename T>
+inline void use(T &_v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r"(&_v) : "memory");
+#else
+  static volatile char sink;
+  sink=*reinterpret_cast<volatile char *>(&_v);
+#endif
+}
+
+} // end namespace bench
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief define a benchmark, the body is timed per call
+//----------------------------------------------------------------------------------------------------------------------
+#define NGL_BENCH(GROUP,NAME) \
+  static void GROUP##_##NAME##_bench(); \
+  static bench::Register GROUP##_##NAME##_register(#GROUP,#NAME,&GROUP##_##NAME##_bench); \
+  static void GROUP##_##NAME##_bench()
+
+#endif
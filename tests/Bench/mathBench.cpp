@@ -0,0 +1,103 @@
+#include "BenchHarness.h"
+#include <ngl/Vec2.h>
+#include <ngl/Vec3.h>
+#include <ngl/Vec4.h>
+#include <ngl/Mat3.h>
+#include <ngl/Mat4.h>
+#include <ngl/Quaternion.h>
+
+// the inputs are globals passed through bench::use so none of the work can be hoisted out of the timing loop
+static ngl::Vec2 v2a(1.0f,2.0f);
+static ngl::Vec2 v2b(0.5f,-3.0f);
+static ngl::Vec3 v3a(1.0f,2.0f,3.0f);
+static ngl::Vec3 v3b(0.5f,-3.0f,0.25f);
+static ngl::Vec4 v4a(1.0f,2.0f,3.0f,1.0f);
+static ngl::Vec4 v4b(0.5f,-3.0f,0.25f,0.0f);
+static ngl::Mat3 m3a(1.0f,0.5f,0.0f,0.25f,2.0f,1.0f,-0.5f,0.0f,2.0f);
+static ngl::Mat3 m3b(2.0f,0.0f,1.0f,0.0f,1.0f,0.5f,1.0f,0.25f,3.0f);
+static ngl::Mat4 m4a(1,0,0,0,0,2,2,0,0,-0.5,2,0,1,2,3,1);
+static ngl::Mat4 m4b(0.5,0,1,0,0,1,0,0,-1,0,0.5,0,4,5,6,1);
+static ngl::Quaternion qa(0.9238795f,0.0f,0.3826834f,0.0f);
+static ngl::Quaternion qb(0.7071068f,0.7071068f,0.0f,0.0f);
+static ngl::Real s=0.5f;
+
+//----------------------------------------------------------------------------------------------------------------------
+// Vec2
+//----------------------------------------------------------------------------------------------------------------------
+NGL_BENCH(Vec2,Add)       { bench::use(v2a); ngl::Vec2 r=v2a+v2b; bench::use(r); }
+NGL_BENCH(Vec2,Sub)       { bench::use(v2a); ngl::Vec2 r=v2a-v2b; bench::use(r); }
+NGL_BENCH(Vec2,MulScalar) { bench::use(v2a); ngl::Vec2 r=s*v2a; bench::use(r); }
+NGL_BENCH(Vec2,Dot)       { bench::use(v2a); ngl::Real r=v2a.dot(v2b); bench::use(r); }
+NGL_BENCH(Vec2,Length)    { bench::use(v2a); ngl::Real r=v2a.length(); bench::use(r); }
+NGL_BENCH(Vec2,Normalize) { ngl::Vec2 r=v2a; bench::use(r); r.normalize(); bench::use(r); }
+
+//----------------------------------------------------------------------------------------------------------------------
+// Vec3
+//----------------------------------------------------------------------------------------------------------------------
+NGL_BENCH(Vec3,Add)       { bench::use(v3a); ngl::Vec3 r=v3a+v3b; bench::use(r); }
+NGL_BENCH(Vec3,Sub)       { bench::use(v3a); ngl::Vec3 r=v3a-v3b; bench::use(r); }
+NGL_BENCH(Vec3,MulScalar) { bench::use(v3a); ngl::Vec3 r=v3a*s; bench::use(r); }
+NGL_BENCH(Vec3,MulVec)    { bench::use(v3a); ngl::Vec3 r=v3a*v3b; bench::use(r); }
+NGL_BENCH(Vec3,Div)       { bench::use(v3a); ngl::Vec3 r=v3a/s; bench::use(r); }
+NGL_BENCH(Vec3,Dot)       { bench::use(v3a); ngl::Real r=v3a.dot(v3b); bench::use(r); }
+NGL_BENCH(Vec3,Cross)     { bench::use(v3a); ngl::Vec3 r=v3a.cross(v3b); bench::use(r); }
+NGL_BENCH(Vec3,Length)    { bench::use(v3a); ngl::Real r=v3a.length(); bench::use(r); }
+NGL_BENCH(Vec3,Normalize) { ngl::Vec3 r=v3a; bench::use(r); r.normalize(); bench::use(r); }
+NGL_BENCH(Vec3,MulMat3)   { bench::use(v3a); ngl::Vec3 r=m3a*v3a; bench::use(r); }
+
+//----------------------------------------------------------------------------------------------------------------------
+// Vec4
+//----------------------------------------------------------------------------------------------------------------------
+NGL_BENCH(Vec4,Add)       { bench::use(v4a); ngl::Vec4 r=v4a+v4b; bench::use(r); }
+NGL_BENCH(Vec4,Sub)       { bench::use(v4a); ngl::Vec4 r=v4a-v4b; bench::use(r); }
+NGL_BENCH(Vec4,MulScalar) { bench::use(v4a); ngl::Vec4 r=v4a*s; bench::use(r); }
+NGL_BENCH(Vec4,Dot)       { bench::use(v4a); ngl::Real r=v4a.dot(v4b); bench::use(r); }
+NGL_BENCH(Vec4,Cross)     { bench::use(v4a); ngl::Vec4 r=v4a.cross(v4b); bench::use(r); }
+NGL_BENCH(Vec4,Length)    { bench::use(v4a); ngl::Real r=v4a.length(); bench::use(r); }
+NGL_BENCH(Vec4,Normalize) { ngl::Vec4 r=v4a; bench::use(r); r.normalize(); bench::use(r); }
+NGL_BENCH(Vec4,MulMat4)   { bench::use(v4a); ngl::Vec4 r=v4a*m4a; bench::use(r); }
+
+//----------------------------------------------------------------------------------------------------------------------
+// Mat3
+//----------------------------------------------------------------------------------------------------------------------
+NGL_BENCH(Mat3,Ctor)        { ngl::Mat3 r(s); bench::use(r); }
+NGL_BENCH(Mat3,Add)         { bench::use(m3a); ngl::Mat3 r=m3a+m3b; bench::use(r); }
+NGL_BENCH(Mat3,MulScalar)   { bench::use(m3a); ngl::Mat3 r=m3a*s; bench::use(r); }
+NGL_BENCH(Mat3,Mul)         { bench::use(m3a); ngl::Mat3 r=m3a*m3b; bench::use(r); }
+NGL_BENCH(Mat3,Transpose)   { ngl::Mat3 r=m3a; bench::use(r); r.transpose(); bench::use(r); }
+NGL_BENCH(Mat3,Determinant) { bench::use(m3a); ngl::Real r=m3a.determinant(); bench::use(r); }
+NGL_BENCH(Mat3,Inverse)     { ngl::Mat3 r=m3a; bench::use(r); r.inverse(); bench::use(r); }
+NGL_BENCH(Mat3,FromMat4)    { bench::use(m4a); ngl::Mat3 r(m4a); bench::use(r); }
+
+//----------------------------------------------------------------------------------------------------------------------
+// Mat4
+//----------------------------------------------------------------------------------------------------------------------
+NGL_BENCH(Mat4,Ctor)          { ngl::Mat4 r(s); bench::use(r); }
+NGL_BENCH(Mat4,Add)           { bench::use(m4a); ngl::Mat4 r=m4a+m4b; bench::use(r); }
+NGL_BENCH(Mat4,MulScalar)     { bench::use(m4a); ngl::Mat4 r=m4a*s; bench::use(r); }
+NGL_BENCH(Mat4,Mul)           { bench::use(m4a); ngl::Mat4 r=m4a*m4b; bench::use(r); }
+NGL_BENCH(Mat4,MulAssign)     { ngl::Mat4 r=m4a; bench::use(r); r*=m4b; bench::use(r); }
+NGL_BENCH(Mat4,MulVec3)       { bench::use(v3a); auto r=m4a*v3a; bench::use(r); }
+NGL_BENCH(Mat4,MulVec4)       { bench::use(v4a); ngl::Vec4 r=m4a*v4a; bench::use(r); }
+NGL_BENCH(Mat4,Transpose)     { ngl::Mat4 r=m4a; bench::use(r); r.transpose(); bench::use(r); }
+NGL_BENCH(Mat4,Determinant)   { bench::use(m4a); ngl::Real r=m4a.determinant(); bench::use(r); }
+NGL_BENCH(Mat4,Inverse)       { ngl::Mat4 m=m4a; bench::use(m); ngl::Mat4 r=m.inverse(); bench::use(r); }
+NGL_BENCH(Mat4,InverseAffine) { bench::use(m4a); ngl::Mat4 r=m4a.inverseAffine(); bench::use(r); }
+NGL_BENCH(Mat4,InverseRigid)  { bench::use(m4a); ngl::Mat4 r=m4a.inverseRigid(); bench::use(r); }
+NGL_BENCH(Mat4,NormalMatrix)  { bench::use(m4a); ngl::Mat3 r=m4a.normalMatrix(); bench::use(r); }
+NGL_BENCH(Mat4,RotateX)       { ngl::Mat4 r; bench::use(s); r.rotateX(s); bench::use(r); }
+NGL_BENCH(Mat4,Euler)         { ngl::Mat4 r; bench::use(s); r.euler(s,0.0f,1.0f,0.0f); bench::use(r); }
+NGL_BENCH(Mat4,FromTRS)       { bench::use(v3a); ngl::Mat4 r=ngl::Mat4::fromTRS(v3a,v3b,v3a); bench::use(r); }
+
+//----------------------------------------------------------------------------------------------------------------------
+// Quaternion
+//----------------------------------------------------------------------------------------------------------------------
+NGL_BENCH(Quaternion,Mul)          { bench::use(qa); ngl::Quaternion r=qa*qb; bench::use(r); }
+NGL_BENCH(Quaternion,Add)          { bench::use(qa); ngl::Quaternion r=qa+qb; bench::use(r); }
+NGL_BENCH(Quaternion,Normalise)    { ngl::Quaternion r=qa; bench::use(r); r.normalise(); bench::use(r); }
+NGL_BENCH(Quaternion,Magnitude)    { bench::use(qa); ngl::Real r=qa.magnitude(); bench::use(r); }
+NGL_BENCH(Quaternion,Slerp)        { bench::use(qa); ngl::Quaternion r=ngl::Quaternion::slerp(qa,qb,s); bench::use(r); }
+NGL_BENCH(Quaternion,ToMat4)       { bench::use(qa); ngl::Mat4 r=qa.toMat4(); bench::use(r); }
+NGL_BENCH(Quaternion,MulVec4)      { bench::use(qa); ngl::Vec4 r=qa*v4a; bench::use(r); }
+NGL_BENCH(Quaternion,FromAxisAngle){ ngl::Quaternion r; bench::use(s); r.fromAxisAngle(ngl::Vec3(0.0f,1.0f,0.0f),s); bench::use(r); }
+NGL_BENCH(Quaternion,FromEuler)    { ngl::Quaternion r; bench::use(s); r.fromEulerAngles(s,s,s); bench::use(r); }
@@ -0,0 +1,615 @@
+#include "BenchHarness.h"
+#include <ngl/Camera.h>
+#include <ngl/Transformation.h>
+#include <ngl/TransformHierarchy.h>
+#include <ngl/TransformPool.h>
+#include <ngl/Util.h>
+#include <ngl/AABB.h>
+#include <ngl/Bounds3.h>
+#include <ngl/BoundingSphere.h>
+#include <ngl/OBB.h>
+#include <ngl/OcclusionBuffer.h>
+#include <ngl/MeshBVH.h>
+#include <ngl/MeshOptimizer.h>
+#include <ngl/MeshSimplify.h>
+#include <ngl/SceneBVH.h>
+#include <ngl/LODSelector.h>
+#include <ngl/VertexPacking.h>
+#include <ngl/Vec3Array.h>
+#include <cmath>
+
+static ngl::Real s=0.5f;
+static ngl::Vec3 eye(2.0f,2.0f,2.0f);
+static ngl::Vec3 look(0.0f,0.0f,0.0f);
+static ngl::Vec3 up(0.0f,1.0f,0.0f);
+static ngl::Vec3 point(0.5f,0.25f,-0.5f);
+static ngl::Vec4 viewport(0.0f,0.0f,1024.0f,720.0f);
+static ngl::Mat4 model(1,0,0,0,0,2,2,0,0,-0.5,2,0,1,2,3,1);
+static ngl::Mat4 project=ngl::perspective(45.0f,1.5f,0.1f,100.0f);
+
+static ngl::Camera &camera()
+{
+  static ngl::Camera cam=[]()
+  {
+    ngl::Camera c(eye,look,up);
+    c.setShape(45.0f,1.5f,0.1f,100.0f);
+    c.calculateFrustum();
+    return c;
+  }();
+  return cam;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Transformation
+//----------------------------------------------------------------------------------------------------------------------
+NGL_BENCH(Transformation,GetMatrix)
+{
+  static ngl::Transformation t;
+  bench::use(s);
+  // changing the rotation each time forces the matrices to be rebuilt
+  t.setRotation(s,s,s);
+  ngl::Mat4 r=t.getMatrix();
+  bench::use(r);
+}
+
+NGL_BENCH(Transformation,GetMatrixCached)
+{
+  static ngl::Transformation t;
+  ngl::Mat4 r=t.getMatrix();
+  bench::use(r);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// TransformPool, 10000 instances all changed per update against the same done one Transformation at a time
+//----------------------------------------------------------------------------------------------------------------------
+constexpr size_t c_instances=10000;
+
+static ngl::TransformPool &instancePool()
+{
+  static ngl::TransformPool p=[]()
+  {
+    ngl::TransformPool t;
+    for(size_t i=0; i<c_instances; ++i)
+    {
+      t.add(ngl::Vec3(static_cast<ngl::Real>(i),0.0f,0.0f));
+    }
+    return t;
+  }();
+  return p;
+}
+
+NGL_BENCH(TransformPool,Update10k)
+{
+  instancePool().setAllDirty();
+  instancePool().update();
+  bench::use(instancePool());
+}
+
+NGL_BENCH(TransformPool,Transformation10k)
+{
+  static std::vector<ngl::Transformation> t(c_instances);
+  for(auto &i : t)
+  {
+    i.setRotation(s,s,s);
+    ngl::Mat4 r=i.getMatrix();
+    bench::use(r);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// TransformHierarchy, a 64 joint chain where one joint half way down changes per update
+//----------------------------------------------------------------------------------------------------------------------
+static ngl::TransformHierarchy &rig()
+{
+  static ngl::TransformHierarchy h=[]()
+  {
+    ngl::TransformHierarchy t;
+    size_t parent=t.addNode();
+    for(int i=1; i<64; ++i)
+    {
+      parent=t.addNode(parent);
+      t.setRotation(parent,ngl::Vec3(5.0f,0.0f,0.0f));
+    }
+    t.update();
+    return t;
+  }();
+  return h;
+}
+
+NGL_BENCH(TransformHierarchy,UpdateOneJoint)
+{
+  bench::use(s);
+  rig().setRotation(32,ngl::Vec3(s,0.0f,0.0f));
+  rig().update();
+  bench::use(rig());
+}
+
+NGL_BENCH(TransformHierarchy,UpdateAll)
+{
+  bench::use(s);
+  rig().setRotation(0,ngl::Vec3(s,0.0f,0.0f));
+  rig().update();
+  bench::use(rig());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Camera
+//----------------------------------------------------------------------------------------------------------------------
+NGL_BENCH(Camera,CalculateFrustum) { camera().calculateFrustum(); bench::use(camera()); }
+NGL_BENCH(Camera,PointInFrustum)   { bench::use(point); auto r=camera().isPointInFrustum(point); bench::use(r); }
+NGL_BENCH(Camera,SphereInFrustum)  { bench::use(point); auto r=camera().isSphereInFrustum(point,s); bench::use(r); }
+NGL_BENCH(Camera,BoxInFrustum)
+{
+  static ngl::AABB box(ngl::Vec4(-0.5f,-0.5f,-0.5f,1.0f),1.0f,1.0f,1.0f);
+  bench::use(box);
+  auto r=camera().boxInFrustum(box);
+  bench::use(r);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// batch culling of 10000 bounds spread around the camera against the same one at a time
+//----------------------------------------------------------------------------------------------------------------------
+constexpr size_t c_bounds=10000;
+
+static ngl::Vec3Array boundsMin;
+static ngl::Vec3Array boundsMax;
+static std::vector<ngl::Real> boundsRadius;
+static std::vector<ngl::AABB> boundsBoxes;
+static std::vector<uint32_t> visible(ngl::Frustum::maskWords(c_bounds));
+
+static void makeBounds()
+{
+  if(!boundsMin.empty())
+  {
+    return;
+  }
+  for(size_t i=0; i<c_bounds; ++i)
+  {
+    ngl::Real f=static_cast<ngl::Real>(i);
+    ngl::Vec3 p(std::fmod(f*0.37f,20.0f)-10.0f,std::fmod(f*0.73f,20.0f)-10.0f,std::fmod(f*0.11f,20.0f)-10.0f);
+    boundsMin.push_back(p);
+    boundsMax.push_back(p+ngl::Vec3(0.5f,0.5f,0.5f));
+    boundsRadius.push_back(0.5f);
+    boundsBoxes.push_back(ngl::AABB(ngl::Vec4(p.m_x,p.m_y,p.m_z,1.0f),0.5f,0.5f,0.5f));
+  }
+}
+
+NGL_BENCH(Camera,CullBoxes10k)
+{
+  makeBounds();
+  camera().cullBoxes(boundsMin,boundsMax,visible.data());
+  bench::use(visible);
+}
+
+NGL_BENCH(Camera,BoxInFrustum10k)
+{
+  makeBounds();
+  for(const auto &b : boundsBoxes)
+  {
+    auto r=camera().boxInFrustum(b);
+    bench::use(r);
+  }
+}
+
+NGL_BENCH(Camera,CullSpheres10k)
+{
+  makeBounds();
+  camera().cullSpheres(boundsMin,boundsRadius.data(),visible.data());
+  bench::use(visible);
+}
+
+// the same spheres culled with a level chosen for each from 4 in the same pass
+NGL_BENCH(Camera,CullSpheresLOD10k)
+{
+  makeBounds();
+  static ngl::LODSelector selector(camera(),720.0f);
+  static std::vector<ngl::Real> errors[4];
+  static std::vector<uint8_t> levels(c_bounds,0);
+  static const ngl::Real *levelError[4];
+  for(size_t l=0; l<4; ++l)
+  {
+    errors[l].resize(c_bounds,0.002f*l*l);
+    levelError[l]=errors[l].data();
+  }
+  selector.cullSpheres(boundsMin,boundsRadius.data(),levelError,4,visible.data(),levels.data());
+  bench::use(visible);
+  bench::use(levels);
+}
+
+// the camera plus three shadow cascades in one pass against four separate culls
+static const ngl::Frustum *cascades()
+{
+  static ngl::Frustum views[4];
+  views[0]=camera().getFrustum();
+  for(int i=1; i<4; ++i)
+  {
+    ngl::Real r=5.0f*i;
+    views[i]=ngl::Frustum(ngl::lookAt(ngl::Vec3(10.0f,20.0f,10.0f),look,up)*ngl::ortho(-r,r,-r,r,0.1f,60.0f));
+  }
+  return views;
+}
+
+static std::vector<uint32_t> cascadeVisible[4];
+
+NGL_BENCH(Camera,CullBoxes4Views10k)
+{
+  makeBounds();
+  static const ngl::Frustum *views=cascades();
+  static uint32_t *out[4];
+  for(int i=0; i<4; ++i)
+  {
+    cascadeVisible[i].resize(visible.size());
+    out[i]=cascadeVisible[i].data();
+  }
+  ngl::Frustum::cullBoxes(views,4,boundsMin,boundsMax,out);
+  bench::use(cascadeVisible);
+}
+
+NGL_BENCH(Camera,CullBoxes4Separate10k)
+{
+  makeBounds();
+  static const ngl::Frustum *views=cascades();
+  for(int i=0; i<4; ++i)
+  {
+    cascadeVisible[i].resize(visible.size());
+    views[i].cullBoxes(boundsMin,boundsMax,cascadeVisible[i].data());
+  }
+  bench::use(cascadeVisible);
+}
+
+// the local bounds of 10000 instances to world space with Arvo's method
+static std::vector<ngl::Bounds3> localBounds(c_bounds,ngl::Bounds3(ngl::Vec3(-0.5f,-0.5f,-0.5f),ngl::Vec3(0.5f,0.5f,0.5f)));
+static std::vector<ngl::Bounds3> worldBounds(c_bounds);
+
+NGL_BENCH(Bounds3,Transform10k)
+{
+  ngl::Bounds3::transform(localBounds.data(),localBounds.size(),model,worldBounds.data());
+  bench::use(worldBounds);
+}
+
+NGL_BENCH(Bounds3,Merge10k)
+{
+  ngl::Bounds3 b=ngl::Bounds3::merge(localBounds.data(),localBounds.size());
+  bench::use(b);
+}
+
+// the bounds of a 1M vertex mesh, a stretched cloud of points
+static const std::vector<ngl::Vec3> &meshPoints()
+{
+  static std::vector<ngl::Vec3> points=[]()
+  {
+    std::vector<ngl::Vec3> p(1<<20);
+    unsigned int seed=1u;
+    for(auto &v : p)
+    {
+      seed=seed*1664525u+1013904223u;
+      ngl::Real x=static_cast<ngl::Real>(seed>>8)/static_cast<ngl::Real>(1u<<24);
+      seed=seed*1664525u+1013904223u;
+      ngl::Real y=static_cast<ngl::Real>(seed>>8)/static_cast<ngl::Real>(1u<<24);
+      seed=seed*1664525u+1013904223u;
+      ngl::Real z=static_cast<ngl::Real>(seed>>8)/static_cast<ngl::Real>(1u<<24);
+      v.set(x*8.0f+y,y*2.0f,z*0.5f+x);
+    }
+    return p;
+  }();
+  return points;
+}
+
+NGL_BENCH(Bounds3,FromPoints1M)
+{
+  const auto &p=meshPoints();
+  ngl::Bounds3 b=ngl::Bounds3::fromPoints(p.data(),p.size());
+  bench::use(b);
+}
+
+NGL_BENCH(BoundingSphere,Ritter1M)
+{
+  const auto &p=meshPoints();
+  ngl::BoundingSphere s=ngl::BoundingSphere::fromPoints(p.data(),p.size(),ngl::BoundingSphere::Fit::RITTER);
+  bench::use(s);
+}
+
+NGL_BENCH(BoundingSphere,IterativeRitter1M)
+{
+  const auto &p=meshPoints();
+  ngl::BoundingSphere s=ngl::BoundingSphere::fromPoints(p.data(),p.size(),ngl::BoundingSphere::Fit::ITERATIVE_RITTER);
+  bench::use(s);
+}
+
+NGL_BENCH(BoundingSphere,Welzl1M)
+{
+  const auto &p=meshPoints();
+  ngl::BoundingSphere s=ngl::BoundingSphere::fromPoints(p.data(),p.size(),ngl::BoundingSphere::Fit::WELZL);
+  bench::use(s);
+}
+
+NGL_BENCH(OBB,FromPoints1M)
+{
+  const auto &p=meshPoints();
+  ngl::OBB b=ngl::OBB::fromPoints(p.data(),p.size());
+  bench::use(b);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// OcclusionBuffer, a row of walls in front of the camera hiding the 10000 bounds
+//----------------------------------------------------------------------------------------------------------------------
+static ngl::OcclusionBuffer &occlusion()
+{
+  static ngl::OcclusionBuffer b=[]()
+  {
+    ngl::OcclusionBuffer o(256,128);
+    ngl::Vec3 verts[4]={ngl::Vec3(-1.0f,-2.0f,0.0f),ngl::Vec3(1.0f,-2.0f,0.0f),ngl::Vec3(1.0f,2.0f,0.0f),ngl::Vec3(-1.0f,2.0f,0.0f)};
+    uint32_t indices[6]={0,1,2,0,2,3};
+    o.addOccluder(verts,4,indices,6);
+    return o;
+  }();
+  b.begin(camera().getVPMatrix());
+  for(int i=-4; i<=4; ++i)
+  {
+    ngl::Mat4 m;
+    m.translate(i*1.5f,0.0f,0.0f);
+    b.drawOccluder(0,m);
+  }
+  return b;
+}
+
+NGL_BENCH(Occlusion,Rasterise)
+{
+  static ngl::OcclusionBuffer &b=occlusion();
+  b.rasterise();
+  bench::use(b);
+}
+
+NGL_BENCH(Occlusion,TestBoxes10k)
+{
+  makeBounds();
+  static ngl::OcclusionBuffer &b=[]() -> ngl::OcclusionBuffer &
+  {
+    occlusion().rasterise();
+    return occlusion();
+  }();
+  b.testBoxes(boundsMin,boundsMax,visible.data());
+  bench::use(visible);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// MeshBVH over a 128x128 height field (32768 triangles) with rays cast down onto it
+//----------------------------------------------------------------------------------------------------------------------
+constexpr size_t c_rays=1024;
+
+static void heightField(std::vector<ngl::Vec3> &o_verts, std::vector<uint32_t> &o_indices)
+{
+  const uint32_t n=129;
+  for(uint32_t z=0; z<n; ++z)
+  {
+    for(uint32_t x=0; x<n; ++x)
+    {
+      ngl::Real fx=static_cast<ngl::Real>(x);
+      ngl::Real fz=static_cast<ngl::Real>(z);
+      o_verts.push_back(ngl::Vec3(fx,std::sin(fx*0.2f)*std::cos(fz*0.3f)*4.0f,fz));
+    }
+  }
+  for(uint32_t z=0; z+1<n; ++z)
+  {
+    for(uint32_t x=0; x+1<n; ++x)
+    {
+      uint32_t i=z*n+x;
+      o_indices.insert(o_indices.end(),{i,i+n,i+1,i+1,i+n,i+n+1});
+    }
+  }
+}
+
+static ngl::MeshBVH &terrain()
+{
+  static ngl::MeshBVH bvh=[]()
+  {
+    std::vector<ngl::Vec3> verts;
+    std::vector<uint32_t> indices;
+    heightField(verts,indices);
+    ngl::MeshBVH b;
+    b.build(verts.data(),verts.size(),indices.data(),indices.size());
+    return b;
+  }();
+  return bvh;
+}
+
+static std::vector<ngl::Vec3> rayOrigins;
+static std::vector<ngl::Vec3> rayDirs;
+static std::vector<ngl::MeshBVH::Hit> rayHits(c_rays);
+
+static void makeRays()
+{
+  for(size_t i=rayOrigins.size(); i<c_rays; ++i)
+  {
+    ngl::Real f=static_cast<ngl::Real>(i);
+    rayOrigins.push_back(ngl::Vec3(std::fmod(f*7.3f,128.0f),20.0f,std::fmod(f*3.1f,128.0f)));
+    rayDirs.push_back(ngl::Vec3(0.3f,-1.0f,0.2f));
+  }
+}
+
+NGL_BENCH(MeshBVH,Build32k)
+{
+  static std::vector<ngl::Vec3> verts;
+  static std::vector<uint32_t> indices;
+  if(verts.empty())
+  {
+    heightField(verts,indices);
+  }
+  ngl::MeshBVH b;
+  b.build(verts.data(),verts.size(),indices.data(),indices.size());
+  bench::use(b);
+}
+
+NGL_BENCH(MeshBVH,ClosestHit1k)
+{
+  makeRays();
+  for(size_t i=0; i<c_rays; ++i)
+  {
+    terrain().closestHit(rayOrigins[i],rayDirs[i],rayHits[i]);
+  }
+  bench::use(rayHits);
+}
+
+NGL_BENCH(MeshBVH,ClosestHits1k)
+{
+  makeRays();
+  terrain().closestHits(rayOrigins.data(),rayDirs.data(),c_rays,rayHits.data());
+  bench::use(rayHits);
+}
+
+NGL_BENCH(MeshBVH,AnyHit1k)
+{
+  makeRays();
+  for(size_t i=0; i<c_rays; ++i)
+  {
+    bool r=terrain().anyHit(rayOrigins[i],rayDirs[i]);
+    bench::use(r);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// SceneBVH over the 10000 bounds against testing each one (Camera/BoxInFrustum10k)
+//----------------------------------------------------------------------------------------------------------------------
+static std::vector<uint32_t> sceneIds;
+
+static ngl::SceneBVH &sceneTree()
+{
+  static ngl::SceneBVH t=[]()
+  {
+    makeBounds();
+    ngl::SceneBVH b;
+    for(size_t i=0; i<c_bounds; ++i)
+    {
+      sceneIds.push_back(b.insert(boundsMin.get(i),boundsMax.get(i),i));
+    }
+    b.rebuild();
+    return b;
+  }();
+  return t;
+}
+
+static std::vector<size_t> sceneFound;
+
+NGL_BENCH(SceneBVH,QueryFrustum10k)
+{
+  sceneFound.clear();
+  sceneTree().queryFrustum(camera(),sceneFound);
+  bench::use(sceneFound);
+}
+
+NGL_BENCH(SceneBVH,QuerySphere10k)
+{
+  sceneFound.clear();
+  sceneTree().querySphere(point,2.0f,sceneFound);
+  bench::use(sceneFound);
+}
+
+NGL_BENCH(SceneBVH,Move10k)
+{
+  // every object moves back and forth inside its grown box so only the boxes are checked
+  static ngl::Real offset=0.0f;
+  offset=offset>0.0f ? -0.05f : 0.05f;
+  ngl::Vec3 d(offset,0.0f,offset);
+  for(size_t i=0; i<c_bounds; ++i)
+  {
+    sceneTree().move(sceneIds[i],boundsMin.get(i)+d,boundsMax.get(i)+d);
+  }
+  bench::use(sceneTree());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Util.h projection helpers
+//----------------------------------------------------------------------------------------------------------------------
+NGL_BENCH(Util,Perspective)  { bench::use(s); ngl::Mat4 r=ngl::perspective(45.0f,s,0.1f,100.0f); bench::use(r); }
+NGL_BENCH(Util,InfinitePerspective) { bench::use(s); ngl::Mat4 r=ngl::infinitePerspective(45.0f,s,0.1f); bench::use(r); }
+NGL_BENCH(Util,Ortho)        { bench::use(s); ngl::Mat4 r=ngl::ortho(-s,s,-s,s,0.1f,100.0f); bench::use(r); }
+NGL_BENCH(Util,Frustum)      { bench::use(s); ngl::Mat4 r=ngl::frustum(-s,s,-s,s,0.1f,100.0f); bench::use(r); }
+NGL_BENCH(Util,LookAt)       { bench::use(eye); ngl::Mat4 r=ngl::lookAt(eye,look,up); bench::use(r); }
+NGL_BENCH(Util,Project)      { bench::use(point); ngl::Vec3 r=ngl::project(point,model,project,viewport); bench::use(r); }
+NGL_BENCH(Util,UnProject)    { bench::use(point); ngl::Vec3 r=ngl::unProject(point,model,project,viewport); bench::use(r); }
+NGL_BENCH(Util,CalcNormal)   { bench::use(point); ngl::Vec3 r=ngl::calcNormal(point,eye,up); bench::use(r); }
+
+//----------------------------------------------------------------------------------------------------------------------
+// MeshOptimizer, the vertex cache reorder of a shuffled 128 x 128 quad grid (32768 triangles)
+//----------------------------------------------------------------------------------------------------------------------
+static const std::vector<uint32_t> &shuffledGrid()
+{
+  static std::vector<uint32_t> indices=[]()
+  {
+    constexpr uint32_t n=128;
+    std::vector<uint32_t> tris;
+    for(uint32_t y=0; y<n; ++y)
+    {
+      for(uint32_t x=0; x<n; ++x)
+      {
+        uint32_t a=y*(n+1)+x;
+        uint32_t c=a+n+1;
+        tris.insert(tris.end(),{a,a+1,c+1,a,c+1,c});
+      }
+    }
+    unsigned int seed=1u;
+    for(size_t i=tris.size()/3-1; i>0; --i)
+    {
+      seed=seed*1664525u+1013904223u;
+      size_t j=(seed>>8)%(i+1);
+      std::swap_ranges(tris.begin()+static_cast<ptrdiff_t>(i*3),tris.begin()+static_cast<ptrdiff_t>(i*3+3),tris.begin()+static_cast<ptrdiff_t>(j*3));
+    }
+    return tris;
+  }();
+  return indices;
+}
+
+NGL_BENCH(MeshOptimizer,VertexCache32k)
+{
+  std::vector<uint32_t> indices=shuffledGrid();
+  ngl::optimizeVertexCache(indices.data(),indices.size(),129*129);
+  bench::use(indices);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// VertexPacking, interleaving the 1M point mesh as 32 byte float and 16 byte compact vertices
+//----------------------------------------------------------------------------------------------------------------------
+static void packMesh(const ngl::VertexLayout &_layout)
+{
+  const auto &p=meshPoints();
+  static std::vector<unsigned char> data;
+  data.resize(p.size()*_layout.stride());
+  ngl::Bounds3 box=ngl::Bounds3::fromPoints(p.data(),p.size());
+  // the points double as normals and uvs, only the cost matters here
+  ngl::packVertices(_layout,p.size(),p.data(),p.data(),p.data(),box,data.data());
+  bench::use(data);
+}
+
+NGL_BENCH(VertexPacking,Float1M)   { packMesh(ngl::VertexLayout()); }
+NGL_BENCH(VertexPacking,Compact1M) { packMesh(ngl::VertexLayout::compact()); }
+
+//----------------------------------------------------------------------------------------------------------------------
+// MeshSimplify, the 128 x 128 height field (32768 triangles) down to 1% and into a five level chain
+//----------------------------------------------------------------------------------------------------------------------
+static std::vector<ngl::Vec3> terrainVerts;
+static std::vector<uint32_t> terrainIndices;
+
+NGL_BENCH(MeshSimplify,Simplify32k)
+{
+  if(terrainVerts.empty())
+  {
+    heightField(terrainVerts,terrainIndices);
+  }
+  static std::vector<uint32_t> out(terrainIndices.size());
+  size_t count=ngl::simplifyMesh(terrainIndices.data(),terrainIndices.size(),terrainVerts.data(),nullptr,nullptr,terrainVerts.size(),
+                                 terrainIndices.size()/100,ngl::SimplifyOptions(),out.data());
+  bench::use(count);
+}
+
+NGL_BENCH(MeshSimplify,LODChain32k)
+{
+  if(terrainVerts.empty())
+  {
+    heightField(terrainVerts,terrainIndices);
+  }
+  static std::vector<uint32_t> out;
+  static std::vector<ngl::MeshLOD> lods;
+  ngl::buildLODChain(terrainIndices.data(),terrainIndices.size(),terrainVerts.data(),nullptr,nullptr,terrainVerts.size(),
+                     5,0.5f,ngl::SimplifyOptions(),out,lods);
+  bench::use(lods);
+}
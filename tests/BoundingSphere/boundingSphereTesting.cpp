@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+#include <ngl/BoundingSphere.h>
+#include <ngl/Mat4.h>
+#include <ngl/Vec4.h>
+#include <cmath>
+#include <vector>
+#include "../TestUtils.h"
+
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+static ngl::Vec3 randomVec3(unsigned int &io_seed, ngl::Real _min, ngl::Real _max)
+{
+  ngl::Real x=randomReal(io_seed,_min,_max);
+  ngl::Real y=randomReal(io_seed,_min,_max);
+  ngl::Real z=randomReal(io_seed,_min,_max);
+  return ngl::Vec3(x,y,z);
+}
+
+// contains with a little slack for rounding
+static bool holds(const ngl::BoundingSphere &_s, const ngl::Vec3 &_p)
+{
+  return (_p-_s.m_center).length()<=_s.m_radius*1.0001f+1e-5f;
+}
+
+TEST(BoundingSphere,extend)
+{
+  ngl::BoundingSphere s;
+  EXPECT_TRUE(s.isEmpty());
+  unsigned int seed=1u;
+  std::vector<ngl::Vec3> points;
+  for(int i=0; i<200; ++i)
+  {
+    points.push_back(randomVec3(seed,-5.0f,5.0f));
+    s.extend(points.back());
+  }
+  EXPECT_FALSE(s.isEmpty());
+  for(const auto &p : points)
+  {
+    EXPECT_TRUE(holds(s,p));
+  }
+  // no worse than the sphere around the box of the points
+  ngl::BoundingSphere box=ngl::BoundingSphere::fromBounds(ngl::Bounds3::fromPoints(points.data(),points.size()));
+  EXPECT_LE(s.m_radius,box.m_radius*1.2f);
+}
+
+TEST(BoundingSphere,merge)
+{
+  ngl::BoundingSphere a(ngl::Vec3(0.0f,0.0f,0.0f),1.0f);
+  ngl::BoundingSphere b(ngl::Vec3(4.0f,0.0f,0.0f),1.0f);
+  ngl::BoundingSphere m=a;
+  m.merge(b);
+  EXPECT_FLOAT_EQ(m.m_radius,3.0f);
+  EXPECT_EQ(m.m_center,ngl::Vec3(2.0f,0.0f,0.0f));
+  EXPECT_TRUE(m.contains(ngl::BoundingSphere(ngl::Vec3(0.0f,0.0f,0.0f),0.99f)));
+
+  // one inside the other
+  ngl::BoundingSphere big(ngl::Vec3(0.0f,0.0f,0.0f),10.0f);
+  m=a;
+  m.merge(big);
+  EXPECT_FLOAT_EQ(m.m_radius,10.0f);
+  m=big;
+  m.merge(a);
+  EXPECT_FLOAT_EQ(m.m_radius,10.0f);
+
+  ngl::BoundingSphere e;
+  e.merge(a);
+  EXPECT_FLOAT_EQ(e.m_radius,1.0f);
+}
+
+TEST(BoundingSphere,transform)
+{
+  ngl::Mat4 s;
+  s.scale(1.0f,3.0f,0.5f);
+  ngl::Mat4 t;
+  t.translate(1.0f,2.0f,3.0f);
+  ngl::Mat4 m=s*t;
+  ngl::BoundingSphere a(ngl::Vec3(1.0f,1.0f,1.0f),2.0f);
+  ngl::BoundingSphere r=a.transformed(m);
+  EXPECT_EQ(r.m_center,ngl::Vec3(2.0f,5.0f,3.5f));
+  EXPECT_FLOAT_EQ(r.m_radius,6.0f);
+
+  std::vector<ngl::BoundingSphere> spheres(3,a);
+  ngl::BoundingSphere::transform(spheres.data(),spheres.size(),m,spheres.data());
+  for(const auto &i : spheres)
+  {
+    EXPECT_EQ(i.m_center,r.m_center);
+    EXPECT_FLOAT_EQ(i.m_radius,r.m_radius);
+  }
+}
+
+TEST(BoundingSphere,intersections)
+{
+  ngl::BoundingSphere a(ngl::Vec3(0.0f,0.0f,0.0f),1.0f);
+  EXPECT_TRUE(a.intersects(ngl::BoundingSphere(ngl::Vec3(1.9f,0.0f,0.0f),1.0f)));
+  EXPECT_FALSE(a.intersects(ngl::BoundingSphere(ngl::Vec3(2.1f,0.0f,0.0f),1.0f)));
+  EXPECT_TRUE(a.intersects(ngl::Bounds3(ngl::Vec3(0.5f,0.5f,0.5f),ngl::Vec3(2.0f,2.0f,2.0f))));
+  EXPECT_FALSE(a.intersects(ngl::Bounds3(ngl::Vec3(0.8f,0.8f,0.0f),ngl::Vec3(2.0f,2.0f,2.0f))));
+
+  ngl::Real t;
+  EXPECT_TRUE(a.intersectRay(ngl::Vec3(-5.0f,0.0f,0.0f),ngl::Vec3(2.0f,0.0f,0.0f),10.0f,t));
+  EXPECT_FLOAT_EQ(t,2.0f);
+  EXPECT_FALSE(a.intersectRay(ngl::Vec3(-5.0f,0.0f,0.0f),ngl::Vec3(-1.0f,0.0f,0.0f),10.0f,t));
+  EXPECT_FALSE(a.intersectRay(ngl::Vec3(-5.0f,1.5f,0.0f),ngl::Vec3(1.0f,0.0f,0.0f),10.0f,t));
+  EXPECT_TRUE(a.intersectRay(ngl::Vec3(0.0f,0.0f,0.0f),ngl::Vec3(1.0f,0.0f,0.0f),10.0f,t));
+  EXPECT_FLOAT_EQ(t,0.0f);
+
+  ngl::Bounds3 b=a.bounds();
+  EXPECT_EQ(b,ngl::Bounds3(ngl::Vec3(-1.0f,-1.0f,-1.0f),ngl::Vec3(1.0f,1.0f,1.0f)));
+  ngl::BoundingSphere f=ngl::BoundingSphere::fromBounds(b);
+  EXPECT_FLOAT_EQ(f.m_radius,std::sqrt(3.0f));
+}
+
+TEST(BoundingSphere,fromPointsFits)
+{
+  unsigned int seed=7u;
+  std::vector<ngl::Vec3> points;
+  // a stretched cloud so the fits differ
+  for(int i=0; i<5000; ++i)
+  {
+    ngl::Vec3 p=randomVec3(seed,-1.0f,1.0f);
+    points.push_back(ngl::Vec3(p.m_x*4.0f+2.0f,p.m_y,p.m_z*0.5f-1.0f));
+  }
+  EXPECT_TRUE(ngl::BoundingSphere::fromPoints(points.data(),0).isEmpty());
+  ngl::BoundingSphere ritter=ngl::BoundingSphere::fromPoints(points.data(),points.size(),ngl::BoundingSphere::Fit::RITTER);
+  ngl::BoundingSphere iterative=ngl::BoundingSphere::fromPoints(points.data(),points.size(),ngl::BoundingSphere::Fit::ITERATIVE_RITTER);
+  ngl::BoundingSphere welzl=ngl::BoundingSphere::fromPoints(points.data(),points.size(),ngl::BoundingSphere::Fit::WELZL);
+  for(const auto &p : points)
+  {
+    EXPECT_TRUE(ritter.contains(p));
+    EXPECT_TRUE(iterative.contains(p));
+    EXPECT_TRUE(welzl.contains(p));
+  }
+  EXPECT_LE(iterative.m_radius,ritter.m_radius);
+  EXPECT_LE(welzl.m_radius,iterative.m_radius*1.0001f);
+}
+
+TEST(BoundingSphere,welzlKnownSpheres)
+{
+  // the corners of a cube are all on the minimum sphere
+  std::vector<ngl::Vec3> points;
+  for(int i=0; i<8; ++i)
+  {
+    points.push_back(ngl::Vec3((i&1) ? 1.0f : -1.0f,(i&2) ? 1.0f : -1.0f,(i&4) ? 1.0f : -1.0f));
+  }
+  // with points inside that should not change it
+  unsigned int seed=3u;
+  for(int i=0; i<100; ++i)
+  {
+    points.push_back(randomVec3(seed,-0.9f,0.9f));
+  }
+  ngl::BoundingSphere s=ngl::BoundingSphere::fromPoints(points.data(),points.size(),ngl::BoundingSphere::Fit::WELZL);
+  EXPECT_NEAR(s.m_radius,std::sqrt(3.0f),1e-4f);
+  EXPECT_NEAR(s.m_center.length(),0.0f,1e-4f);
+
+  // points on a circle are degenerate for the 4 point case
+  points.clear();
+  for(int i=0; i<64; ++i)
+  {
+    ngl::Real a=static_cast<ngl::Real>(i)*6.2831853f/64.0f;
+    points.push_back(ngl::Vec3(3.0f+2.0f*std::cos(a),2.0f*std::sin(a),5.0f));
+  }
+  s=ngl::BoundingSphere::fromPoints(points.data(),points.size(),ngl::BoundingSphere::Fit::WELZL);
+  EXPECT_NEAR(s.m_radius,2.0f,1e-4f);
+  EXPECT_NEAR((s.m_center-ngl::Vec3(3.0f,0.0f,5.0f)).length(),0.0f,1e-4f);
+
+  ngl::Vec3 one(1.0f,2.0f,3.0f);
+  s=ngl::BoundingSphere::fromPoints(&one,1,ngl::BoundingSphere::Fit::WELZL);
+  EXPECT_FLOAT_EQ(s.m_radius,0.0f);
+  EXPECT_TRUE(s.m_center==one);
+}
@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+#include <ngl/Bounds3.h>
+#include <ngl/BoundingSphere.h>
+#include <ngl/Mat4.h>
+#include <ngl/Vec4.h>
+#include <ngl/SIMD.h>
+#include <vector>
+#include "../TestUtils.h"
+
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+static ngl::Vec3 randomVec3(unsigned int &io_seed, ngl::Real _min, ngl::Real _max)
+{
+  ngl::Real x=randomReal(io_seed,_min,_max);
+  ngl::Real y=randomReal(io_seed,_min,_max);
+  ngl::Real z=randomReal(io_seed,_min,_max);
+  return ngl::Vec3(x,y,z);
+}
+
+static ngl::Mat4 someTransform()
+{
+  ngl::Mat4 r;
+  r.euler(37.0f,0.3f,0.6f,0.74f);
+  ngl::Mat4 s;
+  s.scale(2.0f,0.5f,-1.5f);
+  ngl::Mat4 t;
+  t.translate(3.0f,-4.0f,5.0f);
+  return s*r*t;
+}
+
+static void expectBoundsNear(const ngl::Bounds3 &_a, const ngl::Bounds3 &_b, ngl::Real _eps)
+{
+  for(size_t i=0; i<3; ++i)
+  {
+    EXPECT_NEAR(_a.m_min.m_openGL[i],_b.m_min.m_openGL[i],_eps);
+    EXPECT_NEAR(_a.m_max.m_openGL[i],_b.m_max.m_openGL[i],_eps);
+  }
+}
+
+TEST(Bounds3,defaultIsEmpty)
+{
+  ngl::Bounds3 b;
+  EXPECT_TRUE(b.isEmpty());
+  b.extend(ngl::Vec3(1.0f,2.0f,3.0f));
+  EXPECT_FALSE(b.isEmpty());
+  EXPECT_TRUE(b.contains(ngl::Vec3(1.0f,2.0f,3.0f)));
+  ngl::Bounds3 e;
+  e.merge(b);
+  EXPECT_EQ(e,b);
+  EXPECT_TRUE(ngl::Bounds3::fromPoints(nullptr,0).isEmpty());
+  EXPECT_TRUE(ngl::Bounds3::merge(nullptr,0).isEmpty());
+}
+
+TEST(Bounds3,fromPoints)
+{
+  forEachSIMDLevel([]()
+  {
+    unsigned int seed=3u;
+    std::vector<ngl::Vec3> points;
+    for(size_t n=1; n<40; ++n)
+    {
+      points.push_back(randomVec3(seed,-10.0f,10.0f));
+      ngl::Bounds3 expected;
+      for(const auto &p : points)
+      {
+        expected.extend(p);
+      }
+      EXPECT_EQ(ngl::Bounds3::fromPoints(points.data(),points.size()),expected);
+    }
+  });
+}
+
+TEST(Bounds3,fromPointsLarge)
+{
+  // enough points to be split into several chunks, with the extremes in different chunks
+  forEachSIMDLevel([]()
+  {
+    unsigned int seed=9u;
+    std::vector<ngl::Vec3> points(300001);
+    for(auto &p : points)
+    {
+      p=randomVec3(seed,-1.0f,1.0f);
+    }
+    points[5].m_x=-20.0f;
+    points[70000].m_y=30.0f;
+    points[150000].m_z=-40.0f;
+    points[300000].m_x=50.0f;
+    ngl::Bounds3 expected;
+    for(const auto &p : points)
+    {
+      expected.extend(p);
+    }
+    ngl::Bounds3 b=ngl::Bounds3::fromPoints(points.data(),points.size());
+    EXPECT_EQ(b,expected);
+    EXPECT_FLOAT_EQ(b.m_min.m_x,-20.0f);
+    EXPECT_FLOAT_EQ(b.m_max.m_y,30.0f);
+    EXPECT_FLOAT_EQ(b.m_min.m_z,-40.0f);
+    EXPECT_FLOAT_EQ(b.m_max.m_x,50.0f);
+  });
+}
+
+TEST(Bounds3,mergeArray)
+{
+  forEachSIMDLevel([]()
+  {
+    unsigned int seed=5u;
+    std::vector<ngl::Bounds3> boxes;
+    ngl::Bounds3 expected;
+    for(int i=0; i<33; ++i)
+    {
+      ngl::Vec3 p=randomVec3(seed,-10.0f,10.0f);
+      boxes.push_back(ngl::Bounds3(p,p+randomVec3(seed,0.0f,3.0f)));
+      expected.merge(boxes.back());
+      EXPECT_EQ(ngl::Bounds3::merge(boxes.data(),boxes.size()),expected);
+    }
+  });
+}
+
+TEST(Bounds3,transform)
+{
+  forEachSIMDLevel([]()
+  {
+    ngl::Mat4 m=someTransform();
+    unsigned int seed=9u;
+    std::vector<ngl::Bounds3> boxes;
+    for(int i=0; i<16; ++i)
+    {
+      ngl::Vec3 p=randomVec3(seed,-10.0f,10.0f);
+      boxes.push_back(ngl::Bounds3(p,p+randomVec3(seed,0.0f,3.0f)));
+    }
+    std::vector<ngl::Bounds3> out(boxes.size());
+    ngl::Bounds3::transform(boxes.data(),boxes.size(),m,out.data());
+    std::vector<ngl::Mat4> matrices(boxes.size(),m);
+    std::vector<ngl::Bounds3> inPlace=boxes;
+    ngl::Bounds3::transform(inPlace.data(),matrices.data(),inPlace.size(),inPlace.data());
+    for(size_t i=0; i<boxes.size(); ++i)
+    {
+      // the box around the 8 transformed corners
+      ngl::Bounds3 expected;
+      for(int c=0; c<8; ++c)
+      {
+        const ngl::Bounds3 &b=boxes[i];
+        ngl::Vec4 p((c&1) ? b.m_max.m_x : b.m_min.m_x,(c&2) ? b.m_max.m_y : b.m_min.m_y,(c&4) ? b.m_max.m_z : b.m_min.m_z,1.0f);
+        p=p*m;
+        expected.extend(ngl::Vec3(p.m_x,p.m_y,p.m_z));
+      }
+      expectBoundsNear(boxes[i].transformed(m),expected,1e-4f);
+      expectBoundsNear(out[i],expected,1e-4f);
+      expectBoundsNear(inPlace[i],expected,1e-4f);
+    }
+  });
+}
+
+TEST(Bounds3,intersections)
+{
+  ngl::Bounds3 b(ngl::Vec3(-1.0f,-1.0f,-1.0f),ngl::Vec3(1.0f,1.0f,1.0f));
+  EXPECT_TRUE(b.intersects(ngl::Bounds3(ngl::Vec3(0.5f,0.5f,0.5f),ngl::Vec3(2.0f,2.0f,2.0f))));
+  EXPECT_TRUE(b.intersects(ngl::Bounds3(ngl::Vec3(1.0f,-1.0f,-1.0f),ngl::Vec3(2.0f,2.0f,2.0f))));
+  EXPECT_FALSE(b.intersects(ngl::Bounds3(ngl::Vec3(1.5f,0.0f,0.0f),ngl::Vec3(2.0f,2.0f,2.0f))));
+  EXPECT_TRUE(b.contains(ngl::Bounds3(ngl::Vec3(-0.5f,-0.5f,-0.5f),ngl::Vec3(0.5f,0.5f,0.5f))));
+  EXPECT_FALSE(b.contains(ngl::Bounds3(ngl::Vec3(-0.5f,-0.5f,-0.5f),ngl::Vec3(1.5f,0.5f,0.5f))));
+
+  EXPECT_TRUE(b.intersects(ngl::BoundingSphere(ngl::Vec3(2.0f,0.0f,0.0f),1.01f)));
+  EXPECT_FALSE(b.intersects(ngl::BoundingSphere(ngl::Vec3(2.0f,2.0f,0.0f),1.2f)));
+  EXPECT_FLOAT_EQ(b.distanceSquared(ngl::Vec3(3.0f,3.0f,0.0f)),8.0f);
+  EXPECT_FLOAT_EQ(b.distanceSquared(ngl::Vec3(0.5f,0.0f,0.0f)),0.0f);
+
+  ngl::Real t;
+  EXPECT_TRUE(b.intersectRay(ngl::Vec3(-5.0f,0.0f,0.0f),ngl::Vec3(1.0f,1.0f/0.0f,1.0f/0.0f),10.0f,t));
+  EXPECT_FLOAT_EQ(t,4.0f);
+  EXPECT_FALSE(b.intersectRay(ngl::Vec3(-5.0f,0.0f,0.0f),ngl::Vec3(1.0f,1.0f/0.0f,1.0f/0.0f),3.0f,t));
+  EXPECT_FALSE(b.intersectRay(ngl::Vec3(-5.0f,2.0f,0.0f),ngl::Vec3(1.0f,1.0f/0.0f,1.0f/0.0f),10.0f,t));
+  EXPECT_TRUE(b.intersectRay(ngl::Vec3(0.0f,0.0f,0.0f),ngl::Vec3(1.0f,1.0f,1.0f),10.0f,t));
+  EXPECT_FLOAT_EQ(t,0.0f);
+
+  EXPECT_FLOAT_EQ(b.surfaceArea(),24.0f);
+  EXPECT_EQ(b.center(),ngl::Vec3(0.0f,0.0f,0.0f));
+  EXPECT_EQ(b.expanded(1.0f),ngl::Bounds3(ngl::Vec3(-2.0f,-2.0f,-2.0f),ngl::Vec3(2.0f,2.0f,2.0f)));
+}
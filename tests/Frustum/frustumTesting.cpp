@@ -0,0 +1,407 @@
+#include <gtest/gtest.h>
+#include <ngl/Frustum.h>
+#include <ngl/Camera.h>
+#include <ngl/Plane.h>
+#include <ngl/Util.h>
+#include <ngl/Mat4.h>
+#include <ngl/Vec3.h>
+#include <ngl/Vec4.h>
+#include <ngl/Vec3Array.h>
+#include <ngl/SIMD.h>
+#include <cmath>
+#include <vector>
+#include "../TestUtils.h"
+
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+static std::vector<ngl::Vec3> testPoints()
+{
+  std::vector<ngl::Vec3> p;
+  unsigned int seed=12345u;
+  for(int i=0; i<2000; ++i)
+  {
+    ngl::Real v[3];
+    for(auto &c : v)
+    {
+      seed=seed*1664525u+1013904223u;
+      c=static_cast<ngl::Real>(seed%20000)*0.001f-10.0f;
+    }
+    p.push_back(ngl::Vec3(v[0],v[1],v[2]));
+  }
+  return p;
+}
+
+// enough objects for the cull to use several threads and an odd count for a part filled last word
+constexpr size_t c_cullCount=40009;
+
+static ngl::Frustum cullFrustum()
+{
+  return ngl::Frustum(ngl::lookAt(ngl::Vec3(1.0f,2.0f,5.0f),ngl::Vec3(0.0f,0.0f,0.0f),ngl::Vec3(0.0f,1.0f,0.0f))*
+                      ngl::perspective(50.0f,1.5f,0.5f,15.0f));
+}
+
+// the frustum corners found by transforming the clip space cube back out
+static ngl::Vec3 corner(const ngl::Mat4 &_inverseVP, ngl::Real _x, ngl::Real _y, ngl::Real _z)
+{
+  ngl::Vec4 p=ngl::Vec4(_x,_y,_z,1.0f)*_inverseVP;
+  return ngl::Vec3(p.m_x/p.m_w,p.m_y/p.m_w,p.m_z/p.m_w);
+}
+
+// true if _p is well away from every plane so rounding can't change the answer
+static bool clearOfPlanes(const ngl::Frustum &_f, const ngl::Vec3 &_p)
+{
+  for(size_t i=0; i<ngl::Frustum::c_numPlanes; ++i)
+  {
+    if(std::abs(_f.distance(i,_p)) < 0.001f)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+TEST(NGLFrustum,identityIsClipCube)
+{
+  ngl::Frustum f;
+  EXPECT_EQ(f.isPointInFrustum(ngl::Vec3(0.0f,0.0f,0.0f)),ngl::CameraIntercept::INSIDE);
+  EXPECT_EQ(f.isPointInFrustum(ngl::Vec3(0.99f,-0.99f,0.99f)),ngl::CameraIntercept::INSIDE);
+  EXPECT_EQ(f.isPointInFrustum(ngl::Vec3(1.01f,0.0f,0.0f)),ngl::CameraIntercept::OUTSIDE);
+  EXPECT_EQ(f.isPointInFrustum(ngl::Vec3(0.0f,0.0f,-1.01f)),ngl::CameraIntercept::OUTSIDE);
+  for(size_t i=0; i<ngl::Frustum::c_numPlanes; ++i)
+  {
+    EXPECT_FLOAT_EQ(f.getD()[i],1.0f);
+  }
+}
+
+TEST(NGLFrustum,perspectiveMatchesCornerPlanes)
+{
+  ngl::Mat4 vp=ngl::lookAt(ngl::Vec3(1.0f,2.0f,5.0f),ngl::Vec3(0.0f,0.0f,0.0f),ngl::Vec3(0.0f,1.0f,0.0f))*
+               ngl::perspective(50.0f,1.5f,0.5f,15.0f);
+  ngl::Frustum f(vp);
+  ngl::Mat4 inv=vp.inverse();
+  ngl::Vec3 ntl=corner(inv,-1, 1,-1), ntr=corner(inv,1, 1,-1), nbl=corner(inv,-1,-1,-1), nbr=corner(inv,1,-1,-1);
+  ngl::Vec3 ftl=corner(inv,-1, 1, 1), ftr=corner(inv,1, 1, 1), fbl=corner(inv,-1,-1, 1), fbr=corner(inv,1,-1, 1);
+  // the planes as the old Camera::calculateFrustum built them from the corner points
+  ngl::Plane planes[6]={ {ntr,ntl,ftl},{nbl,nbr,fbr},{ntl,nbl,fbl},{nbr,ntr,fbr},{ntl,ntr,nbr},{ftr,ftl,fbl} };
+  for(size_t i=0; i<ngl::Frustum::c_numPlanes; ++i)
+  {
+    EXPECT_NEAR(f.getNormalX()[i],planes[i].getNormal().m_x,0.0001f);
+    EXPECT_NEAR(f.getNormalY()[i],planes[i].getNormal().m_y,0.0001f);
+    EXPECT_NEAR(f.getNormalZ()[i],planes[i].getNormal().m_z,0.0001f);
+    EXPECT_NEAR(f.getD()[i],planes[i].getD(),0.001f);
+  }
+  size_t inside=0;
+  for(const auto &p : testPoints())
+  {
+    if(!clearOfPlanes(f,p))
+    {
+      continue;
+    }
+    bool expected=true;
+    for(const auto &plane : planes)
+    {
+      expected=expected && plane.distance(p) >= 0.0f;
+    }
+    EXPECT_EQ(f.isPointInFrustum(p)==ngl::CameraIntercept::INSIDE,expected);
+    inside+=expected;
+  }
+  EXPECT_GT(inside,0u);
+}
+
+TEST(NGLFrustum,ortho)
+{
+  ngl::Frustum f(ngl::ortho(-2.0f,2.0f,-1.0f,1.0f,0.1f,10.0f));
+  EXPECT_EQ(f.isPointInFrustum(ngl::Vec3(1.9f,0.9f,-5.0f)),ngl::CameraIntercept::INSIDE);
+  EXPECT_EQ(f.isPointInFrustum(ngl::Vec3(2.1f,0.0f,-5.0f)),ngl::CameraIntercept::OUTSIDE);
+  EXPECT_EQ(f.isPointInFrustum(ngl::Vec3(0.0f,0.0f,-10.5f)),ngl::CameraIntercept::OUTSIDE);
+  EXPECT_EQ(f.isPointInFrustum(ngl::Vec3(0.0f,0.0f,0.0f)),ngl::CameraIntercept::OUTSIDE);
+  EXPECT_EQ(f.isSphereInFrustum(ngl::Vec3(0.0f,0.0f,-5.0f),0.5f),ngl::CameraIntercept::INSIDE);
+  EXPECT_EQ(f.isSphereInFrustum(ngl::Vec3(2.2f,0.0f,-5.0f),0.5f),ngl::CameraIntercept::INTERSECT);
+  EXPECT_EQ(f.isSphereInFrustum(ngl::Vec3(3.0f,0.0f,-5.0f),0.5f),ngl::CameraIntercept::OUTSIDE);
+  EXPECT_EQ(f.boxInFrustum(ngl::Vec3(-1.0f,-0.5f,-6.0f),ngl::Vec3(1.0f,0.5f,-4.0f)),ngl::CameraIntercept::INSIDE);
+  EXPECT_EQ(f.boxInFrustum(ngl::Vec3(1.0f,-0.5f,-6.0f),ngl::Vec3(3.0f,0.5f,-4.0f)),ngl::CameraIntercept::INTERSECT);
+  EXPECT_EQ(f.boxInFrustum(ngl::Vec3(2.5f,-0.5f,-6.0f),ngl::Vec3(3.0f,0.5f,-4.0f)),ngl::CameraIntercept::OUTSIDE);
+  ngl::AABB box(ngl::Vec4(1.0f,-0.5f,-6.0f,1.0f),2.0f,1.0f,2.0f);
+  EXPECT_EQ(f.boxInFrustum(box),ngl::CameraIntercept::INTERSECT);
+}
+
+TEST(NGLFrustum,infinitePerspective)
+{
+  ngl::Frustum f(ngl::infinitePerspective(45.0f,1.0f,0.1f));
+  EXPECT_EQ(f.isPointInFrustum(ngl::Vec3(0.0f,0.0f,-1.0e6f)),ngl::CameraIntercept::INSIDE);
+  EXPECT_EQ(f.isPointInFrustum(ngl::Vec3(0.0f,0.0f,1.0f)),ngl::CameraIntercept::OUTSIDE);
+}
+
+TEST(NGLFrustum,camera)
+{
+  ngl::Camera cam(ngl::Vec3(2.0f,3.0f,4.0f),ngl::Vec3(0.0f,0.0f,0.0f),ngl::Vec3(0.0f,1.0f,0.0f));
+  cam.setShape(60.0f,1.25f,0.2f,20.0f);
+  ngl::Frustum f(cam.getVPMatrix());
+  for(const auto &p : testPoints())
+  {
+    EXPECT_EQ(cam.isPointInFrustum(p),f.isPointInFrustum(p));
+    EXPECT_EQ(cam.isSphereInFrustum(p,0.5f),f.isSphereInFrustum(p,0.5f));
+  }
+  EXPECT_EQ(cam.isPointInFrustum(ngl::Vec3(0.0f,0.0f,0.0f)),ngl::CameraIntercept::INSIDE);
+  EXPECT_EQ(cam.isPointInFrustum(ngl::Vec3(4.0f,6.0f,8.0f)),ngl::CameraIntercept::OUTSIDE);
+}
+
+TEST(NGLFrustum,cameraMatchesCornerPlanes)
+{
+  ngl::Camera cam(ngl::Vec3(2.0f,3.0f,4.0f),ngl::Vec3(0.0f,0.5f,-1.0f),ngl::Vec3(0.0f,1.0f,0.0f));
+  cam.setShape(60.0f,1.25f,0.2f,20.0f);
+  // the corners as the old Camera::calculateFrustum found them from the camera values
+  ngl::Real tang=std::tan(ngl::radians(cam.getFOV())*0.5f);
+  ngl::Real nh=cam.getNear()*tang;
+  ngl::Real nw=nh*cam.getAspect();
+  ngl::Real fh=cam.getFar()*tang;
+  ngl::Real fw=fh*cam.getAspect();
+  ngl::Vec3 u=cam.getU().toVec3();
+  ngl::Vec3 v=cam.getV().toVec3();
+  ngl::Vec3 nc=(cam.getEye()-cam.getN()*cam.getNear()).toVec3();
+  ngl::Vec3 fc=(cam.getEye()-cam.getN()*cam.getFar()).toVec3();
+  ngl::Vec3 ntl=nc+v*nh-u*nw, ntr=nc+v*nh+u*nw, nbl=nc-v*nh-u*nw, nbr=nc-v*nh+u*nw;
+  ngl::Vec3 ftl=fc+v*fh-u*fw, ftr=fc+v*fh+u*fw, fbl=fc-v*fh-u*fw, fbr=fc-v*fh+u*fw;
+  ngl::Plane planes[6]={ {ntr,ntl,ftl},{nbl,nbr,fbr},{ntl,nbl,fbl},{nbr,ntr,fbr},{ntl,ntr,nbr},{ftr,ftl,fbl} };
+  const ngl::Frustum &f=cam.getFrustum();
+  for(size_t i=0; i<ngl::Frustum::c_numPlanes; ++i)
+  {
+    EXPECT_NEAR(f.getNormalX()[i],planes[i].getNormal().m_x,0.0001f) << i;
+    EXPECT_NEAR(f.getNormalY()[i],planes[i].getNormal().m_y,0.0001f) << i;
+    EXPECT_NEAR(f.getNormalZ()[i],planes[i].getNormal().m_z,0.0001f) << i;
+    EXPECT_NEAR(f.getD()[i],planes[i].getD(),0.001f) << i;
+  }
+  size_t inside=0;
+  for(const auto &p : testPoints())
+  {
+    if(!clearOfPlanes(f,p))
+    {
+      continue;
+    }
+    bool expected=true;
+    for(const auto &plane : planes)
+    {
+      expected=expected && plane.distance(p) >= 0.0f;
+    }
+    EXPECT_EQ(cam.isPointInFrustum(p)==ngl::CameraIntercept::INSIDE,expected);
+    inside+=expected;
+  }
+  EXPECT_GT(inside,0u);
+}
+
+TEST(NGLFrustum,cullBoxes)
+{
+  ngl::Frustum f=cullFrustum();
+  std::vector<ngl::AABB> boxes;
+  ngl::Vec3Array mn;
+  ngl::Vec3Array mx;
+  unsigned int seed=99u;
+  for(size_t i=0; i<c_cullCount; ++i)
+  {
+    ngl::Vec3 corner(randomReal(seed,-15.0f,15.0f),randomReal(seed,-15.0f,15.0f),randomReal(seed,-15.0f,15.0f));
+    ngl::Vec3 size(randomReal(seed,0.0f,2.0f),randomReal(seed,0.0f,2.0f),randomReal(seed,0.0f,2.0f));
+    boxes.push_back(ngl::AABB(ngl::Vec4(corner.m_x,corner.m_y,corner.m_z,1.0f),size.m_x,size.m_y,size.m_z));
+    mn.push_back(boxes.back().getMin());
+    mx.push_back(boxes.back().getMax());
+  }
+  forEachSIMDLevel([&]()
+  {
+    std::vector<uint32_t> mask(ngl::Frustum::maskWords(c_cullCount),0xffffffff);
+    std::vector<uint32_t> aosMask(mask.size(),0xffffffff);
+    f.cullBoxes(mn,mx,mask.data());
+    f.cullBoxes(boxes.data(),boxes.size(),aosMask.data());
+    std::vector<size_t> indices;
+    f.cullBoxes(mn,mx,indices);
+    size_t next=0;
+    for(size_t i=0; i<c_cullCount; ++i)
+    {
+      bool visible=f.boxInFrustum(boxes[i])!=ngl::CameraIntercept::OUTSIDE;
+      ASSERT_EQ(((mask[i/32] >> (i%32)) & 1u)!=0,visible) << i;
+      ASSERT_EQ(((aosMask[i/32] >> (i%32)) & 1u)!=0,visible) << i;
+      if(visible)
+      {
+        ASSERT_LT(next,indices.size());
+        EXPECT_EQ(indices[next++],i);
+      }
+    }
+    EXPECT_EQ(next,indices.size());
+    EXPECT_GT(next,0u);
+    // the bits past the end are cleared
+    EXPECT_EQ(mask.back() >> (c_cullCount%32),0u);
+  });
+}
+
+TEST(NGLFrustum,cullSpheres)
+{
+  ngl::Frustum f=cullFrustum();
+  ngl::Vec3Array centre;
+  std::vector<ngl::Real> radius;
+  unsigned int seed=7u;
+  for(size_t i=0; i<c_cullCount; ++i)
+  {
+    centre.push_back(ngl::Vec3(randomReal(seed,-15.0f,15.0f),randomReal(seed,-15.0f,15.0f),randomReal(seed,-15.0f,15.0f)));
+    radius.push_back(randomReal(seed,0.0f,1.5f));
+  }
+  forEachSIMDLevel([&]()
+  {
+    std::vector<uint32_t> mask(ngl::Frustum::maskWords(c_cullCount));
+    f.cullSpheres(centre,radius.data(),mask.data());
+    std::vector<size_t> indices;
+    f.cullSpheres(centre,radius.data(),indices);
+    size_t next=0;
+    for(size_t i=0; i<c_cullCount; ++i)
+    {
+      bool visible=f.isSphereInFrustum(centre.get(i),radius[i])!=ngl::CameraIntercept::OUTSIDE;
+      ASSERT_EQ(((mask[i/32] >> (i%32)) & 1u)!=0,visible) << i;
+      if(visible)
+      {
+        ASSERT_LT(next,indices.size());
+        EXPECT_EQ(indices[next++],i);
+      }
+    }
+    EXPECT_EQ(next,indices.size());
+    EXPECT_GT(next,0u);
+  });
+}
+
+// true if the sphere is well away from being just outside any plane, so planes from a different but
+// equivalent matrix give the same answer
+static bool clearOfPlanes(const ngl::Frustum &_f, const ngl::Vec3 &_c, ngl::Real _radius)
+{
+  for(size_t i=0; i<ngl::Frustum::c_numPlanes; ++i)
+  {
+    if(std::abs(_f.distance(i,_c)+_radius) < 0.001f)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+TEST(NGLFrustum,cameraCull)
+{
+  // the camera batch culls checked against planes built independently from ngl::lookAt and ngl::perspective
+  ngl::Vec3 eye(1.0f,2.0f,5.0f);
+  ngl::Vec3 look(0.0f,0.0f,0.0f);
+  ngl::Vec3 up(0.0f,1.0f,0.0f);
+  ngl::Camera cam(eye,look,up);
+  cam.setShape(50.0f,1.5f,0.5f,15.0f);
+  ngl::Frustum f(ngl::lookAt(eye,look,up)*ngl::perspective(50.0f,1.5f,0.5f,15.0f));
+  ngl::Vec3Array centre;
+  ngl::Vec3Array mn;
+  ngl::Vec3Array mx;
+  std::vector<ngl::Real> radius;
+  unsigned int seed=31u;
+  for(size_t i=0; i<c_cullCount; ++i)
+  {
+    ngl::Vec3 c(randomReal(seed,-15.0f,15.0f),randomReal(seed,-15.0f,15.0f),randomReal(seed,-15.0f,15.0f));
+    ngl::Real r=randomReal(seed,0.0f,1.5f);
+    centre.push_back(c);
+    radius.push_back(r);
+    // the cube around the sphere
+    mn.push_back(c-ngl::Vec3(r,r,r));
+    mx.push_back(c+ngl::Vec3(r,r,r));
+  }
+  forEachSIMDLevel([&]()
+  {
+    std::vector<uint32_t> sphereMask(ngl::Frustum::maskWords(c_cullCount));
+    std::vector<uint32_t> boxMask(sphereMask.size());
+    cam.cullSpheres(centre,radius.data(),sphereMask.data());
+    cam.cullBoxes(mn,mx,boxMask.data());
+    size_t checked=0;
+    size_t visible=0;
+    for(size_t i=0; i<c_cullCount; ++i)
+    {
+      ngl::Vec3 c=centre.get(i);
+      if(!clearOfPlanes(f,c,radius[i]))
+      {
+        continue;
+      }
+      bool sphere=f.isSphereInFrustum(c,radius[i])!=ngl::CameraIntercept::OUTSIDE;
+      ASSERT_EQ(((sphereMask[i/32] >> (i%32)) & 1u)!=0,sphere) << i;
+      ++checked;
+      visible+=sphere;
+      // a visible sphere has a visible box around it
+      if(sphere)
+      {
+        ASSERT_NE((boxMask[i/32] >> (i%32)) & 1u,0u) << i;
+      }
+    }
+    EXPECT_GT(checked,c_cullCount*9/10);
+    EXPECT_GT(visible,0u);
+    // and the boxes against the independent planes
+    std::vector<uint32_t> expected(boxMask.size());
+    f.cullBoxes(mn,mx,expected.data());
+    size_t differ=0;
+    for(size_t w=0; w<expected.size(); ++w)
+    {
+      for(uint32_t bits=expected[w]^boxMask[w]; bits!=0; bits&=bits-1)
+      {
+        ++differ;
+      }
+    }
+    // only boxes touching a plane can differ by rounding
+    EXPECT_LT(differ,c_cullCount/1000);
+  });
+}
+
+TEST(NGLFrustum,cullMultipleViews)
+{
+  // more views than are done in one pass, each orbiting the origin with a different projection
+  std::vector<ngl::Frustum> views;
+  for(int v=0; v<10; ++v)
+  {
+    ngl::Real a=static_cast<ngl::Real>(v)*0.6f;
+    ngl::Mat4 view=ngl::lookAt(ngl::Vec3(8.0f*std::cos(a),2.0f,8.0f*std::sin(a)),ngl::Vec3(0.0f,0.0f,0.0f),ngl::Vec3(0.0f,1.0f,0.0f));
+    views.push_back(ngl::Frustum(view*(v%2 ? ngl::ortho(-4.0f,4.0f,-4.0f,4.0f,0.5f,20.0f) : ngl::perspective(40.0f+v,1.5f,0.5f,20.0f))));
+  }
+  std::vector<ngl::AABB> boxes;
+  ngl::Vec3Array mn;
+  ngl::Vec3Array mx;
+  std::vector<ngl::Real> radius;
+  unsigned int seed=31u;
+  for(size_t i=0; i<c_cullCount; ++i)
+  {
+    ngl::Vec3 corner(randomReal(seed,-15.0f,15.0f),randomReal(seed,-15.0f,15.0f),randomReal(seed,-15.0f,15.0f));
+    ngl::Real size=randomReal(seed,0.0f,2.0f);
+    boxes.push_back(ngl::AABB(ngl::Vec4(corner.m_x,corner.m_y,corner.m_z,1.0f),size,size,size));
+    mn.push_back(boxes.back().getMin());
+    mx.push_back(boxes.back().getMax());
+    radius.push_back(size);
+  }
+  forEachSIMDLevel([&]()
+  {
+    size_t words=ngl::Frustum::maskWords(c_cullCount);
+    std::vector<std::vector<uint32_t>> boxMask(views.size(),std::vector<uint32_t>(words));
+    std::vector<std::vector<uint32_t>> aosMask(views.size(),std::vector<uint32_t>(words));
+    std::vector<std::vector<uint32_t>> sphereMask(views.size(),std::vector<uint32_t>(words));
+    std::vector<uint32_t *> boxOut;
+    std::vector<uint32_t *> aosOut;
+    std::vector<uint32_t *> sphereOut;
+    for(size_t v=0; v<views.size(); ++v)
+    {
+      boxOut.push_back(boxMask[v].data());
+      aosOut.push_back(aosMask[v].data());
+      sphereOut.push_back(sphereMask[v].data());
+    }
+    ngl::Frustum::cullBoxes(views.data(),views.size(),mn,mx,boxOut.data());
+    ngl::Frustum::cullBoxes(views.data(),views.size(),boxes.data(),boxes.size(),aosOut.data());
+    ngl::Frustum::cullSpheres(views.data(),views.size(),mn,radius.data(),sphereOut.data());
+    for(size_t v=0; v<views.size(); ++v)
+    {
+      std::vector<uint32_t> single(words);
+      views[v].cullBoxes(mn,mx,single.data());
+      EXPECT_EQ(boxMask[v],single) << v;
+      EXPECT_EQ(aosMask[v],single) << v;
+      views[v].cullSpheres(mn,radius.data(),single.data());
+      EXPECT_EQ(sphereMask[v],single) << v;
+    }
+    // the views see different things
+    EXPECT_NE(boxMask[0],boxMask[1]);
+  });
+}
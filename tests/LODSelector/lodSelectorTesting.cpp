@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include <ngl/LODSelector.h>
+#include <ngl/Camera.h>
+#include <ngl/Frustum.h>
+#include <ngl/Vec3.h>
+#include <ngl/Vec3Array.h>
+#include <ngl/SIMD.h>
+#include <ngl/Util.h>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "../TestUtils.h"
+
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+// a 90 degree camera at the origin looking down -z, a pixel of a 1000 pixel viewport is 0.002 wide at 1 unit
+static ngl::Camera testCamera()
+{
+  ngl::Camera cam(ngl::Vec3(0.0f,0.0f,0.0f),ngl::Vec3(0.0f,0.0f,-1.0f),ngl::Vec3(0.0f,1.0f,0.0f));
+  cam.setShape(90.0f,1.0f,0.5f,200.0f);
+  cam.calculateFrustum();
+  return cam;
+}
+
+static const ngl::Real c_errors[5]={0.0f,0.01f,0.02f,0.04f,0.08f};
+
+TEST(NGLLODSelector,projectedError)
+{
+  ngl::LODSelector s(testCamera(),1000.0f);
+  EXPECT_NEAR(s.projectedError(ngl::Vec3(0.0f,0.0f,-10.0f),0.0f,0.01f),0.5f,1e-5f);
+  // measured to the front of the sphere
+  EXPECT_NEAR(s.projectedError(ngl::Vec3(0.0f,0.0f,-12.0f),2.0f,0.01f),0.5f,1e-5f);
+  EXPECT_NEAR(s.projectedError(ngl::Vec3(0.0f,20.0f,0.0f),0.0f,0.01f),0.25f,1e-5f);
+  // a sphere around the eye is measured from the near plane
+  EXPECT_NEAR(s.projectedError(ngl::Vec3(0.0f,0.0f,-1.0f),3.0f,0.01f),10.0f,1e-4f);
+}
+
+TEST(NGLLODSelector,coarserWithDistance)
+{
+  ngl::LODSelector s(testCamera(),1000.0f,1.0f,0.0f);
+  size_t previous=0;
+  for(ngl::Real z=1.0f; z<100.0f; z+=0.25f)
+  {
+    ngl::Vec3 c(0.0f,0.0f,-z);
+    size_t level=s.selectLOD(c,0.5f,c_errors,5);
+    EXPECT_GE(level,previous);
+    previous=level;
+    // the coarsest level within a pixel
+    EXPECT_LE(s.projectedError(c,0.5f,c_errors[level]),1.0001f);
+    if(level<4)
+    {
+      EXPECT_GT(s.projectedError(c,0.5f,c_errors[level+1]),0.9999f);
+    }
+  }
+  EXPECT_EQ(previous,4u);
+  EXPECT_EQ(s.selectLOD(ngl::Vec3(0.0f,0.0f,-1.0f),0.5f,c_errors,5),0u);
+}
+
+TEST(NGLLODSelector,hysteresis)
+{
+  ngl::LODSelector s(testCamera(),1000.0f,1.0f,0.2f);
+  // level 1 at 1.1 pixels, over the limit but not by 20% so a level 1 object stays there
+  ngl::Vec3 c(0.0f,0.0f,-0.01f/(1.1f*0.002f));
+  EXPECT_EQ(s.selectLOD(c,0.0f,c_errors,2,0),0u);
+  EXPECT_EQ(s.selectLOD(c,0.0f,c_errors,2,1),1u);
+  // at 1.3 pixels it goes back to level 0
+  c.m_z=-0.01f/(1.3f*0.002f);
+  EXPECT_EQ(s.selectLOD(c,0.0f,c_errors,2,1),0u);
+  // at 0.9 pixels a level 0 object waits, at 0.8 it moves to level 1
+  c.m_z=-0.01f/(0.9f*0.002f);
+  EXPECT_EQ(s.selectLOD(c,0.0f,c_errors,2,0),0u);
+  c.m_z=-0.01f/(0.8f*0.002f);
+  EXPECT_EQ(s.selectLOD(c,0.0f,c_errors,2,0),1u);
+  // without hysteresis the level only depends on the distance
+  s.setHysteresis(0.0f);
+  c.m_z=-0.01f/(1.1f*0.002f);
+  EXPECT_EQ(s.selectLOD(c,0.0f,c_errors,2,1),0u);
+}
+
+TEST(NGLLODSelector,cullSpheresMatchesSingle)
+{
+  // enough objects for several threads and an odd count for a part filled last word
+  constexpr size_t count=40009;
+  constexpr size_t levels=5;
+  ngl::Camera cam=testCamera();
+  ngl::LODSelector s(cam,720.0f,2.0f,0.25f);
+  ngl::Vec3Array centre;
+  std::vector<ngl::Real> radius;
+  std::vector<ngl::Real> errors[levels];
+  std::vector<uint8_t> start;
+  unsigned int seed=7u;
+  for(size_t i=0; i<count; ++i)
+  {
+    centre.push_back(ngl::Vec3(randomReal(seed,-60.0f,60.0f),randomReal(seed,-60.0f,60.0f),randomReal(seed,-100.0f,10.0f)));
+    radius.push_back(randomReal(seed,0.0f,2.0f));
+    // objects with fewer levels pad the rest with the largest error
+    size_t used=1+static_cast<size_t>(randomReal(seed,0.0f,4.99f));
+    ngl::Real e=0.0f;
+    for(size_t l=0; l<levels; ++l)
+    {
+      errors[l].push_back(l<used ? e : std::numeric_limits<ngl::Real>::max());
+      e+=randomReal(seed,0.0f,0.05f);
+    }
+    start.push_back(static_cast<uint8_t>(randomReal(seed,0.0f,4.99f)));
+  }
+  const ngl::Real *levelError[levels]={errors[0].data(),errors[1].data(),errors[2].data(),errors[3].data(),errors[4].data()};
+  std::vector<uint32_t> expected(ngl::Frustum::maskWords(count));
+  cam.cullSpheres(centre,radius.data(),expected.data());
+  // the camera planes against ones built independently, skipping spheres just touching a plane
+  ngl::Frustum f(ngl::lookAt(ngl::Vec3(0.0f,0.0f,0.0f),ngl::Vec3(0.0f,0.0f,-1.0f),ngl::Vec3(0.0f,1.0f,0.0f))*
+                 ngl::perspective(90.0f,1.0f,0.5f,200.0f));
+  size_t checked=0;
+  size_t visible=0;
+  for(size_t i=0; i<count; ++i)
+  {
+    bool clear=true;
+    for(size_t p=0; p<ngl::Frustum::c_numPlanes; ++p)
+    {
+      clear=clear && std::abs(f.distance(p,centre.get(i))+radius[i]) >= 0.001f;
+    }
+    if(clear)
+    {
+      bool expectVisible=f.isSphereInFrustum(centre.get(i),radius[i])!=ngl::CameraIntercept::OUTSIDE;
+      ASSERT_EQ(((expected[i/32] >> (i%32)) & 1u)!=0,expectVisible) << i;
+      ++checked;
+      visible+=expectVisible;
+    }
+  }
+  EXPECT_GT(checked,count*9/10);
+  EXPECT_GT(visible,0u);
+  forEachSIMDLevel([&]()
+  {
+    std::vector<uint32_t> mask(ngl::Frustum::maskWords(count));
+    std::vector<uint8_t> level=start;
+    s.cullSpheres(centre,radius.data(),levelError,levels,mask.data(),level.data());
+    EXPECT_EQ(mask,expected);
+    size_t changed=0;
+    for(size_t i=0; i<count; ++i)
+    {
+      ngl::Real e[levels];
+      for(size_t l=0; l<levels; ++l)
+      {
+        e[l]=errors[l][i];
+      }
+      ASSERT_EQ(level[i],s.selectLOD(centre.get(i),radius[i],e,levels,start[i])) << i;
+      changed+=level[i]!=start[i];
+    }
+    EXPECT_GT(changed,0u);
+  });
+}
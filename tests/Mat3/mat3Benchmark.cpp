@@ -1,8 +1,10 @@
 #include <ngl/Mat3.h>
 #include <ngl/Vec3.h>
+#include <ngl/Mat4.h>
 #include <ngl/NGLStream.h>
 #include <hayai/hayai.hpp>
 #include <hayai/hayai_main.hpp>
+#include <vector>
 
 static ngl::Mat3 t1;
 static ngl::Mat3 t2(1.0);
@@ -39,6 +41,73 @@ BENCHMARK(Mat3Tests, TestCopyCtor, 10, 100)
 }
 
 
+// per object normal matrices and bulk 3x3 maths over a frame's worth of objects
+constexpr size_t c_count=4096;
+static std::vector<ngl::Mat3> a(c_count,ngl::Mat3(1.0f,0.5f,0.0f,0.25f,2.0f,1.0f,-0.5f,0.0f,2.0f));
+static std::vector<ngl::Mat3> b(c_count,ngl::Mat3(2.0f,0.0f,1.0f,0.0f,1.0f,0.5f,1.0f,0.25f,3.0f));
+static std::vector<ngl::Mat3> o(c_count);
+static std::vector<ngl::Real> d(c_count);
+static ngl::Mat4 model(1,0,0,0,0,2,2,0,0,-0.5,2,0,1,2,3,1);
+
+BENCHMARK(Mat3Tests, NormalMatrixFromInverse, 10, 100)
+{
+  ngl::Mat4 m=model;
+  m=m.inverse();
+  m.transpose();
+  o[0]=ngl::Mat3(m);
+}
+
+BENCHMARK(Mat3Tests, NormalMatrix, 10, 100)
+{
+  o[0]=model.normalMatrix();
+}
+
+BENCHMARK(Mat3Tests, NormalMatrixUniformScale, 10, 100)
+{
+  o[0]=model.normalMatrix(true);
+}
+
+BENCHMARK(Mat3Tests, MultiplyLoop, 10, 100)
+{
+  for(size_t i=0; i<c_count; ++i)
+  {
+    o[i]=a[i]*b[i];
+  }
+}
+
+BENCHMARK(Mat3Tests, MultiplyArray, 10, 100)
+{
+  ngl::multiplyMatrices(a.data(),b.data(),c_count,o.data());
+}
+
+BENCHMARK(Mat3Tests, InverseLoop, 10, 100)
+{
+  for(size_t i=0; i<c_count; ++i)
+  {
+    ngl::Mat3 m(a[i]);
+    o[i]=m.inverse();
+  }
+}
+
+BENCHMARK(Mat3Tests, InverseArray, 10, 100)
+{
+  ngl::inverseMatrices(a.data(),c_count,o.data());
+}
+
+BENCHMARK(Mat3Tests, DeterminantLoop, 10, 100)
+{
+  for(size_t i=0; i<c_count; ++i)
+  {
+    d[i]=a[i].determinant();
+  }
+}
+
+BENCHMARK(Mat3Tests, DeterminantArray, 10, 100)
+{
+  ngl::determinants(a.data(),c_count,d.data());
+}
+
+
 int main(int argc, char **argv)
 {
     // Set up the main runner.
@@ -1,9 +1,12 @@
 #include <gtest/gtest.h>
 #include <ngl/Mat3.h>
 #include <ngl/Vec3.h>
+#include <ngl/SIMD.h>
 #include <string>
 #include <sstream>
+#include <vector>
 #include <ngl/NGLStream.h>
+#include "../TestUtils.h"
 
 
 int main(int argc, char **argv)
@@ -193,11 +196,8 @@ TEST(NGLMat3,Mat3plus)
 
 TEST(NGLMat3,Mat3xReal)
 {
-  ngl::Mat3 test;
-  int value=0.0f;
-  for(int y=0; y<4; ++y)
-    for(int x=0; x<4; ++x)
-        test.setAtXY(x,y,value++);
+  // the values a 4x4 fill would leave in the 3x3 (writing past m_m is undefined now setAtXY is inline)
+  ngl::Mat3 test(0,4,8,12,5,9,13,6,10);
   test=test*4.2f;
   ngl::Mat3 result(0,16.8,33.6,50.4,21,37.8,54.6,25.2,42);
 
@@ -206,11 +206,8 @@ TEST(NGLMat3,Mat3xReal)
 
 TEST(NGLMat3,Mat3xEqualReal)
 {
-  ngl::Mat3 test;
-  int value=0.0f;
-  for(int y=0; y<4; ++y)
-    for(int x=0; x<4; ++x)
-        test.setAtXY(x,y,value++);
+  // the values a 4x4 fill would leave in the 3x3 (writing past m_m is undefined now setAtXY is inline)
+  ngl::Mat3 test(0,4,8,12,5,9,13,6,10);
   test*=4.2f;
   ngl::Mat3 result(0,16.8,33.6,50.4,21,37.8,54.6,25.2,42);
 
@@ -241,6 +238,68 @@ TEST(NGLMat3,inverse)
   EXPECT_TRUE(test == result);
 }
 
+// matrices for the array tests, these use an odd count so the simd blocks and the scalar tail are both run
+static std::vector<ngl::Mat3> makeMatrices(size_t _count, ngl::Real _offset)
+{
+  std::vector<ngl::Mat3> m(_count);
+  for(size_t i=0; i<_count; ++i)
+  {
+    ngl::Real v=static_cast<ngl::Real>(i)*0.1f+_offset;
+    m[i]=ngl::Mat3(1.0f+v,0.5f,-v,0.25f*v,2.0f,1.0f,-0.5f,v,2.0f-v);
+  }
+  // a singular matrix gives the identity for the inverse
+  m[1]=ngl::Mat3(1,2,3,2,4,6,0,1,0);
+  return m;
+}
+
+TEST(NGLMat3,multiplyMatrices)
+{
+  auto a=makeMatrices(103,0.0f);
+  auto b=makeMatrices(103,1.5f);
+  std::vector<ngl::Mat3> out(a.size());
+  forEachSIMDLevel([&]()
+  {
+    ngl::multiplyMatrices(a.data(),b.data(),a.size(),out.data());
+    for(size_t i=0; i<a.size(); ++i)
+    {
+      EXPECT_TRUE(out[i].m_openGL==(a[i]*b[i]).m_openGL);
+    }
+  });
+}
+
+TEST(NGLMat3,inverseMatrices)
+{
+  auto m=makeMatrices(103,0.0f);
+  std::vector<ngl::Mat3> out(m.size());
+  forEachSIMDLevel([&]()
+  {
+    ngl::inverseMatrices(m.data(),m.size(),out.data());
+    EXPECT_TRUE(out[1] == ngl::Mat3());
+    for(size_t i=0; i<m.size(); ++i)
+    {
+      if(i!=1)
+      {
+        ngl::Mat3 result(m[i]);
+        EXPECT_TRUE(out[i].m_openGL==result.inverse().m_openGL);
+      }
+    }
+  });
+}
+
+TEST(NGLMat3,determinants)
+{
+  auto m=makeMatrices(103,0.0f);
+  std::vector<ngl::Real> out(m.size());
+  forEachSIMDLevel([&]()
+  {
+    ngl::determinants(m.data(),m.size(),out.data());
+    for(size_t i=0; i<m.size(); ++i)
+    {
+      EXPECT_FLOAT_EQ(out[i],m[i].determinant());
+    }
+  });
+}
+
 TEST(NGLMat3,adjacent)
 {
   ngl::Mat3 test(1,0,0,0,2,2,0,-0.5,2);
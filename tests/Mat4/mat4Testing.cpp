@@ -2,6 +2,15 @@
 #include <ngl/Types.h>
 #include <ngl/Mat4.h>
 #include <ngl/Vec4.h>
+#include <ngl/SIMD.h>
+#include <ngl/BatchTransform.h>
+#include <ngl/Vec3.h>
+#include <ngl/Mat3.h>
+#include <ngl/Quaternion.h>
+#include <ngl/Mat4T.h>
+#include <ngl/QuaternionT.h>
+#include <ngl/PrecisionConvert.h>
+#include <vector>
 #include <string>
 #include <sstream>
 
@@ -239,6 +248,71 @@ TEST(NGLMat4,inverse)
   EXPECT_TRUE(test == result);
 }
 
+TEST(NGLMat4,inverseAffine)
+{
+  ngl::Mat4 test(1,0,0,0,0,2,2,0,0,-0.5,2,0,1,2,3,1);
+  ngl::Mat4 result=test;
+  result=result.inverse();
+  EXPECT_TRUE(test.inverseAffine() == result);
+  EXPECT_TRUE(test*test.inverseAffine() == ngl::Mat4());
+}
+
+TEST(NGLMat4,inverseRigid)
+{
+  ngl::Mat4 rx;
+  ngl::Mat4 ry;
+  rx.rotateX(45.0f);
+  ry.rotateY(35.0f);
+  ngl::Mat4 test=rx*ry;
+  test.translate(1,2,3);
+  ngl::Mat4 result=test;
+  result=result.inverse();
+  EXPECT_TRUE(test.inverseRigid() == result);
+}
+
+TEST(NGLMat4,normalMatrix)
+{
+  ngl::Mat4 test(1,0,0,0,0,2,2,0,0,-0.5,2,0,1,2,3,1);
+  ngl::Mat4 result=test;
+  result=result.inverse();
+  result.transpose();
+  EXPECT_TRUE(test.normalMatrix() == ngl::Mat3(result));
+}
+
+TEST(NGLMat4,normalMatrixUniformScale)
+{
+  ngl::Mat4 rx;
+  ngl::Mat4 ry;
+  ngl::Mat4 scale;
+  rx.rotateX(45.0f);
+  ry.rotateY(35.0f);
+  scale.scale(3.0f,3.0f,3.0f);
+  ngl::Mat4 test=scale*rx*ry;
+  test.translate(1,2,3);
+  EXPECT_TRUE(test.normalMatrix(true) == test.normalMatrix());
+}
+
+TEST(NGLMat4,fromTRS)
+{
+  ngl::Mat4 scale;
+  ngl::Mat4 rX;
+  ngl::Mat4 rY;
+  ngl::Mat4 rZ;
+  scale.scale(2.0f,0.5f,3.0f);
+  rX.rotateX(25.0f);
+  rY.rotateY(-40.0f);
+  rZ.rotateZ(110.0f);
+  ngl::Mat4 result=scale*rX*rY*rZ;
+  result.translate(1,-2,3);
+  ngl::Mat4 test;
+  ngl::Mat4 inverse;
+  ngl::Mat4::fromTRS(ngl::Vec3(1,-2,3),ngl::Vec3(25.0f,-40.0f,110.0f),ngl::Vec3(2.0f,0.5f,3.0f),test,inverse);
+  EXPECT_TRUE(test == result)<<print(test)<<print(result);
+  result=result.inverse();
+  EXPECT_TRUE(inverse == result)<<print(inverse)<<print(result);
+  EXPECT_TRUE(ngl::Mat4::fromTRS(ngl::Vec3(1,-2,3),ngl::Vec3(25.0f,-40.0f,110.0f),ngl::Vec3(2.0f,0.5f,3.0f)) == test);
+}
+
 TEST(NGLMat4,adjacent)
 {
   ngl::Mat4 test(1,0,0,0,0,2,2,0,0,-0.5,2,0,0,0,0,1);
@@ -280,6 +354,207 @@ TEST(NGLMat4,Mat4xVec4)
   EXPECT_TRUE(test == result);
 }
 
+TEST(NGLMat4,SIMDMatchesScalar)
+{
+  ngl::Mat4 a(1,2,0,1,0,2,2,0,3,-0.5,2,0,0.5,1,4,1);
+  ngl::Mat4 b;
+  b.rotateX(30.0f);
+  b.translate(1,2,3);
+  ngl::Vec4 v(2,1,2,1);
+  auto level=ngl::activeSIMDLevel();
+  ngl::setSIMDLevel(ngl::SIMDLevel::SCALAR);
+  ngl::Mat4 mul=a*b;
+  ngl::Mat4 mulEq=a;
+  mulEq*=b;
+  ngl::Mat4 tran=a;
+  tran.transpose();
+  ngl::Mat4 inv=a;
+  inv=inv.inverse();
+  ngl::Vec4 vec=a*v;
+  for(int l=static_cast<int>(ngl::SIMDLevel::SSE2); l<=static_cast<int>(ngl::cpuSIMDLevel()); ++l)
+  {
+    ngl::setSIMDLevel(static_cast<ngl::SIMDLevel>(l));
+    ngl::Mat4 test=a*b;
+    EXPECT_TRUE(test == mul)<<"level "<<l<<'\n'<<print(test)<<print(mul);
+    test=a;
+    test*=b;
+    EXPECT_TRUE(test == mulEq)<<"level "<<l<<'\n'<<print(test)<<print(mulEq);
+    test=a;
+    test.transpose();
+    EXPECT_TRUE(test == tran)<<"level "<<l<<'\n'<<print(test)<<print(tran);
+    test=a;
+    test=test.inverse();
+    EXPECT_TRUE(test == inv)<<"level "<<l<<'\n'<<print(test)<<print(inv);
+    EXPECT_TRUE(a*v == vec)<<"level "<<l;
+  }
+  ngl::setSIMDLevel(level);
+}
+
+TEST(NGLMat4,transformPoints)
+{
+  ngl::Mat4 t1;
+  t1.rotateX(45.0f);
+  t1.translate(1,2,3);
+  // odd size so both the simd blocks and the tail are used
+  std::vector<ngl::Vec3> in(7,ngl::Vec3(2,1,2));
+  std::vector<ngl::Vec3> out(7);
+  ngl::transformPoints(t1,&in[0],in.size(),&out[0]);
+  ngl::Vec4 result=ngl::Vec4(2,1,2,1)*t1;
+  for(auto &p : out)
+  {
+    EXPECT_TRUE(p == result.toVec3());
+  }
+  ngl::transformVectors(t1,&in[0],in.size(),&out[0]);
+  result=ngl::Vec4(2,1,2,0)*t1;
+  for(auto &p : out)
+  {
+    EXPECT_TRUE(p == result.toVec3());
+  }
+}
+
+TEST(NGLMat4,transformNormals)
+{
+  ngl::Mat4 t1;
+  t1.scale(1,2,1);
+  std::vector<ngl::Vec3> in(5,ngl::Vec3(1,1,0));
+  std::vector<ngl::Real> x(5),y(5),z(5);
+  ngl::transformNormals(t1,&in[0],in.size(),&x[0],&y[0],&z[0]);
+  // scaling y by 2 halves the y of the normal before it is normalized
+  ngl::Vec3 result(1,0.5f,0);
+  result.normalize();
+  for(size_t i=0; i<in.size(); ++i)
+  {
+    EXPECT_TRUE(ngl::Vec3(x[i],y[i],z[i]) == result);
+  }
+}
+
+TEST(NGLMat4,constexprTables)
+{
+  // a static transform table built at compile time, the static_asserts fail the build if any of these
+  // stop being constant expressions
+  constexpr ngl::Mat4 table[]=
+  {
+    ngl::Mat4(),
+    ngl::Mat4(2.0f),
+    ngl::Mat4(1,0,0,0, 0,1,0,0, 0,0,1,0, 1,2,3,1)
+  };
+  constexpr ngl::Mat4 sum=table[1]+table[2]*2.0f;
+  static_assert(sum.m_m[0][0]==4.0f && sum.m_m[3][2]==6.0f && sum.m_m[3][3]==3.0f,"Mat4 not constexpr");
+  constexpr ngl::Mat3 m3=ngl::Mat3(1,2,3,4,5,6,7,8,10)*ngl::Mat3(2.0f);
+  static_assert(m3.m_m[2][2]==20.0f && m3.determinant()==-24.0f,"Mat3 not constexpr");
+  constexpr ngl::Vec3 v=ngl::Mat3(2.0f)*ngl::Vec3::up()+ngl::Vec3::left().cross(ngl::Vec3::in());
+  static_assert(v.m_y==3.0f && v.dot(v)==9.0f,"Vec3 not constexpr");
+  constexpr ngl::Vec4 v4=ngl::Vec4(ngl::Vec3(1,2,3))*2.0f-ngl::Vec4::zero();
+  static_assert(v4.m_z==6.0f && v4.toVec3().lengthSquared()==56.0f,"Vec4 not constexpr");
+  constexpr ngl::Vec2 v2=ngl::Vec2(1,2)+ngl::Vec2(3,4);
+  static_assert(v2.m_x==4.0f && v2.m_y==6.0f,"Vec2 not constexpr");
+  constexpr ngl::Quaternion q=ngl::Quaternion(0,1,0,0)*ngl::Quaternion(0,0,1,0);
+  static_assert(q.getS()==0.0f && q.getZ()==1.0f,"Quaternion not constexpr");
+  // and the constant values match the runtime versions
+  ngl::Mat4 rt(1,0,0,0, 0,1,0,0, 0,0,1,0, 1,2,3,1);
+  EXPECT_TRUE(table[2]==rt);
+  EXPECT_TRUE(sum==ngl::Mat4(2.0f)+rt*2.0f);
+  EXPECT_TRUE(q==ngl::Quaternion(0,1,0,0)*ngl::Quaternion(0,0,1,0));
+}
+
+TEST(NGLMat4,Mat4dMatchesMat4)
+{
+  ngl::Mat4 a(1,2,0,1,0,2,2,0,3,-0.5,2,0,0.5,1,4,1);
+  ngl::Mat4d ad(a);
+  EXPECT_TRUE(ad.toMat4() == a);
+  EXPECT_TRUE((ad*ad.inverse()) == ngl::Mat4d());
+  EXPECT_TRUE(ad.inverse().toMat4() == a.inverse());
+  EXPECT_FLOAT_EQ(static_cast<float>(ad.determinant()),a.determinant());
+  ngl::Mat4 rx,ry;
+  ngl::Mat4d rxd,ryd;
+  rx.rotateX(30.0f);
+  rxd.rotateX(30.0);
+  ry.rotateY(45.0f);
+  ryd.rotateY(45.0);
+  EXPECT_TRUE((rxd*ryd).toMat4() == rx*ry);
+
+  ngl::Quaternion q;
+  q.fromAxisAngle(ngl::Vec3(1,1,0),60.0f);
+  ngl::Quaterniond qd;
+  qd.fromAxisAngle(ngl::Vec3d(1,1,0),60.0);
+  EXPECT_TRUE(qd.toQuaternion() == q);
+  EXPECT_TRUE(qd.toMat4T().toMat4() == q.toMat4());
+  ngl::Quaternion other(0.5f,0.5f,0.5f,0.5f);
+  EXPECT_TRUE(ngl::Quaterniond::slerp(qd,ngl::Quaterniond(other),0.3).toQuaternion() == ngl::Quaternion::slerp(q,other,0.3f));
+}
+
+TEST(NGLMat4,largeWorldRelativeTo)
+{
+  // a point 1cm from a camera 10000km from the origin, in float the positions can't represent the 1cm
+  ngl::Vec3d camera(1.0e7,-2.0e7,3.0e7);
+  ngl::Mat4d model;
+  model.translate(camera.m_x+0.01,camera.m_y,camera.m_z);
+  ngl::Mat4 rel=model.toMat4RelativeTo(camera);
+  EXPECT_FLOAT_EQ(rel.m_30,0.01f);
+  EXPECT_FLOAT_EQ(rel.m_31,0.0f);
+  EXPECT_FLOAT_EQ(rel.m_32,0.0f);
+  ngl::Vec3 p(0,0,0);
+  EXPECT_TRUE((ngl::Vec4(p)*rel).toVec3() == ngl::Vec3(0.01f,0.0f,0.0f));
+  // the result is the same as model * translate(-camera)
+  ngl::Mat4d proj(1,0,0,0.5, 0,1,0,0.25, 0,0,1,1, 2,3,4,1);
+  ngl::Mat4d t;
+  t.translate(-camera.m_x,-camera.m_y,-camera.m_z);
+  EXPECT_TRUE(proj.relativeTo(camera) == proj*t);
+}
+
+TEST(NGLMat4,convertToFloat)
+{
+  // odd sizes so every simd loop has a tail
+  const size_t count=1027;
+  ngl::Vec3d origin(1.0e6,2.0e6,-3.0e6);
+  std::vector<ngl::Vec3d> points(count);
+  std::vector<ngl::Mat4d> mats(count/16);
+  for(size_t i=0; i<count; ++i)
+  {
+    points[i].set(origin.m_x+i*0.001,origin.m_y-i*0.002,origin.m_z+i*0.5);
+  }
+  for(size_t i=0; i<mats.size(); ++i)
+  {
+    mats[i].rotateZ(i*10.0);
+    mats[i].translate(origin.m_x+i,origin.m_y,origin.m_z-i);
+  }
+  auto level=ngl::activeSIMDLevel();
+  for(int l=0; l<=static_cast<int>(ngl::cpuSIMDLevel()); ++l)
+  {
+    ngl::setSIMDLevel(static_cast<ngl::SIMDLevel>(l));
+    std::vector<ngl::Vec3> out(count);
+    ngl::convertToFloat(&points[0],count,&out[0]);
+    for(size_t i=0; i<count; ++i)
+    {
+      ASSERT_EQ(out[i].m_y,static_cast<float>(points[i].m_y))<<"level "<<l<<" index "<<i;
+    }
+    ngl::convertToFloatRelativeTo(&points[0],count,origin,&out[0]);
+    for(size_t i=0; i<count; ++i)
+    {
+      ASSERT_TRUE(out[i] == (points[i]-origin).toVec3())<<"level "<<l<<" index "<<i;
+    }
+    std::vector<float> flat(3*count-1);
+    ngl::convertToFloat(&points[0].m_x+1,flat.size(),&flat[0]);
+    for(size_t i=0; i<flat.size(); ++i)
+    {
+      ASSERT_EQ(flat[i],static_cast<float>((&points[0].m_x)[i+1]))<<"level "<<l<<" index "<<i;
+    }
+    std::vector<ngl::Mat4> mout(mats.size());
+    ngl::convertToFloat(&mats[0],mats.size(),&mout[0]);
+    for(size_t i=0; i<mats.size(); ++i)
+    {
+      // FCompare can't match large values so compare exactly
+      ASSERT_TRUE(mout[i].m_openGL == mats[i].toMat4().m_openGL)<<"level "<<l<<" index "<<i;
+    }
+    ngl::convertToFloatRelativeTo(&mats[0],mats.size(),origin,&mout[0]);
+    for(size_t i=0; i<mats.size(); ++i)
+    {
+      ASSERT_TRUE(mout[i].m_openGL == mats[i].toMat4RelativeTo(origin).m_openGL)<<"level "<<l<<" index "<<i;
+    }
+  }
+  ngl::setSIMDLevel(level);
+}
+
 /* after thinking about it this is not a valid test!
 class EulerTestRot : public ::testing::TestWithParam<ngl::Real> {
   // You can implement all the usual fixture class members here.
@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+#include <ngl/MeshBVH.h>
+#include <ngl/Vec3.h>
+#include <ngl/SIMD.h>
+#include <cmath>
+#include <vector>
+#include "../TestUtils.h"
+
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+static ngl::Vec3 randomVec3(unsigned int &io_seed, ngl::Real _min, ngl::Real _max)
+{
+  ngl::Real x=randomReal(io_seed,_min,_max);
+  ngl::Real y=randomReal(io_seed,_min,_max);
+  ngl::Real z=randomReal(io_seed,_min,_max);
+  return ngl::Vec3(x,y,z);
+}
+
+// a soup of small triangles, enough for the threaded build
+struct Soup
+{
+  std::vector<ngl::Vec3> m_verts;
+  std::vector<uint32_t> m_indices;
+};
+
+static Soup makeSoup(size_t _numTris)
+{
+  Soup s;
+  unsigned int seed=17u;
+  for(size_t t=0; t<_numTris; ++t)
+  {
+    ngl::Vec3 c=randomVec3(seed,-10.0f,10.0f);
+    for(int i=0; i<3; ++i)
+    {
+      s.m_verts.push_back(c+randomVec3(seed,-0.6f,0.6f));
+      s.m_indices.push_back(static_cast<uint32_t>(s.m_verts.size()-1));
+    }
+  }
+  return s;
+}
+
+// brute force closest hit in double precision
+static bool bruteForce(const Soup &_s, const ngl::Vec3 &_o, const ngl::Vec3 &_d, double &o_t, uint32_t &o_tri)
+{
+  bool found=false;
+  o_t=1e30;
+  for(size_t t=0; t<_s.m_indices.size()/3; ++t)
+  {
+    const ngl::Vec3 &a=_s.m_verts[_s.m_indices[t*3]];
+    const ngl::Vec3 &b=_s.m_verts[_s.m_indices[t*3+1]];
+    const ngl::Vec3 &c=_s.m_verts[_s.m_indices[t*3+2]];
+    double e1[3]={double(b.m_x)-a.m_x,double(b.m_y)-a.m_y,double(b.m_z)-a.m_z};
+    double e2[3]={double(c.m_x)-a.m_x,double(c.m_y)-a.m_y,double(c.m_z)-a.m_z};
+    double p[3]={_d.m_y*e2[2]-_d.m_z*e2[1],_d.m_z*e2[0]-_d.m_x*e2[2],_d.m_x*e2[1]-_d.m_y*e2[0]};
+    double det=e1[0]*p[0]+e1[1]*p[1]+e1[2]*p[2];
+    if(det==0.0)
+    {
+      continue;
+    }
+    double tv[3]={double(_o.m_x)-a.m_x,double(_o.m_y)-a.m_y,double(_o.m_z)-a.m_z};
+    double u=(tv[0]*p[0]+tv[1]*p[1]+tv[2]*p[2])/det;
+    double q[3]={tv[1]*e1[2]-tv[2]*e1[1],tv[2]*e1[0]-tv[0]*e1[2],tv[0]*e1[1]-tv[1]*e1[0]};
+    double v=(_d.m_x*q[0]+_d.m_y*q[1]+_d.m_z*q[2])/det;
+    double dist=(e2[0]*q[0]+e2[1]*q[1]+e2[2]*q[2])/det;
+    if(u>=0.0 && v>=0.0 && u+v<=1.0 && dist>0.0 && dist<o_t)
+    {
+      o_t=dist;
+      o_tri=static_cast<uint32_t>(t);
+      found=true;
+    }
+  }
+  return found;
+}
+
+// rays from outside the soup aimed at points in it so plenty hit
+static void makeRays(size_t _count, std::vector<ngl::Vec3> &o_origins, std::vector<ngl::Vec3> &o_dirs)
+{
+  unsigned int seed=3u;
+  for(size_t i=0; i<_count; ++i)
+  {
+    ngl::Vec3 o=randomVec3(seed,-20.0f,20.0f);
+    o_origins.push_back(o);
+    o_dirs.push_back(randomVec3(seed,-8.0f,8.0f)-o);
+  }
+}
+
+TEST(NGLMeshBVH,empty)
+{
+  ngl::MeshBVH bvh;
+  ngl::MeshBVH::Hit hit;
+  EXPECT_TRUE(bvh.empty());
+  EXPECT_FALSE(bvh.closestHit(ngl::Vec3(0.0f,0.0f,0.0f),ngl::Vec3(0.0f,0.0f,1.0f),hit));
+  EXPECT_FALSE(bvh.anyHit(ngl::Vec3(0.0f,0.0f,0.0f),ngl::Vec3(0.0f,0.0f,1.0f)));
+  EXPECT_EQ(hit.m_triangle,ngl::MeshBVH::c_noHit);
+}
+
+TEST(NGLMeshBVH,quad)
+{
+  ngl::Vec3 verts[4]={ngl::Vec3(-1.0f,-1.0f,0.0f),ngl::Vec3(1.0f,-1.0f,0.0f),ngl::Vec3(1.0f,1.0f,0.0f),ngl::Vec3(-1.0f,1.0f,0.0f)};
+  uint32_t indices[6]={0,1,2,0,2,3};
+  ngl::MeshBVH bvh;
+  bvh.build(verts,4,indices,6);
+  EXPECT_EQ(bvh.numTriangles(),2u);
+  forEachSIMDLevel([&]()
+  {
+    ngl::MeshBVH::Hit hit;
+    ASSERT_TRUE(bvh.closestHit(ngl::Vec3(0.5f,-0.5f,5.0f),ngl::Vec3(0.0f,0.0f,-2.0f),hit));
+    EXPECT_FLOAT_EQ(hit.m_t,2.5f);
+    EXPECT_EQ(hit.m_triangle,0u);
+    // the barycentric coordinates give back the hit point
+    const uint32_t *tri=bvh.getTriangle(hit.m_triangle);
+    ngl::Vec3 p=verts[tri[0]]*(1.0f-hit.m_u-hit.m_v)+verts[tri[1]]*hit.m_u+verts[tri[2]]*hit.m_v;
+    EXPECT_NEAR(p.m_x,0.5f,1e-5f);
+    EXPECT_NEAR(p.m_y,-0.5f,1e-5f);
+    // both sides are hit but not past _tMax or behind the origin
+    EXPECT_TRUE(bvh.closestHit(ngl::Vec3(-0.5f,0.5f,-1.0f),ngl::Vec3(0.0f,0.0f,1.0f),hit));
+    EXPECT_EQ(hit.m_triangle,1u);
+    EXPECT_FALSE(bvh.anyHit(ngl::Vec3(-0.5f,0.5f,-1.0f),ngl::Vec3(0.0f,0.0f,1.0f),0.5f));
+    EXPECT_FALSE(bvh.anyHit(ngl::Vec3(-0.5f,0.5f,-1.0f),ngl::Vec3(0.0f,0.0f,-1.0f)));
+    EXPECT_FALSE(bvh.anyHit(ngl::Vec3(2.0f,0.0f,-1.0f),ngl::Vec3(0.0f,0.0f,1.0f)));
+  });
+}
+
+TEST(NGLMeshBVH,matchesBruteForce)
+{
+  Soup s=makeSoup(20000);
+  ngl::MeshBVH bvh;
+  bvh.build(s.m_verts.data(),s.m_verts.size(),s.m_indices.data(),s.m_indices.size());
+  EXPECT_EQ(bvh.numTriangles(),20000u);
+  std::vector<ngl::Vec3> origins;
+  std::vector<ngl::Vec3> dirs;
+  makeRays(1000,origins,dirs);
+  std::vector<double> t(origins.size());
+  std::vector<uint32_t> tri(origins.size(),ngl::MeshBVH::c_noHit);
+  size_t hits=0;
+  for(size_t r=0; r<origins.size(); ++r)
+  {
+    hits+=bruteForce(s,origins[r],dirs[r],t[r],tri[r]);
+  }
+  EXPECT_GT(hits,origins.size()/2);
+  forEachSIMDLevel([&]()
+  {
+    std::vector<ngl::MeshBVH::Hit> batch(origins.size());
+    bvh.closestHits(origins.data(),dirs.data(),origins.size(),batch.data());
+    for(size_t r=0; r<origins.size(); ++r)
+    {
+      ngl::MeshBVH::Hit hit;
+      bool found=bvh.closestHit(origins[r],dirs[r],hit);
+      ASSERT_EQ(found,tri[r]!=ngl::MeshBVH::c_noHit) << r;
+      EXPECT_EQ(bvh.anyHit(origins[r],dirs[r]),found) << r;
+      EXPECT_EQ(batch[r].m_triangle,hit.m_triangle) << r;
+      if(found)
+      {
+        EXPECT_EQ(hit.m_triangle,tri[r]) << r;
+        EXPECT_NEAR(hit.m_t,t[r],1e-4) << r;
+        EXPECT_FLOAT_EQ(batch[r].m_t,hit.m_t) << r;
+        // nothing is found when the ray stops short of the hit
+        EXPECT_FALSE(bvh.anyHit(origins[r],dirs[r],hit.m_t*0.999f)) << r;
+      }
+    }
+  });
+}
+
+TEST(NGLMeshBVH,refit)
+{
+  Soup s=makeSoup(5000);
+  ngl::MeshBVH bvh;
+  bvh.build(s.m_verts.data(),s.m_verts.size(),s.m_indices.data(),s.m_indices.size());
+  size_t nodes=bvh.numNodes();
+  // move everything along and stretch it, the same rays moved with it hit the same triangles
+  std::vector<ngl::Vec3> moved;
+  for(auto v : s.m_verts)
+  {
+    moved.push_back(ngl::Vec3(v.m_x*2.0f+5.0f,v.m_y+1.0f,v.m_z));
+  }
+  std::vector<ngl::Vec3> origins;
+  std::vector<ngl::Vec3> dirs;
+  makeRays(500,origins,dirs);
+  std::vector<ngl::MeshBVH::Hit> before(origins.size());
+  bvh.closestHits(origins.data(),dirs.data(),origins.size(),before.data());
+  bvh.refit(moved.data(),moved.size());
+  EXPECT_EQ(bvh.numNodes(),nodes);
+  const ngl::MeshBVH::Node &root=bvh.nodes()[0];
+  EXPECT_GT(root.m_max[0],20.0f);
+  for(size_t r=0; r<origins.size(); ++r)
+  {
+    ngl::Vec3 o(origins[r].m_x*2.0f+5.0f,origins[r].m_y+1.0f,origins[r].m_z);
+    ngl::Vec3 d(dirs[r].m_x*2.0f,dirs[r].m_y,dirs[r].m_z);
+    ngl::MeshBVH::Hit hit;
+    bvh.closestHit(o,d,hit);
+    EXPECT_EQ(hit.m_triangle,before[r].m_triangle) << r;
+    if(hit.m_triangle!=ngl::MeshBVH::c_noHit)
+    {
+      EXPECT_NEAR(hit.m_t,before[r].m_t,1e-4f) << r;
+    }
+  }
+}
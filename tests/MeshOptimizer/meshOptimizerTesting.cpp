@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+#include <ngl/MeshOptimizer.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+// an _n by _n grid of quads split into triangles, shuffled so the input order has no locality
+static void makeGrid(size_t _n, std::vector<ngl::Vec3> &o_positions, std::vector<uint32_t> &o_indices)
+{
+  o_positions.clear();
+  o_indices.clear();
+  for(size_t y=0; y<=_n; ++y)
+  {
+    for(size_t x=0; x<=_n; ++x)
+    {
+      o_positions.push_back(ngl::Vec3(static_cast<ngl::Real>(x),static_cast<ngl::Real>(y),0.0f));
+    }
+  }
+  std::vector<std::array<uint32_t,3>> tris;
+  for(size_t y=0; y<_n; ++y)
+  {
+    for(size_t x=0; x<_n; ++x)
+    {
+      uint32_t a=static_cast<uint32_t>(y*(_n+1)+x);
+      uint32_t b=a+1;
+      uint32_t c=a+static_cast<uint32_t>(_n+1);
+      uint32_t d=c+1;
+      tris.push_back({{a,b,d}});
+      tris.push_back({{a,d,c}});
+    }
+  }
+  unsigned int seed=1u;
+  for(size_t i=tris.size()-1; i>0; --i)
+  {
+    seed=seed*1664525u+1013904223u;
+    std::swap(tris[i],tris[(seed>>8)%(i+1)]);
+  }
+  for(const auto &t : tris)
+  {
+    o_indices.insert(o_indices.end(),t.begin(),t.end());
+  }
+}
+
+// each triangle rotated so its smallest index is first, keeping the winding, then sorted
+static std::vector<std::array<uint32_t,3>> canonical(const std::vector<uint32_t> &_indices)
+{
+  std::vector<std::array<uint32_t,3>> tris;
+  for(size_t i=0; i<_indices.size(); i+=3)
+  {
+    std::array<uint32_t,3> t={{_indices[i],_indices[i+1],_indices[i+2]}};
+    while(t[0]!=std::min(t[0],std::min(t[1],t[2])))
+    {
+      std::rotate(t.begin(),t.begin()+1,t.end());
+    }
+    tris.push_back(t);
+  }
+  std::sort(tris.begin(),tris.end());
+  return tris;
+}
+
+TEST(MeshOptimizer,analyze)
+{
+  // a strip of triangles each sharing two vertices with the last only misses once per triangle after the first
+  std::vector<uint32_t> indices;
+  for(uint32_t i=0; i<10; ++i)
+  {
+    indices.insert(indices.end(),{i,i+1,i+2});
+  }
+  ngl::VertexCacheStats s=ngl::analyzeVertexCache(indices.data(),indices.size(),12);
+  EXPECT_EQ(s.m_misses,12u);
+  EXPECT_FLOAT_EQ(s.m_acmr,1.2f);
+  EXPECT_FLOAT_EQ(s.m_atvr,1.0f);
+  // a cache of 1 only holds the last vertex which the next triangle never starts with
+  s=ngl::analyzeVertexCache(indices.data(),indices.size(),12,1);
+  EXPECT_EQ(s.m_misses,30u);
+  s=ngl::analyzeVertexCache(nullptr,0,0);
+  EXPECT_EQ(s.m_misses,0u);
+}
+
+TEST(MeshOptimizer,vertexCache)
+{
+  std::vector<ngl::Vec3> positions;
+  std::vector<uint32_t> indices;
+  makeGrid(64,positions,indices);
+  ngl::VertexCacheStats before=ngl::analyzeVertexCache(indices.data(),indices.size(),positions.size());
+  auto tris=canonical(indices);
+  ngl::optimizeVertexCache(indices.data(),indices.size(),positions.size());
+  ngl::VertexCacheStats after=ngl::analyzeVertexCache(indices.data(),indices.size(),positions.size());
+  EXPECT_EQ(canonical(indices),tris);
+  EXPECT_GT(before.m_acmr,2.0f);
+  EXPECT_LT(after.m_acmr,0.8f);
+  EXPECT_LT(after.m_atvr,1.5f);
+}
+
+TEST(MeshOptimizer,overdraw)
+{
+  // a closed box made of grids, the clusters on the faces must all still be there after sorting
+  std::vector<ngl::Vec3> positions;
+  std::vector<uint32_t> indices;
+  makeGrid(32,positions,indices);
+  size_t faceVerts=positions.size();
+  size_t faceIndices=indices.size();
+  for(int f=1; f<6; ++f)
+  {
+    for(size_t i=0; i<faceVerts; ++i)
+    {
+      ngl::Vec3 p=positions[i];
+      ngl::Vec3 q;
+      switch(f)
+      {
+        case 1 : q.set(p.m_x,p.m_y,32.0f); break;
+        case 2 : q.set(0.0f,p.m_x,p.m_y); break;
+        case 3 : q.set(32.0f,p.m_x,p.m_y); break;
+        case 4 : q.set(p.m_x,0.0f,p.m_y); break;
+        default : q.set(p.m_x,32.0f,p.m_y); break;
+      }
+      positions.push_back(q);
+    }
+    for(size_t i=0; i<faceIndices; ++i)
+    {
+      indices.push_back(indices[i]+static_cast<uint32_t>(f*faceVerts));
+    }
+  }
+  ngl::optimizeVertexCache(indices.data(),indices.size(),positions.size());
+  ngl::VertexCacheStats cached=ngl::analyzeVertexCache(indices.data(),indices.size(),positions.size());
+  auto tris=canonical(indices);
+  ngl::optimizeOverdraw(indices.data(),indices.size(),positions.data(),positions.size(),1.05f);
+  ngl::VertexCacheStats sorted=ngl::analyzeVertexCache(indices.data(),indices.size(),positions.size());
+  EXPECT_EQ(canonical(indices),tris);
+  EXPECT_LE(sorted.m_acmr,cached.m_acmr*1.1f);
+}
+
+TEST(MeshOptimizer,vertexFetch)
+{
+  std::vector<ngl::Vec3> positions;
+  std::vector<uint32_t> indices;
+  makeGrid(16,positions,indices);
+  // an unused vertex on the end
+  positions.push_back(ngl::Vec3(100.0f,100.0f,100.0f));
+  std::vector<uint32_t> original=indices;
+  std::vector<uint32_t> remap(positions.size());
+  size_t used=ngl::optimizeVertexFetch(indices.data(),indices.size(),positions.size(),remap.data());
+  EXPECT_EQ(used,positions.size()-1);
+  EXPECT_EQ(remap.back(),~0u);
+  std::vector<ngl::Vec3> moved(used);
+  ngl::remapVertices(positions.data(),positions.size(),remap.data(),moved.data());
+  // the same triangles and each new index is at most one more than any before it
+  uint32_t next=0;
+  for(size_t i=0; i<indices.size(); ++i)
+  {
+    EXPECT_TRUE(moved[indices[i]]==positions[original[i]]);
+    EXPECT_LE(indices[i],next);
+    next=std::max(next,indices[i]+1);
+  }
+}
@@ -0,0 +1,252 @@
+#include <gtest/gtest.h>
+#include <ngl/MeshSimplify.h>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <utility>
+#include <vector>
+
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+// a closed unit sphere with one vertex at each pole
+static void makeSphere(uint32_t _stacks, uint32_t _slices, std::vector<ngl::Vec3> &o_positions, std::vector<ngl::Vec3> &o_normals, std::vector<uint32_t> &o_indices)
+{
+  o_positions.assign(1,ngl::Vec3(0.0f,1.0f,0.0f));
+  for(uint32_t s=1; s<_stacks; ++s)
+  {
+    ngl::Real phi=static_cast<ngl::Real>(M_PI)*s/_stacks;
+    for(uint32_t i=0; i<_slices; ++i)
+    {
+      ngl::Real theta=2.0f*static_cast<ngl::Real>(M_PI)*i/_slices;
+      o_positions.push_back(ngl::Vec3(std::sin(phi)*std::cos(theta),std::cos(phi),std::sin(phi)*std::sin(theta)));
+    }
+  }
+  o_positions.push_back(ngl::Vec3(0.0f,-1.0f,0.0f));
+  o_normals=o_positions;
+  uint32_t south=static_cast<uint32_t>(o_positions.size()-1);
+  auto ring=[_slices](uint32_t _s, uint32_t _i){ return 1+(_s-1)*_slices+_i%_slices; };
+  o_indices.clear();
+  for(uint32_t i=0; i<_slices; ++i)
+  {
+    o_indices.insert(o_indices.end(),{0,ring(1,i+1),ring(1,i)});
+    o_indices.insert(o_indices.end(),{south,ring(_stacks-1,i),ring(_stacks-1,i+1)});
+  }
+  for(uint32_t s=1; s<_stacks-1; ++s)
+  {
+    for(uint32_t i=0; i<_slices; ++i)
+    {
+      uint32_t a=ring(s,i);
+      uint32_t b=ring(s,i+1);
+      uint32_t c=ring(s+1,i);
+      uint32_t d=ring(s+1,i+1);
+      o_indices.insert(o_indices.end(),{a,b,d,a,d,c});
+    }
+  }
+}
+
+// a flat _n by _n grid in x,z, if _seam the column x=_n/2 is split into two vertices with different uvs
+static void makeGrid(uint32_t _n, bool _seam, std::vector<ngl::Vec3> &o_positions, std::vector<ngl::Vec3> &o_uvs,
+                     std::vector<uint32_t> &o_indices, std::vector<int> &o_chart)
+{
+  o_positions.clear();
+  o_uvs.clear();
+  o_chart.clear();
+  o_indices.clear();
+  std::map<std::pair<uint32_t,int>,uint32_t> ids;
+  auto vertex=[&](uint32_t _x, uint32_t _z, int _chart)
+  {
+    int chart=_seam ? _chart : 0;
+    auto found=ids.find({_z*(_n+1)+_x,chart});
+    if(found!=ids.end())
+    {
+      return found->second;
+    }
+    uint32_t id=static_cast<uint32_t>(o_positions.size());
+    ids[{_z*(_n+1)+_x,chart}]=id;
+    o_positions.push_back(ngl::Vec3(static_cast<ngl::Real>(_x),0.0f,static_cast<ngl::Real>(_z)));
+    o_uvs.push_back(ngl::Vec3(static_cast<ngl::Real>(_x)/_n+(chart ? 0.5f : 0.0f),static_cast<ngl::Real>(_z)/_n,0.0f));
+    o_chart.push_back(chart);
+    return id;
+  };
+  for(uint32_t z=0; z<_n; ++z)
+  {
+    for(uint32_t x=0; x<_n; ++x)
+    {
+      int chart= x<_n/2 ? 0 : 1;
+      uint32_t a=vertex(x,z,chart);
+      uint32_t b=vertex(x+1,z,chart);
+      uint32_t c=vertex(x,z+1,chart);
+      uint32_t d=vertex(x+1,z+1,chart);
+      o_indices.insert(o_indices.end(),{a,c,d,a,d,b});
+    }
+  }
+}
+
+static ngl::Vec3 triangleNormal(const std::vector<ngl::Vec3> &_p, const uint32_t *_t)
+{
+  return (_p[_t[1]]-_p[_t[0]]).cross(_p[_t[2]]-_p[_t[0]]);
+}
+
+TEST(MeshSimplify,sphereStaysClosed)
+{
+  std::vector<ngl::Vec3> positions,normals;
+  std::vector<uint32_t> indices;
+  makeSphere(32,64,positions,normals,indices);
+  std::vector<uint32_t> out(indices.size());
+  ngl::Real error=-1.0f;
+  size_t target=indices.size()/4;
+  size_t count=ngl::simplifyMesh(indices.data(),indices.size(),positions.data(),normals.data(),nullptr,positions.size(),
+                                 target,ngl::SimplifyOptions(),out.data(),&error);
+  EXPECT_LE(count,target);
+  EXPECT_GT(count,target/2);
+  EXPECT_EQ(count%3,0u);
+  EXPECT_GT(error,0.0f);
+  EXPECT_LT(error,0.05f);
+  // still a closed manifold, every edge used once each way, with every triangle facing out
+  std::map<std::pair<uint32_t,uint32_t>,int> edges;
+  for(size_t t=0; t<count; t+=3)
+  {
+    for(size_t k=0; k<3; ++k)
+    {
+      ASSERT_LT(out[t+k],positions.size());
+      ++edges[{out[t+k],out[t+(k+1)%3]}];
+    }
+    ngl::Vec3 centre=(positions[out[t]]+positions[out[t+1]]+positions[out[t+2]])/3.0f;
+    EXPECT_GT(triangleNormal(positions,&out[t]).dot(centre),0.0f);
+  }
+  for(const auto &e : edges)
+  {
+    EXPECT_EQ(e.second,1);
+    EXPECT_EQ(edges.count({e.first.second,e.first.first}),1u);
+  }
+}
+
+TEST(MeshSimplify,flatGridKeepsBorder)
+{
+  std::vector<ngl::Vec3> positions,uvs;
+  std::vector<uint32_t> indices;
+  std::vector<int> chart;
+  makeGrid(16,false,positions,uvs,indices,chart);
+  std::vector<uint32_t> out(indices.size());
+  ngl::SimplifyOptions options;
+  options.m_maxError=0.0f;
+  ngl::Real error=-1.0f;
+  size_t count=ngl::simplifyMesh(indices.data(),indices.size(),positions.data(),nullptr,nullptr,positions.size(),
+                                 0,options,out.data(),&error);
+  // a plane simplifies with no error until little more than the locked border is left, the 64 border
+  // vertices alone need 62 triangles (from 512)
+  EXPECT_FLOAT_EQ(error,0.0f);
+  EXPECT_LE(count,64u*3u);
+  // the area and the border are kept and nothing is flipped
+  ngl::Real area=0.0f;
+  std::vector<bool> used(positions.size(),false);
+  for(size_t t=0; t<count; t+=3)
+  {
+    ngl::Vec3 n=triangleNormal(positions,&out[t]);
+    EXPECT_GT(n.m_y,0.0f);
+    area+=0.5f*n.length();
+    for(size_t k=0; k<3; ++k)
+    {
+      used[out[t+k]]=true;
+    }
+  }
+  EXPECT_NEAR(area,256.0f,1.0e-3f);
+  for(size_t v=0; v<positions.size(); ++v)
+  {
+    const ngl::Vec3 &p=positions[v];
+    if(p.m_x==0.0f || p.m_x==16.0f || p.m_z==0.0f || p.m_z==16.0f)
+    {
+      EXPECT_TRUE(used[v]);
+    }
+  }
+}
+
+TEST(MeshSimplify,seamsCollapseTogether)
+{
+  std::vector<ngl::Vec3> positions,uvs;
+  std::vector<uint32_t> indices;
+  std::vector<int> chart;
+  makeGrid(16,true,positions,uvs,indices,chart);
+  std::vector<uint32_t> out(indices.size());
+  ngl::SimplifyOptions options;
+  size_t count=ngl::simplifyMesh(indices.data(),indices.size(),positions.data(),nullptr,uvs.data(),positions.size(),
+                                 indices.size()/4,options,out.data());
+  EXPECT_LE(count,indices.size()/4);
+  // each triangle only uses the vertices of one side of the seam
+  for(size_t t=0; t<count; t+=3)
+  {
+    EXPECT_EQ(chart[out[t]],chart[out[t+1]]);
+    EXPECT_EQ(chart[out[t]],chart[out[t+2]]);
+  }
+  // and the two sides still meet, every seam position used on one side is used on the other
+  std::map<std::pair<int,int>,int> sides;
+  for(size_t i=0; i<count; ++i)
+  {
+    const ngl::Vec3 &p=positions[out[i]];
+    if(p.m_x==8.0f)
+    {
+      sides[{static_cast<int>(p.m_z),chart[out[i]]}]=1;
+    }
+  }
+  for(const auto &s : sides)
+  {
+    EXPECT_EQ(sides.count({s.first.first,1-s.first.second}),1u);
+  }
+}
+
+TEST(MeshSimplify,errorLimit)
+{
+  std::vector<ngl::Vec3> positions,normals;
+  std::vector<uint32_t> indices;
+  makeSphere(16,32,positions,normals,indices);
+  std::vector<uint32_t> out(indices.size());
+  ngl::SimplifyOptions options;
+  // every collapse on a sphere moves the surface so nothing is done
+  options.m_maxError=1.0e-6f;
+  ngl::Real error;
+  size_t count=ngl::simplifyMesh(indices.data(),indices.size(),positions.data(),normals.data(),nullptr,positions.size(),
+                                 0,options,out.data(),&error);
+  EXPECT_EQ(count,indices.size());
+  EXPECT_EQ(error,0.0f);
+  // with a larger limit it stops short of the target once the error gets too big
+  options.m_maxError=0.01f;
+  count=ngl::simplifyMesh(indices.data(),indices.size(),positions.data(),normals.data(),nullptr,positions.size(),
+                          0,options,out.data(),&error);
+  EXPECT_LT(count,indices.size());
+  EXPECT_GT(count,indices.size()/20);
+  EXPECT_GT(error,0.0f);
+  EXPECT_LE(error,0.01f);
+}
+
+TEST(MeshSimplify,lodChain)
+{
+  std::vector<ngl::Vec3> positions,normals;
+  std::vector<uint32_t> indices;
+  makeSphere(48,96,positions,normals,indices);
+  std::vector<uint32_t> chain;
+  std::vector<ngl::MeshLOD> lods;
+  ngl::buildLODChain(indices.data(),indices.size(),positions.data(),normals.data(),nullptr,positions.size(),
+                     5,0.5f,ngl::SimplifyOptions(),chain,lods);
+  ASSERT_EQ(lods.size(),5u);
+  EXPECT_TRUE(std::equal(indices.begin(),indices.end(),chain.begin()));
+  EXPECT_EQ(lods[0].m_error,0.0f);
+  for(size_t l=1; l<lods.size(); ++l)
+  {
+    EXPECT_EQ(lods[l].m_indexOffset,lods[l-1].m_indexOffset+lods[l-1].m_indexCount);
+    EXPECT_LE(lods[l].m_indexCount,lods[l-1].m_indexCount/2);
+    EXPECT_GE(lods[l].m_error,lods[l-1].m_error);
+  }
+  EXPECT_GT(lods.back().m_error,0.0f);
+  EXPECT_EQ(lods.back().m_indexOffset+lods.back().m_indexCount,chain.size());
+  // every level is simplified on its own so the same as simplifying directly
+  std::vector<uint32_t> out(indices.size());
+  size_t count=ngl::simplifyMesh(indices.data(),indices.size(),positions.data(),normals.data(),nullptr,positions.size(),
+                                 lods[2].m_indexCount,ngl::SimplifyOptions(),out.data());
+  ASSERT_EQ(count,lods[2].m_indexCount);
+  EXPECT_TRUE(std::equal(out.begin(),out.begin()+count,chain.begin()+lods[2].m_indexOffset));
+}
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include <ngl/OBB.h>
+#include <ngl/Mat4.h>
+#include <ngl/SIMD.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "../TestUtils.h"
+
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+static ngl::Vec3 transformPoint(const ngl::Vec3 &_p, const ngl::Mat4 &_m)
+{
+  return ngl::Vec3(_p.m_x*_m.m_m[0][0] + _p.m_y*_m.m_m[1][0] + _p.m_z*_m.m_m[2][0] + _m.m_m[3][0],
+                   _p.m_x*_m.m_m[0][1] + _p.m_y*_m.m_m[1][1] + _p.m_z*_m.m_m[2][1] + _m.m_m[3][1],
+                   _p.m_x*_m.m_m[0][2] + _p.m_y*_m.m_m[1][2] + _p.m_z*_m.m_m[2][2] + _m.m_m[3][2]);
+}
+
+// points filling a 8 x 2 x 0.5 box rotated and moved away from the origin
+static std::vector<ngl::Vec3> rotatedBox(size_t _count, ngl::Mat4 &o_m)
+{
+  ngl::Mat4 r;
+  r.euler(40.0f,0.2f,0.7f,0.4f);
+  ngl::Mat4 t;
+  t.translate(5.0f,-3.0f,2.0f);
+  o_m=r*t;
+  unsigned int seed=11u;
+  std::vector<ngl::Vec3> points;
+  for(size_t i=0; i<_count; ++i)
+  {
+    ngl::Vec3 p(randomReal(seed,-4.0f,4.0f),randomReal(seed,-1.0f,1.0f),randomReal(seed,-0.25f,0.25f));
+    points.push_back(transformPoint(p,o_m));
+  }
+  return points;
+}
+
+TEST(OBB,empty)
+{
+  ngl::OBB b;
+  EXPECT_TRUE(b.isEmpty());
+  EXPECT_TRUE(ngl::OBB::fromPoints(nullptr,0).isEmpty());
+  EXPECT_TRUE(b.bounds().isEmpty());
+}
+
+TEST(OBB,fromPointsRecoversBox)
+{
+  forEachSIMDLevel([]()
+  {
+    ngl::Mat4 m;
+    std::vector<ngl::Vec3> points=rotatedBox(20000,m);
+    ngl::OBB b=ngl::OBB::fromPoints(points.data(),points.size());
+    ASSERT_FALSE(b.isEmpty());
+    for(const auto &p : points)
+    {
+      EXPECT_TRUE(b.contains(p,1e-4f));
+    }
+    // the half sizes in some order are close to 4, 1 and 0.25
+    ngl::Real h[3]={b.m_halfSize.m_x,b.m_halfSize.m_y,b.m_halfSize.m_z};
+    std::sort(h,h+3);
+    EXPECT_NEAR(h[0],0.25f,0.02f);
+    EXPECT_NEAR(h[1],1.0f,0.02f);
+    EXPECT_NEAR(h[2],4.0f,0.02f);
+    EXPECT_NEAR((b.m_center-ngl::Vec3(5.0f,-3.0f,2.0f)).length(),0.0f,0.05f);
+    // much tighter than the axis aligned box
+    ngl::OBB aligned(ngl::Bounds3::fromPoints(points.data(),points.size()));
+    EXPECT_LT(b.volume(),aligned.volume()*0.5f);
+    // the axes are orthonormal
+    for(int i=0; i<3; ++i)
+    {
+      EXPECT_NEAR(b.m_axis[i].length(),1.0f,1e-5f);
+      EXPECT_NEAR(b.m_axis[i].dot(b.m_axis[(i+1)%3]),0.0f,1e-5f);
+    }
+  });
+}
+
+TEST(OBB,alignedPointsKeepWorldAxes)
+{
+  std::vector<ngl::Vec3> points;
+  for(int i=0; i<8; ++i)
+  {
+    points.push_back(ngl::Vec3((i&1) ? 3.0f : 1.0f,(i&2) ? 1.0f : -1.0f,(i&4) ? 4.0f : 0.0f));
+  }
+  ngl::OBB b=ngl::OBB::fromPoints(points.data(),points.size());
+  EXPECT_NEAR(b.volume(),16.0f,1e-4f);
+  ngl::Bounds3 box=b.bounds();
+  EXPECT_NEAR(box.m_min.m_x,1.0f,1e-4f);
+  EXPECT_NEAR(box.m_max.m_z,4.0f,1e-4f);
+}
+
+TEST(OBB,cornersBoundsAndTransform)
+{
+  ngl::Mat4 m;
+  std::vector<ngl::Vec3> points=rotatedBox(1000,m);
+  ngl::OBB b=ngl::OBB::fromPoints(points.data(),points.size());
+  ngl::Vec3 corners[8];
+  b.getCorners(corners);
+  ngl::Bounds3 cornerBounds=ngl::Bounds3::fromPoints(corners,8);
+  ngl::Bounds3 box=b.bounds();
+  for(size_t i=0; i<3; ++i)
+  {
+    EXPECT_NEAR(box.m_min.m_openGL[i],cornerBounds.m_min.m_openGL[i],1e-4f);
+    EXPECT_NEAR(box.m_max.m_openGL[i],cornerBounds.m_max.m_openGL[i],1e-4f);
+  }
+  ngl::Mat4 r;
+  r.rotateY(30.0f);
+  ngl::Mat4 t;
+  t.translate(-1.0f,2.0f,0.5f);
+  ngl::Mat4 rt=r*t;
+  ngl::OBB moved=b.transformed(rt);
+  EXPECT_NEAR(moved.volume(),b.volume(),b.volume()*1e-4f);
+  for(const auto &p : points)
+  {
+    EXPECT_TRUE(moved.contains(transformPoint(p,rt),1e-4f));
+  }
+}
@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+#include <ngl/OcclusionBuffer.h>
+#include <ngl/AABB.h>
+#include <ngl/Util.h>
+#include <ngl/Mat4.h>
+#include <ngl/Vec3.h>
+#include <ngl/Vec3Array.h>
+#include <ngl/SIMD.h>
+#include <cmath>
+#include <vector>
+#include "../TestUtils.h"
+
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+// looking down -z from (0,0,5)
+static ngl::Mat4 viewProject()
+{
+  return ngl::lookAt(ngl::Vec3(0.0f,0.0f,5.0f),ngl::Vec3(0.0f,0.0f,0.0f),ngl::Vec3(0.0f,1.0f,0.0f))*
+         ngl::perspective(60.0f,2.0f,0.5f,50.0f);
+}
+
+// a square in the x,y plane at _z
+static size_t addWall(ngl::OcclusionBuffer &io_buffer, ngl::Real _size, ngl::Real _z)
+{
+  ngl::Vec3 verts[4]={ngl::Vec3(-_size,-_size,_z),ngl::Vec3(_size,-_size,_z),ngl::Vec3(_size,_size,_z),ngl::Vec3(-_size,_size,_z)};
+  uint32_t indices[6]={0,1,2,0,2,3};
+  return io_buffer.addOccluder(verts,4,indices,6);
+}
+
+static bool boxVisible(const ngl::OcclusionBuffer &_buffer, const ngl::Vec3 &_centre, ngl::Real _size)
+{
+  ngl::Vec3 h(_size,_size,_size);
+  return _buffer.isVisible(_centre-h,_centre+h);
+}
+
+TEST(NGLOcclusionBuffer,empty)
+{
+  ngl::OcclusionBuffer b(128,64);
+  b.begin(viewProject());
+  b.rasterise();
+  for(size_t y=0; y<b.height(); ++y)
+  {
+    for(size_t x=0; x<b.width(); ++x)
+    {
+      ASSERT_FLOAT_EQ(b.getDepth(x,y),1.0f);
+    }
+  }
+  EXPECT_TRUE(boxVisible(b,ngl::Vec3(0.0f,0.0f,0.0f),0.5f));
+  // off screen, past the far plane and crossing the near plane
+  EXPECT_FALSE(boxVisible(b,ngl::Vec3(100.0f,0.0f,0.0f),0.5f));
+  EXPECT_FALSE(boxVisible(b,ngl::Vec3(0.0f,0.0f,-100.0f),0.5f));
+  EXPECT_TRUE(boxVisible(b,ngl::Vec3(0.0f,0.0f,5.0f),1.0f));
+}
+
+TEST(NGLOcclusionBuffer,wallHidesBoxes)
+{
+  forEachSIMDLevel([]()
+  {
+    ngl::OcclusionBuffer b(256,128);
+    size_t wall=addWall(b,2.0f,0.0f);
+    b.begin(viewProject());
+    b.drawOccluder(wall);
+    b.rasterise();
+    EXPECT_FALSE(boxVisible(b,ngl::Vec3(0.0f,0.0f,-3.0f),0.5f));
+    EXPECT_FALSE(boxVisible(b,ngl::Vec3(0.5f,-0.5f,-1.0f),0.2f));
+    // in front of the wall, beside it and poking through it
+    EXPECT_TRUE(boxVisible(b,ngl::Vec3(0.0f,0.0f,2.0f),0.5f));
+    EXPECT_TRUE(boxVisible(b,ngl::Vec3(4.0f,0.0f,-3.0f),0.5f));
+    EXPECT_TRUE(boxVisible(b,ngl::Vec3(0.0f,0.0f,0.0f),0.5f));
+    // the same wall moved back by the model matrix no longer hides the box
+    ngl::Mat4 back;
+    back.translate(0.0f,0.0f,-5.0f);
+    b.begin(viewProject());
+    b.drawOccluder(wall,back);
+    b.rasterise();
+    EXPECT_TRUE(boxVisible(b,ngl::Vec3(0.0f,0.0f,-3.0f),0.5f));
+  });
+}
+
+TEST(NGLOcclusionBuffer,depth)
+{
+  ngl::OcclusionBuffer b(256,128);
+  b.begin(viewProject());
+  b.drawOccluder(addWall(b,2.0f,0.0f));
+  b.rasterise();
+  // the wall is facing the camera so the centre pixel has the depth of the origin
+  ngl::Vec4 p=ngl::Vec4(0.0f,0.0f,0.0f,1.0f)*viewProject();
+  EXPECT_NEAR(b.getDepth(128,64),p.m_z/p.m_w*0.5f+0.5f,1e-4f);
+  EXPECT_GE(b.getBlockDepth(128,64),b.getDepth(128,64));
+  EXPECT_FLOAT_EQ(b.getDepth(0,0),1.0f);
+}
+
+TEST(NGLOcclusionBuffer,nearClip)
+{
+  // a floor running from behind the camera into the distance still hides what is under it
+  ngl::OcclusionBuffer b(256,128);
+  ngl::Vec3 verts[4]={ngl::Vec3(-20.0f,-1.0f,20.0f),ngl::Vec3(20.0f,-1.0f,20.0f),ngl::Vec3(20.0f,-1.0f,-40.0f),ngl::Vec3(-20.0f,-1.0f,-40.0f)};
+  uint32_t indices[6]={0,1,2,0,2,3};
+  size_t floor=b.addOccluder(verts,4,indices,6);
+  b.begin(viewProject());
+  b.drawOccluder(floor);
+  b.rasterise();
+  EXPECT_FALSE(boxVisible(b,ngl::Vec3(0.0f,-3.0f,0.0f),0.5f));
+  EXPECT_TRUE(boxVisible(b,ngl::Vec3(0.0f,0.0f,0.0f),0.5f));
+}
+
+TEST(NGLOcclusionBuffer,tnvOccluder)
+{
+  // two triangles as u,v,nx,ny,nz,x,y,z
+  ngl::Real data[]={0,0,0,0,1,-2,-2,0, 0,0,0,0,1,2,-2,0, 0,0,0,0,1,2,2,0,
+                    0,0,0,0,1,-2,-2,0, 0,0,0,0,1,2,2,0, 0,0,0,0,1,-2,2,0};
+  ngl::OcclusionBuffer b(256,128);
+  size_t wall=b.addOccluder(data,sizeof(data)/sizeof(ngl::Real));
+  b.begin(viewProject());
+  b.drawOccluder(wall);
+  b.rasterise();
+  EXPECT_FALSE(boxVisible(b,ngl::Vec3(0.0f,0.0f,-3.0f),0.5f));
+  EXPECT_TRUE(boxVisible(b,ngl::Vec3(4.0f,0.0f,-3.0f),0.5f));
+}
+
+TEST(NGLOcclusionBuffer,simdLevelsMatch)
+{
+  // lots of random triangles over several tiles, every level must give the same depths
+  ngl::OcclusionBuffer b(300,150);
+  std::vector<ngl::Vec3> verts;
+  std::vector<uint32_t> indices;
+  unsigned int seed=5u;
+  auto random=[&seed](ngl::Real _min, ngl::Real _max)
+  {
+    seed=seed*1664525u+1013904223u;
+    return _min+static_cast<ngl::Real>(seed>>8)/static_cast<ngl::Real>(1u<<24)*(_max-_min);
+  };
+  for(uint32_t i=0; i<600; ++i)
+  {
+    verts.push_back(ngl::Vec3(random(-6.0f,6.0f),random(-3.0f,3.0f),random(-10.0f,6.0f)));
+    indices.push_back(i);
+  }
+  size_t mesh=b.addOccluder(verts.data(),verts.size(),indices.data(),indices.size());
+  std::vector<std::vector<ngl::Real>> depths;
+  forEachSIMDLevel([&]()
+  {
+    b.begin(viewProject());
+    b.drawOccluder(mesh);
+    b.rasterise();
+    std::vector<ngl::Real> d;
+    for(size_t y=0; y<b.height(); ++y)
+    {
+      for(size_t x=0; x<b.width(); ++x)
+      {
+        d.push_back(b.getDepth(x,y));
+      }
+    }
+    depths.push_back(d);
+  });
+  for(size_t i=1; i<depths.size(); ++i)
+  {
+    EXPECT_EQ(depths[0],depths[i]) << "level " << i;
+  }
+  size_t drawn=0;
+  for(auto d : depths[0])
+  {
+    drawn+= d < 1.0f;
+  }
+  EXPECT_GT(drawn,depths[0].size()/4);
+
+  // the batch test gives the same as testing one at a time
+  ngl::Vec3Array mn;
+  ngl::Vec3Array mx;
+  for(size_t i=0; i<5003; ++i)
+  {
+    ngl::Vec3 c(random(-8.0f,8.0f),random(-4.0f,4.0f),random(-12.0f,4.0f));
+    ngl::Real s=random(0.05f,0.5f);
+    mn.push_back(c-ngl::Vec3(s,s,s));
+    mx.push_back(c+ngl::Vec3(s,s,s));
+  }
+  std::vector<uint32_t> mask((mn.size()+31)/32);
+  b.testBoxes(mn,mx,mask.data());
+  size_t hidden=0;
+  for(size_t i=0; i<mn.size(); ++i)
+  {
+    bool visible=b.isVisible(mn.get(i),mx.get(i));
+    ASSERT_EQ(((mask[i/32] >> (i%32)) & 1u)!=0,visible) << i;
+    hidden+=!visible;
+  }
+  EXPECT_GT(hidden,0u);
+}
@@ -0,0 +1,82 @@
+#include <ngl/Quaternion.h>
+#include <ngl/BatchQuaternion.h>
+#include <ngl/Mat4.h>
+#include <hayai/hayai.hpp>
+#include <hayai/hayai_main.hpp>
+#include <vector>
+
+// blending and converting a block of joint rotations, the per frame work of a skinned character
+constexpr size_t c_count=4096;
+
+static std::vector<ngl::Quaternion> makeRotations(ngl::Real _offset)
+{
+  std::vector<ngl::Quaternion> q(c_count);
+  for(size_t i=0; i<c_count; ++i)
+  {
+    q[i].fromAxisAngle(ngl::Vec3(0.0f,1.0f,0.0f),static_cast<ngl::Real>(i%360)+_offset);
+  }
+  return q;
+}
+
+static std::vector<ngl::Quaternion> a=makeRotations(0.0f);
+static std::vector<ngl::Quaternion> b=makeRotations(45.0f);
+static std::vector<ngl::Quaternion> o(c_count);
+static std::vector<ngl::Mat4> m(c_count);
+static ngl::Real t=0.3f;
+
+BENCHMARK(QuaternionTests, SlerpLoop, 10, 100)
+{
+  for(size_t i=0; i<c_count; ++i)
+  {
+    o[i]=ngl::Quaternion::slerp(a[i],b[i],t);
+  }
+}
+
+BENCHMARK(QuaternionTests, SlerpBatch, 10, 100)
+{
+  ngl::slerpQuaternions(a.data(),b.data(),c_count,t,o.data());
+}
+
+BENCHMARK(QuaternionTests, NlerpBatch, 10, 100)
+{
+  ngl::nlerpQuaternions(a.data(),b.data(),c_count,t,o.data());
+}
+
+BENCHMARK(QuaternionTests, MultiplyLoop, 10, 100)
+{
+  for(size_t i=0; i<c_count; ++i)
+  {
+    o[i]=a[i]*b[i];
+  }
+}
+
+BENCHMARK(QuaternionTests, MultiplyBatch, 10, 100)
+{
+  ngl::multiplyQuaternions(a.data(),b.data(),c_count,o.data());
+}
+
+BENCHMARK(QuaternionTests, ToMat4Loop, 10, 100)
+{
+  for(size_t i=0; i<c_count; ++i)
+  {
+    m[i]=a[i].toMat4();
+  }
+}
+
+BENCHMARK(QuaternionTests, ToMat4Batch, 10, 100)
+{
+  ngl::quaternionsToMat4(a.data(),c_count,m.data());
+}
+
+int main(int argc, char **argv)
+{
+    // Set up the main runner.
+    ::hayai::MainRunner runner;
+    // Parse the arguments.
+    int result = runner.ParseArgs(argc, argv);
+    if (result)
+        return result;
+
+    // Execute based on the selected mode.
+    return runner.Run();
+}
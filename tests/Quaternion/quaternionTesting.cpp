@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include <ngl/Types.h>
+#include <ngl/Quaternion.h>
+#include <ngl/BatchQuaternion.h>
+#include <ngl/Mat3.h>
+#include <ngl/Mat4.h>
+#include <ngl/SIMD.h>
+#include <cmath>
+#include <vector>
+#include "../TestUtils.h"
+
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+// an odd count so the simd blocks and the scalar tail are both used
+constexpr size_t c_count=1031;
+
+static std::vector<ngl::Quaternion> randomRotations(unsigned int _seed)
+{
+  std::vector<ngl::Quaternion> q(c_count);
+  for(size_t i=0; i<c_count; ++i)
+  {
+    _seed=_seed*1664525u+1013904223u;
+    ngl::Real angle=static_cast<ngl::Real>(_seed%3600)*0.1f;
+    ngl::Vec3 axis(std::sin(angle*0.7f),std::cos(angle*1.3f),std::sin(angle*2.9f)+0.1f);
+    axis.normalize();
+    q[i].fromAxisAngle(axis,angle);
+  }
+  // nearly identical and opposite pairs hit the linear and sign flip branches
+  q[1]=q[0];
+  q[3]=ngl::Quaternion(-q[2].getS(),-q[2].getX(),-q[2].getY(),-q[2].getZ());
+  return q;
+}
+
+static void expectNear(const ngl::Quaternion &_a, const ngl::Quaternion &_b, ngl::Real _eps)
+{
+  EXPECT_NEAR(_a.getS(),_b.getS(),_eps);
+  EXPECT_NEAR(_a.getX(),_b.getX(),_eps);
+  EXPECT_NEAR(_a.getY(),_b.getY(),_eps);
+  EXPECT_NEAR(_a.getZ(),_b.getZ(),_eps);
+}
+
+static std::vector<ngl::Real> blendValues()
+{
+  std::vector<ngl::Real> t(c_count);
+  for(size_t i=0; i<c_count; ++i)
+  {
+    t[i]=static_cast<ngl::Real>(i%101)/100.0f;
+  }
+  return t;
+}
+
+
+TEST(NGLQuaternion,batchSlerp)
+{
+  auto a=randomRotations(1);
+  auto b=randomRotations(2);
+  auto t=blendValues();
+  std::vector<ngl::Quaternion> out(c_count);
+  forEachSIMDLevel([&]()
+  {
+    ngl::slerpQuaternions(a.data(),b.data(),c_count,0.3f,out.data());
+    for(size_t i=0; i<c_count; ++i)
+    {
+      expectNear(out[i],ngl::Quaternion::slerp(a[i],b[i],0.3f),1e-5f);
+    }
+    ngl::slerpQuaternions(a.data(),b.data(),c_count,t.data(),out.data());
+    for(size_t i=0; i<c_count; ++i)
+    {
+      expectNear(out[i],ngl::Quaternion::slerp(a[i],b[i],t[i]),1e-5f);
+    }
+  });
+}
+
+TEST(NGLQuaternion,batchNlerp)
+{
+  auto a=randomRotations(3);
+  auto b=randomRotations(4);
+  auto t=blendValues();
+  std::vector<ngl::Quaternion> out(c_count);
+  forEachSIMDLevel([&]()
+  {
+    ngl::nlerpQuaternions(a.data(),b.data(),c_count,t.data(),out.data());
+    for(size_t i=0; i<c_count; ++i)
+    {
+      EXPECT_NEAR(out[i].magnitude(),1.0f,1e-5f);
+      // nlerp follows the same great circle as slerp so the end points match exactly
+      if(t[i]==0.0f)
+      {
+        expectNear(out[i],a[i],1e-5f);
+      }
+      // and both take the short way round
+      ngl::Quaternion s=ngl::Quaternion::slerp(a[i],b[i],t[i]);
+      EXPECT_GT(s.getS()*out[i].getS()+s.getX()*out[i].getX()+s.getY()*out[i].getY()+s.getZ()*out[i].getZ(),0.9f);
+    }
+  });
+}
+
+TEST(NGLQuaternion,batchMultiply)
+{
+  auto a=randomRotations(5);
+  auto b=randomRotations(6);
+  std::vector<ngl::Quaternion> out(c_count);
+  forEachSIMDLevel([&]()
+  {
+    ngl::multiplyQuaternions(a.data(),b.data(),c_count,out.data());
+    for(size_t i=0; i<c_count; ++i)
+    {
+      expectNear(out[i],a[i]*b[i],1e-6f);
+    }
+    // in place
+    std::vector<ngl::Quaternion> c=a;
+    ngl::multiplyQuaternions(c.data(),b.data(),c_count,c.data());
+    for(size_t i=0; i<c_count; ++i)
+    {
+      expectNear(c[i],out[i],0.0f);
+    }
+  });
+}
+
+TEST(NGLQuaternion,batchToMat4)
+{
+  auto q=randomRotations(7);
+  std::vector<ngl::Mat4> out(c_count);
+  forEachSIMDLevel([&]()
+  {
+    ngl::quaternionsToMat4(q.data(),c_count,out.data());
+    for(size_t i=0; i<c_count; ++i)
+    {
+      EXPECT_TRUE(out[i]==q[i].toMat4());
+    }
+  });
+}
+
+TEST(NGLQuaternion,batchToMat3)
+{
+  auto q=randomRotations(8);
+  std::vector<ngl::Mat3> out(c_count);
+  forEachSIMDLevel([&]()
+  {
+    ngl::quaternionsToMat3(q.data(),c_count,out.data());
+    for(size_t i=0; i<c_count; ++i)
+    {
+      EXPECT_TRUE(out[i]==ngl::Mat3(q[i].toMat4()));
+    }
+  });
+}
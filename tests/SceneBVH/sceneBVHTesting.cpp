@@ -0,0 +1,246 @@
+#include <gtest/gtest.h>
+#include <ngl/SceneBVH.h>
+#include <ngl/Frustum.h>
+#include <ngl/BBox.h>
+#include <ngl/Util.h>
+#include <ngl/Vec3.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "../TestUtils.h"
+
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+static ngl::Vec3 randomVec3(unsigned int &io_seed, ngl::Real _min, ngl::Real _max)
+{
+  ngl::Real x=randomReal(io_seed,_min,_max);
+  ngl::Real y=randomReal(io_seed,_min,_max);
+  ngl::Real z=randomReal(io_seed,_min,_max);
+  return ngl::Vec3(x,y,z);
+}
+
+// the objects held in the tree so every query can be checked against testing them all
+struct Object
+{
+  uint32_t m_id;
+  ngl::Vec3 m_min;
+  ngl::Vec3 m_max;
+  bool m_alive;
+};
+
+static std::vector<size_t> sorted(std::vector<size_t> _v)
+{
+  std::sort(_v.begin(),_v.end());
+  return _v;
+}
+
+template<typename Test>
+static std::vector<size_t> bruteForce(const std::vector<Object> &_objects, Test _test)
+{
+  std::vector<size_t> r;
+  for(size_t i=0; i<_objects.size(); ++i)
+  {
+    if(_objects[i].m_alive && _test(_objects[i].m_min,_objects[i].m_max))
+    {
+      r.push_back(i);
+    }
+  }
+  return r;
+}
+
+static void checkQueries(const ngl::SceneBVH &_bvh, const std::vector<Object> &_objects)
+{
+  unsigned int seed=99u;
+  std::vector<size_t> found;
+
+  ngl::Frustum f(ngl::lookAt(ngl::Vec3(0.0f,5.0f,30.0f),ngl::Vec3(0.0f,0.0f,0.0f),ngl::Vec3(0.0f,1.0f,0.0f))*
+                 ngl::perspective(40.0f,1.5f,0.5f,40.0f));
+  _bvh.queryFrustum(f,found);
+  EXPECT_EQ(sorted(found),bruteForce(_objects,[&](const ngl::Vec3 &_min, const ngl::Vec3 &_max)
+  {
+    return f.boxInFrustum(_min,_max)!=ngl::CameraIntercept::OUTSIDE;
+  }));
+
+  for(int q=0; q<20; ++q)
+  {
+    ngl::Vec3 c=randomVec3(seed,-20.0f,20.0f);
+    ngl::Real r=randomReal(seed,0.5f,6.0f);
+    found.clear();
+    _bvh.querySphere(c,r,found);
+    EXPECT_EQ(sorted(found),bruteForce(_objects,[&](const ngl::Vec3 &_min, const ngl::Vec3 &_max)
+    {
+      ngl::Vec3 p(std::max(_min.m_x,std::min(c.m_x,_max.m_x)),
+                  std::max(_min.m_y,std::min(c.m_y,_max.m_y)),
+                  std::max(_min.m_z,std::min(c.m_z,_max.m_z)));
+      return (p-c).lengthSquared()<=r*r;
+    }));
+
+    ngl::Vec3 bMin=randomVec3(seed,-20.0f,15.0f);
+    ngl::Vec3 bMax=bMin+randomVec3(seed,0.1f,5.0f);
+    found.clear();
+    _bvh.queryBox(bMin,bMax,found);
+    EXPECT_EQ(sorted(found),bruteForce(_objects,[&](const ngl::Vec3 &_min, const ngl::Vec3 &_max)
+    {
+      return _min.m_x<=bMax.m_x && _max.m_x>=bMin.m_x && _min.m_y<=bMax.m_y && _max.m_y>=bMin.m_y &&
+             _min.m_z<=bMax.m_z && _max.m_z>=bMin.m_z;
+    }));
+
+    ngl::Vec3 o=randomVec3(seed,-25.0f,25.0f);
+    ngl::Vec3 d=randomVec3(seed,-1.0f,1.0f);
+    found.clear();
+    _bvh.queryRay(o,d,30.0f,found);
+    EXPECT_EQ(sorted(found),bruteForce(_objects,[&](const ngl::Vec3 &_min, const ngl::Vec3 &_max)
+    {
+      ngl::Real t0=0.0f;
+      ngl::Real t1=30.0f;
+      for(int i=0; i<3; ++i)
+      {
+        ngl::Real a=(_min.m_openGL[i]-o.m_openGL[i])/d.m_openGL[i];
+        ngl::Real b=(_max.m_openGL[i]-o.m_openGL[i])/d.m_openGL[i];
+        t0=std::max(t0,std::min(a,b));
+        t1=std::min(t1,std::max(a,b));
+      }
+      return t0<=t1;
+    }));
+  }
+}
+
+static void insertRandom(ngl::SceneBVH &io_bvh, std::vector<Object> &io_objects, size_t _count, unsigned int &io_seed)
+{
+  for(size_t i=0; i<_count; ++i)
+  {
+    Object o;
+    o.m_min=randomVec3(io_seed,-20.0f,20.0f);
+    o.m_max=o.m_min+randomVec3(io_seed,0.1f,2.0f);
+    o.m_alive=true;
+    o.m_id=io_bvh.insert(o.m_min,o.m_max,io_objects.size());
+    io_objects.push_back(o);
+  }
+}
+
+TEST(SceneBVH,empty)
+{
+  ngl::SceneBVH bvh;
+  std::vector<size_t> found;
+  bvh.queryBox(ngl::Vec3(-1.0f,-1.0f,-1.0f),ngl::Vec3(1.0f,1.0f,1.0f),found);
+  bvh.queryFrustum(ngl::Frustum(),found);
+  EXPECT_TRUE(found.empty());
+  EXPECT_TRUE(bvh.empty());
+  EXPECT_EQ(bvh.getHeight(),0);
+}
+
+TEST(SceneBVH,insertAndQuery)
+{
+  ngl::SceneBVH bvh;
+  std::vector<Object> objects;
+  unsigned int seed=7u;
+  insertRandom(bvh,objects,2000,seed);
+  EXPECT_EQ(bvh.size(),2000u);
+  // the rotations keep the tree close to balanced
+  EXPECT_LE(bvh.getHeight(),2*static_cast<int>(std::log2(2000.0)));
+  for(size_t i=0; i<objects.size(); ++i)
+  {
+    EXPECT_EQ(bvh.getUserData(objects[i].m_id),i);
+  }
+  checkQueries(bvh,objects);
+}
+
+TEST(SceneBVH,removeAndMove)
+{
+  ngl::SceneBVH bvh(0.25f);
+  std::vector<Object> objects;
+  unsigned int seed=11u;
+  insertRandom(bvh,objects,1000,seed);
+  for(size_t i=0; i<objects.size(); i+=3)
+  {
+    bvh.remove(objects[i].m_id);
+    objects[i].m_alive=false;
+  }
+  EXPECT_EQ(bvh.size(),666u);
+  checkQueries(bvh,objects);
+
+  size_t reinserted=0;
+  for(auto &o : objects)
+  {
+    if(!o.m_alive)
+    {
+      continue;
+    }
+    // a small nudge stays in the grown box, a big one moves the leaf
+    ngl::Vec3 delta=randomVec3(seed,-0.1f,0.1f);
+    if(&o-objects.data() < 300)
+    {
+      delta=randomVec3(seed,-10.0f,10.0f);
+    }
+    o.m_min+=delta;
+    o.m_max+=delta;
+    reinserted+=bvh.move(o.m_id,o.m_min,o.m_max);
+  }
+  EXPECT_GT(reinserted,0u);
+  EXPECT_LT(reinserted,300u);
+  checkQueries(bvh,objects);
+
+  // ids freed by remove are reused and the old ones keep working
+  insertRandom(bvh,objects,200,seed);
+  EXPECT_EQ(bvh.size(),866u);
+  checkQueries(bvh,objects);
+}
+
+TEST(SceneBVH,rebuild)
+{
+  ngl::SceneBVH bvh;
+  std::vector<Object> objects;
+  unsigned int seed=23u;
+  insertRandom(bvh,objects,1500,seed);
+  for(auto &o : objects)
+  {
+    ngl::Vec3 delta=randomVec3(seed,-5.0f,5.0f);
+    o.m_min+=delta;
+    o.m_max+=delta;
+    bvh.move(o.m_id,o.m_min,o.m_max);
+  }
+  ngl::Real before=bvh.getCost();
+  bvh.rebuild();
+  EXPECT_LE(bvh.getCost(),before);
+  EXPECT_EQ(bvh.size(),1500u);
+  for(size_t i=0; i<objects.size(); ++i)
+  {
+    EXPECT_EQ(bvh.getUserData(objects[i].m_id),i);
+  }
+  checkQueries(bvh,objects);
+  // and the tree still updates after a rebuild
+  bvh.remove(objects[0].m_id);
+  objects[0].m_alive=false;
+  checkQueries(bvh,objects);
+}
+
+TEST(SceneBVH,transformedBox)
+{
+  ngl::BBox box(-1.0f,1.0f,-2.0f,2.0f,-0.5f,0.5f);
+  ngl::Mat4 r;
+  r.rotateY(90.0f);
+  ngl::Mat4 t;
+  t.translate(10.0f,0.0f,0.0f);
+  ngl::Mat4 m=r*t;
+  ngl::Vec3 mn,mx;
+  ngl::SceneBVH::transformBox(box,m,mn,mx);
+  EXPECT_NEAR(mn.m_x,9.5f,1e-5f);
+  EXPECT_NEAR(mx.m_x,10.5f,1e-5f);
+  EXPECT_NEAR(mn.m_y,-2.0f,1e-5f);
+  EXPECT_NEAR(mx.m_y,2.0f,1e-5f);
+  EXPECT_NEAR(mn.m_z,-1.0f,1e-5f);
+  EXPECT_NEAR(mx.m_z,1.0f,1e-5f);
+
+  ngl::SceneBVH bvh;
+  uint32_t id=bvh.insert(box,m,42);
+  std::vector<size_t> found;
+  bvh.querySphere(ngl::Vec3(10.0f,0.0f,0.0f),0.1f,found);
+  ASSERT_EQ(found.size(),1u);
+  EXPECT_EQ(found[0],42u);
+  EXPECT_NEAR(bvh.getMax(id).m_x,10.5f,1e-5f);
+}
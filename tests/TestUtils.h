@@ -0,0 +1,39 @@
+#ifndef TESTUTILS_H_
+#define TESTUTILS_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file TestUtils.h
+/// @brief helpers shared by the test suites, include as "../TestUtils.h" from a suite directory
+//----------------------------------------------------------------------------------------------------------------------
+#include <ngl/Types.h>
+#include <ngl/SIMD.h>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief run _test once for every simd level the cpu has then put the active level back
+/// @param[in] _test the test body to run
+//----------------------------------------------------------------------------------------------------------------------
+template<typename Func>
+void forEachSIMDLevel(Func _test)
+{
+  auto level=ngl::activeSIMDLevel();
+  for(int l=0; l<=static_cast<int>(ngl::cpuSIMDLevel()); ++l)
+  {
+    ngl::setSIMDLevel(static_cast<ngl::SIMDLevel>(l));
+    _test();
+  }
+  ngl::setSIMDLevel(level);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief a small lcg so the random test data is the same on every platform
+/// @param[in,out] io_seed the generator state
+/// @param[in] _min the lowest value
+/// @param[in] _max the highest value
+/// @returns a value in [_min,_max)
+//----------------------------------------------------------------------------------------------------------------------
+inline ngl::Real randomReal(unsigned int &io_seed, ngl::Real _min, ngl::Real _max)
+{
+  io_seed=io_seed*1664525u+1013904223u;
+  return _min+static_cast<ngl::Real>(io_seed>>8)/static_cast<ngl::Real>(1u<<24)*(_max-_min);
+}
+
+#endif
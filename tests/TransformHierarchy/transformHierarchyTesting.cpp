@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+#include <ngl/TransformHierarchy.h>
+#include <ngl/Mat4.h>
+#include <ngl/Vec3.h>
+
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+static ngl::Mat4 trs(const ngl::Vec3 &_t, const ngl::Vec3 &_r, const ngl::Vec3 &_s)
+{
+  return ngl::Mat4::fromTRS(_t,_r,_s);
+}
+
+TEST(NGLTransformHierarchy,worldMatrices)
+{
+  ngl::TransformHierarchy h;
+  size_t root=h.addNode();
+  size_t child=h.addNode(root);
+  size_t grandChild=h.addNode(child);
+  EXPECT_EQ(h.getParent(root),ngl::TransformHierarchy::c_noParent);
+  EXPECT_EQ(h.getParent(grandChild),child);
+
+  h.setTransform(root,ngl::Vec3(1.0f,2.0f,3.0f),ngl::Vec3(0.0f,45.0f,0.0f),ngl::Vec3(2.0f,2.0f,2.0f));
+  h.setTransform(child,ngl::Vec3(0.0f,1.0f,0.0f),ngl::Vec3(30.0f,0.0f,10.0f),ngl::Vec3(1.0f,0.5f,1.0f));
+  h.setPosition(grandChild,ngl::Vec3(0.0f,0.0f,2.0f));
+  h.update();
+
+  ngl::Mat4 r=trs(ngl::Vec3(1.0f,2.0f,3.0f),ngl::Vec3(0.0f,45.0f,0.0f),ngl::Vec3(2.0f,2.0f,2.0f));
+  ngl::Mat4 c=trs(ngl::Vec3(0.0f,1.0f,0.0f),ngl::Vec3(30.0f,0.0f,10.0f),ngl::Vec3(1.0f,0.5f,1.0f))*r;
+  ngl::Mat4 g=trs(ngl::Vec3(0.0f,0.0f,2.0f),ngl::Vec3(0.0f,0.0f,0.0f),ngl::Vec3(1.0f,1.0f,1.0f))*c;
+  EXPECT_TRUE(h.getWorldMatrix(root)==r);
+  EXPECT_TRUE(h.getWorldMatrix(child)==c);
+  EXPECT_TRUE(h.getWorldMatrix(grandChild)==g);
+  for(size_t i=0; i<h.size(); ++i)
+  {
+    EXPECT_TRUE(h.getWorldMatrix(i)*h.getInverseWorldMatrix(i)==ngl::Mat4());
+  }
+}
+
+TEST(NGLTransformHierarchy,dirtySubtree)
+{
+  ngl::TransformHierarchy h;
+  size_t root=h.addNode();
+  size_t a=h.addNode(root);
+  size_t b=h.addNode(root);
+  size_t a1=h.addNode(a);
+  h.update();
+  for(size_t i=0; i<h.size(); ++i)
+  {
+    EXPECT_FALSE(h.isDirty(i));
+  }
+
+  h.setRotation(a,ngl::Vec3(0.0f,0.0f,90.0f));
+  EXPECT_FALSE(h.isDirty(root));
+  EXPECT_TRUE(h.isDirty(a));
+  EXPECT_FALSE(h.isDirty(b));
+  EXPECT_TRUE(h.isDirty(a1));
+
+  h.update();
+  EXPECT_FALSE(h.isDirty(a1));
+  EXPECT_TRUE(h.getWorldMatrix(root)==ngl::Mat4());
+  EXPECT_TRUE(h.getWorldMatrix(b)==ngl::Mat4());
+  EXPECT_TRUE(h.getWorldMatrix(a1)==h.getLocalMatrix(a));
+
+  // moving the root moves everything under it
+  h.setPosition(root,ngl::Vec3(0.0f,5.0f,0.0f));
+  h.update();
+  EXPECT_FLOAT_EQ(h.getWorldMatrix(b).m_31,5.0f);
+  EXPECT_FLOAT_EQ(h.getWorldMatrix(a1).m_31,5.0f);
+}
+
+TEST(NGLTransformHierarchy,updateParallel)
+{
+  // many small rigs so the parallel path is used
+  ngl::TransformHierarchy serial;
+  for(size_t rig=0; rig<1000; ++rig)
+  {
+    size_t root=serial.addNode();
+    size_t spine=serial.addNode(root);
+    serial.addNode(spine);
+    serial.addNode(spine);
+    serial.addNode(root);
+  }
+  for(size_t i=0; i<serial.size(); ++i)
+  {
+    ngl::Real v=static_cast<ngl::Real>(i%37);
+    serial.setTransform(i,ngl::Vec3(v*0.1f,1.0f,-v*0.05f),ngl::Vec3(v,2.0f*v,-v),ngl::Vec3(1.0f,1.0f+v*0.01f,1.0f));
+  }
+  ngl::TransformHierarchy parallel=serial;
+  serial.update();
+  parallel.updateParallel();
+  for(size_t i=0; i<serial.size(); ++i)
+  {
+    EXPECT_TRUE(serial.getWorldMatrix(i).m_openGL==parallel.getWorldMatrix(i).m_openGL);
+    EXPECT_TRUE(serial.getInverseWorldMatrix(i).m_openGL==parallel.getInverseWorldMatrix(i).m_openGL);
+  }
+  // then an incremental change to some of the rigs
+  for(size_t i=1; i<serial.size(); i+=50)
+  {
+    serial.setRotation(i,ngl::Vec3(10.0f,0.0f,0.0f));
+    parallel.setRotation(i,ngl::Vec3(10.0f,0.0f,0.0f));
+  }
+  serial.update();
+  parallel.updateParallel();
+  for(size_t i=0; i<serial.size(); ++i)
+  {
+    EXPECT_TRUE(serial.getWorldMatrix(i).m_openGL==parallel.getWorldMatrix(i).m_openGL);
+  }
+}
+
+TEST(NGLTransformHierarchy,updateParallelOneRig)
+{
+  // one root with wide levels so the nodes of each depth are split over threads
+  ngl::TransformHierarchy serial;
+  serial.addNode();
+  for(size_t i=1; i<8192; ++i)
+  {
+    size_t node=serial.addNode((i-1)/4);
+    ngl::Real v=static_cast<ngl::Real>(i%29);
+    serial.setTransform(node,ngl::Vec3(v*0.1f,0.5f,-v*0.05f),ngl::Vec3(v,-v,2.0f*v),ngl::Vec3(1.0f,1.0f,1.0f+v*0.01f));
+  }
+  ngl::TransformHierarchy parallel=serial;
+  serial.update();
+  parallel.updateParallel();
+  for(size_t i=0; i<serial.size(); ++i)
+  {
+    EXPECT_TRUE(serial.getWorldMatrix(i).m_openGL==parallel.getWorldMatrix(i).m_openGL);
+    EXPECT_TRUE(serial.getInverseWorldMatrix(i).m_openGL==parallel.getInverseWorldMatrix(i).m_openGL);
+  }
+  // moving one joint near the root changes its whole subtree
+  serial.setRotation(2,ngl::Vec3(0.0f,30.0f,0.0f));
+  parallel.setRotation(2,ngl::Vec3(0.0f,30.0f,0.0f));
+  serial.update();
+  parallel.updateParallel();
+  for(size_t i=0; i<serial.size(); ++i)
+  {
+    EXPECT_TRUE(serial.getWorldMatrix(i).m_openGL==parallel.getWorldMatrix(i).m_openGL);
+  }
+}
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <ngl/TransformPool.h>
+#include <ngl/Transformation.h>
+#include <ngl/Mat4.h>
+#include <ngl/Vec3.h>
+#include <ngl/SIMD.h>
+#include "../TestUtils.h"
+
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+// an odd count so the simd blocks and the scalar tail are both used
+constexpr size_t c_count=1031;
+
+static ngl::Vec3 value(size_t _i, ngl::Real _scale, ngl::Real _offset)
+{
+  return ngl::Vec3(static_cast<ngl::Real>(_i%37)*_scale+_offset,
+                   static_cast<ngl::Real>(_i%53)*-_scale+_offset,
+                   static_cast<ngl::Real>(_i%71)*_scale*0.5f+_offset);
+}
+
+static ngl::Vec3 scaleValue(size_t _i)
+{
+  return ngl::Vec3(0.5f+static_cast<ngl::Real>(_i%7)*0.25f,2.0f-static_cast<ngl::Real>(_i%5)*0.25f,0.75f+static_cast<ngl::Real>(_i%3));
+}
+
+TEST(NGLTransformPool,update)
+{
+  forEachSIMDLevel([]()
+  {
+    ngl::TransformPool pool;
+    for(size_t i=0; i<c_count; ++i)
+    {
+      // rotations well outside +/-360 check the range reduction
+      pool.add(value(i,0.5f,-3.0f),value(i,23.0f,-400.0f),scaleValue(i));
+    }
+    pool.update();
+    for(size_t i=0; i<c_count; ++i)
+    {
+      EXPECT_FALSE(pool.isDirty(i));
+      ngl::Mat4 m;
+      ngl::Mat4 inv;
+      ngl::Mat4::fromTRS(pool.getPosition(i),pool.getRotation(i),pool.getScale(i),m,inv);
+      EXPECT_TRUE(pool.matrices()[i]==m);
+      EXPECT_TRUE(pool.inverseMatrices()[i]==inv);
+    }
+  });
+}
+
+TEST(NGLTransformPool,onlyDirtySlotsUpdate)
+{
+  ngl::TransformPool pool;
+  for(size_t i=0; i<c_count; ++i)
+  {
+    pool.add(value(i,0.5f,1.0f));
+  }
+  pool.update();
+  pool.setPosition(5,ngl::Vec3(1.0f,2.0f,3.0f));
+  pool.setRotation(1030,ngl::Vec3(0.0f,90.0f,0.0f));
+  EXPECT_TRUE(pool.isDirty(5));
+  EXPECT_FALSE(pool.isDirty(6));
+  // a matrix set directly is kept by the update
+  ngl::Mat4 m(2.0f);
+  pool.setMatrix(6,m,ngl::Mat4(0.5f));
+  pool.update();
+  EXPECT_TRUE(pool.getMatrix(5)==ngl::Mat4::fromTRS(ngl::Vec3(1.0f,2.0f,3.0f),ngl::Vec3(0.0f,0.0f,0.0f),ngl::Vec3(1.0f,1.0f,1.0f)));
+  EXPECT_TRUE(pool.getMatrix(6)==m);
+  EXPECT_TRUE(pool.getMatrix(1030)==ngl::Mat4::fromTRS(value(1030,0.5f,1.0f),ngl::Vec3(0.0f,90.0f,0.0f),ngl::Vec3(1.0f,1.0f,1.0f)));
+
+  pool.release(5);
+  EXPECT_TRUE(pool.getMatrix(5)==ngl::Mat4());
+  EXPECT_EQ(pool.add(),5u);
+  EXPECT_EQ(pool.size(),c_count);
+}
+
+TEST(NGLTransformPool,transformationHandle)
+{
+  ngl::TransformPool pool;
+  ngl::Transformation standalone;
+  {
+    ngl::Transformation handle(pool);
+    EXPECT_EQ(handle.getPool(),&pool);
+    EXPECT_EQ(pool.size(),1u);
+    handle.setPosition(1.0f,2.0f,3.0f);
+    handle.setRotation(10.0f,20.0f,30.0f);
+    handle.addScale(1.0f,0.0f,0.5f);
+    standalone.setPosition(1.0f,2.0f,3.0f);
+    standalone.setRotation(10.0f,20.0f,30.0f);
+    standalone.addScale(1.0f,0.0f,0.5f);
+    EXPECT_TRUE(pool.isDirty(handle.getPoolIndex()));
+    pool.update();
+    EXPECT_TRUE(pool.getMatrix(handle.getPoolIndex())==standalone.getMatrix());
+    EXPECT_TRUE(handle.getMatrix()==standalone.getMatrix());
+    EXPECT_TRUE(handle.getInverseMatrix()==standalone.getInverseMatrix());
+    EXPECT_TRUE(handle.getTransposeMatrix()==standalone.getTransposeMatrix());
+
+    // reading the matrix without a pool update still gives the new value
+    handle.setPosition(-1.0f,0.0f,0.0f);
+    standalone.setPosition(-1.0f,0.0f,0.0f);
+    EXPECT_TRUE(handle.getMatrix()==standalone.getMatrix());
+    EXPECT_FALSE(pool.isDirty(handle.getPoolIndex()));
+
+    // copies get a slot of their own
+    ngl::Transformation copy(handle);
+    EXPECT_EQ(pool.size(),2u);
+    EXPECT_NE(copy.getPoolIndex(),handle.getPoolIndex());
+    EXPECT_TRUE(pool.getMatrix(copy.getPoolIndex())==standalone.getMatrix());
+  }
+  // both slots are released and reused
+  ngl::Transformation next(pool);
+  EXPECT_EQ(pool.size(),2u);
+  EXPECT_TRUE(next.getMatrix()==ngl::Mat4());
+}
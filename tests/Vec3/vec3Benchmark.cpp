@@ -0,0 +1,74 @@
+#include <ngl/Vec3.h>
+#include <ngl/Vec4.h>
+#include <hayai/hayai.hpp>
+#include <hayai/hayai_main.hpp>
+#include <vector>
+
+// a+b*s over a block of vectors, the typical particle / deformer update
+constexpr size_t c_count=4096;
+static std::vector<ngl::Vec3> a3(c_count,ngl::Vec3(1.0f,2.0f,3.0f));
+static std::vector<ngl::Vec3> b3(c_count,ngl::Vec3(0.5f,0.25f,2.0f));
+static std::vector<ngl::Vec3> o3(c_count);
+static std::vector<ngl::Vec4> a4(c_count,ngl::Vec4(1.0f,2.0f,3.0f,1.0f));
+static std::vector<ngl::Vec4> b4(c_count,ngl::Vec4(0.5f,0.25f,2.0f,1.0f));
+static std::vector<ngl::Vec4> o4(c_count);
+static ngl::Real s=0.5f;
+
+// calling through a pointer stops the compiler inlining, this is the cost every operator
+// had when they were only defined out of line in the library
+static ngl::Vec3 (ngl::Vec3::* volatile add3)(const ngl::Vec3 &) const=&ngl::Vec3::operator+;
+static ngl::Vec3 (ngl::Vec3::* volatile mul3)(ngl::Real) const=&ngl::Vec3::operator*;
+static ngl::Vec4 (ngl::Vec4::* volatile add4)(const ngl::Vec4 &) const=&ngl::Vec4::operator+;
+static ngl::Vec4 (ngl::Vec4::* volatile mul4)(ngl::Real) const=&ngl::Vec4::operator*;
+static ngl::Vec4 &(ngl::Vec4::* volatile assign4)(const ngl::Vec4 &)=&ngl::Vec4::operator=;
+
+BENCHMARK(Vec3Tests, AddMulInline, 10, 100)
+{
+  for(size_t i=0; i<c_count; ++i)
+  {
+    o3[i]=a3[i]+b3[i]*s;
+  }
+}
+
+BENCHMARK(Vec3Tests, AddMulOutOfLine, 10, 100)
+{
+  auto add=add3;
+  auto mul=mul3;
+  for(size_t i=0; i<c_count; ++i)
+  {
+    o3[i]=(a3[i].*add)((b3[i].*mul)(s));
+  }
+}
+
+BENCHMARK(Vec4Tests, AddMulInline, 10, 100)
+{
+  for(size_t i=0; i<c_count; ++i)
+  {
+    o4[i]=a4[i]+b4[i]*s;
+  }
+}
+
+BENCHMARK(Vec4Tests, AddMulOutOfLine, 10, 100)
+{
+  auto add=add4;
+  auto mul=mul4;
+  auto assign=assign4;
+  for(size_t i=0; i<c_count; ++i)
+  {
+    (o4[i].*assign)((a4[i].*add)((b4[i].*mul)(s)));
+  }
+}
+
+
+int main(int argc, char **argv)
+{
+    // Set up the main runner.
+    ::hayai::MainRunner runner;
+    // Parse the arguments.
+    int result = runner.ParseArgs(argc, argv);
+    if (result)
+        return result;
+
+    // Execute based on the selected mode.
+    return runner.Run();
+}
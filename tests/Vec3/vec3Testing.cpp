@@ -1,6 +1,10 @@
 #include <gtest/gtest.h>
 #include <ngl/Types.h>
 #include <ngl/Vec3.h>
+#include <ngl/Vec3Array.h>
+#include <ngl/Vec4Array.h>
+#include <ngl/Util.h>
+#include <vector>
 #include <string>
 #include <sstream>
 
@@ -57,3 +61,79 @@ TEST(NGLVec3,AssignOperator)
   ngl::Vec3 result(1.0f,2.0f,3.0f);
   EXPECT_TRUE(copy == result);
 }
+
+TEST(NGLVec3Array,AoSRoundTrip)
+{
+  // odd size so both the simd blocks and the tail are used
+  std::vector<ngl::Vec3> data;
+  for(int i=0; i<11; ++i)
+  {
+    data.push_back(ngl::Vec3(i,i*2.0f,-i*0.5f));
+  }
+  ngl::Vec3Array test(data);
+  EXPECT_EQ(test.size(),data.size());
+  auto result=test.toAoS();
+  for(size_t i=0; i<data.size(); ++i)
+  {
+    EXPECT_TRUE(result[i] == data[i])<<print(result[i])<<print(data[i]);
+    EXPECT_TRUE(test.get(i) == data[i]);
+  }
+}
+
+TEST(NGLVec3Array,BulkOps)
+{
+  std::vector<ngl::Vec3> a;
+  std::vector<ngl::Vec3> b;
+  for(int i=0; i<9; ++i)
+  {
+    a.push_back(ngl::Vec3(i+1.0f,2.0f,-i*0.5f));
+    b.push_back(ngl::Vec3(0.5f,i-3.0f,1.0f));
+  }
+  ngl::Vec3Array va(a);
+  ngl::Vec3Array vb(b);
+  std::vector<ngl::Real> dot(a.size());
+  std::vector<ngl::Real> len(a.size());
+  va.dot(vb,&dot[0]);
+  va.length(&len[0]);
+  ngl::Vec3Array cross;
+  va.cross(vb,cross);
+  ngl::Vec3Array lerp;
+  va.lerp(vb,0.25f,lerp);
+  for(size_t i=0; i<a.size(); ++i)
+  {
+    EXPECT_FLOAT_EQ(dot[i],a[i].dot(b[i]));
+    EXPECT_FLOAT_EQ(len[i],a[i].length());
+    EXPECT_TRUE(cross.get(i) == a[i].cross(b[i]));
+    EXPECT_TRUE(lerp.get(i) == ngl::lerp(a[i],b[i],0.25f));
+  }
+  va.normalize();
+  for(size_t i=0; i<a.size(); ++i)
+  {
+    a[i].normalize();
+    EXPECT_TRUE(va.get(i) == a[i]);
+  }
+  ngl::Vec3 min;
+  ngl::Vec3 max;
+  vb.minMax(min,max);
+  EXPECT_TRUE(min == ngl::Vec3(0.5f,-3.0f,1.0f));
+  EXPECT_TRUE(max == ngl::Vec3(0.5f,5.0f,1.0f));
+}
+
+TEST(NGLVec4Array,AoSRoundTrip)
+{
+  std::vector<ngl::Vec4> data;
+  for(int i=0; i<7; ++i)
+  {
+    data.push_back(ngl::Vec4(i,i*2.0f,-i*0.5f,i*0.1f));
+  }
+  ngl::Vec4Array test(data);
+  auto result=test.toAoS();
+  for(size_t i=0; i<data.size(); ++i)
+  {
+    EXPECT_TRUE(result[i] == data[i]);
+    EXPECT_FLOAT_EQ(result[i].m_w,data[i].m_w);
+  }
+  test.resize(9);
+  EXPECT_TRUE(test.get(8) == ngl::Vec4());
+  EXPECT_FLOAT_EQ(test.get(8).m_w,1.0f);
+}
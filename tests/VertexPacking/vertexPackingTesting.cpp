@@ -0,0 +1,229 @@
+#include <gtest/gtest.h>
+#include <ngl/VertexPacking.h>
+#include <ngl/Vec4.h>
+#include <ngl/SIMD.h>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+#include "../TestUtils.h"
+
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+static ngl::Vec3 randomVec3(unsigned int &io_seed, ngl::Real _min, ngl::Real _max)
+{
+  ngl::Real x=randomReal(io_seed,_min,_max);
+  ngl::Real y=randomReal(io_seed,_min,_max);
+  ngl::Real z=randomReal(io_seed,_min,_max);
+  return ngl::Vec3(x,y,z);
+}
+
+static ngl::Vec3 randomUnit(unsigned int &io_seed)
+{
+  ngl::Vec3 n;
+  do
+  {
+    n=randomVec3(io_seed,-1.0f,1.0f);
+  } while(n.lengthSquared()<0.01f || n.lengthSquared()>1.0f);
+  n.normalize();
+  return n;
+}
+
+TEST(VertexPacking,halfValues)
+{
+  EXPECT_EQ(ngl::floatToHalf(0.0f),0x0000);
+  EXPECT_EQ(ngl::floatToHalf(-0.0f),0x8000);
+  EXPECT_EQ(ngl::floatToHalf(1.0f),0x3c00);
+  EXPECT_EQ(ngl::floatToHalf(-2.0f),0xc000);
+  EXPECT_EQ(ngl::floatToHalf(0.1f),0x2e66);
+  EXPECT_EQ(ngl::floatToHalf(65504.0f),0x7bff);
+  EXPECT_EQ(ngl::floatToHalf(65519.0f),0x7bff);
+  EXPECT_EQ(ngl::floatToHalf(65520.0f),0x7c00);
+  EXPECT_EQ(ngl::floatToHalf(-1.0e10f),0xfc00);
+  EXPECT_EQ(ngl::floatToHalf(std::numeric_limits<float>::infinity()),0x7c00);
+  // the smallest denormal, half way to it rounds to even (zero) and just over rounds up
+  EXPECT_EQ(ngl::floatToHalf(std::ldexp(1.0f,-24)),0x0001);
+  EXPECT_EQ(ngl::floatToHalf(std::ldexp(1.0f,-25)),0x0000);
+  EXPECT_EQ(ngl::floatToHalf(std::ldexp(1.5f,-25)),0x0001);
+  // ties to even in the normal range, 1+2^-11 is half way between 1 and the next half
+  EXPECT_EQ(ngl::floatToHalf(1.0f+std::ldexp(1.0f,-11)),0x3c00);
+  EXPECT_EQ(ngl::floatToHalf(1.0f+3.0f*std::ldexp(1.0f,-11)),0x3c02);
+  uint16_t nan=ngl::floatToHalf(std::numeric_limits<float>::quiet_NaN());
+  EXPECT_EQ(nan&0x7c00,0x7c00);
+  EXPECT_NE(nan&0x3ff,0);
+  EXPECT_FLOAT_EQ(ngl::halfToFloat(0x3555),0.333251953125f);
+  EXPECT_FLOAT_EQ(ngl::halfToFloat(0x0001),std::ldexp(1.0f,-24));
+}
+
+TEST(VertexPacking,halfRoundTrip)
+{
+  // every half converts to a float and back to itself
+  for(uint32_t h=0; h<0x10000u; ++h)
+  {
+    float f=ngl::halfToFloat(static_cast<uint16_t>(h));
+    if((h&0x7c00u)==0x7c00u && (h&0x3ffu)!=0)
+    {
+      EXPECT_TRUE(std::isnan(f));
+      continue;
+    }
+    ASSERT_EQ(ngl::floatToHalf(f),h);
+  }
+}
+
+TEST(VertexPacking,halfArraysMatchScalar)
+{
+  // random bit patterns cover denormals, overflow, infinity and nan, 1003 values checks the scalar tail
+  std::vector<float> values(1003);
+  unsigned int seed=7u;
+  for(auto &v : values)
+  {
+    seed=seed*1664525u+1013904223u;
+    uint32_t bits=seed;
+    // keep most of them in the half range
+    if(bits&1u)
+    {
+      bits=(bits&0x83ffffffu) | (0x30000000u+(bits&0x0e000000u));
+    }
+    std::memcpy(&v,&bits,sizeof(v));
+  }
+  forEachSIMDLevel([&values]()
+  {
+    std::vector<uint16_t> halves(values.size());
+    ngl::floatToHalf(values.data(),values.size(),halves.data());
+    for(size_t i=0; i<values.size(); ++i)
+    {
+      ASSERT_EQ(halves[i],ngl::floatToHalf(values[i])) << i;
+    }
+    std::vector<float> floats(values.size());
+    ngl::halfToFloat(halves.data(),halves.size(),floats.data());
+    for(size_t i=0; i<values.size(); ++i)
+    {
+      float expected=ngl::halfToFloat(halves[i]);
+      ASSERT_EQ(std::memcmp(&floats[i],&expected,sizeof(float)),0) << i;
+    }
+  });
+}
+
+TEST(VertexPacking,octahedral)
+{
+  unsigned int seed=11u;
+  std::vector<ngl::Vec3> normals={ngl::Vec3(1.0f,0.0f,0.0f),ngl::Vec3(0.0f,-1.0f,0.0f),ngl::Vec3(0.0f,0.0f,1.0f),
+                                  ngl::Vec3(0.0f,0.0f,-1.0f),ngl::Vec3(-1.0f,0.0f,-1.0f)};
+  for(size_t i=0; i<10000; ++i)
+  {
+    normals.push_back(randomUnit(seed));
+  }
+  // the angle error is well under 0.01 degrees, measured by the sine as the cosine is 1 in a float
+  ngl::Real maxSin=std::sin(0.01f*static_cast<ngl::Real>(M_PI)/180.0f);
+  for(auto n : normals)
+  {
+    n.normalize();
+    ngl::Vec3 d=ngl::unpackOctahedral(ngl::packOctahedral(n));
+    EXPECT_NEAR(d.length(),1.0f,1.0e-5f);
+    EXPECT_GT(d.dot(n),0.0f);
+    EXPECT_LE(d.cross(n).length(),maxSin);
+  }
+  // a zero normal decodes to a unit vector rather than nan
+  ngl::Vec3 z=ngl::unpackOctahedral(ngl::packOctahedral(ngl::Vec3(0.0f,0.0f,0.0f)));
+  EXPECT_FLOAT_EQ(z.m_z,1.0f);
+}
+
+TEST(VertexPacking,snorm1010102)
+{
+  // x in the low 10 bits, -1 is -511 (0x201)
+  EXPECT_EQ(ngl::packSnorm1010102(ngl::Vec3(1.0f,-1.0f,0.0f)),511u | (0x201u<<10));
+  unsigned int seed=13u;
+  for(size_t i=0; i<10000; ++i)
+  {
+    ngl::Vec3 n=randomUnit(seed);
+    ngl::Vec3 d=ngl::unpackSnorm1010102(ngl::packSnorm1010102(n));
+    for(size_t k=0; k<3; ++k)
+    {
+      EXPECT_NEAR(d.m_openGL[k],n.m_openGL[k],0.5f/511.0f+1.0e-6f);
+    }
+  }
+}
+
+TEST(VertexPacking,layouts)
+{
+  ngl::VertexLayout f;
+  EXPECT_TRUE(f.isFloat());
+  EXPECT_EQ(f.uvOffset(),0u);
+  EXPECT_EQ(f.normalOffset(),8u);
+  EXPECT_EQ(f.positionOffset(),20u);
+  EXPECT_EQ(f.stride(),32u);
+  ngl::VertexLayout c=ngl::VertexLayout::compact();
+  EXPECT_FALSE(c.isFloat());
+  EXPECT_EQ(c.normalOffset(),4u);
+  EXPECT_EQ(c.positionOffset(),8u);
+  EXPECT_EQ(c.stride(),16u);
+  ngl::VertexLayout h(ngl::VertexLayout::Position::HALF,ngl::VertexLayout::Normal::SNORM_10_10_10_2,ngl::VertexLayout::UV::FLOAT);
+  EXPECT_EQ(h.positionOffset(),12u);
+  EXPECT_EQ(h.stride(),20u);
+}
+
+TEST(VertexPacking,packFloat)
+{
+  // the float layout is the u,v,nx,ny,nz,x,y,z vertex
+  ngl::Vec3 p(1.0f,2.0f,3.0f);
+  ngl::Vec3 n(0.0f,1.0f,0.0f);
+  ngl::Vec3 uv(0.25f,0.75f,0.0f);
+  ngl::VertexLayout layout;
+  float data[8];
+  ngl::packVertices(layout,1,&p,&n,&uv,ngl::Bounds3(),reinterpret_cast<unsigned char *>(data));
+  float expected[8]={0.25f,0.75f,0.0f,1.0f,0.0f,1.0f,2.0f,3.0f};
+  for(size_t i=0; i<8; ++i)
+  {
+    EXPECT_FLOAT_EQ(data[i],expected[i]);
+  }
+  EXPECT_TRUE(layout.dequantize(ngl::Bounds3(ngl::Vec3(-1.0f,-1.0f,-1.0f),ngl::Vec3(1.0f,1.0f,1.0f)))==ngl::Mat4());
+}
+
+TEST(VertexPacking,packCompact)
+{
+  forEachSIMDLevel([]()
+  {
+    unsigned int seed=17u;
+    // enough vertices for more than one conversion block
+    size_t count=1000;
+    std::vector<ngl::Vec3> positions,normals,uvs;
+    for(size_t i=0; i<count; ++i)
+    {
+      positions.push_back(randomVec3(seed,-5.0f,20.0f));
+      normals.push_back(randomUnit(seed));
+      uvs.push_back(ngl::Vec3(randomReal(seed,0.0f,1.0f),randomReal(seed,0.0f,1.0f),0.0f));
+    }
+    ngl::Bounds3 box=ngl::Bounds3::fromPoints(positions.data(),count);
+    ngl::VertexLayout layout=ngl::VertexLayout::compact();
+    std::vector<unsigned char> data(count*layout.stride());
+    ngl::packVertices(layout,count,positions.data(),normals.data(),uvs.data(),box,data.data());
+    ngl::Mat4 dequantize=layout.dequantize(box);
+    ngl::Vec3 size=box.size();
+    for(size_t i=0; i<count; ++i)
+    {
+      const unsigned char *v=&data[i*layout.stride()];
+      uint16_t uv[2];
+      std::memcpy(uv,v+layout.uvOffset(),sizeof(uv));
+      EXPECT_NEAR(ngl::halfToFloat(uv[0]),uvs[i].m_x,1.0f/2048.0f);
+      EXPECT_NEAR(ngl::halfToFloat(uv[1]),uvs[i].m_y,1.0f/2048.0f);
+      uint32_t normal;
+      std::memcpy(&normal,v+layout.normalOffset(),sizeof(normal));
+      EXPECT_GT(ngl::unpackOctahedral(normal).dot(normals[i]),0.99999f);
+      uint16_t p[4];
+      std::memcpy(p,v+layout.positionOffset(),sizeof(p));
+      EXPECT_EQ(p[3],0);
+      // the shader sees each unorm as value / 65535
+      ngl::Vec4 q(p[0]/65535.0f,p[1]/65535.0f,p[2]/65535.0f,1.0f);
+      ngl::Vec4 r=q*dequantize;
+      for(size_t k=0; k<3; ++k)
+      {
+        EXPECT_NEAR(r.m_openGL[k],positions[i].m_openGL[k],size.m_openGL[k]/65535.0f);
+      }
+    }
+  });
+}